@@ -316,6 +316,57 @@ static void DeleteTest()
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+static void ReadSnapshotTest()
+{
+    static char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+    static char valuePathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    snprintf(pathBuffer, LE_CFG_STR_LEN_BYTES, "%s/readSnapshotTest/", TestRootDir);
+    snprintf(valuePathBuffer, LE_CFG_STR_LEN_BYTES, "%s/readSnapshotTest/valueC", TestRootDir);
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+
+    le_cfg_SetString(iterRef, "valueA", "before");
+    le_cfg_SetString(iterRef, "valueB", "before");
+
+    le_cfg_CommitTxn(iterRef);
+
+
+
+    // If the writes had to wait for this read transaction to end, they would never finish.
+    le_cfg_IteratorRef_t readIterRef = le_cfg_CreateReadTxn(pathBuffer);
+
+    iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+
+    le_cfg_SetString(iterRef, "valueA", "after");
+    le_cfg_DeleteNode(iterRef, "valueB");
+
+    le_cfg_CommitTxn(iterRef);
+
+    le_cfg_QuickSetString(valuePathBuffer, "after");
+
+    TestValue(readIterRef, "valueA", "before");
+    TestValue(readIterRef, "valueB", "before");
+    TestValue(readIterRef, "valueC", "");
+
+    le_cfg_CancelTxn(readIterRef);
+
+
+
+    readIterRef = le_cfg_CreateReadTxn(pathBuffer);
+
+    TestValue(readIterRef, "valueA", "after");
+    TestValue(readIterRef, "valueB", "");
+    TestValue(readIterRef, "valueC", "after");
+
+    le_cfg_CancelTxn(readIterRef);
+}
+#endif
+
+
+
+
 static void StringSizeTest()
 {
     le_result_t result;
@@ -800,6 +851,52 @@ static void BinaryTest
 }
 
 
+static void SubtreeTest
+(
+    void
+)
+{
+    static char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    snprintf(pathBuffer, LE_CFG_STR_LEN_BYTES, "%s/test_subtree", TestRootDir);
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+    le_cfg_SetInt(iterRef, "stem/num", 42);
+    le_cfg_CommitTxn(iterRef);
+
+    static const uint8_t expected[] =
+    {
+        LE_CFG_TYPE_STEM, 't', 'e', 's', 't', '_', 's', 'u', 'b', 't', 'r', 'e', 'e', '\0',
+            LE_CFG_TYPE_STEM, 's', 't', 'e', 'm', '\0',
+                LE_CFG_TYPE_INT, 'n', 'u', 'm', '\0', '4', '2', '\0',
+            LE_CFG_SUBTREE_END,
+        LE_CFG_SUBTREE_END
+    };
+    uint8_t subtree[LE_CFG_BINARY_LEN];
+    size_t len = sizeof(subtree);
+
+    LE_TEST(le_cfg_QuickGetSubtree(pathBuffer, subtree, &len) == LE_OK);
+    LE_TEST(len == sizeof(expected));
+    LE_TEST(memcmp(subtree, expected, sizeof(expected)) == 0);
+
+    // Read the same subtree through an iterator, from the parent node.
+    iterRef = le_cfg_CreateReadTxn(TestRootDir);
+    len = sizeof(subtree);
+    LE_TEST(le_cfg_GetSubtree(iterRef, "test_subtree", subtree, &len) == LE_OK);
+    LE_TEST(len == sizeof(expected));
+    LE_TEST(memcmp(subtree, expected, sizeof(expected)) == 0);
+
+    len = sizeof(subtree);
+    LE_TEST(le_cfg_GetSubtree(iterRef, "test_subtree/missing", subtree, &len) == LE_NOT_FOUND);
+    LE_TEST(len == 0);
+    le_cfg_CancelTxn(iterRef);
+
+    // A buffer too small for the subtree.
+    len = sizeof(expected) - 1;
+    LE_TEST(le_cfg_QuickGetSubtree(pathBuffer, subtree, &len) == LE_OVERFLOW);
+}
+
+
 static void ListTreeTest()
 {
     SetSimpleValue("foo");
@@ -964,6 +1061,91 @@ static void TestStringOverwrite
                 strBuffer);
 }
 
+// Enough children to make the config tree index them by name.
+#define LARGE_FAN_OUT_COUNT 500
+
+static void LargeFanOutTest()
+{
+    static char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+    char nameBuffer[LE_CFG_NAME_LEN_BYTES] = "";
+    int i;
+
+    LE_INFO("---- Large Fan-out Test ------------------------------------------------------------");
+
+    snprintf(pathBuffer, LE_CFG_STR_LEN_BYTES, "%s/largeFanOut/", TestRootDir);
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+
+    for (i = 0; i < LARGE_FAN_OUT_COUNT; i++)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "child%d", i);
+        le_cfg_SetInt(iterRef, nameBuffer, i);
+    }
+
+    le_cfg_CommitTxn(iterRef);
+
+
+
+    // Delete every seventh child.
+    iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+
+    for (i = 0; i < LARGE_FAN_OUT_COUNT; i += 7)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "child%d", i);
+        le_cfg_DeleteNode(iterRef, nameBuffer);
+    }
+
+    le_cfg_CommitTxn(iterRef);
+
+
+
+    iterRef = le_cfg_CreateReadTxn(pathBuffer);
+
+    for (i = 0; i < LARGE_FAN_OUT_COUNT; i++)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "child%d", i);
+
+        if ((i % 7) == 0)
+        {
+            LE_TEST(le_cfg_NodeExists(iterRef, nameBuffer) == false);
+        }
+        else
+        {
+            LE_TEST(le_cfg_GetInt(iterRef, nameBuffer, -1) == i);
+        }
+    }
+
+    LE_TEST(le_cfg_NodeExists(iterRef, "child") == false);
+
+    le_cfg_CancelTxn(iterRef);
+
+
+
+    // Put the deleted children back, and check that they are found in the same transaction.
+    iterRef = le_cfg_CreateWriteTxn(pathBuffer);
+
+    for (i = 0; i < LARGE_FAN_OUT_COUNT; i += 7)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "child%d", i);
+        le_cfg_SetInt(iterRef, nameBuffer, -i);
+        LE_TEST(le_cfg_GetInt(iterRef, nameBuffer, 1) == -i);
+    }
+
+    le_cfg_CommitTxn(iterRef);
+
+
+
+    iterRef = le_cfg_CreateReadTxn(pathBuffer);
+
+    for (i = 0; i < LARGE_FAN_OUT_COUNT; i++)
+    {
+        snprintf(nameBuffer, sizeof(nameBuffer), "child%d", i);
+        LE_TEST(le_cfg_GetInt(iterRef, nameBuffer, 1) == (((i % 7) == 0) ? -i : i));
+    }
+
+    le_cfg_CancelTxn(iterRef);
+}
+
 COMPONENT_INIT
 {
     strncpy(TestRootDir, "/configTest", LE_CFG_STR_LEN_BYTES);
@@ -985,6 +1167,9 @@ COMPONENT_INIT
     QuickFunctionTest();
     TestImportLargeString();
     DeleteTest();
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    ReadSnapshotTest();
+#endif
     StringSizeTest();
     TestImportExport();
     MultiTreeTest();
@@ -992,6 +1177,8 @@ COMPONENT_INIT
     ListTreeTest();
     CallbackTest();
     BinaryTest();
+    SubtreeTest();
+    LargeFanOutTest();
 
     // overwrite a large string with a small string and vice-versa
     TestStringOverwrite();
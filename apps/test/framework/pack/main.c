@@ -112,6 +112,51 @@ static void TestString(void)
     CheckString("", 512, 12, true); // Empty
 }
 
+/** Raw arrays **/
+
+static void TestRawArray(void)
+{
+    static const int32_t array[] = { 0, -1, 0x12345678, INT32_MIN, INT32_MAX };
+    uint8_t buffer[BUFFER_SZ];
+    uint8_t rawBuffer[BUFFER_SZ];
+    uint8_t* bufferPtr = buffer;
+    uint8_t* rawBufferPtr = rawBuffer;
+    bool result;
+
+    printf("=> raw array\n");
+
+    ResetBuffer(buffer, sizeof(buffer));
+    ResetBuffer(rawBuffer, sizeof(rawBuffer));
+
+    // Packing the whole array at once must give the same message as packing each element.
+    LE_PACK_PACKARRAY(&bufferPtr, array, NUM_ARRAY_MEMBERS(array), 8,
+                      le_pack_PackInt32, &result);
+    LE_TEST(result);
+    LE_PACK_PACKRAWARRAY(&rawBufferPtr, array, NUM_ARRAY_MEMBERS(array), 8, &result);
+    LE_TEST(result);
+    LE_TEST((rawBufferPtr - rawBuffer) == (bufferPtr - buffer));
+    LE_TEST(0 == memcmp(buffer, rawBuffer, sizeof(buffer)));
+
+    // Unpack
+    int32_t valueOut[8];
+    size_t countOut = 0;
+    rawBufferPtr = rawBuffer;
+    LE_PACK_UNPACKRAWARRAY(&rawBufferPtr, valueOut, &countOut, NUM_ARRAY_MEMBERS(valueOut),
+                           &result);
+    LE_TEST(result);
+    LE_TEST(countOut == NUM_ARRAY_MEMBERS(array));
+    LE_TEST(0 == memcmp(array, valueOut, sizeof(array)));
+    LE_TEST(rawBufferPtr == bufferPtr - buffer + rawBuffer);
+
+    // Too many elements
+    rawBufferPtr = rawBuffer;
+    LE_PACK_PACKRAWARRAY(&rawBufferPtr, array, NUM_ARRAY_MEMBERS(array), 4, &result);
+    LE_TEST(!result);
+    rawBufferPtr = buffer;
+    LE_PACK_UNPACKRAWARRAY(&rawBufferPtr, valueOut, &countOut, 4, &result);
+    LE_TEST(!result);
+}
+
 COMPONENT_INIT
 {
     printf("======== le_pack Test Started ========\n");
@@ -121,6 +166,7 @@ COMPONENT_INIT
 
     TestUint8();
     TestString();
+    TestRawArray();
 
     printf("======== le_pack Test Complete ========\n");
     printf("\n");
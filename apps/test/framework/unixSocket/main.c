@@ -0,0 +1,225 @@
+/**
+ * This module is for unit testing the batch receive of the unixSocket module in the legato
+ * runtime library (liblegato.so).
+ *
+ * The following is a list of the test cases:
+ *
+ *  - Receiving a batch with a message too big for its buffer in the middle: the messages after it
+ *    are still received, and the file descriptor sent with it is closed.
+ *  - Receiving a batch that starts with a message too big for its buffer.
+ *  - Receiving the end of the connection after the last batch.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "unixSocket.h"
+#include "fileDescriptor.h"
+#include <dirent.h>
+
+/// Size of the receive buffers.
+#define BUFF_SIZE       16
+
+/// Size of the messages that fit in the receive buffers.
+#define SMALL_MSG_SIZE  8
+
+/// Size of the messages that don't.
+#define BIG_MSG_SIZE    64
+
+/// Number of buffers passed to unixSocket_ReceiveMsgBatch().
+#define BATCH_SIZE      8
+
+static uint8_t Buffs[BATCH_SIZE][BUFF_SIZE];
+static unixSocket_MsgBuff_t MsgBuffs[BATCH_SIZE];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the file descriptors open in this process.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CountOpenFds
+(
+    void
+)
+{
+    DIR* dirPtr = opendir("/proc/self/fd");
+    int count = 0;
+
+    LE_ASSERT(dirPtr != NULL);
+    while (readdir(dirPtr) != NULL)
+    {
+        count++;
+    }
+    closedir(dirPtr);
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a message whose bytes are all set to its sequence number.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendMsg
+(
+    int     socketFd,
+    uint8_t seq,
+    size_t  size,
+    bool    withFd      ///< true to send a file descriptor with the message.
+)
+{
+    uint8_t data[BIG_MSG_SIZE];
+    int fd = -1;
+
+    LE_ASSERT(size <= sizeof(data));
+    memset(data, seq, size);
+
+    if (withFd)
+    {
+        fd = open("/dev/null", O_RDONLY);
+        LE_ASSERT(fd >= 0);
+    }
+
+    LE_ASSERT_OK(unixSocket_SendMsg(socketFd, data, size, fd, false));
+
+    if (fd >= 0)
+    {
+        fd_Close(fd);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive a batch of messages into the buffers.
+ *
+ * @return The unixSocket_ReceiveMsgBatch() result.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReceiveBatch
+(
+    int     socketFd,
+    size_t* countPtr    ///< [OUT] Number of messages received.
+)
+{
+    size_t i;
+
+    for (i = 0; i < BATCH_SIZE; i++)
+    {
+        MsgBuffs[i].dataPtr = Buffs[i];
+        MsgBuffs[i].dataSize = BUFF_SIZE;
+        MsgBuffs[i].fd = -1;
+    }
+
+    *countPtr = BATCH_SIZE;
+    return unixSocket_ReceiveMsgBatch(socketFd, MsgBuffs, countPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a message of the last batch was received whole.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMsg
+(
+    size_t  index,
+    uint8_t seq,
+    bool    withFd      ///< true if a file descriptor was sent with the message.
+)
+{
+    size_t i;
+
+    LE_ASSERT(MsgBuffs[index].result == LE_OK);
+    LE_ASSERT(MsgBuffs[index].dataSize == SMALL_MSG_SIZE);
+    for (i = 0; i < SMALL_MSG_SIZE; i++)
+    {
+        LE_ASSERT(Buffs[index][i] == seq);
+    }
+
+    if (withFd)
+    {
+        LE_ASSERT(MsgBuffs[index].fd >= 0);
+        fd_Close(MsgBuffs[index].fd);
+    }
+    else
+    {
+        LE_ASSERT(MsgBuffs[index].fd == -1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a message of the last batch was too big for its buffer, and that no file descriptor
+ * is returned for it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckBigMsg
+(
+    size_t  index
+)
+{
+    LE_ASSERT(MsgBuffs[index].result == LE_NO_MEMORY);
+    LE_ASSERT(MsgBuffs[index].fd == -1);
+}
+
+
+COMPONENT_INIT
+{
+    int sendFd;
+    int recvFd;
+    size_t count;
+    int fdCount;
+
+    LE_INFO("======== Begin unixSocket batch receive test ========");
+
+    LE_ASSERT_OK(unixSocket_CreateSeqPacketPair(&sendFd, &recvFd));
+    fd_SetNonBlocking(recvFd);
+
+    fdCount = CountOpenFds();
+
+    LE_INFO("Too big message in the middle of a batch");
+    SendMsg(sendFd, 0, SMALL_MSG_SIZE, false);
+    SendMsg(sendFd, 1, BIG_MSG_SIZE, true);
+    SendMsg(sendFd, 2, SMALL_MSG_SIZE, true);
+    SendMsg(sendFd, 3, SMALL_MSG_SIZE, false);
+
+    LE_ASSERT_OK(ReceiveBatch(recvFd, &count));
+    LE_ASSERT(count == 4);
+    CheckMsg(0, 0, false);
+    CheckBigMsg(1);
+    CheckMsg(2, 2, true);
+    CheckMsg(3, 3, false);
+
+    // The file descriptor sent with the message that was too big has been closed.
+    LE_ASSERT(CountOpenFds() == fdCount);
+
+    LE_ASSERT(ReceiveBatch(recvFd, &count) == LE_WOULD_BLOCK);
+    LE_ASSERT(count == 0);
+
+    LE_INFO("Too big message at the start of a batch");
+    SendMsg(sendFd, 4, BIG_MSG_SIZE, false);
+    SendMsg(sendFd, 5, SMALL_MSG_SIZE, false);
+
+    LE_ASSERT_OK(ReceiveBatch(recvFd, &count));
+    LE_ASSERT(count == 2);
+    CheckBigMsg(0);
+    CheckMsg(1, 5, false);
+
+    LE_INFO("End of the connection after the last batch");
+    SendMsg(sendFd, 6, SMALL_MSG_SIZE, false);
+    SendMsg(sendFd, 7, BIG_MSG_SIZE, false);
+    fd_Close(sendFd);
+
+    LE_ASSERT_OK(ReceiveBatch(recvFd, &count));
+    LE_ASSERT(count == 2);
+    CheckMsg(0, 6, false);
+    CheckBigMsg(1);
+
+    LE_ASSERT(ReceiveBatch(recvFd, &count) == LE_CLOSED);
+    LE_ASSERT(count == 0);
+
+    fd_Close(recvFd);
+
+    LE_INFO("======== unixSocket batch receive test PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,31 @@
+/**
+ * This module implements some stubs for the sysfs GPIO benchmark.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fetch the process ID of the client of a session (STUBBED FUNCTION)
+ *
+ * The sessions of the test are not real: the process ID is the value of the session reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t MyGetClientProcessId
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    pid_t*              processIdPtr///< [out] Ptr to where the process id is to be stored.
+)
+{
+    if (NULL == sessionRef)
+    {
+        return LE_CLOSED;
+    }
+
+    *processIdPtr = (pid_t)(intptr_t)sessionRef;
+    return LE_OK;
+}
@@ -0,0 +1,29 @@
+/**
+ * interfaces.h
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#ifndef _INTERFACES_H
+#define _INTERFACES_H
+
+#include "le_gpioPin2_interface.h"
+
+#undef LE_KILL_CLIENT
+#define LE_KILL_CLIENT LE_ERROR
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fetch the process ID of the client of a session (STUBBED FUNCTION)
+ *
+ * The sessions of the test are not real: the process ID is the value of the session reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t MyGetClientProcessId
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    pid_t*              processIdPtr///< [out] Ptr to where the process id is to be stored.
+);
+
+#endif /* interfaces.h */
@@ -0,0 +1,506 @@
+/**
+ * This module benchmarks the sysfs GPIO service against an emulated /sys/class/gpio tree, so that
+ * it runs without hardware.
+ *
+ * Usage: gpioSysfsBench [-n <toggles>]
+ *
+ * The tree is made of regular files under /dev/shm/gpioSysfsBench, which is a tmpfs on most
+ * systems, so that the file system costs about as little as sysfs does. Toggling a pin with the
+ * original path based access (check the directory, fopen, fwrite, fclose for "direction" then
+ * "value") is timed against gpioSysfs_Activate() and gpioSysfs_Deactivate(), which keep the
+ * attribute files open. A bank of pins is also driven with gpioSysfs_WritePins() and pin by pin.
+ *
+ * Before timing, the results of the service are checked against the content of the files.
+ *
+ * @note Regular files are not truncated by a write at offset 0, unlike sysfs attributes, so only
+ *       the prefix of the attributes is checked.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "gpioSysfs.h"
+#include <sys/vfs.h>
+#include <linux/magic.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the emulated tree. SYSFS_GPIO_PATH in gpioSysfs/Component.cdef must be below it.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT          "/dev/shm/gpioSysfsBench"
+#define GPIO_PATH           BENCH_ROOT "/sys/class/gpio"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of emulated pins, advertised in the mask of gpiochip1
+ */
+//--------------------------------------------------------------------------------------------------
+#define NB_PINS             8
+#define CHIP_MASK           "0x00000000000000ff\n"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fake client processes: the process ID of a session is the value of its reference.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CLIENT_PID          1001
+#define OTHER_CLIENT_PID    1002
+#define CLIENT_SESSION      ((le_msg_SessionRef_t)(intptr_t)CLIENT_PID)
+#define OTHER_SESSION       ((le_msg_SessionRef_t)(intptr_t)OTHER_CLIENT_PID)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pins held by the client: all but the last one, which is held by the other client
+ */
+//--------------------------------------------------------------------------------------------------
+#define CLIENT_PINS_MASK    ((1ULL << (NB_PINS - 1)) - 1)
+
+#define DEFAULT_TOGGLES     100000
+
+static int Toggles = DEFAULT_TOGGLES;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Emulated pins, GpioRefs[n-1] being GPIO n
+ */
+//--------------------------------------------------------------------------------------------------
+static char PinNames[NB_PINS][8];
+static struct gpioSysfs_Gpio Pins[NB_PINS];
+static gpioSysfs_GpioRef_t GpioRefs[NB_PINS];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file of the emulated tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFile
+(
+    const char* pathPtr,
+    const char* contentPtr
+)
+{
+    int fd = open(pathPtr, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, contentPtr, strlen(contentPtr)) == (ssize_t)strlen(contentPtr));
+    LE_ASSERT(close(fd) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the beginning of a file of the emulated tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FileStartsWith
+(
+    const char* pathPtr,
+    const char* contentPtr
+)
+{
+    char buf[32] = {0};
+    int fd = open(pathPtr, O_RDONLY);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(read(fd, buf, sizeof(buf) - 1) >= 0);
+    LE_ASSERT(close(fd) == 0);
+
+    return (strncmp(buf, contentPtr, strlen(contentPtr)) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the beginning of an attribute of an emulated pin.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool AttrStartsWith
+(
+    int pinNum,
+    const char* attrPtr,
+    const char* contentPtr
+)
+{
+    char path[128];
+
+    snprintf(path, sizeof(path), "%s/gpio%d/%s", GPIO_PATH, pinNum, attrPtr);
+    return FileStartsWith(path, contentPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the emulated tree: the mask of gpiochip1, and the attributes of exported pins.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeTree
+(
+    void
+)
+{
+    static const char* const attrs[][2] =
+    {
+        { "value",      "0\n" },
+        { "direction",  "in\n" },
+        { "edge",       "none\n" },
+        { "active_low", "0\n" },
+        { "pull",       "down\n" },
+    };
+    char path[128];
+    struct statfs fs;
+    int pin;
+    size_t i;
+
+    le_dir_RemoveRecursive(BENCH_ROOT);
+
+    LE_ASSERT(le_dir_MakePath(GPIO_PATH "/gpiochip1", S_IRWXU) == LE_OK);
+    WriteFile(GPIO_PATH "/gpiochip1/mask", CHIP_MASK);
+    WriteFile(GPIO_PATH "/export", "");
+
+    for (pin = 1; pin <= NB_PINS; pin++)
+    {
+        snprintf(path, sizeof(path), "%s/gpio%d", GPIO_PATH, pin);
+        LE_ASSERT(le_dir_Make(path, S_IRWXU) == LE_OK);
+
+        for (i = 0; i < NUM_ARRAY_MEMBERS(attrs); i++)
+        {
+            snprintf(path, sizeof(path), "%s/gpio%d/%s", GPIO_PATH, pin, attrs[i][0]);
+            WriteFile(path, attrs[i][1]);
+        }
+    }
+
+    if ((statfs(BENCH_ROOT, &fs) == 0) && (fs.f_type != TMPFS_MAGIC))
+    {
+        LE_WARN("%s is not on a tmpfs: the timings include the cost of the file system",
+                BENCH_ROOT);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write an attribute the way the service did before keeping the files open: check that the
+ * directory exists, then open, write and close the file.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LegacyWriteAttr
+(
+    const char* pathPtr,
+    const char* attrPtr
+)
+{
+    DIR* dir = opendir(pathPtr);
+    FILE* fp;
+
+    if (dir)
+    {
+        closedir(dir);
+    }
+    else if (ENOENT == errno)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    fp = fopen(pathPtr, "w");
+    if (!fp)
+    {
+        return LE_IO_ERROR;
+    }
+
+    size_t written = fwrite(attrPtr, 1, strlen(attrPtr), fp);
+    fflush(fp);
+    int fileError = ferror(fp);
+    fclose(fp);
+
+    return ((fileError == 0) && (written == strlen(attrPtr))) ? LE_OK : LE_IO_ERROR;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read an attribute the way the service did before keeping the files open.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LegacyReadAttr
+(
+    const char* pathPtr,
+    int size,
+    char* attrPtr
+)
+{
+    DIR* dir = opendir(pathPtr);
+    FILE* fp;
+    int i = 0;
+    int c;
+
+    if (dir)
+    {
+        closedir(dir);
+    }
+    else if (ENOENT == errno)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    fp = fopen(pathPtr, "r");
+    if (!fp)
+    {
+        return LE_IO_ERROR;
+    }
+
+    while (((c = fgetc(fp)) != EOF) && (i < (size - 1)))
+    {
+        attrPtr[i++] = c;
+    }
+    attrPtr[i] = '\0';
+    fclose(fp);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drive an output the way gpioSysfs_Activate() and gpioSysfs_Deactivate() did before keeping the
+ * files open: write "direction", then "value".
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LegacyDrive
+(
+    int pinNum,
+    bool active
+)
+{
+    char path[64];
+
+    snprintf(path, sizeof(path), "%s/gpio%d/%s", GPIO_PATH, pinNum, "direction");
+    if (LE_OK != LegacyWriteAttr(path, "out"))
+    {
+        return LE_IO_ERROR;
+    }
+
+    snprintf(path, sizeof(path), "%s/gpio%d/%s", GPIO_PATH, pinNum, "value");
+    return LegacyWriteAttr(path, active ? "1" : "0");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the service against the content of the emulated tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckService
+(
+    void
+)
+{
+    uint64_t values;
+    int pin;
+
+    LE_INFO("======== Check the service ========");
+
+    for (pin = 1; pin <= NB_PINS; pin++)
+    {
+        LE_ASSERT(gpioSysfs_IsPinAvailable(pin));
+    }
+    LE_ASSERT(!gpioSysfs_IsPinAvailable(NB_PINS + 1));
+
+    for (pin = 0; pin < NB_PINS; pin++)
+    {
+        gpioSysfs_SessionOpenHandlerFunc((pin < NB_PINS - 1) ? CLIENT_SESSION : OTHER_SESSION,
+                                         GpioRefs[pin]);
+        LE_ASSERT(GpioRefs[pin]->inUse);
+    }
+
+    // Single pin access
+    LE_ASSERT(gpioSysfs_IsInput(GpioRefs[0]));
+    LE_ASSERT(gpioSysfs_SetPushPullOutput(GpioRefs[0], SYSFS_ACTIVE_TYPE_HIGH, false) == LE_OK);
+    LE_ASSERT(AttrStartsWith(1, "direction", "out"));
+    LE_ASSERT(AttrStartsWith(1, "value", "0"));
+    LE_ASSERT(gpioSysfs_IsOutput(GpioRefs[0]));
+    LE_ASSERT(gpioSysfs_GetPolarity(GpioRefs[0]) == SYSFS_ACTIVE_TYPE_HIGH);
+
+    LE_ASSERT(gpioSysfs_Activate(GpioRefs[0]) == LE_OK);
+    LE_ASSERT(AttrStartsWith(1, "value", "1"));
+    LE_ASSERT(gpioSysfs_IsActive(GpioRefs[0]));
+    LE_ASSERT(gpioSysfs_ReadValue(GpioRefs[0]) == SYSFS_VALUE_HIGH);
+
+    LE_ASSERT(gpioSysfs_Deactivate(GpioRefs[0]) == LE_OK);
+    LE_ASSERT(AttrStartsWith(1, "value", "0"));
+    LE_ASSERT(gpioSysfs_ReadValue(GpioRefs[0]) == SYSFS_VALUE_LOW);
+
+    // A pin is switched to an output by Activate()
+    LE_ASSERT(gpioSysfs_Activate(GpioRefs[1]) == LE_OK);
+    LE_ASSERT(AttrStartsWith(2, "direction", "out"));
+    LE_ASSERT(AttrStartsWith(2, "value", "1"));
+
+    // Bank access
+    for (pin = 0; pin < NB_PINS; pin++)
+    {
+        LE_ASSERT(gpioSysfs_SetPushPullOutput(GpioRefs[pin], SYSFS_ACTIVE_TYPE_HIGH, false)
+                  == LE_OK);
+    }
+
+    LE_ASSERT(gpioSysfs_WritePins(GpioRefs, NB_PINS, CLIENT_SESSION, CLIENT_PINS_MASK, 0x55)
+              == LE_OK);
+    for (pin = 1; pin < NB_PINS; pin++)
+    {
+        LE_ASSERT(AttrStartsWith(pin, "value", (0x55 & (1 << (pin - 1))) ? "1" : "0"));
+    }
+
+    values = ~0ULL;
+    LE_ASSERT(gpioSysfs_ReadPins(GpioRefs, NB_PINS, CLIENT_SESSION, CLIENT_PINS_MASK, &values)
+              == LE_OK);
+    LE_ASSERT(values == (0x55 & CLIENT_PINS_MASK));
+
+    LE_ASSERT(gpioSysfs_ReadPins(GpioRefs, NB_PINS, CLIENT_SESSION, 0x6, &values) == LE_OK);
+    LE_ASSERT(values == (0x55 & 0x6));
+
+    // Pins held by another client, or out of range, are refused as a whole
+    LE_ASSERT(gpioSysfs_WritePins(GpioRefs, NB_PINS, CLIENT_SESSION, 0xff, 0xff)
+              == LE_NOT_PERMITTED);
+    LE_ASSERT(gpioSysfs_ReadPins(GpioRefs, NB_PINS, CLIENT_SESSION, 0x100, &values)
+              == LE_NOT_PERMITTED);
+    LE_ASSERT(AttrStartsWith(2, "value", "0"));
+    LE_ASSERT(gpioSysfs_WritePins(GpioRefs, NB_PINS, OTHER_SESSION, 0x80, 0x80) == LE_OK);
+    LE_ASSERT(AttrStartsWith(NB_PINS, "value", "1"));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the toggles of a pin, and of a bank of pins.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Bench
+(
+    void
+)
+{
+    char path[64];
+    char result[17];
+    le_clk_Time_t start;
+    double legacyUsec, usec;
+    int i, pin;
+
+    LE_INFO("======== Toggle pin 1, %d times ========", Toggles);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        LE_ASSERT(LegacyDrive(1, (i & 1) == 0) == LE_OK);
+    }
+    legacyUsec = ElapsedUsec(start);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        LE_ASSERT(((i & 1) ? gpioSysfs_Deactivate(GpioRefs[0]) : gpioSysfs_Activate(GpioRefs[0]))
+                  == LE_OK);
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("open/write/close: %.0f ns/toggle, persistent fds: %.0f ns/toggle (x%.1f)",
+            legacyUsec * 1000 / Toggles, usec * 1000 / Toggles, legacyUsec / usec);
+
+    LE_INFO("======== Read pin 1, %d times ========", Toggles);
+
+    snprintf(path, sizeof(path), "%s/gpio1/value", GPIO_PATH);
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        LE_ASSERT(LegacyReadAttr(path, sizeof(result), result) == LE_OK);
+    }
+    legacyUsec = ElapsedUsec(start);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        LE_ASSERT(gpioSysfs_ReadValue(GpioRefs[0]) != (gpioSysfs_Value_t)-1);
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("open/read/close: %.0f ns/read, persistent fds: %.0f ns/read (x%.1f)",
+            legacyUsec * 1000 / Toggles, usec * 1000 / Toggles, legacyUsec / usec);
+
+    LE_INFO("======== Toggle pins 1-%d, %d times ========", NB_PINS - 1, Toggles);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        for (pin = 0; pin < NB_PINS - 1; pin++)
+        {
+            LE_ASSERT(((i & 1) ? gpioSysfs_Deactivate(GpioRefs[pin]) :
+                                 gpioSysfs_Activate(GpioRefs[pin])) == LE_OK);
+        }
+    }
+    legacyUsec = ElapsedUsec(start);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < Toggles; i++)
+    {
+        LE_ASSERT(gpioSysfs_WritePins(GpioRefs, NB_PINS, CLIENT_SESSION, CLIENT_PINS_MASK,
+                                      (i & 1) ? 0 : CLIENT_PINS_MASK) == LE_OK);
+    }
+    usec = ElapsedUsec(start);
+
+    // On target, the pin by pin case also costs one IPC round trip per pin
+    LE_INFO("pin by pin: %.0f ns/toggle, bank: %.0f ns/toggle (x%.1f)",
+            legacyUsec * 1000 / Toggles, usec * 1000 / Toggles, legacyUsec / usec);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the sessions and remove the emulated tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Cleanup
+(
+    void
+)
+{
+    int pin;
+
+    for (pin = 0; pin < NB_PINS; pin++)
+    {
+        gpioSysfs_SessionCloseHandlerFunc(GpioRefs[pin]->currentSession, GpioRefs[pin]);
+        LE_ASSERT(!GpioRefs[pin]->inUse);
+        LE_ASSERT(GpioRefs[pin]->attrFdMask == 0);
+    }
+
+    le_dir_RemoveRecursive(BENCH_ROOT);
+}
+
+COMPONENT_INIT
+{
+    int pin;
+
+    le_arg_SetIntVar(&Toggles, "n", "toggles");
+    le_arg_Scan();
+
+    LE_ASSERT(Toggles > 0);
+
+    for (pin = 0; pin < NB_PINS; pin++)
+    {
+        snprintf(PinNames[pin], sizeof(PinNames[pin]), "gpio%d", pin + 1);
+        Pins[pin].pinNum = pin + 1;
+        Pins[pin].gpioName = PinNames[pin];
+        GpioRefs[pin] = &Pins[pin];
+    }
+
+    MakeTree();
+    CheckService();
+    Bench();
+    Cleanup();
+
+    LE_INFO("======== gpioSysfsBench PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,14 @@
+/**
+ * interfaces.h
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#ifndef _INTERFACES_H
+#define _INTERFACES_H
+
+#include "le_mdmDefs_interface.h"
+#include "le_sms_interface.h"
+
+#endif /* interfaces.h */
@@ -0,0 +1,284 @@
+/**
+ * This module benchmarks the 7 bits codecs of the SMS PDU module.
+ *
+ * Usage: smsPduBench [-n <messages>]
+ *
+ * Full length text messages, as sent by the segments of a concatenated SMS, are encoded in GSM and
+ * CDMA 7 bits PDUs and decoded back, and full Cell Broadcast pages are decoded. Each operation is
+ * timed over the given number of messages, and its result is checked.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "pa_sms.h"
+#include "smsPdu.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of characters of a full 7 bits message.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEXT_CHARS          160
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of characters of a full GSM 7 bits message holding two escape sequences.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GSM_TEXT_CHARS      (TEXT_CHARS - 2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of distinct texts, cycled through during the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NB_TEXTS            64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a GW Cell Broadcast page: a 6 bytes header and 82 bytes holding 93 septets.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CB_HEADER_SIZE      6
+#define CB_PAGE_SIZE        88
+#define CB_PAGE_CHARS       93
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destination of the messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_DEST          "+33661651866"
+
+#define DEFAULT_MESSAGES    100000
+
+static int NbMessages = DEFAULT_MESSAGES;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Texts of the messages, and their GSM and CDMA PDUs.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t Texts[NB_TEXTS][TEXT_CHARS];
+static pa_sms_Pdu_t GsmPdus[NB_TEXTS];
+static pa_sms_Pdu_t CdmaPdus[NB_TEXTS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cell Broadcast page.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t CbPage[CB_PAGE_SIZE];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the throughput of an operation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const char* labelPtr,       ///< [IN] operation
+    double      usec,           ///< [IN] time spent for all the messages
+    int         charsPerMessage ///< [IN] number of characters of a message
+)
+{
+    LE_INFO("%s: %.2f us/message, %.1f Mchars/s", labelPtr, usec / NbMessages,
+            ((double)NbMessages * charsPerMessage) / usec);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the texts: printable characters, a few of them encoded with an escape sequence in the
+ * GSM 7 bits default alphabet.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeTexts
+(
+    void
+)
+{
+    int i, j;
+
+    for (i = 0; i < NB_TEXTS; i++)
+    {
+        for (j = 0; j < TEXT_CHARS; j++)
+        {
+            Texts[i][j] = 'a' + (i + j) % 26;
+            if (0 == (j % 16))
+            {
+                Texts[i][j] = ' ';
+            }
+        }
+        // Two escape sequences among the first GSM_TEXT_CHARS characters, but none in a Cell
+        // Broadcast page
+        Texts[i][CB_PAGE_CHARS + (i % (GSM_TEXT_CHARS - CB_PAGE_CHARS - 1))] = '[';
+        Texts[i][GSM_TEXT_CHARS - 1] = ']';
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the encoding of the texts in 7 bits PDUs.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchEncode
+(
+    pa_sms_Protocol_t protocol,     ///< [IN] protocol
+    pa_sms_Pdu_t*     pdusPtr,      ///< [OUT] PDUs of the texts
+    int               length,       ///< [IN] number of characters to encode
+    const char*       labelPtr      ///< [IN] operation
+)
+{
+    smsPdu_DataToEncode_t data =
+    {
+        .protocol = protocol,
+        .addressPtr = BENCH_DEST,
+        .encoding = SMSPDU_7_BITS,
+        .messageType = PA_SMS_SUBMIT,
+        .statusReport = false,
+        .length = length,
+    };
+    le_clk_Time_t start;
+    int i;
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMessages; i++)
+    {
+        data.messagePtr = Texts[i % NB_TEXTS];
+        LE_ASSERT_OK(smsPdu_Encode(&data, &pdusPtr[i % NB_TEXTS]));
+    }
+    Report(labelPtr, ElapsedUsec(start), length);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the decoding of 7 bits PDUs, and check the decoded texts.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchDecode
+(
+    pa_sms_Protocol_t protocol,     ///< [IN] protocol
+    pa_sms_Pdu_t*     pdusPtr,      ///< [IN] PDUs of the texts
+    int               length,       ///< [IN] number of encoded characters
+    const char*       labelPtr      ///< [IN] operation
+)
+{
+    pa_sms_Message_t message;
+    le_clk_Time_t start;
+    int i;
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMessages; i++)
+    {
+        pa_sms_Pdu_t* pduPtr = &pdusPtr[i % NB_TEXTS];
+
+        LE_ASSERT_OK(smsPdu_Decode(protocol, pduPtr->data, pduPtr->dataLen, true, &message));
+    }
+    Report(labelPtr, ElapsedUsec(start), length);
+
+    for (i = 0; i < NB_TEXTS; i++)
+    {
+        LE_ASSERT_OK(smsPdu_Decode(protocol, pdusPtr[i].data, pdusPtr[i].dataLen, true,
+                                   &message));
+        LE_ASSERT(PA_SMS_SUBMIT == message.type);
+        LE_ASSERT(message.smsSubmit.dataLen == length);
+        LE_ASSERT(0 == memcmp(message.smsSubmit.data, Texts[i], length));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the decoding of a Cell Broadcast page, and check the decoded text.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchDecodeCb
+(
+    void
+)
+{
+    smsPdu_DataToEncode_t data =
+    {
+        .protocol = PA_SMS_PROTOCOL_GSM,
+        .messagePtr = Texts[0],
+        .addressPtr = BENCH_DEST,
+        .encoding = SMSPDU_7_BITS,
+        .messageType = PA_SMS_SUBMIT,
+        .statusReport = false,
+        .length = CB_PAGE_CHARS,
+    };
+    int udSize = (CB_PAGE_CHARS * 7 + 7) / 8;
+    pa_sms_Pdu_t pdu;
+    pa_sms_Message_t message;
+    le_clk_Time_t start;
+    int i;
+
+    // SN, MI, DCS (GSM 7 bits default alphabet) and PP
+    CbPage[0] = 0x00;
+    CbPage[1] = 0x01;
+    CbPage[2] = 0x00;
+    CbPage[3] = 0x32;
+    CbPage[4] = 0x00;
+    CbPage[5] = 0x11;
+
+    // The page holds the user data of a message with the beginning of the first text
+    LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+    memcpy(&CbPage[CB_HEADER_SIZE], &pdu.data[pdu.dataLen - udSize], udSize);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMessages; i++)
+    {
+        LE_ASSERT_OK(smsPdu_Decode(PA_SMS_PROTOCOL_GW_CB, CbPage, sizeof(CbPage), false,
+                                   &message));
+    }
+    Report("decode GSM Cell Broadcast", ElapsedUsec(start), CB_PAGE_CHARS);
+
+    LE_ASSERT(PA_SMS_CELL_BROADCAST == message.type);
+    LE_ASSERT(message.cellBroadcast.dataLen == CB_PAGE_CHARS);
+    LE_ASSERT(0 == memcmp(message.cellBroadcast.data, Texts[0], CB_PAGE_CHARS));
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&NbMessages, "n", "messages");
+    le_arg_Scan();
+
+    LE_ASSERT(NbMessages > 0);
+
+    smsPdu_Initialize();
+    MakeTexts();
+
+    LE_INFO("======== GSM 7 bits, %d messages of %d characters ========",
+            NbMessages, GSM_TEXT_CHARS);
+
+    BenchEncode(PA_SMS_PROTOCOL_GSM, GsmPdus, GSM_TEXT_CHARS, "encode GSM SMS-SUBMIT");
+    BenchDecode(PA_SMS_PROTOCOL_GSM, GsmPdus, GSM_TEXT_CHARS, "decode GSM SMS-SUBMIT");
+    BenchDecodeCb();
+
+    LE_INFO("======== CDMA 7 bits, %d messages of %d characters ========",
+            NbMessages, TEXT_CHARS);
+
+    BenchEncode(PA_SMS_PROTOCOL_CDMA, CdmaPdus, TEXT_CHARS, "encode CDMA SMS-SUBMIT");
+    BenchDecode(PA_SMS_PROTOCOL_CDMA, CdmaPdus, TEXT_CHARS, "decode CDMA SMS-SUBMIT");
+
+    LE_INFO("======== smsPduBench PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -161,6 +161,9 @@ COMPONENT_INIT
     LE_INFO("======== SMS PDU Test ========");
     testle_sms_SmsPduTest();
 
+    LE_INFO("======== SMS PDU Fuzz Test ========");
+    testle_sms_SmsPduFuzzTest();
+
     LE_INFO("======== SMS API Unit Test ========");
     testle_sms_SmsApiUnitTest();
 
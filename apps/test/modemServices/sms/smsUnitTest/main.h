@@ -33,6 +33,18 @@ void testle_sms_SmsPduTest
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/*
+ * SMS PDU 7 bits codecs fuzz test
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+void testle_sms_SmsPduFuzzTest
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /*
  * CDMA SMS PDU encoding and decoding test
@@ -0,0 +1,502 @@
+/**
+ * This module implements the fuzz tests of the 7 bits codecs of the SMS PDU module.
+ *
+ * Random messages are encoded and decoded with smsPdu_Encode() and smsPdu_Decode(), and their user
+ * data are checked against the reference implementation below, which is the original codec packing
+ * and unpacking the septets one character at a time.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include <legato.h>
+#include "interfaces.h"
+
+#include "pa_sms.h"
+#include "smsPdu.h"
+#include "main.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of random messages per test
+ */
+//--------------------------------------------------------------------------------------------------
+#define FUZZ_ITERATIONS     10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Seed of the random messages, so that a failure can be reproduced
+ */
+//--------------------------------------------------------------------------------------------------
+#define FUZZ_SEED           0x5E97E75
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of characters of a text message
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEXT_MAX_CHARS      160
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Margin left after the reference buffers: the reference encoder writes up to 2 bytes past the
+ * end of its buffer before reporting an overflow, and the reference decoder reads the septet
+ * following the data when the last one is an escape.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REF_MARGIN          8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the header of a GW Cell Broadcast PDU
+ */
+//--------------------------------------------------------------------------------------------------
+#define CB_HEADER_SIZE      6
+
+/* Define Non-Printable Characters as a question mark */
+#define NPC8    '?'
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Conversion tables of the SMS PDU module.
+ */
+//--------------------------------------------------------------------------------------------------
+extern const uint8_t Ascii8to7[];
+extern const uint8_t Ascii7to8[];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Characters encoded with an escape sequence in the GSM 7 bits default alphabet.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char EscapedChars[] = "\f^{}\\[~]|";
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference implementation: read a GSM 7 bits character.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int RefRead7Bits
+(
+    const uint8_t* bufferPtr,
+    uint32_t       pos
+)
+{
+    int a = bufferPtr[pos/8] >> (pos&7);
+    int b = 0;
+    if ((pos&7) > 1) {
+        b = bufferPtr[(pos/8)+1] << (8-(pos&7));
+    }
+
+    return (a|b) & 0x7F;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference implementation: write a GSM 7 bits character.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RefWrite7Bits
+(
+    uint8_t* bufferPtr,
+    uint8_t  val,
+    uint32_t pos
+)
+{
+    val &= 0x7F;
+    uint8_t idx = pos/8;
+
+
+    if (!(pos&7)) {
+        bufferPtr[idx] = val;
+    }
+    else if ((pos&7) == 1) {
+        bufferPtr[idx] = bufferPtr[idx] | (val<<1);
+    }
+    else {
+        bufferPtr[idx] = bufferPtr[idx] | (val<<(pos&7));
+        bufferPtr[idx+1] = (val>>(8-(pos&7)));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference implementation: convert an ascii array into a 7bits array.
+ *
+ * @return the size of the a7bit string, or LE_OVERFLOW if a7bitPtr is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t RefConvert8BitsTo7Bits
+(
+    const uint8_t *a8bitPtr,    ///< [IN] 8bits array to convert
+    int            length,      ///< [IN] size of 8bits byte conversion
+    uint8_t       *a7bitPtr,    ///< [OUT] 7bits array result
+    size_t         a7bitSize,   ///< [IN] 7bits array size
+    uint8_t       *a7bitsNumber ///< [OUT] number of char in &7bitsPtr
+)
+{
+    int read;
+    int write = 0;
+    int size = 0;
+
+    for (read = 0; read < length; ++read)
+    {
+        uint8_t byte = Ascii8to7[a8bitPtr[read]];
+
+        /* Escape */
+        if (byte >= 128)
+        {
+            if (size>a7bitSize)
+            {
+                return LE_OVERFLOW;
+            }
+
+            RefWrite7Bits(a7bitPtr, 0x1B, write*7);
+            write++;
+            byte -= 128;
+        }
+
+        if (size>a7bitSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        RefWrite7Bits(a7bitPtr, byte, write*7);
+        write++;
+
+        /* Number of 8 bit chars */
+        size = (write * 7);
+        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
+    }
+
+    if (size>a7bitSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    /* Number of written chars */
+    *a7bitsNumber = write;
+
+    return size;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference implementation: convert a 7bit array into a ascii array.
+ *
+ * @return the size of the ascii array, of LE_OVERFLOW if a8bitPtr is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t RefConvert7BitsTo8Bits
+(
+    const uint8_t *a7bitPtr,     ///< [IN] 7bits array to convert
+    int            length,       ///< [IN] size of 7bits byte conversion
+    uint8_t       *a8bitPtr,     ///< [OUT] 8bits array restul
+    size_t         a8bitSize     ///< [IN] 8bits array size.
+)
+{
+    int r;
+    int w;
+
+    w = 0;
+    for (r = 0; r < length; r++)
+    {
+        uint8_t byte = RefRead7Bits(a7bitPtr, r*7);
+        byte = Ascii7to8[byte];
+
+        if (byte != 27)
+        {
+            if (w < a8bitSize)
+            {
+                a8bitPtr[w] = byte;
+                w++;
+            }
+            else
+            {
+                return LE_OVERFLOW;
+            }
+        }
+        else
+        {
+            /* If we're escaped then the next byte have a special meaning. */
+            r++;
+
+            byte = RefRead7Bits(a7bitPtr, r*7);
+            if (w < a8bitSize)
+            {
+                switch (byte)
+                {
+                    case 10:
+                        a8bitPtr[w] = 12;
+                        break;
+                    case 20:
+                        a8bitPtr[w] = '^';
+                        break;
+                    case 40:
+                        a8bitPtr[w] = '{';
+                        break;
+                    case 41:
+                        a8bitPtr[w] = '}';
+                        break;
+                    case 47:
+                        a8bitPtr[w] = '\\';
+                        break;
+                    case 60:
+                        a8bitPtr[w] = '[';
+                        break;
+                    case 61:
+                        a8bitPtr[w] = '~';
+                        break;
+                    case 62:
+                        a8bitPtr[w] = ']';
+                        break;
+                    case 64:
+                        a8bitPtr[w] = '|';
+                        break;
+                    default:
+                        a8bitPtr[w] = NPC8;
+                        break;
+                }
+                w++;
+            }
+            else
+            {
+                return LE_OVERFLOW;
+            }
+        }
+    }
+
+    return w;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a buffer with a random text: mostly printable characters, with characters encoded with an
+ * escape sequence and any ISO-8859-1 character.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RandomText
+(
+    uint8_t* textPtr,   ///< [OUT] text
+    int      length     ///< [IN] number of characters
+)
+{
+    int i;
+
+    for (i = 0; i < length; i++)
+    {
+        int draw = rand() % 10;
+
+        if (draw < 7)
+        {
+            textPtr[i] = ' ' + rand() % ('~' - ' ' + 1);
+        }
+        else if (draw < 8)
+        {
+            textPtr[i] = EscapedChars[rand() % (sizeof(EscapedChars) - 1)];
+        }
+        else
+        {
+            textPtr[i] = rand() % 256;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode random texts in GSM 7 bits SMS-SUBMIT PDUs, and decode them back.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FuzzGsm7Bits
+(
+    void
+)
+{
+    uint8_t text[TEXT_MAX_CHARS];
+    uint8_t expectedUd[LE_SMS_PDU_MAX_PAYLOAD + REF_MARGIN];
+    uint8_t expectedText[LE_SMS_TEXT_MAX_BYTES + REF_MARGIN];
+    pa_sms_Pdu_t pdu;
+    pa_sms_Message_t message;
+    smsPdu_DataToEncode_t data =
+    {
+        .protocol = PA_SMS_PROTOCOL_GSM,
+        .messagePtr = text,
+        .addressPtr = "+33661651866",
+        .encoding = SMSPDU_7_BITS,
+        .messageType = PA_SMS_SUBMIT,
+        .statusReport = false,
+    };
+    int headerSize = -1;
+    int nbOverflows = 0;
+    int i;
+
+    for (i = 0; i < FUZZ_ITERATIONS; i++)
+    {
+        int length = 1 + rand() % TEXT_MAX_CHARS;
+        uint8_t septets = 0;
+        int32_t udSize;
+        int32_t textSize;
+        int udPos;
+
+        RandomText(text, length);
+        data.length = length;
+
+        udSize = RefConvert8BitsTo7Bits(text, length, expectedUd, LE_SMS_PDU_MAX_PAYLOAD,
+                                        &septets);
+
+        memset(&pdu, 0, sizeof(pdu));
+        if (LE_OVERFLOW == udSize)
+        {
+            LE_ASSERT(smsPdu_Encode(&data, &pdu) == LE_OVERFLOW);
+            nbOverflows++;
+            continue;
+        }
+        LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+
+        // The user data end the PDU, after the TP-UDL byte
+        udPos = pdu.dataLen - udSize;
+        if (headerSize < 0)
+        {
+            headerSize = udPos;
+        }
+        LE_ASSERT(udPos == headerSize);
+        LE_ASSERT(pdu.data[udPos - 1] == septets);
+        LE_ASSERT(0 == memcmp(&pdu.data[udPos], expectedUd, udSize));
+
+        textSize = RefConvert7BitsTo8Bits(&pdu.data[udPos], septets, expectedText,
+                                          sizeof(message.smsSubmit.data));
+        LE_ASSERT(textSize > 0);
+
+        LE_ASSERT_OK(smsPdu_Decode(PA_SMS_PROTOCOL_GSM, pdu.data, pdu.dataLen, true, &message));
+        LE_ASSERT(PA_SMS_SUBMIT == message.type);
+        LE_ASSERT(LE_SMS_FORMAT_TEXT == message.smsSubmit.format);
+        LE_ASSERT(message.smsSubmit.dataLen == textSize);
+        LE_ASSERT(0 == memcmp(message.smsSubmit.data, expectedText, textSize));
+    }
+
+    LE_INFO("%d GSM 7 bits messages checked, %d overflows", FUZZ_ITERATIONS, nbOverflows);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode GW Cell Broadcast PDUs holding random septets.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FuzzGwCb7Bits
+(
+    void
+)
+{
+    uint8_t pdu[CB_HEADER_SIZE + LE_SMS_TEXT_MAX_BYTES + REF_MARGIN];
+    uint8_t expectedText[LE_SMS_TEXT_MAX_BYTES + REF_MARGIN];
+    pa_sms_Message_t message;
+    int nbOverflows = 0;
+    int i, j;
+
+    for (i = 0; i < FUZZ_ITERATIONS; i++)
+    {
+        // Up to 182 septets, which may overflow the decoded text
+        int payloadSize = 1 + rand() % LE_SMS_TEXT_MAX_LEN;
+        int32_t textSize;
+
+        for (j = 0; j < sizeof(pdu); j++)
+        {
+            pdu[j] = rand() % 256;
+        }
+        // Data Coding Scheme: GSM 7 bits default alphabet
+        pdu[4] = 0x00;
+
+        textSize = RefConvert7BitsTo8Bits(&pdu[CB_HEADER_SIZE], (payloadSize * 8) / 7,
+                                          expectedText, sizeof(message.cellBroadcast.data));
+
+        if (LE_OVERFLOW == textSize)
+        {
+            LE_ASSERT(smsPdu_Decode(PA_SMS_PROTOCOL_GW_CB, pdu, CB_HEADER_SIZE + payloadSize,
+                                    false, &message) == LE_OVERFLOW);
+            nbOverflows++;
+            continue;
+        }
+
+        LE_ASSERT_OK(smsPdu_Decode(PA_SMS_PROTOCOL_GW_CB, pdu, CB_HEADER_SIZE + payloadSize,
+                                   false, &message));
+        LE_ASSERT(PA_SMS_CELL_BROADCAST == message.type);
+        LE_ASSERT(LE_SMS_FORMAT_TEXT == message.cellBroadcast.format);
+        LE_ASSERT(message.cellBroadcast.dataLen == textSize);
+        LE_ASSERT(0 == memcmp(message.cellBroadcast.data, expectedText, textSize));
+    }
+
+    LE_INFO("%d Cell Broadcast messages checked, %d overflows", FUZZ_ITERATIONS, nbOverflows);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode random texts in CDMA 7 bits PDUs, and decode them back.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FuzzCdma7Bits
+(
+    void
+)
+{
+    uint8_t text[TEXT_MAX_CHARS];
+    pa_sms_Pdu_t pdu;
+    pa_sms_Message_t message;
+    smsPdu_DataToEncode_t data =
+    {
+        .protocol = PA_SMS_PROTOCOL_CDMA,
+        .messagePtr = text,
+        .addressPtr = "+33661651866",
+        .encoding = SMSPDU_7_BITS,
+        .messageType = PA_SMS_SUBMIT,
+        .statusReport = false,
+    };
+    int i, j;
+
+    for (i = 0; i < FUZZ_ITERATIONS; i++)
+    {
+        int length = 1 + rand() % TEXT_MAX_CHARS;
+
+        // 7 bits ASCII
+        for (j = 0; j < length; j++)
+        {
+            text[j] = 1 + rand() % 127;
+        }
+        data.length = length;
+
+        memset(&pdu, 0, sizeof(pdu));
+        LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+
+        LE_ASSERT_OK(smsPdu_Decode(PA_SMS_PROTOCOL_CDMA, pdu.data, pdu.dataLen, true, &message));
+        LE_ASSERT(PA_SMS_SUBMIT == message.type);
+        LE_ASSERT(LE_SMS_FORMAT_TEXT == message.smsSubmit.format);
+        LE_ASSERT(message.smsSubmit.dataLen == length);
+        LE_ASSERT(0 == memcmp(message.smsSubmit.data, text, length));
+    }
+
+    LE_INFO("%d CDMA 7 bits messages checked", FUZZ_ITERATIONS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * SMS PDU 7 bits codecs fuzz test
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+void testle_sms_SmsPduFuzzTest
+(
+    void
+)
+{
+    srand(FUZZ_SEED);
+
+    LE_INFO("Fuzz GSM 7 bits codec");
+    FuzzGsm7Bits();
+
+    LE_INFO("Fuzz Cell Broadcast 7 bits decoder");
+    FuzzGwCb7Bits();
+
+    LE_INFO("Fuzz CDMA 7 bits codec");
+    FuzzCdma7Bits();
+
+    LE_INFO("smsPduFuzzTest SUCCESS");
+}
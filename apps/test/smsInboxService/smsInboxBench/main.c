@@ -0,0 +1,332 @@
+/**
+ * This module benchmarks the message store of the smsInbox service.
+ *
+ * Usage: smsInboxBench [-n <messages>] [--reload]
+ *
+ * The service is linked with stubs of the sms, sim and cfg services: text SMS are handed directly
+ * to its reception handler, and its message boxes hold 10000 messages. The store is kept under
+ * /dev/shm/smsInboxBench (see smsInboxServiceComp/Component.cdef), which is a tmpfs on most
+ * systems, so that the figures show the cost of the service rather than the cost of the flash.
+ *
+ * The store is first wiped, then the reception of the messages, the browsing of a message box,
+ * the reading of the messages, marking them as read and deleting half of them are timed. The
+ * content of the message box is checked at each step, and a message received while browsing it
+ * must be left out of the browse.
+ *
+ * With --reload, the store left by a previous run with the same number of messages is loaded
+ * instead, and its content is checked.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store directory. It must match SMSINBOX_PATH in smsInboxServiceComp/Component.cdef.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT          "/dev/shm/smsInboxBench"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the message boxes, as returned by the cfg stub.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_MBOX_SIZE     10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sender of the messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_TEL           "+33612345678"
+
+#define DEFAULT_MESSAGES    10000
+
+static int NbMessages = DEFAULT_MESSAGES;
+static int NbMboxMessages;
+static bool Reload = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message box of the benchmark
+ */
+//--------------------------------------------------------------------------------------------------
+static le_smsInbox1_SessionRef_t MboxRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identifiers of the messages of the message box, in reception order
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t* MsgIds;
+static int NbMsgIds;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the text of a message. The stored messages are numbered from 1, like the identifiers
+ * given by a new store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeText
+(
+    uint32_t number,
+    char* textPtr,
+    size_t textSize
+)
+{
+    snprintf(textPtr, textSize, "Benchmark message %08u, sent from the smsInbox benchmark",
+             number);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Browse the message box into MsgIds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Browse
+(
+    void
+)
+{
+    uint32_t msgId;
+
+    NbMsgIds = 0;
+    for (msgId = le_smsInbox1_GetFirst(MboxRef); msgId; msgId = le_smsInbox1_GetNext(MboxRef))
+    {
+        LE_ASSERT(NbMsgIds < BENCH_MBOX_SIZE);
+        LE_ASSERT((0 == NbMsgIds) || (msgId > MsgIds[NbMsgIds - 1]));
+        MsgIds[NbMsgIds++] = msgId;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the messages of the message box.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMessages
+(
+    int step,               ///< Expected step between the numbers of the messages
+    bool isUnread           ///< Expected read status, checked before reading the messages
+)
+{
+    char text[LE_SMS_TEXT_MAX_BYTES];
+    char expectedText[LE_SMS_TEXT_MAX_BYTES];
+    char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+    int i;
+
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        // The oldest messages were evicted
+        uint32_t number = NbMessages - (NbMsgIds - 1 - i) * step;
+
+        LE_ASSERT(MsgIds[i] == number);
+        LE_ASSERT(le_smsInbox1_IsUnread(MsgIds[i]) == isUnread);
+        LE_ASSERT(le_smsInbox1_GetFormat(MsgIds[i]) == LE_SMS_FORMAT_TEXT);
+        LE_ASSERT_OK(le_smsInbox1_GetSenderTel(MsgIds[i], tel, sizeof(tel)));
+        LE_ASSERT(0 == strcmp(tel, BENCH_TEL));
+
+        MakeText(number, expectedText, sizeof(expectedText));
+        LE_ASSERT_OK(le_smsInbox1_GetText(MsgIds[i], text, sizeof(text)));
+        LE_ASSERT(0 == strcmp(text, expectedText));
+        LE_ASSERT(le_smsInbox1_GetMsgLen(MsgIds[i]) == strlen(expectedText));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the operations on a new store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Bench
+(
+    void
+)
+{
+    char text[LE_SMS_TEXT_MAX_BYTES];
+    le_clk_Time_t start;
+    double usec;
+    int i, nbDeleted;
+
+    le_dir_RemoveRecursive(BENCH_ROOT);
+
+    MboxRef = le_smsInbox1_Open();
+    LE_ASSERT(MboxRef != NULL);
+
+    LE_INFO("======== Receive %d messages ========", NbMessages);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 1; i <= NbMessages; i++)
+    {
+        MakeText(i, text, sizeof(text));
+        BenchStub_ReceiveText(BENCH_TEL, text);
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("receive: %.1f us/message", usec / NbMessages);
+
+    LE_INFO("======== Browse the message box ========");
+
+    start = le_clk_GetRelativeTime();
+    Browse();
+    usec = ElapsedUsec(start);
+
+    LE_ASSERT(NbMsgIds == NbMboxMessages);
+    LE_INFO("browse: %.0f us for %d messages", usec, NbMsgIds);
+
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        LE_ASSERT(le_smsInbox1_IsUnread(MsgIds[i]));
+    }
+
+    LE_INFO("======== Read the messages ========");
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        LE_ASSERT_OK(le_smsInbox1_GetText(MsgIds[i], text, sizeof(text)));
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("get text (1st read, marks the message as read): %.1f us/message", usec / NbMsgIds);
+
+    CheckMessages(1, false);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        LE_ASSERT_OK(le_smsInbox1_GetText(MsgIds[i], text, sizeof(text)));
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("get text (already read): %.1f us/message", usec / NbMsgIds);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        le_smsInbox1_MarkUnread(MsgIds[i]);
+    }
+    for (i = 0; i < NbMsgIds; i++)
+    {
+        le_smsInbox1_MarkRead(MsgIds[i]);
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("mark unread then read: %.1f us/message", usec / NbMsgIds);
+
+    LE_INFO("======== Delete half of the messages ========");
+
+    // Delete the messages whose number has not the parity of the last one
+    start = le_clk_GetRelativeTime();
+    nbDeleted = 0;
+    for (i = NbMsgIds - 2; i >= 0; i -= 2)
+    {
+        le_smsInbox1_DeleteMsg(MsgIds[i]);
+        nbDeleted++;
+    }
+    usec = ElapsedUsec(start);
+
+    LE_INFO("delete: %.1f us/message", usec / nbDeleted);
+
+    Browse();
+    LE_ASSERT(NbMsgIds == NbMboxMessages - nbDeleted);
+    CheckMessages(2, false);
+
+    LE_INFO("======== Receive a message while browsing ========");
+
+    // The message received after GetFirst() is left out of the browse
+    LE_ASSERT(le_smsInbox1_GetFirst(MboxRef) == MsgIds[0]);
+    MakeText(NbMessages + 1, text, sizeof(text));
+    BenchStub_ReceiveText(BENCH_TEL, text);
+    for (i = 1; i < NbMsgIds; i++)
+    {
+        LE_ASSERT(le_smsInbox1_GetNext(MboxRef) == MsgIds[i]);
+    }
+    LE_ASSERT(le_smsInbox1_GetNext(MboxRef) == 0);
+
+    // It is found by the next browse, then deleted to leave the store checked with --reload
+    Browse();
+    LE_ASSERT(NbMsgIds == NbMboxMessages - nbDeleted + 1);
+    LE_ASSERT(MsgIds[NbMsgIds - 1] == (uint32_t)NbMessages + 1);
+    le_smsInbox1_DeleteMsg(MsgIds[NbMsgIds - 1]);
+
+    le_smsInbox1_Close(MboxRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the loading of the store left by Bench().
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchReload
+(
+    void
+)
+{
+    le_clk_Time_t start;
+    double usec;
+
+    LE_INFO("======== Load the message store ========");
+
+    // The store is loaded when the first message box is opened
+    start = le_clk_GetRelativeTime();
+    MboxRef = le_smsInbox1_Open();
+    usec = ElapsedUsec(start);
+
+    LE_ASSERT(MboxRef != NULL);
+
+    Browse();
+    LE_ASSERT(NbMsgIds == (NbMboxMessages + 1) / 2);
+    LE_INFO("load: %.0f us, %d messages in the message box", usec, NbMsgIds);
+
+    CheckMessages(2, false);
+
+    le_smsInbox1_Close(MboxRef);
+    le_dir_RemoveRecursive(BENCH_ROOT);
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&NbMessages, "n", "messages");
+    le_arg_SetFlagVar(&Reload, NULL, "reload");
+    le_arg_Scan();
+
+    LE_ASSERT(NbMessages > 0);
+    NbMboxMessages = (NbMessages < BENCH_MBOX_SIZE) ? NbMessages : BENCH_MBOX_SIZE;
+
+    MsgIds = calloc(BENCH_MBOX_SIZE, sizeof(uint32_t));
+    LE_ASSERT(MsgIds != NULL);
+
+    if (Reload)
+    {
+        BenchReload();
+    }
+    else
+    {
+        Bench();
+    }
+
+    free(MsgIds);
+
+    LE_INFO("======== smsInboxBench PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,348 @@
+/**
+ * This module implements the sms, sim and cfg stubs of the smsInbox service benchmark.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the message boxes, as read from the config tree.
+ *
+ * It is above the limit of le_smsInbox_SetMaxMessages(), to bench large message boxes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_MBOX_SIZE     10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulated SMS. A message reference points to it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* telPtr;         ///< Sender telephone number
+    const char* textPtr;        ///< Message text
+}
+BenchSms_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler registered by the service for new SMS.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_RxMessageHandlerFunc_t RxHandlerPtr;
+static void* RxContextPtr;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the reception of a text SMS by the modem.
+ */
+//--------------------------------------------------------------------------------------------------
+void BenchStub_ReceiveText
+(
+    const char* telPtr,
+    const char* textPtr
+)
+{
+    BenchSms_t sms = { .telPtr = telPtr, .textPtr = textPtr };
+
+    LE_ASSERT(RxHandlerPtr != NULL);
+    RxHandlerPtr((le_sms_MsgRef_t)&sms, RxContextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server service and client session references (STUBBED FUNCTIONS)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_smsInbox1_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+le_msg_ServiceRef_t le_smsInbox2_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+le_msg_SessionRef_t le_smsInbox1_GetClientSessionRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+le_msg_SessionRef_t le_smsInbox2_GetClientSessionRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registers a function to be called whenever one of this service's sessions is closed by
+ * the client. (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t MyAddServiceCloseHandler
+(
+    le_msg_ServiceRef_t             serviceRef,
+    le_msg_SessionEventHandler_t    handlerFunc,
+    void*                           contextPtr
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_sms stubs: the simulated SMS are text messages.
+ */
+//--------------------------------------------------------------------------------------------------
+le_sms_RxMessageHandlerRef_t le_sms_AddRxMessageHandler
+(
+    le_sms_RxMessageHandlerFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    RxHandlerPtr = handlerPtr;
+    RxContextPtr = contextPtr;
+
+    return (le_sms_RxMessageHandlerRef_t)1;
+}
+
+le_sms_Format_t le_sms_GetFormat
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+    return LE_SMS_FORMAT_TEXT;
+}
+
+le_result_t le_sms_GetSenderTel
+(
+    le_sms_MsgRef_t msgRef,
+    char* tel,
+    size_t telSize
+)
+{
+    return le_utf8_Copy(tel, ((BenchSms_t*)msgRef)->telPtr, telSize, NULL);
+}
+
+le_result_t le_sms_GetTimeStamp
+(
+    le_sms_MsgRef_t msgRef,
+    char* timestamp,
+    size_t timestampSize
+)
+{
+    return le_utf8_Copy(timestamp, "17/08/29,18:36:41+22", timestampSize, NULL);
+}
+
+size_t le_sms_GetUserdataLen
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+    return strlen(((BenchSms_t*)msgRef)->textPtr);
+}
+
+le_result_t le_sms_GetText
+(
+    le_sms_MsgRef_t msgRef,
+    char* text,
+    size_t textSize
+)
+{
+    return le_utf8_Copy(text, ((BenchSms_t*)msgRef)->textPtr, textSize, NULL);
+}
+
+le_result_t le_sms_GetBinary
+(
+    le_sms_MsgRef_t msgRef,
+    uint8_t* binPtr,
+    size_t* binSizePtr
+)
+{
+    return LE_FORMAT_ERROR;
+}
+
+le_result_t le_sms_GetPDU
+(
+    le_sms_MsgRef_t msgRef,
+    uint8_t* pduPtr,
+    size_t* pduSizePtr
+)
+{
+    return LE_FORMAT_ERROR;
+}
+
+size_t le_sms_GetPDULen
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+    return 0;
+}
+
+le_sms_MsgListRef_t le_sms_CreateRxMsgList
+(
+    void
+)
+{
+    return NULL;
+}
+
+le_sms_MsgRef_t le_sms_GetFirst
+(
+    le_sms_MsgListRef_t msgListRef
+)
+{
+    return NULL;
+}
+
+le_sms_MsgRef_t le_sms_GetNext
+(
+    le_sms_MsgListRef_t msgListRef
+)
+{
+    return NULL;
+}
+
+void le_sms_DeleteList
+(
+    le_sms_MsgListRef_t msgListRef
+)
+{
+}
+
+le_result_t le_sms_DeleteFromStorage
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+    return LE_OK;
+}
+
+void le_sms_Delete
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_sim stubs: the SIM is never ready, so the service does not read the SMS stored on it.
+ */
+//--------------------------------------------------------------------------------------------------
+le_sim_NewStateHandlerRef_t le_sim_AddNewStateHandler
+(
+    le_sim_NewStateHandlerFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    return NULL;
+}
+
+le_sim_Id_t le_sim_GetSelectedCard
+(
+    void
+)
+{
+    return LE_SIM_EXTERNAL_SLOT_1;
+}
+
+le_sim_States_t le_sim_GetState
+(
+    le_sim_Id_t simId
+)
+{
+    return LE_SIM_INSERTED;
+}
+
+le_result_t le_sim_GetIMSI
+(
+    le_sim_Id_t simId,
+    char* imsi,
+    size_t imsiSize
+)
+{
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_cfg stubs: every message box holds BENCH_MBOX_SIZE messages.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_IteratorRef_t le_cfg_CreateReadTxn
+(
+    const char* basePath
+)
+{
+    return NULL;
+}
+
+le_cfg_IteratorRef_t le_cfg_CreateWriteTxn
+(
+    const char* basePath
+)
+{
+    return NULL;
+}
+
+bool le_cfg_NodeExists
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path
+)
+{
+    return true;
+}
+
+int32_t le_cfg_GetInt
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    int32_t defaultValue
+)
+{
+    return BENCH_MBOX_SIZE;
+}
+
+void le_cfg_SetInt
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    int32_t value
+)
+{
+}
+
+void le_cfg_CancelTxn
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+}
+
+void le_cfg_CommitTxn
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+}
@@ -213,6 +213,38 @@ static void WriteBits
     return;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the number of bits specified by length from a read buffer into a write buffer.
+ *
+ * The bits are moved by chunks of 24 bits, whatever the size of the characters they hold: this is
+ * the largest chunk that ReadBits() can add to a non empty cache.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CopyBits
+(
+    readBitsBuffer_t*  readBufferPtr,
+    writeBitsBuffer_t* writeBufferPtr,
+    uint32_t           length
+)
+{
+    // Stay away from the end of the write buffer with large chunks, where WriteBits() checks the
+    // remaining space byte by byte
+    while ((length >= 24) && ((writeBufferPtr->index + 3) < writeBufferPtr->bufferSize))
+    {
+        WriteBits(writeBufferPtr, ReadBits(readBufferPtr, 24), 24);
+        length -= 24;
+    }
+
+    while (length > 0)
+    {
+        uint8_t chunkLength = (length > 8) ? 8 : length;
+
+        WriteBits(writeBufferPtr, ReadBits(readBufferPtr, chunkLength), chunkLength);
+        length -= chunkLength;
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read the Teleservice Identifier structure.
@@ -546,7 +578,6 @@ static void ReadSubParameterUserData
     cdmaSmsPtr->message.bearerData.userData.fieldsNumber = fieldsNumber;
 
     uint8_t charBitSize;
-    uint8_t index;
     switch (encoding)
     {
         case CDMAPDU_ENCODING_7BIT_ASCII: charBitSize = 7; break;
@@ -573,12 +604,8 @@ static void ReadSubParameterUserData
         cdmaSmsPtr->message.bearerData.userData.chari,
         sizeof(cdmaSmsPtr->message.bearerData.userData.chari));
 
-    for (index = 0;
-         totalBitSize>0;
-         totalBitSize-=charBitSize, index++)
-    {
-        WriteBits(&buffer,ReadBits(decoderPtr,charBitSize),charBitSize);
-    }
+    // The characters are contiguous: copy them as a single bit field
+    CopyBits(decoderPtr, &buffer, totalBitSize);
     WritePadding(&buffer);
 
     // User data is available
@@ -1755,7 +1782,6 @@ static void WriteSubParameterUserData
     WriteBits(encoderPtr,cdmaSmsPtr->message.bearerData.userData.fieldsNumber,8);
 
     uint8_t charBitSize;
-    uint8_t index;
     switch (encoding)
     {
         case CDMAPDU_ENCODING_7BIT_ASCII: charBitSize = 7; break;
@@ -1773,12 +1799,8 @@ static void WriteSubParameterUserData
     readBitsBuffer_t buffer;
     InitializeReadBuffer(&buffer,cdmaSmsPtr->message.bearerData.userData.chari);
 
-    for (index = 0;
-         totalBitSize>0;
-         totalBitSize-=charBitSize, index++)
-    {
-        WriteBits(encoderPtr,ReadBits(&buffer,charBitSize),charBitSize);
-    }
+    // The characters are contiguous: copy them as a single bit field
+    CopyBits(&buffer, encoderPtr, totalBitSize);
     WritePadding(encoderPtr);
 
     // update the TLV Length value
@@ -507,8 +507,7 @@ const uint8_t Ascii7to8[] = {
     252,        /*  126    ü  LATIN SMALL LETTER U WITH DIAERESIS     */
     224         /*  127    à  LATIN SMALL LETTER A WITH GRAVE         */
 
-    /*  The double bytes below must be handled separately after the
-     *   table lookup.
+    /*  The double bytes below are decoded with the Ascii7to8Ext table.
      *
      *   12             27 10      FORM FEED
      *   94             27 20   ^  CIRCUMFLEX ACCENT
@@ -522,6 +521,33 @@ const uint8_t Ascii7to8[] = {
 
 };
 
+/****************************************************************************
+ *  This lookup table converts the character following an escape (27) in
+ *   the 7 bit "default alphabet" extension table, as defined in ETSI GSM
+ *   03.38, to a standard ISO-8859-1 8-bit ASCII.
+ *
+ *   The characters which are not in the ISO character set, as well as
+ *   the undefined escape sequences, are replaced by the NPC8-character.
+ ****************************************************************************/
+static const uint8_t Ascii7to8Ext[] = {
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*   0 -   7 */
+    NPC8,  NPC8,  12,    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*   8 -  15 */
+    NPC8,  NPC8,  NPC8,  NPC8,  94,    NPC8,  NPC8,  NPC8,  /*  16 -  23 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  24 -  31 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  32 -  39 */
+    123,   125,   NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  92,    /*  40 -  47 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  48 -  55 */
+    NPC8,  NPC8,  NPC8,  NPC8,  91,    126,   93,    NPC8,  /*  56 -  63 */
+    124,   NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  64 -  71 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  72 -  79 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  80 -  87 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  88 -  95 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /*  96 - 103 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /* 104 - 111 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /* 112 - 119 */
+    NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  NPC8,  /* 120 - 127 */
+};
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Dump the PDU
@@ -554,75 +580,189 @@ static void DumpPdu
 }
 
 
-static inline unsigned int Read7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * 8 septets fill exactly 7 bytes: the 7 bits codecs below pack and unpack a whole group of septets
+ * at once in a 64-bit word, instead of walking the bits one character at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SEPTETS_PER_GROUP   8
+#define BYTES_PER_GROUP     7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Septet packer, used to write a stream of GSM 03.38 septets by groups.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t*    bufferPtr;      ///< buffer
+    size_t      bufferSize;     ///< buffer size
+    size_t      index;          ///< current index in buffer
+    uint64_t    group;          ///< septets of the current group, the first one in the low bits
+    uint8_t     groupSize;      ///< number of septets in the current group
+    int         septetCount;    ///< number of septets packed so far
+}
+SeptetPacker_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load up to 7 bytes packed as defined in GSM 03.38: the first septet is in the low bits of the
+ * returned word.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t LoadGsm7Word
 (
-    const uint8_t* bufferPtr,
-    uint32_t       pos
+    const uint8_t* bufferPtr,   ///< [IN] packed septets
+    int            size         ///< [IN] number of bytes to load
 )
 {
-    int a = bufferPtr[pos/8] >> (pos&7);
-    int b = 0;
-    if ((pos&7) > 1) {
-        b = bufferPtr[(pos/8)+1] << (8-(pos&7));
+    uint64_t word = 0;
+    int i;
+
+    for (i = size - 1; i >= 0; i--)
+    {
+        word = (word << 8) | bufferPtr[i];
     }
 
-    return (a|b) & 0x7F;
+    return word;
 }
 
-static inline void Write7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store the low bytes of a word of septets packed as defined in GSM 03.38.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void StoreGsm7Word
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    uint8_t* bufferPtr,     ///< [OUT] packed septets
+    uint64_t word,          ///< [IN] septets, the first one in the low bits
+    int      size           ///< [IN] number of bytes to store
 )
 {
-    val &= 0x7F;
-    uint8_t idx = pos/8;
+    int i;
 
-
-    if (!(pos&7)) {
-        bufferPtr[idx] = val;
+    for (i = 0; i < size; i++, word >>= 8)
+    {
+        bufferPtr[i] = word & 0xFF;
     }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load up to 7 bytes of septets packed for CDMA (most significant bit first): the first septet is
+ * in bits 55-49 of the returned word.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t LoadCdma7Word
+(
+    const uint8_t* bufferPtr,   ///< [IN] packed septets
+    int            size         ///< [IN] number of bytes to load
+)
+{
+    uint64_t word = 0;
+    int i;
+
+    for (i = 0; i < BYTES_PER_GROUP; i++)
+    {
+        word = (word << 8) | ((i < size) ? bufferPtr[i] : 0);
     }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<(pos&7));
-        bufferPtr[idx+1] = (val>>(8-(pos&7)));
+
+    return word;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store the high bytes of a word of septets packed for CDMA.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void StoreCdma7Word
+(
+    uint8_t* bufferPtr,     ///< [OUT] packed septets
+    uint64_t word,          ///< [IN] septets, the first one in bits 55-49
+    int      size           ///< [IN] number of bytes to store
+)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        bufferPtr[i] = (word >> (8 * (BYTES_PER_GROUP - 1 - i))) & 0xFF;
     }
 }
 
-static inline unsigned int ReadCdma7Bits
+static inline unsigned int Read7Bits
 (
     const uint8_t* bufferPtr,
     uint32_t       pos
 )
 {
-    uint8_t idx = pos/8;
+    int a = bufferPtr[pos/8] >> (pos&7);
+    int b = 0;
+    if ((pos&7) > 1) {
+        b = bufferPtr[(pos/8)+1] << (8-(pos&7));
+    }
 
-    return (((bufferPtr[idx]<<(pos&7))&0xFF)|(bufferPtr[idx+1]>>(8-(pos&7))))>>1;
+    return (a|b) & 0x7F;
 }
 
-static inline void WriteCdma7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a septet to a packer. The septets are written to the buffer by whole groups.
+ *
+ * @return LE_OK, or LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_result_t PackSeptet
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    SeptetPacker_t* packerPtr,  ///< [IN/OUT] packer
+    uint8_t         septet      ///< [IN] septet to append
 )
 {
-    val &= 0x7F;
-    uint8_t idx = pos/8;
+    packerPtr->group |= (uint64_t)(septet & 0x7F) << (7 * packerPtr->groupSize);
+    packerPtr->septetCount++;
 
-    if (!(pos&7)) {
-        bufferPtr[idx] = val << 1;
-    }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | val;
+    if (++packerPtr->groupSize == SEPTETS_PER_GROUP)
+    {
+        if ((packerPtr->index + BYTES_PER_GROUP) > packerPtr->bufferSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        StoreGsm7Word(&packerPtr->bufferPtr[packerPtr->index], packerPtr->group, BYTES_PER_GROUP);
+        packerPtr->index += BYTES_PER_GROUP;
+        packerPtr->group = 0;
+        packerPtr->groupSize = 0;
     }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val>>((pos&7)-1));
-        bufferPtr[idx+1] = ((val<<(8-((pos&7)-1)))&0xff);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the last, incomplete, group of septets of a packer.
+ *
+ * @return LE_OK, or LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_result_t FlushSeptets
+(
+    SeptetPacker_t* packerPtr   ///< [IN/OUT] packer
+)
+{
+    int size = (packerPtr->groupSize * 7 + 7) / 8;
+
+    if ((packerPtr->index + size) > packerPtr->bufferSize)
+    {
+        return LE_OVERFLOW;
     }
+
+    StoreGsm7Word(&packerPtr->bufferPtr[packerPtr->index], packerPtr->group, size);
+    packerPtr->index += size;
+    packerPtr->group = 0;
+    packerPtr->groupSize = 0;
+
+    return LE_OK;
 }
 
 /**
@@ -641,9 +781,8 @@ static int32_t Convert8BitsTo7Bits
     uint8_t       *a7bitsNumber ///< [OUT] number of char in &7bitsPtr
 )
 {
+    SeptetPacker_t packer = { .bufferPtr = a7bitPtr, .bufferSize = a7bitSize };
     int read;
-    int write = 0;
-    int size = 0;
 
     for (read = pos; read < length+pos; ++read)
     {
@@ -652,38 +791,28 @@ static int32_t Convert8BitsTo7Bits
         /* Escape */
         if (byte >= 128)
         {
-            if (size>a7bitSize)
+            if (PackSeptet(&packer, 0x1B) != LE_OK)
             {
                 return LE_OVERFLOW;
             }
-
-            Write7Bits(a7bitPtr, 0x1B, write*7);
-            write++;
             byte -= 128;
         }
 
-        if (size>a7bitSize)
+        if (PackSeptet(&packer, byte) != LE_OK)
         {
             return LE_OVERFLOW;
         }
-
-        Write7Bits(a7bitPtr, byte, write*7);
-        write++;
-
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
     }
 
-    if (size>a7bitSize)
+    if (FlushSeptets(&packer) != LE_OK)
     {
         return LE_OVERFLOW;
     }
 
     /* Number of written chars */
-    *a7bitsNumber = write;
+    *a7bitsNumber = packer.septetCount;
 
-    return size;
+    return packer.index;
 }
 
 /**
@@ -701,75 +830,64 @@ static int32_t Convert7BitsTo8Bits
     size_t         a8bitSize     ///< [IN] 8bits array size.
 )
 {
-    int r;
-    int w;
+    bool escaped = false;
+    int r = pos;
+    int w = 0;
 
-    w = 0;
-    for (r = pos; r < length+pos; r++)
+    while (r < length+pos)
     {
-        uint8_t byte = Read7Bits(a7bitPtr, r*7);
-        byte = Ascii7to8[byte];
+        uint64_t septets;
+        int count;
 
-        if (byte != 27)
+        /* Unpack a whole group when the position is aligned on one, else a single septet */
+        if (!(r & 7) && ((length + pos - r) >= SEPTETS_PER_GROUP))
         {
-            if (w < a8bitSize)
-            {
-                a8bitPtr[w] = byte;
-                w++;
-            }
-            else
-            {
-                return LE_OVERFLOW;
-            }
+            septets = LoadGsm7Word(&a7bitPtr[(r / 8) * BYTES_PER_GROUP], BYTES_PER_GROUP);
+            count = SEPTETS_PER_GROUP;
         }
         else
         {
-            /* If we're escaped then the next byte have a special meaning. */
-            r++;
+            septets = Read7Bits(a7bitPtr, r*7);
+            count = 1;
+        }
+        r += count;
+
+        for (; count > 0; count--, septets >>= 7)
+        {
+            uint8_t byte;
 
-            byte = Read7Bits(a7bitPtr, r*7);
-            if (w < a8bitSize)
+            /* If we're escaped then the septet has a special meaning. */
+            if (escaped)
             {
-                switch (byte)
+                byte = Ascii7to8Ext[septets & 0x7F];
+                escaped = false;
+            }
+            else
+            {
+                byte = Ascii7to8[septets & 0x7F];
+                if (byte == 27)
                 {
-                    case 10:
-                        a8bitPtr[w] = 12;
-                        break;
-                    case 20:
-                        a8bitPtr[w] = '^';
-                        break;
-                    case 40:
-                        a8bitPtr[w] = '{';
-                        break;
-                    case 41:
-                        a8bitPtr[w] = '}';
-                        break;
-                    case 47:
-                        a8bitPtr[w] = '\\';
-                        break;
-                    case 60:
-                        a8bitPtr[w] = '[';
-                        break;
-                    case 61:
-                        a8bitPtr[w] = '~';
-                        break;
-                    case 62:
-                        a8bitPtr[w] = ']';
-                        break;
-                    case 64:
-                        a8bitPtr[w] = '|';
-                        break;
-                    default:
-                        a8bitPtr[w] = NPC8;
-                        break;
+                    escaped = true;
+                    continue;
                 }
-                w++;
             }
-            else
+
+            if (w >= a8bitSize)
             {
                 return LE_OVERFLOW;
             }
+            a8bitPtr[w++] = byte;
+        }
+    }
+
+    /* An escape in the last septet applies to the septet following the array. */
+    if (escaped)
+    {
+        if (w >= a8bitSize)
+        {
+            return LE_OVERFLOW;
         }
+        a8bitPtr[w++] = Ascii7to8Ext[Read7Bits(a7bitPtr, r*7)];
     }
 
     return w;
@@ -1067,7 +1185,7 @@ static le_result_t DecodeUserDataField
                 return LE_OVERFLOW;
             }
             *destDataLenPtr = size;
-            LE_INFO(" messageLen %d, pos %d, size %d ", messageLen, *posPtr, size);
+            LE_DEBUG(" messageLen %d, pos %d, size %d ", messageLen, *posPtr, size);
             break;
 
         case SMSPDU_UCS2_16_BITS:
@@ -1840,29 +1958,33 @@ static le_result_t EncodeCdma7BitsData
     uint8_t       *a7bitsNumber ///< [OUT] number of char in 7bitsPtr
 )
 {
+    int size = (a8bitPtrSize * 7 + 7) / 8;
     int read;
-    int write = 0;
-    int size = 0;
 
     memset(a7bitPtr,0,a7bitSize);
 
-    for (read = 0; read < a8bitPtrSize; ++read)
+    if (size>a7bitSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    /* Pack the characters by groups of 8 septets, then the remaining ones */
+    for (read = 0; read < a8bitPtrSize; read += SEPTETS_PER_GROUP)
     {
-        if (size>a7bitSize)
+        int count = min(a8bitPtrSize - read, SEPTETS_PER_GROUP);
+        uint64_t word = 0;
+        int i;
+
+        for (i = 0; i < count; i++)
         {
-            return LE_OVERFLOW;
+            word |= (uint64_t)(a8bitPtr[read + i] & 0x7F) << (49 - (7 * i));
         }
 
-        WriteCdma7Bits(a7bitPtr, a8bitPtr[read], write*7);
-        write++;
-
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
+        StoreCdma7Word(&a7bitPtr[(read / 8) * BYTES_PER_GROUP], word, (count * 7 + 7) / 8);
     }
 
     /* Number of written chars */
-    *a7bitsNumber = write;
+    *a7bitsNumber = a8bitPtrSize;
 
     return LE_OK;
 }
@@ -1884,24 +2006,31 @@ static le_result_t DecodeCdma7bitsData
     uint32_t      *a8bitNumber   ///< [OUT] number of char written
 )
 {
-    int read;
-    int write;
+    uint32_t count = min(a7bitPtrSize, a8bitSize);
+    uint32_t read;
 
     memset(a8bitPtr,0,a8bitSize);
 
-    for (read = 0, write = 0; read < a7bitPtrSize; read++, write++)
+    /* Unpack the characters by groups of 8 septets, then the remaining ones */
+    for (read = 0; read < count; read += SEPTETS_PER_GROUP)
     {
-        if (write < a8bitSize)
-        {
-            a8bitPtr[write] = ReadCdma7Bits(a7bitPtr, read*7);
-        }
-        else
+        int groupSize = min(count - read, SEPTETS_PER_GROUP);
+        uint64_t word = LoadCdma7Word(&a7bitPtr[(read / 8) * BYTES_PER_GROUP],
+                                      (groupSize * 7 + 7) / 8);
+        int i;
+
+        for (i = 0; i < groupSize; i++)
         {
-            return LE_OVERFLOW;
+            a8bitPtr[read + i] = (word >> (49 - (7 * i))) & 0x7F;
         }
     }
 
-    *a8bitNumber = write;
+    if (a7bitPtrSize > a8bitSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    *a8bitNumber = a7bitPtrSize;
 
     return LE_OK;
 }
@@ -2,18 +2,27 @@
 /**
  *  SMS Inbox Server
  *
- * When the service is activated, or when a SMS is received, the SMS is copied from the SIM to a
- * specific folder (SMSINBOX_PATH/MSG_PATH).
+ * When the service is activated, or when a SMS is received, the SMS is copied from the SIM to the
+ * message store (SMSINBOX_PATH/STORE_FILE).
  *
- * Each SMS is copied into a dedicated file (named with a unique message identifier). The data
- * are stored using the Jannsson representation: Each data (imsi, SMS format, message length,
- * text/pdu, sender telephone number, timestamp, read/unread) are recorded with a key to retrieve
- * each value.
+ * The message store is an append-only log of records:
+ *  - a message box record names the message box tied to a bit of the message box masks,
+ *  - a message record holds the data of a SMS (imsi, SMS format, message length, text/binary/pdu,
+ *    sender telephone number, timestamp) together with the message boxes holding it and the
+ *    message boxes where it is unread,
+ *  - a state record updates these two masks, when a message is read, marked unread or deleted by a
+ *    message box. A message is dropped when no message box holds it anymore.
  *
- * Each application using the SMS Inbox Server possesses a configuration file in
- * SMSINBOX_PATH/CONF_PATH directory (also encoding using Jansson format): this file is used to
- * store the message identifier contained in the application mailbox. It is updated each time is new
- * SMS is received.
+ * The store is loaded on first use into an index of the live messages by message identifier, kept
+ * in a list ordered by identifier (i.e. by reception order) to browse the message boxes. Only
+ * message records are read back from the file afterwards, to retrieve the message data.
+ *
+ * The store is compacted by rewriting the live messages when more than half of it is made of
+ * superseded records.
+ *
+ * Message boxes used to be stored as Jansson files: one file per SMS in SMSINBOX_PATH/MSG_PATH and
+ * one file per application in SMSINBOX_PATH/CONF_PATH listing the messages of its message box.
+ * These files are imported into the store, and then removed, when it is loaded.
  *
  *  Copyright (C) Sierra Wireless Inc.
  */
@@ -28,6 +37,7 @@
 #include "le_hex.h"
 
 #include <dirent.h>
+#include <sys/mman.h>
 #include "jansson.h"
 
 //--------------------------------------------------------------------------------------------------
@@ -39,24 +49,34 @@
  * SMSInbox directory path.
  */
 //--------------------------------------------------------------------------------------------------
+#ifndef SMSINBOX_PATH
 #ifdef LEGATO_EMBEDDED
 #define SMSINBOX_PATH "/data/smsInbox/"
 #else
 #define SMSINBOX_PATH "/tmp/smsInbox/"
 #endif
-#define MSG_PATH "msg/"
-#define CONF_PATH "cfg/"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store file, and temporary file used to compact it.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_FILE      "msgStore"
+#define STORE_TMP_FILE  "msgStore.tmp"
 
 //--------------------------------------------------------------------------------------------------
 /**
- * File extension definition.
+ * Legacy message and configuration directories, and file extension.
  */
 //--------------------------------------------------------------------------------------------------
+#define MSG_PATH "msg/"
+#define CONF_PATH "cfg/"
 #define FILE_EXTENSION ".json"
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Json keys.
+ * Json keys of the legacy files.
  */
 //--------------------------------------------------------------------------------------------------
 #define JSON_FORMAT "format"
@@ -71,6 +91,50 @@
 #define JSON_ISDELETED "isDeleted"
 #define JSON_MSGINBOX "msgInBox"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store magic number ("SMSI") and format version.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_MAGIC     0x49534d53
+#define STORE_VERSION   1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of the data (text, binary or PDU) of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_DATA_MAX_BYTES  LE_SMS_PDU_MAX_BYTES
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a record. A message record is the largest one.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_RECORD_MAX_SIZE   512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the superseded records below which the store is never compacted.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_COMPACT_MIN_SIZE  (16 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the write buffer used to compact the store.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_BUFFER_SIZE       4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Minimum expected number of stored messages, used to size the message index. The index is sized
+ * for the largest message box otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_INDEX_SIZE          1024
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of user applications.
@@ -99,13 +163,6 @@
 //--------------------------------------------------------------------------------------------------
 #define MAX_MBOX_CONFIG_PATH_LEN 100
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Maximum number of Message List objects we expect to have at one time.
- */
-//--------------------------------------------------------------------------------------------------
-#define MAX_NUM_OF_LIST    MAX_APPS
-
 //--------------------------------------------------------------------------------------------------
 /**
  * The config tree path and node definitions.
@@ -133,46 +190,135 @@ typedef uint32_t MessageId_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Browsing structure.
+ * Set of message boxes: bit n stands for Apps[n], so it holds MAX_APPS bits.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint16_t MboxMask_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record types of the message store.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    RECORD_MBOX = 1,        ///< Name of a message box index. Payload: name, without '\0'.
+    RECORD_MESSAGE,         ///< New message. Payload: MsgHeader_t followed by the message fields.
+    RECORD_STATE            ///< Update of the masks of a message. No payload.
+}
+RecordType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of the message store file.
  *
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    json_t* jsonObjPtr;
-    json_t* jsonArrayPtr;
-    uint32_t currentMessageIndex;
-    uint32_t maxIndex;
+    uint32_t    magic;          ///< STORE_MAGIC
+    uint32_t    version;        ///< STORE_VERSION
+    MessageId_t nextMsgId;      ///< Next message identifier when the file was written
 }
-BrowseCtx_t;
+StoreHeader_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Entry description structure.
+ * Header of a record of the message store.
  *
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    enum
-    {
-        DESC_INT,
-        DESC_STRING,
-        DESC_BOOL
-    }                               type;       ///< Union type (string or integer
-    union
-    {
-        struct
-        {
-            char*   strPtr;                     ///< String
-            size_t  lenStr;                     ///< Length of the string
-        }                  str;                 ///< Value for string
-        uint32_t           val;                 ///< Value for integer
-        bool               boolVal;             ///< Boolean value
-    }                               uVal;       ///< Union type
+    uint32_t    crc;            ///< CRC32 of the record, from the size field to the end of payload
+    uint16_t    size;           ///< Size of the payload
+    uint8_t     type;           ///< Record type (RecordType_t)
+    uint8_t     mboxIdx;        ///< Message box index (RECORD_MBOX)
+    MessageId_t msgId;          ///< Message identifier (RECORD_MESSAGE, RECORD_STATE)
+    MboxMask_t  memberMask;     ///< Message boxes holding the message
+    MboxMask_t  unreadMask;     ///< Message boxes where the message is unread
+}
+RecordHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of the payload of a message record. It is followed by the IMSI, the sender telephone
+ * number and the timestamp, with their '\0', then by the data.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t     format;         ///< Message format (le_sms_Format_t)
+    uint8_t     imsiSize;       ///< Size of the IMSI
+    uint8_t     telSize;        ///< Size of the sender telephone number, 0 if unknown
+    uint8_t     timestampSize;  ///< Size of the timestamp, 0 if unknown
+    uint16_t    dataSize;       ///< Size of the text (with its '\0'), binary or PDU data
+    uint8_t     hasData;        ///< Whether the data of the message could be retrieved
+    uint8_t     reserved;       ///< Unused, 0
+    uint32_t    msgLen;         ///< Message length, as returned by GetMsgLen()
+}
+MsgHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of the payload of a message record.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_PAYLOAD_MAX_SIZE    (sizeof(MsgHeader_t) + LE_SIM_IMSI_BYTES +                       \
+                                 LE_MDMDEFS_PHONE_NUM_MAX_BYTES + LE_SMS_TIMESTAMP_MAX_BYTES +  \
+                                 MSG_DATA_MAX_BYTES)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message fields, as encoded in or decoded from a message record.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MsgHeader_t     hdr;                            ///< Format, field sizes and message length
+    const char*     imsiPtr;                        ///< IMSI
+    const char*     telPtr;                         ///< Sender telephone number, NULL if unknown
+    const char*     timestampPtr;                   ///< Timestamp, NULL if unknown
+    const uint8_t*  dataPtr;                        ///< Data, NULL if unknown
+    uint8_t         record[STORE_RECORD_MAX_SIZE];  ///< Decoded record
+}
+Msg_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index entry of a live message.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MessageId_t     id;             ///< Message identifier, key of the index
+    uint32_t        offset;         ///< Offset of the message record in the store
+    uint16_t        size;           ///< Size of the message record
+    MboxMask_t      memberMask;     ///< Message boxes holding the message
+    MboxMask_t      unreadMask;     ///< Message boxes where the message is unread
+    le_dls_Link_t   link;           ///< Link in MsgList
 }
-EntryDesc_t;
+MsgEntry_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Browsing structure.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool        isBrowsing;     ///< GetFirst() was called and the end of the box is not reached
+    MessageId_t lastMsgId;      ///< Last message returned by GetFirst() or GetNext()
+    MessageId_t maxMsgId;       ///< Last message received when GetFirst() was called
+}
+BrowseCtx_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -336,1202 +482,1428 @@ static le_ref_MapRef_t ActivationRequestRefMap;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a boolean value of a key in a Jason object
+ * Message store file descriptor, -1 until the store is loaded.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddBooleanKeyInJsonObject
-(
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    bool value          ///<[IN] Value to be added
-)
-{
-    json_t *jsonBoolPtr;
-    int ret = -1;
+static int StoreFd = -1;
 
-    if ( value == true )
-    {
-        jsonBoolPtr = json_true();
-    }
-    else
-    {
-        jsonBoolPtr = json_false();
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the message store, and size of its records superseded by later ones.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t StoreSize;
+static uint32_t StoreDeadSize;
 
-    if (jsonBoolPtr)
-    {
-        ret = json_object_set_new(jsonObjPtr, key, jsonBoolPtr);
-    }
-    else
-    {
-        LE_ERROR("Error during set of the key %s", key);
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for the index entries.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t MsgEntryPool;
 
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
-    {
-        return LE_FAULT;
-    }
-}
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index of the live messages, by message identifier.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t MsgIndex;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Live messages, by increasing message identifier.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t MsgList = LE_DLS_LIST_INIT;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add an integer value of a key in a Jason object
+ * Get the mask of a message box
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddIntegerKeyInJsonObject
+static inline MboxMask_t GetMboxMask
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    int  value          ///<[IN] Value to be added
+    const MboxCtx_t* mboxPtr    ///<[IN] message box
 )
 {
-    json_t *jsonIntPtr = json_integer(value);
-    int ret = -1;
+    return (MboxMask_t)(1 << (mboxPtr - Apps));
+}
 
-    if (jsonIntPtr)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a directory
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MkdirCreate
+(
+    const char* path    ///<[IN] path for directory creation
+)
+{
+    int status = mkdir(path, S_IRWXU|S_IRWXG);
+    if (0 != status)
     {
-        if (json_is_array(jsonObjPtr))
-        {
-            ret = json_array_append_new(jsonObjPtr, jsonIntPtr);
-        }
-        else
+        if (EEXIST != errno)
         {
-            ret = json_object_set_new(jsonObjPtr, key, jsonIntPtr);
+            LE_ERROR("Unable to create directory %s: %m", path);
+            return LE_FAULT;
         }
     }
-    else
-    {
-        LE_ERROR("Error during set of the key %s", key);
-    }
+    return LE_OK;
+}
 
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a buffer to a file
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteAll
+(
+    int fd,                 ///<[IN] file descriptor
+    const uint8_t* bufPtr,  ///<[IN] data to write
+    size_t size             ///<[IN] size of the data
+)
+{
+    while (size > 0)
     {
-        return LE_FAULT;
+        ssize_t writtenSize = write(fd, bufPtr, size);
+
+        if (writtenSize < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            LE_ERROR("Write error: %m");
+            return LE_FAULT;
+        }
+
+        bufPtr += writtenSize;
+        size -= writtenSize;
     }
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a string value of a key in a Jason object
+ * Compute the CRC of a record
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddStringKeyInJsonObject
+static uint32_t ComputeRecordCrc
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    char* string        ///<[IN] String to be added
+    const uint8_t* recordPtr,   ///<[IN] record, starting with its header
+    size_t recordSize           ///<[IN] size of the record
 )
 {
-    json_t * jsonStrPtr = json_string(string);
-    int ret = -1;
+    return le_crc_Crc32((uint8_t*)recordPtr + sizeof(uint32_t),
+                        recordSize - sizeof(uint32_t),
+                        LE_CRC_START_CRC32);
+}
 
-    if (jsonStrPtr)
-    {
-        ret = json_object_set_new(jsonObjPtr, key, jsonStrPtr);
-    }
-    else
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a record
+ *
+ * @return Size of the record
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeRecord
+(
+    uint8_t* bufPtr,            ///<[OUT] record buffer
+    RecordType_t type,          ///<[IN] record type
+    uint8_t mboxIdx,            ///<[IN] message box index
+    MessageId_t msgId,          ///<[IN] message identifier
+    MboxMask_t memberMask,      ///<[IN] message boxes holding the message
+    MboxMask_t unreadMask,      ///<[IN] message boxes where the message is unread
+    const void* payloadPtr,     ///<[IN] payload
+    size_t payloadSize          ///<[IN] size of the payload
+)
+{
+    RecordHeader_t header =
     {
-        LE_ERROR("Error during set of the key %s", key);
-    }
+        .size = payloadSize,
+        .type = type,
+        .mboxIdx = mboxIdx,
+        .msgId = msgId,
+        .memberMask = memberMask,
+        .unreadMask = unreadMask
+    };
+    size_t recordSize = sizeof(header) + payloadSize;
 
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
+    LE_ASSERT(recordSize <= STORE_RECORD_MAX_SIZE);
+
+    memcpy(bufPtr, &header, sizeof(header));
+    if (payloadSize)
     {
-        return LE_FAULT;
+        memcpy(bufPtr + sizeof(header), payloadPtr, payloadSize);
     }
+
+    header.crc = ComputeRecordCrc(bufPtr, recordSize);
+    memcpy(bufPtr, &header.crc, sizeof(header.crc));
+
+    return recordSize;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox directory path length
+ * Append a record to the message store
  *
  */
 //--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxMessagePathLen
+static le_result_t AppendRecord
 (
-    void
+    RecordType_t type,          ///<[IN] record type
+    uint8_t mboxIdx,            ///<[IN] message box index
+    MessageId_t msgId,          ///<[IN] message identifier
+    MboxMask_t memberMask,      ///<[IN] message boxes holding the message
+    MboxMask_t unreadMask,      ///<[IN] message boxes where the message is unread
+    const void* payloadPtr,     ///<[IN] payload
+    size_t payloadSize,         ///<[IN] size of the payload
+    uint32_t* offsetPtr         ///<[OUT] offset of the record in the store (optional)
 )
 {
-    return 2*sizeof(MessageId_t)+strlen(SMSINBOX_PATH)+strlen(MSG_PATH)+strlen(FILE_EXTENSION)+1;
+    uint8_t record[STORE_RECORD_MAX_SIZE];
+    size_t recordSize = EncodeRecord(record, type, mboxIdx, msgId, memberMask, unreadMask,
+                                     payloadPtr, payloadSize);
+
+    if (WriteAll(StoreFd, record, recordSize) != LE_OK)
+    {
+        // Do not leave a partial record behind
+        if (ftruncate(StoreFd, StoreSize) != 0)
+        {
+            LE_ERROR("Unable to truncate the message store: %m");
+        }
+        return LE_FAULT;
+    }
+
+    if (offsetPtr)
+    {
+        *offsetPtr = StoreSize;
+    }
+    StoreSize += recordSize;
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox file path
+ * Update the message counts of the message boxes when the message boxes holding a message change
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxMessagePath
+static void UpdateMsgCounts
 (
-    MessageId_t messageId,  ///[IN] message identifier
-    char* pathPtr,          ///<[OUT] path of the messageId file
-    uint32_t pathLen        ///<[IN] Length of pathPtr
+    MboxMask_t oldMask,     ///<[IN] message boxes previously holding the message
+    MboxMask_t newMask      ///<[IN] message boxes now holding the message
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%08x%s", SMSINBOX_PATH, MSG_PATH,
-                                            (int) messageId,
-                                            FILE_EXTENSION);
+    MboxMask_t changedMask = oldMask ^ newMask;
+    int i;
+
+    for (i = 0; changedMask; i++, changedMask >>= 1)
+    {
+        if (changedMask & 1)
+        {
+            if (newMask & (1 << i))
+            {
+                Apps[i].msgCount++;
+            }
+            else
+            {
+                Apps[i].msgCount--;
+            }
+        }
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox configuration path length
+ * Add an entry to the index, keeping MsgList ordered by message identifier
  *
  */
 //--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxConfigPathLen
+static void InsertMsgEntry
 (
-    char* appNamePtr    ///<[IN] Application name
+    MsgEntry_t* entryPtr    ///<[IN] entry to add
 )
 {
-    return strlen(appNamePtr)+strlen(SMSINBOX_PATH)+strlen(CONF_PATH)+strlen(FILE_EXTENSION)+1;
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&MsgList);
+
+    // Messages are nearly always added in identifier order, so start from the tail
+    while (linkPtr && (CONTAINER_OF(linkPtr, MsgEntry_t, link)->id > entryPtr->id))
+    {
+        linkPtr = le_dls_PeekPrev(&MsgList, linkPtr);
+    }
+
+    entryPtr->link = LE_DLS_LINK_INIT;
+    if (linkPtr)
+    {
+        le_dls_AddAfter(&MsgList, linkPtr, &entryPtr->link);
+    }
+    else
+    {
+        le_dls_Stack(&MsgList, &entryPtr->link);
+    }
+
+    le_hashmap_Put(MsgIndex, &entryPtr->id, entryPtr);
+    UpdateMsgCounts(0, entryPtr->memberMask);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the application's box file descriptor path
+ * Remove an entry from the index and release it. Its message record is superseded.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxConfigPath
+static void ReleaseMsgEntry
 (
-    char* appNamePtr,   ///<[IN] Application name
-    char* pathPtr,      ///<[OUT] configuration file path
-    uint32_t pathLen    ///<[IN] path length
+    MsgEntry_t* entryPtr    ///<[IN] entry to remove
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%s%s", SMSINBOX_PATH, CONF_PATH, appNamePtr, FILE_EXTENSION);
+    UpdateMsgCounts(entryPtr->memberMask, 0);
+    le_hashmap_Remove(MsgIndex, &entryPtr->id);
+    le_dls_Remove(&MsgList, &entryPtr->link);
+    StoreDeadSize += entryPtr->size;
+    le_mem_Release(entryPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Modify Json object
+ * Rewrite the message store with the live messages only
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ModifyJsonObj
+static le_result_t CompactStore
 (
-    json_t* jsonObjPtr,         ///<[IN] Json object (root object)
-    json_t* jsonValPtr,         ///<[IN] Json value to be modified
-    char*   key,                ///<[IN] Key to modify
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
+    void
 )
 {
-    int res = 0;
+    int fd = open(SMSINBOX_PATH STORE_TMP_FILE,
+                  O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR);
 
-    if (jsonValPtr == NULL)
+    if (fd < 0)
     {
-        LE_ERROR("NULL jsonValPtr");
+        LE_ERROR("Unable to create %s: %m", SMSINBOX_PATH STORE_TMP_FILE);
         return LE_FAULT;
     }
 
-    switch (modifPtr->type)
+    uint8_t buf[STORE_BUFFER_SIZE];
+    StoreHeader_t header =
     {
-        case DESC_STRING:
-            // check the type
-            if (json_is_string(jsonValPtr) == false)
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
+        .magic = STORE_MAGIC,
+        .version = STORE_VERSION,
+        .nextMsgId = NextMessageId
+    };
+    size_t len = sizeof(header);
+    int i;
 
-            if ( res == 0 )
-            {
-                res = json_string_set(jsonValPtr, modifPtr->uVal.str.strPtr);
-            }
-        break;
-        case DESC_INT:
-            // check the type
-            if (json_is_integer(jsonValPtr) == false )
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
+    memcpy(buf, &header, sizeof(header));
 
-            if ( res == 0 )
-            {
-                res = json_integer_set(jsonValPtr, modifPtr->uVal.val);
-            }
-        break;
-        case DESC_BOOL:
-            // check the type
-            if ( (json_is_true(jsonValPtr) != true) && (json_is_false(jsonValPtr) != true) )
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
-
-            if (( res == 0 ) &&
-                (AddBooleanKeyInJsonObject(jsonObjPtr, key, modifPtr->uVal.boolVal) != LE_OK))
-            {
-                res = -1;
-            }
-        break;
-        default:
-            res = -1;
-        break;
-    }
-
-    if (res < 0)
+    for (i = 0; i < MAX_APPS; i++)
     {
-        LE_ERROR(("Update error %d"), modifPtr->type);
-        return LE_FAULT;
+        if (Apps[i].namePtr)
+        {
+            len += EncodeRecord(buf + len, RECORD_MBOX, i, 0, 0, 0,
+                                Apps[i].namePtr, strlen(Apps[i].namePtr));
+        }
     }
-    else
+
+    uint32_t firstMsgOffset = len;
+    le_result_t res = LE_OK;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&MsgList);
+
+    while (linkPtr && (LE_OK == res))
     {
-        LE_DEBUG("ModifyJsonObj OK");
-        return LE_OK;
-    }
+        MsgEntry_t* entryPtr = CONTAINER_OF(linkPtr, MsgEntry_t, link);
 
-}
+        if (len + entryPtr->size > sizeof(buf))
+        {
+            res = WriteAll(fd, buf, len);
+            len = 0;
+        }
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Modify message file
- *
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t ModifyMsgEntry
-(
-    MessageId_t messageId,      ///<[IN] Message identifier to be modified
-    char* keyPtr[],              ///<[IN] Key to modify
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
-)
-{
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res;
-    int indexKey = -1;
+        if (pread(StoreFd, buf + len, entryPtr->size, entryPtr->offset) != entryPtr->size)
+        {
+            LE_ERROR("Unable to read message %u: %m", entryPtr->id);
+            res = LE_FAULT;
+        }
+        else
+        {
+            // Fold the state records of the message into its message record
+            RecordHeader_t recordHeader;
 
-    GetSMSInboxMessagePath(messageId, path, pathLen);
+            memcpy(&recordHeader, buf + len, sizeof(recordHeader));
+            recordHeader.memberMask = entryPtr->memberMask;
+            recordHeader.unreadMask = entryPtr->unreadMask;
+            memcpy(buf + len, &recordHeader, sizeof(recordHeader));
+            recordHeader.crc = ComputeRecordCrc(buf + len, entryPtr->size);
+            memcpy(buf + len, &recordHeader.crc, sizeof(recordHeader.crc));
 
-    LE_DEBUG("ModifyMsgEntry: messageId %d, path %s",messageId, path);
+            len += entryPtr->size;
+        }
 
-    json_t* jsonRootPtr = json_load_file(path, 0, &error);
+        linkPtr = le_dls_PeekNext(&MsgList, linkPtr);
+    }
 
-    if ( jsonRootPtr == NULL )
+    if (LE_OK == res)
     {
-        LE_ERROR("Json decoder error %s", error.text);
-        return LE_FAULT;
+        res = WriteAll(fd, buf, len);
     }
 
-    json_t* jsonValPtr = jsonRootPtr;
-    json_t* jsonSubObjPtr = jsonRootPtr;
-
-    while ( ( json_is_object(jsonValPtr) == true ) && ( nbKey > indexKey ) )
+    if ((LE_OK == res) && (fdatasync(fd) != 0))
     {
-        indexKey++;
-        jsonSubObjPtr = jsonValPtr;
-        jsonValPtr = json_object_get(jsonSubObjPtr, keyPtr[indexKey]);
+        LE_ERROR("Unable to sync the message store: %m");
+        res = LE_FAULT;
     }
 
-    if ( !jsonValPtr )
+    if ((LE_OK == res) && (rename(SMSINBOX_PATH STORE_TMP_FILE, SMSINBOX_PATH STORE_FILE) != 0))
     {
-        if ((indexKey > -1) && (indexKey < nbKey))
-        {
-            LE_ERROR("Unable to get the object %s", keyPtr[indexKey]);
-        }
-        else
-        {
-            LE_ERROR("IndexKey: %d is out of range", indexKey);
-        }
-
+        LE_ERROR("Unable to rename the message store: %m");
         res = LE_FAULT;
     }
-    else
+
+    if (LE_OK != res)
     {
-        if ((indexKey > -1) && (indexKey < nbKey))
-        {
-            res = ModifyJsonObj(jsonSubObjPtr, jsonValPtr, keyPtr[indexKey], modifPtr);
-        }
-        else
-        {
-            LE_ERROR("IndexKey: %d is out of range", indexKey);
-            res = LE_FAULT;
-        }
+        close(fd);
+        unlink(SMSINBOX_PATH STORE_TMP_FILE);
+        return res;
     }
 
-    if ( res == LE_OK )
+    if (StoreFd >= 0)
     {
-        if (json_dump_file(jsonRootPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0)
-        {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
-        }
+        close(StoreFd);
     }
-    else
+    StoreFd = fd;
+
+    // The messages are written in the order of MsgList
+    StoreSize = firstMsgOffset;
+    linkPtr = le_dls_Peek(&MsgList);
+    while (linkPtr)
     {
-        LE_ERROR("Something was wrong in ModifyJsonObj");
+        MsgEntry_t* entryPtr = CONTAINER_OF(linkPtr, MsgEntry_t, link);
+
+        entryPtr->offset = StoreSize;
+        StoreSize += entryPtr->size;
+        linkPtr = le_dls_PeekNext(&MsgList, linkPtr);
     }
+    StoreDeadSize = 0;
 
-    json_decref(jsonRootPtr);
+    LE_DEBUG("Message store compacted, size %u", StoreSize);
 
-    return res;
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Json object
+ * Compact the message store if more than half of it is made of superseded records
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ReadJsonObj
+static void CompactStoreIfNeeded
 (
-    json_t* jsonValPtr,         ///<[IN] Json value to be read
-    char* keyPtr[],             ///<[IN] Key to read
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr     ///<[OUT] Decoding result
+    void
 )
 {
-    le_result_t res = LE_OK;
-
-    if ( jsonValPtr == NULL )
+    if ((StoreDeadSize > STORE_COMPACT_MIN_SIZE) && (StoreDeadSize > StoreSize / 2))
     {
-        LE_ERROR("No information");
-        return LE_FAULT;
-    }
-
-    switch json_typeof(jsonValPtr)
-    {
-        case JSON_STRING:
-        {
-            if ( decodePtr->type != DESC_STRING )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
-
-            if (res == LE_OK)
-            {
-                const char* strPtr = json_string_value((const json_t *)jsonValPtr);
-
-                if ( strlen(strPtr) >= decodePtr->uVal.str.lenStr )
-                {
-                    LE_ERROR("String too long");
-                    res = LE_OVERFLOW;
-                }
-                else
-                {
-                    strncpy(decodePtr->uVal.str.strPtr, strPtr, decodePtr->uVal.str.lenStr);
-                    decodePtr->uVal.str.lenStr = strlen(strPtr);
-                }
-            }
-        }
-        break;
-        case JSON_INTEGER:
-        {
-            if ( decodePtr->type != DESC_INT )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
-            else
-            {
-                decodePtr->uVal.val = json_integer_value((const json_t *)jsonValPtr);
-            }
-        }
-        break;
-        case JSON_TRUE:
-        case JSON_FALSE:
+        if (CompactStore() != LE_OK)
         {
-            if ( decodePtr->type != DESC_BOOL )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
-            else
-            {
-                decodePtr->uVal.boolVal = json_is_true((const json_t *)jsonValPtr);
-            }
+            LE_ERROR("Unable to compact the message store");
         }
-        break;
-        case JSON_OBJECT:
-        {
-            // if key-value is an object, read the next key
-            if (nbKey >= 1)
-            {
-                json_t* jsonSubValPtr = json_object_get(jsonValPtr, keyPtr[0]);
-
-                if ( jsonSubValPtr )
-                {
-                    res = ReadJsonObj(jsonSubValPtr, &keyPtr[1], nbKey-1,  decodePtr );
-                }
-                else
-                {
-                    LE_ERROR("Bad format");
-                    res = LE_FAULT;
-                }
-            }
-            else
-            {
-                LE_ERROR("Key error");
-                res = LE_FAULT;
-            }
-        }
-        break;
-        case JSON_ARRAY:
-        case JSON_REAL:
-        case JSON_NULL:
-        default:
-            LE_ERROR("Bad json_typeof");
-            res = LE_FAULT;
-        break;
     }
-
-    return res;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Application's config file
+ * Update the message boxes holding a message, and the message boxes where it is unread. The
+ * message is dropped when no message box holds it anymore.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetMsgListFromMbox
+static le_result_t SetMsgState
 (
-    char* pathPtr,              ///<[IN] Application's config file path
-    json_t **jsonRootObjPtr,    ///<[OUT] json root object
-    json_t **jsonArrayPtr       ///<[OUT] messages in box list
+    MsgEntry_t* entryPtr,       ///<[IN] message
+    MboxMask_t memberMask,      ///<[IN] message boxes holding the message
+    MboxMask_t unreadMask       ///<[IN] message boxes where the message is unread
 )
 {
-    json_error_t error;
-    *jsonRootObjPtr = json_load_file(pathPtr, 0, &error);
+    unreadMask &= memberMask;
 
-    if ( !(*jsonRootObjPtr) )
+    if ((entryPtr->memberMask == memberMask) && (entryPtr->unreadMask == unreadMask))
     {
-        // File doesn't exist, create objects
-        *jsonRootObjPtr = json_object();
-
-        if ( !(*jsonRootObjPtr) )
-        {
-            LE_ERROR("Json error");
-            return LE_FAULT;
-        }
+        return LE_OK;
     }
 
-    *jsonArrayPtr = json_object_get(*jsonRootObjPtr, JSON_MSGINBOX);
-
-    if ( !(*jsonArrayPtr) )
+    if (AppendRecord(RECORD_STATE, 0, entryPtr->id, memberMask, unreadMask, NULL, 0, NULL)
+        != LE_OK)
     {
-        // Array doesn't exist, create it
-        *jsonArrayPtr = json_array();
+        LE_ERROR("Unable to update message %u", entryPtr->id);
+        return LE_FAULT;
+    }
 
-        if (!(*jsonArrayPtr))
-        {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
-        }
+    // A state record is always folded into the message record by the compaction
+    StoreDeadSize += sizeof(RecordHeader_t);
 
-        if ( json_object_set(*jsonRootObjPtr, JSON_MSGINBOX, *jsonArrayPtr) < 0 )
-        {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
-        }
+    UpdateMsgCounts(entryPtr->memberMask, memberMask);
+    entryPtr->memberMask = memberMask;
+    entryPtr->unreadMask = unreadMask;
+
+    if (0 == memberMask)
+    {
+        LE_DEBUG("Delete messageId %u", entryPtr->id);
+        ReleaseMsgEntry(entryPtr);
     }
 
+    CompactStoreIfNeeded();
+
     return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove a message from the application's cfg file
+ * Append a string and its '\0' to a message payload, truncated to maxSize bytes
  *
+ * @return Size of the string, including its '\0'
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DeleteMsgInAppCfg
+static uint8_t PutString
 (
-    char *appNamePtr,               ///<[IN] application name
-    MessageId_t deleteMessageId     ///<[IN] message to delete
+    uint8_t* bufPtr,        ///<[OUT] payload buffer
+    const char* strPtr,     ///<[IN] string
+    size_t maxSize          ///<[IN] maximum size of the string, including its '\0'
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appNamePtr);
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    GetSMSInboxConfigPath(appNamePtr, path, pathLen);
-    json_t *jsonObjPtr;
-    json_t *jsonArrayPtr;
+    size_t len = strnlen(strPtr, maxSize - 1);
 
-    LE_DEBUG("DeleteMessageId %d, path %s",deleteMessageId, path);
+    memcpy(bufPtr, strPtr, len);
+    bufPtr[len] = '\0';
 
-    if (GetMsgListFromMbox(path, &jsonObjPtr, &jsonArrayPtr) != LE_OK)
-    {
-       LE_ERROR("No message");
-       return LE_FAULT;
-    }
+    return len + 1;
+}
 
-    int i;
-    MessageId_t messageId;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode the payload of a message record
+ *
+ * @return Size of the payload
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeMsgPayload
+(
+    uint8_t* bufPtr,        ///<[OUT] payload buffer, MSG_PAYLOAD_MAX_SIZE bytes
+    Msg_t* msgPtr           ///<[IN] message fields. The field sizes are updated.
+)
+{
+    MsgHeader_t* hdrPtr = &msgPtr->hdr;
+    size_t len = sizeof(MsgHeader_t);
 
-    for (i=0; i < json_array_size(jsonArrayPtr); i++)
-    {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
+    hdrPtr->imsiSize = PutString(bufPtr + len, msgPtr->imsiPtr, LE_SIM_IMSI_BYTES);
+    len += hdrPtr->imsiSize;
 
-        if (jsonIntegerPtr)
-        {
-            messageId = json_integer_value(jsonIntegerPtr);
+    hdrPtr->telSize = 0;
+    if (msgPtr->telPtr)
+    {
+        hdrPtr->telSize = PutString(bufPtr + len, msgPtr->telPtr, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
+        len += hdrPtr->telSize;
+    }
 
-            if (messageId == deleteMessageId)
-            {
-                LE_DEBUG("Remove %d", (int) messageId);
-                json_array_remove(jsonArrayPtr, i);
-            }
-        }
-        else
-        {
-            LE_ERROR("Json error");
-        }
+    hdrPtr->timestampSize = 0;
+    if (msgPtr->timestampPtr)
+    {
+        hdrPtr->timestampSize = PutString(bufPtr + len, msgPtr->timestampPtr,
+                                          LE_SMS_TIMESTAMP_MAX_BYTES);
+        len += hdrPtr->timestampSize;
     }
 
-    le_result_t res = LE_OK;
-    if ( json_dump_file(jsonObjPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
+    hdrPtr->hasData = (msgPtr->dataPtr != NULL);
+    if (!hdrPtr->hasData)
     {
-        res = LE_FAULT;
-        LE_ERROR("Json_dump_file error");
+        hdrPtr->dataSize = 0;
+    }
+    LE_ASSERT(hdrPtr->dataSize <= MSG_DATA_MAX_BYTES);
+    if (hdrPtr->dataSize)
+    {
+        memcpy(bufPtr + len, msgPtr->dataPtr, hdrPtr->dataSize);
+        len += hdrPtr->dataSize;
     }
 
-    json_decref(jsonObjPtr);
+    hdrPtr->reserved = 0;
+    memcpy(bufPtr, hdrPtr, sizeof(MsgHeader_t));
 
-    return res;
+    return len;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if a message belongs to a message box
+ * Read a message record from the store
  *
  */
 //--------------------------------------------------------------------------------------------------
-
-static le_result_t CheckMessageIdInMbox
+static le_result_t ReadMsg
 (
-    char* mboxName,
-    MessageId_t messageId
+    const MsgEntry_t* entryPtr,     ///<[IN] message
+    Msg_t* msgPtr                   ///<[OUT] decoded message
 )
 {
-    json_t *jsonRootObjPtr;
-    json_t *jsonArrayPtr;
-    uint32_t pathLen = GetSMSInboxConfigPathLen(mboxName);
-    char path[pathLen];
-    GetSMSInboxConfigPath(mboxName, path, pathLen);
+    const uint8_t* payloadPtr = msgPtr->record + sizeof(RecordHeader_t);
+    const uint8_t* fieldPtr = payloadPtr + sizeof(MsgHeader_t);
+    MsgHeader_t* hdrPtr = &msgPtr->hdr;
 
-    if ( GetMsgListFromMbox(path, &jsonRootObjPtr, &jsonArrayPtr) != LE_OK )
+    if ((entryPtr->size < sizeof(RecordHeader_t) + sizeof(MsgHeader_t)) ||
+        (pread(StoreFd, msgPtr->record, entryPtr->size, entryPtr->offset) != entryPtr->size))
     {
-        LE_ERROR("Error in GetMsgListFromMbox");
+        LE_ERROR("Unable to read message %u", entryPtr->id);
         return LE_FAULT;
     }
 
-    int i = 0;
+    memcpy(hdrPtr, payloadPtr, sizeof(MsgHeader_t));
 
-    while (i < json_array_size(jsonArrayPtr))
+    if ((fieldPtr + hdrPtr->imsiSize + hdrPtr->telSize + hdrPtr->timestampSize +
+         hdrPtr->dataSize > msgPtr->record + entryPtr->size) ||
+        (0 == hdrPtr->imsiSize))
     {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
-        MessageId_t msgId = 0;
+        LE_ERROR("Corrupted message %u", entryPtr->id);
+        return LE_FAULT;
+    }
 
-        if (jsonIntegerPtr)
-        {
-            msgId = json_integer_value(jsonIntegerPtr);
-        }
-        else
-        {
-            LE_ERROR("Json error");
-            json_decref(jsonRootObjPtr);
-            return LE_FAULT;
-        }
+    msgPtr->imsiPtr = (const char*)fieldPtr;
+    fieldPtr += hdrPtr->imsiSize;
+    msgPtr->telPtr = hdrPtr->telSize ? (const char*)fieldPtr : NULL;
+    fieldPtr += hdrPtr->telSize;
+    msgPtr->timestampPtr = hdrPtr->timestampSize ? (const char*)fieldPtr : NULL;
+    fieldPtr += hdrPtr->timestampSize;
+    msgPtr->dataPtr = hdrPtr->hasData ? fieldPtr : NULL;
 
-        LE_DEBUG("MessageId %d, msgId %d, i %d", messageId, msgId, i);
-        if (msgId == messageId)
-        {
-            json_decref(jsonRootObjPtr);
-            return LE_OK;
-        }
+    if ((msgPtr->imsiPtr[hdrPtr->imsiSize - 1] != '\0') ||
+        (msgPtr->telPtr && (msgPtr->telPtr[hdrPtr->telSize - 1] != '\0')) ||
+        (msgPtr->timestampPtr && (msgPtr->timestampPtr[hdrPtr->timestampSize - 1] != '\0')))
+    {
+        LE_ERROR("Corrupted message %u", entryPtr->id);
+        return LE_FAULT;
+    }
 
-        i++;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string field of a message
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyMsgString
+(
+    const char* strPtr,     ///<[IN] string, NULL if unknown
+    size_t strSize,         ///<[IN] size of the string, including its '\0'
+    char* destPtr,          ///<[OUT] destination buffer
+    size_t destSize         ///<[IN] size of the destination buffer
+)
+{
+    if (NULL == strPtr)
+    {
+        LE_ERROR("No information");
+        return LE_FAULT;
     }
 
-    LE_ERROR("Bad msg id or mbox name");
-    json_decref(jsonRootObjPtr);
-    return LE_FAULT;
+    if (strSize > destSize)
+    {
+        LE_ERROR("String too long");
+        return LE_OVERFLOW;
+    }
+
+    memcpy(destPtr, strPtr, strSize);
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Decode message file
+ * Add a message to the store. A message already stored with the same identifier is replaced.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DecodeMsgEntry
+static le_result_t AddMsg
 (
-    char* mboxName,                      ///<[IN] mbox name
-    MessageId_t messageId,               ///<[IN] Message identifier to decode
-    char* keyPtr[],                      ///<[IN] Key to retrieve
-    uint8_t nbKey,                       ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr              ///<[IN/OUT] Decoding result
+    MessageId_t msgId,          ///<[IN] message identifier
+    MboxMask_t memberMask,      ///<[IN] message boxes holding the message
+    MboxMask_t unreadMask,      ///<[IN] message boxes where the message is unread
+    const uint8_t* payloadPtr,  ///<[IN] message record payload
+    size_t payloadSize          ///<[IN] size of the payload
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res = LE_OK;
+    MsgEntry_t* entryPtr = le_hashmap_Get(MsgIndex, &msgId);
 
-    GetSMSInboxMessagePath(messageId, path, pathLen);
+    if (entryPtr && (SetMsgState(entryPtr, 0, 0) != LE_OK))
+    {
+        return LE_FAULT;
+    }
 
-    json_t* jsonRootPtr = json_load_file(path, JSON_REJECT_DUPLICATES, &error);
+    entryPtr = le_mem_ForceAlloc(MsgEntryPool);
+    entryPtr->id = msgId;
+    entryPtr->size = sizeof(RecordHeader_t) + payloadSize;
+    entryPtr->memberMask = memberMask;
+    entryPtr->unreadMask = unreadMask & memberMask;
 
-    if ( jsonRootPtr == NULL )
+    if (AppendRecord(RECORD_MESSAGE, 0, msgId, entryPtr->memberMask, entryPtr->unreadMask,
+                     payloadPtr, payloadSize, &entryPtr->offset) != LE_OK)
     {
-        LE_ERROR("Json decoder error %s mboxName %s", error.text, mboxName);
-        DeleteMsgInAppCfg(mboxName, messageId);
+        LE_ERROR("Unable to store message %u", msgId);
+        le_mem_Release(entryPtr);
         return LE_FAULT;
     }
 
-    res = ReadJsonObj(jsonRootPtr, keyPtr, nbKey, decodePtr);
+    InsertMsgEntry(entryPtr);
 
-    json_decref(jsonRootPtr);
+    if (msgId >= NextMessageId)
+    {
+        NextMessageId = msgId + 1;
+    }
 
-    return res;
+    return LE_OK;
 }
 
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if an application requested the deletion of a message
+ * Translate a message box mask of the store into a mask of Apps
  *
  */
 //--------------------------------------------------------------------------------------------------
-static bool IsDeleted
+static MboxMask_t RemapMboxMask
 (
-    MessageId_t messageId,  ///<[IN] Message identifier
-    char* appNamePtr        ///<[IN] Application name
+    MboxMask_t storeMask,       ///<[IN] mask, in store message box indexes
+    const int8_t* mboxMapPtr    ///<[IN] Apps index of each store message box index, or -1
 )
 {
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[2] = {JSON_ISDELETED, appNamePtr};
+    MboxMask_t mask = 0;
+    int i;
 
-    if (DecodeMsgEntry(appNamePtr, messageId, key, 2, &decode) == LE_OK)
-    {
-        LE_DEBUG("Decode.uVal.boolVal %d", decode.uVal.boolVal);
-        return decode.uVal.boolVal;
-    }
-    else
+    for (i = 0; storeMask; i++, storeMask >>= 1)
     {
-        // if error, delete the message
-        return true;
+        if ((storeMask & 1) && (mboxMapPtr[i] >= 0))
+        {
+            mask |= 1 << mboxMapPtr[i];
+        }
     }
+
+    return mask;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform the deleteion
+ * Apply a record of the message store to the index
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void PerformDeletion
+static void LoadRecord
 (
-    MessageId_t messageId   ///<[IN] Message identifier
+    const RecordHeader_t* headerPtr,    ///<[IN] record header
+    const uint8_t* payloadPtr,          ///<[IN] record payload
+    uint32_t offset,                    ///<[IN] offset of the record
+    int8_t* mboxMapPtr                  ///<[INOUT] Apps index of each store message box index
 )
 {
+    uint32_t recordSize = sizeof(RecordHeader_t) + headerPtr->size;
+    MboxMask_t memberMask = RemapMboxMask(headerPtr->memberMask, mboxMapPtr);
+    MboxMask_t unreadMask = RemapMboxMask(headerPtr->unreadMask, mboxMapPtr) & memberMask;
+    MsgEntry_t* entryPtr = le_hashmap_Get(MsgIndex, &headerPtr->msgId);
     int i;
-    bool deleted = true;
 
-    for (i=0; i < MAX_APPS; i++)
+    if ((RECORD_MESSAGE == headerPtr->type) || (RECORD_STATE == headerPtr->type))
     {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
+        if (headerPtr->msgId >= NextMessageId)
         {
-            deleted &= IsDeleted(messageId, Apps[i].namePtr);
+            NextMessageId = headerPtr->msgId + 1;
         }
     }
 
-    // All applications mark this message to be delteted => erase physically the message
-    if (deleted)
+    switch (headerPtr->type)
     {
-        uint16_t pathLen = GetSMSInboxMessagePathLen();
-        char path[pathLen];
-        memset(path, 0, pathLen);
+        case RECORD_MBOX:
+            if (headerPtr->mboxIdx >= MAX_APPS)
+            {
+                break;
+            }
+            mboxMapPtr[headerPtr->mboxIdx] = -1;
+            for (i = 0; i < MAX_APPS; i++)
+            {
+                if (Apps[i].namePtr && (strlen(Apps[i].namePtr) == headerPtr->size) &&
+                    (0 == memcmp(Apps[i].namePtr, payloadPtr, headerPtr->size)))
+                {
+                    mboxMapPtr[headerPtr->mboxIdx] = i;
+                }
+            }
+        break;
 
-        GetSMSInboxMessagePath(messageId, path, pathLen);
+        case RECORD_MESSAGE:
+            if (entryPtr)
+            {
+                ReleaseMsgEntry(entryPtr);
+            }
+            if (0 == memberMask)
+            {
+                StoreDeadSize += recordSize;
+                break;
+            }
+            entryPtr = le_mem_ForceAlloc(MsgEntryPool);
+            entryPtr->id = headerPtr->msgId;
+            entryPtr->offset = offset;
+            entryPtr->size = recordSize;
+            entryPtr->memberMask = memberMask;
+            entryPtr->unreadMask = unreadMask;
+            InsertMsgEntry(entryPtr);
+        break;
+
+        case RECORD_STATE:
+            StoreDeadSize += recordSize;
+            if (NULL == entryPtr)
+            {
+                break;
+            }
+            UpdateMsgCounts(entryPtr->memberMask, memberMask);
+            entryPtr->memberMask = memberMask;
+            entryPtr->unreadMask = unreadMask;
+            if (0 == memberMask)
+            {
+                ReleaseMsgEntry(entryPtr);
+            }
+        break;
 
-        LE_DEBUG("Delete messageId %d, path %s",messageId, path);
-        unlink(path);
+        default:
+            LE_WARN("Unknown record type %u at %u", headerPtr->type, offset);
+            StoreDeadSize += recordSize;
+        break;
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a message in the application's cfg file
+ * Load the message store into the index. The store is truncated after its last valid record.
  *
+ * @return Whether the store must be rewritten before records are appended to it
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddMsgInAppCfg
+static bool LoadStore
 (
-    MboxCtx_t* appsPtr,         ///<[IN] application config
-    MessageId_t messageId     ///<[IN] message to add
+    void
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appsPtr->namePtr);
-    char path[pathLen];
-    GetSMSInboxConfigPath(appsPtr->namePtr, path, pathLen);
-    json_t* jsonMsgIdPtr = NULL;
-    json_t* jsonPtr;
-    json_t* jsonArrayPtr;
+    struct stat st;
+    StoreHeader_t header;
+    int8_t mboxMap[MAX_APPS];
+    bool rewrite = false;
+    int i;
 
-    if ( GetMsgListFromMbox (path, &jsonPtr, &jsonArrayPtr) != LE_OK )
+    StoreSize = 0;
+    StoreDeadSize = 0;
+
+    if ((fstat(StoreFd, &st) != 0) || (st.st_size < (off_t)sizeof(header)))
     {
-        LE_ERROR("Message %s not found", path);
-        return LE_FAULT;
+        // New store
+        return true;
     }
-    LE_DEBUG("Add messageId %d, path %s, array Size %zu", messageId,
-                                                          path,
-                                                          json_array_size(jsonArrayPtr) );
 
-    if ( json_array_size(jsonArrayPtr) == appsPtr->inboxSize )
+    uint8_t* mapPtr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, StoreFd, 0);
+    if (MAP_FAILED == mapPtr)
     {
-        // delete older entry
-        jsonMsgIdPtr = json_array_get(jsonArrayPtr, 0);
-        MessageId_t messageId = 0;
+        LE_ERROR("Unable to map the message store: %m");
+        return true;
+    }
 
-        if (jsonMsgIdPtr)
-        {
-            messageId = json_integer_value(jsonMsgIdPtr);
-        }
+    memcpy(&header, mapPtr, sizeof(header));
+    if ((STORE_MAGIC != header.magic) || (STORE_VERSION != header.version))
+    {
+        LE_ERROR("Unknown message store format, messages are lost");
+        munmap(mapPtr, st.st_size);
+        return true;
+    }
 
-        if (messageId != 0)
-        {
-            json_array_remove(jsonArrayPtr, 0);
+    if (header.nextMsgId > NextMessageId)
+    {
+        NextMessageId = header.nextMsgId;
+    }
 
-            EntryDesc_t modif;
-            modif.type = DESC_BOOL;
-            modif.uVal.boolVal = true;
-            char* key[2]={JSON_ISDELETED, appsPtr->namePtr};
+    memset(mboxMap, -1, sizeof(mboxMap));
 
-            if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-            {
-                LE_ERROR("Can't modify entry %08x, path %s", (int) messageId, path);
-            }
+    uint32_t offset = sizeof(header);
 
-            PerformDeletion(messageId);
-        }
-        else
+    while (offset + sizeof(RecordHeader_t) <= (uint32_t)st.st_size)
+    {
+        RecordHeader_t recordHeader;
+
+        memcpy(&recordHeader, mapPtr + offset, sizeof(recordHeader));
+
+        uint32_t recordSize = sizeof(recordHeader) + recordHeader.size;
+
+        if ((recordSize > STORE_RECORD_MAX_SIZE) ||
+            (offset + recordSize > (uint32_t)st.st_size) ||
+            (ComputeRecordCrc(mapPtr + offset, recordSize) != recordHeader.crc))
         {
-            json_decref(jsonPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
+            break;
         }
-    }
 
-    if (AddIntegerKeyInJsonObject(jsonArrayPtr, NULL, messageId) != LE_OK)
-    {
-        json_decref(jsonPtr);
-        LE_ERROR("Json error");
-        return LE_FAULT;
+        LoadRecord(&recordHeader, mapPtr + offset + sizeof(recordHeader), offset, mboxMap);
+        offset += recordSize;
     }
 
-    if ( json_dump_file(jsonPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
+    munmap(mapPtr, st.st_size);
+
+    if (offset != st.st_size)
     {
-        json_decref(jsonPtr);
-        LE_ERROR("Json error");
-        return LE_FAULT;
+        // Interrupted write
+        LE_WARN("Message store truncated at %u (size %u)", offset, (uint32_t)st.st_size);
+        if (ftruncate(StoreFd, offset) != 0)
+        {
+            LE_ERROR("Unable to truncate the message store: %m");
+            rewrite = true;
+        }
     }
 
-    json_decref(jsonPtr);
+    StoreSize = offset;
 
-    // Use for the first initialization
-    if (jsonArrayPtr->refcount > 0)
+    // The masks of the records to append use Apps indexes
+    for (i = 0; i < MAX_APPS; i++)
     {
-        json_decref(jsonArrayPtr);
+        if ((Apps[i].namePtr && (mboxMap[i] != i)) || (!Apps[i].namePtr && (mboxMap[i] >= 0)))
+        {
+            rewrite = true;
+        }
     }
 
-    return LE_OK;
+    return rewrite;
 }
 
-
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Encode Json file
+ * Check whether a legacy message box file lists a message
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t EncodeMsgEntry
+static bool IsInLegacyMbox
 (
-    uint32_t fd,            ///<[IN] file descriptor
-    le_sms_MsgRef_t msgRef  ///<[IN] SMS to be encoding
+    json_t* jsonArrayPtr,   ///<[IN] message identifiers of the message box, or NULL
+    MessageId_t msgId       ///<[IN] message identifier
 )
 {
-    json_t *jsonRootPtr = json_object();
+    size_t i;
 
-    if (!jsonRootPtr)
+    for (i = 0; i < json_array_size(jsonArrayPtr); i++)
     {
-        LE_ERROR("Json error");
-        return LE_FAULT;
+        if (json_integer_value(json_array_get(jsonArrayPtr, i)) == msgId)
+        {
+            return true;
+        }
     }
 
-    // Add imsi in json file
-    AddStringKeyInJsonObject(jsonRootPtr, JSON_IMSI, SimImsi);
+    return false;
+}
 
-    // Add sms format in json file
-    le_sms_Format_t format = le_sms_GetFormat(msgRef);
-    AddIntegerKeyInJsonObject(jsonRootPtr, JSON_FORMAT, (int) format);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Import a legacy message file into the store
+ *
+ * @return
+ *      - LE_OK             The message is imported, or no message box holds it.
+ *      - LE_FORMAT_ERROR   The file cannot be decoded.
+ *      - LE_FAULT          The message cannot be stored.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MigrateLegacyMsg
+(
+    const char* pathPtr,        ///<[IN] message file path
+    MessageId_t msgId,          ///<[IN] message identifier
+    json_t* mboxListPtr[]       ///<[IN] messages listed by the legacy file of each message box
+)
+{
+    json_error_t error;
+    json_t* jsonRootPtr = json_load_file(pathPtr, JSON_REJECT_DUPLICATES, &error);
 
-    // Unread by default for all applications
-    json_t *jsonUnreadPtr = json_object();
-    int i;
-    for (i=0; i < MAX_APPS; i++)
+    if (NULL == jsonRootPtr)
     {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            AddBooleanKeyInJsonObject(jsonUnreadPtr, Apps[i].namePtr, true);
-        }
+        LE_ERROR("Json decoder error %s", error.text);
+        return LE_FORMAT_ERROR;
     }
 
-    json_object_set_new(jsonRootPtr, JSON_ISUNREAD, jsonUnreadPtr);
+    json_t* jsonUnreadPtr = json_object_get(jsonRootPtr, JSON_ISUNREAD);
+    json_t* jsonDeletedPtr = json_object_get(jsonRootPtr, JSON_ISDELETED);
+    MboxMask_t memberMask = 0;
+    MboxMask_t unreadMask = 0;
+    int i;
 
-    // Undeleted by default for all applications
-    json_t *jsonDeletePtr = json_object();
-    for (i=0; i < MAX_APPS; i++)
+    for (i = 0; i < MAX_APPS; i++)
     {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
+        if (Apps[i].namePtr && IsInLegacyMbox(mboxListPtr[i], msgId) &&
+            !json_is_true(json_object_get(jsonDeletedPtr, Apps[i].namePtr)))
         {
-            AddBooleanKeyInJsonObject(jsonDeletePtr, Apps[i].namePtr, false);
+            memberMask |= 1 << i;
+            if (!json_is_false(json_object_get(jsonUnreadPtr, Apps[i].namePtr)))
+            {
+                unreadMask |= 1 << i;
+            }
         }
     }
 
-    json_object_set_new(jsonRootPtr, JSON_ISDELETED, jsonDeletePtr);
+    if (0 == memberMask)
+    {
+        json_decref(jsonRootPtr);
+        return LE_OK;
+    }
+
+    Msg_t msg;
+    const char* dataKeyPtr = NULL;
+    const char* hexPtr;
+    uint8_t data[MSG_DATA_MAX_BYTES];
 
-    switch ( format )
+    memset(&msg, 0, sizeof(msg));
+    msg.hdr.format = json_integer_value(json_object_get(jsonRootPtr, JSON_FORMAT));
+    msg.hdr.msgLen = json_integer_value(json_object_get(jsonRootPtr, JSON_MSGLEN));
+    msg.imsiPtr = json_string_value(json_object_get(jsonRootPtr, JSON_IMSI));
+    msg.telPtr = json_string_value(json_object_get(jsonRootPtr, JSON_SENDERTEL));
+    msg.timestampPtr = json_string_value(json_object_get(jsonRootPtr, JSON_TIMESTAMP));
+
+    if (NULL == msg.imsiPtr)
+    {
+        msg.imsiPtr = "";
+    }
+
+    switch (msg.hdr.format)
     {
         case LE_SMS_FORMAT_TEXT:
+            dataKeyPtr = JSON_TEXT;
+        break;
         case LE_SMS_FORMAT_BINARY:
-        {
-            char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
-            memset(tel, 0, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
+            dataKeyPtr = JSON_BIN;
+        break;
+        case LE_SMS_FORMAT_PDU:
+            dataKeyPtr = JSON_PDU;
+        break;
+        default:
+        break;
+    }
 
-            // Add phone number
-            le_result_t result = le_sms_GetSenderTel(msgRef, tel, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
+    hexPtr = dataKeyPtr ? json_string_value(json_object_get(jsonRootPtr, dataKeyPtr)) : NULL;
+    if (hexPtr)
+    {
+        int32_t dataSize = le_hex_StringToBinary(hexPtr, strlen(hexPtr), data, sizeof(data));
 
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get the tel number %d", result);
-            }
-            else
+        if (dataSize >= 0)
+        {
+            if (LE_SMS_FORMAT_TEXT == msg.hdr.format)
             {
-                LE_DEBUG("Tel num: %s", tel);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_SENDERTEL, tel);
+                // The text was stored with its '\0'
+                dataSize = strnlen((const char*)data, sizeof(data) - 1);
+                data[dataSize++] = '\0';
             }
+            msg.dataPtr = data;
+            msg.hdr.dataSize = dataSize;
+        }
+        else
+        {
+            LE_ERROR("Bad %s field in message %u", dataKeyPtr, msgId);
+        }
+    }
 
-            // Add timestamp
-            char timeStamp[LE_SMS_TIMESTAMP_MAX_BYTES];
-            result = le_sms_GetTimeStamp (msgRef, timeStamp, LE_SMS_TIMESTAMP_MAX_BYTES);
-
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get the timestamp %d", result);
-            }
-            else
-            {
-                LE_DEBUG("Timestamp: %s", timeStamp);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_TIMESTAMP, timeStamp);
-            }
+    uint8_t payload[MSG_PAYLOAD_MAX_SIZE];
+    size_t payloadSize = EncodeMsgPayload(payload, &msg);
+    le_result_t res = AddMsg(msgId, memberMask, unreadMask, payload, payloadSize);
 
-            size_t len = le_sms_GetUserdataLen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
+    json_decref(jsonRootPtr);
 
-            // Add a character for last '\0'
-            len++;
+    return res;
+}
 
-            uint8_t bin[len];
-            memset(bin, 0, len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string, 0, strLen);
-            const char* jsonKey;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Import the legacy message box files into the store, and remove them once they are imported
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void MigrateLegacyStore
+(
+    void
+)
+{
+    char path[PATH_MAX];
+    json_t* jsonRootPtr[MAX_APPS] = {NULL};
+    json_t* mboxListPtr[MAX_APPS] = {NULL};
+    struct dirent **namelist;
+    int nbEntries;
+    int nbMsg = 0;
+    bool complete = true;
+    int i;
 
-            if (format == LE_SMS_FORMAT_TEXT)
-            {
-                // Get text
-                result = le_sms_GetText(msgRef, (char*) bin, len);
-                jsonKey = JSON_TEXT;
-            }
-            else
-            {
-                // Get binary
-                result = le_sms_GetBinary(msgRef, bin, &len);
-                jsonKey = JSON_BIN;
-            }
+    nbEntries = scandir(SMSINBOX_PATH MSG_PATH, &namelist, NULL, alphasort);
+    if (nbEntries < 0)
+    {
+        // No legacy message: remove the legacy message box files, if any
+        nbEntries = 0;
+        namelist = NULL;
+    }
 
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get payload %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
-            }
-            else
-            {
-                // Convert payload in string: json supports only utf-8 characters.
-                // Some extended-ASCII characters can be sent by SMS (such as character with accent)
-                // and can't be convert directly in utf-8. A convertion in string solves this issue.
-                strLen = le_hex_BinaryToString(bin, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, jsonKey, string);
+    for (i = 0; i < MAX_APPS; i++)
+    {
+        if (Apps[i].namePtr)
+        {
+            json_error_t error;
 
-            }
+            snprintf(path, sizeof(path), "%s%s%s%s", SMSINBOX_PATH, CONF_PATH,
+                     Apps[i].namePtr, FILE_EXTENSION);
+            jsonRootPtr[i] = json_load_file(path, 0, &error);
+            mboxListPtr[i] = json_object_get(jsonRootPtr[i], JSON_MSGINBOX);
         }
-        break;
+    }
 
-        case LE_SMS_FORMAT_PDU:
-        {
-            size_t len = le_sms_GetPDULen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
-            // Add a character for last '\0'
-            len++;
-            uint8_t pdu[len];
-            memset(pdu, 0, len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string, 0, strLen);
+    // The file names are the message identifiers in hexadecimal, so they are sorted by identifier
+    for (i = 0; i < nbEntries; i++)
+    {
+        char* endPtr;
+        MessageId_t msgId = strtoul(namelist[i]->d_name, &endPtr, 16);
 
-            // Add pdu
-            le_result_t result = le_sms_GetPDU(msgRef, pdu, &len);
+        if ((endPtr != namelist[i]->d_name) && (0 == strcmp(endPtr, FILE_EXTENSION)))
+        {
+            snprintf(path, sizeof(path), "%s%s%s", SMSINBOX_PATH, MSG_PATH, namelist[i]->d_name);
 
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get pdu %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
-            }
-            else
+            if (MigrateLegacyMsg(path, msgId, mboxListPtr) == LE_FAULT)
             {
-                // Convert pdu in string
-                strLen = le_hex_BinaryToString(pdu, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_PDU, string);
-                LE_DEBUG("PDU format OK");
+                complete = false;
             }
+            nbMsg++;
         }
-        break;
-        case LE_SMS_FORMAT_UNKNOWN:
-        default:
-            LE_ERROR("Bad format %d", format);
     }
 
-    // Write json file in the file system
-    char* jsondumpStr = json_dumps( (const json_t *) jsonRootPtr,
-                                    JSON_INDENT(1) | JSON_PRESERVE_ORDER);
-    if (!jsondumpStr)
+    // Keep the legacy files until the messages are safely stored, they are imported again at next
+    // start otherwise
+    if (complete && nbMsg && (fdatasync(StoreFd) != 0))
     {
-        LE_ERROR("JsondumpStr is NULL");
-        return LE_FAULT;
+        LE_ERROR("Unable to sync the message store: %m");
+        complete = false;
     }
 
-    char* restJsondumpStr = jsondumpStr;
-    ssize_t writeSize = strlen(jsondumpStr);
-    ssize_t writtenSize;
+    for (i = 0; i < nbEntries; i++)
+    {
+        if (complete && strcmp(namelist[i]->d_name, ".") && strcmp(namelist[i]->d_name, ".."))
+        {
+            snprintf(path, sizeof(path), "%s%s%s", SMSINBOX_PATH, MSG_PATH, namelist[i]->d_name);
+            unlink(path);
+        }
+        free(namelist[i]);
+    }
+    free(namelist);
 
-    do
+    for (i = 0; i < MAX_APPS; i++)
     {
-        writtenSize = write( fd, restJsondumpStr, writeSize );
-        if (writtenSize > 0)
+        if (jsonRootPtr[i])
+        {
+            json_decref(jsonRootPtr[i]);
+        }
+
+        if (complete && Apps[i].namePtr)
         {
-            writeSize -= writtenSize;
-            restJsondumpStr += writtenSize;
+            snprintf(path, sizeof(path), "%s%s%s%s", SMSINBOX_PATH, CONF_PATH,
+                     Apps[i].namePtr, FILE_EXTENSION);
+            unlink(path);
         }
     }
-    while ((writeSize > 0) && ((writtenSize >= 0) || (EINTR == errno)));
 
-    free(jsondumpStr);
-    json_decref(jsonRootPtr);
+    if (complete)
+    {
+        rmdir(SMSINBOX_PATH MSG_PATH);
+        rmdir(SMSINBOX_PATH CONF_PATH);
+    }
 
-    return LE_OK;
+    if (nbMsg)
+    {
+        LE_INFO("%d legacy messages imported%s", nbMsg, complete ? "" : " with errors");
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create a new message entry
+ * Load the message store, if not done yet
+ *
+ * The store is loaded on first use rather than at start-up, so that the service is up without
+ * waiting for the file system.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateMsgEntry
+static le_result_t OpenStore
 (
-    MessageId_t *msgPtr,    ///<[OUT] create messageId
-    int32_t *fdPtr         ///<[OUT] Created file descriptor
+    void
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-
-    GetSMSInboxMessagePath(NextMessageId, path, pathLen);
-    LE_DEBUG("Create entry: NextMessageId %d, path %s",NextMessageId, path);
-
-    *fdPtr = open( path, O_CREAT | O_RDWR | O_SYNC, S_IRUSR | S_IWUSR );
+    if (StoreFd >= 0)
+    {
+        return LE_OK;
+    }
 
-    if (*fdPtr < 0)
+    if (LE_OK != MkdirCreate(SMSINBOX_PATH))
     {
-        LE_ERROR("No such file: %s: %m", path);
         return LE_FAULT;
     }
 
-    LE_DEBUG("New entry: %s", path);
+    StoreFd = open(SMSINBOX_PATH STORE_FILE, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                   S_IRUSR | S_IWUSR);
+    if (StoreFd < 0)
+    {
+        LE_ERROR("Unable to open %s: %m", SMSINBOX_PATH STORE_FILE);
+        return LE_FAULT;
+    }
 
-    int i;
+    bool rewrite = LoadStore();
 
-    // For all the applications
-    for (i = 0; i < MAX_APPS; i++)
+    if (rewrite || (StoreDeadSize > STORE_COMPACT_MIN_SIZE && StoreDeadSize > StoreSize / 2))
     {
-        if ( Apps[i].namePtr && strlen(Apps[i].namePtr) )
+        if (CompactStore() != LE_OK)
         {
-            AddMsgInAppCfg(&Apps[i], NextMessageId);
+            LE_ERROR("Unable to rewrite the message store");
+
+            if (rewrite)
+            {
+                le_dls_Link_t* linkPtr;
+
+                while ((linkPtr = le_dls_Peek(&MsgList)) != NULL)
+                {
+                    ReleaseMsgEntry(CONTAINER_OF(linkPtr, MsgEntry_t, link));
+                }
+                close(StoreFd);
+                StoreFd = -1;
+                return LE_FAULT;
+            }
         }
     }
 
-    *msgPtr = NextMessageId;
+    MigrateLegacyStore();
+
+    LE_DEBUG("Message store loaded: %zu messages, size %u, NextMessageId %u",
+             le_hashmap_Size(MsgIndex), StoreSize, NextMessageId);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a message of a message box
+ *
+ * @return The message, or NULL if the message box does not hold the message
+ */
+//--------------------------------------------------------------------------------------------------
+static MsgEntry_t* GetMsgEntry
+(
+    const MboxCtx_t* mboxPtr,   ///<[IN] message box
+    MessageId_t messageId       ///<[IN] message identifier
+)
+{
+    MsgEntry_t* entryPtr = (StoreFd >= 0) ? le_hashmap_Get(MsgIndex, &messageId) : NULL;
 
-    NextMessageId++;
+    if ((NULL == entryPtr) || !(entryPtr->memberMask & GetMboxMask(mboxPtr)))
+    {
+        LE_ERROR("Bad msg id or mbox name");
+        return NULL;
+    }
 
-    return LE_OK;
+    return entryPtr;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Convert the file name string in hexa
+ * Get the first message of a message box, starting from a message of MsgList
  *
- * @return
- *      - Positive integer corresponding to the hexadecimal input string
- *      - -1 in case of error
+ * @return The message, or NULL if there is none
  */
 //--------------------------------------------------------------------------------------------------
-static MessageId_t GetMessageId
+static MsgEntry_t* FindMsgInMbox
 (
-    char* fileNamePtr  ///<[IN] file name to be converted
+    le_dls_Link_t* linkPtr,     ///<[IN] first message to check, or NULL
+    MboxMask_t mboxMask         ///<[IN] message box
 )
 {
-    char *savePtr;
-
-    if(NULL != fileNamePtr)
+    while (linkPtr)
     {
-        char *str = strtok_r(fileNamePtr,".", &savePtr);
+        MsgEntry_t* entryPtr = CONTAINER_OF(linkPtr, MsgEntry_t, link);
 
-        if (NULL == str)
+        if (entryPtr->memberMask & mboxMask)
         {
-            LE_ERROR("Unable to find . in the file name");
-            return -1;
+            return entryPtr;
         }
-        return le_hex_HexaToInteger(str);
-    }
-    else
-    {
-        LE_ERROR("Provided file name pointer is NULL");
-        return -1;
+
+        linkPtr = le_dls_PeekNext(&MsgList, linkPtr);
     }
+
+    return NULL;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create a directory
+ * Remove the oldest message of a message box
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t MkdirCreate
+static le_result_t RemoveOldestMsg
 (
-    const char* path    ///<[IN] path for directory creation
+    const MboxCtx_t* mboxPtr    ///<[IN] message box
 )
 {
-    int status = mkdir(path, S_IRWXU|S_IRWXG);
-    if (0 != status)
+    MboxMask_t mboxMask = GetMboxMask(mboxPtr);
+    MsgEntry_t* entryPtr = FindMsgInMbox(le_dls_Peek(&MsgList), mboxMask);
+
+    if (NULL == entryPtr)
     {
-        if (EEXIST != errno)
-        {
-            LE_ERROR("Unable to create directory %s: %m", path);
-            return LE_FAULT;
-        }
+        return LE_NOT_FOUND;
     }
-    return LE_OK;
+
+    LE_DEBUG("Remove %u from %s", entryPtr->id, mboxPtr->namePtr);
+
+    return SetMsgState(entryPtr, entryPtr->memberMask & ~mboxMask,
+                       entryPtr->unreadMask & ~mboxMask);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Init the SMSInBox directory
+ * Store a new message in all the message boxes
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void InitSmsInBoxDirectory
+static le_result_t StoreMsg
 (
-    void
+    le_sms_MsgRef_t msgRef,     ///<[IN] SMS to store
+    MessageId_t* msgIdPtr       ///<[OUT] message identifier
 )
 {
-    struct dirent **namelist;
-    uint32_t nbSmsEntries;
-
-    LE_DEBUG("InitSmsInBoxDirectory");
-
-    // create directories
-    if (LE_OK != MkdirCreate(SMSINBOX_PATH))
+    if (OpenStore() != LE_OK)
     {
-        return;
+        return LE_FAULT;
     }
 
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, CONF_PATH);
+    Msg_t msg;
+    char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES] = {0};
+    char timeStamp[LE_SMS_TIMESTAMP_MAX_BYTES] = {0};
+    uint8_t data[MSG_DATA_MAX_BYTES] = {0};
+    size_t len;
+    le_result_t result;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.hdr.format = le_sms_GetFormat(msgRef);
+    msg.imsiPtr = SimImsi;
 
-    if (LE_OK != MkdirCreate(path))
+    switch (msg.hdr.format)
     {
-        return;
-    }
+        case LE_SMS_FORMAT_TEXT:
+        case LE_SMS_FORMAT_BINARY:
+        {
+            // Add phone number
+            result = le_sms_GetSenderTel(msgRef, tel, sizeof(tel));
 
-    memset(path, 0, pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, MSG_PATH);
+            if (result != LE_OK)
+            {
+                LE_ERROR("Unable to get the tel number %d", result);
+            }
+            else
+            {
+                LE_DEBUG("Tel num: %s", tel);
+                msg.telPtr = tel;
+            }
 
-    if (LE_OK != MkdirCreate(path))
-    {
-        return;
+            // Add timestamp
+            result = le_sms_GetTimeStamp(msgRef, timeStamp, sizeof(timeStamp));
+
+            if (result != LE_OK)
+            {
+                LE_ERROR("Unable to get the timestamp %d", result);
+            }
+            else
+            {
+                LE_DEBUG("Timestamp: %s", timeStamp);
+                msg.timestampPtr = timeStamp;
+            }
+
+            msg.hdr.msgLen = le_sms_GetUserdataLen(msgRef);
+
+            if (LE_SMS_FORMAT_TEXT == msg.hdr.format)
+            {
+                // Get text
+                result = le_sms_GetText(msgRef, (char*)data, sizeof(data));
+                len = strnlen((const char*)data, sizeof(data) - 1) + 1;
+            }
+            else
+            {
+                // Get binary
+                len = sizeof(data);
+                result = le_sms_GetBinary(msgRef, data, &len);
+            }
+        }
+        break;
+
+        case LE_SMS_FORMAT_PDU:
+        {
+            msg.hdr.msgLen = le_sms_GetPDULen(msgRef);
+
+            // Add pdu
+            len = sizeof(data);
+            result = le_sms_GetPDU(msgRef, data, &len);
+        }
+        break;
+
+        case LE_SMS_FORMAT_UNKNOWN:
+        default:
+            LE_ERROR("Bad format %d", msg.hdr.format);
+            result = LE_FAULT;
+            len = 0;
+        break;
     }
 
-    nbSmsEntries = scandir(path, &namelist, NULL, alphasort);
-    if ( nbSmsEntries > 2 )
+    if (result != LE_OK)
     {
-        uint8_t len = strlen(namelist[nbSmsEntries-1]->d_name);
-        char name[len+1];
-        MessageId_t id;
+        LE_ERROR("Unable to get payload %d", result);
+        msg.hdr.msgLen = 0;
+    }
+    else
+    {
+        msg.dataPtr = data;
+        msg.hdr.dataSize = len;
+    }
 
-        memset(name, 0, len+1);
-        strncpy(name, namelist[nbSmsEntries-1]->d_name, len);
+    // Make room in the message boxes
+    MboxMask_t memberMask = 0;
+    int i;
 
-        id = GetMessageId(name);
-        if (-1 == id)
+    for (i = 0; i < MAX_APPS; i++)
+    {
+        if (Apps[i].namePtr && Apps[i].inboxSize)
         {
-            LE_ERROR("Unable to get the id of %s", name);
-            return;
+            while ((Apps[i].msgCount >= Apps[i].inboxSize) && (RemoveOldestMsg(&Apps[i]) == LE_OK))
+            {
+            }
+            memberMask |= GetMboxMask(&Apps[i]);
         }
+    }
 
-        NextMessageId = ++id;
+    uint8_t payload[MSG_PAYLOAD_MAX_SIZE];
+    size_t payloadSize = EncodeMsgPayload(payload, &msg);
 
-        LE_DEBUG("NextMessageId %d", (int) NextMessageId);
+    if (AddMsg(NextMessageId, memberMask, memberMask, payload, payloadSize) != LE_OK)
+    {
+        return LE_FAULT;
     }
 
-    while (nbSmsEntries--)
+    // The SMS is deleted from the SIM once stored
+    if (fdatasync(StoreFd) != 0)
     {
-        free(namelist[nbSmsEntries]);
+        LE_ERROR("Unable to sync the message store: %m");
     }
 
-    free(namelist);
+    *msgIdPtr = NextMessageId - 1;
+    LE_DEBUG("New entry %u", *msgIdPtr);
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1545,7 +1917,6 @@ static void MoveSmsFromSimToFolder
     void
 )
 {
-    int32_t fd;
     le_result_t result = LE_OK;
 
     le_sms_MsgListRef_t msgListRef = le_sms_CreateRxMsgList();
@@ -1562,18 +1933,7 @@ static void MoveSmsFromSimToFolder
     {
         MessageId_t msgId;
 
-        result = CreateMsgEntry(&msgId, &fd);
-
-        if (result == LE_OK)
-        {
-            if ( EncodeMsgEntry(fd, smsRef) != LE_OK )
-            {
-                LE_ERROR("Encoding issue");
-            }
-
-            close(fd);
-        }
-        else
+        if (StoreMsg(smsRef, &msgId) != LE_OK)
         {
             LE_ERROR("Error during new entry creation");
         }
@@ -1602,23 +1962,12 @@ static void NewSmsMsgHandler
     void*           contextPtr
 )
 {
-    int32_t fd;
     le_result_t result;
     MessageId_t msgId;
 
     LE_DEBUG("Receive new message");
 
-    result = CreateMsgEntry(&msgId, &fd);
-
-    if (result == LE_OK)
-    {
-        result = EncodeMsgEntry(fd, msgRef);
-        close(fd);
-    }
-    else
-    {
-        LE_ERROR("CreateMsgEntry error");
-    }
+    result = StoreMsg(msgRef, &msgId);
 
     if (result == LE_OK)
     {
@@ -1630,7 +1979,7 @@ static void NewSmsMsgHandler
     }
     else
     {
-        LE_ERROR("EncodeMsgEntry error");
+        LE_ERROR("StoreMsg error");
     }
 }
 
@@ -1723,6 +2072,7 @@ static le_result_t LoadInboxSettings
     return LE_OK;
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The first-layer New message Handler.
@@ -1820,8 +2170,11 @@ COMPONENT_INIT
     // Retrieve the smsInbox settings from the configuration tree
     LoadInboxSettings();
 
-    // Initialization of the smsInbox directory
-    InitSmsInBoxDirectory();
+    // Create the message index. The message store itself is loaded on first use.
+    MsgEntryPool = le_mem_CreatePool("MsgEntryPool", sizeof(MsgEntry_t));
+    MsgIndex = le_hashmap_Create("MsgIndex",
+                                 (MaxInboxSize > MSG_INDEX_SIZE) ? MaxInboxSize : MSG_INDEX_SIZE,
+                                 le_hashmap_HashUInt32, le_hashmap_EqualsUInt32);
 
     // Create an event Id for new messages
     RxMsgEventId = le_event_CreateId("RxMsgEventId", sizeof(MessageId_t));
@@ -1839,6 +2192,7 @@ COMPONENT_INIT
     LE_INFO("smsInbox Component Init done");
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Open a message box.
@@ -1868,6 +2222,12 @@ SmsInbox_SessionRef_t SmsInbox_Open
         return NULL;
     }
 
+    if (OpenStore() != LE_OK)
+    {
+        LE_ERROR("Message store unavailable");
+        return NULL;
+    }
+
     int i;
 
     for (i=0; i < MAX_APPS; i++)
@@ -2040,30 +2400,21 @@ void SmsInbox_DeleteMsg
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    MsgEntry_t* entryPtr = GetMsgEntry(mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISDELETED, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
+    MboxMask_t mboxMask = GetMboxMask(mboxCtxPtr);
 
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
+    if (SetMsgState(entryPtr, entryPtr->memberMask & ~mboxMask, entryPtr->unreadMask & ~mboxMask)
+        != LE_OK)
     {
-        LE_ERROR("ModifyMsgEntry error");
+        LE_ERROR("Unable to delete message %u", msgId);
     }
-
-    if (DeleteMsgInAppCfg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId)
-                          != LE_OK)
-    {
-        LE_ERROR("DeleteMsgInAppCfg error");
-    }
-
-    PerformDeletion(messageId);
 }
 
 
@@ -2111,13 +2462,14 @@ le_result_t SmsInbox_GetImsi
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
 
     memset(imsiPtr, 0, imsiNumElements);
@@ -2127,14 +2479,12 @@ le_result_t SmsInbox_GetImsi
         return LE_OVERFLOW;
     }
 
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = imsiPtr;
-    decode.uVal.str.lenStr = imsiNumElements;
-    char* key[1] = {JSON_IMSI};
+    if ((res = ReadMsg(entryPtr, &msg)) != LE_OK)
+    {
+        return res;
+    }
 
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                              messageId, key, 1, &decode)) == LE_OK)
+    if ((res = CopyMsgString(msg.imsiPtr, msg.hdr.imsiSize, imsiPtr, imsiNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2178,22 +2528,19 @@ le_sms_Format_t SmsInbox_GetFormat
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_FORMAT};
+    Msg_t msg;
 
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                      &decode) == LE_OK)
+    if (ReadMsg(entryPtr, &msg) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
-        return decode.uVal.val;
+        return msg.hdr.format;
     }
     else
     {
@@ -2243,23 +2590,24 @@ le_result_t SmsInbox_GetSenderTel
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = telPtr;
-    decode.uVal.str.lenStr = telNumElements;
+
     memset(telPtr, 0, telNumElements);
-    char* key[1] = {JSON_SENDERTEL};
 
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key,
-                              1, &decode)) == LE_OK)
+    if ((res = ReadMsg(entryPtr, &msg)) != LE_OK)
+    {
+        return res;
+    }
+
+    if ((res = CopyMsgString(msg.telPtr, msg.hdr.telSize, telPtr, telNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2313,23 +2661,25 @@ le_result_t SmsInbox_GetTimeStamp
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = timestampPtr;
-    decode.uVal.str.lenStr = timestampNumElements;
-    memset(timestampPtr, 0, timestampNumElements);
-    char* key[1] = {JSON_TIMESTAMP};
+    Msg_t msg;
     le_result_t res;
 
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                               key, 1, &decode)) == LE_OK )
+    memset(timestampPtr, 0, timestampNumElements);
+
+    if ((res = ReadMsg(entryPtr, &msg)) != LE_OK)
+    {
+        return res;
+    }
+
+    if ((res = CopyMsgString(msg.timestampPtr, msg.hdr.timestampSize,
+                             timestampPtr, timestampNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2370,28 +2720,20 @@ size_t SmsInbox_GetMsgLen
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
 
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_MSGLEN};
-    le_result_t res;
-
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                                messageId,
-                                key,
-                                1,
-                                &decode)) == LE_OK )
+    if (ReadMsg(entryPtr, &msg) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
 
-        return decode.uVal.val;
+        return msg.hdr.msgLen;
     }
     else
     {
@@ -2399,6 +2741,57 @@ size_t SmsInbox_GetMsgLen
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the data of a message
+ *
+ * @return
+ *  - LE_FORMAT_ERROR  Message is not in the expected format.
+ *  - LE_OVERFLOW      Message length exceed the maximum length.
+ *  - LE_FAULT         The data cannot be read.
+ *  - LE_OK            Function succeeded.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetMsgData
+(
+    const MsgEntry_t* entryPtr,     ///<[IN] message
+    le_sms_Format_t format,         ///<[IN] expected format
+    uint8_t* dataPtr,               ///<[OUT] data buffer
+    size_t* dataSizePtr             ///<[INOUT] size of the data buffer, then size of the data
+)
+{
+    Msg_t msg;
+    le_result_t res;
+
+    if ((res = ReadMsg(entryPtr, &msg)) != LE_OK)
+    {
+        return res;
+    }
+
+    if (msg.hdr.format != format)
+    {
+        LE_ERROR("Message %u format is %d", entryPtr->id, msg.hdr.format);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (NULL == msg.dataPtr)
+    {
+        LE_ERROR("No data");
+        return LE_FAULT;
+    }
+
+    if (msg.hdr.dataSize > *dataSizePtr)
+    {
+        LE_ERROR("Data too long");
+        return LE_OVERFLOW;
+    }
+
+    memcpy(dataPtr, msg.dataPtr, msg.hdr.dataSize);
+    *dataSizePtr = msg.hdr.dataSize;
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the text Message.
@@ -2442,38 +2835,23 @@ le_result_t SmsInbox_GetText
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
+    // The text is stored with its '\0'
+    size_t len = textNumElements;
     le_result_t res;
-    size_t len = 2*textNumElements+1;
-    char tmpTextPtr[len];
-    memset(tmpTextPtr, 0, len);
-    memset(textPtr, 0, textNumElements);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpTextPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_TEXT};
+    memset(textPtr, 0, textNumElements);
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    res = GetMsgData(entryPtr, LE_SMS_FORMAT_TEXT, (uint8_t*)textPtr, &len);
 
     if ( res == LE_OK )
     {
-        if ( le_hex_StringToBinary(tmpTextPtr,
-                                   decode.uVal.str.lenStr,
-                                   (uint8_t*) textPtr,
-                                   textNumElements ) < 0 )
-        {
-            return LE_FAULT;
-        }
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2529,42 +2907,21 @@ le_result_t SmsInbox_GetBinary
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*binNumElementsPtr)+1;
-    char tmpBinPtr[len];
-    memset(tmpBinPtr, 0, len);
-    memset(binPtr, 0, *binNumElementsPtr);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpBinPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_BIN};
+    memset(binPtr, 0, *binNumElementsPtr);
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                         key, 1, &decode);
+    res = GetMsgData(entryPtr, LE_SMS_FORMAT_BINARY, binPtr, binNumElementsPtr);
 
     if ( res == LE_OK )
     {
-        int32_t binNumElements = le_hex_StringToBinary(tmpBinPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    binPtr,
-                                                    *binNumElementsPtr);
-
-        if ( binNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *binNumElementsPtr = binNumElements;
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2624,42 +2981,21 @@ le_result_t SmsInbox_GetPdu
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MsgEntry_t* entryPtr = GetMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*pduNumElementsPtr)+1;
-    char tmpPduPtr[len];
-    memset(tmpPduPtr, 0, len);
-    memset(pduPtr, 0, *pduNumElementsPtr);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpPduPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_PDU};
+    memset(pduPtr, 0, *pduNumElementsPtr);
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    res = GetMsgData(entryPtr, LE_SMS_FORMAT_PDU, pduPtr, pduNumElementsPtr);
 
     if ( res == LE_OK )
     {
-        int32_t pduNumElements = le_hex_StringToBinary(tmpPduPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    pduPtr,
-                                                    *pduNumElementsPtr);
-
-        if ( pduNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *pduNumElementsPtr = pduNumElements;
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2698,75 +3034,29 @@ uint32_t SmsInbox_GetFirst
         return 0;
     }
 
-    uint32_t pathLen = GetSMSInboxConfigPathLen(clientRequestPtr->
-                                                mboxSessionPtr->mboxCtxPtr->namePtr);
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    GetSMSInboxConfigPath(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, path, pathLen);
-    le_result_t res = LE_OK;
-    MessageId_t messageId=0;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
+    MsgEntry_t* entryPtr = NULL;
 
-    if ( GetMsgListFromMbox(path,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr) != LE_OK )
+    if (OpenStore() == LE_OK)
     {
-        LE_ERROR("Error in GetMsgListFromMbox");
-        return 0;
+        entryPtr = FindMsgInMbox(le_dls_Peek(&MsgList),
+                                 GetMboxMask(clientRequestPtr->mboxSessionPtr->mboxCtxPtr));
     }
 
-    clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex =
-                      json_array_size(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr);
-
-    LE_DEBUG("MaxIndex %d", clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex);
-
-    if ( clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex > 0 )
-    {
-        json_t * jsonIntegerPtr =
-                 json_array_get(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr, 0);
-
-        if (jsonIntegerPtr)
-        {
-            messageId = json_integer_value(jsonIntegerPtr);
-        }
-        else
-        {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
-        }
-
-        if (messageId)
-        {
-            clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex = 1;
-        }
-        else
-        {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
-        }
-    }
-    else
+    if (NULL == entryPtr)
     {
-        res = LE_FAULT;
         LE_DEBUG("Empty mbox");
-    }
-
-    if (res == LE_FAULT)
-    {
-        if (clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr)
-        {
-            json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-        }
-
-        memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
-
+        memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
         return 0;
     }
-    else
-    {
-        return messageId;
-    }
 
-    return 0;
+    // Messages received after this call are left out of the browse, as the list of the message
+    // box used to be read once here
+    browseCtxPtr->isBrowsing = true;
+    browseCtxPtr->lastMsgId = entryPtr->id;
+    browseCtxPtr->maxMsgId = CONTAINER_OF(le_dls_PeekTail(&MsgList), MsgEntry_t, link)->id;
+
+    return entryPtr->id;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2794,60 +3084,51 @@ uint32_t SmsInbox_GetNext
         return LE_BAD_PARAMETER;
     }
 
-    while(clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex !=
-          clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex)
+    if (clientRequestPtr->mboxSessionPtr == NULL)
     {
-        LE_DEBUG("CurrentIndex %d, maxIndex %d", clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.maxIndex);
-
-        json_t * jsonIntegerPtr = json_array_get(clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.jsonArrayPtr,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex);
-
-        if (jsonIntegerPtr)
-        {
-            MessageId_t messageId = json_integer_value(jsonIntegerPtr);
+        LE_ERROR("Bad mbox reference");
+        return 0;
+    }
 
-            if (messageId > 0)
-            {
-                clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex++;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
 
-                // Check if the message exist (it may be deleted since the GetFirst call)
-                uint16_t pathLen = GetSMSInboxMessagePathLen();
-                char path[pathLen];
-                memset(path, 0, pathLen);
-                GetSMSInboxMessagePath(messageId, path, pathLen);
-                int32_t fd = open(path, O_RDWR);
+    if (!browseCtxPtr->isBrowsing)
+    {
+        return 0;
+    }
 
-                if (fd >= 0)
-                {
-                    // message is still existing
-                    close(fd);
-                    return messageId;
-                }
+    MboxMask_t mboxMask = GetMboxMask(clientRequestPtr->mboxSessionPtr->mboxCtxPtr);
+    MsgEntry_t* entryPtr = le_hashmap_Get(MsgIndex, &browseCtxPtr->lastMsgId);
+    le_dls_Link_t* linkPtr;
 
-                // else continue the parsing
-            }
-            else
-            {
-                LE_ERROR("Json error");
-            }
-        }
-        else
+    if (entryPtr)
+    {
+        linkPtr = le_dls_PeekNext(&MsgList, &entryPtr->link);
+    }
+    else
+    {
+        // The last message was deleted since the previous call: the list is ordered by
+        // identifier, so resume from the first message received after it
+        linkPtr = le_dls_Peek(&MsgList);
+        while (linkPtr &&
+               (CONTAINER_OF(linkPtr, MsgEntry_t, link)->id <= browseCtxPtr->lastMsgId))
         {
-            LE_ERROR("Json error");
+            linkPtr = le_dls_PeekNext(&MsgList, linkPtr);
         }
     }
 
-    // Parsing end => free the memory
-    LE_DEBUG("No more messages");
-    json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-    memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
+    entryPtr = FindMsgInMbox(linkPtr, mboxMask);
+
+    if ((NULL == entryPtr) || (entryPtr->id > browseCtxPtr->maxMsgId))
+    {
+        LE_DEBUG("No more messages");
+        memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
+        return 0;
+    }
+
+    browseCtxPtr->lastMsgId = entryPtr->id;
 
-    return 0;
+    return entryPtr->id;
 }
 //--------------------------------------------------------------------------------------------------
 /**
@@ -2886,27 +3167,15 @@ bool SmsInbox_IsUnread
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    MsgEntry_t* entryPtr = GetMsgEntry(mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[] = {JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 2,
-                       &decode) == LE_OK)
-    {
-        return decode.uVal.boolVal;
-    }
-    else
-    {
-        LE_ERROR("Error in DecodeMsgEntry");
-        return false;
-    }
+    return (entryPtr->unreadMask & GetMboxMask(mboxCtxPtr)) != 0;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2941,21 +3210,18 @@ void SmsInbox_MarkRead
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    MsgEntry_t* entryPtr = GetMsgEntry(mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = false;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
+    if (SetMsgState(entryPtr, entryPtr->memberMask,
+                    entryPtr->unreadMask & ~GetMboxMask(mboxCtxPtr)) != LE_OK)
     {
-        LE_ERROR("Error in ModifyMsgEntry");
+        LE_ERROR("Unable to mark message %u as read", msgId);
     }
 }
 
@@ -2991,21 +3257,18 @@ void SmsInbox_MarkUnread
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    MsgEntry_t* entryPtr = GetMsgEntry(mboxCtxPtr, msgId);
+    if (NULL == entryPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
+    if (SetMsgState(entryPtr, entryPtr->memberMask,
+                    entryPtr->unreadMask | GetMboxMask(mboxCtxPtr)) != LE_OK)
     {
-        LE_ERROR("Error in ModifyMsgEntry");
+        LE_ERROR("Unable to mark message %u as unread", msgId);
     }
 }
 
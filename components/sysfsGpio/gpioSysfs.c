@@ -8599,6 +8599,62 @@ le_result_t le_gpioPin64_DisableEdgeSense (void)
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * All the pins, GpioRefs[n-1] being GPIO n. Used by the bank service.
+ */
+//--------------------------------------------------------------------------------------------------
+static const gpioSysfs_GpioRef_t GpioRefs[] =
+{
+    &SysfsGpioPin1, &SysfsGpioPin2, &SysfsGpioPin3, &SysfsGpioPin4,
+    &SysfsGpioPin5, &SysfsGpioPin6, &SysfsGpioPin7, &SysfsGpioPin8,
+    &SysfsGpioPin9, &SysfsGpioPin10, &SysfsGpioPin11, &SysfsGpioPin12,
+    &SysfsGpioPin13, &SysfsGpioPin14, &SysfsGpioPin15, &SysfsGpioPin16,
+    &SysfsGpioPin17, &SysfsGpioPin18, &SysfsGpioPin19, &SysfsGpioPin20,
+    &SysfsGpioPin21, &SysfsGpioPin22, &SysfsGpioPin23, &SysfsGpioPin24,
+    &SysfsGpioPin25, &SysfsGpioPin26, &SysfsGpioPin27, &SysfsGpioPin28,
+    &SysfsGpioPin29, &SysfsGpioPin30, &SysfsGpioPin31, &SysfsGpioPin32,
+    &SysfsGpioPin33, &SysfsGpioPin34, &SysfsGpioPin35, &SysfsGpioPin36,
+    &SysfsGpioPin37, &SysfsGpioPin38, &SysfsGpioPin39, &SysfsGpioPin40,
+    &SysfsGpioPin41, &SysfsGpioPin42, &SysfsGpioPin43, &SysfsGpioPin44,
+    &SysfsGpioPin45, &SysfsGpioPin46, &SysfsGpioPin47, &SysfsGpioPin48,
+    &SysfsGpioPin49, &SysfsGpioPin50, &SysfsGpioPin51, &SysfsGpioPin52,
+    &SysfsGpioPin53, &SysfsGpioPin54, &SysfsGpioPin55, &SysfsGpioPin56,
+    &SysfsGpioPin57, &SysfsGpioPin58, &SysfsGpioPin59, &SysfsGpioPin60,
+    &SysfsGpioPin61, &SysfsGpioPin62, &SysfsGpioPin63, &SysfsGpioPin64,
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the value of a set of pins held by the client.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gpioBank_Read
+(
+    uint64_t pinMask,       ///< [IN] Pins to read (bit n-1 for GPIO n).
+    uint64_t* valuesPtr     ///< [OUT] Values of the pins (1 = active).
+)
+{
+    return gpioSysfs_ReadPins(GpioRefs, NUM_ARRAY_MEMBERS(GpioRefs),
+                              le_gpioBank_GetClientSessionRef(), pinMask, valuesPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drive a set of output pins held by the client.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gpioBank_Write
+(
+    uint64_t pinMask,       ///< [IN] Pins to drive (bit n-1 for GPIO n).
+    uint64_t values         ///< [IN] Values to drive (1 = active).
+)
+{
+    return gpioSysfs_WritePins(GpioRefs, NUM_ARRAY_MEMBERS(GpioRefs),
+                               le_gpioBank_GetClientSessionRef(), pinMask, values);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The place where the component starts up.  All initialization happens here.
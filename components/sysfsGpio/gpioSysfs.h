@@ -122,6 +122,23 @@ typedef enum
 }
 gpioSysfs_OpenDrainOperation_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The sysfs attributes of a GPIO signal, which file descriptors are kept open while the pin is
+ * in use.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SYSFS_ATTR_VALUE,        ///< "value"
+    SYSFS_ATTR_DIRECTION,    ///< "direction"
+    SYSFS_ATTR_EDGE,         ///< "edge"
+    SYSFS_ATTR_ACTIVE_LOW,   ///< "active_low"
+    SYSFS_ATTR_PULL,         ///< "pull"
+    SYSFS_ATTR_MAX           ///< Number of attributes
+}
+gpioSysfs_Attr_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Setup GPIO pullup/pulldown.
@@ -435,6 +452,44 @@ bool gpioSysfs_IsPinAvailable
     int pinNum         ///< [IN] GPIO pin number (starting at 1)
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the value of a set of pins held by the client process of a session.
+ *
+ * @return
+ * - LE_OK on success
+ * - LE_NOT_PERMITTED if a pin of the mask is not held by the client process
+ * - LE_IO_ERROR if a pin could not be read
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gpioSysfs_ReadPins
+(
+    const gpioSysfs_GpioRef_t* gpioRefs,  ///< [IN] GPIO objects, gpioRefs[n-1] being GPIO n
+    size_t nbGpios,                       ///< [IN] Number of GPIO objects
+    le_msg_SessionRef_t sessionRef,       ///< [IN] Session of the client
+    uint64_t pinMask,                     ///< [IN] Pins to read (bit n-1 for GPIO n)
+    uint64_t* valuesPtr                   ///< [OUT] Values of the pins
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drive a set of output pins held by the client process of a session.
+ *
+ * @return
+ * - LE_OK on success
+ * - LE_NOT_PERMITTED if a pin of the mask is not held by the client process
+ * - LE_IO_ERROR if a pin could not be driven
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gpioSysfs_WritePins
+(
+    const gpioSysfs_GpioRef_t* gpioRefs,  ///< [IN] GPIO objects, gpioRefs[n-1] being GPIO n
+    size_t nbGpios,                       ///< [IN] Number of GPIO objects
+    le_msg_SessionRef_t sessionRef,       ///< [IN] Session of the client
+    uint64_t pinMask,                     ///< [IN] Pins to drive (bit n-1 for GPIO n)
+    uint64_t values                       ///< [IN] Values to drive
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The struct of Sysfs object
@@ -448,6 +503,9 @@ struct gpioSysfs_Gpio {
     void *callbackContextPtr;                     ///< Client context to be passed back
     le_fdMonitor_Ref_t fdMonitor;                 ///< fdMonitor Object associated to this GPIO
     le_msg_SessionRef_t currentSession;           ///< Current valid IPC session for this pin
+    pid_t clientPid;                              ///< Client process of the current session
+    int attrFd[SYSFS_ATTR_MAX];                   ///< Open sysfs attribute files
+    uint8_t attrFdMask;                           ///< Bit n set when attrFd[n] is open
 };
 
 
@@ -18,7 +18,9 @@
  * GPIO signals have paths like /sys/class/gpio/gpio42/ (for GPIO #42)
  */
 //--------------------------------------------------------------------------------------------------
+#ifndef SYSFS_GPIO_PATH
 #define SYSFS_GPIO_PATH    "/sys/class/gpio"
+#endif
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -28,6 +30,58 @@
 #define MAX_PIN_NUMBER 64
 #define MIN_PIN_NUMBER 1
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Names of the GPIO signal attributes, indexed by gpioSysfs_Attr_t
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const AttrNames[SYSFS_ATTR_MAX] =
+{
+    [SYSFS_ATTR_VALUE]      = "value",
+    [SYSFS_ATTR_DIRECTION]  = "direction",
+    [SYSFS_ATTR_EDGE]       = "edge",
+    [SYSFS_ATTR_ACTIVE_LOW] = "active_low",
+    [SYSFS_ATTR_PULL]       = "pull",
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the file of a GPIO signal attribute, if it is open
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseAttrFd
+(
+    gpioSysfs_GpioRef_t gpioRef,    ///< [IN] GPIO object reference
+    gpioSysfs_Attr_t attr           ///< [IN] Attribute to close
+)
+{
+    if (gpioRef->attrFdMask & (1 << attr))
+    {
+        const int ret = close(gpioRef->attrFd[attr]);
+        LE_WARN_IF(ret == -1, "Failed to close %s of gpio %d: %m",
+                   AttrNames[attr], gpioRef->pinNum);
+        gpioRef->attrFdMask &= ~(1 << attr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close all the open attribute files of a GPIO
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseAttrFds
+(
+    gpioSysfs_GpioRef_t gpioRef     ///< [IN] GPIO object reference
+)
+{
+    gpioSysfs_Attr_t attr;
+
+    for (attr = 0; attr < SYSFS_ATTR_MAX; attr++)
+    {
+        CloseAttrFd(gpioRef, attr);
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Remove the change callback for the given GPIO
@@ -151,7 +205,7 @@ static le_result_t ExportGpio
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set sysfs GPIO signals attributes
+ * Get the file descriptor of a sysfs GPIO signal attribute.
  *
  * GPIO signals have paths like /sys/class/gpio/gpioN/
  * and have the following read/write attributes:
@@ -161,70 +215,171 @@ static le_result_t ExportGpio
  * - "active_low"
  * - "pull"
  *
+ * The file is opened on first use and then kept open until the session on the pin is closed, so
+ * that an access to the attribute only costs a single pread() or pwrite().
+ *
  * @return
- * - LE_IO_ERROR if there was an error while writing the sysfs entry
+ * - LE_IO_ERROR if the file could not be opened
  * - LE_BAD_PARAMETER if the path doesn't exist
  * - LE_OK on success
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t WriteSysGpioSignalAttr
+static le_result_t GetAttrFd
 (
-    const char *path,        ///< [IN] path to sysfs gpio signal
-    const char *attr         ///< [IN] GPIO signal write attribute
+    gpioSysfs_GpioRef_t gpioRef,    ///< [IN] GPIO object reference
+    gpioSysfs_Attr_t attr,          ///< [IN] GPIO signal attribute
+    int *fdPtr                      ///< [OUT] File descriptor of the attribute
 )
 {
-    FILE *fp = NULL;
+    char path[64];
+    int fd;
 
-    if (!CheckGpioPathExist(path))
+    if (gpioRef->attrFdMask & (1 << attr))
     {
-        LE_ERROR("GPIO %s does not exist (probably not exported)", path);
-        return LE_BAD_PARAMETER;
+        *fdPtr = gpioRef->attrFd[attr];
+        return LE_OK;
     }
 
+    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, AttrNames[attr]);
+
     do
     {
-        fp = fopen(path, "w");
+        fd = open(path, O_RDWR | O_CLOEXEC);
     }
-    while ((fp == NULL) && (errno == EINTR));
+    while ((fd < 0) && (errno == EINTR));
 
-    if (!fp)
+    // Some attributes are read-only, e.g. "direction" on a pin which direction is fixed
+    if ((fd < 0) && (errno == EACCES))
     {
-        LE_ERROR("Error opening file %s for writing.\n", path);
+        do
+        {
+            fd = open(path, O_RDONLY | O_CLOEXEC);
+        }
+        while ((fd < 0) && (errno == EINTR));
+    }
+
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            LE_ERROR("GPIO %s does not exist (probably not exported)", path);
+            return LE_BAD_PARAMETER;
+        }
+
+        LE_ERROR("Error opening file %s. %m", path);
         return LE_IO_ERROR;
     }
 
-    ssize_t written = fwrite(attr, 1, strlen(attr), fp);
-    fflush(fp);
+    gpioRef->attrFd[attr] = fd;
+    gpioRef->attrFdMask |= (1 << attr);
+    *fdPtr = fd;
+    return LE_OK;
+}
 
-    int fileError = ferror(fp);
-    if (fileError != 0)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set sysfs GPIO signal attribute
+ *
+ * @return
+ * - LE_IO_ERROR if there was an error while writing the sysfs entry
+ * - LE_BAD_PARAMETER if the path doesn't exist
+ * - LE_OK on success
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteGpioAttr
+(
+    gpioSysfs_GpioRef_t gpioRef,    ///< [IN] GPIO object reference
+    gpioSysfs_Attr_t attr,          ///< [IN] GPIO signal attribute
+    const char *valueStr            ///< [IN] Value to write
+)
+{
+    int fd;
+    ssize_t written;
+    size_t len = strlen(valueStr);
+
+    le_result_t result = GetAttrFd(gpioRef, attr, &fd);
+    if (LE_OK != result)
+    {
+        return result;
+    }
+
+    LE_DEBUG("%s/%s: %s", gpioRef->gpioName, AttrNames[attr], valueStr);
+
+    do
+    {
+        written = pwrite(fd, valueStr, len, 0);
+    }
+    while ((written < 0) && (errno == EINTR));
+
+    if (written < 0)
     {
-        LE_EMERG("Failed to write %s to GPIO config %s. Error %s", attr, path, strerror(fileError));
-        fclose(fp);
+        LE_EMERG("Failed to write %s to GPIO config %s/%s. %m",
+                 valueStr, gpioRef->gpioName, AttrNames[attr]);
+
+        // The file is stale if the pin has been unexported meanwhile: open it again next time
+        CloseAttrFd(gpioRef, attr);
         return LE_IO_ERROR;
     }
 
-    if (written < strlen(attr))
+    if ((size_t)written < len)
     {
-        LE_EMERG("Data truncated while writing %s to GPIO config %s.", path, attr);
-        fclose(fp);
+        LE_EMERG("Data truncated while writing %s to GPIO config %s/%s.",
+                 valueStr, gpioRef->gpioName, AttrNames[attr]);
         return LE_IO_ERROR;
     }
-    fclose(fp);
+
     return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get sysfs GPIO attribute
+ * Get sysfs GPIO signal attribute
  *
- * GPIO signals have paths like /sys/class/gpio/gpioN/
- * and have the following read/write attributes:
- * - "direction"
- * - "value"
- * - "edge"
- * - "active_low"
- * - "pull"
+ * @return
+ * - LE_IO_ERROR if there was an error while reading the sysfs entry
+ * - LE_BAD_PARAMETER if the path doesn't exist
+ * - LE_OK on success
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadGpioAttr
+(
+    gpioSysfs_GpioRef_t gpioRef,    ///< [IN] GPIO object reference
+    gpioSysfs_Attr_t attr,          ///< [IN] GPIO signal attribute
+    int attr_size,                  ///< [IN] the size of attribute content
+    char *attrPtr                   ///< [OUT] GPIO signal read attribute content
+)
+{
+    int fd;
+    ssize_t size;
+
+    le_result_t result = GetAttrFd(gpioRef, attr, &fd);
+    if (LE_OK != result)
+    {
+        return result;
+    }
+
+    do
+    {
+        size = pread(fd, attrPtr, attr_size - 1, 0);
+    }
+    while ((size < 0) && (errno == EINTR));
+
+    if (size < 0)
+    {
+        LE_ERROR("Error reading GPIO config %s/%s. %m", gpioRef->gpioName, AttrNames[attr]);
+        CloseAttrFd(gpioRef, attr);
+        return LE_IO_ERROR;
+    }
+    attrPtr[size] = '\0';
+
+    LE_DEBUG("Read result: %s from %s/%s", attrPtr, gpioRef->gpioName, AttrNames[attr]);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a sysfs GPIO file which is not an attribute of a GPIO signal, e.g. the mask of a chip
  *
  * @return
  * - LE_IO_ERROR if there was an error while reading the sysfs entry
@@ -287,7 +442,6 @@ static le_result_t WriteOutputValue
     gpioSysfs_Value_t level                   ///< [IN] High or low
 )
 {
-    char path[64];
     char attr[16];
 
     if ((!gpioRef) || (gpioRef->pinNum == 0))
@@ -296,11 +450,9 @@ static le_result_t WriteOutputValue
         return LE_BAD_PARAMETER;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "value");
     snprintf(attr, sizeof(attr), "%d", level);
-    LE_DEBUG("path:%s, attr:%s", path, attr);
 
-    return WriteSysGpioSignalAttr(path, attr);
+    return WriteGpioAttr(gpioRef, SYSFS_ATTR_VALUE, attr);
 }
 
 
@@ -323,7 +475,6 @@ static le_result_t SetEdgeSense
     gpioSysfs_EdgeSensivityMode_t edge        ///< [IN] The mode of GPIO Edge Sensivity.
 )
 {
-    char path[64];
     const char *attr;
 
     if ((!gpioRef) || (gpioRef->pinNum == 0))
@@ -332,8 +483,6 @@ static le_result_t SetEdgeSense
         return LE_BAD_PARAMETER;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "edge");
-
     switch(edge)
     {
         case SYSFS_EDGE_SENSE_RISING:
@@ -349,9 +498,8 @@ static le_result_t SetEdgeSense
             attr = "none";
             break;
     }
-    LE_DEBUG("path:%s, attr:%s", path, attr);
 
-    return WriteSysGpioSignalAttr(path, attr);
+    return WriteGpioAttr(gpioRef, SYSFS_ATTR_EDGE, attr);
 }
 
 
@@ -372,7 +520,6 @@ static le_result_t SetDirection
     gpioSysfs_PinMode_t mode           ///< [IN] gpio direction input/output mode
 )
 {
-    char path[64];
     const char *attr;
 
     if ((!gpioRef) || (gpioRef->pinNum == 0))
@@ -381,11 +528,41 @@ static le_result_t SetDirection
         return LE_BAD_PARAMETER;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "direction");
     attr = (mode == SYSFS_PIN_MODE_OUTPUT) ? "out": "in";
-    LE_DEBUG("path:%s, attribute:%s", path, attr);
 
-    return WriteSysGpioSignalAttr(path, attr);
+    return WriteGpioAttr(gpioRef, SYSFS_ATTR_DIRECTION, attr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make sure the GPIO is an output before driving it.
+ *
+ * Writing "out" to "direction" also drives the pin low, so it is only done if the pin is not
+ * already an output: toggling an output then costs a read of "direction" and a write of "value",
+ * without a glitch.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SetOutputDirection
+(
+    gpioSysfs_GpioRef_t gpioRef        ///< [IN] GPIO object reference
+)
+{
+    char result[9];
+
+    if ((!gpioRef) || (gpioRef->pinNum == 0))
+    {
+        LE_ERROR("gpioRef is NULL or object not initialized");
+        return LE_BAD_PARAMETER;
+    }
+
+    if ((LE_OK == ReadGpioAttr(gpioRef, SYSFS_ATTR_DIRECTION, sizeof(result), result)) &&
+        (strncmp(result, "out", 3) == 0))
+    {
+        return LE_OK;
+    }
+
+    return SetDirection(gpioRef, SYSFS_PIN_MODE_OUTPUT);
 }
 
 
@@ -400,7 +577,6 @@ le_result_t gpioSysfs_SetPullUpDown
     gpioSysfs_PullUpDownType_t pud     ///< [IN] pull up, pull down type
 )
 {
-    char path[64];
     const char *attr;
 
     if ((!gpioRef) || (gpioRef->pinNum == 0))
@@ -416,11 +592,9 @@ le_result_t gpioSysfs_SetPullUpDown
         return LE_NOT_IMPLEMENTED;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "pull");
     attr = (pud == SYSFS_PULLUPDOWN_TYPE_DOWN) ? "down": "up";
-    LE_DEBUG("path:%s, attr:%s", path, attr);
 
-    return WriteSysGpioSignalAttr(path, attr);
+    return WriteGpioAttr(gpioRef, SYSFS_ATTR_PULL, attr);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -547,7 +721,6 @@ le_result_t gpioSysfs_SetPolarity
     gpioSysfs_ActiveType_t level            ///< [IN] Active-high or active-low
 )
 {
-    char path[64];
     char attr[16];
 
     if ((!gpioRef) || (gpioRef->pinNum == 0))
@@ -556,11 +729,9 @@ le_result_t gpioSysfs_SetPolarity
         return LE_BAD_PARAMETER;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "active_low");
     snprintf(attr, sizeof(attr), "%d", level);
-    LE_DEBUG("path:%s, attr:%s", path, attr);
 
-    return WriteSysGpioSignalAttr(path, attr);
+    return WriteGpioAttr(gpioRef, SYSFS_ATTR_ACTIVE_LOW, attr);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -709,7 +880,6 @@ gpioSysfs_Value_t gpioSysfs_ReadValue
     gpioSysfs_GpioRef_t gpioRef            ///< [IN] GPIO object reference
 )
 {
-    char path[64];
     char result[17];
     le_result_t leResult;
     gpioSysfs_Value_t type;
@@ -720,8 +890,7 @@ gpioSysfs_Value_t gpioSysfs_ReadValue
         return -1;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "value");
-    leResult = ReadSysGpioSignalAttr(path, sizeof(result), result);
+    leResult = ReadGpioAttr(gpioRef, SYSFS_ATTR_VALUE, sizeof(result), result);
     if (leResult != LE_OK)
     {
         return -1;
@@ -746,7 +915,7 @@ le_result_t gpioSysfs_Activate
     gpioSysfs_GpioRef_t gpioRef
 )
 {
-    if (LE_OK != SetDirection(gpioRef, SYSFS_PIN_MODE_OUTPUT))
+    if (LE_OK != SetOutputDirection(gpioRef))
     {
         LE_ERROR("Failed to set Direction on GPIO %s", gpioRef->gpioName);
         return LE_IO_ERROR;
@@ -772,7 +941,7 @@ le_result_t gpioSysfs_Deactivate
     gpioSysfs_GpioRef_t gpioRef
 )
 {
-    if (LE_OK != SetDirection(gpioRef, SYSFS_PIN_MODE_OUTPUT))
+    if (LE_OK != SetOutputDirection(gpioRef))
     {
         LE_ERROR("Failed to set Direction on GPIO %s", gpioRef->gpioName);
         return LE_IO_ERROR;
@@ -821,7 +990,6 @@ bool gpioSysfs_IsInput
     gpioSysfs_GpioRef_t gpioRef         ///< [IN] GPIO object reference
 )
 {
-    char path[64];
     char result[9];
     le_result_t leResult;
 
@@ -831,8 +999,7 @@ bool gpioSysfs_IsInput
         return false;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "direction");
-    leResult = ReadSysGpioSignalAttr(path, sizeof(result), result);
+    leResult = ReadGpioAttr(gpioRef, SYSFS_ATTR_DIRECTION, sizeof(result), result);
     if (leResult != LE_OK)
     {
         return -1;
@@ -870,7 +1037,6 @@ gpioSysfs_PullUpDownType_t gpioSysfs_GetPullUpDown
     gpioSysfs_GpioRef_t gpioRef         ///< [IN] GPIO object reference
 )
 {
-    char path[64];
     char result[9];
     le_result_t leResult;
 
@@ -880,8 +1046,7 @@ gpioSysfs_PullUpDownType_t gpioSysfs_GetPullUpDown
         return -1;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "pull");
-    leResult = ReadSysGpioSignalAttr(path, sizeof(result), result);
+    leResult = ReadGpioAttr(gpioRef, SYSFS_ATTR_PULL, sizeof(result), result);
     if (leResult != LE_OK)
     {
         return -1;
@@ -917,7 +1082,6 @@ gpioSysfs_ActiveType_t gpioSysfs_GetPolarity
     gpioSysfs_GpioRef_t gpioRef         ///< [IN] GPIO object reference
 )
 {
-    char path[64];
     char result[17];
     le_result_t leResult;
     gpioSysfs_ActiveType_t type;
@@ -928,8 +1092,7 @@ gpioSysfs_ActiveType_t gpioSysfs_GetPolarity
         return -1;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "active_low");
-    leResult = ReadSysGpioSignalAttr(path, sizeof(result), result);
+    leResult = ReadGpioAttr(gpioRef, SYSFS_ATTR_ACTIVE_LOW, sizeof(result), result);
     if (leResult != LE_OK)
     {
         return -1;
@@ -960,7 +1123,6 @@ gpioSysfs_EdgeSensivityMode_t gpioSysfs_GetEdgeSense
     gpioSysfs_GpioRef_t gpioRef         ///< [IN] GPIO object reference
 )
 {
-    char path[64];
     char result[9];
     le_result_t leResult;
 
@@ -976,8 +1138,7 @@ gpioSysfs_EdgeSensivityMode_t gpioSysfs_GetEdgeSense
         return SYSFS_EDGE_SENSE_NONE;
     }
 
-    snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_GPIO_PATH, gpioRef->gpioName, "edge");
-    leResult = ReadSysGpioSignalAttr(path, sizeof(result), result);
+    leResult = ReadGpioAttr(gpioRef, SYSFS_ATTR_EDGE, sizeof(result), result);
     if (leResult != LE_OK)
     {
         return -1;
@@ -1141,6 +1302,10 @@ void gpioSysfs_SessionOpenHandlerFunc
 
     // Store the current, valid session ref
     gpioRef->currentSession = sessionRef;
+    if (LE_OK != le_msg_GetClientProcessId(sessionRef, &gpioRef->clientPid))
+    {
+        gpioRef->clientPid = -1;
+    }
 
     LE_DEBUG("gpio pin:%d, GPIO Name:%s", gpioRef->pinNum, gpioRef->gpioName);
     return;
@@ -1179,8 +1344,140 @@ void gpioSysfs_SessionCloseHandlerFunc
     gpioRef->inUse = false;
 
     RemoveChangeCallback(gpioRef);
+    CloseAttrFds(gpioRef);
 
     gpioRef->currentSession = NULL;
+    gpioRef->clientPid = -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that all the pins of a mask are held by the client process of a session.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ArePinsHeld
+(
+    const gpioSysfs_GpioRef_t* gpioRefs,  ///< [IN] GPIO objects, gpioRefs[n-1] being GPIO n
+    size_t nbGpios,                       ///< [IN] Number of GPIO objects
+    le_msg_SessionRef_t sessionRef,       ///< [IN] Session of the client
+    uint64_t pinMask                      ///< [IN] Pins to check (bit n-1 for GPIO n)
+)
+{
+    pid_t pid;
+    size_t i;
+
+    if ((nbGpios < 64) && ((pinMask >> nbGpios) != 0))
+    {
+        LE_WARN("Pin mask 0x%" PRIx64 " is out of range", pinMask);
+        return false;
+    }
+
+    if (LE_OK != le_msg_GetClientProcessId(sessionRef, &pid))
+    {
+        return false;
+    }
+
+    for (i = 0; i < nbGpios; i++)
+    {
+        if ((pinMask & (1ULL << i)) &&
+            ((!gpioRefs[i]->inUse) || (gpioRefs[i]->clientPid != pid)))
+        {
+            LE_WARN("GPIO %zu is not held by process %d", i + 1, pid);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the value of a set of pins held by the client process of a session.
+ *
+ * @return
+ * - LE_OK on success
+ * - LE_NOT_PERMITTED if a pin of the mask is not held by the client process
+ * - LE_IO_ERROR if a pin could not be read
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gpioSysfs_ReadPins
+(
+    const gpioSysfs_GpioRef_t* gpioRefs,  ///< [IN] GPIO objects, gpioRefs[n-1] being GPIO n
+    size_t nbGpios,                       ///< [IN] Number of GPIO objects
+    le_msg_SessionRef_t sessionRef,       ///< [IN] Session of the client
+    uint64_t pinMask,                     ///< [IN] Pins to read (bit n-1 for GPIO n)
+    uint64_t* valuesPtr                   ///< [OUT] Values of the pins
+)
+{
+    char result[17];
+    uint64_t values = 0;
+    size_t i;
+
+    if (!ArePinsHeld(gpioRefs, nbGpios, sessionRef, pinMask))
+    {
+        return LE_NOT_PERMITTED;
+    }
+
+    for (i = 0; i < nbGpios; i++)
+    {
+        if (pinMask & (1ULL << i))
+        {
+            if (LE_OK != ReadGpioAttr(gpioRefs[i], SYSFS_ATTR_VALUE, sizeof(result), result))
+            {
+                return LE_IO_ERROR;
+            }
+
+            if (result[0] == '1')
+            {
+                values |= (1ULL << i);
+            }
+        }
+    }
+
+    *valuesPtr = values;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drive a set of output pins held by the client process of a session.
+ *
+ * @return
+ * - LE_OK on success
+ * - LE_NOT_PERMITTED if a pin of the mask is not held by the client process
+ * - LE_IO_ERROR if a pin could not be driven
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gpioSysfs_WritePins
+(
+    const gpioSysfs_GpioRef_t* gpioRefs,  ///< [IN] GPIO objects, gpioRefs[n-1] being GPIO n
+    size_t nbGpios,                       ///< [IN] Number of GPIO objects
+    le_msg_SessionRef_t sessionRef,       ///< [IN] Session of the client
+    uint64_t pinMask,                     ///< [IN] Pins to drive (bit n-1 for GPIO n)
+    uint64_t values                       ///< [IN] Values to drive
+)
+{
+    size_t i;
+
+    if (!ArePinsHeld(gpioRefs, nbGpios, sessionRef, pinMask))
+    {
+        return LE_NOT_PERMITTED;
+    }
+
+    for (i = 0; i < nbGpios; i++)
+    {
+        if (pinMask & (1ULL << i))
+        {
+            // The direction is left as it is: writing "value" fails on an input
+            if (LE_OK != WriteGpioAttr(gpioRefs[i], SYSFS_ATTR_VALUE,
+                                       (values & (1ULL << i)) ? "1" : "0"))
+            {
+                return LE_IO_ERROR;
+            }
+        }
+    }
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
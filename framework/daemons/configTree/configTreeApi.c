@@ -1373,6 +1373,54 @@ void le_cfg_SetBool
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, from the configuration tree.  See le_cfg.api for the
+ *  format of the data.
+ *
+ *  \b Responds \b With:
+ *
+ *  This function will respond with one of the following values:
+ *
+ *          - LE_OK             - Read was completed successfully.
+ *          - LE_NOT_FOUND      - The node doesn't exist.
+ *          - LE_OVERFLOW       - Supplied buffer was not large enough to hold the subtree.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_GetSubtree
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    le_cfg_IteratorRef_t externalRef,  ///< [IN] Iterator to use as a basis for the transaction.
+    const char* pathPtr,               ///< [IN] Absolute or relative path to read from.
+    size_t maxSubtree                  ///< [IN] Maximum size of the result data.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Reading the subtree under the iterator's <%p> current node.", externalRef);
+    LE_DEBUG_IF((pathPtr != NULL) && (strlen(pathPtr) != 0), "** Offset by \"%s\"", pathPtr);
+
+    ni_IteratorRef_t iteratorRef = GetIteratorFromRef(externalRef);
+    le_result_t result = LE_NOT_FOUND;
+    uint8_t* subtreeBuf = le_mem_ForceAlloc(tdb_GetBinaryDataMemoryPool());
+    size_t subtreeLen = 0;
+
+    if ((NULL != pathPtr) && (NULL != iteratorRef)
+        && (false == CheckPathForSpecifier(pathPtr)))
+    {
+        subtreeLen = MaxBinary(maxSubtree);
+        result = ni_GetSubtree(iteratorRef, pathPtr, subtreeBuf, &subtreeLen);
+    }
+
+    le_cfg_GetSubtreeRespond(commandRef, result, subtreeBuf, subtreeLen);
+
+    le_mem_Release(subtreeBuf);
+}
+
+
+
+
+
 
 // -------------------------------------------------------------------------------------------------
 //  Basic reading/writing, creation/deletion.
@@ -1817,3 +1865,36 @@ void le_cfg_QuickSetBool
                               value);
     }
 }
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, from the configuration tree.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_QuickGetSubtree
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    const char* pathPtr,               ///< [IN] Path to read from.
+    size_t maxSubtree                  ///< [IN] Maximum size of the result data.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Quick get subtree at \"%p\".", pathPtr);
+
+    tu_UserRef_t userRef = tu_GetCurrentConfigUserInfo();
+    tdb_TreeRef_t treeRef = QuickGetTree(userRef, TU_TREE_READ, pathPtr);
+
+    if (treeRef != NULL)
+    {
+        rq_HandleQuickGetSubtree(le_cfg_GetClientSessionRef(),
+                                 commandRef,
+                                 userRef,
+                                 treeRef,
+                                 tp_GetPathOnly(pathPtr),
+                                 maxSubtree);
+    }
+}
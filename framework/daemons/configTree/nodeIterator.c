@@ -209,6 +209,95 @@ static le_result_t CloneAndAppendPath
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Append a node, and all of the nodes under it, to a buffer in the format read by
+ *  le_cfg_GetSubtree().
+ *
+ *  @return LE_OK if the nodes fit in the buffer, LE_OVERFLOW if they don't.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendSubtree
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN]     The node to append.
+    uint8_t* bufferPtr,     ///< [OUT]    The buffer to append to.
+    size_t bufferSize,      ///< [IN]     The size of the buffer.
+    size_t* usedPtr         ///< [IN/OUT] The number of bytes of the buffer used so far.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_cfg_nodeType_t type = tdb_GetNodeType(nodeRef);
+    size_t used = *usedPtr;
+
+    // The type, then the name.  Make sure there's at least room for the name's terminator, as
+    // tdb_GetNodeName() always writes one.
+    if (bufferSize - used < 2)
+    {
+        return LE_OVERFLOW;
+    }
+
+    bufferPtr[used++] = (uint8_t)type;
+
+    if (tdb_GetNodeName(nodeRef, (char*)&bufferPtr[used], bufferSize - used) != LE_OK)
+    {
+        return LE_OVERFLOW;
+    }
+
+    used += strlen((char*)&bufferPtr[used]) + 1;
+
+    switch (type)
+    {
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            if (   (used >= bufferSize)
+                || (tdb_GetValueAsString(nodeRef,
+                                         (char*)&bufferPtr[used],
+                                         bufferSize - used,
+                                         "") != LE_OK))
+            {
+                return LE_OVERFLOW;
+            }
+
+            used += strlen((char*)&bufferPtr[used]) + 1;
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (childRef != NULL)
+                {
+                    if (AppendSubtree(childRef, bufferPtr, bufferSize, &used) != LE_OK)
+                    {
+                        return LE_OVERFLOW;
+                    }
+
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                if (used >= bufferSize)
+                {
+                    return LE_OVERFLOW;
+                }
+
+                bufferPtr[used++] = LE_CFG_SUBTREE_END;
+            }
+            break;
+
+        default:
+            // Empty nodes have no value.
+            break;
+    }
+
+    *usedPtr = used;
+    return LE_OK;
+}
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Init the node iterator subsystem and get it ready for use by the other subsystems in this
@@ -608,6 +697,67 @@ void ni_ForEachIter
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Move the read iterators that are open on a tree onto a snapshot of the tree as it is now, so
+ *  that a write can be merged into the tree without them seeing it.
+ *
+ *  Only iterators with active safe refs are moved, and none are moved off a tree that's waiting to
+ *  be deleted.  Those that aren't moved keep the tree busy, so check tdb_HasActiveReaders
+ *  afterwards.
+ */
+// -------------------------------------------------------------------------------------------------
+void ni_SnapshotReaders
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree, or a shadow of the tree, that's about to change.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(treeRef != NULL);
+
+    // A shadow tree's original is the one that's in the tree collection.
+    treeRef = tdb_GetTree(tdb_GetTreeName(treeRef));
+
+    tdb_TreeRef_t snapshotRef = tdb_SnapshotTree(treeRef);
+
+    if (snapshotRef == NULL)
+    {
+        return;
+    }
+
+    le_ref_IterRef_t refIterator = le_ref_GetIterator(IteratorRefMap);
+
+    while (le_ref_NextNode(refIterator) == LE_OK)
+    {
+        ni_IteratorRef_t iteratorRef = (ni_IteratorRef_t)le_ref_GetValue(refIterator);
+
+        if (   (iteratorRef != NULL)
+            && (iteratorRef->type == NI_READ)
+            && (iteratorRef->treeRef == treeRef))
+        {
+            LE_DEBUG("Moving read iterator <%p> to a snapshot of tree %s.",
+                     iteratorRef,
+                     tdb_GetTreeName(treeRef));
+
+            tdb_UnregisterIterator(treeRef, iteratorRef);
+            iteratorRef->treeRef = snapshotRef;
+            tdb_RegisterIterator(snapshotRef, iteratorRef);
+
+            // The snapshot has the same layout, so the iterator's path leads to the same node.
+            iteratorRef->currentNodeRef = tdb_GetNode(tdb_GetRootNode(snapshotRef),
+                                                      iteratorRef->pathIterRef);
+        }
+    }
+
+    // The iterators moved onto the snapshot now hold it.
+    tdb_ReleaseTree(snapshotRef);
+}
+#endif
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Move the iterator to a different node in the current tree.
@@ -1309,3 +1459,39 @@ void ni_SetNodeValueBool
         tdb_SetValueAsBool(nodeRef, value);
     }
 }
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, in the format read by le_cfg_GetSubtree().
+ *
+ *  @return LE_OK if the nodes were read, LE_NOT_FOUND if the node doesn't exist, or LE_OVERFLOW if
+ *          the nodes don't fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t ni_GetSubtree
+(
+    ni_IteratorRef_t iteratorRef,  ///< [IN]     The iterator object to access.
+    const char* pathPtr,           ///< [IN]     Optional path to another node in the tree.
+    uint8_t* destBufferPtr,        ///< [OUT]    The buffer to write the nodes into.
+    size_t* bufferSizePtr          ///< [IN/OUT] The size of the buffer on entry, and the number of
+                                   ///<          bytes written on exit.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t nodeRef = ni_GetNode(iteratorRef, pathPtr);
+    le_result_t result = LE_NOT_FOUND;
+    size_t used = 0;
+
+    // tdb_GetNodeType() also takes care of a NULL node.
+    if (tdb_GetNodeType(nodeRef) != LE_CFG_TYPE_DOESNT_EXIST)
+    {
+        result = AppendSubtree(nodeRef, destBufferPtr, *bufferSizePtr, &used);
+    }
+
+    *bufferSizePtr = (result == LE_OK) ? used : 0;
+
+    return result;
+}
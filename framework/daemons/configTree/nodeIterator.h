@@ -254,6 +254,26 @@ void ni_ForEachIter
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Move the read iterators that are open on a tree onto a snapshot of the tree as it is now, so
+ *  that a write can be merged into the tree without them seeing it.
+ *
+ *  Only iterators with active safe refs are moved, and none are moved off a tree that's waiting to
+ *  be deleted.  Those that aren't moved keep the tree busy, so check tdb_HasActiveReaders
+ *  afterwards.
+ */
+// -------------------------------------------------------------------------------------------------
+void ni_SnapshotReaders
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree, or a shadow of the tree, that's about to change.
+);
+#endif
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Move the iterator to a different node in the current tree.
@@ -612,4 +632,24 @@ void ni_SetNodeValueBool
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, in the format read by le_cfg_GetSubtree().
+ *
+ *  @return LE_OK if the nodes were read, LE_NOT_FOUND if the node doesn't exist, or LE_OVERFLOW if
+ *          the nodes don't fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t ni_GetSubtree
+(
+    ni_IteratorRef_t iteratorRef,  ///< [IN]     The iterator object to access.
+    const char* pathPtr,           ///< [IN]     Optional path to another node in the tree.
+    uint8_t* destBufferPtr,        ///< [OUT]    The buffer to write the nodes into.
+    size_t* bufferSizePtr          ///< [IN/OUT] The size of the buffer on entry, and the number of
+                                   ///<          bytes written on exit.
+);
+
+
+
+
 #endif
@@ -429,6 +429,34 @@ static void ProcessRequestQueue
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check to see if a write can be committed to the given tree without changing it under any of its
+ *  readers.  If the configTree was built with read snapshots, the readers are moved onto a snapshot
+ *  of the tree first, so they don't hold the write up.
+ *
+ *  @return True if a write can safely be committed now.  False if not.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CanCommit
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to check.  This can be a shadow tree.
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    if (tdb_HasActiveReaders(treeRef))
+    {
+        ni_SnapshotReaders(treeRef);
+    }
+#endif
+
+    return tdb_HasActiveReaders(treeRef) == false;
+}
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Check to see if the given tree is open for quick writes.
@@ -443,8 +471,8 @@ static bool CanQuickSet
 //--------------------------------------------------------------------------------------------------
 {
     // If there are active readers or writers on the tree then a quick write should be defered.
-    if (   (tdb_HasActiveReaders(treeRef) == false)
-        && (tdb_GetActiveWriteIter(treeRef) == NULL))
+    if (   (tdb_GetActiveWriteIter(treeRef) == NULL)
+        && (CanCommit(treeRef)))
     {
         return true;
     }
@@ -603,7 +631,7 @@ void rq_HandleCommitTxnRequest
         le_cfg_CommitTxnRespond(commandRef);
         ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
     }
-    else if (tdb_HasActiveReaders(ni_GetTree(iteratorRef)) == false)
+    else if (CanCommit(ni_GetTree(iteratorRef)))
     {
         ni_Close(iteratorRef);
         ni_Commit(iteratorRef);
@@ -1207,3 +1235,44 @@ void rq_HandleQuickSetBool
         le_cfg_QuickSetBoolRespond(commandRef);
     }
 }
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, from the tree.
+ */
+// -------------------------------------------------------------------------------------------------
+void rq_HandleQuickGetSubtree
+(
+    le_msg_SessionRef_t sessionRef,    ///< [IN] The session this request occured on.
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] This handle is used to generate the reply for this
+                                       ///<      message.
+    tu_UserRef_t userRef,              ///< [IN] The user that's requesting the action.
+    tdb_TreeRef_t treeRef,             ///< [IN] The tree that we're peforming the action on.
+    const char* pathPtr,               ///< [IN] The path to the node to access.
+    size_t maxSubtree                  ///< [IN] Maximum data the caller can handle.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ni_IteratorRef_t iteratorRef = ni_CreateIterator(sessionRef,
+                                                     userRef,
+                                                     treeRef,
+                                                     NI_READ,
+                                                     pathPtr);
+
+    uint8_t* subtreeBuf = le_mem_ForceAlloc(tdb_GetBinaryDataMemoryPool());
+    size_t subtreeLen = maxSubtree;
+    if (maxSubtree > LE_CFG_BINARY_LEN)
+    {
+        subtreeLen = LE_CFG_BINARY_LEN;
+    }
+
+    le_result_t result = ni_GetSubtree(iteratorRef, NULL, subtreeBuf, &subtreeLen);
+
+    le_cfg_QuickGetSubtreeRespond(commandRef, result, subtreeBuf, subtreeLen);
+
+    ni_Release(iteratorRef);
+    le_mem_Release(subtreeBuf);
+}
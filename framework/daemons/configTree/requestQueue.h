@@ -325,4 +325,23 @@ void rq_HandleQuickSetBool
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a node, and all of the nodes under it, from the tree.
+ */
+// -------------------------------------------------------------------------------------------------
+void rq_HandleQuickGetSubtree
+(
+    le_msg_SessionRef_t sessionRef,    ///< [IN] The session this request occured on.
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] This handle is used to generate the reply for this
+                                       ///<      message.
+    tu_UserRef_t userRef,              ///< [IN] The user that's requesting the action.
+    tdb_TreeRef_t treeRef,             ///< [IN] The tree that we're peforming the action on.
+    const char* pathPtr,               ///< [IN] The path to the node to access.
+    size_t maxSubtree                  ///< [IN] Maximum data the caller can handle.
+);
+
+
+
+
 #endif
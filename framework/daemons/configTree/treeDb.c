@@ -68,6 +68,23 @@
  *  Shadow Trees don't have handlers, request queues, write iterator references or read iterator
  *  counts.
  *
+ *  <b>Child Indexes:</b>
+ *
+ *  Children are found by name by scanning their parent's child list.  Once a scan has to go through
+ *  more than LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD children, the parent gets a hash index of its
+ *  children by name, which is kept up to date as children are added, renamed and removed.
+ *
+ *  <b>Tree Files:</b>
+ *
+ *  Trees are saved either as text, or, if LE_CONFIG_CFGTREE_BINARY_SNAPSHOT is set, as binary
+ *  snapshots (see SnapshotHeader_t).  Both kinds of file are loaded, so text files written by older
+ *  versions or imported by the update daemon still work.  Imports and exports are always text.
+ *
+ *  If LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE is not 0, a commit doesn't write a new tree file.  Instead,
+ *  the nodes it changed are appended to the tree's journal (see JournalHeader_t), which is replayed
+ *  on top of the tree file when the tree is loaded.  Once the journal would grow past the maximum
+ *  size, the next commit writes a new tree file and deletes the journal.
+ *
  *  <b>Event Handler Registration:</b>
  *
  *  The config tree allows clients to register callbacks to be notified if certian sections of a
@@ -134,6 +151,10 @@
 #include "nodeIterator.h"
 #include "sysPaths.h"
 
+#if LE_CONFIG_LINUX
+#include <sys/mman.h>
+#endif
+
 
 
 /// Maximum path size for the config tree.
@@ -271,6 +292,12 @@ typedef struct Node
         le_dls_List_t children;      ///< The linked list of children belonging to this node.
     }
     info;                            ///< The actual inforation that this node stores.
+
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    le_flatHashmap_Ref_t childIndexRef;  ///< Index of this node's children by name.  NULL until a
+                                         ///<   lookup has had to scan more than
+                                         ///<   LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD children.
+#endif
 }
 Node_t;
 
@@ -307,6 +334,19 @@ typedef struct Tree
 
     le_sls_List_t requestList;            ///< Each tree maintains it's own list of pending
                                           ///<   requests.
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    int journalFd;                        ///< The open journal file, or -1.
+    off_t journalSize;                    ///< Size of the journal file, 0 if there isn't one.
+    bool isJournalable;                   ///< Can commits be appended to the journal?  Only true
+                                          ///<   while the tree file and journal on disk hold the
+                                          ///<   same tree as memory.
+#endif
+
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    bool isSnapshot;                      ///< Is this a copy of a tree kept for the readers that
+                                          ///<   were open on it when a write was committed?
+#endif
 }
 Tree_t;
 
@@ -331,6 +371,152 @@ typedef enum
 TokenType_t;
 
 
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a binary snapshot file.
+ *
+ * A snapshot is written on the device that reads it, so all fields are in the native byte order.
+ * The header is followed by one record per node, in depth first order starting with the root node.
+ * Each record is:
+ *
+ *  - 1 byte node type (le_cfg_nodeType_t).
+ *  - 1 byte name length, followed by the name without a terminator.  Zero for the root node.
+ *  - For string, bool, int and float nodes, a 2 byte value length followed by the value string
+ *    without a terminator.
+ *  - For stem nodes, a 4 byte child count.  The children's records follow.
+ *
+ * Multi-byte fields are not aligned.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char magic[8];          ///< SNAPSHOT_MAGIC.
+    uint32_t version;       ///< SNAPSHOT_VERSION.
+    uint32_t nodeCount;     ///< Number of node records.
+    uint64_t dataSize;      ///< Number of bytes of node records following the header.
+}
+SnapshotHeader_t;
+
+/// Magic string at the start of binary snapshot files.  Text tree files can't start with it.
+#define SNAPSHOT_MAGIC "LECFGBIN"
+
+/// Version of the binary snapshot format.
+#define SNAPSHOT_VERSION 1
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of a binary snapshot being loaded.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t* nextPtr;  ///< The next unread byte of node records.
+    const uint8_t* endPtr;   ///< The end of the node records.
+    uint32_t nodeCount;      ///< Number of node records read so far.
+    char* stringBuffer;      ///< Buffer of TDB_MAX_ENCODED_SIZE bytes for names and values.
+}
+SnapshotReader_t;
+
+
+
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a tree's journal file.
+ *
+ * The journal holds the transactions committed since the tree file it was started for was written.
+ * That tree file is identified by its revision and size, so a journal left behind by an
+ * interrupted write of a new tree file is ignored.  The header is followed by one record per
+ * transaction, each a JournalRecordHeader_t followed by operations:
+ *
+ *  - 1 byte JournalOp_t.
+ *  - 1 byte count of the names in the path to the node's parent, followed by each name as a 1 byte
+ *    length and the name without a terminator.
+ *  - For JOURNAL_OP_SET, the node's snapshot record, including its children.  The node is created
+ *    if needed, and replaces the node of the same name.
+ *  - For JOURNAL_OP_DELETE, the node's name as a 1 byte length and the name.
+ *  - For JOURNAL_OP_RENAME, the node's name and its new name, each as a 1 byte length and the name.
+ *
+ * All of a transaction's deletes and renames come before its sets.  Deletes and renames use the
+ * paths from before the transaction, sets the paths from after it.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char magic[8];          ///< JOURNAL_MAGIC.
+    uint32_t version;       ///< JOURNAL_VERSION.
+    uint32_t baseRevision;  ///< Revision of the tree file the journal applies to.
+    uint64_t baseSize;      ///< Size of the tree file the journal applies to.
+}
+JournalHeader_t;
+
+/// Magic string at the start of journal files.
+#define JOURNAL_MAGIC "LECFGJNL"
+
+/// Version of the journal format.
+#define JOURNAL_VERSION 1
+
+/// Extension of journal files.  Tree files have the extension of their revision instead.
+#define JOURNAL_EXTENSION "journal"
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a journal record.  A record whose size or CRC is wrong was not completely written, and
+ * ends the journal.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t size;          ///< Number of bytes of operations following the header.
+    uint32_t crc;           ///< CRC32 of the operations.
+}
+JournalRecordHeader_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Journal operations.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    JOURNAL_OP_SET = 1,     ///< Create or replace a node.
+    JOURNAL_OP_DELETE = 2,  ///< Delete a node.
+    JOURNAL_OP_RENAME = 3   ///< Rename a node, keeping its place among its siblings.
+}
+JournalOp_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A journal record being built for a transaction.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    FILE* streamPtr;        ///< Memory stream the record is written to.
+    char* bufferPtr;        ///< The record, once the stream is closed.  Freed with free().
+    size_t size;            ///< Size of the record, including its header.
+    FILE* renameStreamPtr;  ///< Memory stream for the second step of renames.
+    uint32_t renameCount;   ///< Number of renames, used to make temporary names.
+}
+JournalRecord_t;
+#endif /* LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE */
+
+
 /// Define static pool for nodes
 LE_MEM_DEFINE_STATIC_POOL(nodePool, LE_CONFIG_CFGTREE_MAX_NODE_POOL_SIZE, sizeof(Node_t));
 
@@ -547,6 +733,245 @@ static void ClearDeletedFlag
 
 
 
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Does the node have a name, either of its own or, for a shadow node, the name of the node that it
+ *  shadows?
+ */
+// -------------------------------------------------------------------------------------------------
+static bool HasName
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The node to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (nodeRef->nameRef != NULL)
+    {
+        return true;
+    }
+
+    return    (IsShadow(nodeRef))
+           && (nodeRef->shadowRef != NULL)
+           && (nodeRef->shadowRef->nameRef != NULL);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  The child indexes use the child nodes themselves as keys, and compare them by name.  To look a
+ *  name up, this node stands in for a child with that name.  It is never linked into a tree.
+ */
+// -------------------------------------------------------------------------------------------------
+static Node_t IndexProbe;
+
+/// The name being looked up with IndexProbe.
+static const char* IndexProbeNamePtr;
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get the name of a child index key.
+ *
+ *  @return The name, either in the supplied buffer or, for the probe node, the name being looked up.
+ */
+// -------------------------------------------------------------------------------------------------
+static const char* GetIndexKeyName
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN]  The key node.
+    char* bufferPtr         ///< [OUT] Buffer of LE_CFG_NAME_LEN_BYTES bytes for the name.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (nodeRef == &IndexProbe)
+    {
+        return IndexProbeNamePtr;
+    }
+
+    tdb_GetNodeName(nodeRef, bufferPtr, LE_CFG_NAME_LEN_BYTES);
+    return bufferPtr;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Hash function for child index keys.
+ *
+ *  @return The hash of the key node's name.
+ */
+// -------------------------------------------------------------------------------------------------
+static size_t HashIndexKey
+(
+    const void* keyPtr  ///< [IN] The key node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    return tdb_GetNodeNameHash((tdb_NodeRef_t)keyPtr);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Equality function for child index keys.
+ *
+ *  @return True if the two key nodes have the same name.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IndexKeysEqual
+(
+    const void* firstKeyPtr,  ///< [IN] The first key node.
+    const void* secondKeyPtr  ///< [IN] The second key node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (firstKeyPtr == secondKeyPtr)
+    {
+        return true;
+    }
+
+    char firstBuffer[LE_CFG_NAME_LEN_BYTES];
+    char secondBuffer[LE_CFG_NAME_LEN_BYTES];
+
+    return strcmp(GetIndexKeyName((tdb_NodeRef_t)firstKeyPtr, firstBuffer),
+                  GetIndexKeyName((tdb_NodeRef_t)secondKeyPtr, secondBuffer)) == 0;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Build an index of a stem node's named children.  If two children have the same name, which can
+ *  briefly happen while nodes are being renamed during a merge, the first one is indexed, as that is
+ *  the one a scan of the child list would find.
+ */
+// -------------------------------------------------------------------------------------------------
+static void BuildChildIndex
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node to index.
+    size_t childCount       ///< [IN] Number of children the node has, at least.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(nodeRef->childIndexRef == NULL);
+
+    nodeRef->childIndexRef = le_flatHashmap_Create("cfgChildIndex",
+                                                   2 * childCount,
+                                                   HashIndexKey,
+                                                   IndexKeysEqual);
+
+    tdb_NodeRef_t childRef = tdb_GetFirstChildNode(nodeRef);
+
+    while (childRef != NULL)
+    {
+        if (   (HasName(childRef))
+            && (le_flatHashmap_ContainsKey(nodeRef->childIndexRef, childRef) == false))
+        {
+            le_flatHashmap_Put(nodeRef->childIndexRef, childRef, childRef);
+        }
+
+        childRef = tdb_GetNextSiblingNode(childRef);
+    }
+}
+
+#endif /* LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD */
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a child node to its parent's child index, if the parent has one.  Must be called whenever a
+ *  node that has a name is added to a child list, and after a node has been renamed.
+ */
+// -------------------------------------------------------------------------------------------------
+static void IndexChild
+(
+    tdb_NodeRef_t childRef  ///< [IN] The child to add.
+)
+// -------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    tdb_NodeRef_t parentRef = childRef->parentRef;
+
+    if (   (parentRef != NULL)
+        && (parentRef->childIndexRef != NULL)
+        && (HasName(childRef)))
+    {
+        // If another child briefly has the same name during a merge, replace its entry rather than
+        // just its value, so that the stored key is always a node with the name it is stored under.
+        le_flatHashmap_Remove(parentRef->childIndexRef, childRef);
+        le_flatHashmap_Put(parentRef->childIndexRef, childRef, childRef);
+    }
+#endif
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Remove a child node from its parent's child index, if the parent has one.  Must be called while
+ *  the node still has the name it was indexed under, before it is renamed or destroyed.
+ */
+// -------------------------------------------------------------------------------------------------
+static void UnindexChild
+(
+    tdb_NodeRef_t childRef  ///< [IN] The child to remove.
+)
+// -------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    tdb_NodeRef_t parentRef = childRef->parentRef;
+
+    // Another child may briefly have the same name during a merge, in which case the index entry
+    // for that name may be the other child's and is left alone.
+    if (   (parentRef != NULL)
+        && (parentRef->childIndexRef != NULL)
+        && (HasName(childRef))
+        && (le_flatHashmap_Get(parentRef->childIndexRef, childRef) == childRef))
+    {
+        le_flatHashmap_Remove(parentRef->childIndexRef, childRef);
+    }
+#endif
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Drop a node's child index, if it has one.  This is done before the node's children are released
+ *  so that they don't each have to be removed from it.
+ */
+// -------------------------------------------------------------------------------------------------
+static void DeleteChildIndex
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The node to update.
+)
+// -------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    if (nodeRef->childIndexRef != NULL)
+    {
+        le_flatHashmap_Delete(nodeRef->childIndexRef);
+        nodeRef->childIndexRef = NULL;
+    }
+#endif
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Allocate a new node and fill out it's default information.
@@ -571,6 +996,9 @@ static tdb_NodeRef_t NewNode
     newNodeRef->nameHash = 0;
     newNodeRef->siblingList = LE_DLS_LINK_INIT;
     memset(&newNodeRef->info, 0, sizeof(newNodeRef->info));
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    newNodeRef->childIndexRef = NULL;
+#endif
 
     return newNodeRef;
 }
@@ -578,6 +1006,30 @@ static tdb_NodeRef_t NewNode
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get the first child that a stem node has right now.  Unlike tdb_GetFirstChildNode, this doesn't
+ *  give a shadow node shadows of its original's children if it doesn't have any yet.  Those
+ *  children can't have been changed in the transaction, as they were never looked at.
+ *
+ *  @return The first child of the given node, or NULL if it doesn't have any.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t PeekFirstChild
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The stem node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&nodeRef->info.children);
+
+    return linkPtr == NULL ? NULL
+                           : CONTAINER_OF(linkPtr, Node_t, siblingList);
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  The node destructor function.  This will take care of freeing a node's string values and any
@@ -592,6 +1044,11 @@ static void NodeDestructor
 {
     tdb_NodeRef_t nodeRef = (tdb_NodeRef_t)objectPtr;
 
+    // The index entry has to be found by name, so drop it before the name is released.  Drop this
+    // node's own index before its children are released, so they don't have to be removed from it.
+    UnindexChild(nodeRef);
+    DeleteChildIndex(nodeRef);
+
     if (nodeRef->nameRef)
     {
         dstr_Release(nodeRef->nameRef);
@@ -616,7 +1073,8 @@ static void NodeDestructor
 
         case LE_CFG_TYPE_STEM:
             {
-                tdb_NodeRef_t childRef = tdb_GetFirstChildNode(nodeRef);
+                // Shadow nodes that were never given shadow children don't need them now.
+                tdb_NodeRef_t childRef = PeekFirstChild(nodeRef);
 
                 while (childRef != NULL)
                 {
@@ -784,6 +1242,7 @@ static void ShadowChildren
         newShadowRef->parentRef = shadowParentRef;
 
         le_dls_Queue(&shadowParentRef->info.children, &newShadowRef->siblingList);
+        IndexChild(newShadowRef);
 
         originalChildRef = tdb_GetNextSiblingNode(originalChildRef);
     }
@@ -792,23 +1251,88 @@ static void ShadowChildren
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
 // -------------------------------------------------------------------------------------------------
 /**
- *  Search up through a node tree until we find the root node.
+ *  Make a copy of a node, along with all of its children.
+ *
+ *  @return The new copy, which has no parent.
  */
 // -------------------------------------------------------------------------------------------------
-static tdb_NodeRef_t GetRootParentNode
+static tdb_NodeRef_t CopyNode
 (
-    tdb_NodeRef_t nodeRef  ///< [IN] Find the greatest grand parent of this node.
+    tdb_NodeRef_t nodeRef  ///< [IN] The node to copy.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    tdb_NodeRef_t parentRef = NULL;
+    tdb_NodeRef_t copyRef = NewNode();
 
-    while (nodeRef != NULL)
+    copyRef->type = nodeRef->type;
+    copyRef->flags = nodeRef->flags;
+    copyRef->nameHash = nodeRef->nameHash;
+
+    if (nodeRef->nameRef != NULL)
     {
-        parentRef = nodeRef;
-        nodeRef = tdb_GetNodeParent(nodeRef);
+        copyRef->nameRef = dstr_NewFromDstr(nodeRef->nameRef);
+    }
+
+    switch (nodeRef->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            break;
+
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            if (nodeRef->info.valueRef != NULL)
+            {
+                copyRef->info.valueRef = dstr_NewFromDstr(nodeRef->info.valueRef);
+            }
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                tdb_NodeRef_t childRef = PeekFirstChild(nodeRef);
+
+                while (childRef != NULL)
+                {
+                    tdb_NodeRef_t childCopyRef = CopyNode(childRef);
+
+                    childCopyRef->parentRef = copyRef;
+                    le_dls_Queue(&copyRef->info.children, &childCopyRef->siblingList);
+
+                    childRef = tdb_GetNextSiblingNode(childRef);
+                }
+            }
+            break;
+    }
+
+    return copyRef;
+}
+#endif
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Search up through a node tree until we find the root node.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t GetRootParentNode
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] Find the greatest grand parent of this node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t parentRef = NULL;
+
+    while (nodeRef != NULL)
+    {
+        parentRef = nodeRef;
+        nodeRef = tdb_GetNodeParent(nodeRef);
     }
 
     return parentRef;
@@ -819,44 +1343,43 @@ static tdb_NodeRef_t GetRootParentNode
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Called to look for a named child in a given node's child collection.
+ *  Search a stem node's children for one with the given name.  If the node's children have been
+ *  indexed the index is used, otherwise the child list is scanned, and the index is built if the
+ *  scan had to go through too many children.
  *
  *  @return Reference to the found child node, or NULL if a node was not found.
  */
 // -------------------------------------------------------------------------------------------------
-static tdb_NodeRef_t GetNamedChild
+static tdb_NodeRef_t FindChild
 (
     tdb_NodeRef_t nodeRef,  ///< [IN] The node to search.
     const char* nameRef     ///< [IN] The name we're searching for.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Is this one of the "special" names?
-    if (strcmp(nameRef, ".") == 0)
-    {
-        return nodeRef;
-    }
+    // Getting the first child also gives shadow nodes their children, if they don't have them yet.
+    tdb_NodeRef_t currentRef = tdb_GetFirstChildNode(nodeRef);
+    size_t stringHash = le_hashmap_HashString(nameRef);
 
-    if (strcmp(nameRef, "..") == 0)
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    if (nodeRef->childIndexRef != NULL)
     {
-        return nodeRef->parentRef;
-    }
+        IndexProbe.nameHash = stringHash;
+        IndexProbeNamePtr = nameRef;
 
-    // If the current node isn't a stem, then this node can't have any children.
-    if (nodeRef->type != LE_CFG_TYPE_STEM)
-    {
-        return NULL;
+        return le_flatHashmap_Get(nodeRef->childIndexRef, &IndexProbe);
     }
+#endif
 
     // Search the child list for a node with the given name.
-    tdb_NodeRef_t currentRef = tdb_GetFirstChildNode(nodeRef);
     char currentNameRef[LE_CFG_NAME_LEN_BYTES] = "";
-    size_t stringHash = le_hashmap_HashString(nameRef);
     size_t nodeHash;
+    size_t scanCount = 0;
 
     while (currentRef != NULL)
     {
         nodeHash = tdb_GetNodeNameHash(currentRef);
+        scanCount++;
 
         // if the hash doesn't match, the name is different. If the hash matches, there is
         // a small possibility of collision, and the string comparison is required.
@@ -866,15 +1389,58 @@ static tdb_NodeRef_t GetNamedChild
 
             if (strncmp(currentNameRef, nameRef, sizeof(currentNameRef)) == 0)
             {
-                return currentRef;
+                break;
             }
         }
 
         currentRef = tdb_GetNextSiblingNode(currentRef);
     }
 
-    // Looks like there was no node to return.
-    return NULL;
+#if LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD > 0
+    if (scanCount > LE_CONFIG_CFGTREE_CHILD_INDEX_THRESHOLD)
+    {
+        BuildChildIndex(nodeRef, scanCount);
+    }
+#endif
+
+    return currentRef;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called to look for a named child in a given node's child collection.
+ *
+ *  @return Reference to the found child node, or NULL if a node was not found.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t GetNamedChild
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node to search.
+    const char* nameRef     ///< [IN] The name we're searching for.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Is this one of the "special" names?
+    if (strcmp(nameRef, ".") == 0)
+    {
+        return nodeRef;
+    }
+
+    if (strcmp(nameRef, "..") == 0)
+    {
+        return nodeRef->parentRef;
+    }
+
+    // If the current node isn't a stem, then this node can't have any children.
+    if (nodeRef->type != LE_CFG_TYPE_STEM)
+    {
+        return NULL;
+    }
+
+    return FindChild(nodeRef, nameRef);
 }
 
 
@@ -939,22 +1505,8 @@ static bool NodeExists
 )
 // -------------------------------------------------------------------------------------------------
 {
-    tdb_NodeRef_t currentRef = tdb_GetFirstChildNode(parentRef);
-    char currentName[LE_CFG_NAME_LEN_BYTES] = "";
-
-    while (currentRef != NULL)
-    {
-        tdb_GetNodeName(currentRef, currentName, sizeof(currentName));
-
-        if (strncmp(currentName, namePtr, sizeof(currentName)) == 0)
-        {
-            return true;
-        }
-
-        currentRef = tdb_GetNextSiblingNode(currentRef);
-    }
-
-    return false;
+    return    (parentRef->type == LE_CFG_TYPE_STEM)
+           && (FindChild(parentRef, namePtr) != NULL);
 }
 
 
@@ -1085,6 +1637,8 @@ static void MergeNode
     // If the name has been changed, then copy it over now.
     if (dstr_IsNullOrEmpty(nodeRef->nameRef) == false)
     {
+        UnindexChild(originalRef);
+
         if (originalRef->nameRef != NULL)
         {
             dstr_Copy(originalRef->nameRef, nodeRef->nameRef);
@@ -1094,6 +1648,8 @@ static void MergeNode
             originalRef->nameRef = dstr_NewFromDstr(nodeRef->nameRef);
         }
         originalRef->nameHash = nodeRef->nameHash;
+
+        IndexChild(originalRef);
     }
 
     // Check the types of the original and the shadow nodes.  If the new node has been cleared,
@@ -1500,6 +2056,12 @@ static bool InternalMergeTree
     bool isModified = IsModified(nodeRef);
     bool renamed = WasRenamed(nodeRef);
 
+    // A stem that was never given shadow children hasn't changed.  Checking its type would give it
+    // those children, and its children theirs as they are merged in turn.
+    bool isUntouched = (   (isModified == false)
+                        && (nodeRef->type == LE_CFG_TYPE_STEM)
+                        && (PeekFirstChild(nodeRef) == NULL));
+
     // If this node was renamed, then all children also need to be triggered as well.
     forceFire = renamed || forceFire;
 
@@ -1507,7 +2069,8 @@ static bool InternalMergeTree
     // notifications fired on the original nodes.
     if (   (renamed == true)
         || (IsDeleted(nodeRef) == true)
-        || (OriginalToBeCleared(nodeRef) == true))
+        || (   (isUntouched == false)
+            && (OriginalToBeCleared(nodeRef) == true)))
     {
         le_pathIter_Ref_t originalPathRef = CreateBasePath(treeNamePtr);
 
@@ -1542,7 +2105,10 @@ static bool InternalMergeTree
     if (   (nodeRef->type == LE_CFG_TYPE_STEM)
         && (IsDeleted(nodeRef) == false))
     {
-        nodeRef = tdb_GetFirstChildNode(nodeRef);
+        // Children that were never shadowed are unchanged, so they only need to be visited when
+        // handlers have to be fired for all of them.  Skipping them keeps small commits to large
+        // trees from shadowing the whole tree.
+        nodeRef = forceFire ? tdb_GetFirstChildNode(nodeRef) : PeekFirstChild(nodeRef);
 
         while (nodeRef != NULL)
         {
@@ -1598,6 +2164,14 @@ tdb_TreeRef_t NewTree
     treeRef->activeReadCount = 0;
     treeRef->activeWriteIterRef = NULL;
     treeRef->requestList = LE_SLS_LIST_INIT;
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    treeRef->journalFd = -1;
+    treeRef->journalSize = 0;
+    treeRef->isJournalable = false;
+#endif
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    treeRef->isSnapshot = false;
+#endif
 
     return treeRef;
 }
@@ -1622,6 +2196,14 @@ static void TreeDestructor
     le_mem_Release(treeRef->rootNodeRef);
     treeRef->rootNodeRef = NULL;
 
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    if (treeRef->journalFd != -1)
+    {
+        close(treeRef->journalFd);
+        treeRef->journalFd = -1;
+    }
+#endif
+
     // Sanity check, is the tree actually ready to clean up?
     LE_ASSERT(treeRef->activeReadCount == 0);
     LE_ASSERT(treeRef->activeWriteIterRef == NULL);
@@ -2367,9 +2949,1283 @@ static le_result_t InternalReadNode
 
     tdb_EnsureExists(nodeRef);
 
-cleanup:
-    le_mem_Release(stringBuffer);
-    return result;
+cleanup:
+    le_mem_Release(stringBuffer);
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file in the filesystem.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t InternalWriteNode
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node being written.
+    FILE* filePtr           ///< [IN] The file being written to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // If there is no node to write, or if the node is marked as having been deleted...  Then write
+    // a blank node.
+    if (   (nodeRef == NULL)
+        || (IsDeleted(nodeRef) == true))
+    {
+        return WriteFile(filePtr, "~ ", 2);
+    }
+
+    // Get the node's value as a string.
+    char* stringBuffer = le_mem_ForceAlloc(EncodedStringPool);
+    size_t stringBufferSize = TDB_MAX_ENCODED_SIZE;
+    le_result_t result = LE_OK;
+
+    tdb_GetValueAsString(nodeRef, stringBuffer, stringBufferSize, "");
+
+    // Now, depending on the type of node, write out any required format information.
+    switch (nodeRef->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            result = WriteFile(filePtr, "~ ", 2);
+            break;
+
+        case LE_CFG_TYPE_BOOL:
+            {
+                const char boolBuffer[3] = { '!', stringBuffer[0], ' ' };
+                result = WriteFile(filePtr, boolBuffer, sizeof(boolBuffer));
+            }
+            break;
+
+        case LE_CFG_TYPE_STRING:
+            result = WriteStringValue(filePtr, '\"', '\"', stringBuffer);
+            break;
+
+        case LE_CFG_TYPE_INT:
+            result = WriteStringValue(filePtr, '[', ']', stringBuffer);
+            break;
+
+        case LE_CFG_TYPE_FLOAT:
+            result = WriteStringValue(filePtr, '(', ')', stringBuffer);
+            break;
+
+        // Looks like this node is a collection, so write out it's child nodes now.
+        case LE_CFG_TYPE_STEM:
+            if ((result = WriteFile(filePtr, "{ ", 2)) == LE_OK)
+            {
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (   (childRef != NULL)
+                       && (result == LE_OK))
+                {
+                    tdb_GetNodeName(childRef, stringBuffer, stringBufferSize);
+                    result = WriteStringValue(filePtr, '\"', '\"', stringBuffer);
+
+                    if (result == LE_OK)
+                    {
+                        result = InternalWriteNode(childRef, filePtr);
+                    }
+
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                if (result == LE_OK)
+                {
+                    result = WriteFile(filePtr, "} ", 2);
+                }
+            }
+            break;
+    }
+
+    le_mem_Release(stringBuffer);
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Calculate the number of bytes required to store a node path, including seperators and a trailing
+ *  NULL.
+ *
+ *  @return The amount of bytes required to store the whole path string.
+ */
+// -------------------------------------------------------------------------------------------------
+static size_t ComputePathLength
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] Compute a path for this node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t pathLen = 0;
+    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
+
+    while (nodeRef != NULL)
+    {
+        LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
+
+        // Add this path segment's length to our running total, along with the required path
+        // seperator.
+        pathLen += 1 + le_utf8_NumBytes(nodeName);
+        nodeRef = tdb_GetNodeParent(nodeRef);
+    }
+
+    // Don't forget to include a spot for the trailing NULL.
+    return pathLen + 1;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Bump up the version id of this tree.
+ */
+// -------------------------------------------------------------------------------------------------
+static void IncrementRevision
+(
+    tdb_TreeRef_t treeRef  ///< [IN] Increment the revision of this tree.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    treeRef->revisionId++;
+
+    if (treeRef->revisionId > 3)
+    {
+        treeRef->revisionId = 1;
+    }
+}
+
+
+
+
+#if LE_CONFIG_CFGTREE_BINARY_SNAPSHOT
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a node record, and the records of its children, to a binary snapshot file.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteSnapshotNode
+(
+    tdb_NodeRef_t nodeRef,   ///< [IN]     The node being written.
+    FILE* filePtr,           ///< [IN]     The file being written to.
+    char* stringBuffer,      ///< [IN]     Buffer of TDB_MAX_ENCODED_SIZE bytes for names and
+                             ///<          values.
+    uint32_t* nodeCountPtr   ///< [IN,OUT] Count of node records written.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Nodes that are marked as deleted are written as empty nodes, like in text files.
+    le_cfg_nodeType_t type = IsDeleted(nodeRef) ? LE_CFG_TYPE_EMPTY : nodeRef->type;
+
+    if (type == LE_CFG_TYPE_DOESNT_EXIST)
+    {
+        type = LE_CFG_TYPE_EMPTY;
+    }
+
+    LE_ASSERT(tdb_GetNodeName(nodeRef, stringBuffer, TDB_MAX_ENCODED_SIZE) == LE_OK);
+
+    size_t nameLen = strlen(stringBuffer);
+    uint8_t recordHeader[2] = { (uint8_t)type, (uint8_t)nameLen };
+    le_result_t result;
+
+    LE_ASSERT(nameLen <= LE_CFG_NAME_LEN);
+
+    result = WriteFile(filePtr, recordHeader, sizeof(recordHeader));
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(filePtr, stringBuffer, nameLen);
+    }
+
+    (*nodeCountPtr)++;
+
+    switch (type)
+    {
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            if (result == LE_OK)
+            {
+                tdb_GetValueAsString(nodeRef, stringBuffer, TDB_MAX_ENCODED_SIZE, "");
+
+                uint16_t valueLen = strlen(stringBuffer);
+
+                result = WriteFile(filePtr, &valueLen, sizeof(valueLen));
+
+                if (result == LE_OK)
+                {
+                    result = WriteFile(filePtr, stringBuffer, valueLen);
+                }
+            }
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                uint32_t childCount = 0;
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (childRef != NULL)
+                {
+                    childCount++;
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                if (result == LE_OK)
+                {
+                    result = WriteFile(filePtr, &childCount, sizeof(childCount));
+                }
+
+                childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (   (childRef != NULL)
+                       && (result == LE_OK))
+                {
+                    result = WriteSnapshotNode(childRef, filePtr, stringBuffer, nodeCountPtr);
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a tree to a file as a binary snapshot.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteSnapshot
+(
+    tdb_NodeRef_t rootRef,  ///< [IN] The root node of the tree being written.
+    FILE* filePtr           ///< [IN] The file being written to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    SnapshotHeader_t header = { .version = SNAPSHOT_VERSION };
+    le_result_t result;
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+
+    // The counts aren't known yet, so the header is written again once the nodes have been.
+    result = WriteFile(filePtr, &header, sizeof(header));
+
+    if (result == LE_OK)
+    {
+        char* stringBuffer = le_mem_ForceAlloc(EncodedStringPool);
+
+        result = WriteSnapshotNode(rootRef, filePtr, stringBuffer, &header.nodeCount);
+        le_mem_Release(stringBuffer);
+    }
+
+    if (result == LE_OK)
+    {
+        long endOffset = ftell(filePtr);
+
+        if (   (endOffset < (long)sizeof(header))
+            || (fseek(filePtr, 0, SEEK_SET) != 0))
+        {
+            LE_EMERG("Failed to seek in config tree file (%m).");
+            return LE_IO_ERROR;
+        }
+
+        header.dataSize = endOffset - sizeof(header);
+        result = WriteFile(filePtr, &header, sizeof(header));
+    }
+
+    return result;
+}
+#endif /* LE_CONFIG_CFGTREE_BINARY_SNAPSHOT */
+
+
+
+
+#if LE_CONFIG_LINUX
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Copy the next bytes of a binary snapshot.
+ *
+ *  @return True if the bytes were copied, false if the snapshot ends before them.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool ReadSnapshotBytes
+(
+    SnapshotReader_t* readerPtr,  ///< [IN]  The snapshot being read.
+    void* destPtr,                ///< [OUT] Where to copy the bytes.
+    size_t size                   ///< [IN]  How many bytes to copy.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if ((size_t)(readerPtr->endPtr - readerPtr->nextPtr) < size)
+    {
+        LE_ERROR("Unexpected end of snapshot.");
+        return false;
+    }
+
+    memcpy(destPtr, readerPtr->nextPtr, size);
+    readerPtr->nextPtr += size;
+
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a length prefixed string from a binary snapshot into the reader's string buffer.
+ *
+ *  @return True if the string was read, false if it is too long or the snapshot ends before it.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool ReadSnapshotString
+(
+    SnapshotReader_t* readerPtr,  ///< [IN] The snapshot being read.
+    size_t length,                ///< [IN] The length of the string.
+    size_t maxLength              ///< [IN] The maximum valid length.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (length > maxLength)
+    {
+        LE_ERROR("String in snapshot is too long.  (%" PRIuS "/%" PRIuS ")", length, maxLength);
+        return false;
+    }
+
+    if (!ReadSnapshotBytes(readerPtr, readerPtr->stringBuffer, length))
+    {
+        return false;
+    }
+
+    readerPtr->stringBuffer[length] = '\0';
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read the rest of a node record from a binary snapshot, once its type and name have been read.
+ *  If the node is a stem, then read in its children too.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if the snapshot is not valid.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadSnapshotNode
+(
+    tdb_NodeRef_t nodeRef,        ///< [IN] The node we're reading a value for.
+    uint8_t type,                 ///< [IN] The node type from the record.
+    SnapshotReader_t* readerPtr,  ///< [IN] The snapshot being read.
+    size_t pathLen                ///< [IN] The length of the path including nodeRef.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    readerPtr->nodeCount++;
+
+    switch (type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+            break;
+
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            {
+                uint16_t valueLen;
+
+                if (   (!ReadSnapshotBytes(readerPtr, &valueLen, sizeof(valueLen)))
+                    || (!ReadSnapshotString(readerPtr, valueLen, TDB_MAX_ENCODED_SIZE - 1)))
+                {
+                    return LE_FORMAT_ERROR;
+                }
+
+                tdb_SetValueAsString(nodeRef, readerPtr->stringBuffer);
+                nodeRef->type = type;
+            }
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                uint32_t childCount;
+                uint32_t i;
+
+                if (!ReadSnapshotBytes(readerPtr, &childCount, sizeof(childCount)))
+                {
+                    return LE_FORMAT_ERROR;
+                }
+
+                for (i = 0; i < childCount; i++)
+                {
+                    uint8_t recordHeader[2];
+
+                    if (   (!ReadSnapshotBytes(readerPtr, recordHeader, sizeof(recordHeader)))
+                        || (!ReadSnapshotString(readerPtr, recordHeader[1], LE_CFG_NAME_LEN)))
+                    {
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    size_t newPathLen = pathLen + 1 + recordHeader[1];
+
+                    if (newPathLen > LE_CFG_STR_LEN)
+                    {
+                        LE_ERROR("New path length for node '%s' is too long.",
+                                 readerPtr->stringBuffer);
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    // Setting the name also checks that it isn't a duplicate, which is quick once
+                    // the node has enough children for them to be indexed.
+                    tdb_NodeRef_t childRef = NewChildNode(nodeRef);
+
+                    if (tdb_SetNodeName(childRef, readerPtr->stringBuffer) != LE_OK)
+                    {
+                        LE_ERROR("Bad node name, '%s'.", readerPtr->stringBuffer);
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    le_result_t result = ReadSnapshotNode(childRef,
+                                                          recordHeader[0],
+                                                          readerPtr,
+                                                          newPathLen);
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+                }
+            }
+            break;
+
+        default:
+            LE_ERROR("Unexpected node type %u in snapshot.", type);
+            return LE_FORMAT_ERROR;
+    }
+
+    ClearModifiedFlag(nodeRef);
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check whether a tree file is a binary snapshot.  The file is left positioned at its start.
+ *
+ *  @return True if the file starts with the snapshot magic string.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IsSnapshotFile
+(
+    FILE* filePtr  ///< [IN] The file to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char magic[sizeof(((SnapshotHeader_t*)NULL)->magic)];
+    bool isSnapshot = (   (fread(magic, 1, sizeof(magic), filePtr) == sizeof(magic))
+                       && (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0));
+
+    rewind(filePtr);
+
+    return isSnapshot;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Load a tree from a binary snapshot file.  The file is memory mapped and its records are copied
+ *  straight into the tree.
+ *
+ *  @return True if the read is successful, or false if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool ReadSnapshot
+(
+    tdb_NodeRef_t rootRef,  ///< [IN] The root node of the tree to load.
+    FILE* filePtr           ///< [IN] The snapshot file.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if (fstat(fileno(filePtr), &fileStat) != 0)
+    {
+        LE_ERROR("Can't stat snapshot file (%m).");
+        return false;
+    }
+
+    size_t fileSize = fileStat.st_size;
+    SnapshotHeader_t header;
+
+    if (fileSize < sizeof(header))
+    {
+        LE_ERROR("Snapshot file is too small.");
+        return false;
+    }
+
+    uint8_t* mapPtr = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileno(filePtr), 0);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Can't map snapshot file (%m).");
+        return false;
+    }
+
+    madvise(mapPtr, fileSize, MADV_SEQUENTIAL);
+    memcpy(&header, mapPtr, sizeof(header));
+
+    SnapshotReader_t reader =
+        {
+            .nextPtr = mapPtr + sizeof(header),
+            .endPtr = mapPtr + fileSize,
+            .nodeCount = 0,
+            .stringBuffer = le_mem_ForceAlloc(EncodedStringPool)
+        };
+    uint8_t recordHeader[2];
+    bool result = false;
+
+    tdb_SetEmpty(rootRef);
+    tdb_EnsureExists(rootRef);
+
+    // Check that the whole snapshot was written, then read the root node's record.  The root node
+    // doesn't have a name.
+    if (header.version != SNAPSHOT_VERSION)
+    {
+        LE_ERROR("Unsupported snapshot version %" PRIu32 ".", header.version);
+    }
+    else if (header.dataSize != fileSize - sizeof(header))
+    {
+        LE_ERROR("Snapshot size mismatch, %" PRIu64 " bytes of data in a %" PRIuS " byte file.",
+                 header.dataSize,
+                 fileSize);
+    }
+    else if (   (ReadSnapshotBytes(&reader, recordHeader, sizeof(recordHeader)))
+             && (recordHeader[1] == 0)
+             && (ReadSnapshotNode(rootRef,
+                                  recordHeader[0],
+                                  &reader,
+                                  ComputePathLength(rootRef)) == LE_OK))
+    {
+        if (   (reader.nextPtr != reader.endPtr)
+            || (reader.nodeCount != header.nodeCount))
+        {
+            LE_ERROR("Snapshot has %" PRIu32 " of %" PRIu32 " nodes, and %" PRIuS
+                     " unexpected bytes.",
+                     reader.nodeCount,
+                     header.nodeCount,
+                     (size_t)(reader.endPtr - reader.nextPtr));
+        }
+        else
+        {
+            result = true;
+        }
+    }
+
+    le_mem_Release(reader.stringBuffer);
+    munmap(mapPtr, fileSize);
+
+    return result;
+}
+#endif /* LE_CONFIG_LINUX */
+
+
+
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Create a path to a tree's journal file.
+ */
+// -------------------------------------------------------------------------------------------------
+static void GetJournalPath
+(
+    const char* treeNameRef,  ///< [IN] The name of the tree we're generating a name for.
+    char* pathBuffer,         ///< [IN] Buffer to hold the new path.
+    size_t pathSize           ///< [IN] Size of the path buffer.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    int printSize = snprintf(pathBuffer,
+                             pathSize,
+                             "%s/%s." JOURNAL_EXTENSION,
+                             CFG_TREE_PATH,
+                             treeNameRef);
+
+    if (printSize >= pathSize)
+    {
+       LE_ERROR("Unable to store config journal path in buffer");
+       pathBuffer[0] = '\0';
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Close a tree's journal file, if it's open, and delete it from the filesystem.
+ */
+// -------------------------------------------------------------------------------------------------
+static void DeleteJournal
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree whose journal is deleted.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    if (treeRef->journalFd != -1)
+    {
+        close(treeRef->journalFd);
+        treeRef->journalFd = -1;
+    }
+
+    treeRef->journalSize = 0;
+
+    GetJournalPath(treeRef->name, pathBuffer, sizeof(pathBuffer));
+
+    if (   (pathBuffer[0] != '\0')
+        && (unlink(pathBuffer) != 0)
+        && (errno != ENOENT))
+    {
+        LE_ERROR("File delete failure, '%s', reason '%m'.", pathBuffer);
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a name to a journal record, as a 1 byte length followed by the name.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalName
+(
+    FILE* streamPtr,       ///< [IN] The record being written.
+    const char* namePtr    ///< [IN] The name.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    uint8_t nameLen = strlen(namePtr);
+    le_result_t result = WriteFile(streamPtr, &nameLen, sizeof(nameLen));
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(streamPtr, namePtr, nameLen);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write the names of the nodes between the root node and a node, not including either of them.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalParentNames
+(
+    FILE* streamPtr,       ///< [IN] The record being written.
+    tdb_NodeRef_t nodeRef  ///< [IN] The node whose parents' names are written.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t parentRef = nodeRef->parentRef;
+
+    if (   (parentRef == NULL)
+        || (parentRef->parentRef == NULL))
+    {
+        return LE_OK;
+    }
+
+    le_result_t result = WriteJournalParentNames(streamPtr, parentRef);
+
+    if (result == LE_OK)
+    {
+        char name[LE_CFG_NAME_LEN_BYTES] = "";
+
+        LE_ASSERT(tdb_GetNodeName(parentRef, name, sizeof(name)) == LE_OK);
+        result = WriteJournalName(streamPtr, name);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Start a journal operation on a node by writing the operation and the path to the node's parent.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalOp
+(
+    FILE* streamPtr,       ///< [IN] The record being written.
+    JournalOp_t op,        ///< [IN] The operation.
+    tdb_NodeRef_t nodeRef  ///< [IN] The original node the operation is on.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Paths are at most LE_CFG_STR_LEN bytes long, so they can't have more than 255 names.
+    uint8_t opHeader[2] = { (uint8_t)op, 0 };
+    tdb_NodeRef_t parentRef;
+
+    for (parentRef = nodeRef->parentRef;
+         (parentRef != NULL) && (parentRef->parentRef != NULL);
+         parentRef = parentRef->parentRef)
+    {
+        opHeader[1]++;
+    }
+
+    le_result_t result = WriteFile(streamPtr, opHeader, sizeof(opHeader));
+
+    if (result == LE_OK)
+    {
+        result = WriteJournalParentNames(streamPtr, nodeRef);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a journal operation that renames an original node.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalRename
+(
+    FILE* streamPtr,         ///< [IN] The record being written.
+    tdb_NodeRef_t nodeRef,   ///< [IN] The original node.
+    const char* oldNamePtr,  ///< [IN] The name the node has when the operation is replayed.
+    const char* newNamePtr   ///< [IN] The name the node is given.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_result_t result = WriteJournalOp(streamPtr, JOURNAL_OP_RENAME, nodeRef);
+
+    if (result == LE_OK)
+    {
+        result = WriteJournalName(streamPtr, oldNamePtr);
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteJournalName(streamPtr, newNamePtr);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write operations for the original nodes that a transaction deletes or renames.  This has to be
+ *  done before the transaction is merged, while the original nodes still have their old names.
+ *
+ *  Nodes can swap names in a transaction, so renames are done in two steps.  First each renamed
+ *  node is given a temporary name, which contains a '/' so it can't be the name of any other node.
+ *  Once all of the renamed nodes are out of the way, they are given their new names.  The second
+ *  step is written to its own stream, which is added to the record afterwards.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalDeletes
+(
+    JournalRecord_t* recordPtr,  ///< [IN] The record being written.
+    tdb_NodeRef_t nodeRef        ///< [IN] The shadow node to check, along with its children.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (   (IsDeleted(nodeRef))
+        || (WasRenamed(nodeRef)))
+    {
+        tdb_NodeRef_t originalRef = nodeRef->shadowRef;
+        char name[LE_CFG_NAME_LEN_BYTES] = "";
+
+        // Find the original the same way MergeNode does, in case the shadow node was re-created.
+        if (   (originalRef == NULL)
+            && (nodeRef->parentRef != NULL)
+            && (nodeRef->parentRef->shadowRef != NULL))
+        {
+            tdb_GetNodeName(nodeRef, name, sizeof(name));
+            originalRef = GetNamedChild(nodeRef->parentRef->shadowRef, name);
+        }
+
+        // The root node is cleared rather than deleted, which WriteJournalSets takes care of.
+        if (   (originalRef == NULL)
+            || (originalRef->parentRef == NULL))
+        {
+            return LE_OK;
+        }
+
+        LE_ASSERT(tdb_GetNodeName(originalRef, name, sizeof(name)) == LE_OK);
+
+        if (IsDeleted(nodeRef))
+        {
+            le_result_t result = WriteJournalOp(recordPtr->streamPtr,
+                                                JOURNAL_OP_DELETE,
+                                                originalRef);
+            if (result == LE_OK)
+            {
+                result = WriteJournalName(recordPtr->streamPtr, name);
+            }
+
+            return result;
+        }
+
+        char tempName[SMALL_STR] = "";
+        char newName[LE_CFG_NAME_LEN_BYTES] = "";
+
+        snprintf(tempName, sizeof(tempName), "/%" PRIu32, recordPtr->renameCount++);
+        LE_ASSERT(tdb_GetNodeName(nodeRef, newName, sizeof(newName)) == LE_OK);
+
+        le_result_t result = WriteJournalRename(recordPtr->streamPtr, originalRef, name, tempName);
+
+        if (result == LE_OK)
+        {
+            result = WriteJournalRename(recordPtr->renameStreamPtr,
+                                        originalRef,
+                                        tempName,
+                                        newName);
+        }
+
+        // The node is written whole by WriteJournalSets, which covers any changes to its children.
+        return result;
+    }
+
+    // Modified nodes are written whole by WriteJournalSets, which covers any changes to their
+    // children.
+    if (   (IsModified(nodeRef))
+        || (nodeRef->type != LE_CFG_TYPE_STEM))
+    {
+        return LE_OK;
+    }
+
+    le_result_t result = LE_OK;
+    tdb_NodeRef_t childRef = PeekFirstChild(nodeRef);
+
+    while (   (childRef != NULL)
+           && (result == LE_OK))
+    {
+        result = WriteJournalDeletes(recordPtr, childRef);
+        childRef = tdb_GetNextSiblingNode(childRef);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write set operations for the nodes that a transaction creates or modifies.  This has to be done
+ *  after the transaction is merged, so the operations hold the merged nodes.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalSets
+(
+    FILE* streamPtr,       ///< [IN] The record being written.
+    tdb_NodeRef_t nodeRef, ///< [IN] The shadow node to check, along with its children.
+    char* stringBuffer     ///< [IN] Buffer of TDB_MAX_ENCODED_SIZE bytes for names and values.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (IsDeleted(nodeRef))
+    {
+        // Deleting the root node clears it, so write it.  Other nodes were handled by
+        // WriteJournalDeletes.
+        if (nodeRef->parentRef != NULL)
+        {
+            return LE_OK;
+        }
+    }
+    else if (IsModified(nodeRef) == false)
+    {
+        le_result_t result = LE_OK;
+
+        if (nodeRef->type == LE_CFG_TYPE_STEM)
+        {
+            tdb_NodeRef_t childRef = PeekFirstChild(nodeRef);
+
+            while (   (childRef != NULL)
+                   && (result == LE_OK))
+            {
+                result = WriteJournalSets(streamPtr, childRef, stringBuffer);
+                childRef = tdb_GetNextSiblingNode(childRef);
+            }
+        }
+
+        return result;
+    }
+
+    LE_ASSERT(nodeRef->shadowRef != NULL);
+
+    uint32_t nodeCount = 0;
+    le_result_t result = WriteJournalOp(streamPtr, JOURNAL_OP_SET, nodeRef->shadowRef);
+
+    if (result == LE_OK)
+    {
+        result = WriteSnapshotNode(nodeRef->shadowRef, streamPtr, stringBuffer, &nodeCount);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Start a journal record for a transaction that is about to be merged, and write its delete and
+ *  rename operations.
+ *
+ *  @return True if the record was started, false if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool StartJournalRecord
+(
+    JournalRecord_t* recordPtr,  ///< [OUT] The record.
+    tdb_NodeRef_t shadowRootRef  ///< [IN]  Root node of the transaction's shadow tree.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    JournalRecordHeader_t recordHeader = { 0 };
+    char* renameBufferPtr = NULL;
+    size_t renameSize = 0;
+
+    recordPtr->bufferPtr = NULL;
+    recordPtr->size = 0;
+    recordPtr->renameCount = 0;
+    recordPtr->streamPtr = open_memstream(&recordPtr->bufferPtr, &recordPtr->size);
+    recordPtr->renameStreamPtr = open_memstream(&renameBufferPtr, &renameSize);
+
+    if (   (recordPtr->streamPtr == NULL)
+        || (recordPtr->renameStreamPtr == NULL))
+    {
+        LE_ERROR("Can't create journal record (%m).");
+
+        if (recordPtr->streamPtr != NULL)
+        {
+            fclose(recordPtr->streamPtr);
+            free(recordPtr->bufferPtr);
+        }
+
+        if (recordPtr->renameStreamPtr != NULL)
+        {
+            fclose(recordPtr->renameStreamPtr);
+            free(renameBufferPtr);
+        }
+
+        return false;
+    }
+
+    // The header is filled in once the record is complete.
+    le_result_t result = WriteFile(recordPtr->streamPtr, &recordHeader, sizeof(recordHeader));
+
+    if (result == LE_OK)
+    {
+        result = WriteJournalDeletes(recordPtr, shadowRootRef);
+    }
+
+    if (fclose(recordPtr->renameStreamPtr) != 0)
+    {
+        result = LE_IO_ERROR;
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(recordPtr->streamPtr, renameBufferPtr, renameSize);
+    }
+
+    free(renameBufferPtr);
+
+    if (result != LE_OK)
+    {
+        fclose(recordPtr->streamPtr);
+        free(recordPtr->bufferPtr);
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Finish the journal record of a transaction that has been merged.  Whether this succeeds or not,
+ *  the record's buffer has to be freed.
+ *
+ *  @return LE_OK if the record is complete, LE_IO_ERROR if writing it failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t FinishJournalRecord
+(
+    JournalRecord_t* recordPtr,  ///< [IN] The record.
+    tdb_NodeRef_t shadowRootRef  ///< [IN] Root node of the transaction's shadow tree.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char* stringBuffer = le_mem_ForceAlloc(EncodedStringPool);
+    le_result_t result = WriteJournalSets(recordPtr->streamPtr, shadowRootRef, stringBuffer);
+
+    le_mem_Release(stringBuffer);
+
+    if (fclose(recordPtr->streamPtr) != 0)
+    {
+        LE_ERROR("Failed to write journal record (%m).");
+        result = LE_IO_ERROR;
+    }
+
+    if (result == LE_OK)
+    {
+        JournalRecordHeader_t recordHeader;
+
+        recordHeader.size = recordPtr->size - sizeof(recordHeader);
+        recordHeader.crc = le_crc_Crc32((uint8_t*)recordPtr->bufferPtr + sizeof(recordHeader),
+                                        recordHeader.size,
+                                        LE_CRC_START_CRC32);
+
+        memcpy(recordPtr->bufferPtr, &recordHeader, sizeof(recordHeader));
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write all of a buffer to a journal file.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJournalFile
+(
+    int fd,               ///< [IN] The journal file.
+    const void* dataPtr,  ///< [IN] The data being written.
+    size_t dataSize       ///< [IN] The amount of data being written.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    while (dataSize > 0)
+    {
+        ssize_t written = write(fd, bytePtr, dataSize);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            LE_EMERG("Failed to write to config journal file (%m).");
+            return LE_IO_ERROR;
+        }
+
+        bytePtr += written;
+        dataSize -= written;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Append a finished record to a tree's journal, starting a new journal for the current tree file
+ *  if there isn't one.  The journal is synced before returning.
+ *
+ *  @return LE_OK if the record was appended, or there was nothing to append.
+ *          LE_OUT_OF_RANGE if the journal would grow past LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE.
+ *          LE_IO_ERROR if the journal could not be written.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t AppendJournal
+(
+    tdb_TreeRef_t treeRef,            ///< [IN] The tree the record was committed to.
+    const JournalRecord_t* recordPtr  ///< [IN] The record.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // A transaction that didn't change anything doesn't need to be saved.
+    if (recordPtr->size == sizeof(JournalRecordHeader_t))
+    {
+        return LE_OK;
+    }
+
+    off_t headerSize = (treeRef->journalSize == 0) ? sizeof(JournalHeader_t) : 0;
+
+    if (treeRef->journalSize + headerSize + recordPtr->size > LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+    le_result_t result = LE_OK;
+
+    if (treeRef->journalFd == -1)
+    {
+        GetJournalPath(treeRef->name, pathBuffer, sizeof(pathBuffer));
+
+        if (pathBuffer[0] == '\0')
+        {
+            return LE_IO_ERROR;
+        }
+
+        treeRef->journalFd = open(pathBuffer,
+                                  O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC
+                                      | ((treeRef->journalSize == 0) ? O_TRUNC : 0),
+                                  S_IRUSR | S_IWUSR);
+
+        if (treeRef->journalFd == -1)
+        {
+            LE_ERROR("Failed to open config journal '%s' (%m).", pathBuffer);
+            return LE_IO_ERROR;
+        }
+    }
+
+    // A new journal starts with a header identifying the tree file it applies to.
+    if (headerSize != 0)
+    {
+        JournalHeader_t header = { .version = JOURNAL_VERSION,
+                                   .baseRevision = treeRef->revisionId };
+        struct stat fileStat;
+
+        memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+        GetTreePath(treeRef->name, treeRef->revisionId, pathBuffer, sizeof(pathBuffer));
+
+        if (stat(pathBuffer, &fileStat) != 0)
+        {
+            LE_ERROR("Can't stat config tree file '%s' (%m).", pathBuffer);
+            return LE_IO_ERROR;
+        }
+
+        header.baseSize = fileStat.st_size;
+        result = WriteJournalFile(treeRef->journalFd, &header, sizeof(header));
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteJournalFile(treeRef->journalFd, recordPtr->bufferPtr, recordPtr->size);
+    }
+
+    if (   (result == LE_OK)
+        && (fdatasync(treeRef->journalFd) != 0))
+    {
+        LE_EMERG("Failed to sync config journal file (%m).");
+        result = LE_IO_ERROR;
+    }
+
+    if (result == LE_OK)
+    {
+        treeRef->journalSize += headerSize + recordPtr->size;
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Find a child node while replaying a journal, optionally creating it if it doesn't exist.
+ *
+ *  @return The child node, or NULL if it doesn't exist and wasn't created.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t GetJournalChild
+(
+    tdb_NodeRef_t parentRef,  ///< [IN] The parent node.
+    const char* namePtr,      ///< [IN] The child's name.
+    bool create               ///< [IN] Create the child if it doesn't exist?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t childRef = NULL;
+
+    if (parentRef->type == LE_CFG_TYPE_STEM)
+    {
+        childRef = FindChild(parentRef, namePtr);
+    }
+
+    if (   (childRef == NULL)
+        && (create))
+    {
+        // Like CreateNamedChild, turn a value node into a stem to give it a child.
+        if (   (parentRef->type != LE_CFG_TYPE_STEM)
+            && (parentRef->type != LE_CFG_TYPE_EMPTY))
+        {
+            tdb_SetEmpty(parentRef);
+            ClearModifiedFlag(parentRef);
+            parentRef->type = LE_CFG_TYPE_STEM;
+            parentRef->info.children = LE_DLS_LIST_INIT;
+        }
+
+        childRef = NewChildNode(parentRef);
+
+        if (tdb_SetNodeName(childRef, namePtr) != LE_OK)
+        {
+            LE_ERROR("Bad node name, '%s'.", namePtr);
+            le_mem_Release(childRef);
+            return NULL;
+        }
+
+        ClearModifiedFlag(childRef);
+    }
+
+    return childRef;
 }
 
 
@@ -2377,90 +4233,141 @@ cleanup:
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Serialize a tree node and it's children to a file in the filesystem.
+ *  Apply the next operation of a journal record to a tree.
  *
- *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ *  @return LE_OK if the operation was applied.
+ *          LE_FORMAT_ERROR if the operation is not valid.
  */
 // -------------------------------------------------------------------------------------------------
-static le_result_t InternalWriteNode
+static le_result_t ReplayJournalOp
 (
-    tdb_NodeRef_t nodeRef,  ///< [IN] The node being written.
-    FILE* filePtr           ///< [IN] The file being written to.
+    tdb_NodeRef_t rootRef,        ///< [IN] The root node of the tree.
+    SnapshotReader_t* readerPtr   ///< [IN] The record being read.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // If there is no node to write, or if the node is marked as having been deleted...  Then write
-    // a blank node.
-    if (   (nodeRef == NULL)
-        || (IsDeleted(nodeRef) == true))
+    uint8_t opHeader[2];
+    uint8_t nameLen;
+    uint8_t i;
+
+    if (   (!ReadSnapshotBytes(readerPtr, opHeader, sizeof(opHeader)))
+        || (   (opHeader[0] != JOURNAL_OP_SET)
+            && (opHeader[0] != JOURNAL_OP_DELETE)
+            && (opHeader[0] != JOURNAL_OP_RENAME)))
     {
-        return WriteFile(filePtr, "~ ", 2);
+        return LE_FORMAT_ERROR;
     }
 
-    // Get the node's value as a string.
-    char* stringBuffer = le_mem_ForceAlloc(EncodedStringPool);
-    size_t stringBufferSize = TDB_MAX_ENCODED_SIZE;
-    le_result_t result = LE_OK;
+    // Find the node's parent.  If the node is being set, create any of its parents that are
+    // missing.  Otherwise there's nothing to do if they are missing.
+    bool isSet = (opHeader[0] == JOURNAL_OP_SET);
+    tdb_NodeRef_t parentRef = rootRef;
 
-    tdb_GetValueAsString(nodeRef, stringBuffer, stringBufferSize, "");
+    for (i = 0; i < opHeader[1]; i++)
+    {
+        if (   (!ReadSnapshotBytes(readerPtr, &nameLen, sizeof(nameLen)))
+            || (!ReadSnapshotString(readerPtr, nameLen, LE_CFG_NAME_LEN)))
+        {
+            return LE_FORMAT_ERROR;
+        }
 
-    // Now, depending on the type of node, write out any required format information.
-    switch (nodeRef->type)
+        if (parentRef != NULL)
+        {
+            parentRef = GetJournalChild(parentRef, readerPtr->stringBuffer, isSet);
+
+            if (   (parentRef == NULL)
+                && (isSet))
+            {
+                return LE_FORMAT_ERROR;
+            }
+        }
+    }
+
+    if (isSet == false)
     {
-        case LE_CFG_TYPE_EMPTY:
-        case LE_CFG_TYPE_DOESNT_EXIST:
-            result = WriteFile(filePtr, "~ ", 2);
-            break;
+        if (   (!ReadSnapshotBytes(readerPtr, &nameLen, sizeof(nameLen)))
+            || (nameLen == 0)
+            || (!ReadSnapshotString(readerPtr, nameLen, LE_CFG_NAME_LEN)))
+        {
+            return LE_FORMAT_ERROR;
+        }
 
-        case LE_CFG_TYPE_BOOL:
+        tdb_NodeRef_t nodeRef = (parentRef != NULL) ?
+                                    GetJournalChild(parentRef, readerPtr->stringBuffer, false) :
+                                    NULL;
+
+        if (opHeader[0] == JOURNAL_OP_DELETE)
+        {
+            if (nodeRef != NULL)
             {
-                const char boolBuffer[3] = { '!', stringBuffer[0], ' ' };
-                result = WriteFile(filePtr, boolBuffer, sizeof(boolBuffer));
+                le_mem_Release(nodeRef);
             }
-            break;
 
-        case LE_CFG_TYPE_STRING:
-            result = WriteStringValue(filePtr, '\"', '\"', stringBuffer);
-            break;
+            return LE_OK;
+        }
 
-        case LE_CFG_TYPE_INT:
-            result = WriteStringValue(filePtr, '[', ']', stringBuffer);
-            break;
+        if (   (!ReadSnapshotBytes(readerPtr, &nameLen, sizeof(nameLen)))
+            || (nameLen == 0)
+            || (!ReadSnapshotString(readerPtr, nameLen, LE_CFG_NAME_LEN)))
+        {
+            return LE_FORMAT_ERROR;
+        }
 
-        case LE_CFG_TYPE_FLOAT:
-            result = WriteStringValue(filePtr, '(', ')', stringBuffer);
-            break;
+        // The new name may be a temporary one that tdb_SetNodeName won't take, and may be the name
+        // of a sibling that hasn't been renamed yet, so the name is copied like MergeNode does.
+        if (nodeRef != NULL)
+        {
+            UnindexChild(nodeRef);
 
-        // Looks like this node is a collection, so write out it's child nodes now.
-        case LE_CFG_TYPE_STEM:
-            if ((result = WriteFile(filePtr, "{ ", 2)) == LE_OK)
+            if (nodeRef->nameRef != NULL)
             {
-                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+                dstr_CopyFromCstr(nodeRef->nameRef, readerPtr->stringBuffer);
+            }
+            else
+            {
+                nodeRef->nameRef = dstr_NewFromCstr(readerPtr->stringBuffer);
+            }
+            nodeRef->nameHash = le_hashmap_HashString(readerPtr->stringBuffer);
 
-                while (   (childRef != NULL)
-                       && (result == LE_OK))
-                {
-                    tdb_GetNodeName(childRef, stringBuffer, stringBufferSize);
-                    result = WriteStringValue(filePtr, '\"', '\"', stringBuffer);
+            IndexChild(nodeRef);
+        }
 
-                    if (result == LE_OK)
-                    {
-                        result = InternalWriteNode(childRef, filePtr);
-                    }
+        return LE_OK;
+    }
 
-                    childRef = tdb_GetNextActiveSiblingNode(childRef);
-                }
+    // The node being set is replaced by the snapshot record that follows.  Only the root node
+    // doesn't have a name.
+    uint8_t recordHeader[2];
+    tdb_NodeRef_t nodeRef;
 
-                if (result == LE_OK)
-                {
-                    result = WriteFile(filePtr, "} ", 2);
-                }
-            }
-            break;
+    if (   (!ReadSnapshotBytes(readerPtr, recordHeader, sizeof(recordHeader)))
+        || (!ReadSnapshotString(readerPtr, recordHeader[1], LE_CFG_NAME_LEN)))
+    {
+        return LE_FORMAT_ERROR;
     }
 
-    le_mem_Release(stringBuffer);
-    return result;
+    if (recordHeader[1] == 0)
+    {
+        if (opHeader[1] != 0)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        nodeRef = rootRef;
+    }
+    else
+    {
+        nodeRef = GetJournalChild(parentRef, readerPtr->stringBuffer, true);
+
+        if (nodeRef == NULL)
+        {
+            return LE_FORMAT_ERROR;
+        }
+    }
+
+    tdb_SetEmpty(nodeRef);
+
+    return ReadSnapshotNode(nodeRef, recordHeader[0], readerPtr, ComputePathLength(nodeRef));
 }
 
 
@@ -2468,56 +4375,157 @@ static le_result_t InternalWriteNode
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Calculate the number of bytes required to store a node path, including seperators and a trailing
- *  NULL.
+ *  Replay a tree's journal on top of the tree file that was just loaded.  A journal that doesn't
+ *  belong to that tree file is deleted, and an incomplete record at the end of the journal is cut
+ *  off, so new records can be appended.
  *
- *  @return The amount of bytes required to store the whole path string.
+ *  @return True if the tree and the files on disk match, so that commits can be journaled.
  */
 // -------------------------------------------------------------------------------------------------
-static size_t ComputePathLength
+static bool ReplayJournal
 (
-    tdb_NodeRef_t nodeRef  ///< [IN] Compute a path for this node.
+    tdb_TreeRef_t treeRef,  ///< [IN] The tree that was loaded.
+    FILE* treeFilePtr       ///< [IN] The tree file it was loaded from.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    size_t pathLen = 0;
-    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
+    char pathBuffer[LE_CFG_STR_LEN_BYTES] = "";
+    struct stat fileStat;
+    JournalHeader_t header;
 
-    while (nodeRef != NULL)
+    GetJournalPath(treeRef->name, pathBuffer, sizeof(pathBuffer));
+
+    if (   (pathBuffer[0] == '\0')
+        || (fstat(fileno(treeFilePtr), &fileStat) != 0))
     {
-        LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
+        return false;
+    }
 
-        // Add this path segment's length to our running total, along with the required path
-        // seperator.
-        pathLen += 1 + le_utf8_NumBytes(nodeName);
-        nodeRef = tdb_GetNodeParent(nodeRef);
+    uint64_t baseSize = fileStat.st_size;
+    int fd = open(pathBuffer, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+    {
+        if (errno != ENOENT)
+        {
+            LE_ERROR("Could not open config journal '%s' (%m).", pathBuffer);
+            return false;
+        }
+
+        return true;
     }
 
-    // Don't forget to include a spot for the trailing NULL.
-    return pathLen + 1;
-}
+    if (fstat(fd, &fileStat) != 0)
+    {
+        LE_ERROR("Can't stat config journal '%s' (%m).", pathBuffer);
+        close(fd);
+        return false;
+    }
 
+    size_t fileSize = fileStat.st_size;
+    uint8_t* mapPtr = NULL;
 
+    if (fileSize >= sizeof(header))
+    {
+        mapPtr = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
 
+    close(fd);
 
-// -------------------------------------------------------------------------------------------------
-/**
- *  Bump up the version id of this tree.
- */
-// -------------------------------------------------------------------------------------------------
-static void IncrementRevision
-(
-    tdb_TreeRef_t treeRef  ///< [IN] Increment the revision of this tree.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    treeRef->revisionId++;
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Can't map config journal '%s' (%m).", pathBuffer);
+        return false;
+    }
 
-    if (treeRef->revisionId > 3)
+    if (mapPtr != NULL)
     {
-        treeRef->revisionId = 1;
+        memcpy(&header, mapPtr, sizeof(header));
+    }
+
+    // A journal left behind when a new tree file replaced the one it was for is not used.
+    if (   (mapPtr == NULL)
+        || (memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0)
+        || (header.version != JOURNAL_VERSION)
+        || (header.baseRevision != treeRef->revisionId)
+        || (header.baseSize != baseSize))
+    {
+        LE_WARN("Ignoring config journal '%s', it doesn't belong to the tree file.", pathBuffer);
+
+        if (mapPtr != NULL)
+        {
+            munmap(mapPtr, fileSize);
+        }
+
+        DeleteJournal(treeRef);
+        return true;
+    }
+
+    SnapshotReader_t reader = { .stringBuffer = le_mem_ForceAlloc(EncodedStringPool) };
+    size_t offset = sizeof(header);
+    size_t recordCount = 0;
+    bool isOk = true;
+
+    while (fileSize - offset >= sizeof(JournalRecordHeader_t))
+    {
+        JournalRecordHeader_t recordHeader;
+        uint8_t* dataPtr = mapPtr + offset + sizeof(recordHeader);
+
+        memcpy(&recordHeader, mapPtr + offset, sizeof(recordHeader));
+
+        if (   (recordHeader.size > fileSize - offset - sizeof(recordHeader))
+            || (recordHeader.crc != le_crc_Crc32(dataPtr, recordHeader.size, LE_CRC_START_CRC32)))
+        {
+            break;
+        }
+
+        reader.nextPtr = dataPtr;
+        reader.endPtr = dataPtr + recordHeader.size;
+
+        while (   (isOk)
+               && (reader.nextPtr < reader.endPtr))
+        {
+            isOk = (ReplayJournalOp(treeRef->rootNodeRef, &reader) == LE_OK);
+        }
+
+        if (!isOk)
+        {
+            LE_ERROR("Could not replay record %" PRIuS " of config journal '%s'.",
+                     recordCount,
+                     pathBuffer);
+            break;
+        }
+
+        offset += sizeof(recordHeader) + recordHeader.size;
+        recordCount++;
+    }
+
+    le_mem_Release(reader.stringBuffer);
+    munmap(mapPtr, fileSize);
+
+    LE_DEBUG("** Replayed %" PRIuS " records from '%s'.", recordCount, pathBuffer);
+
+    if (   (isOk)
+        && (offset < fileSize))
+    {
+        // The system went down while the last record was being written, so that transaction was
+        // never committed.
+        LE_WARN("Discarding %" PRIuS " bytes of incomplete records from '%s'.",
+                fileSize - offset,
+                pathBuffer);
+
+        if (truncate(pathBuffer, offset) != 0)
+        {
+            LE_ERROR("Failed to truncate config journal '%s' (%m).", pathBuffer);
+            isOk = false;
+        }
     }
+
+    treeRef->journalSize = isOk ? offset : fileSize;
+
+    return isOk;
 }
+#endif /* LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE */
 
 
 
@@ -2568,12 +4576,31 @@ static void LoadTree
         }
         else
         {
-            if (tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef) == false)
+            bool isRead;
+
+#if LE_CONFIG_LINUX
+            if (IsSnapshotFile(fileRef))
+            {
+                isRead = ReadSnapshot(treeRef->rootNodeRef, fileRef);
+            }
+            else
+#endif
+            {
+                isRead = tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef);
+            }
+
+            if (isRead == false)
             {
                 LE_ERROR("Could not parse configuration tree file: %s.", pathPtr);
                 le_mem_Release(treeRef->rootNodeRef);
                 treeRef->rootNodeRef = NewNode();
             }
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+            else
+            {
+                treeRef->isJournalable = ReplayJournal(treeRef, fileRef);
+            }
+#endif
 
             fclose(fileRef);
         }
@@ -2846,6 +4873,10 @@ void tdb_DeleteTree
             }
         }
 
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+        DeleteJournal(treeRef);
+#endif
+
         LE_ASSERT(le_hashmap_Remove(TreeCollectionRef, treeRef->name) == treeRef);
         le_mem_Release(treeRef);
     }
@@ -2904,6 +4935,42 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called to create a copy of a tree as it is now, for read iterators to move to before a write is
+ *  merged into the tree.  The snapshot is kept until the last iterator on it is released.
+ *
+ *  @return Pointer to the new snapshot tree.  The caller holds a reference to it, which it must
+ *          release with tdb_ReleaseTree.  NULL if the tree is waiting to be deleted, as it would
+ *          be deleted as soon as its readers left it.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_SnapshotTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to copy.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(treeRef->originalTreeRef == NULL);
+    LE_ASSERT(treeRef->isSnapshot == false);
+
+    if (treeRef->isDeletePending)
+    {
+        return NULL;
+    }
+
+    tdb_TreeRef_t snapshotRef = NewTree(treeRef->name, CopyNode(treeRef->rootNodeRef));
+    snapshotRef->revisionId = treeRef->revisionId;
+    snapshotRef->isSnapshot = true;
+
+    return snapshotRef;
+}
+#endif
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
@@ -3017,6 +5084,15 @@ void tdb_RegisterIterator
         treeRef = treeRef->originalTreeRef;
     }
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    // Each iterator on a snapshot holds a reference to it, released by tdb_ReleaseTree.
+    if (treeRef->isSnapshot)
+    {
+        LE_ASSERT(ni_IsWriteable(iteratorRef) == false);
+        le_mem_AddRef(treeRef);
+    }
+#endif
+
     if (ni_IsWriteable(iteratorRef))
     {
         LE_ASSERT(treeRef->activeWriteIterRef == NULL);
@@ -3107,7 +5183,8 @@ le_sls_List_t* tdb_GetRequestQueue
 // -------------------------------------------------------------------------------------------------
 /**
  *  Merge a shadow tree into the original tree it was created from.  Once the change is merged the
- *  updated tree is serialized to the filesystem.
+ *  updated tree is serialized to the filesystem, or just the changes are appended to the tree's
+ *  journal.
  */
 // -------------------------------------------------------------------------------------------------
 void tdb_MergeTree
@@ -3119,16 +5196,47 @@ void tdb_MergeTree
     // Get our shadow tree's root node and merge it's changes into the real tree.  Create a path
     // iterator to track the merge and allow for update handlers to be called.
     tdb_NodeRef_t nodeRef = shadowTreeRef->rootNodeRef;
-    le_pathIter_Ref_t pathRef = CreateBasePath(shadowTreeRef->originalTreeRef->name);
+    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    // Deletes are journaled before the merge, while the deleted nodes still exist.
+    JournalRecord_t journalRecord;
+    bool isJournaled = (   (originalTreeRef->isJournalable)
+                        && (StartJournalRecord(&journalRecord, nodeRef)));
+#endif
+
+    le_pathIter_Ref_t pathRef = CreateBasePath(originalTreeRef->name);
 
-    InternalMergeTree(shadowTreeRef->originalTreeRef->name, pathRef, nodeRef, false);
+    InternalMergeTree(originalTreeRef->name, pathRef, nodeRef, false);
     le_pathIter_Delete(pathRef);
 
     // Now, go through and call the triggered callbacks.
     FireTriggeredCallbacks();
 
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    // If the changes fit in the journal, that's all that needs to be written.  Otherwise the whole
+    // tree is written to a new tree file, which replaces the journal.
+    if (isJournaled)
+    {
+        le_result_t result = FinishJournalRecord(&journalRecord, nodeRef);
+
+        if (result == LE_OK)
+        {
+            result = AppendJournal(originalTreeRef, &journalRecord);
+        }
+
+        free(journalRecord.bufferPtr);
+
+        if (result == LE_OK)
+        {
+            return;
+        }
+    }
+
+    originalTreeRef->isJournalable = false;
+#endif
+
     // Now increment revision of the tree and open a tree file for writing.
-    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
     int oldId = originalTreeRef->revisionId;
 
     IncrementRevision(originalTreeRef);
@@ -3157,7 +5265,22 @@ void tdb_MergeTree
     }
 
     // We have a tree file to write to, so stream the new tree to it then close the output file.
+#if LE_CONFIG_CFGTREE_BINARY_SNAPSHOT
+    le_result_t writeResult = WriteSnapshot(originalTreeRef->rootNodeRef, filePtr);
+#else
     le_result_t writeResult = tdb_WriteTreeNode(originalTreeRef->rootNodeRef, filePtr);
+#endif
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+    // The new file replaces the journal, so make sure it's on disk before the journal is deleted.
+    if (   (writeResult == LE_OK)
+        && (   (fflush(filePtr) != 0)
+            || (fsync(fileno(filePtr)) != 0)))
+    {
+        LE_EMERG("Failed to sync the tree file: %s", strerror(errno));
+        writeResult = LE_IO_ERROR;
+    }
+#endif
 
     int retVal = fclose(filePtr);
     LE_EMERG_IF(retVal == EOF,
@@ -3172,6 +5295,13 @@ void tdb_MergeTree
             GetTreePath(originalTreeRef->name, oldId, filePath, sizeof(filePath));
             DeleteTreeFile(filePath);
         }
+
+#if LE_CONFIG_CFGTREE_JOURNAL_MAX_SIZE > 0
+        // The journal was for the old file.  Delete it only now, as if the system goes down
+        // before this, it's ignored anyway because it doesn't match the new file.
+        DeleteJournal(originalTreeRef);
+        originalTreeRef->isJournalable = true;
+#endif
     }
     else
     {
@@ -3201,6 +5331,12 @@ void tdb_ReleaseTree
     {
         le_mem_Release(treeRef);
     }
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+    else if (treeRef->isSnapshot)
+    {
+        le_mem_Release(treeRef);
+    }
+#endif
 
     // TODO: Possibly free regular trees if there are no active iterators on it?
     //       Should timeouts be used for this?
@@ -3547,6 +5683,8 @@ le_result_t tdb_SetNodeName
 
     // Copy over the new name.  Note that we don't care if this node is a shadow node.  Coping over
     // the name is taken care of as part of the merge process.
+    UnindexChild(nodeRef);
+
     if (nodeRef->nameRef == NULL)
     {
         nodeRef->nameRef = dstr_NewFromCstr(stringPtr);
@@ -3557,6 +5695,8 @@ le_result_t tdb_SetNodeName
     }
     nodeRef->nameHash = le_hashmap_HashString(stringPtr);
 
+    IndexChild(nodeRef);
+
     // If this is a shadow node and this is the change that modified it, then try to get it's
     // children now.  This is done so that later when this node is merged the merge code doesn't end
     // up thinking that the child nodes where removed.
@@ -3682,6 +5822,8 @@ void tdb_SetEmpty
     // If this is a stem node, then go through and clear out the children.
     if (nodeRef->type == LE_CFG_TYPE_STEM)
     {
+        DeleteChildIndex(nodeRef);
+
         tdb_NodeRef_t childRef = tdb_GetFirstChildNode(nodeRef);
 
         while (childRef != NULL)
@@ -127,6 +127,26 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+#if LE_CONFIG_CFGTREE_READ_SNAPSHOTS
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called to create a copy of a tree as it is now, for read iterators to move to before a write is
+ *  merged into the tree.  The snapshot is kept until the last iterator on it is released.
+ *
+ *  @return Pointer to the new snapshot tree.  The caller holds a reference to it, which it must
+ *          release with tdb_ReleaseTree.  NULL if the tree is waiting to be deleted, as it would
+ *          be deleted as soon as its readers left it.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_SnapshotTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to copy.
+);
+#endif
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
@@ -223,6 +223,10 @@ typedef struct
     pid_t               pid;            ///< The process ID.
     le_msg_SessionRef_t ipcSessionRef;  ///< Reference to the IPC session connected to this process.
     le_dls_List_t       logSessionList; ///< List of log sessions in this process.
+#if LE_CONFIG_LOG_BINARY_RING
+    logRing_Reader_t*   ringPtr;        ///< Binary log ring shared by this process (or NULL).
+    bool                isRingFullReported; ///< true once the ring being full has been logged.
+#endif
 /* TODO: Implement shared memory.
     void*               sharedMemAddr;  ///< Address of base of memory region shared with
                                         ///  this process.
@@ -327,6 +331,17 @@ FdLog_t;
 static le_mem_PoolRef_t FdLogPoolRef;
 
 
+#if LE_CONFIG_LOG_BINARY_RING
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer used to log the messages that processes write into their binary log rings.  It is started
+ * when the first ring is received.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t DrainRingsTimerRef;
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum length of log messages.
@@ -731,6 +746,10 @@ static RunningProcess_t* CreateRunningProcess
 
     objPtr->pid = pid;
     objPtr->ipcSessionRef = ipcSessionRef;
+#if LE_CONFIG_LOG_BINARY_RING
+    objPtr->ringPtr = NULL;
+    objPtr->isRingFullReported = false;
+#endif
 //    objPtr->sharedMemAddr = NULL;   // TODO: Implement shared memory.
 
     le_hashmap_Put(ProcessIdMapRef, &objPtr->pid, objPtr);
@@ -1445,6 +1464,134 @@ static void RegComponent
 }
 
 
+#if LE_CONFIG_LOG_BINARY_RING
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message decoded from a running process's binary log ring.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void LogRingMsg
+(
+    const logRing_Msg_t* msgPtr,    ///< [IN] The message.
+    void* contextPtr                ///< [IN] The Running Process object.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RunningProcess_t* runningProcObjPtr = contextPtr;
+
+    log_LogRingMsg(runningProcObjPtr->procNameObjPtr->name, runningProcObjPtr->pid, msgPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs all the unread messages in a running process's binary log ring.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void DrainRing
+(
+    RunningProcess_t* runningProcObjPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t overflows = logRing_Drain(runningProcObjPtr->ringPtr, LogRingMsg, runningProcObjPtr);
+
+    if ((overflows != 0) && !runningProcObjPtr->isRingFullReported)
+    {
+        LE_WARN("Log ring of process '%s' with pid %d is full. Messages are being logged directly.",
+                runningProcObjPtr->procNameObjPtr->name,
+                runningProcObjPtr->pid);
+        runningProcObjPtr->isRingFullReported = true;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer handler that logs the unread messages in all the running processes' binary log rings.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void DrainRingsTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_hashmap_It_Ref_t iterRef = le_hashmap_GetIterator(IpcSessionMapRef);
+
+    while (le_hashmap_NextNode(iterRef) == LE_OK)
+    {
+        RunningProcess_t* runningProcObjPtr = (RunningProcess_t*)le_hashmap_GetValue(iterRef);
+
+        if (runningProcObjPtr->ringPtr != NULL)
+        {
+            DrainRing(runningProcObjPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accepts a binary log ring from a running process.
+ *
+ * @return
+ *      LE_OK if the ring was accepted.
+ *      LE_BAD_PARAMETER if no ring was received.
+ *      LE_NOT_FOUND if the process hasn't registered any log sessions.
+ *      LE_DUPLICATE if the process already has a ring.
+ *      LE_FAULT if the ring is not acceptable.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_result_t ShareRing
+(
+    le_msg_SessionRef_t ipcSessionRef,
+    int fd                              ///< [IN] The ring's memfd (or -1 if none was received).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (fd < 0)
+    {
+        LE_ERROR("Log ring message received without a file descriptor.");
+        return LE_BAD_PARAMETER;
+    }
+
+    RunningProcess_t* runningProcObjPtr = FindProcessByIpcSession(ipcSessionRef);
+    le_result_t result = LE_OK;
+
+    if (runningProcObjPtr == NULL)
+    {
+        LE_ERROR("Log ring received from unregistered IPC session (%p).", ipcSessionRef);
+        result = LE_NOT_FOUND;
+    }
+    else if (runningProcObjPtr->ringPtr != NULL)
+    {
+        LE_ERROR("Process '%s' with pid %d already has a log ring.",
+                 runningProcObjPtr->procNameObjPtr->name,
+                 runningProcObjPtr->pid);
+        result = LE_DUPLICATE;
+    }
+    else
+    {
+        runningProcObjPtr->ringPtr = logRing_Attach(fd);
+
+        if (runningProcObjPtr->ringPtr == NULL)
+        {
+            result = LE_FAULT;
+        }
+        else if (!le_timer_IsRunning(DrainRingsTimerRef))
+        {
+            LE_ASSERT_OK(le_timer_Start(DrainRingsTimerRef));
+        }
+    }
+
+    fd_Close(fd);
+
+    return result;
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle the closing of a client IPC session, which signals the death of a process.
@@ -1475,6 +1622,16 @@ static void ClientIpcSessionClosed
              procNameObjPtr->name,
              runningProcObjPtr->pid);
 
+#if LE_CONFIG_LOG_BINARY_RING
+    // Log whatever the process left in its ring before it went away.
+    if (runningProcObjPtr->ringPtr != NULL)
+    {
+        DrainRing(runningProcObjPtr);
+        logRing_Detach(runningProcObjPtr->ringPtr);
+        runningProcObjPtr->ringPtr = NULL;
+    }
+#endif
+
     // Remove the process from the PID and IPC Session hash maps.
     le_hashmap_Remove(ProcessIdMapRef, &runningProcObjPtr->pid);
     le_hashmap_Remove(IpcSessionMapRef, &ipcSessionRef);
@@ -2492,6 +2649,19 @@ static void ClientMsgReceiveHandler
 
                 return;
 
+#if LE_CONFIG_LOG_BINARY_RING
+            case LOG_CMD_SHARE_RING:
+            {
+                // The response's payload is the result code.
+                le_result_t result = ShareRing(ipcSessionRef, le_msg_GetFd(msgRef));
+
+                memcpy(le_msg_GetPayloadPtr(msgRef), &result, sizeof(result));
+                le_msg_Respond(msgRef);
+
+                return;
+            }
+#endif
+
             case LOG_CMD_SET_LEVEL:
             case LOG_CMD_ENABLE_TRACE:
             case LOG_CMD_DISABLE_TRACE:
@@ -2827,6 +2997,13 @@ COMPONENT_INIT
                                           ProcessIdHash,
                                           ProcessIdEquals);
 
+#if LE_CONFIG_LOG_BINARY_RING
+    DrainRingsTimerRef = le_timer_Create("DrainLogRings");
+    LE_ASSERT_OK(le_timer_SetMsInterval(DrainRingsTimerRef, LE_CONFIG_LOG_BINARY_RING_DRAIN_MS));
+    LE_ASSERT_OK(le_timer_SetRepeat(DrainRingsTimerRef, 0));
+    LE_ASSERT_OK(le_timer_SetHandler(DrainRingsTimerRef, DrainRingsTimerHandler));
+#endif
+
     // Get a reference to the Log Control Protocol identification.
     le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(LOG_CONTROL_PROTOCOL_ID,
                                                              LOG_MAX_CMD_PACKET_BYTES);
@@ -94,6 +94,8 @@
  */
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_REG_COMPONENT           'r' // CommandData = string containing the process ID.
+#define LOG_CMD_SHARE_RING              'b' // CommandData = string containing the process ID.
+                                            // The binary log ring's memfd is attached.
 
 
 //--------------------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
  * @ref sd_toolService <br>
  * @ref sd_data <br>
  * @ref sd_theoryOfOperation <br>
+ * @ref sd_indexes <br>
  * @ref sd_deathDetection <br>
  * @ref sd_threading <br>
  * @ref sd_startUpSync <br>
@@ -114,10 +115,9 @@ User List ------> User --+---> Name               |        |        |
  * object is not found for that service name on that User, the new one is is added to the list.
  * Otherwise, the new server connection is dropped.
  *
- * When a new Server Connection is added to a Service List, all users' Binding Lists are
- * searched for matching bindings, and if any that match have non-empty Waiting Clients Lists,
- * all those Client Connections are removed from those lists and dispatched to the new Server
- * Connection.
+ * When a new Server Connection is added to a Service List, the bindings that refer to its service
+ * are found, and if any of them have non-empty Waiting Clients Lists, all those Client Connections
+ * are removed from those lists and dispatched to the new Server Connection.
  *
  * When a Binding is added, it is added to the client's User object's Binding List.  That user's
  * Unbound Clients List will then be checked for matches to the new binding, and if any are found,
@@ -134,6 +134,27 @@ User List ------> User --+---> Name               |        |        |
  * be changed.)
  *
  *
+ * @section sd_indexes              Lookup Indexes
+ *
+ * At start-up, every app opens its sessions at about the same time, so the searches above are
+ * done hundreds of times in a burst.  To keep them from growing with the number of users, bindings
+ * and services, the lists are indexed by hash maps:
+ *
+ *  - The User Map finds a User object from its Unix user ID.
+ *  - The Binding Map finds a Binding object from its client User and client interface name.
+ *  - The Service Map finds the Server Connection serving a service from its server User and
+ *    service name.
+ *  - The Bound Service Map finds the Binding objects that refer to a service from the service's
+ *    server User and service name, whether the service is being served or not.
+ *
+ * The lists are kept, so the order of the @c sdir tool's output doesn't change.
+ *
+ * The Client Socket and Server Socket handlers accept all pending connections (up to
+ * MAX_ACCEPTS_PER_WAKEUP) each time they are called, and try to receive each new connection's
+ * first message straight away, because processes send it as soon as they are connected.  This
+ * saves a trip through the Event Loop per connection when many processes are connecting at once.
+ *
+ *
  * @section sd_deathDetection       Detection of Client or Server Death
  *
  * When a client or server process dies while it is connected to the Service Directory, the OS
@@ -220,6 +241,21 @@ User List ------> User --+---> Name               |        |        |
 #define MAX_CONNECT_REQUEST_BACKLOG 100
 
 
+//--------------------------------------------------------------------------------------------------
+/// The maximum number of connection requests accepted from the Client Socket or the Server Socket
+/// each time it is reported readable.  Bounds how long one socket can hold off the other.
+//--------------------------------------------------------------------------------------------------
+#define MAX_ACCEPTS_PER_WAKEUP 32
+
+
+//--------------------------------------------------------------------------------------------------
+/// Initial capacities of the hash maps.  They are sized for a system with about 40 apps.
+//--------------------------------------------------------------------------------------------------
+#define USER_MAP_CAPACITY           61
+#define BINDING_MAP_CAPACITY        509
+#define SERVICE_MAP_CAPACITY        251
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a user.  Objects of this type are allocated from the User Pool and are kept on the
@@ -250,6 +286,26 @@ static le_mem_PoolRef_t UserPoolRef;
 static le_dls_List_t UserList = LE_DLS_LIST_INIT;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The User Map, which indexes the User List by Unix user ID.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t UserMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key of the Binding Map, the Service Map and the Bound Service Map: a User and an interface or
+ * service name.  The name points into the object that holds the key.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const User_t*   userPtr;    ///< Ptr to the User object.
+    const char*     name;       ///< Interface or service name.
+}
+NameKey_t;
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -260,6 +316,7 @@ static le_dls_List_t UserList = LE_DLS_LIST_INIT;
 typedef struct
 {
     le_dls_Link_t               link;           ///< Used to link onto user's Service List.
+    NameKey_t                   serviceKey;     ///< Key in the Service Map, once on Service List.
     int                         fd;             ///< Fd of the connection socket.
     le_fdMonitor_Ref_t          fdMonitorRef;   ///< FD Monitor object monitoring this connection.
     User_t*                     userPtr;        ///< Pointer to the User object for the client uid.
@@ -275,6 +332,42 @@ ServerConnection_t;
 static le_mem_PoolRef_t ServerConnectionPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The Service Map, which finds the Server Connection on a User's Service List from its User and
+/// service name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ServiceMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Represents a service that one or more bindings refer to, whether it is being served or not.
+ * Objects of this type are allocated from the Bound Service Pool and are kept in the Bound Service
+ * Map.  Each Binding object on the Binding List holds a reference count on it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    NameKey_t       key;            ///< Key in the Bound Service Map.
+    User_t*         serverUserPtr;  ///< Ptr to the User who serves the service.
+    char            serviceName[LIMIT_MAX_IPC_INTERFACE_NAME_BYTES]; ///< Service name.
+    le_dls_List_t   bindingList;    ///< List of Bindings that refer to the service.
+}
+BoundService_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/// Pool from which Bound Service objects are allocated.
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BoundServicePoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/// The Bound Service Map, which finds a Bound Service object from its server User and service name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BoundServiceMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a binding from a user's client interface to a service.  Objects of this type are
@@ -284,6 +377,9 @@ static le_mem_PoolRef_t ServerConnectionPoolRef;
 typedef struct
 {
     le_dls_Link_t       link;               ///< Used to link into the User's Binding List.
+    NameKey_t           clientKey;          ///< Key in the Binding Map.
+    le_dls_Link_t       boundServiceLink;   ///< Used to link into the Bound Service's Binding List.
+    BoundService_t*     boundServicePtr;    ///< Ptr to the Bound Service object for the service.
     User_t*             clientUserPtr;      ///< Ptr to the client User whose Binding List I'm in.
     User_t*             serverUserPtr;      ///< Ptr to the User who serves the service.
     char                clientInterfaceName[LIMIT_MAX_IPC_INTERFACE_NAME_BYTES];///< Client I/F name
@@ -300,6 +396,12 @@ Binding_t;
 static le_mem_PoolRef_t BindingPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The Binding Map, which finds a Binding object from its client User and client interface name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BindingMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Enumeration of the different states that a client connection can be in.
@@ -370,6 +472,47 @@ static le_fdMonitor_Ref_t ServerSocketMonitorRef;
 // =======================================
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hashing function for the keys of the Binding Map, Service Map and Bound Service Map.
+ *
+ * @return The hash value.
+ **/
+//--------------------------------------------------------------------------------------------------
+static size_t HashNameKey
+(
+    const void* keyPtr      ///< [in] Ptr to the NameKey_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const NameKey_t* nameKeyPtr = keyPtr;
+
+    return (le_hashmap_HashString(nameKeyPtr->name) * 31) + nameKeyPtr->userPtr->uid;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Equality function for the keys of the Binding Map, Service Map and Bound Service Map.
+ *
+ * @return true if the keys are equal.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool EqualsNameKey
+(
+    const void* firstKeyPtr,    ///< [in] Ptr to the first NameKey_t.
+    const void* secondKeyPtr    ///< [in] Ptr to the second NameKey_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const NameKey_t* firstPtr = firstKeyPtr;
+    const NameKey_t* secondPtr = secondKeyPtr;
+
+    return (   (firstPtr->userPtr == secondPtr->userPtr)
+            && (strcmp(firstPtr->name, secondPtr->name) == 0) );
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a User object for a given Unix user ID.
@@ -399,8 +542,9 @@ static User_t* CreateUser
     userPtr->serviceList = LE_DLS_LIST_INIT;
     userPtr->unboundClientsList = LE_DLS_LIST_INIT;
 
-    // Add it to the User List.
+    // Add it to the User List and the User Map.
     le_dls_Queue(&UserList, &userPtr->link);
+    le_hashmap_Put(UserMapRef, &userPtr->uid, userPtr);
 
     return userPtr;
 }
@@ -408,7 +552,7 @@ static User_t* CreateUser
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches the User List for a particular Unix user ID.  If found, increments the reference count
+ * Looks up a particular Unix user ID in the User Map.  If found, increments the reference count
  * on that object.  If not found, creates a new User object.
  *
  * @return Pointer to the User object.
@@ -420,19 +564,12 @@ static User_t* GetUser
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&UserList);
+    User_t* userPtr = le_hashmap_Get(UserMapRef, &uid);
 
-    while (linkPtr != NULL)
+    if (userPtr != NULL)
     {
-        User_t* userPtr = CONTAINER_OF(linkPtr, User_t, link);
-
-        if (userPtr->uid == uid)
-        {
-            le_mem_AddRef(userPtr);
-            return userPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&UserList, linkPtr);
+        le_mem_AddRef(userPtr);
+        return userPtr;
     }
 
     return CreateUser(uid);
@@ -453,14 +590,16 @@ static void UserDestructor
 {
     User_t* userPtr = objPtr;
 
-    // Remove the User object from the User List.
+    // Remove the User object from the User List and the User Map.
     le_dls_Remove(&UserList, &userPtr->link);
+    le_hashmap_Remove(UserMapRef, &userPtr->uid);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a (client) User's Binding List for a particular client-side interface name.
+ * Looks up a (client) User's binding of a particular client-side interface name in the
+ * Binding Map.
  *
  * @return Pointer to the Binding object or NULL if not found.
  **/
@@ -472,21 +611,9 @@ static Binding_t* FindBinding
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->bindingList);
+    NameKey_t key = { .userPtr = userPtr, .name = interfaceName };
 
-    while (linkPtr != NULL)
-    {
-        Binding_t* bindingPtr = CONTAINER_OF(linkPtr, Binding_t, link);
-
-        if (strcmp(bindingPtr->clientInterfaceName, interfaceName) == 0)
-        {
-            return bindingPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&userPtr->bindingList, linkPtr);
-    }
-
-    return NULL;
+    return le_hashmap_Get(BindingMapRef, &key);
 }
 
 
@@ -597,9 +724,9 @@ static le_result_t ReceiveMessage
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a User's Service List for a particular service name.
+ * Looks up a User's service of a particular service name in the Service Map.
  *
- * @return Pointer to the Server Connection object for the matching service.
+ * @return Pointer to the Server Connection object for the matching service, or NULL if not found.
  **/
 //--------------------------------------------------------------------------------------------------
 static ServerConnection_t* FindService
@@ -609,21 +736,78 @@ static ServerConnection_t* FindService
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->serviceList);
+    NameKey_t key = { .userPtr = userPtr, .name = serviceName };
 
-    while (linkPtr != NULL)
-    {
-        ServerConnection_t* serverConnectionPtr = CONTAINER_OF(linkPtr, ServerConnection_t, link);
+    return le_hashmap_Get(ServiceMapRef, &key);
+}
 
-        if (strcmp(serverConnectionPtr->interface.interfaceName, serviceName) == 0)
-        {
-            return serverConnectionPtr;
-        }
 
-        linkPtr = le_dls_PeekNext(&userPtr->serviceList, linkPtr);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks up the Bound Service object for a particular service of a User in the Bound Service Map.
+ * If found, increments the reference count on that object.  If not found, creates a new one.
+ *
+ * @return Pointer to the Bound Service object.
+ **/
+//--------------------------------------------------------------------------------------------------
+static BoundService_t* GetBoundService
+(
+    User_t* serverUserPtr,      ///< [in] Ptr to the server's User object.
+    const char* serviceName     ///< [in] Service name string.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    NameKey_t key = { .userPtr = serverUserPtr, .name = serviceName };
+
+    BoundService_t* boundServicePtr = le_hashmap_Get(BoundServiceMapRef, &key);
+
+    if (boundServicePtr != NULL)
+    {
+        le_mem_AddRef(boundServicePtr);
+        return boundServicePtr;
     }
 
-    return NULL;
+    boundServicePtr = le_mem_ForceAlloc(BoundServicePoolRef);
+
+    // Note: we know the service name is a valid length.
+    le_utf8_Copy(boundServicePtr->serviceName,
+                 serviceName,
+                 sizeof(boundServicePtr->serviceName),
+                 NULL);
+
+    // The Bound Service object holds a reference to the server User object.
+    le_mem_AddRef(serverUserPtr);
+    boundServicePtr->serverUserPtr = serverUserPtr;
+    boundServicePtr->bindingList = LE_DLS_LIST_INIT;
+
+    boundServicePtr->key.userPtr = serverUserPtr;
+    boundServicePtr->key.name = boundServicePtr->serviceName;
+    le_hashmap_Put(BoundServiceMapRef, &boundServicePtr->key, boundServicePtr);
+
+    return boundServicePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor function that runs when a Bound Service object's reference count reaches zero and
+ * the object is about to be released back into its pool.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BoundServiceDestructor
+(
+    void* objPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BoundService_t* boundServicePtr = objPtr;
+
+    LE_ASSERT(le_dls_IsEmpty(&boundServicePtr->bindingList));
+
+    le_hashmap_Remove(BoundServiceMapRef, &boundServicePtr->key);
+
+    le_mem_Release(boundServicePtr->serverUserPtr);
+    boundServicePtr->serverUserPtr = NULL;
 }
 
 
@@ -917,8 +1101,16 @@ static void CreateBinding
     bindingPtr->serverConnectionPtr = NULL;
     bindingPtr->waitingClientsList = LE_DLS_LIST_INIT;
 
-    // Add the Binding to the client User's Binding List.
+    // Add the Binding to the client User's Binding List and to the Binding Map.
     le_dls_Queue(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    bindingPtr->clientKey.userPtr = clientUserPtr;
+    bindingPtr->clientKey.name = bindingPtr->clientInterfaceName;
+    le_hashmap_Put(BindingMapRef, &bindingPtr->clientKey, bindingPtr);
+
+    // Add the Binding to the Binding List of the service it refers to.
+    bindingPtr->boundServicePtr = GetBoundService(serverUserPtr, serverInterfaceName);
+    bindingPtr->boundServiceLink = LE_DLS_LINK_INIT;
+    le_dls_Queue(&bindingPtr->boundServicePtr->bindingList, &bindingPtr->boundServiceLink);
 
     // Look for a server serving the binding's destination service.
     bindingPtr->serverConnectionPtr = FindService(bindingPtr->serverUserPtr, serverInterfaceName);
@@ -1001,51 +1193,46 @@ static void ResolveBindingsToServer
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // For each user,
-    le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
+    NameKey_t key = { .userPtr = connectionPtr->userPtr,
+                      .name = connectionPtr->interface.interfaceName };
 
-    while (userLinkPtr != NULL)
+    BoundService_t* boundServicePtr = le_hashmap_Get(BoundServiceMapRef, &key);
+
+    // If no bindings refer to the new server's service, there's nothing to do.
+    if (boundServicePtr == NULL)
     {
-        User_t* userPtr = CONTAINER_OF(userLinkPtr, User_t, link);
+        return;
+    }
 
-        // For each of the user's bindings,
-        le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&userPtr->bindingList);
-        while (bindingLinkPtr != NULL)
-        {
-            Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, link);
+    // For each of the bindings that point at the new server's service,
+    le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&boundServicePtr->bindingList);
+    while (bindingLinkPtr != NULL)
+    {
+        Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, boundServiceLink);
 
-            // If the binding is pointing at the new server's service,
-            if (   (connectionPtr->userPtr == bindingPtr->serverUserPtr)
-                && (0 == strcmp(connectionPtr->interface.interfaceName,
-                                bindingPtr->serverInterfaceName))  )
-            {
-                bindingPtr->serverConnectionPtr = connectionPtr;
+        bindingPtr->serverConnectionPtr = connectionPtr;
 
-                // While there's still a client connection on the Waiting Clients List, get
-                // a pointer to the first one, without removing it from the list, then try
-                // to dispatch that client to the server.
-                le_dls_Link_t* clientLinkPtr;
-                while (NULL != (clientLinkPtr = le_dls_Peek(&bindingPtr->waitingClientsList)))
-                {
-                    ClientConnection_t* clientConnectionPtr = CONTAINER_OF(clientLinkPtr,
-                                                                           ClientConnection_t,
-                                                                           link);
-                    if (DispatchToServer(clientConnectionPtr, connectionPtr) == LE_CLOSED)
-                    {
-                        // Server went down.  Client was left on the Waiting Clients List.
-                        // Server Connection destructor was run and it disconnected itself
-                        // from the Binding object.
-                        return;
-                    }
-                    // NOTE: If the server didn't go down, then the Client Connection has been
-                    // deleted and its destructor removed it from the Waiting Clients List.
-                }
+        // While there's still a client connection on the Waiting Clients List, get
+        // a pointer to the first one, without removing it from the list, then try
+        // to dispatch that client to the server.
+        le_dls_Link_t* clientLinkPtr;
+        while (NULL != (clientLinkPtr = le_dls_Peek(&bindingPtr->waitingClientsList)))
+        {
+            ClientConnection_t* clientConnectionPtr = CONTAINER_OF(clientLinkPtr,
+                                                                   ClientConnection_t,
+                                                                   link);
+            if (DispatchToServer(clientConnectionPtr, connectionPtr) == LE_CLOSED)
+            {
+                // Server went down.  Client was left on the Waiting Clients List.
+                // Server Connection destructor was run and it disconnected itself
+                // from the Binding object.
+                return;
             }
-
-            bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
+            // NOTE: If the server didn't go down, then the Client Connection has been
+            // deleted and its destructor removed it from the Waiting Clients List.
         }
 
-        userLinkPtr = le_dls_PeekNext(&UserList, userLinkPtr);
+        bindingLinkPtr = le_dls_PeekNext(&boundServicePtr->bindingList, bindingLinkPtr);
     }
 }
 
@@ -1079,8 +1266,11 @@ static void ProcessAdvertisementFromServer
     // connection to the service list.
     else
     {
-        // Add the object to the User's Service List.
+        // Add the object to the User's Service List and to the Service Map.
         le_dls_Queue(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+        connectionPtr->serviceKey.userPtr = connectionPtr->userPtr;
+        connectionPtr->serviceKey.name = connectionPtr->interface.interfaceName;
+        le_hashmap_Put(ServiceMapRef, &connectionPtr->serviceKey, connectionPtr);
 
         LE_DEBUG("Server (uid %u '%s', pid %d) now serving service '%s' (%s).",
                  connectionPtr->userPtr->uid,
@@ -1202,25 +1392,22 @@ static void ProcessOpenRequestFromClient
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Handler function that gets called when the client sends us data.
+ * Receives and processes data sent to us by a client, if there is any.
  *
- * @note The Context Pointer is a pointer to a Client Connection object.
+ * @note The Client Connection may be closed by this function.
  */
 //--------------------------------------------------------------------------------------------------
-static void ClientReadHandler
+static void ReceiveFromClient
 (
-    int fd  ///< [in] File descriptor for the connection.
+    ClientConnection_t* clientConnectionPtr ///< [in] Ptr to the Client Connection object.
 )
 //--------------------------------------------------------------------------------------------------
 {
     le_result_t result;
-    ClientConnection_t* clientConnectionPtr = le_fdMonitor_GetContextPtr();
-
-    LE_ASSERT(clientConnectionPtr != NULL);
 
     // Receive the "Open" request from the client.
     svcdir_OpenRequest_t msg;
-    result = ReceiveMessage(fd, &msg, sizeof(msg));
+    result = ReceiveMessage(clientConnectionPtr->fd, &msg, sizeof(msg));
 
     // If the connection has closed or there is simply nothing left to be received
     // from the socket,
@@ -1267,6 +1454,27 @@ static void ClientReadHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function that gets called when the client sends us data.
+ *
+ * @note The Context Pointer is a pointer to a Client Connection object.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientReadHandler
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ClientConnection_t* clientConnectionPtr = le_fdMonitor_GetContextPtr();
+
+    LE_ASSERT(clientConnectionPtr != NULL);
+
+    ReceiveFromClient(clientConnectionPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * File descriptor event handler for sockets connected to clients.
@@ -1289,7 +1497,7 @@ static void ClientSocketHandler
     }
     else if (events & POLLIN)
     {
-        ClientReadHandler(fd);
+        ClientReadHandler();
     }
 
     LE_CRIT_IF(events & ~(POLLERR | POLLRDHUP | POLLHUP | POLLIN),
@@ -1301,9 +1509,11 @@ static void ClientSocketHandler
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a Client Connection object to track a given connection to a given client process.
+ *
+ * @return Pointer to the new Client Connection object.
  **/
 //--------------------------------------------------------------------------------------------------
-static void CreateClientConnection
+static ClientConnection_t* CreateClientConnection
 (
     int     fd,     ///< [in] File descriptor for the connection.
     uid_t   uid,    ///< [in] Unix user ID of the connected process.
@@ -1334,6 +1544,8 @@ static void CreateClientConnection
 
     // Set a pointer to the Connection object as the handler context.
     le_fdMonitor_SetContextPtr(connectionPtr->fdMonitorRef, connectionPtr);
+
+    return connectionPtr;
 }
 
 
@@ -1391,7 +1603,64 @@ static void ClientConnectionDestructor
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Handler function that gets called when a client connects to the Client socket.
+ * Accepts a connection request on the Client Socket or the Server Socket, and gets the
+ * credentials of the connected process.
+ *
+ * @return
+ * - File descriptor of the new connection, set to be non-blocking, if successful.
+ * - LE_WOULD_BLOCK if there are no connection requests pending.
+ * - LE_FAULT if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static int AcceptConnection
+(
+    int fd,                         ///< [in] File descriptor of the Client or Server Socket.
+    const char* peerTypeStr,        ///< [in] "client" or "server", for log messages.
+    struct ucred* credentialsPtr    ///< [out] Credentials of the connected process.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int connectionFd;
+
+    // Accept the connection, setting the connection to be non-blocking.
+    do
+    {
+        connectionFd = accept4(fd, NULL, NULL, SOCK_NONBLOCK);
+    }
+    while ((connectionFd < 0) && (errno == EINTR));
+
+    if (connectionFd < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            return LE_WOULD_BLOCK;
+        }
+
+        LE_CRIT("Failed to accept %s connection. Errno %d (%m).", peerTypeStr, errno);
+        return LE_FAULT;
+    }
+
+    socklen_t credentialsSize = sizeof(*credentialsPtr);
+
+    // Get the remote process's credentials.
+    if (0 != getsockopt(connectionFd,
+                        SOL_SOCKET,
+                        SO_PEERCRED,
+                        credentialsPtr,
+                        &credentialsSize) )
+    {
+        LE_ERROR("Failed to obtain credentials from %s.  Errno = %d (%m)", peerTypeStr, errno);
+        fd_Close(connectionFd);
+        return LE_FAULT;
+    }
+
+    return connectionFd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function that gets called when clients connect to the Client socket.
  */
 //--------------------------------------------------------------------------------------------------
 static void ClientConnectHandler
@@ -1406,42 +1675,33 @@ static void ClientConnectHandler
         LE_CRIT("Unexpected fd event(s): 0x%hX", events);
     }
 
-    // Accept the connection, setting the connection to be non-blocking.
-    fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK);
-
-    if (fd < 0)
-    {
-        LE_CRIT("Failed to accept client connection. Errno %d (%m).", errno);
-    }
-    else
+    // Accept the pending connection requests, up to a limit.  If there are more, we will be
+    // called again.
+    int i;
+    for (i = 0; i < MAX_ACCEPTS_PER_WAKEUP; i++)
     {
         struct ucred credentials;
 
-        socklen_t credentialsSize = sizeof(credentials);
-
-        // Get the remote process's credentials.
-        if (0 != getsockopt(fd,
-                            SOL_SOCKET,
-                            SO_PEERCRED,
-                            &credentials,
-                            &credentialsSize) )
+        int connectionFd = AcceptConnection(fd, "client", &credentials);
+        if (connectionFd < 0)
         {
-            LE_ERROR("Failed to obtain credentials from client.  Errno = %d (%m)", errno);
-            fd_Close(fd);
+            break;
         }
-        else
-        {
-            LE_DEBUG("Client connected:  pid = %d;  uid = %d;  gid = %d.",
-                     credentials.pid,
-                     credentials.uid,
-                     credentials.gid);
 
-            // Create a Connection object to use to track this connection.
-            CreateClientConnection(fd, credentials.uid, credentials.pid);
+        LE_DEBUG("Client connected:  pid = %d;  uid = %d;  gid = %d.",
+                 credentials.pid,
+                 credentials.uid,
+                 credentials.gid);
 
-            // Now we wait for the client to send us the session details (or disconnect).
-            // When that happens, our client fd event handler functions will be called.
-        }
+        // Create a Connection object to use to track this connection.
+        ClientConnection_t* connectionPtr = CreateClientConnection(connectionFd,
+                                                                   credentials.uid,
+                                                                   credentials.pid);
+
+        // Clients send the session details as soon as they are connected, so they have usually
+        // arrived by now.  If not, we wait for the client to send them (or disconnect), and our
+        // client fd event handler functions will be called when that happens.
+        ReceiveFromClient(connectionPtr);
     }
 }
 
@@ -1500,26 +1760,25 @@ static void ServerHangUpHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Handler function that gets called when the server sends us data.
+ * Receives and processes data sent to us by a server, if there is any.
  *
- * @note The Context Pointer is a pointer to a Server Connection object.
+ * @note The Server Connection may be closed by this function.
  */
 //--------------------------------------------------------------------------------------------------
-static void ServerReadHandler
+static void ReceiveFromServer
 (
-    int fd  ///< [in] File descriptor for the connection.
+    ServerConnection_t* connectionPtr   ///< [in] Ptr to the Server Connection object.
 )
 //--------------------------------------------------------------------------------------------------
 {
     le_result_t result;
-    ServerConnection_t* connectionPtr = le_fdMonitor_GetContextPtr();
-
-    LE_ASSERT(connectionPtr != NULL);
 
     bool alreadyReceivedServiceId = (connectionPtr->interface.interfaceName[0] != '\0');
 
     // Receive the service identity from the server.
-    result = ReceiveMessage(fd, &(connectionPtr->interface), sizeof(connectionPtr->interface));
+    result = ReceiveMessage(connectionPtr->fd,
+                            &(connectionPtr->interface),
+                            sizeof(connectionPtr->interface));
 
     // If the connection has closed or there is simply nothing left to be received
     // from the socket,
@@ -1559,6 +1818,27 @@ static void ServerReadHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function that gets called when the server sends us data.
+ *
+ * @note The Context Pointer is a pointer to a Server Connection object.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServerReadHandler
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ServerConnection_t* connectionPtr = le_fdMonitor_GetContextPtr();
+
+    LE_ASSERT(connectionPtr != NULL);
+
+    ReceiveFromServer(connectionPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * File descriptor event handler for sockets connected to servers.
@@ -1581,7 +1861,7 @@ static void ServerSocketHandler
     }
     else if (events & POLLIN)
     {
-        ServerReadHandler(fd);
+        ServerReadHandler();
     }
 
     LE_CRIT_IF(events & ~(POLLERR | POLLRDHUP | POLLHUP | POLLIN),
@@ -1593,9 +1873,11 @@ static void ServerSocketHandler
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a Server Connection object to track a given connection to a given server process.
+ *
+ * @return Pointer to the new Server Connection object.
  **/
 //--------------------------------------------------------------------------------------------------
-static void CreateServerConnection
+static ServerConnection_t* CreateServerConnection
 (
     int     fd,     ///< [in] File descriptor for the connection.
     uid_t   uid,    ///< [in] Unix user ID of the connected process.
@@ -1624,6 +1906,8 @@ static void CreateServerConnection
 
     // Set a pointer to the Connection object as the handler context.
     le_fdMonitor_SetContextPtr(connectionPtr->fdMonitorRef, connectionPtr);
+
+    return connectionPtr;
 }
 
 
@@ -1641,33 +1925,6 @@ static void ServerConnectionDestructor
 {
     ServerConnection_t* connectionPtr = objPtr;
 
-    // Disassociate the Server Connection object from all Binding objects that refer to it...
-
-    // For each user,
-    le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
-
-    while (userLinkPtr != NULL)
-    {
-        User_t* userPtr = CONTAINER_OF(userLinkPtr, User_t, link);
-
-        // For each of the user's bindings,
-        le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&userPtr->bindingList);
-        while (bindingLinkPtr != NULL)
-        {
-            Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, link);
-
-            // If the binding is associated with the deleted server connection,
-            if (connectionPtr == bindingPtr->serverConnectionPtr)
-            {
-                bindingPtr->serverConnectionPtr = NULL;
-            }
-
-            bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
-        }
-
-        userLinkPtr = le_dls_PeekNext(&UserList, userLinkPtr);
-    }
-
     if (connectionPtr->interface.interfaceName[0] == '\0')
     {
         LE_DEBUG("Server (uid %u '%s', pid %d) disconnected without ever advertising a service.",
@@ -1684,12 +1941,37 @@ static void ServerConnectionDestructor
                  connectionPtr->interface.interfaceName,
                  connectionPtr->interface.protocolId);
 
-        // Remove the Server Connection from the User's Service List, if it has been added.
+        // Remove the Server Connection from the User's Service List and the Service Map, if it
+        // has been added.
         // NOTE: If the connection is rejected because of a bad or duplicate advertisement,
         //       then the connection will not have made it into the user's list of services.
         if (le_dls_IsInList(&connectionPtr->userPtr->serviceList, &connectionPtr->link))
         {
             le_dls_Remove(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+            le_hashmap_Remove(ServiceMapRef, &connectionPtr->serviceKey);
+
+            // Disassociate the Server Connection object from all Binding objects that refer
+            // to it.  Only a connection on a Service List can be referred to by a binding.
+            BoundService_t* boundServicePtr = le_hashmap_Get(BoundServiceMapRef,
+                                                             &connectionPtr->serviceKey);
+            if (boundServicePtr != NULL)
+            {
+                le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&boundServicePtr->bindingList);
+                while (bindingLinkPtr != NULL)
+                {
+                    Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr,
+                                                         Binding_t,
+                                                         boundServiceLink);
+
+                    if (connectionPtr == bindingPtr->serverConnectionPtr)
+                    {
+                        bindingPtr->serverConnectionPtr = NULL;
+                    }
+
+                    bindingLinkPtr = le_dls_PeekNext(&boundServicePtr->bindingList,
+                                                     bindingLinkPtr);
+                }
+            }
         }
     }
 
@@ -1712,7 +1994,7 @@ static void ServerConnectionDestructor
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Handler function that gets called when a server connects to the Server socket.
+ * Handler function that gets called when servers connect to the Server socket.
  */
 //--------------------------------------------------------------------------------------------------
 static void ServerConnectHandler
@@ -1727,41 +2009,33 @@ static void ServerConnectHandler
         LE_CRIT("Unexpected fd event(s): 0x%hX", events);
     }
 
-    // Accept the connection, setting the connection to be non-blocking.
-    fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK);
-
-    if (fd < 0)
-    {
-        LE_CRIT("Failed to accept server connection. Errno %d (%m).", errno);
-    }
-    else
+    // Accept the pending connection requests, up to a limit.  If there are more, we will be
+    // called again.
+    int i;
+    for (i = 0; i < MAX_ACCEPTS_PER_WAKEUP; i++)
     {
         struct ucred credentials;
-        socklen_t credentialsSize = sizeof(credentials);
-
-        // Get the remote process's credentials.
-        if (0 != getsockopt(fd,
-                            SOL_SOCKET,
-                            SO_PEERCRED,
-                            &credentials,
-                            &credentialsSize) )
+
+        int connectionFd = AcceptConnection(fd, "server", &credentials);
+        if (connectionFd < 0)
         {
-            LE_ERROR("Failed to obtain credentials from server.  Errno = %d (%m)", errno);
-            fd_Close(fd);
+            break;
         }
-        else
-        {
-            LE_DEBUG("Server connected:  pid = %d;  uid = %u;  gid = %u.",
-                     credentials.pid,
-                     credentials.uid,
-                     credentials.gid);
 
-            // Create a Connection object to use to track this connection.
-            CreateServerConnection(fd, credentials.uid, credentials.pid);
+        LE_DEBUG("Server connected:  pid = %d;  uid = %u;  gid = %u.",
+                 credentials.pid,
+                 credentials.uid,
+                 credentials.gid);
 
-            // Now we wait for the server to send us the session details (or disconnect).
-            // When that happens, our server fd event handler functions will be called.
-        }
+        // Create a Connection object to use to track this connection.
+        ServerConnection_t* connectionPtr = CreateServerConnection(connectionFd,
+                                                                   credentials.uid,
+                                                                   credentials.pid);
+
+        // Servers send the service details as soon as they can write to the connection, so they
+        // may have arrived by now.  If not, we wait for the server to send them (or disconnect),
+        // and our server fd event handler functions will be called when that happens.
+        ReceiveFromServer(connectionPtr);
     }
 }
 
@@ -1780,8 +2054,14 @@ static void BindingDestructor
 {
     Binding_t* bindingPtr = objPtr;
 
-    // Remove the Binding object from the User's Binding List.
+    // Remove the Binding object from the User's Binding List and from the Binding Map.
     le_dls_Remove(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    le_hashmap_Remove(BindingMapRef, &bindingPtr->clientKey);
+
+    // Remove it from the Binding List of the service it refers to.
+    le_dls_Remove(&bindingPtr->boundServicePtr->bindingList, &bindingPtr->boundServiceLink);
+    le_mem_Release(bindingPtr->boundServicePtr);
+    bindingPtr->boundServicePtr = NULL;
 
     // While the list of waiting clients is not empty, pop one off and process it.
     le_dls_Link_t* linkPtr;
@@ -2566,6 +2846,7 @@ COMPONENT_INIT
     ServerConnectionPoolRef = le_mem_CreatePool("Server Connection", sizeof(ServerConnection_t));
     UserPoolRef = le_mem_CreatePool("User", sizeof(User_t));
     BindingPoolRef = le_mem_CreatePool("Binding", sizeof(Binding_t));
+    BoundServicePoolRef = le_mem_CreatePool("Bound Service", sizeof(BoundService_t));
 
     /// Expand the pools to their expected maximum sizes.
     /// @todo Make this configurable.
@@ -2573,12 +2854,32 @@ COMPONENT_INIT
     le_mem_ExpandPool(ServerConnectionPoolRef, 30);
     le_mem_ExpandPool(UserPoolRef, 30);
     le_mem_ExpandPool(BindingPoolRef, 30);
+    le_mem_ExpandPool(BoundServicePoolRef, 30);
 
     // Register destructor functions.
     le_mem_SetDestructor(ClientConnectionPoolRef, ClientConnectionDestructor);
     le_mem_SetDestructor(ServerConnectionPoolRef, ServerConnectionDestructor);
     le_mem_SetDestructor(UserPoolRef, UserDestructor);
     le_mem_SetDestructor(BindingPoolRef, BindingDestructor);
+    le_mem_SetDestructor(BoundServicePoolRef, BoundServiceDestructor);
+
+    // Create the indexes.
+    UserMapRef = le_hashmap_Create("User Map",
+                                   USER_MAP_CAPACITY,
+                                   le_hashmap_HashUInt32,
+                                   le_hashmap_EqualsUInt32);
+    BindingMapRef = le_hashmap_Create("Binding Map",
+                                      BINDING_MAP_CAPACITY,
+                                      HashNameKey,
+                                      EqualsNameKey);
+    ServiceMapRef = le_hashmap_Create("Service Map",
+                                      SERVICE_MAP_CAPACITY,
+                                      HashNameKey,
+                                      EqualsNameKey);
+    BoundServiceMapRef = le_hashmap_Create("Bound Service Map",
+                                           SERVICE_MAP_CAPACITY,
+                                           HashNameKey,
+                                           EqualsNameKey);
 
     // Create built-in, hard-coded bindings.
     CreateHardCodedBindings();
@@ -2594,6 +2895,10 @@ COMPONENT_INIT
     ClientSocketFd = OpenSocket(LE_SVCDIR_CLIENT_SOCKET_NAME);
     ServerSocketFd = OpenSocket(LE_SVCDIR_SERVER_SOCKET_NAME);
 
+    // The connect handlers accept until there are no more connection requests pending.
+    fd_SetNonBlocking(ClientSocketFd);
+    fd_SetNonBlocking(ServerSocketFd);
+
     // Start listening for connection attempts.
     ClientSocketMonitorRef = le_fdMonitor_Create("Client Socket",
                                                  ClientSocketFd,
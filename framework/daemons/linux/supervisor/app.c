@@ -27,6 +27,15 @@
  * So, instead when a directory is required or bundled, all files in the directory are individually
  * linked.
  *
+ * The links to create are listed in a sandbox manifest, which is built from the config tree and
+ * the app's install directory the first time the app is started, and cached by app hash so that
+ * later starts of the same version of the app don't have to read the config or walk its
+ * directories again.
+ *
+ * Apps that are started together (e.g., the apps started automatically when the framework starts)
+ * are first prepared with app_Prepare(), then their working areas are set up in parallel by
+ * app_SetupPrepared() before app_Start() starts their processes.
+ *
  * The working area is not cleaned up by the Supervisor, rather it is left to the installer to
  * clean up.
  *
@@ -331,6 +340,62 @@ static const le_clk_Time_t KillTimeout =
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the small path strings in sandbox manifests.  Longer paths are allocated from the full
+ * size path pool.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SANDBOX_SHORT_PATH_BYTES        64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of links in a sandbox manifest.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SANDBOX_LINK_FILE,          ///< Link to a file or a device.
+    SANDBOX_LINK_DIR,           ///< Link to a directory.
+    SANDBOX_LINK_SHARED_DIR     ///< Link to a directory under /dev/shm, which everyone can access.
+}
+SandboxLinkType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A link in a sandbox manifest.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    SandboxLinkType_t type;     ///< Type of link.
+    char* srcPtr;               ///< Absolute path to the source.
+    char* destPtr;              ///< Dest path relative to the application's runtime area.
+    le_sls_Link_t link;         ///< Link in the manifest's list of links.
+}
+SandboxLink_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sandbox manifest.  The list of links that make up an app's working area, as read from the
+ * config tree and the app's install directory.
+ *
+ * Manifests are cached by app hash, so the config is only read and the bundled directories only
+ * walked once for each installed version of an app.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char            hash[LIMIT_MD5_STR_BYTES];  ///< Hash of the app, or empty if not cached.
+    le_sls_List_t   links;                      ///< List of SandboxLink_t, in creation order.
+    size_t          numLinks;                   ///< Number of links in the list.
+}
+SandboxManifest_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The application object.
@@ -355,6 +420,12 @@ typedef struct app_Ref
     le_sls_List_t   additionalLinks;    // List of additional links that are temporarily added to
                                         // the app.
     le_sls_List_t   reqModuleName;      // List of required kernel module names
+    SandboxManifest_t* manifestPtr;     // Links to create in the working directory.
+    bool            isPrepared;         // true if app_Prepare() was called since the last start.
+    bool            moduleLoadFailed;   // true if a required kernel module failed to load.
+    le_result_t     areaResult;         // Result of setting up the working area.
+    le_clk_Time_t   areaTime;           // Time it took to set up the working area.
+    le_sls_Link_t   setupLink;          // Link in the list of apps waiting for their working area.
 }
 App_t;
 
@@ -431,6 +502,35 @@ static le_mem_PoolRef_t ProcContainerPool;
 static le_mem_PoolRef_t ReqModStringPool;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The memory pools for sandbox manifests, their links and the links' paths.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SandboxManifestPool;
+static le_mem_PoolRef_t SandboxLinkPool;
+static le_mem_PoolRef_t SandboxPathPool;
+static le_mem_PoolRef_t SandboxShortPathPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cached sandbox manifests, keyed by app hash.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t SandboxManifestMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apps that were prepared with app_Prepare() and are waiting for app_SetupPrepared() to set up
+ * their working areas, and the mutex that protects the list while it is being emptied.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sls_List_t PendingSetupList = LE_SLS_LIST_INIT;
+static le_mutex_Ref_t PendingSetupMutex;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Application kill type.
@@ -1936,7 +2036,9 @@ static le_result_t CreateDirLink
     app_Ref_t appRef,                   ///< [IN] Application reference.
     const char* appDirLabelPtr,         ///< [IN] SMACK label to use for created directories.
     const char* srcPtr,                 ///< [IN] Source path.
-    const char* destPtr                 ///< [IN] Destination path.
+    const char* destPtr,                ///< [IN] Destination path.
+    bool makeDirs                       ///< [IN] false if the directories along the destination
+                                        ///       path are known to exist.
 )
 {
     // Check the source.
@@ -1964,7 +2066,7 @@ static le_result_t CreateDirLink
     }
 
     // Create the necessary intermediate directories along the destination path.
-    if (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK)
+    if (makeDirs && (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK))
     {
         goto failure;
     }
@@ -2030,7 +2132,9 @@ static le_result_t CreateFileLink
     app_Ref_t appRef,                   ///< [IN] Application reference.
     const char* appDirLabelPtr,         ///< [IN] SMACK label to use for created directories.
     const char* srcPtr,                 ///< [IN] Source path.
-    const char* destPtr                 ///< [IN] Destination path.
+    const char* destPtr,                ///< [IN] Destination path.
+    bool makeDirs                       ///< [IN] false if the directories along the destination
+                                        ///       path are known to exist.
 )
 {
     // Check the source.
@@ -2058,7 +2162,7 @@ static le_result_t CreateFileLink
     }
 
     // Create the necessary intermediate directories along the destination path.
-    if (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK)
+    if (makeDirs && (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK))
     {
         goto failure;
     }
@@ -2162,7 +2266,78 @@ failure:
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Recursively create links from all files under the source directory to corresponding files under
+ * Copies a path into a sandbox manifest.
+ *
+ * @return
+ *      The copy of the path.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* CopyManifestPath
+(
+    const char* pathPtr                 ///< [IN] Path to copy.
+)
+{
+    size_t pathSize = strlen(pathPtr) + 1;
+    char* copyPtr = le_mem_ForceVarAlloc(SandboxShortPathPool, pathSize);
+
+    memcpy(copyPtr, pathPtr, pathSize);
+
+    return copyPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a link to the end of a sandbox manifest.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddManifestLink
+(
+    SandboxManifest_t* manifestPtr,     ///< [IN] Manifest to add the link to.
+    SandboxLinkType_t type,             ///< [IN] Type of link.
+    const char* srcPtr,                 ///< [IN] Source path.
+    const char* destPtr                 ///< [IN] Destination path.
+)
+{
+    SandboxLink_t* linkPtr = le_mem_ForceAlloc(SandboxLinkPool);
+
+    linkPtr->type = type;
+    linkPtr->srcPtr = CopyManifestPath(srcPtr);
+    linkPtr->destPtr = CopyManifestPath(destPtr);
+    linkPtr->link = LE_SLS_LINK_INIT;
+
+    le_sls_Queue(&(manifestPtr->links), &(linkPtr->link));
+    manifestPtr->numLinks++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor for sandbox manifests.  Releases all of the manifest's links.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SandboxManifestDestructor
+(
+    void* objPtr                        ///< [IN] Manifest being released.
+)
+{
+    SandboxManifest_t* manifestPtr = objPtr;
+    le_sls_Link_t* linkPtr;
+
+    while ((linkPtr = le_sls_Pop(&(manifestPtr->links))) != NULL)
+    {
+        SandboxLink_t* sandboxLinkPtr = CONTAINER_OF(linkPtr, SandboxLink_t, link);
+
+        le_mem_Release(sandboxLinkPtr->srcPtr);
+        le_mem_Release(sandboxLinkPtr->destPtr);
+        le_mem_Release(sandboxLinkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Recursively add links from all files under the source directory to corresponding files under
  * the destination directory.
  *
  * @return
@@ -2170,10 +2345,10 @@ failure:
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t RecursivelyCreateLinks
+static le_result_t RecursivelyAddLinks
 (
     app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr,         ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr,     ///< [IN] Manifest to add the links to.
     const char* srcDirPtr,              ///< [IN] Source directory.
     const char* destDirPtr              ///< [IN] Destination directory.
 )
@@ -2253,12 +2428,8 @@ static le_result_t RecursivelyCreateLinks
                     return LE_FAULT;
                 }
 
-                // Create the link.
-                if (CreateFileLink(appRef, appDirLabelPtr, srcEntPtr->fts_path, destPath) != LE_OK)
-                {
-                    fts_close(ftsPtr);
-                    return LE_FAULT;
-                }
+                // Add the link.
+                AddManifestLink(manifestPtr, SANDBOX_LINK_FILE, srcEntPtr->fts_path, destPath);
             }
         }
     }
@@ -2310,7 +2481,7 @@ static le_result_t CreateDefaultTmpLinks
     {
         // Default links must work otherwise there is something very wrong.
         if (CreateFileLink(appRef, appDirLabelPtr,
-                           DefaultTmpLinks[i].src, DefaultTmpLinks[i].dest) != LE_OK)
+                           DefaultTmpLinks[i].src, DefaultTmpLinks[i].dest, true) != LE_OK)
         {
             return LE_FAULT;
         }
@@ -2322,58 +2493,42 @@ static le_result_t CreateDefaultTmpLinks
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create links to the default libs and files that all app's will likely need.
- *
- * @return
- *      LE_OK if successful.
- *      LE_FAULT if there was an error.
+ * Add links to the default libs and files that all app's will likely need.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateDefaultLinks
+static void AddDefaultLinks
 (
-    app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr      ///< [IN] Manifest to add the links to.
 )
 {
     int i = 0;
 
     for (i = 0; i < NUM_ARRAY_MEMBERS(DefaultLinks); i++)
     {
-        // Default links must work otherwise there is something very wrong.
-        if (CreateFileLink(appRef, appDirLabelPtr,
-                           DefaultLinks[i].src, DefaultLinks[i].dest) != LE_OK)
-        {
-            return LE_FAULT;
-        }
+        AddManifestLink(manifestPtr, SANDBOX_LINK_FILE, DefaultLinks[i].src, DefaultLinks[i].dest);
     }
 
     for (i = 0; i < NUM_ARRAY_MEMBERS(DefaultSystemLinks); i++)
     {
-        // Default links must work otherwise there is something very wrong.
-        if (CreateFileLink(appRef, appDirLabelPtr, DefaultSystemLinks[i].src,
-                           DefaultSystemLinks[i].dest) != LE_OK)
-        {
-            return LE_FAULT;
-        }
+        AddManifestLink(manifestPtr, SANDBOX_LINK_FILE,
+                        DefaultSystemLinks[i].src, DefaultSystemLinks[i].dest);
     }
-
-    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create links to the app's lib and bin files.
+ * Add links to the app's lib and bin files.
  *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateLibBinLinks
+static le_result_t AddLibBinLinks
 (
     app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr      ///< [IN] Manifest to add the links to.
 )
 {
     // Create links to the apps lib directory.
@@ -2386,7 +2541,7 @@ static le_result_t CreateLibBinLinks
         return LE_FAULT;
     }
 
-    if (RecursivelyCreateLinks(appRef, appDirLabelPtr, srcLib, "/lib") != LE_OK)
+    if (RecursivelyAddLinks(appRef, manifestPtr, srcLib, "/lib") != LE_OK)
     {
         return LE_FAULT;
     }
@@ -2401,7 +2556,7 @@ static le_result_t CreateLibBinLinks
         return LE_FAULT;
     }
 
-    if (RecursivelyCreateLinks(appRef, appDirLabelPtr, srcBin, "/bin") != LE_OK)
+    if (RecursivelyAddLinks(appRef, manifestPtr, srcBin, "/bin") != LE_OK)
     {
         return LE_FAULT;
     }
@@ -2539,17 +2694,17 @@ static le_result_t GetSrcPath
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create links to the app's read only bundled files.
+ * Add links to the app's read only bundled files.
  *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateBundledLinks
+static le_result_t AddBundledLinks
 (
     app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr      ///< [IN] Manifest to add the links to.
 )
 {
     // Get a config iterator for this app.
@@ -2582,8 +2737,8 @@ static le_result_t CreateBundledLinks
                     return LE_FAULT;
                 }
 
-                // Create links for all files in the source directory.
-                if (RecursivelyCreateLinks(appRef, appDirLabelPtr, srcPath, destPath) != LE_OK)
+                // Add links for all files in the source directory.
+                if (RecursivelyAddLinks(appRef, manifestPtr, srcPath, destPath) != LE_OK)
                 {
                     le_cfg_CancelTxn(appCfg);
                     return LE_FAULT;
@@ -2622,11 +2777,7 @@ static le_result_t CreateBundledLinks
                     return LE_FAULT;
                 }
 
-                if (CreateFileLink(appRef, appDirLabelPtr, srcPath, destPath) != LE_OK)
-                {
-                    le_cfg_CancelTxn(appCfg);
-                    return LE_FAULT;
-                }
+                AddManifestLink(manifestPtr, SANDBOX_LINK_FILE, srcPath, destPath);
             }
         }
         while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
@@ -2640,17 +2791,17 @@ static le_result_t CreateBundledLinks
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create links to the app's required files under the current node in the configuration iterator.
+ * Add links to the app's required files under the current node in the configuration iterator.
  *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateRequiredFileLinks
+static le_result_t AddRequiredFileLinks
 (
     app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr,         ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr,     ///< [IN] Manifest to add the links to.
     le_cfg_IteratorRef_t cfgIter        ///< [IN] Config iterator.
 )
 {
@@ -2673,10 +2824,7 @@ static le_result_t CreateRequiredFileLinks
                 return LE_FAULT;
             }
 
-            if (CreateFileLink(appRef, appDirLabelPtr, srcPath, destPath) != LE_OK)
-            {
-                return LE_FAULT;
-            }
+            AddManifestLink(manifestPtr, SANDBOX_LINK_FILE, srcPath, destPath);
         }
         while (le_cfg_GoToNextSibling(cfgIter) == LE_OK);
 
@@ -2689,17 +2837,17 @@ static le_result_t CreateRequiredFileLinks
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create links to the app's required directories, files and devices.
+ * Add links to the app's required directories, files and devices.
  *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateRequiredLinks
+static le_result_t AddRequiredLinks
 (
     app_Ref_t appRef,                   ///< [IN] Application reference.
-    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+    SandboxManifest_t* manifestPtr      ///< [IN] Manifest to add the links to.
 )
 {
     // Get a config iterator for this app.
@@ -2735,21 +2883,11 @@ static le_result_t CreateRequiredLinks
             if (le_path_IsEquivalent("/dev/shm", srcPath, "/") ||
                      le_path_IsSubpath("/dev/shm", srcPath, "/"))
             {
-                if ((CreateDirLink(appRef, appDirLabelPtr, srcPath, destPath) != LE_OK) ||
-                    (smack_SetLabel(srcPath, "*") != LE_OK))
-                {
-                    le_cfg_CancelTxn(appCfg);
-                    return LE_FAULT;
-                }
-
+                AddManifestLink(manifestPtr, SANDBOX_LINK_SHARED_DIR, srcPath, destPath);
             }
             else
             {
-                if (CreateDirLink(appRef, appDirLabelPtr, srcPath, destPath) != LE_OK)
-                {
-                    le_cfg_CancelTxn(appCfg);
-                    return LE_FAULT;
-                }
+                AddManifestLink(manifestPtr, SANDBOX_LINK_DIR, srcPath, destPath);
             }
         }
         while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
@@ -2761,7 +2899,7 @@ static le_result_t CreateRequiredLinks
     le_cfg_GoToParent(appCfg);
     le_cfg_GoToNode(appCfg, CFG_NODE_FILES);
 
-    if (CreateRequiredFileLinks(appRef, appDirLabelPtr, appCfg) != LE_OK)
+    if (AddRequiredFileLinks(appRef, manifestPtr, appCfg) != LE_OK)
     {
         le_cfg_CancelTxn(appCfg);
         return LE_FAULT;
@@ -2771,7 +2909,7 @@ static le_result_t CreateRequiredLinks
     le_cfg_GoToParent(appCfg);
     le_cfg_GoToNode(appCfg, CFG_NODE_DEVICES);
 
-    if (CreateRequiredFileLinks(appRef, appDirLabelPtr, appCfg) != LE_OK)
+    if (AddRequiredFileLinks(appRef, manifestPtr, appCfg) != LE_OK)
     {
         le_cfg_CancelTxn(appCfg);
         return LE_FAULT;
@@ -2782,11 +2920,273 @@ static le_result_t CreateRequiredLinks
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the hash of the installed version of an app, from the name of the directory that its
+ * install directory links to.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the hash could not be found (bufPtr is then set to an empty string).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetInstalledHash
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    char* bufPtr,                       ///< [OUT] Buffer to store the hash.
+    size_t bufSize                      ///< [IN] Size of the buffer.
+)
+{
+    char targetPath[LIMIT_MAX_PATH_BYTES];
+    ssize_t len = readlink(appRef->installDirPath, targetPath, sizeof(targetPath) - 1);
+
+    bufPtr[0] = '\0';
+
+    if (len < 0)
+    {
+        LE_DEBUG("Could not read link '%s'.  %m.", appRef->installDirPath);
+        return LE_NOT_FOUND;
+    }
+
+    targetPath[len] = '\0';
+
+    if (le_utf8_Copy(bufPtr, le_path_GetBasenamePtr(targetPath, "/"), bufSize, NULL) != LE_OK)
+    {
+        bufPtr[0] = '\0';
+        return LE_NOT_FOUND;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the sandbox manifest for an app from its configuration and install directory.
+ *
+ * @return
+ *      The new manifest if successful.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static SandboxManifest_t* BuildManifest
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    SandboxManifest_t* manifestPtr = le_mem_ForceAlloc(SandboxManifestPool);
+
+    manifestPtr->hash[0] = '\0';
+    manifestPtr->links = LE_SLS_LIST_INIT;
+    manifestPtr->numLinks = 0;
+
+    // Default links for sandboxed apps first, then links to the app's lib and bin directories,
+    // bundled files and required files.
+    if (appRef->sandboxed)
+    {
+        AddDefaultLinks(manifestPtr);
+    }
+
+    if ( (AddLibBinLinks(appRef, manifestPtr) != LE_OK) ||
+         (AddBundledLinks(appRef, manifestPtr) != LE_OK) ||
+         (AddRequiredLinks(appRef, manifestPtr) != LE_OK) )
+    {
+        le_mem_Release(manifestPtr);
+        return NULL;
+    }
+
+    return manifestPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases an app's sandbox manifest.  The cached copy of the manifest is also dropped if this
+ * version of the app is no longer installed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseManifest
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    SandboxManifest_t* manifestPtr = appRef->manifestPtr;
+
+    if (manifestPtr == NULL)
+    {
+        return;
+    }
+
+    appRef->manifestPtr = NULL;
+
+    char hash[LIMIT_MD5_STR_BYTES];
+    GetInstalledHash(appRef, hash, sizeof(hash));
+
+    if ( (manifestPtr->hash[0] != '\0') &&
+         (strcmp(manifestPtr->hash, hash) != 0) &&
+         (le_hashmap_Remove(SandboxManifestMap, manifestPtr->hash) != NULL) )
+    {
+        le_mem_Release(manifestPtr);
+    }
+
+    le_mem_Release(manifestPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the sandbox manifest for the installed version of an app, from the cache if it was already
+ * built.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetManifest
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    char hash[LIMIT_MD5_STR_BYTES];
+    GetInstalledHash(appRef, hash, sizeof(hash));
+
+    if (appRef->manifestPtr != NULL)
+    {
+        if ( (hash[0] != '\0') && (strcmp(appRef->manifestPtr->hash, hash) == 0) )
+        {
+            return LE_OK;
+        }
+
+        ReleaseManifest(appRef);
+    }
+
+    SandboxManifest_t* manifestPtr = NULL;
+
+    if (hash[0] != '\0')
+    {
+        manifestPtr = le_hashmap_Get(SandboxManifestMap, hash);
+    }
+
+    if (manifestPtr != NULL)
+    {
+        le_mem_AddRef(manifestPtr);
+    }
+    else
+    {
+        manifestPtr = BuildManifest(appRef);
+
+        if (manifestPtr == NULL)
+        {
+            return LE_FAULT;
+        }
+
+        // An app whose hash can't be found gets a new manifest every time it starts.
+        if (hash[0] != '\0')
+        {
+            LE_ASSERT(le_utf8_Copy(manifestPtr->hash, hash, sizeof(manifestPtr->hash), NULL)
+                      == LE_OK);
+
+            le_mem_AddRef(manifestPtr);
+            le_hashmap_Put(SandboxManifestMap, manifestPtr->hash, manifestPtr);
+        }
+
+        LE_DEBUG("Built sandbox manifest for app '%s' with %" PRIuS " links.",
+                 appRef->name,
+                 manifestPtr->numLinks);
+    }
+
+    appRef->manifestPtr = manifestPtr;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates the links in an app's sandbox manifest.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyManifest
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+)
+{
+    // Links in the same directory are usually listed one after the other, so the directories
+    // along a link's destination path are only created when they differ from the previous link's.
+    char lastDir[LIMIT_MAX_PATH_BYTES] = "";
+
+    le_sls_Link_t* linkPtr = le_sls_Peek(&(appRef->manifestPtr->links));
+
+    while (linkPtr != NULL)
+    {
+        SandboxLink_t* sandboxLinkPtr = CONTAINER_OF(linkPtr, SandboxLink_t, link);
+
+        char destPath[LIMIT_MAX_PATH_BYTES] = "";
+        char destDir[LIMIT_MAX_PATH_BYTES] = "";
+
+        if ( (GetAbsDestPath(sandboxLinkPtr->destPtr, sandboxLinkPtr->srcPtr, appRef->workingDir,
+                             destPath, sizeof(destPath)) != LE_OK) ||
+             (le_path_GetDir(destPath, "/", destDir, sizeof(destDir)) != LE_OK) )
+        {
+            LE_ERROR("Link destination path '%s' is too long.", destPath);
+            LE_ERROR("Failed to create link at '%s' in app '%s'.",
+                     sandboxLinkPtr->destPtr,
+                     appRef->name);
+            return LE_FAULT;
+        }
+
+        bool makeDirs = (strcmp(destDir, lastDir) != 0);
+        le_result_t result;
+
+        if (sandboxLinkPtr->type == SANDBOX_LINK_FILE)
+        {
+            result = CreateFileLink(appRef, appDirLabelPtr,
+                                    sandboxLinkPtr->srcPtr, sandboxLinkPtr->destPtr, makeDirs);
+        }
+        else
+        {
+            result = CreateDirLink(appRef, appDirLabelPtr,
+                                   sandboxLinkPtr->srcPtr, sandboxLinkPtr->destPtr, makeDirs);
+
+            // Treat /dev/shm differently.  These are shared memory expected to be shared between
+            // other apps but also other userland processes.  So export the entire directory.
+            if ( (result == LE_OK) && (sandboxLinkPtr->type == SANDBOX_LINK_SHARED_DIR) )
+            {
+                result = smack_SetLabel(sandboxLinkPtr->srcPtr, "*");
+            }
+        }
+
+        if (result != LE_OK)
+        {
+            return LE_FAULT;
+        }
+
+        if (makeDirs)
+        {
+            LE_ASSERT(le_utf8_Copy(lastDir, destDir, sizeof(lastDir), NULL) == LE_OK);
+        }
+
+        linkPtr = le_sls_PeekNext(&(appRef->manifestPtr->links), linkPtr);
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets up the application execution area in the file system.  For a sandboxed app this will be the
  * sandbox.  For an unsandboxed app this will be the app's current working directory..
  *
+ * The app's sandbox manifest must have been fetched with GetManifest().  This does not read the
+ * config tree, so it can be called from any thread.
+ *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
@@ -2821,33 +3221,51 @@ static le_result_t SetupAppArea
                 return LE_FAULT;
             }
         }
-
-        // Create default links.
-        if (CreateDefaultLinks(appRef, appDirLabel) != LE_OK)
-        {
-            return LE_FAULT;
-        }
     }
 
-    // Create links to the app's lib and bin directories.
-    if (CreateLibBinLinks(appRef, appDirLabel) != LE_OK)
-    {
-        return LE_FAULT;
-    }
+    // Create the default links, links to the app's lib and bin directories, links to bundled
+    // files and links to required files.
+    return ApplyManifest(appRef, appDirLabel);
+}
 
-    // Create links to bundled files.
-    if (CreateBundledLinks(appRef, appDirLabel) != LE_OK)
-    {
-        return LE_FAULT;
-    }
 
-    // Create links to required files.
-    if (CreateRequiredLinks(appRef, appDirLabel) != LE_OK)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets up the application's working area, including /tmp for sandboxed apps, and records how long
+ * it took.  Can be called from any thread.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SetupWorkingArea
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    le_result_t result = SetupAppArea(appRef);
+
+    // Create /tmp for sandboxed apps and link in /tmp files.
+    if ( (result == LE_OK) && appRef->sandboxed )
     {
-        return LE_FAULT;
+        // Get the SMACK label for the folders we create.
+        char appDirLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
+        smack_GetAppAccessLabel(app_GetName(appRef), S_IRWXU, appDirLabel, sizeof(appDirLabel));
+
+        // Create the app's /tmp for sandboxed apps, then the default links.
+        if ( (CreateTmpFs(appRef, appDirLabel) != LE_OK) ||
+             (CreateDefaultTmpLinks(appRef, appDirLabel) != LE_OK) )
+        {
+            result = LE_FAULT;
+        }
     }
 
-    return LE_OK;
+    appRef->areaTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return result;
 }
 
 
@@ -2979,6 +3397,92 @@ static le_result_t GetKernelModules(app_Ref_t appRef)
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Does the parts of starting an app that have to be done in the Supervisor's main thread before
+ * its working area can be set up: loading its kernel modules, setting its SMACK rules and getting
+ * its sandbox manifest.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PrepareApp
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    // Install the required kernel modules
+    appRef->moduleLoadFailed = false;
+
+    if (GetKernelModules(appRef) != LE_OK)
+    {
+        LE_ERROR("Error in installing dependent kernel modules for app '%s'", appRef->name);
+        appRef->moduleLoadFailed = true;
+    }
+
+    // Set SMACK rules for this app.
+    // Get the links to create in the app's working area.
+    if ( (SetSmackRules(appRef) != LE_OK) ||
+         (GetManifest(appRef) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets up the working areas of apps on the list of apps waiting for them, until the list is empty.
+ * Runs in app_SetupPrepared()'s worker threads as well as in the main thread.
+ *
+ * @return
+ *      NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* SetupPendingAreas
+(
+    void* contextPtr                    ///< [IN] Not used.
+)
+{
+    for (;;)
+    {
+        le_mutex_Lock(PendingSetupMutex);
+        le_sls_Link_t* linkPtr = le_sls_Pop(&PendingSetupList);
+        le_mutex_Unlock(PendingSetupMutex);
+
+        if (linkPtr == NULL)
+        {
+            return NULL;
+        }
+
+        App_t* appPtr = CONTAINER_OF(linkPtr, App_t, setupLink);
+
+        appPtr->areaResult = SetupWorkingArea(appPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a time to milliseconds, for logging durations.
+ *
+ * @return
+ *      The time in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int TimeToMs
+(
+    le_clk_Time_t time                  ///< [IN] Time to convert.
+)
+{
+    return (unsigned int)(time.sec * 1000 + time.usec / 1000);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Checks if the path refers to a directory.
@@ -3095,6 +3599,18 @@ void app_Init
     ProcContainerPool = le_mem_CreatePool("ProcContainers", sizeof(ProcContainer_t));
     ReqModStringPool = le_mem_CreatePool("Required Modules", sizeof(ModNameNode_t));
 
+    SandboxManifestPool = le_mem_CreatePool("SandboxManifests", sizeof(SandboxManifest_t));
+    le_mem_SetDestructor(SandboxManifestPool, SandboxManifestDestructor);
+    SandboxLinkPool = le_mem_CreatePool("SandboxLinks", sizeof(SandboxLink_t));
+    SandboxPathPool = le_mem_CreatePool("SandboxPaths", LIMIT_MAX_PATH_BYTES);
+    SandboxShortPathPool = le_mem_CreateReducedPool(SandboxPathPool, "SandboxShortPaths",
+                                                    0, SANDBOX_SHORT_PATH_BYTES);
+    SandboxManifestMap = le_hashmap_Create("SandboxManifests",
+                                           31,
+                                           le_hashmap_HashString,
+                                           le_hashmap_EqualsString);
+    PendingSetupMutex = le_mutex_CreateNonRecursive("PendingSetup");
+
     proc_Init();
 
     // Create the appsWriteable area.
@@ -3252,6 +3768,12 @@ app_Ref_t app_Create
     appPtr->additionalLinks = LE_SLS_LIST_INIT;
     appPtr->state = APP_STATE_STOPPED;
     appPtr->killTimer = NULL;
+    appPtr->manifestPtr = NULL;
+    appPtr->isPrepared = false;
+    appPtr->moduleLoadFailed = false;
+    appPtr->areaResult = LE_OK;
+    appPtr->areaTime = (le_clk_Time_t){0, 0};
+    appPtr->setupLink = LE_SLS_LINK_INIT;
 
     LE_INFO("Creating app '%s'", appPtr->name);
 
@@ -3447,11 +3969,106 @@ void app_Delete
         le_timer_Delete(appRef->killTimer);
     }
 
+    ReleaseManifest(appRef);
+
     // Release app.
     le_mem_Release(appRef);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prepares an application to be started: loads its kernel modules, sets its SMACK rules, gets its
+ * sandbox manifest, and queues it to have its working area set up by app_SetupPrepared().  The
+ * next app_Start() will then only start the app's processes.
+ *
+ * This is used to set up the working areas of several apps at the same time.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.  app_Start() will then fail.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t app_Prepare
+(
+    app_Ref_t appRef                    ///< [IN] Reference to the application to prepare.
+)
+{
+    if (appRef->isPrepared)
+    {
+        return appRef->areaResult;
+    }
+
+    if ( (appRef->state == APP_STATE_RUNNING) || framework_IsStopping() )
+    {
+        return LE_FAULT;
+    }
+
+    appRef->areaResult = PrepareApp(appRef);
+    appRef->isPrepared = true;
+
+    if (appRef->areaResult == LE_OK)
+    {
+        le_sls_Queue(&PendingSetupList, &(appRef->setupLink));
+    }
+
+    return appRef->areaResult;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets up the working areas of all the apps prepared with app_Prepare(), using up to
+ * LE_CONFIG_SUPERV_SANDBOX_THREADS threads.  Returns when they are all set up.
+ */
+//--------------------------------------------------------------------------------------------------
+void app_SetupPrepared
+(
+    void
+)
+{
+    size_t numApps = le_sls_NumLinks(&PendingSetupList);
+
+    if (numApps == 0)
+    {
+        return;
+    }
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+#if LE_CONFIG_SUPERV_SANDBOX_THREADS > 1
+    // This thread sets up working areas too, so only start the other threads that are needed.
+    le_thread_Ref_t threads[LE_CONFIG_SUPERV_SANDBOX_THREADS - 1];
+    size_t numThreads = 0;
+
+    while ( (numThreads < NUM_ARRAY_MEMBERS(threads)) && (numThreads + 1 < numApps) )
+    {
+        char threadName[LIMIT_MAX_THREAD_NAME_BYTES];
+        snprintf(threadName, sizeof(threadName), "SandboxSetup%" PRIuS, numThreads);
+
+        threads[numThreads] = le_thread_Create(threadName, SetupPendingAreas, NULL);
+        le_thread_SetJoinable(threads[numThreads]);
+        le_thread_Start(threads[numThreads]);
+        numThreads++;
+    }
+#endif
+
+    SetupPendingAreas(NULL);
+
+#if LE_CONFIG_SUPERV_SANDBOX_THREADS > 1
+    size_t i;
+    for (i = 0; i < numThreads; i++)
+    {
+        le_thread_Join(threads[i], NULL);
+    }
+#endif
+
+    LE_INFO("Set up working areas for %" PRIuS " apps in %u ms.",
+            numApps,
+            TimeToMs(le_clk_Sub(le_clk_GetRelativeTime(), startTime)));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts an application.
@@ -3468,8 +4085,6 @@ le_result_t app_Start
 {
     LE_INFO("Starting app '%s'", appRef->name);
 
-    bool moduleLoadFailed = false;
-
     if (appRef->state == APP_STATE_RUNNING)
     {
         LE_ERROR("Application '%s' is already running.", appRef->name);
@@ -3484,43 +4099,28 @@ le_result_t app_Start
         return LE_FAULT;
     }
 
-    // Install the required kernel modules
-    if (GetKernelModules(appRef) != LE_OK)
+    // Load the kernel modules, set the SMACK rules and set up the runtime area in the file system,
+    // unless app_Prepare() and app_SetupPrepared() already did.
+    if (!appRef->isPrepared)
     {
-        LE_ERROR("Error in installing dependent kernel modules for app '%s'", appRef->name);
-        moduleLoadFailed = true;
+        appRef->areaResult = PrepareApp(appRef);
+
+        if (appRef->areaResult == LE_OK)
+        {
+            appRef->areaResult = SetupWorkingArea(appRef);
+        }
     }
 
+    appRef->isPrepared = false;
     appRef->state = APP_STATE_RUNNING;
 
-    // Set SMACK rules for this app.
-    // Setup the runtime area in the file system.
-    if ( (SetSmackRules(appRef) != LE_OK) ||
-         (SetupAppArea(appRef) != LE_OK) )
+    if (appRef->areaResult != LE_OK)
     {
         LE_ERROR("Failed to set Smack rules or set up app area.");
         return LE_FAULT;
     }
 
-    // Create /tmp for sandboxed apps and link in /tmp files.
-    if (appRef->sandboxed)
-    {
-        // Get the SMACK label for the folders we create.
-        char appDirLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
-        smack_GetAppAccessLabel(app_GetName(appRef), S_IRWXU, appDirLabel, sizeof(appDirLabel));
-
-        // Create the app's /tmp for sandboxed apps.
-        if (CreateTmpFs(appRef, appDirLabel) != LE_OK)
-        {
-            return LE_FAULT;
-        }
-
-        // Create default links.
-        if (CreateDefaultTmpLinks(appRef, appDirLabel) != LE_OK)
-        {
-            return LE_FAULT;
-        }
-    }
+    le_clk_Time_t launchStartTime = le_clk_GetRelativeTime();
 
     // Start all the processes in the application.
     le_dls_Link_t* procLinkPtr = le_dls_Peek(&(appRef->procs));
@@ -3529,7 +4129,7 @@ le_result_t app_Start
     {
         ProcContainer_t* procContainerPtr = CONTAINER_OF(procLinkPtr, ProcContainer_t, link);
 
-        if (moduleLoadFailed)
+        if (appRef->moduleLoadFailed)
         {
             // If a module failed to load then trigger fault action of the process.
             switch (proc_GetFaultAction(procContainerPtr->procRef))
@@ -3575,6 +4175,11 @@ le_result_t app_Start
         procLinkPtr = le_dls_PeekNext(&(appRef->procs), procLinkPtr);
     }
 
+    LE_INFO("App '%s' started: working area set up in %u ms, processes started in %u ms.",
+            appRef->name,
+            TimeToMs(appRef->areaTime),
+            TimeToMs(le_clk_Sub(le_clk_GetRelativeTime(), launchStartTime)));
+
     return LE_OK;
 }
 
@@ -4545,11 +5150,11 @@ le_result_t app_AddLink
 
     if (isDir)
     {
-        result = CreateDirLink(appRef, appDirLabel, destPathPtr, destPathPtr);
+        result = CreateDirLink(appRef, appDirLabel, destPathPtr, destPathPtr, true);
     }
     else
     {
-        result = CreateFileLink(appRef, appDirLabel, pathPtr, destPathPtr);
+        result = CreateFileLink(appRef, appDirLabel, pathPtr, destPathPtr, true);
     }
 
     // Store a record of the new link.
@@ -156,6 +156,37 @@ void app_Delete
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prepares an application to be started: loads its kernel modules, sets its SMACK rules, gets its
+ * sandbox manifest, and queues it to have its working area set up by app_SetupPrepared().  The
+ * next app_Start() will then only start the app's processes.
+ *
+ * This is used to set up the working areas of several apps at the same time.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.  app_Start() will then fail.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t app_Prepare
+(
+    app_Ref_t appRef                    ///< [IN] Reference to the application to prepare.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets up the working areas of all the apps prepared with app_Prepare(), using up to
+ * LE_CONFIG_SUPERV_SANDBOX_THREADS threads.  Returns when they are all set up.
+ */
+//--------------------------------------------------------------------------------------------------
+void app_SetupPrepared
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts an application.
@@ -12,7 +12,8 @@
  * Apps run in containers. The container for an app is created either when someone calls
  * le_appCtrl_GetRef() or when the app is started, whichever comes first.
  * An app can be started by either an le_appCtrl_Start() IPC call or automatically on start-up
- * using the apps_AutoStart() API.
+ * using the apps_AutoStart() API.  apps_AutoStart() prepares all the apps before starting any of
+ * them, so that their working areas can be set up in parallel (see app_SetupPrepared()).
  *
  * When an app's container is created, a new app container object is created which contains a
  * list link, an app stop handler reference and the app object (which is also instantiated).  After
@@ -1375,6 +1376,9 @@ void apps_AutoStart
     void
 )
 {
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    size_t numApps = 0;
+
     // Read the list of applications from the config tree.
     le_cfg_IteratorRef_t appCfg = le_cfg_CreateReadTxn(CFG_NODE_APPS_LIST);
 
@@ -1387,6 +1391,7 @@ void apps_AutoStart
         return;
     }
 
+    // Prepare all the applications first, so that their working areas can be set up together.
     do
     {
         // Check the start mode for this application.
@@ -1403,15 +1408,53 @@ void apps_AutoStart
             }
             else
             {
-                // Launch the application now.  No need to check the return code because there is
-                // nothing we can do about errors.
-                LaunchApp(appName);
+                // Create the app container and prepare the app.  No need to check the return
+                // code of app_Prepare() because app_Start() will fail and report the error.
+                AppContainer_t* appContainerPtr;
+
+                if ( (CreateApp(appName, &appContainerPtr) == LE_OK) &&
+                     !appContainerPtr->isActive )
+                {
+                    app_Prepare(appContainerPtr->appRef);
+                    numApps++;
+                }
+            }
+        }
+    }
+    while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
+
+    app_SetupPrepared();
+
+    // Then launch the applications that were prepared.
+    le_cfg_GoToParent(appCfg);
+    LE_ASSERT(le_cfg_GoToFirstChild(appCfg) == LE_OK);
+
+    do
+    {
+        char appName[LIMIT_MAX_APP_NAME_BYTES];
+
+        if ( !le_cfg_GetBool(appCfg, CFG_NODE_START_MANUAL, false) &&
+             (le_cfg_GetNodeName(appCfg, "", appName, sizeof(appName)) == LE_OK) )
+        {
+            AppContainer_t* appContainerPtr = GetInactiveApp(appName);
+
+            // Launch the application now.  No need to check the return code because there is
+            // nothing we can do about errors.
+            if (appContainerPtr != NULL)
+            {
+                StartApp(appContainerPtr);
             }
         }
     }
     while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
 
     le_cfg_CancelTxn(appCfg);
+
+    le_clk_Time_t totalTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("Auto-started %" PRIuS " apps in %u ms.",
+            numApps,
+            (unsigned int)(totalTime.sec * 1000 + totalTime.usec / 1000));
 }
 
 
@@ -0,0 +1,701 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgSubtree.c
+ *
+ * Reads a section of the config tree in one go.  See le_cfg.api for the format of the nodes.  They
+ * are checked once when they are read, so the lookups don't need to check for bad data.
+ *
+ * A section too big for le_cfg_QuickGetSubtree() is read node by node in a read transaction, like
+ * the Supervisor used to read process configs, and written out in the same format to a heap block.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "cfgSubtree.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a node of a given type has a value after its name.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool HasValue
+(
+    uint8_t type                    ///< [IN] The node type.
+)
+{
+    return (type != LE_CFG_TYPE_STEM) && (type != LE_CFG_TYPE_EMPTY);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skips over a NUL-terminated string in data that hasn't been checked yet.
+ *
+ * @return
+ *      true if the string is terminated within the data.
+ *      false if it isn't.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckAndSkipString
+(
+    const uint8_t* dataPtr,         ///< [IN] The data.
+    size_t size,                    ///< [IN] Number of bytes of data.
+    size_t* posPtr                  ///< [IN/OUT] Position of the string, then of what follows it.
+)
+{
+    if (*posPtr >= size)
+    {
+        return false;
+    }
+
+    const uint8_t* endPtr = memchr(dataPtr + *posPtr, '\0', size - *posPtr);
+
+    if (endPtr == NULL)
+    {
+        return false;
+    }
+
+    *posPtr = endPtr - dataPtr + 1;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that data read from the config tree is one complete, well-formed node.
+ *
+ * @return
+ *      true if the data is well-formed.
+ *      false if it isn't.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsWellFormed
+(
+    const uint8_t* dataPtr,         ///< [IN] The data.
+    size_t size                     ///< [IN] Number of bytes of data.
+)
+{
+    size_t pos = 0;
+    size_t depth = 0;
+
+    do
+    {
+        if (pos >= size)
+        {
+            return false;
+        }
+
+        uint8_t type = dataPtr[pos++];
+
+        if (type > LE_CFG_TYPE_STEM)
+        {
+            return false;
+        }
+
+        if (!CheckAndSkipString(dataPtr, size, &pos))
+        {
+            return false;
+        }
+
+        if (type == LE_CFG_TYPE_STEM)
+        {
+            depth++;
+        }
+        else if (HasValue(type) && !CheckAndSkipString(dataPtr, size, &pos))
+        {
+            return false;
+        }
+
+        while ((depth > 0) && (pos < size) && (dataPtr[pos] == LE_CFG_SUBTREE_END))
+        {
+            pos++;
+            depth--;
+        }
+    }
+    while (depth > 0);
+
+    return (pos == size);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the name of a node.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline const char* NodeName
+(
+    const uint8_t* nodePtr          ///< [IN] The node.
+)
+{
+    return (const char*)(nodePtr + 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skips over a node's type, name and value.
+ *
+ * @return
+ *      Pointer to what follows: the node's first child if it's a stem, or else its next sibling
+ *      or the end of its parent's children.
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint8_t* SkipNodeHeader
+(
+    const uint8_t* nodePtr          ///< [IN] The node.
+)
+{
+    const char* namePtr = NodeName(nodePtr);
+    const char* nextPtr = namePtr + strlen(namePtr) + 1;
+
+    if (HasValue(*nodePtr))
+    {
+        nextPtr += strlen(nextPtr) + 1;
+    }
+
+    return (const uint8_t*)nextPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skips over a node and all of the nodes under it.
+ *
+ * @return
+ *      Pointer to the node's next sibling, or to the end of its parent's children.
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint8_t* SkipNode
+(
+    const uint8_t* nodePtr          ///< [IN] The node.
+)
+{
+    size_t depth = 0;
+
+    do
+    {
+        if (*nodePtr == LE_CFG_TYPE_STEM)
+        {
+            depth++;
+        }
+
+        nodePtr = SkipNodeHeader(nodePtr);
+
+        while ((depth > 0) && (*nodePtr == LE_CFG_SUBTREE_END))
+        {
+            nodePtr++;
+            depth--;
+        }
+    }
+    while (depth > 0);
+
+    return nodePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Nodes being read one at a time by ReadNodeByNode().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t* dataPtr;               ///< Heap block the nodes are written to.
+    size_t size;                    ///< Number of bytes of nodes written so far.
+    size_t capacity;                ///< Size of the heap block.
+}
+NodeBuffer_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes sure there is room for a number of bytes after the nodes written so far.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReserveBytes
+(
+    NodeBuffer_t* bufferPtr,        ///< [IN/OUT] The nodes.
+    size_t numBytes                 ///< [IN] Number of bytes needed.
+)
+{
+    size_t capacity = bufferPtr->capacity;
+
+    while (capacity - bufferPtr->size < numBytes)
+    {
+        capacity *= 2;
+    }
+
+    if (capacity != bufferPtr->capacity)
+    {
+        bufferPtr->dataPtr = realloc(bufferPtr->dataPtr, capacity);
+        LE_ASSERT(bufferPtr->dataPtr != NULL);
+        bufferPtr->capacity = capacity;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Appends the node an iterator is on, and all of the nodes under it, to the nodes read so far.
+ * The iterator is back on the node when this returns.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if a name or value is too long to be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendNode
+(
+    le_cfg_IteratorRef_t iterRef,   ///< [IN] Iterator on the node.
+    NodeBuffer_t* bufferPtr         ///< [IN/OUT] The nodes.
+)
+{
+    le_cfg_nodeType_t type = le_cfg_GetNodeType(iterRef, "");
+
+    // The type, then the name.
+    ReserveBytes(bufferPtr, 1 + LE_CFG_NAME_LEN_BYTES);
+    bufferPtr->dataPtr[bufferPtr->size++] = (uint8_t)type;
+
+    char* namePtr = (char*)&bufferPtr->dataPtr[bufferPtr->size];
+
+    if (le_cfg_GetNodeName(iterRef, "", namePtr, LE_CFG_NAME_LEN_BYTES) != LE_OK)
+    {
+        return LE_OVERFLOW;
+    }
+
+    bufferPtr->size += strlen(namePtr) + 1;
+
+    if (HasValue(type))
+    {
+        ReserveBytes(bufferPtr, LE_CFG_STR_LEN_BYTES);
+
+        char* valuePtr = (char*)&bufferPtr->dataPtr[bufferPtr->size];
+
+        if (le_cfg_GetString(iterRef, "", valuePtr, LE_CFG_STR_LEN_BYTES, "") != LE_OK)
+        {
+            return LE_OVERFLOW;
+        }
+
+        bufferPtr->size += strlen(valuePtr) + 1;
+    }
+    else if (type == LE_CFG_TYPE_STEM)
+    {
+        if (le_cfg_GoToFirstChild(iterRef) == LE_OK)
+        {
+            le_result_t result;
+
+            do
+            {
+                result = AppendNode(iterRef, bufferPtr);
+            }
+            while ((result == LE_OK) && (le_cfg_GoToNextSibling(iterRef) == LE_OK));
+
+            le_cfg_GoToParent(iterRef);
+
+            if (result != LE_OK)
+            {
+                return result;
+            }
+        }
+
+        ReserveBytes(bufferPtr, 1);
+        bufferPtr->dataPtr[bufferPtr->size++] = LE_CFG_SUBTREE_END;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a node, and all of the nodes under it, one at a time in a read transaction.  Used when
+ * they don't fit in one le_cfg_QuickGetSubtree() call.  The subtree must have no nodes.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the node doesn't exist.
+ *      LE_OVERFLOW if a name or value is too long to be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadNodeByNode
+(
+    cfgSubtree_t* treePtr,          ///< [IN/OUT] The subtree.
+    const char* pathPtr             ///< [IN] Path of the node in the config tree.
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(pathPtr);
+
+    if (!le_cfg_NodeExists(iterRef, ""))
+    {
+        le_cfg_CancelTxn(iterRef);
+        return LE_NOT_FOUND;
+    }
+
+    NodeBuffer_t buffer = { .dataPtr = NULL, .size = 0, .capacity = 2 * sizeof(treePtr->buffer) };
+
+    buffer.dataPtr = malloc(buffer.capacity);
+    LE_ASSERT(buffer.dataPtr != NULL);
+
+    le_result_t result = AppendNode(iterRef, &buffer);
+
+    le_cfg_CancelTxn(iterRef);
+
+    if (result != LE_OK)
+    {
+        free(buffer.dataPtr);
+        return result;
+    }
+
+    // Leave room for the extra LE_CFG_SUBTREE_END.
+    ReserveBytes(&buffer, 1);
+
+    treePtr->dataPtr = buffer.dataPtr;
+    treePtr->size = buffer.size;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes a subtree with no nodes.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgSubtree_Init
+(
+    cfgSubtree_t* treePtr           ///< [OUT] The subtree.
+)
+{
+    treePtr->dataPtr = treePtr->buffer;
+    treePtr->size = 0;
+    treePtr->dataPtr[0] = LE_CFG_SUBTREE_END;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the nodes of a subtree, leaving it with no nodes.  Must be called once a subtree that
+ * was read is no longer needed.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgSubtree_Release
+(
+    cfgSubtree_t* treePtr           ///< [IN/OUT] The subtree.
+)
+{
+    if (treePtr->dataPtr != treePtr->buffer)
+    {
+        free(treePtr->dataPtr);
+    }
+
+    cfgSubtree_Init(treePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a node, and all of the nodes under it, from the config tree, replacing the nodes the
+ * subtree had.  If this fails, the subtree is left with no nodes.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the node doesn't exist.
+ *      LE_OVERFLOW if a value is too long to be read from the config tree.
+ *      LE_FORMAT_ERROR if the config tree sent something that can't be decoded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgSubtree_Read
+(
+    cfgSubtree_t* treePtr,          ///< [IN/OUT] The subtree, initialized with cfgSubtree_Init().
+    const char* pathPtr             ///< [IN] Path of the node in the config tree.
+)
+{
+    size_t size = LE_CFG_BINARY_LEN;
+
+    cfgSubtree_Release(treePtr);
+
+    le_result_t result = le_cfg_QuickGetSubtree(pathPtr, treePtr->buffer, &size);
+
+    if ((result == LE_OK) && !IsWellFormed(treePtr->buffer, size))
+    {
+        LE_ERROR("Config tree sent malformed nodes for '%s'.", pathPtr);
+        result = LE_FORMAT_ERROR;
+    }
+    else if (result == LE_OVERFLOW)
+    {
+        LE_DEBUG("Config of '%s' is too big to read in one go, reading it node by node.", pathPtr);
+
+        result = ReadNodeByNode(treePtr, pathPtr);
+        size = treePtr->size;
+    }
+
+    if (result != LE_OK)
+    {
+        cfgSubtree_Init(treePtr);
+        return result;
+    }
+
+    // Terminate the nodes so that the top node has a "last sibling" like any other.
+    treePtr->size = size;
+    treePtr->dataPtr[size] = LE_CFG_SUBTREE_END;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the node that was read, at the top of the subtree.
+ *
+ * @return
+ *      The node, or NULL if the subtree has no nodes.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetRoot
+(
+    const cfgSubtree_t* treePtr     ///< [IN] The subtree.
+)
+{
+    if (treePtr->size == 0)
+    {
+        return NULL;
+    }
+
+    return (cfgSubtree_NodeRef_t)treePtr->dataPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a node under another one.
+ *
+ * @return
+ *      The node, or NULL if it doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetNode
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr             ///< [IN] Path from that node, "" for the node itself.
+)
+{
+    const char* segmentPtr = pathPtr;
+
+    while ((nodeRef != NULL) && (*segmentPtr != '\0'))
+    {
+        size_t segmentLen = strcspn(segmentPtr, "/");
+
+        if (segmentLen > 0)
+        {
+            cfgSubtree_NodeRef_t childRef = cfgSubtree_GetFirstChild(nodeRef);
+
+            while (childRef != NULL)
+            {
+                const char* namePtr = cfgSubtree_GetNodeName(childRef);
+
+                if ((strncmp(namePtr, segmentPtr, segmentLen) == 0) &&
+                    (namePtr[segmentLen] == '\0'))
+                {
+                    break;
+                }
+
+                childRef = cfgSubtree_GetNextSibling(childRef);
+            }
+
+            nodeRef = childRef;
+        }
+
+        segmentPtr += segmentLen;
+
+        if (*segmentPtr == '/')
+        {
+            segmentPtr++;
+        }
+    }
+
+    return nodeRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the first child of a node.
+ *
+ * @return
+ *      The child, or NULL if the node has no children.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetFirstChild
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.  Can be NULL.
+)
+{
+    const uint8_t* nodePtr = (const uint8_t*)nodeRef;
+
+    if ((nodePtr == NULL) || (*nodePtr != LE_CFG_TYPE_STEM))
+    {
+        return NULL;
+    }
+
+    const uint8_t* childPtr = SkipNodeHeader(nodePtr);
+
+    if (*childPtr == LE_CFG_SUBTREE_END)
+    {
+        return NULL;
+    }
+
+    return (cfgSubtree_NodeRef_t)childPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next sibling of a node.
+ *
+ * @return
+ *      The sibling, or NULL if the node is the last of its siblings.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetNextSibling
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.  Can be NULL.
+)
+{
+    if (nodeRef == NULL)
+    {
+        return NULL;
+    }
+
+    const uint8_t* siblingPtr = SkipNode((const uint8_t*)nodeRef);
+
+    if (*siblingPtr == LE_CFG_SUBTREE_END)
+    {
+        return NULL;
+    }
+
+    return (cfgSubtree_NodeRef_t)siblingPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the name of a node.
+ *
+ * @return
+ *      The name, or "" if the node is NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* cfgSubtree_GetNodeName
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.
+)
+{
+    if (nodeRef == NULL)
+    {
+        return "";
+    }
+
+    return NodeName((const uint8_t*)nodeRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the type of a node.
+ *
+ * @return
+ *      The type of the node, or LE_CFG_TYPE_DOESNT_EXIST if it doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_nodeType_t cfgSubtree_GetNodeType
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr             ///< [IN] Path from that node, "" for the node itself.
+)
+{
+    const uint8_t* nodePtr = (const uint8_t*)cfgSubtree_GetNode(nodeRef, pathPtr);
+
+    if (nodePtr == NULL)
+    {
+        return LE_CFG_TYPE_DOESNT_EXIST;
+    }
+
+    return (le_cfg_nodeType_t)*nodePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the value of a node as a string.  If the node doesn't exist, is empty or is a stem, the
+ * default value is used.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the value didn't fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgSubtree_GetString
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr,            ///< [IN] Path from that node, "" for the node itself.
+    char* bufferPtr,                ///< [OUT] Buffer to copy the value into.
+    size_t bufferSize,              ///< [IN] Size of the buffer.
+    const char* defaultPtr          ///< [IN] Default value.
+)
+{
+    const uint8_t* nodePtr = (const uint8_t*)cfgSubtree_GetNode(nodeRef, pathPtr);
+
+    if ((nodePtr == NULL) || !HasValue(*nodePtr))
+    {
+        return le_utf8_Copy(bufferPtr, defaultPtr, bufferSize, NULL);
+    }
+
+    const char* namePtr = NodeName(nodePtr);
+
+    return le_utf8_Copy(bufferPtr, namePtr + strlen(namePtr) + 1, bufferSize, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the value of a node as an integer.  Floating point values are rounded.  If the node is of
+ * any other type, or doesn't exist, the default value is returned.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t cfgSubtree_GetInt
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr,            ///< [IN] Path from that node, "" for the node itself.
+    int32_t defaultValue            ///< [IN] Default value.
+)
+{
+    const uint8_t* nodePtr = (const uint8_t*)cfgSubtree_GetNode(nodeRef, pathPtr);
+
+    if (nodePtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    const char* namePtr = NodeName(nodePtr);
+    const char* valuePtr = namePtr + strlen(namePtr) + 1;
+
+    switch (*nodePtr)
+    {
+        case LE_CFG_TYPE_INT:
+            return atoi(valuePtr);
+
+        case LE_CFG_TYPE_FLOAT:
+            {
+                double value = atof(valuePtr);
+                return (int32_t)(value >= 0.0 ? value + 0.5 : value - 0.5);
+            }
+
+        default:
+            return defaultValue;
+    }
+}
@@ -0,0 +1,212 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgSubtree.h
+ *
+ * Reads a section of the config tree in one go.  cfgSubtree_Read() fetches a node, and all of the
+ * nodes under it, with a single le_cfg_QuickGetSubtree() call.  If they don't fit in one call, it
+ * falls back to reading them one at a time in a read transaction.  The rest of the functions look
+ * nodes and values up in that copy, without going back to the config tree.
+ *
+ * The getters follow the config tree's rules: a path of "" is the node itself, and a default value
+ * is returned if the node doesn't exist or is of the wrong type.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_SRC_CFG_SUBTREE_INCLUDE_GUARD
+#define LEGATO_SRC_CFG_SUBTREE_INCLUDE_GUARD
+
+#include "le_cfg_interface.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A copy of a section of the config tree.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t buffer[LE_CFG_BINARY_LEN + 1];  ///< Holds the nodes if they fit in one
+                                            ///  le_cfg_QuickGetSubtree() call.
+    uint8_t* dataPtr;                       ///< Nodes, in le_cfg_GetSubtree() format, followed
+                                            ///  by an extra LE_CFG_SUBTREE_END.  Points to
+                                            ///  buffer, or to a heap block if they didn't fit.
+    size_t size;                            ///< Number of bytes of nodes in data.  0 if there
+                                            ///  are no nodes.
+}
+cfgSubtree_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a node in a cfgSubtree_t.  NULL refers to a node that doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef const struct cfgSubtree_Node* cfgSubtree_NodeRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes a subtree with no nodes.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgSubtree_Init
+(
+    cfgSubtree_t* treePtr           ///< [OUT] The subtree.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the nodes of a subtree, leaving it with no nodes.  Must be called once a subtree that
+ * was read is no longer needed.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgSubtree_Release
+(
+    cfgSubtree_t* treePtr           ///< [IN/OUT] The subtree.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a node, and all of the nodes under it, from the config tree, replacing the nodes the
+ * subtree had.  If this fails, the subtree is left with no nodes.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the node doesn't exist.
+ *      LE_OVERFLOW if a value is too long to be read from the config tree.
+ *      LE_FORMAT_ERROR if the config tree sent something that can't be decoded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgSubtree_Read
+(
+    cfgSubtree_t* treePtr,          ///< [IN/OUT] The subtree, initialized with cfgSubtree_Init().
+    const char* pathPtr             ///< [IN] Path of the node in the config tree.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the node that was read, at the top of the subtree.
+ *
+ * @return
+ *      The node, or NULL if the subtree has no nodes.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetRoot
+(
+    const cfgSubtree_t* treePtr     ///< [IN] The subtree.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a node under another one.
+ *
+ * @return
+ *      The node, or NULL if it doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetNode
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr             ///< [IN] Path from that node, "" for the node itself.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the first child of a node.
+ *
+ * @return
+ *      The child, or NULL if the node has no children.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetFirstChild
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.  Can be NULL.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next sibling of a node.
+ *
+ * @return
+ *      The sibling, or NULL if the node is the last of its siblings.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgSubtree_NodeRef_t cfgSubtree_GetNextSibling
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.  Can be NULL.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the name of a node.
+ *
+ * @return
+ *      The name, or "" if the node is NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* cfgSubtree_GetNodeName
+(
+    cfgSubtree_NodeRef_t nodeRef    ///< [IN] The node.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the type of a node.
+ *
+ * @return
+ *      The type of the node, or LE_CFG_TYPE_DOESNT_EXIST if it doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_nodeType_t cfgSubtree_GetNodeType
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr             ///< [IN] Path from that node, "" for the node itself.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the value of a node as a string.  If the node doesn't exist, is empty or is a stem, the
+ * default value is used.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the value didn't fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgSubtree_GetString
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr,            ///< [IN] Path from that node, "" for the node itself.
+    char* bufferPtr,                ///< [OUT] Buffer to copy the value into.
+    size_t bufferSize,              ///< [IN] Size of the buffer.
+    const char* defaultPtr          ///< [IN] Default value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the value of a node as an integer.  Floating point values are rounded.  If the node is of
+ * any other type, or doesn't exist, the default value is returned.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t cfgSubtree_GetInt
+(
+    cfgSubtree_NodeRef_t nodeRef,   ///< [IN] Node to start from.  Can be NULL.
+    const char* pathPtr,            ///< [IN] Path from that node, "" for the node itself.
+    int32_t defaultValue            ///< [IN] Default value.
+);
+
+
+#endif // LEGATO_SRC_CFG_SUBTREE_INCLUDE_GUARD
@@ -15,6 +15,7 @@
 #include "proc.h"
 #include "limit.h"
 #include "le_cfg_interface.h"
+#include "cfgSubtree.h"
 #include "resourceLimits.h"
 #include "fileDescriptor.h"
 #include "user.h"
@@ -256,6 +257,74 @@ EnvVar_t;
 #define FAULT_LIMIT_INTERVAL_RESTART_APP            10   // in seconds
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timing counters for proc_Start(), covering all of the processes started so far.
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    uint32_t numStarted;            ///< Number of processes started.
+    uint64_t cfgReadUs;             ///< Time spent reading the processes' config, in microseconds.
+    uint64_t startUs;               ///< Time spent starting the processes, in microseconds.
+}
+StartCounters;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the process's whole config node from the config tree, in one call if it fits (see
+ * cfgSubtree_Read()).  The process's settings are then read from this copy instead of going back to
+ * the config tree for each of them.  The copy must be released with cfgSubtree_Release().
+ *
+ * If the process has no config, or it can't be read, the copy is left empty so that reading
+ * settings from it gives their default values.
+ *
+ * @return
+ *      LE_OK if successful, or if the process has no config.
+ *      LE_FAULT if the config could not be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadProcConfig
+(
+    proc_Ref_t procRef,             ///< [IN] The process reference.
+    cfgSubtree_t* cfgPtr            ///< [OUT] Copy of the process's config.
+)
+{
+    cfgSubtree_Init(cfgPtr);
+
+    if (procRef->cfgPathPtr == NULL)
+    {
+        return LE_OK;
+    }
+
+    le_result_t result = cfgSubtree_Read(cfgPtr, procRef->cfgPathPtr);
+
+    if ((result != LE_OK) && (result != LE_NOT_FOUND))
+    {
+        LE_ERROR("Could not read the config of process '%s' (%s).",
+                 procRef->namePtr, LE_RESULT_TXT(result));
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a time to microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t TimeToUs
+(
+    le_clk_Time_t time              ///< [IN] The time.
+)
+{
+    return (uint64_t)time.sec * 1000000 + time.usec;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the fault action for the process from the config tree and store in the process record
@@ -264,7 +333,7 @@ EnvVar_t;
 static void GetFaultAction
 (
     proc_Ref_t procRef,              ///< [IN] The process reference.
-    le_cfg_IteratorRef_t procCfg     ///< [IN] The process config tree reference
+    cfgSubtree_NodeRef_t procCfg     ///< [IN] The process's config node
 )
 {
     if (procCfg == NULL)
@@ -275,8 +344,8 @@ static void GetFaultAction
     }
 
     char faultActionStr[LIMIT_MAX_FAULT_ACTION_NAME_BYTES];
-    le_result_t result = le_cfg_GetString(procCfg, CFG_NODE_FAULT_ACTION,
-                                          faultActionStr, sizeof(faultActionStr), "");
+    le_result_t result = cfgSubtree_GetString(procCfg, CFG_NODE_FAULT_ACTION,
+                                              faultActionStr, sizeof(faultActionStr), "");
 
     // Set the fault action based on the fault action string.
     if (result != LE_OK)
@@ -340,18 +409,19 @@ static void GetFaultAction
 static void GetWatchdogAction
 (
     proc_Ref_t procRef,              ///< [IN] The process reference.
-    le_cfg_IteratorRef_t procCfg     ///< [IN] The process config tree reference
+    cfgSubtree_NodeRef_t actionCfg   ///< [IN] The watchdog action config node, of the process or
+                                     ///       of its app.  NULL if there is none.
 )
 {
-    if (procCfg == NULL)
+    if (actionCfg == NULL)
     {
         procRef->watchdogAction = WATCHDOG_ACTION_NOT_FOUND;
     }
     else
     {
         char watchdogActionStr[LIMIT_MAX_FAULT_ACTION_NAME_BYTES];
-        le_result_t result = le_cfg_GetString(procCfg, CFG_NODE_WDOG_ACTION,
-                                              watchdogActionStr, sizeof(watchdogActionStr), "");
+        le_result_t result = cfgSubtree_GetString(actionCfg, "",
+                                                  watchdogActionStr, sizeof(watchdogActionStr), "");
 
         // Set the watchdog action based on the fault action string.
         if (result == LE_OK)
@@ -472,34 +542,33 @@ proc_Ref_t proc_Create
     //
     // Since something will be going
     // wrong when these are used, we don't want to rely on the config tree being available.
-    le_cfg_IteratorRef_t procCfg = NULL;
-    if (procPtr->cfgPathPtr != NULL)
-    {
-        procCfg = le_cfg_CreateReadTxn(procPtr->cfgPathPtr);
-    }
+    cfgSubtree_t cfg;
+    ReadProcConfig(procPtr, &cfg);
+
+    cfgSubtree_NodeRef_t procCfg = cfgSubtree_GetRoot(&cfg);
     GetFaultAction(procPtr, procCfg);
-    GetWatchdogAction(procPtr, procCfg);
-    if (procCfg)
-    {
-        le_cfg_CancelTxn(procCfg);
-    }
+    GetWatchdogAction(procPtr, cfgSubtree_GetNode(procCfg, CFG_NODE_WDOG_ACTION));
 
     // If watchdog action isn't available in process environment, get it from the app environment.
     if ((WATCHDOG_ACTION_NOT_FOUND == procPtr->watchdogAction ||
          WATCHDOG_ACTION_ERROR == procPtr->watchdogAction))
     {
         const char* appCfgPath = app_GetConfigPath(appRef);
+        char actionCfgPath[LIMIT_MAX_PATH_BYTES] = "";
 
-        if (NULL != appCfgPath)
+        if ((NULL != appCfgPath) &&
+            (le_path_Concat("/", actionCfgPath, sizeof(actionCfgPath),
+                            appCfgPath, CFG_NODE_WDOG_ACTION, NULL) == LE_OK))
         {
             LE_DEBUG("Getting watchdog action for process '%s' from app '%s'",
                      procPtr->namePtr, app_GetName(appRef));
-            le_cfg_IteratorRef_t appCfg = le_cfg_CreateReadTxn(appCfgPath);
-            GetWatchdogAction(procPtr, appCfg);
-            le_cfg_CancelTxn(appCfg);
+            cfgSubtree_Read(&cfg, actionCfgPath);
+            GetWatchdogAction(procPtr, cfgSubtree_GetRoot(&cfg));
         }
     }
 
+    cfgSubtree_Release(&cfg);
+
     return procPtr;
 }
 
@@ -661,7 +730,8 @@ le_result_t SetProcPriority
 //--------------------------------------------------------------------------------------------------
 static void SetSchedulingPriority
 (
-    proc_Ref_t procRef      ///< [IN] The process to set the priority for.
+    proc_Ref_t procRef,             ///< [IN] The process to set the priority for.
+    cfgSubtree_NodeRef_t procCfg    ///< [IN] The process's config node.
 )
 {
     char priorStr[LIMIT_MAX_PRIORITY_NAME_BYTES] = "medium";
@@ -673,17 +743,13 @@ static void SetSchedulingPriority
     }
     else if (procRef->cfgPathPtr != NULL)
     {
-        // Read the priority setting from the config tree.
-        le_cfg_IteratorRef_t procCfg = le_cfg_CreateReadTxn(procRef->cfgPathPtr);
-
-        if (le_cfg_GetString(procCfg, CFG_NODE_PRIORITY, priorStr, sizeof(priorStr), "medium") != LE_OK)
+        // Read the priority setting from the config.
+        if (cfgSubtree_GetString(procCfg, CFG_NODE_PRIORITY, priorStr, sizeof(priorStr), "medium") != LE_OK)
         {
             LE_CRIT("Priority string for process %s is too long.  Using default priority.", procRef->namePtr);
 
             LE_ASSERT(le_utf8_Copy(priorStr, "medium", sizeof(priorStr), NULL) == LE_OK);
         }
-
-        le_cfg_CancelTxn(procCfg);
     }
 
     if (SetProcPriority(priorStrPtr, procRef->pid) != LE_OK)
@@ -704,49 +770,48 @@ static void SetSchedulingPriority
 //--------------------------------------------------------------------------------------------------
 static le_result_t GetEnvironmentVariables
 (
-    proc_Ref_t procRef,     ///< [IN] The process to get the environment variables for.
-    EnvVar_t envVars[],     ///< [IN] The list of environment variables.
-    size_t maxNumEnvVars    ///< [IN] The maximum number of items envVars can hold.
+    proc_Ref_t procRef,             ///< [IN] The process to get the environment variables for.
+    cfgSubtree_NodeRef_t procCfg,   ///< [IN] The process's config node.
+    EnvVar_t envVars[],             ///< [IN] The list of environment variables.
+    size_t maxNumEnvVars            ///< [IN] The maximum number of items envVars can hold.
 )
 {
     int numEnvVars = 0;
 
     if (procRef->cfgPathPtr != NULL)
     {
-        le_cfg_IteratorRef_t procCfg = le_cfg_CreateReadTxn(procRef->cfgPathPtr);
-        le_cfg_GoToNode(procCfg, CFG_NODE_ENV_VARS);
+        cfgSubtree_NodeRef_t envVarCfg =
+            cfgSubtree_GetFirstChild(cfgSubtree_GetNode(procCfg, CFG_NODE_ENV_VARS));
 
-        if (le_cfg_GoToFirstChild(procCfg) != LE_OK)
+        if (envVarCfg == NULL)
         {
             LE_WARN("No environment variables for process '%s'.", procRef->namePtr);
 
-            le_cfg_CancelTxn(procCfg);
             return 0;
         }
 
         int i = 0;
         for (i = 0; i < maxNumEnvVars; i++)
         {
-            if ( (le_cfg_GetNodeName(procCfg, "", envVars[i].name, LIMIT_MAX_ENV_VAR_NAME_BYTES) != LE_OK) ||
-                 (le_cfg_GetString(procCfg, "", envVars[i].value, LIMIT_MAX_PATH_BYTES, "") != LE_OK) )
+            if ( (le_utf8_Copy(envVars[i].name, cfgSubtree_GetNodeName(envVarCfg),
+                               LIMIT_MAX_ENV_VAR_NAME_BYTES, NULL) != LE_OK) ||
+                 (cfgSubtree_GetString(envVarCfg, "", envVars[i].value, LIMIT_MAX_PATH_BYTES, "") != LE_OK) )
             {
-                le_cfg_CancelTxn(procCfg);
                 goto errorReading;
             }
 
-            if (le_cfg_GoToNextSibling(procCfg) != LE_OK)
+            envVarCfg = cfgSubtree_GetNextSibling(envVarCfg);
+
+            if (envVarCfg == NULL)
             {
                 break;
             }
             else if (i >= maxNumEnvVars-1)
             {
-                le_cfg_CancelTxn(procCfg);
                 goto errorReading;
             }
         }
 
-        le_cfg_CancelTxn(procCfg);
-
         numEnvVars = i + 1;
     }
     // If the config path is NULL (likely because the process is auxiliary and thus "unconfigured"),
@@ -845,6 +910,7 @@ static void SetEnvironmentVariables
 static le_result_t GetArgs
 (
     proc_Ref_t procRef,             ///< [IN] The process to get the args for.
+    cfgSubtree_NodeRef_t procCfg,   ///< [IN] The process's config node.
     char argsBuffers[LIMIT_MAX_NUM_CMD_LINE_ARGS][LIMIT_MAX_ARGS_STR_BYTES], ///< [OUT] A pointer to
                                                                              /// an array of buffers
                                                                              /// used to store
@@ -885,28 +951,26 @@ static le_result_t GetArgs
     // Set the executable and the args if necessary.
     if (procRef->cfgPathPtr != NULL)
     {
-        // Get a config iterator to the arguments list.
-        le_cfg_IteratorRef_t procCfg = le_cfg_CreateReadTxn(procRef->cfgPathPtr);
-        le_cfg_GoToNode(procCfg, CFG_NODE_ARGS);
+        // Get the first node of the arguments list.
+        cfgSubtree_NodeRef_t argCfg =
+            cfgSubtree_GetFirstChild(cfgSubtree_GetNode(procCfg, CFG_NODE_ARGS));
 
-        if (le_cfg_GoToFirstChild(procCfg) != LE_OK)
+        if (argCfg == NULL)
         {
             LE_ERROR("No arguments for process '%s'.", procRef->namePtr);
-            le_cfg_CancelTxn(procCfg);
             return LE_FAULT;
         }
 
         // Record the executable path.
         if (procRef->execPathPtr == NULL)
         {
-            if (le_cfg_GetString(procCfg, "", argsBuffers[bufIndex],
-                                 LIMIT_MAX_ARGS_STR_BYTES, "") != LE_OK)
+            if (cfgSubtree_GetString(argCfg, "", argsBuffers[bufIndex],
+                                     LIMIT_MAX_ARGS_STR_BYTES, "") != LE_OK)
             {
                 LE_ERROR("Error reading argument '%s...' for process '%s'.",
                          argsBuffers[bufIndex],
                          procRef->namePtr);
 
-                le_cfg_CancelTxn(procCfg);
                 return LE_FAULT;
             }
 
@@ -921,33 +985,32 @@ static le_result_t GetArgs
 
             while(1)
             {
-                if (le_cfg_GoToNextSibling(procCfg) != LE_OK)
+                argCfg = cfgSubtree_GetNextSibling(argCfg);
+
+                if (argCfg == NULL)
                 {
                     break;
                 }
                 else if (bufIndex >= LIMIT_MAX_NUM_CMD_LINE_ARGS)
                 {
                     LE_ERROR("Too many arguments for process '%s'.", procRef->namePtr);
-                    le_cfg_CancelTxn(procCfg);
                     return LE_FAULT;
                 }
 
-                if (le_cfg_IsEmpty(procCfg, ""))
+                if (cfgSubtree_GetNodeType(argCfg, "") == LE_CFG_TYPE_EMPTY)
                 {
                     LE_ERROR("Empty node in argument list for process '%s'.", procRef->namePtr);
 
-                    le_cfg_CancelTxn(procCfg);
                     return LE_FAULT;
                 }
 
-                if (le_cfg_GetString(procCfg, "", argsBuffers[bufIndex],
-                                     LIMIT_MAX_ARGS_STR_BYTES, "") != LE_OK)
+                if (cfgSubtree_GetString(argCfg, "", argsBuffers[bufIndex],
+                                         LIMIT_MAX_ARGS_STR_BYTES, "") != LE_OK)
                 {
                     LE_ERROR("Argument too long '%s...' for process '%s'.",
                              argsBuffers[bufIndex],
                              procRef->namePtr);
 
-                    le_cfg_CancelTxn(procCfg);
                     return LE_FAULT;
                 }
 
@@ -957,8 +1020,6 @@ static le_result_t GetArgs
                 bufIndex++;
             }
         }
-
-        le_cfg_CancelTxn(procCfg);
     }
 
     // Terminate the list.
@@ -1241,6 +1302,23 @@ le_result_t proc_Start
         return LE_FAULT;
     }
 
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    // @Note The current IPC system does not support forking so any reads to the config DB must be
+    //       done in the parent process.
+
+    // Get this process's config from the config tree.  All of the settings below are read from it.
+    cfgSubtree_t cfg;
+
+    if (ReadProcConfig(procRef, &cfg) != LE_OK)
+    {
+        LE_ERROR("Process '%s' cannot be started.", procRef->namePtr);
+        return LE_FAULT;
+    }
+
+    cfgSubtree_NodeRef_t procCfg = cfgSubtree_GetRoot(&cfg);
+    le_clk_Time_t cfgReadTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
     // Create a pipe for parent/child synchronization.
     int syncPipeFd[2];
     LE_FATAL_IF(pipe(syncPipeFd) == -1, "Could not create synchronization pipe.  %m.");
@@ -1254,17 +1332,15 @@ le_result_t proc_Start
         LE_FATAL_IF(pipe(blockPipeFd) == -1, "Could not create block pipe.  %m.");
     }
 
-    // @Note The current IPC system does not support forking so any reads to the config DB must be
-    //       done in the parent process.
-
     // Get the environment variables from the config tree for this process.
     EnvVar_t envVars[LIMIT_MAX_NUM_ENV_VARS] = {{{ 0 }}};
-    int numEnvVars = GetEnvironmentVariables(procRef, envVars, LIMIT_MAX_NUM_ENV_VARS);
+    int numEnvVars = GetEnvironmentVariables(procRef, procCfg, envVars, LIMIT_MAX_NUM_ENV_VARS);
 
     if ((numEnvVars < 0) || (numEnvVars > LIMIT_MAX_NUM_ENV_VARS))
     {
         LE_ERROR("Error getting environment variables.  Process '%s' cannot be started.",
                  procRef->namePtr);
+        cfgSubtree_Release(&cfg);
         return LE_FAULT;
     }
 
@@ -1272,16 +1348,17 @@ le_result_t proc_Start
     char argsBuffers[LIMIT_MAX_NUM_CMD_LINE_ARGS][LIMIT_MAX_ARGS_STR_BYTES];
     char* argsPtr[NUM_ARGS_PTRS];
 
-    if (GetArgs(procRef, argsBuffers, argsPtr) != LE_OK)
+    if (GetArgs(procRef, procCfg, argsBuffers, argsPtr) != LE_OK)
     {
         LE_ERROR("Could not get command line arguments, process '%s' cannot be started.",
                  procRef->namePtr);
+        cfgSubtree_Release(&cfg);
         return LE_FAULT;
     }
 
     // Get the resource limits from the config tree for this process.
     resLim_ProcLimits_t procLimits;
-    resLim_GetProcLimits(procRef, &procLimits);
+    resLim_GetProcLimits(procRef, procCfg, &procLimits);
 
     // Create pipes for the process's standard error and standard out streams.
     int logStdOutPipe[2];
@@ -1295,6 +1372,7 @@ le_result_t proc_Start
     if (pID < 0)
     {
         LE_EMERG("Failed to fork.  %m.");
+        cfgSubtree_Release(&cfg);
         return LE_FAULT;
     }
 
@@ -1381,7 +1459,8 @@ le_result_t proc_Start
     fd_Close(syncPipeFd[READ_PIPE]);
 
     // Set the scheduling priority for the child process while the child process is blocked.
-    SetSchedulingPriority(procRef);
+    SetSchedulingPriority(procRef, procCfg);
+    cfgSubtree_Release(&cfg);
 
     // Send standard pipes to the log daemon so they will show up in the logs.
     SendStdPipeToLogDaemon(procRef, logStdErrPipe, STDERR_FILENO);
@@ -1390,7 +1469,18 @@ le_result_t proc_Start
     // Set the cgroups for the child process while the child process is blocked.
     resLim_SetCGroups(procRef);
 
-    LE_INFO("Starting process '%s' with pid %d", procRef->namePtr, procRef->pid);
+    le_clk_Time_t startedTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    StartCounters.numStarted++;
+    StartCounters.cfgReadUs += TimeToUs(cfgReadTime);
+    StartCounters.startUs += TimeToUs(startedTime);
+
+    LE_INFO("Starting process '%s' with pid %d (config read in %" PRIu64 " us, started in %"
+            PRIu64 " us)",
+            procRef->namePtr, procRef->pid, TimeToUs(cfgReadTime), TimeToUs(startedTime));
+    LE_DEBUG("%" PRIu32 " processes started in %" PRIu64 " us, %" PRIu64 " us of which reading"
+             " config.",
+             StartCounters.numStarted, StartCounters.startUs, StartCounters.cfgReadUs);
 
     // Unblock the child process.
     fd_Close(syncPipeFd[WRITE_PIPE]);
@@ -1546,15 +1636,18 @@ bool proc_IsRealtime
     else if (procRef->cfgPathPtr != NULL)
     {
         // Read the priority setting from the config tree.
-        le_cfg_IteratorRef_t procCfg = le_cfg_CreateReadTxn(procRef->cfgPathPtr);
+        char priorPath[LIMIT_MAX_PATH_BYTES] = "";
 
-        le_result_t result = le_cfg_GetString(procCfg,
-                                              CFG_NODE_PRIORITY,
-                                              priorStr,
-                                              sizeof(priorStr),
-                                              "medium");
+        if (le_path_Concat("/", priorPath, sizeof(priorPath),
+                           procRef->cfgPathPtr, CFG_NODE_PRIORITY, NULL) != LE_OK)
+        {
+            return false;
+        }
 
-        le_cfg_CancelTxn(procCfg);
+        le_result_t result = le_cfg_QuickGetString(priorPath,
+                                                   priorStr,
+                                                   sizeof(priorStr),
+                                                   "medium");
 
         if (result != LE_OK)
         {
@@ -177,31 +177,22 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets the resource limit value from the config tree.
+ * Checks a resource limit value read from the config tree.
  *
  * @return
  *      The resource limit from the config tree if it is valid.  If the value in the config tree is
  *      invalid the default value is returned.
  */
 //--------------------------------------------------------------------------------------------------
-static int GetCfgResourceLimit
+static int CheckCfgResourceLimit
 (
-    le_cfg_IteratorRef_t limitCfg,  // The iterator to use to read the configured limit.  This
-                                    // iterator is owned by the caller and should not be deleted
-                                    // in this function.
     const char* nodeName,           // The name of the node in the config tree that holds the value.
+    le_cfg_nodeType_t nodeType,     // The type of the node.
+    int limitValue,                 // The value of the node, if it is an integer.
     int defaultValue                // The default value to use if the config value is invalid.
 )
 {
-    // No open config -- just use default value
-    if (!limitCfg)
-    {
-        return defaultValue;
-    }
-
-    int limitValue = le_cfg_GetInt(limitCfg, nodeName, defaultValue);
-
-    if (!le_cfg_NodeExists(limitCfg, nodeName))
+    if (nodeType == LE_CFG_TYPE_DOESNT_EXIST)
     {
         LE_INFO("Configured resource limit %s is not available.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -209,7 +200,7 @@ static int GetCfgResourceLimit
         return defaultValue;
     }
 
-    if (le_cfg_IsEmpty(limitCfg, nodeName))
+    if (nodeType == LE_CFG_TYPE_EMPTY)
     {
         LE_WARN("Configured resource limit %s is empty.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -217,7 +208,7 @@ static int GetCfgResourceLimit
         return defaultValue;
     }
 
-    if (le_cfg_GetNodeType(limitCfg, nodeName) != LE_CFG_TYPE_INT)
+    if (nodeType != LE_CFG_TYPE_INT)
     {
         LE_ERROR("Configured resource limit %s is the wrong type.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -237,6 +228,71 @@ static int GetCfgResourceLimit
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the resource limit value from the config tree.
+ *
+ * @return
+ *      The resource limit from the config tree if it is valid.  If the value in the config tree is
+ *      invalid the default value is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static int GetCfgResourceLimit
+(
+    le_cfg_IteratorRef_t limitCfg,  // The iterator to use to read the configured limit.  This
+                                    // iterator is owned by the caller and should not be deleted
+                                    // in this function.
+    const char* nodeName,           // The name of the node in the config tree that holds the value.
+    int defaultValue                // The default value to use if the config value is invalid.
+)
+{
+    // No open config -- just use default value
+    if (!limitCfg)
+    {
+        return defaultValue;
+    }
+
+    le_cfg_nodeType_t nodeType = le_cfg_GetNodeType(limitCfg, nodeName);
+    int limitValue = defaultValue;
+
+    if (nodeType == LE_CFG_TYPE_INT)
+    {
+        limitValue = le_cfg_GetInt(limitCfg, nodeName, defaultValue);
+    }
+
+    return CheckCfgResourceLimit(nodeName, nodeType, limitValue, defaultValue);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the resource limit value from a process's config, read with cfgSubtree_Read().
+ *
+ * @return
+ *      The resource limit from the config tree if it is valid.  If the value in the config tree is
+ *      invalid the default value is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static int GetSubtreeResourceLimit
+(
+    cfgSubtree_NodeRef_t limitCfg,  // The node that holds the configured limit.
+    const char* nodeName,           // The name of the node in the config tree that holds the value.
+    int defaultValue                // The default value to use if the config value is invalid.
+)
+{
+    // No config -- just use default value
+    if (!limitCfg)
+    {
+        return defaultValue;
+    }
+
+    return CheckCfgResourceLimit(nodeName,
+                                 cfgSubtree_GetNodeType(limitCfg, nodeName),
+                                 cfgSubtree_GetInt(limitCfg, nodeName, defaultValue),
+                                 defaultValue);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the sandboxed application's tmpfs file system limit.
@@ -387,69 +443,61 @@ le_result_t resLim_SetAppLimits
 void resLim_GetProcLimits
 (
     proc_Ref_t procRef,             ///< [IN] The process to get resource limits for.
+    cfgSubtree_NodeRef_t procCfg,   ///< [IN] The process's config.  NULL if it has none.
     resLim_ProcLimits_t* limitsPtr  ///< [OUT] The limits for the process
 )
 {
-    le_cfg_IteratorRef_t procCfg;
-
-    // Create an iterator for this process.
-    if (proc_GetConfigPath(procRef) != NULL)
-    {
-        procCfg = le_cfg_CreateReadTxn(proc_GetConfigPath(procRef));
-    }
-    else
-    {
-        procCfg = NULL;
-    }
-
     // Set the process resource limits.
     limitsPtr->maxCoreDumpFileBytes =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_CORE_DUMP_FILE_BYTES,
-                             DEFAULT_LIMIT_MAX_CORE_DUMP_FILE_BYTES);
+        GetSubtreeResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_CORE_DUMP_FILE_BYTES,
+                                 DEFAULT_LIMIT_MAX_CORE_DUMP_FILE_BYTES);
 
     limitsPtr->maxFileBytes =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_FILE_BYTES,
-                             DEFAULT_LIMIT_MAX_FILE_BYTES);
+        GetSubtreeResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_FILE_BYTES,
+                                 DEFAULT_LIMIT_MAX_FILE_BYTES);
 
     limitsPtr->maxLockedMemoryBytes =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_LOCKED_MEMORY_BYTES,
-                             DEFAULT_LIMIT_MAX_LOCKED_MEMORY_BYTES);
+        GetSubtreeResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_LOCKED_MEMORY_BYTES,
+                                 DEFAULT_LIMIT_MAX_LOCKED_MEMORY_BYTES);
 
     limitsPtr->maxFileDescriptors =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_FILE_DESCRIPTORS,
-                             DEFAULT_LIMIT_MAX_FILE_DESCRIPTORS);
+        GetSubtreeResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_FILE_DESCRIPTORS,
+                                 DEFAULT_LIMIT_MAX_FILE_DESCRIPTORS);
 
     limitsPtr->maxStackBytes =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_STACK_BYTES,
-                             DEFAULT_LIMIT_MAX_STACK_BYTES);
+        GetSubtreeResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_STACK_BYTES,
+                                 DEFAULT_LIMIT_MAX_STACK_BYTES);
 
     // Set the application limits.
     //
     // @note Even though these are application limits they still need to be set for the process
     //       because Linux rlimits are applied to individual processes.
 
-    if (procCfg)
+    le_cfg_IteratorRef_t appCfg = NULL;
+
+    if (proc_GetConfigPath(procRef) != NULL)
     {
         // Goto the application config path from the process config path.
-        le_cfg_GoToParent(procCfg);
-        le_cfg_GoToParent(procCfg);
+        appCfg = le_cfg_CreateReadTxn(proc_GetConfigPath(procRef));
+        le_cfg_GoToParent(appCfg);
+        le_cfg_GoToParent(appCfg);
     }
 
     limitsPtr->maxMQueueBytes =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_MQUEUE_BYTES,
+        GetCfgResourceLimit( appCfg, CFG_NODE_LIMIT_MAX_MQUEUE_BYTES,
                              DEFAULT_LIMIT_MAX_MQUEUE_BYTES);
 
     limitsPtr->maxThreads =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_THREADS,
+        GetCfgResourceLimit( appCfg, CFG_NODE_LIMIT_MAX_THREADS,
                              DEFAULT_LIMIT_MAX_THREADS);
 
     limitsPtr->maxQueuedSignals =
-        GetCfgResourceLimit( procCfg, CFG_NODE_LIMIT_MAX_QUEUED_SIGNALS,
+        GetCfgResourceLimit( appCfg, CFG_NODE_LIMIT_MAX_QUEUED_SIGNALS,
                              DEFAULT_LIMIT_MAX_QUEUED_SIGNALS);
 
-    if (procCfg)
+    if (appCfg)
     {
-        le_cfg_CancelTxn(procCfg);
+        le_cfg_CancelTxn(appCfg);
     }
 }
 
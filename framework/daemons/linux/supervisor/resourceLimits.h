@@ -12,6 +12,7 @@
 
 #include "app.h"
 #include "proc.h"
+#include "cfgSubtree.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -72,6 +73,7 @@ le_result_t resLim_SetAppLimits
 void resLim_GetProcLimits
 (
     proc_Ref_t procRef,             ///< [IN] The process to get resource limits for.
+    cfgSubtree_NodeRef_t procCfg,   ///< [IN] The process's config.  NULL if it has none.
     resLim_ProcLimits_t* limitPtr   ///< [OUT] The limits for the process
 );
 
@@ -0,0 +1,965 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file delta.c
+ *
+ * Completion of unpacked delta payloads from the installed version they are based on.  See
+ * delta.h for the manifest and patch formats.
+ *
+ * Paths from the manifest are walked one component at a time without following symbolic links,
+ * in both the base tree and the new tree, so a manifest can't reach outside either of them.
+ * Every file taken from the base is checked against the MD5 hash in the manifest, so a base that
+ * has been modified since it was installed can't silently end up in the new version.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "delta.h"
+#include "md5.h"
+
+#include <sys/mman.h>
+#include <sys/xattr.h>
+
+
+/// First line of a delta manifest.
+#define MANIFEST_HEADER "legato-delta 1"
+
+/// Longest manifest line that will be accepted.
+#define MANIFEST_LINE_BYTES (LIMIT_MAX_PATH_BYTES + 128)
+
+/// First bytes of a patch file.
+#define PATCH_MAGIC "LEDELTA1"
+
+/// Size of a patch file header: the magic bytes and the new file's size.
+#define PATCH_HEADER_BYTES 16
+
+/// Patch operation codes.
+#define PATCH_OP_END  0
+#define PATCH_OP_COPY 1
+#define PATCH_OP_DATA 2
+
+/// Size of the buffer used to hash and copy files.
+#define COPY_BUFFER_BYTES (16 * 1024)
+
+/// Size of the buffers used to copy extended attributes.
+#define XATTR_BUFFER_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts of what was done, for logging.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    unsigned int linked;    ///< Files hard-linked from the base.
+    unsigned int copied;    ///< Files copied from the base because they couldn't be linked.
+    unsigned int patched;   ///< Files rebuilt from a base file and a patch.
+}
+Counts_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a path from a manifest is relative and stays inside the tree.
+ *
+ * @return true if the path is acceptable.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsPathSafe
+(
+    const char* pathPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((pathPtr[0] == '\0') || (pathPtr[0] == '/'))
+    {
+        return false;
+    }
+
+    const char* componentPtr = pathPtr;
+    for (;;)
+    {
+        const char* endPtr = strchrnul(componentPtr, '/');
+        size_t len = endPtr - componentPtr;
+
+        if (   (len == 0)
+            || ((len == 1) && (componentPtr[0] == '.'))
+            || ((len == 2) && (componentPtr[0] == '.') && (componentPtr[1] == '.')) )
+        {
+            return false;
+        }
+        if (*endPtr == '\0')
+        {
+            return true;
+        }
+        componentPtr = endPtr + 1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the directory that a file is in, without following symbolic links.
+ *
+ * @return An open directory file descriptor, which the caller must close, or -1 on failure
+ *         (errno set).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenParentDir
+(
+    int rootFd,                 ///< [IN] Top of the tree.
+    const char* pathPtr,        ///< [IN] Path of the file, relative to the top of the tree.
+    const char** leafPtrPtr     ///< [OUT] Last component of the path (points into pathPtr).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    if (le_utf8_Copy(path, pathPtr, sizeof(path), NULL) != LE_OK)
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    const char* slashPtr = strrchr(pathPtr, '/');
+    *leafPtrPtr = (slashPtr == NULL) ? pathPtr : slashPtr + 1;
+
+    int fd = dup(rootFd);
+    if ((fd == -1) || (slashPtr == NULL))
+    {
+        return fd;
+    }
+    path[slashPtr - pathPtr] = '\0';
+
+    char* savePtr = NULL;
+    char* componentPtr;
+    for (componentPtr = strtok_r(path, "/", &savePtr);
+         componentPtr != NULL;
+         componentPtr = strtok_r(NULL, "/", &savePtr))
+    {
+        int nextFd = openat(fd, componentPtr, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+        int savedErrno = errno;
+        close(fd);
+        if (nextFd == -1)
+        {
+            errno = savedErrno;
+            return -1;
+        }
+        fd = nextFd;
+    }
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a regular file in the base tree for reading.
+ *
+ * @return An open file descriptor, which the caller must close, or -1 on failure (an error has
+ *         been logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenBaseFile
+(
+    int baseFd,                 ///< [IN] Top of the base tree.
+    const char* pathPtr,        ///< [IN] Path of the file, relative to the top of the tree.
+    struct stat* statPtr        ///< [OUT] The file's status.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* leafPtr;
+    int dirFd = OpenParentDir(baseFd, pathPtr, &leafPtr);
+    if (dirFd == -1)
+    {
+        LE_ERROR("Can't open directory of '%s' in delta base (%m).", pathPtr);
+        return -1;
+    }
+
+    int fd = openat(dirFd, leafPtr, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1)
+    {
+        LE_ERROR("Can't open '%s' in delta base (%m).", pathPtr);
+    }
+    else if (fstat(fd, statPtr) != 0)
+    {
+        LE_ERROR("Can't stat '%s' in delta base (%m).", pathPtr);
+        close(fd);
+        fd = -1;
+    }
+    else if (!S_ISREG(statPtr->st_mode))
+    {
+        LE_ERROR("'%s' in delta base isn't a regular file.", pathPtr);
+        close(fd);
+        fd = -1;
+    }
+
+    close(dirFd);
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the MD5 hash of a file's contents.
+ *
+ * @return LE_OK or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t HashFile
+(
+    int fd,                         ///< [IN] File to hash (read from the beginning).
+    char md5Str[MD5_STRING_BYTES]   ///< [OUT] MD5 hash string.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t buffer[COPY_BUFFER_BYTES];
+    md5_Context_t context;
+    off_t offset = 0;
+
+    md5_Init(&context);
+    for (;;)
+    {
+        ssize_t count = pread(fd, buffer, sizeof(buffer), offset);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return LE_FAULT;
+        }
+        if (count == 0)
+        {
+            break;
+        }
+        md5_Update(&context, buffer, count);
+        offset += count;
+    }
+    md5_Final(&context, md5Str);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a file's extended attributes (e.g., its IMA signature) to another file.
+ *
+ * @return LE_OK or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyXattrs
+(
+    int srcFd,
+    int destFd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char names[XATTR_BUFFER_BYTES];
+    char value[XATTR_BUFFER_BYTES];
+
+    ssize_t namesLen = flistxattr(srcFd, names, sizeof(names));
+    if (namesLen < 0)
+    {
+        return ((errno == ENOTSUP) ? LE_OK : LE_FAULT);
+    }
+
+    const char* namePtr;
+    for (namePtr = names; namePtr < names + namesLen; namePtr += strlen(namePtr) + 1)
+    {
+        ssize_t valueLen = fgetxattr(srcFd, namePtr, value, sizeof(value));
+        if ((valueLen < 0) || (fsetxattr(destFd, namePtr, value, valueLen, 0) != 0))
+        {
+            LE_ERROR("Can't copy extended attribute '%s' (%m).", namePtr);
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a file, for when it can't be hard-linked.
+ *
+ * @return LE_OK or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyFile
+(
+    int srcFd,                      ///< [IN] File to copy.
+    const struct stat* statPtr,     ///< [IN] Its status.
+    int destDirFd,                  ///< [IN] Directory to copy it into.
+    const char* leafPtr             ///< [IN] Name of the copy.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int destFd = openat(destDirFd,
+                        leafPtr,
+                        O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                        S_IRUSR | S_IWUSR);
+    if (destFd == -1)
+    {
+        return LE_FAULT;
+    }
+
+    uint8_t buffer[COPY_BUFFER_BYTES];
+    off_t offset = 0;
+    le_result_t result = LE_OK;
+
+    for (;;)
+    {
+        ssize_t count = pread(srcFd, buffer, sizeof(buffer), offset);
+        if ((count < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            result = ((count == 0) ? LE_OK : LE_FAULT);
+            break;
+        }
+        if (fd_WriteSize(destFd, buffer, count) != count)
+        {
+            result = LE_FAULT;
+            break;
+        }
+        offset += count;
+    }
+
+    if (   (result != LE_OK)
+        || (fchmod(destFd, statPtr->st_mode & 07777) != 0)
+        || (CopyXattrs(srcFd, destFd) != LE_OK) )
+    {
+        result = LE_FAULT;
+    }
+
+    if (close(destFd) != 0)
+    {
+        result = LE_FAULT;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Bring an unchanged file over from the base tree.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LinkFile
+(
+    int baseFd,                 ///< [IN] Top of the base tree.
+    int dirFd,                  ///< [IN] Top of the new tree.
+    const char* md5Ptr,         ///< [IN] Expected MD5 hash of the file.
+    const char* pathPtr,        ///< [IN] Path of the file.
+    Counts_t* countsPtr         ///< [IN,OUT] What was done.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat st;
+    int srcFd = OpenBaseFile(baseFd, pathPtr, &st);
+    if (srcFd == -1)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    const char* leafPtr;
+    char md5[MD5_STRING_BYTES];
+    int srcDirFd = -1;
+    int destDirFd = -1;
+
+    if (HashFile(srcFd, md5) != LE_OK)
+    {
+        LE_ERROR("Can't read '%s' in delta base (%m).", pathPtr);
+        result = LE_FAULT;
+    }
+    else if (strcmp(md5, md5Ptr) != 0)
+    {
+        LE_ERROR("'%s' in delta base has MD5 hash %s; delta expects %s.", pathPtr, md5, md5Ptr);
+        result = LE_FORMAT_ERROR;
+    }
+    else if (   ((srcDirFd = OpenParentDir(baseFd, pathPtr, &leafPtr)) == -1)
+             || ((destDirFd = OpenParentDir(dirFd, pathPtr, &leafPtr)) == -1) )
+    {
+        LE_ERROR("Can't open directory of '%s' (%m).", pathPtr);
+        result = LE_FORMAT_ERROR;
+    }
+    else if (linkat(srcDirFd, leafPtr, destDirFd, leafPtr, 0) == 0)
+    {
+        countsPtr->linked++;
+    }
+    else if ((errno == EXDEV) || (errno == EPERM) || (errno == EMLINK))
+    {
+        result = CopyFile(srcFd, &st, destDirFd, leafPtr);
+        if (result != LE_OK)
+        {
+            LE_ERROR("Can't copy '%s' from delta base (%m).", pathPtr);
+        }
+        else
+        {
+            countsPtr->copied++;
+        }
+    }
+    else
+    {
+        // Something is already there if the tarball carried the file too.
+        result = ((errno == EEXIST) ? LE_FORMAT_ERROR : LE_FAULT);
+        LE_ERROR("Can't link '%s' from delta base (%m).", pathPtr);
+    }
+
+    if (srcDirFd != -1)
+    {
+        close(srcDirFd);
+    }
+    if (destDirFd != -1)
+    {
+        close(destDirFd);
+    }
+    close(srcFd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a whole file into memory for reading.
+ *
+ * @return LE_OK or LE_FAULT.  An empty file is "mapped" at NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MapFile
+(
+    int fd,                     ///< [IN] File to map.
+    size_t size,                ///< [IN] Its size.
+    const uint8_t** dataPtrPtr  ///< [OUT] Where it's mapped.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (size == 0)
+    {
+        *dataPtrPtr = NULL;
+        return LE_OK;
+    }
+
+    void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        return LE_FAULT;
+    }
+
+    *dataPtrPtr = addr;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a big-endian number.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNumber
+(
+    const uint8_t* dataPtr,
+    size_t bytes
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t number = 0;
+    size_t i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        number = (number << 8) | dataPtr[i];
+    }
+
+    return number;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild a file from a patch and its base.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR (corrupt patch) or LE_FAULT (write failed).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyPatch
+(
+    const uint8_t* patchPtr,    ///< [IN] Patch.
+    size_t patchSize,           ///< [IN] Size of the patch.
+    const uint8_t* basePtr,     ///< [IN] Base file.
+    size_t baseSize,            ///< [IN] Size of the base file.
+    int destFd,                 ///< [IN] New file.
+    char md5Str[MD5_STRING_BYTES]   ///< [OUT] MD5 hash of what was written to the new file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (patchSize < PATCH_HEADER_BYTES)
+        || (memcmp(patchPtr, PATCH_MAGIC, sizeof(PATCH_MAGIC) - 1) != 0) )
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    uint64_t newSize = GetNumber(patchPtr + 8, 8);
+    uint64_t written = 0;
+    size_t pos = PATCH_HEADER_BYTES;
+    md5_Context_t context;
+
+    md5_Init(&context);
+    for (;;)
+    {
+        const uint8_t* dataPtr;
+        uint64_t length;
+
+        if (pos >= patchSize)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        uint8_t op = patchPtr[pos++];
+        if (op == PATCH_OP_END)
+        {
+            break;
+        }
+        else if ((op == PATCH_OP_COPY) && (patchSize - pos >= 12))
+        {
+            uint64_t offset = GetNumber(patchPtr + pos, 8);
+            length = GetNumber(patchPtr + pos + 8, 4);
+            pos += 12;
+
+            if ((offset > baseSize) || (length > baseSize - offset))
+            {
+                return LE_FORMAT_ERROR;
+            }
+            dataPtr = basePtr + offset;
+        }
+        else if ((op == PATCH_OP_DATA) && (patchSize - pos >= 4))
+        {
+            length = GetNumber(patchPtr + pos, 4);
+            pos += 4;
+
+            if (length > patchSize - pos)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            dataPtr = patchPtr + pos;
+            pos += length;
+        }
+        else
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if (length > newSize - written)
+        {
+            return LE_FORMAT_ERROR;
+        }
+        if (length > 0)
+        {
+            if (fd_WriteSize(destFd, (void*)dataPtr, length) != (ssize_t)length)
+            {
+                return LE_FAULT;
+            }
+            md5_Update(&context, dataPtr, length);
+            written += length;
+        }
+    }
+
+    if ((written != newSize) || (pos != patchSize))
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    md5_Final(&context, md5Str);
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild a changed file from its version in the base tree and a patch.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PatchFile
+(
+    int baseFd,                 ///< [IN] Top of the base tree.
+    int dirFd,                  ///< [IN] Top of the new tree.
+    int deltaDirFd,             ///< [IN] Directory holding the patch files.
+    const char* md5Ptr,         ///< [IN] Expected MD5 hash of the new file.
+    mode_t mode,                ///< [IN] Permissions of the new file.
+    const char* patchNamePtr,   ///< [IN] Name of the patch file.
+    const char* pathPtr,        ///< [IN] Path of the file.
+    Counts_t* countsPtr         ///< [IN,OUT] What was done.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (strchr(patchNamePtr, '/') != NULL)
+    {
+        LE_ERROR("Bad patch file name '%s' in delta manifest.", patchNamePtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    struct stat baseStat;
+    int srcFd = OpenBaseFile(baseFd, pathPtr, &baseStat);
+    if (srcFd == -1)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    struct stat patchStat;
+    const uint8_t* basePtr = NULL;
+    const uint8_t* patchPtr = NULL;
+    const char* leafPtr;
+    int destDirFd = -1;
+    int destFd = -1;
+
+    int patchFd = openat(deltaDirFd, patchNamePtr, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if ((patchFd == -1) || (fstat(patchFd, &patchStat) != 0) || !S_ISREG(patchStat.st_mode))
+    {
+        LE_ERROR("Can't open patch file '%s' (%m).", patchNamePtr);
+        result = LE_FORMAT_ERROR;
+        goto cleanup;
+    }
+
+    if (   (MapFile(srcFd, baseStat.st_size, &basePtr) != LE_OK)
+        || (MapFile(patchFd, patchStat.st_size, &patchPtr) != LE_OK) )
+    {
+        LE_ERROR("Can't map '%s' or its patch into memory (%m).", pathPtr);
+        result = LE_FAULT;
+        goto cleanup;
+    }
+
+    destDirFd = OpenParentDir(dirFd, pathPtr, &leafPtr);
+    if (destDirFd != -1)
+    {
+        destFd = openat(destDirFd,
+                        leafPtr,
+                        O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                        S_IRUSR | S_IWUSR);
+    }
+    if (destFd == -1)
+    {
+        result = ((errno == EEXIST) || (errno == ENOENT) || (errno == ELOOP) || (errno == ENOTDIR)
+                  ? LE_FORMAT_ERROR : LE_FAULT);
+        LE_ERROR("Can't create '%s' (%m).", pathPtr);
+        goto cleanup;
+    }
+
+    char md5[MD5_STRING_BYTES];
+    result = ApplyPatch(patchPtr, patchStat.st_size, basePtr, baseStat.st_size, destFd, md5);
+    if (result == LE_FORMAT_ERROR)
+    {
+        LE_ERROR("Patch file '%s' for '%s' is corrupt.", patchNamePtr, pathPtr);
+    }
+    else if (result != LE_OK)
+    {
+        LE_ERROR("Can't write '%s' (%m).", pathPtr);
+    }
+    else if (strcmp(md5, md5Ptr) != 0)
+    {
+        LE_ERROR("Patched '%s' has MD5 hash %s; delta expects %s.", pathPtr, md5, md5Ptr);
+        result = LE_FORMAT_ERROR;
+    }
+    else if (fchmod(destFd, mode) != 0)
+    {
+        LE_ERROR("Can't set permissions of '%s' (%m).", pathPtr);
+        result = LE_FAULT;
+    }
+    else
+    {
+        countsPtr->patched++;
+    }
+
+cleanup:
+
+    if (destFd != -1)
+    {
+        if ((close(destFd) != 0) && (result == LE_OK))
+        {
+            LE_ERROR("Can't write '%s' (%m).", pathPtr);
+            result = LE_FAULT;
+        }
+    }
+    if (destDirFd != -1)
+    {
+        close(destDirFd);
+    }
+    if (patchPtr != NULL)
+    {
+        munmap((void*)patchPtr, patchStat.st_size);
+    }
+    if (basePtr != NULL)
+    {
+        munmap((void*)basePtr, baseStat.st_size);
+    }
+    if (patchFd != -1)
+    {
+        close(patchFd);
+    }
+    close(srcFd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split the next space-separated field off the front of a manifest line.
+ *
+ * @return The field, or NULL if there are no more fields.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* NextField
+(
+    char** linePtrPtr           ///< [IN,OUT] Rest of the line.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* fieldPtr = *linePtrPtr;
+    char* spacePtr = strchr(fieldPtr, ' ');
+
+    if (spacePtr == NULL)
+    {
+        return NULL;
+    }
+
+    *spacePtr = '\0';
+    *linePtrPtr = spacePtr + 1;
+    return fieldPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a string is an MD5 hash string.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsMd5
+(
+    const char* md5Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (strlen(md5Ptr) == MD5_STRING_BYTES - 1)
+            && (strspn(md5Ptr, "0123456789abcdef") == MD5_STRING_BYTES - 1) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do what one line of a manifest says.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyManifestLine
+(
+    int baseFd,                 ///< [IN] Top of the base tree.
+    int dirFd,                  ///< [IN] Top of the new tree.
+    int deltaDirFd,             ///< [IN] Directory holding the patch files.
+    char* linePtr,              ///< [IN] Manifest line, without the newline.  Is modified.
+    Counts_t* countsPtr         ///< [IN,OUT] What was done.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* kindPtr = NextField(&linePtr);
+    char* md5Ptr = NextField(&linePtr);
+
+    if ((kindPtr != NULL) && (md5Ptr != NULL) && IsMd5(md5Ptr))
+    {
+        if (strcmp(kindPtr, "link") == 0)
+        {
+            if (IsPathSafe(linePtr))
+            {
+                return LinkFile(baseFd, dirFd, md5Ptr, linePtr, countsPtr);
+            }
+        }
+        else if (strcmp(kindPtr, "patch") == 0)
+        {
+            char* modePtr = NextField(&linePtr);
+            char* patchNamePtr = NextField(&linePtr);
+            char* endPtr = NULL;
+            unsigned long mode = 0;
+
+            if (modePtr != NULL)
+            {
+                mode = strtoul(modePtr, &endPtr, 8);
+            }
+
+            if (   (patchNamePtr != NULL)
+                && (endPtr != modePtr) && (*endPtr == '\0') && (mode <= 07777)
+                && IsPathSafe(linePtr) )
+            {
+                return PatchFile(baseFd,
+                                 dirFd,
+                                 deltaDirFd,
+                                 md5Ptr,
+                                 mode,
+                                 patchNamePtr,
+                                 linePtr,
+                                 countsPtr);
+            }
+        }
+    }
+
+    LE_ERROR("Bad line in delta manifest.");
+    return LE_FORMAT_ERROR;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Go through a delta manifest.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyManifest
+(
+    int baseFd,                 ///< [IN] Top of the base tree.
+    int dirFd,                  ///< [IN] Top of the new tree.
+    Counts_t* countsPtr         ///< [IN,OUT] What was done.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int deltaDirFd = openat(dirFd, DELTA_DIR_NAME, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (deltaDirFd == -1)
+    {
+        LE_ERROR("Delta payload has no '%s' directory (%m).", DELTA_DIR_NAME);
+        return LE_FORMAT_ERROR;
+    }
+
+    int manifestFd = openat(deltaDirFd, "manifest", O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    FILE* manifestPtr = (manifestFd == -1) ? NULL : fdopen(manifestFd, "r");
+    if (manifestPtr == NULL)
+    {
+        LE_ERROR("Can't open delta manifest (%m).");
+        if (manifestFd != -1)
+        {
+            close(manifestFd);
+        }
+        close(deltaDirFd);
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    char line[MANIFEST_LINE_BYTES];
+    bool isFirstLine = true;
+
+    while (fgets(line, sizeof(line), manifestPtr) != NULL)
+    {
+        size_t len = strlen(line);
+        if ((len == 0) || (line[len - 1] != '\n'))
+        {
+            LE_ERROR("Delta manifest line too long or unterminated.");
+            result = LE_FORMAT_ERROR;
+            break;
+        }
+        line[len - 1] = '\0';
+
+        if (isFirstLine)
+        {
+            isFirstLine = false;
+            if (strcmp(line, MANIFEST_HEADER) != 0)
+            {
+                LE_ERROR("Unsupported delta manifest version '%s'.", line);
+                result = LE_FORMAT_ERROR;
+                break;
+            }
+        }
+        else
+        {
+            result = ApplyManifestLine(baseFd, dirFd, deltaDirFd, line, countsPtr);
+            if (result != LE_OK)
+            {
+                break;
+            }
+        }
+    }
+
+    if ((result == LE_OK) && (ferror(manifestPtr) || isFirstLine))
+    {
+        LE_ERROR("Can't read delta manifest.");
+        result = LE_FORMAT_ERROR;
+    }
+
+    fclose(manifestPtr);
+    close(deltaDirFd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete an unpacked delta payload using the files of the version it is based on.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FORMAT_ERROR if the delta is corrupt or doesn't match the base.
+ *  - LE_FAULT if something couldn't be read or written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_Apply
+(
+    const char* basePath,   ///< [IN] Directory holding the base version (e.g., /legato/apps/<md5>)
+    const char* dirPath     ///< [IN] Directory the delta payload was unpacked into.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int baseFd = open(basePath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (baseFd == -1)
+    {
+        LE_ERROR("Can't open delta base '%s' (%m).", basePath);
+        return LE_FORMAT_ERROR;
+    }
+
+    int dirFd = open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd == -1)
+    {
+        LE_ERROR("Can't open '%s' (%m).", dirPath);
+        close(baseFd);
+        return LE_FAULT;
+    }
+
+    Counts_t counts = { 0 };
+    le_result_t result = ApplyManifest(baseFd, dirFd, &counts);
+
+    close(dirFd);
+    close(baseFd);
+
+    if (result == LE_OK)
+    {
+        LE_INFO("Delta applied from '%s': %u files linked, %u copied, %u patched.",
+                basePath,
+                counts.linked,
+                counts.copied,
+                counts.patched);
+
+        char deltaDirPath[LIMIT_MAX_PATH_BYTES] = "";
+        if (   (le_path_Concat("/", deltaDirPath, sizeof(deltaDirPath),
+                               dirPath, DELTA_DIR_NAME, NULL) != LE_OK)
+            || (le_dir_RemoveRecursive(deltaDirPath) != LE_OK) )
+        {
+            LE_ERROR("Failed to remove '%s/%s'.", dirPath, DELTA_DIR_NAME);
+            result = LE_FAULT;
+        }
+    }
+
+    return result;
+}
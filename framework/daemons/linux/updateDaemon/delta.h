@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file delta.h
+ *
+ * Applying delta payloads.  A delta payload is an app or system tarball that only carries what
+ * changed since a "base" version that is already installed on the target.  It is unpacked like
+ * any other payload, and then delta_Apply() fills in the rest of the tree from the base:
+ *
+ *  - Files that didn't change are hard-linked from the base (or copied, if they can't be linked).
+ *  - Files that changed a little are rebuilt from the base file and a block-level patch.
+ *  - Files that aren't mentioned anywhere in the delta were deleted, so they are left out.
+ *
+ * What to do with each file is listed in a manifest inside the tarball, in DELTA_DIR_NAME
+ * "/manifest".  The first line is "legato-delta 1", and each following line is one of:
+ *
+ * @verbatim
+   link <md5> <path>
+   patch <md5> <mode> <patch-name> <path>
+   @endverbatim
+ *
+ * where \<path\> is relative to the top of the tree (and is the same in the base and the new
+ * tree), \<md5\> is the MD5 hash of the file's contents in the new tree, \<mode\> is the new
+ * file's permissions in octal, and \<patch-name\> is the name of the patch file in DELTA_DIR_NAME.
+ *
+ * A patch file is "LEDELTA1", the size of the new file as a 64-bit number, and then a series of
+ * operations, each starting with one byte:
+ *
+ *  - 1 (copy): a 64-bit offset in the base file and a 32-bit length.  Copy that many bytes from
+ *    that offset in the base file.
+ *  - 2 (data): a 32-bit length, followed by that many bytes to put in the new file.
+ *  - 0 (end): the end of the patch.
+ *
+ * All numbers are big-endian.  The delta directory is removed once the delta has been applied.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_UPDATE_DELTA_H_INCLUDE_GUARD
+#define LEGATO_UPDATE_DELTA_H_INCLUDE_GUARD
+
+
+/// Directory, at the top of an unpacked delta payload, that holds the manifest and patch files.
+#define DELTA_DIR_NAME ".legato-delta"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete an unpacked delta payload using the files of the version it is based on.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FORMAT_ERROR if the delta is corrupt or doesn't match the base.
+ *  - LE_FAULT if something couldn't be read or written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_Apply
+(
+    const char* basePath,   ///< [IN] Directory holding the base version (e.g., /legato/apps/<md5>)
+    const char* dirPath     ///< [IN] Directory the delta payload was unpacked into.
+);
+
+
+#endif // LEGATO_UPDATE_DELTA_H_INCLUDE_GUARD
@@ -0,0 +1,217 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file md5.c
+ *
+ * MD5 message digest, as described in RFC 1321.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "md5.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-round shift amounts.
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint8_t Shifts[64] =
+{
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-round constants: floor(abs(sin(i + 1)) * 2^32).
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint32_t Constants[64] =
+{
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash one 64-byte block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HashBlock
+(
+    md5_Context_t* contextPtr,
+    const uint8_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t words[16];
+    uint32_t a = contextPtr->state[0];
+    uint32_t b = contextPtr->state[1];
+    uint32_t c = contextPtr->state[2];
+    uint32_t d = contextPtr->state[3];
+    int i;
+
+    // The block is little-endian, whatever the byte order of the CPU.
+    for (i = 0; i < 16; i++)
+    {
+        words[i] = (uint32_t)blockPtr[i * 4] |
+                   ((uint32_t)blockPtr[i * 4 + 1] << 8) |
+                   ((uint32_t)blockPtr[i * 4 + 2] << 16) |
+                   ((uint32_t)blockPtr[i * 4 + 3] << 24);
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        uint32_t f;
+        int g;
+
+        if (i < 16)
+        {
+            f = (b & c) | (~b & d);
+            g = i;
+        }
+        else if (i < 32)
+        {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        }
+        else if (i < 48)
+        {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        }
+        else
+        {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        f += a + Constants[i] + words[g];
+        a = d;
+        d = c;
+        c = b;
+        b += (f << Shifts[i]) | (f >> (32 - Shifts[i]));
+    }
+
+    contextPtr->state[0] += a;
+    contextPtr->state[1] += b;
+    contextPtr->state[2] += c;
+    contextPtr->state[3] += d;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start computing a digest.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Init
+(
+    md5_Context_t* contextPtr   ///< [OUT] Digest computation.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    contextPtr->state[0] = 0x67452301;
+    contextPtr->state[1] = 0xefcdab89;
+    contextPtr->state[2] = 0x98badcfe;
+    contextPtr->state[3] = 0x10325476;
+    contextPtr->length = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add data to a digest.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Update
+(
+    md5_Context_t* contextPtr,  ///< [IN,OUT] Digest computation.
+    const void* dataPtr,        ///< [IN] Data.
+    size_t length               ///< [IN] Number of bytes of data.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+    size_t used = contextPtr->length % sizeof(contextPtr->block);
+
+    contextPtr->length += length;
+
+    // Fill up a partial block first.
+    if (used > 0)
+    {
+        size_t count = sizeof(contextPtr->block) - used;
+
+        if (count > length)
+        {
+            count = length;
+        }
+        memcpy(contextPtr->block + used, bytePtr, count);
+        bytePtr += count;
+        length -= count;
+
+        if (used + count < sizeof(contextPtr->block))
+        {
+            return;
+        }
+        HashBlock(contextPtr, contextPtr->block);
+    }
+
+    // Hash whole blocks straight from the data.
+    while (length >= sizeof(contextPtr->block))
+    {
+        HashBlock(contextPtr, bytePtr);
+        bytePtr += sizeof(contextPtr->block);
+        length -= sizeof(contextPtr->block);
+    }
+
+    memcpy(contextPtr->block, bytePtr, length);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish a digest and get it as a string of 32 lower-case hexadecimal digits.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Final
+(
+    md5_Context_t* contextPtr,          ///< [IN] Digest computation.  Can't be updated after this.
+    char md5Str[MD5_STRING_BYTES]       ///< [OUT] Digest string.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const uint8_t padding[64] = { 0x80 };
+    uint64_t bitLength = contextPtr->length * 8;
+    uint8_t lengthBytes[8];
+    size_t used = contextPtr->length % sizeof(contextPtr->block);
+    int i;
+
+    // Pad to 56 bytes into a block, then add the length in bits, little-endian.
+    md5_Update(contextPtr, padding, (used < 56) ? (56 - used) : (120 - used));
+
+    for (i = 0; i < 8; i++)
+    {
+        lengthBytes[i] = (uint8_t)(bitLength >> (i * 8));
+    }
+    md5_Update(contextPtr, lengthBytes, sizeof(lengthBytes));
+
+    for (i = 0; i < 16; i++)
+    {
+        uint8_t byte = (uint8_t)(contextPtr->state[i / 4] >> ((i % 4) * 8));
+
+        snprintf(md5Str + i * 2, 3, "%02x", byte);
+    }
+}
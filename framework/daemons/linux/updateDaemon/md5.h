@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file md5.h
+ *
+ * MD5 message digest (RFC 1321), used to check update pack payloads as they are read.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_UPDATE_MD5_H_INCLUDE_GUARD
+#define LEGATO_UPDATE_MD5_H_INCLUDE_GUARD
+
+
+/// An MD5 hash string is 32 characters long, plus a null terminator.
+#define MD5_STRING_BYTES 33
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of an MD5 digest computation.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t state[4];      ///< Intermediate hash value (A, B, C, D).
+    uint64_t length;        ///< Number of bytes hashed so far.
+    uint8_t block[64];      ///< Bytes of a block that hasn't been filled yet.
+}
+md5_Context_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start computing a digest.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Init
+(
+    md5_Context_t* contextPtr   ///< [OUT] Digest computation.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add data to a digest.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Update
+(
+    md5_Context_t* contextPtr,  ///< [IN,OUT] Digest computation.
+    const void* dataPtr,        ///< [IN] Data.
+    size_t length               ///< [IN] Number of bytes of data.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish a digest and get it as a string of 32 lower-case hexadecimal digits.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Final
+(
+    md5_Context_t* contextPtr,          ///< [IN] Digest computation.  Can't be updated after this.
+    char md5Str[MD5_STRING_BYTES]       ///< [OUT] Digest string.
+);
+
+
+#endif // LEGATO_UPDATE_MD5_H_INCLUDE_GUARD
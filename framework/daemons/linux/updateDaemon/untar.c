@@ -0,0 +1,1547 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file untar.c
+ *
+ * In-process, streaming extraction of update pack tarballs.
+ *
+ * Each piece of the tarball passed to untar_Write() goes through the decompressor into a buffer
+ * on the stack, and from there straight into the files being extracted, so nothing is ever
+ * buffered beyond one block of the decompressed stream.  The tar stream is parsed by a state
+ * machine that alternates between collecting a 512-byte header block and copying (or skipping)
+ * the contents that follow it.
+ *
+ * Supported tar formats are POSIX ustar, GNU (long names and long link names), and pax (path,
+ * linkpath, size and SCHILY.xattr records).  Sparse and multi-volume archives are not supported.
+ *
+ * Everything is created relative to a file descriptor for the destination directory.  The
+ * directory part of each entry's path is walked one component at a time without following
+ * symbolic links, so nothing can be written outside the destination directory, even through a
+ * symbolic link extracted earlier.  The last directory walked is kept open, because consecutive
+ * tarball entries are almost always in the same directory.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "untar.h"
+
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#include <bzlib.h>
+#if LE_CONFIG_UPDATE_PACK_LZ4
+#   include <lz4frame.h>
+#endif
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+#   include <zstd.h>
+#endif
+
+
+/// Size of a tar block.  Headers are one block long and contents are padded to a whole block.
+#define BLOCK_BYTES 512
+
+/// Size of the buffer that decompressed data is written into before it is extracted.
+#define OUTPUT_BUFFER_BYTES (32 * 1024)
+
+/// Largest pax extended header that will be accepted.
+#define PAX_MAX_BYTES 8192
+
+/// Most extended attributes that will be restored on one file.
+#define MAX_XATTRS 16
+
+/// Prefix of the pax record keys that carry extended attributes.
+#define PAX_XATTR_PREFIX "SCHILY.xattr."
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offsets and lengths of the fields in a tar header block.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HDR_NAME        0
+#define HDR_NAME_LEN    100
+#define HDR_MODE        100
+#define HDR_MODE_LEN    8
+#define HDR_SIZE        124
+#define HDR_SIZE_LEN    12
+#define HDR_CHKSUM      148
+#define HDR_CHKSUM_LEN  8
+#define HDR_TYPEFLAG    156
+#define HDR_LINKNAME    157
+#define HDR_LINKNAME_LEN 100
+#define HDR_MAGIC       257
+#define HDR_DEVMAJOR    329
+#define HDR_DEVMINOR    337
+#define HDR_DEV_LEN     8
+#define HDR_PREFIX      345
+#define HDR_PREFIX_LEN  155
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compression formats.  COMPRESSION_UNKNOWN until the first four bytes have been seen.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    COMPRESSION_UNKNOWN,
+    COMPRESSION_NONE,
+    COMPRESSION_BZIP2,
+    COMPRESSION_LZ4,
+    COMPRESSION_ZSTD
+}
+Compression_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Where the contents of the current tarball entry go.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    DEST_SKIP,          ///< Nowhere.
+    DEST_FILE,          ///< The regular file being extracted (fileFd).
+    DEST_BUFFER         ///< A metadata buffer (long name, long link name, or pax header).
+}
+Destination_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extended attribute found in a pax header, to be set on the entry that follows it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;        ///< Attribute name (points into the pax buffer).
+    const char* valuePtr;       ///< Attribute value (points into the pax buffer).
+    size_t valueSize;           ///< Attribute value size (bytes).
+}
+Xattr_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A tarball extraction.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct untar_Extraction
+{
+    int dirFd;                  ///< Destination directory.
+    int parentFd;               ///< Last directory walked to (-1 if none).
+    char parentPath[LIMIT_MAX_PATH_BYTES];  ///< Path of parentFd, relative to dirFd.
+
+    Compression_t compression;  ///< Compression format.
+    uint8_t magic[4];           ///< First bytes of the tarball, while detecting the format.
+    size_t magicLen;            ///< Number of bytes in magic.
+    bool isStreamEnd;           ///< true if the decompressor has just finished a stream.
+    bz_stream bzStream;         ///< bzip2 decompressor.
+#if LE_CONFIG_UPDATE_PACK_LZ4
+    LZ4F_dctx* lz4CtxPtr;       ///< LZ4 frame decompressor.
+#endif
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+    ZSTD_DStream* zstdStreamPtr;    ///< zstd decompressor.
+#endif
+
+    bool isEnd;                 ///< true once the end-of-archive blocks have been seen.
+    size_t zeroBlocks;          ///< Number of consecutive all-zero header blocks.
+    uint8_t block[BLOCK_BYTES]; ///< Header block being collected.
+    size_t blockUsed;           ///< Number of bytes in block.
+    uint64_t contentsLeft;      ///< Bytes of the current entry's contents not yet seen.
+    size_t paddingLeft;         ///< Bytes of padding after the contents not yet seen.
+
+    char typeflag;              ///< Type of the current entry.
+    mode_t mode;                ///< Permissions of the current entry.
+    Destination_t dest;         ///< Where the current entry's contents go.
+    int fileFd;                 ///< Regular file being extracted (-1 if none).
+    char* bufferPtr;            ///< Metadata buffer the contents are being collected into.
+    size_t bufferUsed;          ///< Number of bytes collected into bufferPtr.
+    char path[LIMIT_MAX_PATH_BYTES];    ///< Path of the current entry (for opening and errors).
+
+    bool hasLongName;           ///< true if longName overrides the next header's name.
+    char longName[LIMIT_MAX_PATH_BYTES];
+    bool hasLongLink;           ///< true if longLink overrides the next header's link name.
+    char longLink[LIMIT_MAX_PATH_BYTES];
+    bool hasPaxSize;            ///< true if paxSize overrides the next header's size.
+    uint64_t paxSize;
+    size_t xattrCount;          ///< Number of extended attributes for the next entry.
+    Xattr_t xattrs[MAX_XATTRS];
+    char pax[PAX_MAX_BYTES];    ///< Contents of the last pax header.
+}
+Extraction_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which extractions are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ExtractionPool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a numeric header field.  These are octal, terminated by a space or null, except that
+ * GNU tar and bsdtar store values that don't fit as big-endian base-256, flagged by setting the
+ * top bit of the first byte.
+ *
+ * @return LE_OK or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseNumber
+(
+    const uint8_t* fieldPtr,
+    size_t fieldLen,
+    uint64_t* valuePtr          ///< [OUT]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t value = 0;
+    size_t i = 0;
+
+    if (fieldPtr[0] & 0x80)
+    {
+        // Negative numbers aren't valid for any field we use.
+        if (fieldPtr[0] & 0x40)
+        {
+            return LE_FORMAT_ERROR;
+        }
+        value = fieldPtr[0] & 0x3f;
+        for (i = 1; i < fieldLen; i++)
+        {
+            if (value >> 56)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            value = (value << 8) | fieldPtr[i];
+        }
+    }
+    else
+    {
+        while ((i < fieldLen) && (fieldPtr[i] == ' '))
+        {
+            i++;
+        }
+        for (; (i < fieldLen) && (fieldPtr[i] != ' ') && (fieldPtr[i] != '\0'); i++)
+        {
+            if ((fieldPtr[i] < '0') || (fieldPtr[i] > '7'))
+            {
+                return LE_FORMAT_ERROR;
+            }
+            value = (value << 3) | (fieldPtr[i] - '0');
+        }
+    }
+
+    *valuePtr = value;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a header block's checksum.  Historically some tars summed signed chars, so either sum
+ * is accepted.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsChecksumValid
+(
+    const uint8_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t expected;
+    if (ParseNumber(blockPtr + HDR_CHKSUM, HDR_CHKSUM_LEN, &expected) != LE_OK)
+    {
+        return false;
+    }
+
+    uint64_t unsignedSum = ' ' * HDR_CHKSUM_LEN;
+    int64_t signedSum = ' ' * HDR_CHKSUM_LEN;
+    size_t i;
+    for (i = 0; i < BLOCK_BYTES; i++)
+    {
+        if ((i < HDR_CHKSUM) || (i >= HDR_CHKSUM + HDR_CHKSUM_LEN))
+        {
+            unsignedSum += blockPtr[i];
+            signedSum += (int8_t)blockPtr[i];
+        }
+    }
+
+    return (expected == unsignedSum) || ((int64_t)expected == signedSum);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn a path from the tarball into one relative to the destination directory.  Leading slashes
+ * and "./" are dropped, as are trailing slashes.  The destination directory itself becomes "".
+ *
+ * @return The relative path (points into pathPtr), or NULL if the path has a ".." component.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* MakeRelative
+(
+    char* pathPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        if (pathPtr[0] == '/')
+        {
+            pathPtr++;
+        }
+        else if ((pathPtr[0] == '.') && (pathPtr[1] == '/'))
+        {
+            pathPtr += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (strcmp(pathPtr, ".") == 0)
+    {
+        pathPtr[0] = '\0';
+    }
+
+    size_t len = strlen(pathPtr);
+    while ((len > 0) && (pathPtr[len - 1] == '/'))
+    {
+        pathPtr[--len] = '\0';
+    }
+
+    const char* componentPtr = pathPtr;
+    while (componentPtr != NULL)
+    {
+        if (   (componentPtr[0] == '.') && (componentPtr[1] == '.')
+            && ((componentPtr[2] == '/') || (componentPtr[2] == '\0')) )
+        {
+            return NULL;
+        }
+        componentPtr = strchr(componentPtr, '/');
+        if (componentPtr != NULL)
+        {
+            componentPtr++;
+        }
+    }
+
+    return pathPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a directory inside the destination directory, creating any missing directories on the
+ * way, and refusing to follow symbolic links.
+ *
+ * @return An open directory file descriptor, or -1 on failure (errno set; ELOOP or ENOTDIR if
+ *         the path goes through something that isn't a directory).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenDir
+(
+    Extraction_t* extPtr,
+    const char* dirPath         ///< Path relative to the destination directory.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    LE_ASSERT(le_utf8_Copy(path, dirPath, sizeof(path), NULL) == LE_OK);
+
+    int fd = dup(extPtr->dirFd);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    char* savePtr = NULL;
+    char* componentPtr;
+    for (componentPtr = strtok_r(path, "/", &savePtr);
+         componentPtr != NULL;
+         componentPtr = strtok_r(NULL, "/", &savePtr))
+    {
+        int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+        int nextFd = openat(fd, componentPtr, flags);
+        if ((nextFd == -1) && (errno == ENOENT))
+        {
+            if ((mkdirat(fd, componentPtr, 0755) == 0) || (errno == EEXIST))
+            {
+                nextFd = openat(fd, componentPtr, flags);
+            }
+        }
+
+        int savedErrno = errno;
+        close(fd);
+        if (nextFd == -1)
+        {
+            errno = savedErrno;
+            return -1;
+        }
+        fd = nextFd;
+    }
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the directory that an entry is in.
+ *
+ * @return A file descriptor for the directory, owned by the extraction (don't close it), or -1
+ *         on failure (an error has been logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static int GetParentDir
+(
+    Extraction_t* extPtr,
+    const char* pathPtr,        ///< [IN] Entry path, relative to the destination directory.
+    const char** leafPtrPtr     ///< [OUT] Last component of the path.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* slashPtr = strrchr(pathPtr, '/');
+    if (slashPtr == NULL)
+    {
+        *leafPtrPtr = pathPtr;
+        return extPtr->dirFd;
+    }
+    *leafPtrPtr = slashPtr + 1;
+
+    size_t dirLen = slashPtr - pathPtr;
+    if (   (extPtr->parentFd != -1)
+        && (strncmp(extPtr->parentPath, pathPtr, dirLen) == 0)
+        && (extPtr->parentPath[dirLen] == '\0') )
+    {
+        return extPtr->parentFd;
+    }
+
+    if (extPtr->parentFd != -1)
+    {
+        close(extPtr->parentFd);
+        extPtr->parentFd = -1;
+    }
+
+    memcpy(extPtr->parentPath, pathPtr, dirLen);
+    extPtr->parentPath[dirLen] = '\0';
+
+    extPtr->parentFd = OpenDir(extPtr, extPtr->parentPath);
+    if (extPtr->parentFd == -1)
+    {
+        int savedErrno = errno;
+        LE_ERROR("Can't open directory '%s' in tarball (%m).", extPtr->parentPath);
+        errno = savedErrno;
+    }
+    return extPtr->parentFd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the current entry's permissions and extended attributes on an open file or directory.
+ *
+ * @return LE_OK or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SetAttributes
+(
+    Extraction_t* extPtr,
+    int fd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (fchmod(fd, extPtr->mode) == -1)
+    {
+        LE_ERROR("Failed to set permissions of '%s' (%m).", extPtr->path);
+        return LE_FAULT;
+    }
+
+    size_t i;
+    for (i = 0; i < extPtr->xattrCount; i++)
+    {
+        const Xattr_t* xattrPtr = &extPtr->xattrs[i];
+        if (fsetxattr(fd, xattrPtr->namePtr, xattrPtr->valuePtr, xattrPtr->valueSize, 0) == -1)
+        {
+            LE_ERROR("Failed to set extended attribute '%s' of '%s' (%m).",
+                     xattrPtr->namePtr,
+                     extPtr->path);
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the records of a pax extended header ("<length> <key>=<value>\n").  The ones that matter
+ * here are kept to override the fields of the next header.
+ *
+ * @return LE_OK or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParsePax
+(
+    Extraction_t* extPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* recordPtr = extPtr->pax;
+    char* endPtr = extPtr->pax + extPtr->bufferUsed;
+
+    extPtr->xattrCount = 0;
+
+    while (recordPtr < endPtr)
+    {
+        size_t recordLen = 0;
+        char* keyPtr = recordPtr;
+        while ((keyPtr < endPtr) && isdigit((unsigned char)*keyPtr))
+        {
+            recordLen = recordLen * 10 + (*keyPtr - '0');
+            if (recordLen > PAX_MAX_BYTES)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            keyPtr++;
+        }
+        char* recordEndPtr = recordPtr + recordLen;
+        if (   (keyPtr >= endPtr) || (*keyPtr != ' ') || (recordEndPtr > endPtr)
+            || (recordEndPtr <= keyPtr + 1) || (recordEndPtr[-1] != '\n') )
+        {
+            return LE_FORMAT_ERROR;
+        }
+        keyPtr++;
+
+        char* equalsPtr = memchr(keyPtr, '=', recordEndPtr - keyPtr);
+        if (equalsPtr == NULL)
+        {
+            return LE_FORMAT_ERROR;
+        }
+        *equalsPtr = '\0';
+        char* valuePtr = equalsPtr + 1;
+        size_t valueSize = (recordEndPtr - 1) - valuePtr;
+
+        if ((strcmp(keyPtr, "path") == 0) || (strcmp(keyPtr, "linkpath") == 0))
+        {
+            bool isPath = (keyPtr[0] == 'p');
+            char* destPtr = isPath ? extPtr->longName : extPtr->longLink;
+            if (valueSize >= LIMIT_MAX_PATH_BYTES)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            memcpy(destPtr, valuePtr, valueSize);
+            destPtr[valueSize] = '\0';
+            if (isPath)
+            {
+                extPtr->hasLongName = true;
+            }
+            else
+            {
+                extPtr->hasLongLink = true;
+            }
+        }
+        else if (strcmp(keyPtr, "size") == 0)
+        {
+            uint64_t size = 0;
+            char* digitPtr;
+            for (digitPtr = valuePtr; digitPtr < recordEndPtr - 1; digitPtr++)
+            {
+                if (!isdigit((unsigned char)*digitPtr) || (size > (UINT64_MAX / 10) - 10))
+                {
+                    return LE_FORMAT_ERROR;
+                }
+                size = size * 10 + (*digitPtr - '0');
+            }
+            extPtr->paxSize = size;
+            extPtr->hasPaxSize = true;
+        }
+        else if (strncmp(keyPtr, PAX_XATTR_PREFIX, sizeof(PAX_XATTR_PREFIX) - 1) == 0)
+        {
+            if (extPtr->xattrCount >= MAX_XATTRS)
+            {
+                LE_ERROR("Too many extended attributes in tarball.");
+                return LE_FORMAT_ERROR;
+            }
+            Xattr_t* xattrPtr = &extPtr->xattrs[extPtr->xattrCount++];
+            xattrPtr->namePtr = keyPtr + sizeof(PAX_XATTR_PREFIX) - 1;
+            xattrPtr->valuePtr = valuePtr;
+            xattrPtr->valueSize = valueSize;
+        }
+
+        recordPtr = recordEndPtr;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish the current entry, once all its contents have been seen.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t EndEntry
+(
+    Extraction_t* extPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+
+    switch (extPtr->typeflag)
+    {
+        case 'L':
+            extPtr->longName[extPtr->bufferUsed] = '\0';
+            extPtr->hasLongName = true;
+            // Skip clearing the overrides; they're for the next entry.
+            return LE_OK;
+
+        case 'K':
+            extPtr->longLink[extPtr->bufferUsed] = '\0';
+            extPtr->hasLongLink = true;
+            return LE_OK;
+
+        case 'x':
+            return ParsePax(extPtr);
+
+        case 'g':
+            return LE_OK;
+
+        case '5':
+        {
+            const char* leafPtr;
+            int dirFd = extPtr->dirFd;
+            if (extPtr->path[0] != '\0')
+            {
+                dirFd = GetParentDir(extPtr, extPtr->path, &leafPtr);
+                if (dirFd != -1)
+                {
+                    dirFd = openat(dirFd, leafPtr, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                }
+                if (dirFd == -1)
+                {
+                    LE_ERROR("Can't open directory '%s' (%m).", extPtr->path);
+                    result = LE_FAULT;
+                    break;
+                }
+            }
+            result = SetAttributes(extPtr, dirFd);
+            if (dirFd != extPtr->dirFd)
+            {
+                close(dirFd);
+            }
+            break;
+        }
+
+        default:
+            if (extPtr->fileFd != -1)
+            {
+                result = SetAttributes(extPtr, extPtr->fileFd);
+                if (close(extPtr->fileFd) == -1)
+                {
+                    LE_ERROR("Failed to close '%s' (%m).", extPtr->path);
+                    result = LE_FAULT;
+                }
+                extPtr->fileFd = -1;
+            }
+            break;
+    }
+
+    extPtr->hasLongName = false;
+    extPtr->hasLongLink = false;
+    extPtr->hasPaxSize = false;
+    extPtr->xattrCount = 0;
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the file system object for an entry.  Regular files are left open to receive their
+ * contents.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateEntry
+(
+    Extraction_t* extPtr,
+    const char* pathPtr,        ///< Relative path of the entry.
+    const char* linkPtr         ///< Link target (from the header or long link name).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* leafPtr;
+    int parentFd = GetParentDir(extPtr, pathPtr, &leafPtr);
+    if (parentFd == -1)
+    {
+        return (errno == ELOOP || errno == ENOTDIR) ? LE_FORMAT_ERROR : LE_FAULT;
+    }
+
+    // Directories are merged with what's there; anything else replaces it.
+    if (extPtr->typeflag == '5')
+    {
+        if ((mkdirat(parentFd, leafPtr, 0700) == -1) && (errno != EEXIST))
+        {
+            LE_ERROR("Failed to create directory '%s' (%m).", pathPtr);
+            return LE_FAULT;
+        }
+        return LE_OK;
+    }
+
+    if ((unlinkat(parentFd, leafPtr, 0) == -1) && (errno != ENOENT))
+    {
+        LE_ERROR("Failed to replace '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    int result = 0;
+    switch (extPtr->typeflag)
+    {
+        case '1':
+        {
+            char target[LIMIT_MAX_PATH_BYTES];
+            LE_ASSERT(le_utf8_Copy(target, linkPtr, sizeof(target), NULL) == LE_OK);
+            char* targetPtr = MakeRelative(target);
+            if ((targetPtr == NULL) || (targetPtr[0] == '\0'))
+            {
+                LE_ERROR("Invalid hard link target '%s' in tarball.", linkPtr);
+                return LE_FORMAT_ERROR;
+            }
+
+            // The target is usually in another directory, so don't disturb the cached one.
+            const char* targetLeafPtr = strrchr(targetPtr, '/');
+            int targetDirFd = extPtr->dirFd;
+            if (targetLeafPtr == NULL)
+            {
+                targetLeafPtr = targetPtr;
+            }
+            else
+            {
+                *(char*)targetLeafPtr = '\0';
+                targetLeafPtr++;
+                targetDirFd = OpenDir(extPtr, targetPtr);
+                if (targetDirFd == -1)
+                {
+                    LE_ERROR("Can't open directory '%s' in tarball (%m).", targetPtr);
+                    return LE_FORMAT_ERROR;
+                }
+            }
+            result = linkat(targetDirFd, targetLeafPtr, parentFd, leafPtr, 0);
+            if (targetDirFd != extPtr->dirFd)
+            {
+                int savedErrno = errno;
+                close(targetDirFd);
+                errno = savedErrno;
+            }
+            break;
+        }
+
+        case '2':
+            result = symlinkat(linkPtr, parentFd, leafPtr);
+            break;
+
+        case '3':
+        case '4':
+        case '6':
+        {
+            uint64_t major;
+            uint64_t minor;
+            if (   (ParseNumber(extPtr->block + HDR_DEVMAJOR, HDR_DEV_LEN, &major) != LE_OK)
+                || (ParseNumber(extPtr->block + HDR_DEVMINOR, HDR_DEV_LEN, &minor) != LE_OK) )
+            {
+                LE_ERROR("Invalid device number for '%s' in tarball.", pathPtr);
+                return LE_FORMAT_ERROR;
+            }
+            mode_t type = (extPtr->typeflag == '3') ? S_IFCHR :
+                          (extPtr->typeflag == '4') ? S_IFBLK : S_IFIFO;
+            result = mknodat(parentFd, leafPtr, type | extPtr->mode, makedev(major, minor));
+            if (result == 0)
+            {
+                // mknod() is subject to the umask, so set the permissions again.
+                result = fchmodat(parentFd, leafPtr, extPtr->mode, 0);
+            }
+            break;
+        }
+
+        default:
+            extPtr->fileFd = openat(parentFd,
+                                    leafPtr,
+                                    O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                                    S_IRUSR | S_IWUSR);
+            if (extPtr->fileFd == -1)
+            {
+                result = -1;
+            }
+            else
+            {
+                extPtr->dest = DEST_FILE;
+            }
+            break;
+    }
+
+    if (result == -1)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process a header block.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ProcessHeader
+(
+    Extraction_t* extPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* blockPtr = extPtr->block;
+
+    // The archive ends with two blocks of zeros.
+    size_t i;
+    for (i = 0; (i < BLOCK_BYTES) && (blockPtr[i] == 0); i++)
+    {
+    }
+    if (i == BLOCK_BYTES)
+    {
+        extPtr->zeroBlocks++;
+        if (extPtr->zeroBlocks == 2)
+        {
+            extPtr->isEnd = true;
+        }
+        return LE_OK;
+    }
+    if (extPtr->zeroBlocks != 0)
+    {
+        LE_ERROR("Tarball has an entry after an end-of-archive block.");
+        return LE_FORMAT_ERROR;
+    }
+
+    if (memcmp(blockPtr + HDR_MAGIC, "ustar", 5) != 0)
+    {
+        LE_ERROR("Tarball isn't in ustar format.");
+        return LE_FORMAT_ERROR;
+    }
+    if (!IsChecksumValid(blockPtr))
+    {
+        LE_ERROR("Tarball header checksum mismatch.");
+        return LE_FORMAT_ERROR;
+    }
+
+    uint64_t size;
+    uint64_t mode;
+    if (   (ParseNumber(blockPtr + HDR_SIZE, HDR_SIZE_LEN, &size) != LE_OK)
+        || (ParseNumber(blockPtr + HDR_MODE, HDR_MODE_LEN, &mode) != LE_OK) )
+    {
+        LE_ERROR("Invalid number in tarball header.");
+        return LE_FORMAT_ERROR;
+    }
+    if (extPtr->hasPaxSize)
+    {
+        size = extPtr->paxSize;
+    }
+
+    extPtr->typeflag = (char)blockPtr[HDR_TYPEFLAG];
+    extPtr->mode = mode & 07777;
+    extPtr->dest = DEST_SKIP;
+    extPtr->bufferUsed = 0;
+    extPtr->contentsLeft = size;
+    extPtr->paddingLeft = (BLOCK_BYTES - (size % BLOCK_BYTES)) % BLOCK_BYTES;
+
+    le_result_t result = LE_OK;
+
+    switch (extPtr->typeflag)
+    {
+        case 'L':
+        case 'K':
+            if (size >= LIMIT_MAX_PATH_BYTES)
+            {
+                LE_ERROR("Path in tarball is too long.");
+                return LE_FORMAT_ERROR;
+            }
+            extPtr->dest = DEST_BUFFER;
+            extPtr->bufferPtr = (extPtr->typeflag == 'L') ? extPtr->longName : extPtr->longLink;
+            break;
+
+        case 'x':
+            if (size > PAX_MAX_BYTES)
+            {
+                LE_ERROR("Extended header in tarball is too long.");
+                return LE_FORMAT_ERROR;
+            }
+            extPtr->dest = DEST_BUFFER;
+            extPtr->bufferPtr = extPtr->pax;
+            break;
+
+        case 'g':
+            // Global pax headers only carry things that aren't restored (e.g., comments).
+            break;
+
+        case 'S':
+        case 'M':
+            LE_ERROR("Unsupported entry type '%c' in tarball.", extPtr->typeflag);
+            return LE_FORMAT_ERROR;
+
+        default:
+        {
+            // Figure out the path.  POSIX ustar splits long paths into a prefix and a name, but
+            // GNU tar uses the prefix field for other things.
+            char* pathPtr = extPtr->path;
+            if (extPtr->hasLongName)
+            {
+                LE_ASSERT(le_utf8_Copy(pathPtr, extPtr->longName, LIMIT_MAX_PATH_BYTES, NULL)
+                          == LE_OK);
+            }
+            else
+            {
+                size_t len = 0;
+                if ((blockPtr[HDR_MAGIC + 5] == '\0') && (blockPtr[HDR_PREFIX] != '\0'))
+                {
+                    len = strnlen((const char*)blockPtr + HDR_PREFIX, HDR_PREFIX_LEN);
+                    memcpy(pathPtr, blockPtr + HDR_PREFIX, len);
+                    pathPtr[len++] = '/';
+                }
+                size_t nameLen = strnlen((const char*)blockPtr + HDR_NAME, HDR_NAME_LEN);
+                memcpy(pathPtr + len, blockPtr + HDR_NAME, nameLen);
+                pathPtr[len + nameLen] = '\0';
+            }
+
+            char link[HDR_LINKNAME_LEN + 1];
+            const char* linkPtr = extPtr->longLink;
+            if (!extPtr->hasLongLink)
+            {
+                size_t linkLen = strnlen((const char*)blockPtr + HDR_LINKNAME, HDR_LINKNAME_LEN);
+                memcpy(link, blockPtr + HDR_LINKNAME, linkLen);
+                link[linkLen] = '\0';
+                linkPtr = link;
+            }
+
+            pathPtr = MakeRelative(pathPtr);
+            if (pathPtr == NULL)
+            {
+                LE_ERROR("Tarball entry '%s' is outside the destination.", extPtr->path);
+                return LE_FORMAT_ERROR;
+            }
+            memmove(extPtr->path, pathPtr, strlen(pathPtr) + 1);
+
+            // Only the destination directory itself can have an empty path.
+            if (extPtr->path[0] == '\0')
+            {
+                if (extPtr->typeflag != '5')
+                {
+                    LE_ERROR("Tarball entry has no name.");
+                    return LE_FORMAT_ERROR;
+                }
+            }
+            else
+            {
+                switch (extPtr->typeflag)
+                {
+                    case '0':
+                    case '\0':
+                    case '1':
+                    case '2':
+                    case '3':
+                    case '4':
+                    case '5':
+                    case '6':
+                    case '7':
+                        break;
+
+                    default:
+                        LE_WARN("Extracting '%s' of unknown type '%c' as a regular file.",
+                                extPtr->path,
+                                extPtr->typeflag);
+                        break;
+                }
+                result = CreateEntry(extPtr, extPtr->path, linkPtr);
+            }
+            break;
+        }
+    }
+
+    if ((result == LE_OK) && (extPtr->contentsLeft == 0))
+    {
+        result = EndEntry(extPtr);
+    }
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store some of the current entry's contents.
+ *
+ * @return LE_OK or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StoreContents
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (extPtr->dest)
+    {
+        case DEST_SKIP:
+            break;
+
+        case DEST_BUFFER:
+            memcpy(extPtr->bufferPtr + extPtr->bufferUsed, dataPtr, length);
+            extPtr->bufferUsed += length;
+            break;
+
+        case DEST_FILE:
+            while (length > 0)
+            {
+                ssize_t written = write(extPtr->fileFd, dataPtr, length);
+                if (written == -1)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    LE_ERROR("Failed to write '%s' (%m).", extPtr->path);
+                    return LE_FAULT;
+                }
+                dataPtr += written;
+                length -= written;
+            }
+            break;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract the next piece of the uncompressed tar stream.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ProcessTar
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+
+    while ((length > 0) && (result == LE_OK))
+    {
+        size_t count;
+
+        if (extPtr->isEnd)
+        {
+            // Ignore the zeros that pad the archive out to a whole record.
+            break;
+        }
+        else if (extPtr->contentsLeft > 0)
+        {
+            count = (length < extPtr->contentsLeft) ? length : extPtr->contentsLeft;
+            result = StoreContents(extPtr, dataPtr, count);
+            extPtr->contentsLeft -= count;
+            if ((result == LE_OK) && (extPtr->contentsLeft == 0))
+            {
+                result = EndEntry(extPtr);
+            }
+        }
+        else if (extPtr->paddingLeft > 0)
+        {
+            count = (length < extPtr->paddingLeft) ? length : extPtr->paddingLeft;
+            extPtr->paddingLeft -= count;
+        }
+        else
+        {
+            count = BLOCK_BYTES - extPtr->blockUsed;
+            if (count > length)
+            {
+                count = length;
+            }
+            memcpy(extPtr->block + extPtr->blockUsed, dataPtr, count);
+            extPtr->blockUsed += count;
+            if (extPtr->blockUsed == BLOCK_BYTES)
+            {
+                extPtr->blockUsed = 0;
+                result = ProcessHeader(extPtr);
+            }
+        }
+
+        dataPtr += count;
+        length -= count;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompress a piece of a bzip2 tarball.  A tarball can be several bzip2 streams one after the
+ * other (as made by parallel bzip2 implementations).
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DecompressBzip2
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t buffer[OUTPUT_BUFFER_BYTES];
+    bz_stream* streamPtr = &extPtr->bzStream;
+
+    streamPtr->next_in = (char*)dataPtr;
+    streamPtr->avail_in = length;
+
+    do
+    {
+        if (extPtr->isStreamEnd)
+        {
+            BZ2_bzDecompressEnd(streamPtr);
+            if (BZ2_bzDecompressInit(streamPtr, 0, 0) != BZ_OK)
+            {
+                LE_ERROR("Failed to restart bzip2 decompressor.");
+                return LE_FAULT;
+            }
+            extPtr->isStreamEnd = false;
+        }
+
+        streamPtr->next_out = (char*)buffer;
+        streamPtr->avail_out = sizeof(buffer);
+
+        int bzResult = BZ2_bzDecompress(streamPtr);
+        if ((bzResult != BZ_OK) && (bzResult != BZ_STREAM_END))
+        {
+            LE_ERROR("Corrupt bzip2 data in tarball (error %d).", bzResult);
+            return LE_FORMAT_ERROR;
+        }
+
+        le_result_t result = ProcessTar(extPtr, buffer, sizeof(buffer) - streamPtr->avail_out);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        extPtr->isStreamEnd = (bzResult == BZ_STREAM_END);
+    }
+    while (   (streamPtr->avail_in > 0)
+           || ((streamPtr->avail_out == 0) && !extPtr->isStreamEnd) );
+
+    return LE_OK;
+}
+
+
+#if LE_CONFIG_UPDATE_PACK_LZ4
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompress a piece of an LZ4 frame tarball.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DecompressLz4
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t buffer[OUTPUT_BUFFER_BYTES];
+    size_t outSize;
+
+    do
+    {
+        size_t inSize = length;
+        outSize = sizeof(buffer);
+
+        size_t lz4Result = LZ4F_decompress(extPtr->lz4CtxPtr,
+                                           buffer, &outSize,
+                                           dataPtr, &inSize,
+                                           NULL);
+        if (LZ4F_isError(lz4Result))
+        {
+            LE_ERROR("Corrupt LZ4 data in tarball (%s).", LZ4F_getErrorName(lz4Result));
+            return LE_FORMAT_ERROR;
+        }
+        dataPtr += inSize;
+        length -= inSize;
+
+        // A call that did nothing says nothing about where the frame ends.
+        if ((inSize > 0) || (outSize > 0))
+        {
+            extPtr->isStreamEnd = (lz4Result == 0);
+        }
+
+        le_result_t result = ProcessTar(extPtr, buffer, outSize);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+    while ((length > 0) || (outSize == sizeof(buffer)));
+
+    return LE_OK;
+}
+#endif
+
+
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompress a piece of a zstd tarball.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DecompressZstd
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t buffer[OUTPUT_BUFFER_BYTES];
+    ZSTD_inBuffer in = { dataPtr, length, 0 };
+    ZSTD_outBuffer out;
+
+    do
+    {
+        size_t inPos = in.pos;
+        out.dst = buffer;
+        out.size = sizeof(buffer);
+        out.pos = 0;
+
+        size_t zstdResult = ZSTD_decompressStream(extPtr->zstdStreamPtr, &out, &in);
+        if (ZSTD_isError(zstdResult))
+        {
+            LE_ERROR("Corrupt zstd data in tarball (%s).", ZSTD_getErrorName(zstdResult));
+            return LE_FORMAT_ERROR;
+        }
+
+        // A call that did nothing says nothing about where the frame ends.
+        if ((in.pos > inPos) || (out.pos > 0))
+        {
+            extPtr->isStreamEnd = (zstdResult == 0);
+        }
+
+        le_result_t result = ProcessTar(extPtr, buffer, out.pos);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+    while ((in.pos < in.size) || (out.pos == out.size));
+
+    return LE_OK;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Feed data through the decompressor to the tar stream parser.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Decompress
+(
+    Extraction_t* extPtr,
+    const uint8_t* dataPtr,
+    size_t length
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (extPtr->compression)
+    {
+        case COMPRESSION_NONE:
+            return ProcessTar(extPtr, dataPtr, length);
+
+        case COMPRESSION_BZIP2:
+            return DecompressBzip2(extPtr, dataPtr, length);
+
+#if LE_CONFIG_UPDATE_PACK_LZ4
+        case COMPRESSION_LZ4:
+            return DecompressLz4(extPtr, dataPtr, length);
+#endif
+
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+        case COMPRESSION_ZSTD:
+            return DecompressZstd(extPtr, dataPtr, length);
+#endif
+
+        default:
+            break;
+    }
+
+    LE_FATAL("Unexpected compression %d.", extPtr->compression);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work out the compression format from the first four bytes of the tarball, and start the
+ * decompressor.
+ *
+ * @return LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartDecompressor
+(
+    Extraction_t* extPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const uint8_t bzip2Magic[] = { 'B', 'Z', 'h' };
+    static const uint8_t lz4Magic[] = { 0x04, 0x22, 0x4d, 0x18 };
+    static const uint8_t zstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+    if (memcmp(extPtr->magic, bzip2Magic, sizeof(bzip2Magic)) == 0)
+    {
+        memset(&extPtr->bzStream, 0, sizeof(extPtr->bzStream));
+        if (BZ2_bzDecompressInit(&extPtr->bzStream, 0, 0) != BZ_OK)
+        {
+            LE_ERROR("Failed to start bzip2 decompressor.");
+            return LE_FAULT;
+        }
+        extPtr->compression = COMPRESSION_BZIP2;
+    }
+    else if (memcmp(extPtr->magic, lz4Magic, sizeof(lz4Magic)) == 0)
+    {
+#if LE_CONFIG_UPDATE_PACK_LZ4
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&extPtr->lz4CtxPtr, LZ4F_VERSION)))
+        {
+            LE_ERROR("Failed to start LZ4 decompressor.");
+            return LE_FAULT;
+        }
+        extPtr->compression = COMPRESSION_LZ4;
+#else
+        LE_ERROR("LZ4 compressed update packs are not supported.");
+        return LE_FORMAT_ERROR;
+#endif
+    }
+    else if (memcmp(extPtr->magic, zstdMagic, sizeof(zstdMagic)) == 0)
+    {
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+        extPtr->zstdStreamPtr = ZSTD_createDStream();
+        if (   (extPtr->zstdStreamPtr == NULL)
+            || ZSTD_isError(ZSTD_initDStream(extPtr->zstdStreamPtr)) )
+        {
+            LE_ERROR("Failed to start zstd decompressor.");
+            return LE_FAULT;
+        }
+        extPtr->compression = COMPRESSION_ZSTD;
+#else
+        LE_ERROR("zstd compressed update packs are not supported.");
+        return LE_FORMAT_ERROR;
+#endif
+    }
+    else
+    {
+        extPtr->compression = COMPRESSION_NONE;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start extracting a tarball into a directory.
+ *
+ * @return Reference to the extraction, or NULL if the directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+untar_Ref_t untar_Create
+(
+    const char* dirPath     ///< [IN] Directory to extract into.  Must already exist.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int dirFd = open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd == -1)
+    {
+        LE_ERROR("Failed to open directory '%s' (%m).", dirPath);
+        return NULL;
+    }
+
+    if (ExtractionPool == NULL)
+    {
+        ExtractionPool = le_mem_CreatePool("untar", sizeof(Extraction_t));
+    }
+
+    Extraction_t* extPtr = le_mem_ForceAlloc(ExtractionPool);
+    memset(extPtr, 0, sizeof(*extPtr));
+    extPtr->dirFd = dirFd;
+    extPtr->parentFd = -1;
+    extPtr->fileFd = -1;
+    extPtr->compression = COMPRESSION_UNKNOWN;
+
+    return extPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract the next piece of a tarball.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FORMAT_ERROR if the tarball is corrupt, unsafe, or uses an unsupported format.
+ *  - LE_FAULT if something couldn't be written to the file system.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t untar_Write
+(
+    untar_Ref_t ref,        ///< [IN] Extraction.
+    const void* dataPtr,    ///< [IN] Next bytes of the tarball.
+    size_t length           ///< [IN] Number of bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    if (ref->compression == COMPRESSION_UNKNOWN)
+    {
+        while ((ref->magicLen < sizeof(ref->magic)) && (length > 0))
+        {
+            ref->magic[ref->magicLen++] = *bytePtr++;
+            length--;
+        }
+        if (ref->magicLen < sizeof(ref->magic))
+        {
+            return LE_OK;
+        }
+
+        le_result_t result = StartDecompressor(ref);
+        if (result == LE_OK)
+        {
+            result = Decompress(ref, ref->magic, ref->magicLen);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    if (length == 0)
+    {
+        return LE_OK;
+    }
+    return Decompress(ref, bytePtr, length);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the whole tarball has been extracted.
+ *
+ * @return
+ *  - LE_OK if the end of the tarball has been reached.
+ *  - LE_FORMAT_ERROR if the tarball was truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t untar_Finish
+(
+    untar_Ref_t ref         ///< [IN] Extraction.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ref->compression == COMPRESSION_UNKNOWN)
+    {
+        LE_ERROR("Tarball is truncated (%zu bytes).", ref->magicLen);
+        return LE_FORMAT_ERROR;
+    }
+    if ((ref->compression != COMPRESSION_NONE) && !ref->isStreamEnd)
+    {
+        LE_ERROR("Compressed tarball is truncated.");
+        return LE_FORMAT_ERROR;
+    }
+    if (!ref->isEnd)
+    {
+        // Some tars leave out the end-of-archive blocks, which is fine if the last entry is
+        // complete.
+        if (   (ref->blockUsed != 0) || (ref->contentsLeft != 0) || (ref->paddingLeft != 0)
+            || ref->hasLongName || ref->hasLongLink || ref->hasPaxSize )
+        {
+            LE_ERROR("Tarball is truncated.");
+            return LE_FORMAT_ERROR;
+        }
+        LE_WARN("Tarball has no end-of-archive marker.");
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop an extraction and free its resources.  Anything already extracted is left in place.
+ */
+//--------------------------------------------------------------------------------------------------
+void untar_Delete
+(
+    untar_Ref_t ref         ///< [IN] Extraction.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (ref->compression)
+    {
+        case COMPRESSION_BZIP2:
+            BZ2_bzDecompressEnd(&ref->bzStream);
+            break;
+
+#if LE_CONFIG_UPDATE_PACK_LZ4
+        case COMPRESSION_LZ4:
+            LZ4F_freeDecompressionContext(ref->lz4CtxPtr);
+            break;
+#endif
+
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+        case COMPRESSION_ZSTD:
+            ZSTD_freeDStream(ref->zstdStreamPtr);
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    if (ref->fileFd != -1)
+    {
+        close(ref->fileFd);
+    }
+    if (ref->parentFd != -1)
+    {
+        close(ref->parentFd);
+    }
+    close(ref->dirFd);
+
+    le_mem_Release(ref);
+}
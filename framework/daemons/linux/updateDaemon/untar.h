@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file untar.h
+ *
+ * In-process extraction of (possibly compressed) tarballs, fed with the tarball a piece at a time
+ * as it is read from the update pack.  Replaces running "tar xj" in a child process.
+ *
+ * The compression format is detected from the first bytes of the tarball.  bzip2 is always
+ * supported.  LZ4 frames and zstd frames are supported if the update daemon was built with
+ * LE_CONFIG_UPDATE_PACK_LZ4 or LE_CONFIG_UPDATE_PACK_ZSTD, respectively.  Uncompressed tarballs
+ * are accepted too.
+ *
+ * Extraction follows what "bsdtar xmop" does: file permissions are restored, ownership and
+ * modification times are not, and extended attributes recorded in pax headers (e.g., IMA
+ * signatures) are restored.  Entries that would land outside the destination directory are
+ * rejected.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_UPDATE_UNTAR_H_INCLUDE_GUARD
+#define LEGATO_UPDATE_UNTAR_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a tarball extraction.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct untar_Extraction* untar_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start extracting a tarball into a directory.
+ *
+ * @return Reference to the extraction, or NULL if the directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+untar_Ref_t untar_Create
+(
+    const char* dirPath     ///< [IN] Directory to extract into.  Must already exist.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract the next piece of a tarball.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_FORMAT_ERROR if the tarball is corrupt, unsafe, or uses an unsupported format.
+ *  - LE_FAULT if something couldn't be written to the file system.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t untar_Write
+(
+    untar_Ref_t ref,        ///< [IN] Extraction.
+    const void* dataPtr,    ///< [IN] Next bytes of the tarball.
+    size_t length           ///< [IN] Number of bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the whole tarball has been extracted.
+ *
+ * @return
+ *  - LE_OK if the end of the tarball has been reached.
+ *  - LE_FORMAT_ERROR if the tarball was truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t untar_Finish
+(
+    untar_Ref_t ref         ///< [IN] Extraction.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop an extraction and free its resources.  Anything already extracted is left in place.
+ */
+//--------------------------------------------------------------------------------------------------
+void untar_Delete
+(
+    untar_Ref_t ref         ///< [IN] Extraction.
+);
+
+
+#endif // LEGATO_UPDATE_UNTAR_H_INCLUDE_GUARD
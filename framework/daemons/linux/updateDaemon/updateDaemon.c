@@ -1288,9 +1288,11 @@ static bool IsCfgTree
         return false;
     }
 
+    // A tree's journal goes along with its tree files.
     return (strcmp(extension, ".rock") == 0) ||
            (strcmp(extension, ".paper") == 0) ||
-           (strcmp(extension, ".scissors") == 0);
+           (strcmp(extension, ".scissors") == 0) ||
+           (strcmp(extension, ".journal") == 0);
 }
 
 
@@ -1310,7 +1312,8 @@ static bool IsSystemCfgTree
 {
     return (strcmp(treeName, "system.rock") == 0) ||
            (strcmp(treeName, "system.paper") == 0) ||
-           (strcmp(treeName, "system.scissors") == 0);
+           (strcmp(treeName, "system.scissors") == 0) ||
+           (strcmp(treeName, "system.journal") == 0);
 }
 
 
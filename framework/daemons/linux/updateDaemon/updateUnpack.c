@@ -15,14 +15,21 @@
 #include "interfaces.h"
 #include "limit.h"
 #include "updateUnpack.h"
-#include "pipeline.h"
 #include "fileDescriptor.h"
+#include "sysPaths.h"
 #include "system.h"
 #include "app.h"
+#include "md5.h"
+#include "untar.h"
+#include "delta.h"
 
 
-/// An MD5 hash string is 32 characters long, plus a null terminator.
-#define MD5_STRING_BYTES 33
+/// Number of payload bytes read from the input stream at a time.
+#define PAYLOAD_READ_BYTES (16 * 1024)
+
+/// Most payload bytes unpacked per input fd event, so that the rest of the event loop (e.g., the
+/// watchdog kicks) gets to run while a large payload is unpacked.
+#define PAYLOAD_MAX_BYTES_PER_EVENT (256 * 1024)
 
 /// File descriptor to read the update pack from.
 static int InputFd = -1;
@@ -34,11 +41,11 @@ static bool InputFdClosed = false;
 /// Reference to the FD Monitor for the input stream (NULL if not unpacking).
 static le_fdMonitor_Ref_t InputFdMonitor = NULL;
 
-/// Reference to an unpack pipeline (NULL if not unpacking).
-static pipeline_Ref_t Pipeline = NULL;
+/// Reference to the payload tarball extraction (NULL if not unpacking).
+static untar_Ref_t Untar = NULL;
 
-/// File descriptor connected to the input of a pipeline (-1 if not unpacking)
-static int PipelineFd = -1;
+/// MD5 hash of the payload bytes unpacked so far.
+static md5_Context_t PayloadMd5Context;
 
 /// Function to be called to report progress.
 static updateUnpack_ProgressHandler_t ProgressFunc = NULL;
@@ -55,10 +62,23 @@ static char AppName[LIMIT_MAX_APP_NAME_BYTES];
 /// The MD5 hash obtained from a JSON header.
 static char Md5[MD5_STRING_BYTES]; ///< The system's MD5 hash.
 
+/// The MD5 hash of the payload bytes obtained from a JSON header (empty if not given).
+static char PayloadMd5[MD5_STRING_BYTES];
+
+/// The MD5 hash of the installed app or system that the payload is a delta against, obtained
+/// from a JSON header (empty if the payload isn't a delta).
+static char BaseMd5[MD5_STRING_BYTES];
+
+/// Directory holding the installed app or system that the payload is a delta against.
+static char BasePath[LIMIT_MAX_PATH_BYTES];
+
+/// Directory the payload is being unpacked into.
+static char UnpackPath[LIMIT_MAX_PATH_BYTES];
+
 /// # of bytes of payload following the JSON.
 static size_t PayloadSize;
 
-/// # of bytes of payload that have been copied to the unpack pipeline.
+/// # of bytes of payload that have been unpacked (or skipped).
 static size_t PayloadBytesCopied;
 
 /// Percentage complete on current task.
@@ -176,17 +196,12 @@ static void Reset
 
         InputFd = -1;
     }
-    if (PipelineFd != -1)
-    {
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
-    }
 
-    // Delete the pipeline.
-    if (Pipeline != NULL)
+    // Stop extracting the payload.
+    if (Untar != NULL)
     {
-        pipeline_Delete(Pipeline);
-        Pipeline = NULL;
+        untar_Delete(Untar);
+        Untar = NULL;
     }
 }
 
@@ -358,6 +373,8 @@ static void StartParsing
     Command[0] = '\0';
     AppName[0] = '\0';
     Md5[0] = '\0';
+    PayloadMd5[0] = '\0';
+    BaseMd5[0] = '\0';
     PayloadSize = 0;
 
     // Set the state
@@ -370,36 +387,58 @@ static void StartParsing
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Completion callback for "tar xj" operation.
+ * Called when all the payload bytes have been unpacked.  Checks that the payload was complete
+ * and intact, and moves on to whatever comes after it.
  */
 //--------------------------------------------------------------------------------------------------
 static void UntarDone
 (
-    pipeline_Ref_t pipeline,
-    int status
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    pipeline_Delete(Pipeline);
-    Pipeline = NULL;
+    le_result_t result = untar_Finish(Untar);
 
-    if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+    untar_Delete(Untar);
+    Untar = NULL;
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Malformed update pack (payload tarball incomplete).");
+        HandleFormatError();
+        return;
+    }
+
+    if (PayloadMd5[0] != '\0')
     {
-        if (WIFEXITED(status))
+        char md5[MD5_STRING_BYTES];
+        md5_Final(&PayloadMd5Context, md5);
+
+        if (strcasecmp(md5, PayloadMd5) != 0)
         {
-            LE_ERROR("Payload unpack pipeline failed with exit code: %d", WEXITSTATUS(status));
+            LE_ERROR("Malformed update pack (payload MD5 hash is %s, expected %s).",
+                     md5,
+                     PayloadMd5);
+            HandleFormatError();
+            return;
         }
-        else if (WIFSIGNALED(status))
+    }
+
+    // If the payload is a delta, fill in everything it didn't carry from the base.
+    if (BaseMd5[0] != '\0')
+    {
+        result = delta_Apply(BasePath, UnpackPath);
+        if (result == LE_FORMAT_ERROR)
         {
-            LE_ERROR("Payload unpack pipeline killed by signal: %d", WTERMSIG(status));
+            LE_ERROR("Malformed update pack (delta doesn't apply to %s).", BasePath);
+            HandleFormatError();
+            return;
         }
-        else
+        else if (result != LE_OK)
         {
-            LE_ERROR("Payload unpack pipeline died for unknown reason (status: %d)", status);
+            HandleInternalError();
+            return;
         }
-
-        HandleInternalError();
-        return;
     }
 
     // If this update pack contains changes to individual apps,
@@ -472,20 +511,22 @@ static void SkipForwardDone
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Copy bytes from the input fd to the pipeline's input fd until the input fd's read buffer is
- * empty or we have copied all the payload bytes.
+ * Read payload bytes from the input fd and extract them, until the input fd's read buffer is
+ * empty or we have unpacked all the payload bytes.  The payload's MD5 hash is computed on the way.
  */
 //--------------------------------------------------------------------------------------------------
-static void CopyBytesToPipeline
+static void UnpackPayloadBytes
 (
     void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char buffer[1024];
+    uint8_t buffer[PAYLOAD_READ_BYTES];
+    size_t bytesThisEvent = 0;
 
-    // Keep copying as much as we can until we've copied all the payload.
-    while (PayloadBytesCopied < PayloadSize)
+    // Keep unpacking as much as we can until we've unpacked all the payload, but return to the
+    // event loop every now and then.  The FD Monitor will call us back.
+    while ((PayloadBytesCopied < PayloadSize) && (bytesThisEvent < PAYLOAD_MAX_BYTES_PER_EVENT))
     {
         // Compute the number of bytes to read.
         size_t bytesToRead = PayloadSize - PayloadBytesCopied;
@@ -515,7 +556,8 @@ static void CopyBytesToPipeline
             }
 
             LE_ERROR("Failed to read from input stream (%m).");
-            goto error;
+            HandleInternalError();
+            return;
         }
 
         // Handle end of file.
@@ -524,55 +566,42 @@ static void CopyBytesToPipeline
             LE_ERROR("Unexpected early end of input after %zu bytes of %zu.",
                      PayloadBytesCopied,
                      PayloadSize);
-            goto error;
+            HandleInternalError();
+            return;
         }
 
-        // Write the bytes that we read.
-        ssize_t bytesWritten = 0;
-        ssize_t writeResult;
-        do
-        {
-            writeResult = write(PipelineFd, buffer + bytesWritten, readResult - bytesWritten);
+        md5_Update(&PayloadMd5Context, buffer, readResult);
 
-            // If some bytes were written, remember how many bytes, so we don't try to write the
-            // same bytes again if we have more to write.
-            if (writeResult > 0)
-            {
-                bytesWritten += writeResult;
-            }
+        // Extract the bytes that we read.
+        le_result_t result = untar_Write(Untar, buffer, readResult);
+        if (result == LE_FORMAT_ERROR)
+        {
+            LE_ERROR("Malformed update pack (bad payload tarball).");
+            HandleFormatError();
+            return;
         }
-        while (   ((writeResult == -1) && (errno == EINTR)) // Retry if interrupted by a signal
-               || ((writeResult != -1) && (bytesWritten < readResult))  ); // Continue if not done
-
-        // Check for errors.
-        if (writeResult == -1)
+        else if (result != LE_OK)
         {
-            LE_ERROR("Failed to write to output stream (%m)");
-            goto error;
+            HandleInternalError();
+            return;
         }
 
         // Update the static progress variables and report progress to the client.
         PayloadBytesCopied += readResult;
+        bytesThisEvent += readResult;
         PercentDone = (100 * PayloadBytesCopied) / PayloadSize;
         ReportProgress();
     }
 
-    // If we have copied all the payload bytes to the pipeline's input, then we can stop
-    // monitoring the input fd now, close the pipeline input write pipe, and wait for the pipeline
-    // completion callback (UntarDone()).
-    LE_INFO("Payload copied: %zu/%zu", PayloadBytesCopied, PayloadSize);
+    // If we have unpacked all the payload bytes, then we can stop monitoring the input fd now
+    // and finish up the payload.
     LE_ASSERT(PayloadBytesCopied <= PayloadSize);
     if (PayloadBytesCopied == PayloadSize)
     {
+        LE_INFO("Payload unpacked: %zu/%zu", PayloadBytesCopied, PayloadSize);
         DeleteFdMonitor();
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
+        UntarDone();
     }
-    return;
-
-error:
-
-    HandleInternalError();
 }
 
 
@@ -654,7 +683,7 @@ static void DiscardPayloadBytes
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Event handler for the input fd when copying bytes to a pipeline.
+ * Event handler for the input fd when unpacking or skipping payload bytes.
  */
 //--------------------------------------------------------------------------------------------------
 static void InputFdEventHandler
@@ -668,7 +697,7 @@ static void InputFdEventHandler
     {
         if (State == STATE_UNPACKING_PAYLOAD)
         {
-            CopyBytesToPipeline();
+            UnpackPayloadBytes();
         }
         else if (State == STATE_SKIPPING_PAYLOAD)
         {
@@ -687,31 +716,6 @@ static void InputFdEventHandler
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Function that runs in the unpack pipeline's "tar" process.
- **/
-//--------------------------------------------------------------------------------------------------
-static int Untar
-(
-    void* param
-)
-//--------------------------------------------------------------------------------------------------
-{
-    const char* unpackDir = param;
-
-    // Close all open file descriptors except for stdin, stdout, and stderr.
-    // This ensures that we don't keep copies of things like the pipeline input write pipe open.
-    fd_CloseAllNonStd();
-
-    // Try bsdtar first.  If that fails, fallback to tar.
-    execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
-    execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
-
-    LE_FATAL("Failed to exec tar (%m)");
-}
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Start unpacking a tarball.
@@ -727,11 +731,15 @@ static void StartUntar
 
     PayloadBytesCopied = 0;
 
-    // Create a pipeline: PipelineFd -> tar
-    Pipeline = pipeline_Create();
-    PipelineFd = pipeline_CreateInputPipe(Pipeline);
-    pipeline_Append(Pipeline, Untar, (void*)dirPath);
-    pipeline_Start(Pipeline, UntarDone);
+    LE_ASSERT(le_utf8_Copy(UnpackPath, dirPath, sizeof(UnpackPath), NULL) == LE_OK);
+
+    Untar = untar_Create(dirPath);
+    if (Untar == NULL)
+    {
+        HandleInternalError();
+        return;
+    }
+    md5_Init(&PayloadMd5Context);
 
     fd_SetNonBlocking(InputFd);
 
@@ -806,6 +814,58 @@ static void StartFirmwareUpdate
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * If the payload is a delta, find the installed app or system that it is based on.  A system
+ * delta can only be applied on top of the current system.
+ *
+ * @return false if the payload is a delta and its base isn't installed (an error has been logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FindDeltaBase
+(
+    bool isSystem   ///< [IN] true if the payload is a system, false if it's an app.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (BaseMd5[0] == '\0')
+    {
+        return true;
+    }
+
+    if (isSystem)
+    {
+        char currentMd5[LIMIT_MD5_STR_BYTES];
+
+        if (   (system_GetSystemHash(system_Index(), currentMd5) != LE_OK)
+            || (strcmp(currentMd5, BaseMd5) != 0) )
+        {
+            LE_ERROR("Malformed update pack (system delta is based on system %s, which isn't"
+                     " the current system).",
+                     BaseMd5);
+            return false;
+        }
+
+        LE_ASSERT(le_utf8_Copy(BasePath, CURRENT_SYSTEM_PATH, sizeof(BasePath), NULL) == LE_OK);
+    }
+    else
+    {
+        if (!app_Exists(BaseMd5))
+        {
+            LE_ERROR("Malformed update pack (app delta is based on app %s, which isn't installed).",
+                     BaseMd5);
+            return false;
+        }
+
+        LE_ASSERT(snprintf(BasePath, sizeof(BasePath), "/legato/apps/%s", BaseMd5)
+                  < sizeof(BasePath));
+    }
+
+    LE_INFO("Payload is a delta against '%s'.", BasePath);
+    return true;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle the end of a JSON header.
@@ -837,6 +897,10 @@ static void JsonDone
             LE_ERROR("Malformed update pack (system update payload missing)");
             HandleFormatError();
         }
+        else if (!FindDeltaBase(true))
+        {
+            HandleFormatError();
+        }
         // If everything looks good...
         else
         {
@@ -892,6 +956,12 @@ static void JsonDone
 
             if (app_Exists(Md5) == false)
             {
+                if (!FindDeltaBase(false))
+                {
+                    HandleFormatError();
+                    return;
+                }
+
                 LE_INFO("App with MD5 sum %s being unpacked.", Md5);
 
                 State = STATE_UNPACKING_PAYLOAD;
@@ -1073,6 +1143,36 @@ static void Md5EventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * "payloadMd5" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PayloadMd5EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StringMemberEventHandler(event, PayloadMd5, sizeof(PayloadMd5), "payload MD5 hash");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * "deltaFromMd5" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeltaFromMd5EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StringMemberEventHandler(event, BaseMd5, sizeof(BaseMd5), "delta base MD5 hash");
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * "version" member parsing event function.
@@ -1184,6 +1284,14 @@ static void JsonEventHandler
             {
                 le_json_SetEventHandler(Md5EventHandler);
             }
+            else if (strcmp(memberName, "payloadMd5") == 0)
+            {
+                le_json_SetEventHandler(PayloadMd5EventHandler);
+            }
+            else if (strcmp(memberName, "deltaFromMd5") == 0)
+            {
+                le_json_SetEventHandler(DeltaFromMd5EventHandler);
+            }
             else if (strcmp(memberName, "name") == 0)
             {
                 le_json_SetEventHandler(NameEventHandler);
@@ -0,0 +1,325 @@
+/**
+ * @page c_flatHashmap Flat HashMap API
+ *
+ * @ref le_flatHashmap.h "API Reference"
+ *
+ * <HR>
+ *
+ * This API provides a HashMap that stores its entries directly in a flat array, using open
+ * addressing, instead of chaining them through bucket lists like the @ref c_hashmap.  Looking up a
+ * key does not chase pointers and adding a key does not allocate an entry, so it is a better fit
+ * for large or heavily used maps.
+ *
+ * The keys and values are stored the same way as in @ref c_hashmap "le_hashmap", and the same hash
+ * and equality functions (such as le_hashmap_HashString() and le_hashmap_EqualsString()) are used.
+ *
+ * @section c_flatHashmap_create Creating a Flat HashMap
+ *
+ * Use le_flatHashmap_Create() to create a map on the heap:
+ *
+ * @code
+ *     myTable = le_flatHashmap_Create("My Table",
+ *                                     1000,
+ *                                     le_hashmap_HashString,
+ *                                     le_hashmap_EqualsString);
+ * @endcode
+ *
+ * The capacity is only a hint.  The map grows as needed to keep probe sequences short, so unlike
+ * le_hashmap, performance does not degrade if more keys are added than were expected.  Maps can be
+ * deleted with le_flatHashmap_Delete().
+ *
+ * @section c_flatHashmap_layout How it works
+ *
+ * The entries are kept in a power-of-two sized array of slots.  A parallel array holds one control
+ * byte per slot, which is either empty, deleted, or holds 7 bits of the key's hash.  Lookups load
+ * a group of control bytes at a time (16 with SSE2, 8 with NEON or on other targets) and compare
+ * all of them to the key's hash bits at once.  The equality function is only called for the few
+ * slots whose hash bits match.
+ *
+ * The array is grown when it becomes 7/8 full.  By default, the entries are all moved to the new
+ * array during the le_flatHashmap_Put() that triggers the growth.  For maps where that pause is
+ * not acceptable, call le_flatHashmap_EnableIncrementalResize(): the old array is then kept
+ * alongside the new one, and each following le_flatHashmap_Put() of a new key moves a small,
+ * fixed number of slots across.
+ *
+ * @section c_flatHashmap_iterating Iterating over a map
+ *
+ * le_flatHashmap_ForEach() calls a function for each key-value pair, and
+ * le_flatHashmap_GetIterator() with le_flatHashmap_NextNode() step through them, in the same way
+ * as the equivalent @ref c_hashmap_iterating "le_hashmap functions".
+ *
+ * Entries can be removed during iteration, including the current one.  However, adding a new key
+ * may rearrange the whole map, so the iterator must be reset with le_flatHashmap_GetIterator()
+ * after that.  Replacing the value of an existing key does not affect the iterator.
+ *
+ * @note There is only one iterator per map.
+ *
+ * If you need to control access to the map from several threads, then a mutex can be used.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_flatHashmap.h
+ *
+ * Legato @ref c_flatHashmap include file.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_FLAT_HASHMAP_INCLUDE_GUARD
+#define LEGATO_FLAT_HASHMAP_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a Flat HashMap.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_flatHashmap* le_flatHashmap_Ref_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a Flat HashMap Iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_flatHashmap_It* le_flatHashmap_It_Ref_t;
+
+
+/// @cond HIDDEN_IN_USER_DOCS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Internal function used to implement le_flatHashmap_Create().
+ */
+//--------------------------------------------------------------------------------------------------
+le_flatHashmap_Ref_t _le_flatHashmap_Create
+(
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+    const char                *nameStr,
+#endif
+    size_t                     capacity,
+    le_hashmap_HashFunc_t      hashFunc,
+    le_hashmap_EqualsFunc_t    equalsFunc
+);
+/// @endcond
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Flat HashMap.
+ *
+ *  @param[in]  nameStr     Name of the HashMap.  This must be a static string as it is not copied.
+ *  @param[in]  capacity    Number of keys expected.  The map grows beyond this if needed.
+ *  @param[in]  hashFunc    Hash function
+ *  @param[in]  equalsFunc  Equality function
+ *
+ *  @return  Returns a reference to the map.
+ *
+ *  @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+#   define le_flatHashmap_Create(nameStr, capacity, hashFunc, equalsFunc) \
+        _le_flatHashmap_Create((nameStr), (capacity), (hashFunc), (equalsFunc))
+#else /* if not LE_CONFIG_HASHMAP_NAMES_ENABLED */
+#   define le_flatHashmap_Create(nameStr, capacity, hashFunc, equalsFunc) \
+        ((void)(nameStr), _le_flatHashmap_Create((capacity), (hashFunc), (equalsFunc)))
+#endif /* end LE_CONFIG_HASHMAP_NAMES_ENABLED */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a Flat HashMap.  This will not delete the data pointed to by the key and value pointers.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_Delete
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spread the cost of growing the map over the following insertions, instead of moving all the
+ * entries at once when the map becomes full.  This bounds the time taken by any single
+ * le_flatHashmap_Put(), at the cost of looking up keys in two arrays while a resize is in progress.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_EnableIncrementalResize
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a key-value pair to a Flat HashMap. If the key already exists in the map, the previous value
+ * will be replaced with the new value passed into this function.
+ *
+ * @return  Returns NULL for a new entry or a pointer to the old value if it is replaced.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Put
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr,             ///< [in] Pointer to the key to be stored.
+    const void* valuePtr            ///< [in] Pointer to the value to be stored.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieve a value from a Flat HashMap.
+ *
+ * @return  Returns a pointer to the value or NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Get
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be retrieved.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieve a stored key from a Flat HashMap.
+ *
+ * @return  Returns a pointer to the key that was stored in the map by le_flatHashmap_Put() or
+ *          NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_GetStoredKey
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be retrieved.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a value from a Flat HashMap.
+ *
+ * @return  Returns a pointer to the value or NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Remove
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be removed.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests if the Flat HashMap contains a particular key.
+ *
+ * @return  Returns true if the key is found, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_ContainsKey
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be searched.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests if the Flat HashMap is empty (i.e. contains zero keys).
+ *
+ * @return  Returns true if empty, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_IsEmpty
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of keys in the Flat HashMap.
+ *
+ * @return  The number of keys in the map.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_flatHashmap_Size
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes all the entries held in the Flat HashMap. This will not delete the data pointed to by
+ * the key and value pointers. That cleanup is the responsibility of the caller.  The map keeps its
+ * current size, so it can be re-filled without growing again.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_RemoveAll
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterates over the whole map, calling the supplied callback with each key-value pair. If the
+ * callback returns false for any key then this function will return.
+ *
+ * @return  Returns true if all elements were checked; or false if iteration was stopped early
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_ForEach
+(
+    le_flatHashmap_Ref_t mapRef,            ///< [in] Reference to the map.
+    le_hashmap_ForEachHandler_t forEachFn,  ///< [in] Callback function to be called with each pair.
+    void* contextPtr                        ///< [in] Pointer to a context to be supplied to the
+                                            ///<      callback.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets an iterator for step-by-step iteration over the map.  There is one iterator per map, and
+ * calling this function resets the iterator position to the start of the map.  The iterator is not
+ * ready for data access until le_flatHashmap_NextNode() has been called at least once.
+ *
+ * @return  Returns A reference to the map's iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+le_flatHashmap_It_Ref_t le_flatHashmap_GetIterator
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves the iterator to the next key/value pair in the map.  The order is not sorted at all.
+ *
+ * @return  Returns LE_OK unless you go past the end of the map, then returns LE_NOT_FOUND.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_flatHashmap_NextNode
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieves a pointer to the key where the iterator is currently pointing.
+ *
+ * @return  Pointer to the current key, or NULL if the iterator is not ready or its entry has been
+ *          removed.
+ */
+//--------------------------------------------------------------------------------------------------
+const void* le_flatHashmap_GetKey
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieves a pointer to the value where the iterator is currently pointing.
+ *
+ * @return  Pointer to the current value, or NULL if the iterator is not ready or its entry has
+ *          been removed.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_GetValue
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+);
+
+#endif /* LEGATO_FLAT_HASHMAP_INCLUDE_GUARD */
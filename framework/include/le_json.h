@@ -82,6 +82,50 @@
  * To get the number of bytes that have been read by the parser since le_json_Parse() was called,
  * call le_json_GetBytesRead().
  *
+ *  @section c_json_reading Reading From File Descriptors
+ *
+ * The parser reads from the file descriptor in blocks, but it never consumes data that follows
+ * the end of the document, so whatever comes after the document can still be read from the
+ * file descriptor once LE_JSON_DOC_END has been reported.  For files, this is done by seeking
+ * back to just after the end of the document; for stream sockets, by peeking at the data before
+ * consuming it.  Pipes and other file descriptors that can't do either are read a few bytes at a
+ * time (never more than the shortest possible rest of the document), which is slower, so prefer
+ * a file or socket when parsing large documents.
+ *
+ *  @section c_json_docs Parsed Documents
+ *
+ * When the whole document is going to be kept in memory anyway, it is simpler to have it parsed
+ * into a document and walk that, instead of handling events.  le_json_ParseDoc() parses a
+ * document held in memory and le_json_ReadDoc() reads one from a file descriptor up to
+ * end-of-file.  Both return a document reference, or NULL if the document is not valid JSON.
+ * le_json_DeleteDoc() must be called to release the document when it is no longer needed.
+ *
+ * Each value in the document is identified by an le_json_Value_t.  The outermost object or array
+ * is returned by le_json_GetRoot().  le_json_GetFirstChild() and le_json_GetNextSibling() walk the
+ * members of an object or elements of an array (returning LE_JSON_NO_VALUE at the end),
+ * le_json_FindMember() looks up an object member by name, and le_json_GetValueType(),
+ * le_json_GetMemberName(), le_json_GetStringValue() and le_json_GetNumberValue() fetch the
+ * contents of a value.  Escape sequences in strings and member names are decoded.
+ *
+ * @code
+ * char errorMsg[128];
+ * le_json_DocRef_t doc = le_json_ReadDoc(fd, errorMsg, sizeof(errorMsg));
+ * if (doc == NULL)
+ * {
+ *     LE_ERROR("Bad document: %s", errorMsg);
+ * }
+ * else
+ * {
+ *     le_json_Value_t name = le_json_FindMember(doc, le_json_GetRoot(doc), "name");
+ *     if ((name != LE_JSON_NO_VALUE) &&
+ *         (le_json_GetValueType(doc, name) == LE_JSON_CONTEXT_STRING))
+ *     {
+ *         LE_INFO("Name is '%s'.", le_json_GetStringValue(doc, name));
+ *     }
+ *     le_json_DeleteDoc(doc);
+ * }
+ * @endcode
+ *
  *  @section c_json_example Example
  *
  * If the JSON document is
@@ -418,4 +462,207 @@ le_json_ParsingSessionRef_t le_json_GetSession
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a parsed document (see le_json_ParseDoc()).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_json_Doc* le_json_DocRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identifies a value in a parsed document.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint32_t le_json_Value_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value returned when there is no such value in a parsed document.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_JSON_NO_VALUE 0
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a whole JSON document held in memory.
+ *
+ * @return Reference to the document, or NULL if the document is not valid JSON (in which case
+ *         an error message is put in the error message buffer, if one is provided).
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_DocRef_t le_json_ParseDoc
+(
+    const char* textPtr,    ///< [IN] Document text.  Does not need to be null-terminated.
+    size_t textLength,      ///< [IN] Length of the document text, in bytes.
+    char* errorMsgPtr,      ///< [OUT] Buffer to put an error message in (can be NULL).
+    size_t errorMsgSize     ///< [IN] Size of the error message buffer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole JSON document from a file descriptor, up to end-of-file, and parse it.
+ *
+ * @return Reference to the document, or NULL if the document could not be read or is not valid
+ *         JSON (in which case an error message is put in the error message buffer, if one is
+ *         provided).
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_DocRef_t le_json_ReadDoc
+(
+    int fd,                 ///< [IN] File descriptor to read the document from.
+    char* errorMsgPtr,      ///< [OUT] Buffer to put an error message in (can be NULL).
+    size_t errorMsgSize     ///< [IN] Size of the error message buffer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a parsed document.  Strings fetched from the document can't be used after this.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_DeleteDoc
+(
+    le_json_DocRef_t docRef     ///< [IN] Document to delete.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the root value (the outermost object or array) of a parsed document.
+ *
+ * @return The root value.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetRoot
+(
+    le_json_DocRef_t docRef     ///< [IN] Document.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a value in a parsed document.
+ *
+ * @return LE_JSON_CONTEXT_OBJECT, LE_JSON_CONTEXT_ARRAY, LE_JSON_CONTEXT_STRING,
+ *         LE_JSON_CONTEXT_NUMBER, LE_JSON_CONTEXT_TRUE, LE_JSON_CONTEXT_FALSE or
+ *         LE_JSON_CONTEXT_NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ContextType_t le_json_GetValueType
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of members of an object or elements of an array in a parsed document.
+ *
+ * @return The number of members or elements, or 0 if the value is not an object or array.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_json_GetChildCount
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object or array.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first member of an object or element of an array in a parsed document.
+ *
+ * @return The first member or element, or LE_JSON_NO_VALUE if there are none.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetFirstChild
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object or array.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next member of the same object or element of the same array in a parsed document.
+ *
+ * @return The next member or element, or LE_JSON_NO_VALUE if this was the last one.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetNextSibling
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object member or array element.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of an object member in a parsed document.
+ *
+ * @return The member name, or NULL if the value is not an object member.  The string is valid
+ *         until the document is deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_json_GetMemberName
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object member.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a member of an object in a parsed document by name.  If the object has more than one
+ * member with this name, the first one is found.
+ *
+ * @return The member, or LE_JSON_NO_VALUE if not found or the value is not an object.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_FindMember
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t object,     ///< [IN] Object.
+    const char* name            ///< [IN] Member name.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a string in a parsed document.
+ *
+ * @return The string, which is valid until the document is deleted.
+ *
+ * @warning The value must be a string.  Anything else is fatal to the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_json_GetStringValue
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] String value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a number in a parsed document.
+ *
+ * @return The number.
+ *
+ * @warning The value must be a number.  Anything else is fatal to the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+double le_json_GetNumberValue
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Number value.
+);
+
+
 #endif // LEGATO_JSON_H_INCLUDE_GUARD
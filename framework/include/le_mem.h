@@ -297,6 +297,20 @@
  * the data structure, then the mutex must be held by the thread that calls le_mem_Release() to
  * ensure there's no other thread accessing the data structure when the destructor runs.
  *
+ * @subsection mem_thread_cache Per-Thread Caches
+ *
+ * By default, every allocation and release takes a single process-wide lock.  When the
+ * @ref MEM_THREAD_CACHE KConfig option is enabled, heavily used pools can be given a per-thread
+ * cache of free objects with @c le_mem_EnableThreadCache().  Each thread then allocates from and
+ * releases into its own cache without taking the lock, and only moves objects to or from the
+ * pool's shared free list in batches.
+ *
+ * Objects parked in one thread's cache can't be allocated by another thread, so a thread cache
+ * is best suited to pools whose objects are allocated with le_mem_ForceAlloc() (which expands the
+ * pool rather than failing).  Statistics returned by le_mem_GetStats() count cached objects as
+ * free; the maximum number of blocks used is updated when a cache is refilled, so it may be
+ * slightly higher than the true peak.
+ *
  * @section mem_pool_sizes Managing Pool Sizes
  *
  * We know it's possible to have pools automatically expand
@@ -518,6 +532,12 @@ typedef struct le_mem_Pool
     size_t numBlocksInUse;              ///< Number of currently allocated blocks.
     size_t numBlocksToForce;            ///< Number of blocks that is added when Force Alloc
                                         ///  expands the pool.
+#if LE_CONFIG_MEM_THREAD_CACHE
+    size_t threadCacheSize;             ///< Number of blocks moved between a thread's cache and
+                                        ///  the free list at once (0 = no thread cache).
+    size_t threadCacheSlot;             ///< Index of this pool's cache in each thread's table.
+    le_dls_List_t threadCacheList;      ///< List of thread caches holding blocks of this pool.
+#endif
 #if LE_CONFIG_MEM_TRACE
     le_log_TraceRef_t memTrace;         ///< If tracing is enabled, keeps track of a trace object
                                         ///< for this pool.
@@ -527,6 +547,10 @@ typedef struct le_mem_Pool
 #if LE_CONFIG_MEM_POOL_NAMES_ENABLED
     char name[LE_MEM_LIMIT_MAX_MEM_POOL_NAME_BYTES]; ///< Name of the pool.
 #endif
+#if LE_CONFIG_RUNTIME_STATS
+    void* statsPtr;                     ///< This pool's slot in the runtime statistics page, or
+                                        ///  NULL if it doesn't have one.
+#endif
 }
 le_mem_Pool_t;
 
@@ -962,6 +986,31 @@ void le_mem_SetNumObjsToForce
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables a per-thread cache of free objects for a pool.
+ *
+ * Once enabled, each thread keeps up to twice numObjects free objects of this pool to itself, and
+ * allocates and releases them without locking.  Objects are moved between a thread's cache and
+ * the pool in batches of numObjects.  See @ref mem_thread_cache for more information.
+ *
+ * @return
+ *      Nothing.
+ *
+ * @note
+ *      - Must be called before any objects are allocated from the pool.
+ *      - Sub-pools can't have thread caches.
+ *      - Has no effect unless the @ref MEM_THREAD_CACHE KConfig option is enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableThreadCache
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] Pool to enable the thread cache for.
+    size_t              numObjects  ///< [IN] Number of objects moved to or from a thread's cache
+                                    ///       at once.
+);
+
+
 #if !LE_CONFIG_MEM_TRACE
     //----------------------------------------------------------------------------------------------
     /**
@@ -766,6 +766,54 @@
  * @warning DO NOT SEND DIRECTORY FILE DESCRIPTORS.  They can be exploited and used to break out of
  * chroot() jails.
  *
+ * @section c_messagingBatching Batching
+ *
+ * When several messages are waiting to be sent through a session, or have arrived from the other
+ * side, they are sent or received together, with up to @c LE_CONFIG_IPC_BATCH_SIZE messages per
+ * system call.  This happens automatically.  le_msg_GetBatchStats() reports how many messages
+ * were carried per system call.
+ *
+ * A client that makes many asynchronous requests in a row (see le_msg_RequestResponse()) can have
+ * them all sent together by wrapping them in le_msg_StartBatch() and le_msg_EndBatch().  Between
+ * those calls, messages are only queued.  le_msg_EndBatch() then writes them all to the socket, so
+ * the server receives them in one wake-up, and waits for all of the responses.  The response
+ * callbacks are called before le_msg_EndBatch() returns.
+ *
+ * @code
+ * le_msg_StartBatch(sessionRef);
+ *
+ * for (i = 0; i < count; i++)
+ * {
+ *     msgRef = le_msg_CreateMsg(sessionRef);
+ *     ...
+ *     le_msg_RequestResponse(msgRef, ResponseHandler, &results[i]);
+ * }
+ *
+ * le_msg_EndBatch(sessionRef);
+ * @endcode
+ *
+ * Synchronous requests made during a batch send everything queued before them first, so requests
+ * always reach the server in the order they were made.
+ *
+ * @section c_messagingSharedMemory Shared Memory Transport
+ *
+ * By default, every message payload is copied into the session's socket by the sender and out of
+ * it by the receiver.  For protocols with large messages, a client can call
+ * le_msg_EnableSharedMemory() before opening a session to have payloads carried in a pool of
+ * buffers shared between the client and the server instead.  le_msg_CreateMsg() then places the
+ * payload directly in a shared buffer, and only a small notification goes through the socket when
+ * the message is sent, so the payload itself is never copied by the framework.
+ *
+ * The API is otherwise unchanged, with one exception: once a request message has been sent, its
+ * payload buffer may be reused for the response, so the request payload must not be accessed
+ * after calling le_msg_Send(), le_msg_RequestResponse() or le_msg_RequestSyncResponse().
+ *
+ * If all of the session's buffers are in use when a message is created, the message falls back to
+ * being copied through the socket.
+ *
+ * @note Shared memory is only used for sessions with a server in another thread or process.  It
+ *       is not worthwhile for protocols with small messages.
+ *
  * @section c_messagingFutureEnhancements Future Enhancements
  *
  * As an optimization to reduce the number of copies in cases where the sender of a message
@@ -1189,6 +1237,103 @@ LE_FULL_API void le_msg_SetSessionCloseHandler
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts of the socket system calls made by a process to send and receive messages, and of the
+ * messages they carried.  See le_msg_GetBatchStats().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    rxCallCount;    ///< Receive calls that returned at least one message.
+    uint64_t    rxMsgCount;     ///< Messages returned by those calls.
+    size_t      rxMaxBatch;     ///< Most messages returned by one receive call.
+    uint64_t    txCallCount;    ///< Send calls that sent at least one message.
+    uint64_t    txMsgCount;     ///< Messages sent by those calls.
+    size_t      txMaxBatch;     ///< Most messages sent by one send call.
+}
+le_msg_BatchStats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets counts of the socket system calls made by this process to send and receive messages, and
+ * of the messages they carried.  Comparing the message counts to the call counts shows how well
+ * messages are being batched.  See @ref c_messagingBatching.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void le_msg_GetBatchStats
+(
+    le_msg_BatchStats_t* statsPtr   ///< [OUT] The statistics.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of messages on a session.  Until the matching le_msg_EndBatch(), messages sent
+ * with le_msg_Send() or le_msg_RequestResponse() are queued instead of being written to the
+ * socket.  Batches can be nested; only the outermost le_msg_EndBatch() sends the messages.  See
+ * @ref c_messagingBatching.
+ *
+ * Has no effect on local sessions.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Only the thread that owns the session can start a batch on it.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void le_msg_StartBatch
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ends a batch of messages on a session.  At the end of the outermost batch, the queued messages
+ * are sent together, then the calling thread is blocked until the responses to all of the
+ * session's outstanding asynchronous requests have arrived.  Their callbacks are called before
+ * this function returns.  Indication messages that arrive in the meantime are handled later, by
+ * the event loop.
+ *
+ * If the session is closed while waiting, the wait ends and the remaining transactions are
+ * terminated the same way as when no batch is used.
+ *
+ * Has no effect on local sessions.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Only the thread that owns the session can end a batch on it.
+ *
+ * @warning Like le_msg_RequestSyncResponse(), this blocks the calling thread until the server has
+ *          responded, so no other event handling happens in that thread in the meantime.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void le_msg_EndBatch
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Requests that message payloads be carried in shared memory for a session, instead of being
+ * copied through its socket.  See @ref c_messagingSharedMemory.
+ *
+ * Has no effect on local sessions, or if the protocol's maximum message size is too small.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Must be called before the session is opened.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void le_msg_EnableSharedMemory
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t              numBuffers  ///< [in] Number of payload buffers for each direction.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the handler callback function to be called when the session is closed from the other
@@ -283,45 +283,30 @@ LE_DECLARE_INLINE bool le_pack_PackString
     uint32_t maxStringCount
 )
 {
-    size_t bytesCopied;
+    size_t stringSize;
 
     if (!stringPtr)
     {
         return false;
     }
 
-#if defined(__KLOCWORK__)
-    // Just like strncpy & strnlen, this function doesn't know the size of the source string,
-    // which can potentially result in a read overflow on the input buffer.
-    // Static code analyzer can report this issue, which is deliberatly ignored since this
-    // function expects NULL-terminated strings.
-    maxStringCount = strnlen(stringPtr, maxStringCount);
-#endif
-
-    // First copy in the string -- up to maxStringCount bytes, allowing enough
-    // space at the begining for a uint32.
-    for (bytesCopied = 0;
-         (bytesCopied < maxStringCount) && (stringPtr[bytesCopied] != '\0');
-         ++bytesCopied)
-    {
-        (*bufferPtr)[bytesCopied + sizeof(uint32_t)] = stringPtr[bytesCopied];
-    }
+    // Just like strncpy & strnlen, this function doesn't know the size of the source string.
+    // It expects NULL-terminated strings, and reads at most one byte past maxStringCount.
+    stringSize = strnlen(stringPtr, maxStringCount);
 
     // String was too long to fit in the buffer -- return false.
-    if (stringPtr[bytesCopied] != '\0')
+    if (stringPtr[stringSize] != '\0')
     {
         return false;
     }
 
-    // Then go back and copy string size.  No loss of precision packing into a uint32
-    // because maxStringCount is a uint32 or less.
-    bool packResult = le_pack_PackUint32(bufferPtr, bytesCopied);
-    LE_ASSERT(packResult); // Should not fail -- have checked there's enough space above.
+    // Pack the string size, then the string in one copy.  No loss of precision packing into a
+    // uint32 because maxStringCount is a uint32 or less.
+    bool packResult = le_pack_PackUint32(bufferPtr, stringSize);
+    LE_ASSERT(packResult); // Should not fail -- have checked the size above.
 
-    // Now increment buffer by size of string actually copied, and decrement available
-    // space by max which could have been copied.  This ensures out of space errors will
-    // be caught as soon as possible.
-    *bufferPtr = *bufferPtr + bytesCopied;
+    memcpy(*bufferPtr, stringPtr, stringSize);
+    *bufferPtr = *bufferPtr + stringSize;
 
     return true;
 }
@@ -381,6 +366,33 @@ LE_DECLARE_INLINE bool le_pack_PackArrayHeader
         }                                                               \
     } while (0)
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack an array of raw values into a buffer, incrementing the buffer pointer.
+ *
+ * Only for types which are packed as an exact copy of their C representation (integers, chars,
+ * doubles, le_result_t and le_onoff_t, but not bools, sizes or references): the whole array is
+ * copied at once instead of packing one element at a time.
+ *
+ * @note Will assert if the resulted array exceeds the maximum size allowed.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_PACK_PACKRAWARRAY(bufferPtr,                                 \
+                             arrayPtr,                                  \
+                             arrayCount,                                \
+                             arrayMaxCount,                             \
+                             resultPtr)                                 \
+    do {                                                                \
+        *(resultPtr) = le_pack_PackArrayHeader((bufferPtr),             \
+                                               (arrayPtr), sizeof((arrayPtr)[0]), \
+                                               (arrayCount), (arrayMaxCount)); \
+        if (*(resultPtr) && ((arrayCount) > 0))                         \
+        {                                                               \
+            memcpy(*(bufferPtr), (arrayPtr), (arrayCount) * sizeof((arrayPtr)[0])); \
+            *(bufferPtr) += (arrayCount) * sizeof((arrayPtr)[0]);       \
+        }                                                               \
+    } while (0)
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Pack an array of struct into a buffer, incrementing the buffer pointer.
@@ -785,6 +797,40 @@ LE_DECLARE_INLINE bool le_pack_UnpackArrayHeader
     } while (0)
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack an array of raw values from a buffer, incrementing the buffer pointer.
+ *
+ * Only for the types that can be packed with LE_PACK_PACKRAWARRAY(): the whole array is copied at
+ * once instead of unpacking one element at a time.
+ *
+ * @note Will assert if the resulted array exceeds the maximum size allowed.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_PACK_UNPACKRAWARRAY(bufferPtr,                               \
+                               arrayPtr,                                \
+                               arrayCountPtr,                           \
+                               arrayMaxCount,                           \
+                               resultPtr)                               \
+    do {                                                                \
+        if (!le_pack_UnpackArrayHeader((bufferPtr),                     \
+                                       (arrayPtr), sizeof((arrayPtr)[0]), \
+                                       (arrayCountPtr), (arrayMaxCount))) \
+        {                                                               \
+            *(resultPtr) = false;                                       \
+        }                                                               \
+        else                                                            \
+        {                                                               \
+            if (*(arrayCountPtr) > 0)                                   \
+            {                                                           \
+                memcpy((arrayPtr), *(bufferPtr), *(arrayCountPtr) * sizeof((arrayPtr)[0])); \
+                *(bufferPtr) += *(arrayCountPtr) * sizeof((arrayPtr)[0]); \
+            }                                                           \
+            *(resultPtr) = true;                                        \
+        }                                                               \
+    } while (0)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Unpack an array of struct from buffer. Since its logic is the same as that for unpacking an
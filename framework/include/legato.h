@@ -21,6 +21,7 @@
  * @subpage c_eventLoop <br>
  * @subpage c_fd <br>
  * @subpage c_fdMonitor <br>
+ * @subpage c_flatHashmap <br>
  * @subpage c_flock <br>
  * @subpage c_fs <br>
  * @subpage c_hashmap <br>
@@ -183,6 +184,7 @@ extern "C" {
 #include "le_cdata.h"
 #include "le_semaphore.h"
 #include "le_hashmap.h"
+#include "le_flatHashmap.h"
 #include "le_safeRef.h"
 #include "le_thread.h"
 #include "le_eventLoop.h"
@@ -187,6 +187,10 @@ typedef struct
 
     le_event_LayeredHandlerFunc_t   firstLayerFunc;     ///< First-layer handler function.
     void*                           secondLayerFunc;    ///< Second-layer handler function.
+#if LE_CONFIG_RUNTIME_STATS
+    statsPage_Handler_t*            statsPtr;           ///< Slot in the runtime statistics page,
+                                                        ///  or NULL if not looked up yet.
+#endif
 }
 Handler_t;
 
@@ -247,6 +251,9 @@ typedef struct
 {
     le_sls_Link_t           link;       ///< Used to link onto an Event Queue.
     EventReportType_t       type;       ///< Indicates what type of event report this is.
+#if LE_CONFIG_RUNTIME_STATS
+    uint64_t                queuedNs;   ///< When the report was queued (stats_GetTimeNs()), or 0.
+#endif
 }
 Report_t;
 
@@ -521,6 +528,93 @@ static Event_t* CreateEvent
 }
 
 
+#if LE_CONFIG_RUNTIME_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a report being queued to a thread's Event Queue in the runtime statistics page.
+ *
+ * @warning Assumes the mutex is locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountQueued_NoLock
+(
+    event_PerThreadRec_t*   perThreadRecPtr,    ///< [in] The thread's event data record.
+    Report_t*               reportPtr           ///< [in] The report.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    statsPage_Thread_t* slotPtr = perThreadRecPtr->statsPtr;
+
+    reportPtr->queuedNs = 0;
+
+    if (slotPtr != NULL)
+    {
+        // The depth only changes with the mutex locked, so doesn't need an atomic add.
+        uint64_t depth = slotPtr->queueDepth + 1;
+
+        reportPtr->queuedNs = stats_GetTimeNs();
+        stats_Set(&slotPtr->queueDepth, depth);
+        if (depth > slotPtr->queueHighWater)
+        {
+            stats_Set(&slotPtr->queueHighWater, depth);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a report being taken off a thread's Event Queue in the runtime statistics page.
+ *
+ * @warning Assumes the mutex is locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountDequeued_NoLock
+(
+    event_PerThreadRec_t*   perThreadRecPtr     ///< [in] The thread's event data record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    statsPage_Thread_t* slotPtr = perThreadRecPtr->statsPtr;
+
+    if ((slotPtr != NULL) && (slotPtr->queueDepth > 0))
+    {
+        stats_Set(&slotPtr->queueDepth, slotPtr->queueDepth - 1);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a report having been dispatched to a handler in the runtime statistics page.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountDispatched
+(
+    event_PerThreadRec_t*   perThreadRecPtr,    ///< [in] The thread's event data record.
+    const Report_t*         reportPtr,          ///< [in] The report.
+    statsPage_Handler_t*    handlerSlotPtr,     ///< [in] The handler's slot.  Can be NULL.
+    uint64_t                startNs             ///< [in] When the handler was called, or 0.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((startNs == 0) || (perThreadRecPtr->statsPtr == NULL))
+    {
+        return;
+    }
+
+    uint64_t endNs = stats_GetTimeNs();
+
+    stats_CountDispatch(handlerSlotPtr, startNs - reportPtr->queuedNs, endNs - startNs);
+    stats_Add(&perThreadRecPtr->statsPtr->dispatched, 1);
+    STATS_ADD(eventsDispatched, 1);
+}
+#else
+#   define CountQueued_NoLock(perThreadRecPtr, reportPtr)   ((void)0)
+#   define CountDequeued_NoLock(perThreadRecPtr)            ((void)0)
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Deletes a Handler object.
@@ -560,6 +654,10 @@ void event_ProcessOneEventReport
 
     // Pop an Event Report off the head of the Event Queue (inside a critical section).
     linkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue);
+    if (linkPtr != NULL)
+    {
+        CountDequeued_NoLock(perThreadRecPtr);
+    }
 
     event_Unlock(oldState);
 
@@ -571,6 +669,12 @@ void event_ProcessOneEventReport
     // Convert the link pointer into a pointer to the Report base class.
     reportObjPtr = CONTAINER_OF(linkPtr, Report_t, link);
 
+#if LE_CONFIG_RUNTIME_STATS
+    // Dispatch latency is only measured for reports timestamped when they were queued.
+    statsPage_Handler_t* handlerSlotPtr = NULL;
+    uint64_t startNs = 0;
+#endif
+
     // If it's a queued function report,
     if (reportObjPtr->type == LE_EVENT_REPORT_QUEUED_FUNC)
     {
@@ -578,10 +682,22 @@ void event_ProcessOneEventReport
         QueuedFunctionReport_t* queuedFuncReportPtr;
         queuedFuncReportPtr = CONTAINER_OF(reportObjPtr, QueuedFunctionReport_t, baseClass);
 
+#if LE_CONFIG_RUNTIME_STATS
+        if (reportObjPtr->queuedNs != 0)
+        {
+            handlerSlotPtr = stats_GetHandler(queuedFuncReportPtr->function, NULL);
+            startNs = stats_GetTimeNs();
+        }
+#endif
+
         // Call the function.
         queuedFuncReportPtr->function(queuedFuncReportPtr->param1Ptr,
                                       queuedFuncReportPtr->param2Ptr);
 
+#if LE_CONFIG_RUNTIME_STATS
+        CountDispatched(perThreadRecPtr, reportObjPtr, handlerSlotPtr, startNs);
+#endif
+
     }
     // If it's a publish-subscribe event report,
     else
@@ -628,10 +744,30 @@ void event_ProcessOneEventReport
                 reportPtr = pubSubReportPtr->payload;
             }
 
+#if LE_CONFIG_RUNTIME_STATS
+            if (reportObjPtr->queuedNs != 0)
+            {
+                // Single-layer handlers are all called through PubSubHandlerFunc(), so the
+                // second-layer function is the one that tells them apart.
+                if (handlerPtr->statsPtr == NULL)
+                {
+                    handlerPtr->statsPtr = stats_GetHandler(
+                        secondLayerFunc ? secondLayerFunc : (void*)firstLayerFunc,
+                        EVENT_NAME(handlerPtr->name));
+                }
+                handlerSlotPtr = handlerPtr->statsPtr;
+                startNs = stats_GetTimeNs();
+            }
+#endif
+
             event_Unlock(oldState);  // Unlock the mutex before calling the handler function.
                                // Don't access the Handler object anymore after this.
 
             firstLayerFunc(reportPtr, secondLayerFunc);
+
+#if LE_CONFIG_RUNTIME_STATS
+            CountDispatched(perThreadRecPtr, reportObjPtr, handlerSlotPtr, startNs);
+#endif
         }
     }
 
@@ -655,12 +791,24 @@ void event_ProcessEventReports
 {
     // Read the eventfd to fetch the number of Reports on the Event Queue and reset the count
     // to zero.
-    uint64_t numReports = fa_eventLoop_WaitForEvent(perThreadRecPtr);
+    perThreadRecPtr->liveEventCount += fa_eventLoop_WaitForEvent(perThreadRecPtr);
 
     // Process only those event reports that are already on the queue.  Anything reported by the
     // event handlers will have to wait until next time ProcessEventReports() is called.
     // This approach ensures that event handlers that re-queue events to the event
     // queue don't cause fd events to be starved.
+    uint64_t numReports = perThreadRecPtr->liveEventCount;
+
+#if LE_CONFIG_EVENT_MAX_REPORTS_PER_WAKEUP > 0
+    // Likewise, leave the rest of a large batch for later so fd events are checked in between.
+    if (numReports > LE_CONFIG_EVENT_MAX_REPORTS_PER_WAKEUP)
+    {
+        numReports = LE_CONFIG_EVENT_MAX_REPORTS_PER_WAKEUP;
+    }
+#endif
+
+    perThreadRecPtr->liveEventCount -= numReports;
+
     for (; numReports > 0; numReports--)
     {
         event_ProcessOneEventReport(perThreadRecPtr);
@@ -720,6 +868,7 @@ static void QueueFunction_NoLock
     reportPtr->param2Ptr = param2Ptr;
 
     // Queue it to the Event Queue.
+    CountQueued_NoLock(perThreadRecPtr, &reportPtr->baseClass);
     le_sls_Queue(&perThreadRecPtr->eventQueue, &reportPtr->baseClass.link);
 
     // Write to the eventfd to notify the Event Loop that there is something on the queue.
@@ -820,6 +969,12 @@ event_PerThreadRec_t* event_CreatePerThreadInfo
     recPtr->eventQueue = LE_SLS_LIST_INIT;
     recPtr->handlerList = LE_DLS_LIST_INIT;
     recPtr->fdMonitorList = LE_DLS_LIST_INIT;
+    recPtr->liveEventCount = 0;
+
+#if LE_CONFIG_RUNTIME_STATS
+    // The slot isn't shown until the thread names it in event_ThreadInit().
+    recPtr->statsPtr = stats_AddThread();
+#endif
 
     // Set the context pointer to NULL for safety's sake.
     recPtr->contextPtr = NULL;
@@ -853,6 +1008,10 @@ void event_ThreadInit
 {
     // Perform OS-specific initialization
     fa_event_ThreadInit(thread_GetEventRecPtr());
+
+#if LE_CONFIG_RUNTIME_STATS
+    stats_StartThread(thread_GetEventRecPtr()->statsPtr);
+#endif
 }
 
 
@@ -941,6 +1100,11 @@ void event_DestructThread
         le_mem_Release(reportPtr);
     }
 
+#if LE_CONFIG_RUNTIME_STATS
+    stats_FreeSlot(perThreadRecPtr->statsPtr);
+    perThreadRecPtr->statsPtr = NULL;
+#endif
+
     fa_event_DestructThread(perThreadRecPtr);
 }
 
@@ -1105,6 +1269,9 @@ le_event_HandlerRef_t _le_event_AddLayeredHandler
     handlerPtr->contextPtr = NULL;
     handlerPtr->firstLayerFunc = firstLayerFunc;
     handlerPtr->secondLayerFunc = secondLayerFunc;
+#if LE_CONFIG_RUNTIME_STATS
+    handlerPtr->statsPtr = NULL;
+#endif
 #if LE_CONFIG_EVENT_NAMES_ENABLED
     if (le_utf8_Copy(handlerPtr->name, name, sizeof(handlerPtr->name), NULL) == LE_OVERFLOW)
     {
@@ -1216,6 +1383,7 @@ void le_event_Report
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         memset(reportObjPtr->payload, 0, eventPtr->payloadSize);
         memcpy(reportObjPtr->payload, payloadPtr, payloadSize);
+        CountQueued_NoLock(perThreadRecPtr, &reportObjPtr->baseClass);
         le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
         // Increment the eventfd for the handler's thread's Event Queue.
@@ -1277,6 +1445,7 @@ void le_event_ReportWithRefCounting
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         reportObjPtr->payload[0] = objectPtr;
         le_mem_AddRef(objectPtr);
+        CountQueued_NoLock(perThreadRecPtr, &reportObjPtr->baseClass);
         le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
         // Increment the eventfd for the handler's thread's Event Queue.
@@ -12,6 +12,8 @@
 #ifndef LEGATO_LIBLEGATO_EVENTLOOP_H_INCLUDE_GUARD
 #define LEGATO_LIBLEGATO_EVENTLOOP_H_INCLUDE_GUARD
 
+#include "stats.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -58,7 +60,12 @@ typedef struct
     event_LoopState_t   state;              ///< Current state of the event loop.
     uint64_t            liveEventCount;     ///< Number of events ready for dequeing.  Ensures
                                             ///< balance between queued events and monitored fds
-                                            ///< in le_event_ServiceLoop().
+                                            ///< in le_event_ServiceLoop() and
+                                            ///< le_event_RunLoop().
+#if LE_CONFIG_RUNTIME_STATS
+    statsPage_Thread_t* statsPtr;           ///< Thread's slot in the runtime statistics page, or
+                                            ///  NULL if it doesn't have one.
+#endif
 }
 event_PerThreadRec_t;
 
@@ -174,6 +181,9 @@ void event_ProcessOneEventReport
 /**
  * Process Event Reports from the calling thread's Event Queue until the queue is empty.
  *
+ * If LE_CONFIG_EVENT_MAX_REPORTS_PER_WAKEUP is non-zero, at most that many reports are processed
+ * and the number left over is kept in the thread's liveEventCount.
+ *
  * This is usually called from the framework adaptor implementation of le_event_RunLoop() and
  * le_event_ServiceLoop()
  */
@@ -56,6 +56,24 @@ void fdMon_Report
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch FD Events to the FD Monitor's handler immediately, instead of queueing them behind
+ * the Event Reports already on the calling thread's Event Queue.
+ *
+ * This is called by the Event Loop when it detects events on a file descriptor while it still
+ * has a backlog of Event Reports to process.  Events already queued for the FD Monitor by
+ * fdMon_Report() are dispatched along with them, so that the handler isn't called again for them
+ * from the backlog.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdMon_Dispatch
+(
+    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
+    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete all FD Monitor objects for the calling thread.
@@ -0,0 +1,1189 @@
+/** @file flatHashmap.c
+ *
+ * Implementation of the @ref c_flatHashmap.
+ *
+ * Entries are stored in an open-addressed array of slots, with a parallel array of control bytes
+ * (the "Swiss table" layout).  Each control byte is CTRL_EMPTY, CTRL_DELETED, or holds the low 7
+ * bits of the hash of the key in its slot (the "H2" bits), with the sign bit clear.  The rest of
+ * the hash ("H1") picks where the probe sequence starts.
+ *
+ * A probe loads a whole group of control bytes at once and compares them all against H2, so the
+ * equality function is only called for slots that are very likely to hold the key.  The search
+ * stops at the first group containing an empty slot.  Groups are loaded at any slot position,
+ * not just at multiples of the group width, so the first GROUP_WIDTH control bytes are mirrored
+ * after the end of the control byte array.
+ *
+ * Removed entries leave a CTRL_DELETED tombstone behind, unless no probe sequence can have gone
+ * past their slot, in which case the slot is simply made empty again.  When there are no empty
+ * slots left to use, the table is rebuilt: at twice the size if it is more than half full, or at
+ * the same size to clear out tombstones otherwise.
+ *
+ * For an incremental resize, the old table is kept as oldTable while new keys go into the new
+ * table, and each insertion of a new key moves RESIZE_STEP_SLOTS slots from the old table to the
+ * new one.  Lookups check both tables until the old one has been emptied.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#if LE_CONFIG_FLAT_HASHMAP_SIMD && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define GROUP_SSE2
+#elif LE_CONFIG_FLAT_HASHMAP_NEON && defined(__ARM_NEON) && \
+      (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#   include <arm_neon.h>
+#   define GROUP_NEON
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of control bytes compared at once, and the number of bits per control byte in the
+ * bitmasks returned by the Match functions, as a power of two.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifdef GROUP_SSE2
+#   define GROUP_WIDTH      16
+#   define BITMASK_SHIFT    0
+#else
+#   define GROUP_WIDTH      8
+#   define BITMASK_SHIFT    3
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Control byte values for slots that do not hold an entry.  Both have the sign bit set, which is
+ * never set for a slot holding an entry.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CTRL_EMPTY          ((int8_t)-128)
+#define CTRL_DELETED        ((int8_t)-2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Smallest number of slots in a table.  This must be at least GROUP_WIDTH, and large enough that
+ * the 7/8 maximum load always leaves an empty slot to stop probe sequences.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN_CAPACITY        16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots of the old table moved to the new table by each insertion during an incremental
+ * resize.  Rebuilding starts with the new table having room for at least 7/16 of the old table's
+ * capacity of new keys, so this must be at least 3 for the move to finish first.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RESIZE_STEP_SLOTS   32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Returned by FindInTable() when the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NOT_FOUND           SIZE_MAX
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator position before the first entry.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ITERATOR_START      SIZE_MAX
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Bitmask with one bit (SSE2) or one byte (otherwise) per control byte of a group.  Iterate over
+ * the set bits with LowestSlot() and ClearLowest().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint64_t BitMask_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An entry.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const void* keyPtr;     ///< Pointer to key data.
+    const void* valuePtr;   ///< Pointer to value data.
+}
+Slot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An array of slots and their control bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    Slot_t*     slotsPtr;   ///< Array of capacity slots, or NULL if not allocated.
+    int8_t*     ctrlPtr;    ///< Array of capacity + GROUP_WIDTH control bytes.  The last
+                            ///  GROUP_WIDTH mirror the first ones.
+    size_t      capacity;   ///< Number of slots.  A power of two, or 0 if not allocated.
+    size_t      size;       ///< Number of slots holding an entry.
+    size_t      growthLeft; ///< Number of empty slots that can still be used before rebuilding.
+}
+Table_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The map's iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_flatHashmap_It
+{
+    size_t      position;   ///< Current slot.  The old table's slots (if any) come first, then the
+                            ///  current table's.  ITERATOR_START if not started.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_flatHashmap
+{
+    Table_t                     table;              ///< Current table.
+    Table_t                     oldTable;           ///< Table being moved into the current table
+                                                    ///  by an incremental resize.
+    size_t                      migrateIndex;       ///< Next slot of oldTable to move.
+    bool                        incrementalResize;  ///< true if resizes are incremental.
+    le_hashmap_HashFunc_t       hashFuncPtr;        ///< Hash operator.
+    le_hashmap_EqualsFunc_t     equalsFuncPtr;      ///< Equality operator.
+    struct le_flatHashmap_It    iterator;           ///< Iterator instance.
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+    const char*                 nameStr;            ///< Name of the map for diagnostic purposes.
+#endif
+}
+FlatHashmap_t;
+
+
+#if defined(GROUP_SSE2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the control bytes of a group that are equal to a key's H2 bits.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchHash
+(
+    const int8_t*   groupPtr,
+    int8_t          h2
+)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)groupPtr);
+
+    return (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the empty slots of a group.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchEmpty
+(
+    const int8_t*   groupPtr
+)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)groupPtr);
+
+    return (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(CTRL_EMPTY)));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the empty or deleted slots of a group.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchFree
+(
+    const int8_t*   groupPtr
+)
+{
+    return (uint16_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)groupPtr));
+}
+
+#else /* not GROUP_SSE2 */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The top bit and the bottom bit of each control byte in a 64-bit group.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GROUP_MSBS  UINT64_C(0x8080808080808080)
+#define GROUP_LSBS  UINT64_C(0x0101010101010101)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a group of control bytes, with the first control byte in the least significant byte.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t LoadGroup
+(
+    const int8_t*   groupPtr
+)
+{
+    uint64_t group;
+
+    memcpy(&group, groupPtr, sizeof(group));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    group = __builtin_bswap64(group);
+#endif
+    return group;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the control bytes of a group that are equal to a key's H2 bits.
+ *
+ * The integer version can report a false match in the byte after a true match.  That is harmless,
+ * because the keys of matching slots are compared anyway.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchHash
+(
+    const int8_t*   groupPtr,
+    int8_t          h2
+)
+{
+#ifdef GROUP_NEON
+    uint8x8_t ctrl = vld1_u8((const uint8_t*)groupPtr);
+
+    return vget_lane_u64(vreinterpret_u64_u8(vceq_u8(ctrl, vdup_n_u8((uint8_t)h2))), 0) &
+           GROUP_MSBS;
+#else
+    uint64_t x = LoadGroup(groupPtr) ^ (GROUP_LSBS * (uint8_t)h2);
+
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the empty slots of a group: those with the top bit set and bit 1 clear.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchEmpty
+(
+    const int8_t*   groupPtr
+)
+{
+#ifdef GROUP_NEON
+    uint8x8_t ctrl = vld1_u8((const uint8_t*)groupPtr);
+
+    return vget_lane_u64(vreinterpret_u64_u8(vceq_u8(ctrl, vdup_n_u8((uint8_t)CTRL_EMPTY))), 0) &
+           GROUP_MSBS;
+#else
+    uint64_t group = LoadGroup(groupPtr);
+
+    return group & (~group << 6) & GROUP_MSBS;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the empty or deleted slots of a group: those with the top bit set.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t MatchFree
+(
+    const int8_t*   groupPtr
+)
+{
+    return LoadGroup(groupPtr) & GROUP_MSBS;
+}
+
+#endif /* end GROUP_SSE2 */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position in its group of the first slot in a non-empty bitmask.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t LowestSlot
+(
+    BitMask_t   mask
+)
+{
+    return (size_t)__builtin_ctzll(mask) >> BITMASK_SHIFT;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of slots at the end of a group before the last slot in a non-empty bitmask.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t HighestSlotDistance
+(
+    BitMask_t   mask
+)
+{
+    return (size_t)(__builtin_clzll(mask) - (64 - (GROUP_WIDTH << BITMASK_SHIFT))) >>
+           BITMASK_SHIFT;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the first slot from a bitmask.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline BitMask_t ClearLowest
+(
+    BitMask_t   mask
+)
+{
+    return mask & (mask - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a control byte is for a slot holding an entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsFull
+(
+    int8_t      ctrl
+)
+{
+    return ctrl >= 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calculate a key's hash.  The user-supplied hash function's result is mixed with the MurmurHash3
+ * finalizer, as both the low bits (H2) and the high bits (H1) of the hash are used, and hashes
+ * such as le_hashmap_HashVoidPointer() leave some of them constant.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t HashKey
+(
+    const FlatHashmap_t*    mapPtr,
+    const void*             keyPtr
+)
+{
+    uint64_t h = mapPtr->hashFuncPtr(keyPtr);
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the part of a hash that picks where the probe sequence starts.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t H1
+(
+    size_t      hash
+)
+{
+    return hash >> 7;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the part of a hash that is stored in the control byte.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline int8_t H2
+(
+    size_t      hash
+)
+{
+    return (int8_t)(hash & 0x7F);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of entries a table of a given capacity can hold before it has to be rebuilt.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t CapacityToGrowth
+(
+    size_t      capacity
+)
+{
+    return capacity - capacity / 8;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a table's arrays and mark all its slots empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitTable
+(
+    Table_t*    tablePtr,
+    size_t      capacity    ///< [IN] Power of two, at least MIN_CAPACITY.
+)
+{
+    LE_ASSERT(capacity >= MIN_CAPACITY);
+    LE_ASSERT((capacity & (capacity - 1)) == 0);
+    LE_ASSERT(capacity < SIZE_MAX / (2 * sizeof(Slot_t)));
+
+    tablePtr->slotsPtr = malloc(capacity * sizeof(Slot_t) + capacity + GROUP_WIDTH);
+    LE_ASSERT(tablePtr->slotsPtr != NULL);
+
+    tablePtr->ctrlPtr = (int8_t*)(tablePtr->slotsPtr + capacity);
+    memset(tablePtr->ctrlPtr, CTRL_EMPTY, capacity + GROUP_WIDTH);
+
+    tablePtr->capacity = capacity;
+    tablePtr->size = 0;
+    tablePtr->growthLeft = CapacityToGrowth(capacity);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Free a table's arrays.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FreeTable
+(
+    Table_t*    tablePtr
+)
+{
+    free(tablePtr->slotsPtr);
+    memset(tablePtr, 0, sizeof(*tablePtr));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the control byte for a slot, and its mirror if it has one.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SetCtrl
+(
+    Table_t*    tablePtr,
+    size_t      index,
+    int8_t      ctrl
+)
+{
+    tablePtr->ctrlPtr[index] = ctrl;
+    if (index < GROUP_WIDTH)
+    {
+        tablePtr->ctrlPtr[tablePtr->capacity + index] = ctrl;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look for a key in a table.
+ *
+ * @return The index of the key's slot, or NOT_FOUND.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindInTable
+(
+    const FlatHashmap_t*    mapPtr,
+    const Table_t*          tablePtr,
+    size_t                  hash,
+    const void*             keyPtr
+)
+{
+    if (tablePtr->size == 0)
+    {
+        return NOT_FOUND;
+    }
+
+    size_t mask = tablePtr->capacity - 1;
+    size_t pos = H1(hash) & mask;
+    size_t stride = 0;
+    int8_t h2 = H2(hash);
+
+    for (;;)
+    {
+        const int8_t* groupPtr = tablePtr->ctrlPtr + pos;
+        BitMask_t matches;
+
+        for (matches = MatchHash(groupPtr, h2); matches != 0; matches = ClearLowest(matches))
+        {
+            size_t index = (pos + LowestSlot(matches)) & mask;
+            const void* storedKeyPtr = tablePtr->slotsPtr[index].keyPtr;
+
+            if ((storedKeyPtr == keyPtr) || mapPtr->equalsFuncPtr(storedKeyPtr, keyPtr))
+            {
+                return index;
+            }
+        }
+
+        if (MatchEmpty(groupPtr) != 0)
+        {
+            return NOT_FOUND;
+        }
+
+        // Triangular probing visits every group once the table's size is a power of two.
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the first empty or deleted slot on a hash's probe sequence.
+ *
+ * @return The slot's index.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindFreeSlot
+(
+    const Table_t*  tablePtr,
+    size_t          hash
+)
+{
+    size_t mask = tablePtr->capacity - 1;
+    size_t pos = H1(hash) & mask;
+    size_t stride = 0;
+
+    for (;;)
+    {
+        BitMask_t freeSlots = MatchFree(tablePtr->ctrlPtr + pos);
+
+        if (freeSlots != 0)
+        {
+            return (pos + LowestSlot(freeSlots)) & mask;
+        }
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store an entry in a free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void InsertAt
+(
+    Table_t*        tablePtr,
+    size_t          index,
+    size_t          hash,
+    const void*     keyPtr,
+    const void*     valuePtr
+)
+{
+    if (tablePtr->ctrlPtr[index] == CTRL_EMPTY)
+    {
+        tablePtr->growthLeft--;
+    }
+
+    SetCtrl(tablePtr, index, H2(hash));
+    tablePtr->slotsPtr[index].keyPtr = keyPtr;
+    tablePtr->slotsPtr[index].valuePtr = valuePtr;
+    tablePtr->size++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the entry from a slot.
+ *
+ * The slot can be made empty again, instead of leaving a tombstone, if every group-sized window
+ * that contains it also contains an empty slot: no probe sequence can then have gone past it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EraseAt
+(
+    Table_t*        tablePtr,
+    size_t          index
+)
+{
+    size_t indexBefore = (index - GROUP_WIDTH) & (tablePtr->capacity - 1);
+    BitMask_t emptyAfter = MatchEmpty(tablePtr->ctrlPtr + index);
+    BitMask_t emptyBefore = MatchEmpty(tablePtr->ctrlPtr + indexBefore);
+
+    if ((emptyAfter != 0) &&
+        (emptyBefore != 0) &&
+        (LowestSlot(emptyAfter) + HighestSlotDistance(emptyBefore) < GROUP_WIDTH))
+    {
+        SetCtrl(tablePtr, index, CTRL_EMPTY);
+        tablePtr->growthLeft++;
+    }
+    else
+    {
+        SetCtrl(tablePtr, index, CTRL_DELETED);
+    }
+
+    tablePtr->slotsPtr[index].keyPtr = NULL;
+    tablePtr->slotsPtr[index].valuePtr = NULL;
+    tablePtr->size--;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move the entry in one of the old table's slots, if any, to the current table.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void MoveSlot
+(
+    FlatHashmap_t*  mapPtr,
+    Table_t*        fromTablePtr,
+    size_t          index
+)
+{
+    if (IsFull(fromTablePtr->ctrlPtr[index]))
+    {
+        const Slot_t* slotPtr = &fromTablePtr->slotsPtr[index];
+        size_t hash = HashKey(mapPtr, slotPtr->keyPtr);
+
+        InsertAt(&mapPtr->table,
+                 FindFreeSlot(&mapPtr->table, hash),
+                 hash,
+                 slotPtr->keyPtr,
+                 slotPtr->valuePtr);
+
+        // The old table is discarded after this, so the tombstone never needs cleaning up.
+        SetCtrl(fromTablePtr, index, CTRL_DELETED);
+        fromTablePtr->size--;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Continue an incremental resize by moving some of the old table's slots to the current table.
+ * The old table is freed once it is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Migrate
+(
+    FlatHashmap_t*  mapPtr,
+    size_t          numSlots    ///< [IN] Maximum number of slots to move.
+)
+{
+    Table_t* oldTablePtr = &mapPtr->oldTable;
+
+    while ((numSlots > 0) && (oldTablePtr->size > 0))
+    {
+        MoveSlot(mapPtr, oldTablePtr, mapPtr->migrateIndex);
+        mapPtr->migrateIndex++;
+        numSlots--;
+    }
+
+    if (oldTablePtr->size == 0)
+    {
+        FreeTable(oldTablePtr);
+        mapPtr->migrateIndex = 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild the current table because it has no empty slots left: at twice the size if it is more
+ * than half full, or at the same size otherwise, to clear out tombstones.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Rebuild
+(
+    FlatHashmap_t*  mapPtr
+)
+{
+    Table_t oldTable;
+    size_t capacity = mapPtr->table.capacity;
+    size_t i;
+
+    // Finish any incremental resize still in progress first.
+    if (mapPtr->oldTable.capacity != 0)
+    {
+        Migrate(mapPtr, SIZE_MAX);
+        if (mapPtr->table.growthLeft > 0)
+        {
+            return;
+        }
+    }
+
+    if (mapPtr->table.size >= CapacityToGrowth(capacity) / 2)
+    {
+        capacity *= 2;
+    }
+
+    oldTable = mapPtr->table;
+    InitTable(&mapPtr->table, capacity);
+
+    if (mapPtr->incrementalResize)
+    {
+        mapPtr->oldTable = oldTable;
+        mapPtr->migrateIndex = 0;
+        return;
+    }
+
+    for (i = 0; i < oldTable.capacity; i++)
+    {
+        MoveSlot(mapPtr, &oldTable, i);
+    }
+    FreeTable(&oldTable);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look for a key in both tables.
+ *
+ * @return A pointer to the key's slot, or NULL if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+static Slot_t* FindSlot
+(
+    FlatHashmap_t*  mapPtr,
+    size_t          hash,
+    const void*     keyPtr,
+    Table_t**       tablePtrPtr     ///< [OUT] Table the slot is in.  Can be NULL.
+)
+{
+    Table_t* tablePtr = &mapPtr->table;
+    size_t index = FindInTable(mapPtr, tablePtr, hash, keyPtr);
+
+    if (index == NOT_FOUND)
+    {
+        tablePtr = &mapPtr->oldTable;
+        index = FindInTable(mapPtr, tablePtr, hash, keyPtr);
+        if (index == NOT_FOUND)
+        {
+            return NULL;
+        }
+    }
+
+    if (tablePtrPtr != NULL)
+    {
+        *tablePtrPtr = tablePtr;
+    }
+    return &tablePtr->slotsPtr[index];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the slot at an iterator position.
+ *
+ * @return The table holding the slot, or NULL if the position is past the end.
+ */
+//--------------------------------------------------------------------------------------------------
+static Table_t* PositionToSlot
+(
+    FlatHashmap_t*  mapPtr,
+    size_t          position,
+    size_t*         indexPtr    ///< [OUT] Index of the slot in the table.
+)
+{
+    if (position < mapPtr->oldTable.capacity)
+    {
+        *indexPtr = position;
+        return &mapPtr->oldTable;
+    }
+
+    position -= mapPtr->oldTable.capacity;
+    if (position < mapPtr->table.capacity)
+    {
+        *indexPtr = position;
+        return &mapPtr->table;
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the slot the iterator is on.
+ *
+ * @return The slot, or NULL if the iterator is not on an entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static Slot_t* IteratorSlot
+(
+    le_flatHashmap_It_Ref_t iteratorRef
+)
+{
+    FlatHashmap_t* mapPtr = CONTAINER_OF(iteratorRef, FlatHashmap_t, iterator);
+    size_t index = 0;
+    Table_t* tablePtr;
+
+    if (iteratorRef->position == ITERATOR_START)
+    {
+        return NULL;
+    }
+
+    tablePtr = PositionToSlot(mapPtr, iteratorRef->position, &index);
+    if ((tablePtr == NULL) || !IsFull(tablePtr->ctrlPtr[index]))
+    {
+        return NULL;
+    }
+
+    return &tablePtr->slotsPtr[index];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Flat HashMap.
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_flatHashmap_Ref_t _le_flatHashmap_Create
+(
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+    const char*                nameStr,          ///< [in] Name of the HashMap
+#endif
+    size_t                     capacity,         ///< [in] Expected number of keys
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] The hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] The equality function
+)
+{
+    FlatHashmap_t* mapPtr = calloc(1, sizeof(FlatHashmap_t));
+    size_t tableCapacity = MIN_CAPACITY;
+
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+    LE_ASSERT(nameStr);
+#endif
+    LE_ASSERT(hashFunc);
+    LE_ASSERT(equalsFunc);
+    LE_ASSERT(mapPtr);
+
+    while (CapacityToGrowth(tableCapacity) < capacity)
+    {
+        tableCapacity *= 2;
+    }
+    InitTable(&mapPtr->table, tableCapacity);
+
+    mapPtr->hashFuncPtr = hashFunc;
+    mapPtr->equalsFuncPtr = equalsFunc;
+#if LE_CONFIG_HASHMAP_NAMES_ENABLED
+    mapPtr->nameStr = nameStr;
+#endif
+
+    le_flatHashmap_GetIterator(mapPtr);
+    return mapPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a Flat HashMap.  This will not delete the data pointed to by the key and value pointers.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_Delete
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    FreeTable(&mapRef->oldTable);
+    FreeTable(&mapRef->table);
+    free(mapRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spread the cost of growing the map over the following insertions, instead of moving all the
+ * entries at once when the map becomes full.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_EnableIncrementalResize
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    mapRef->incrementalResize = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a key-value pair to a Flat HashMap. If the key already exists in the map then the previous
+ * value will be replaced with the new value passed into this function.
+ *
+ * @return  Returns NULL for a new entry or a pointer to the old value if it is replaced.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Put
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr,             ///< [in] Pointer to the key to be stored.
+    const void* valuePtr            ///< [in] Pointer to the value to be stored.
+)
+{
+    size_t hash = HashKey(mapRef, keyPtr);
+    Slot_t* slotPtr = FindSlot(mapRef, hash, keyPtr, NULL);
+
+    if (slotPtr != NULL)
+    {
+        const void* oldValuePtr = slotPtr->valuePtr;
+
+        slotPtr->valuePtr = valuePtr;
+        return (void*)oldValuePtr;
+    }
+
+    size_t index = FindFreeSlot(&mapRef->table, hash);
+
+    if ((mapRef->table.ctrlPtr[index] == CTRL_EMPTY) && (mapRef->table.growthLeft == 0))
+    {
+        Rebuild(mapRef);
+        index = FindFreeSlot(&mapRef->table, hash);
+    }
+
+    InsertAt(&mapRef->table, index, hash, keyPtr, valuePtr);
+
+    if (mapRef->oldTable.capacity != 0)
+    {
+        Migrate(mapRef, RESIZE_STEP_SLOTS);
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieve a value from a Flat HashMap.
+ *
+ * @return  Returns a pointer to the value or NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Get
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be retrieved.
+)
+{
+    Slot_t* slotPtr = FindSlot(mapRef, HashKey(mapRef, keyPtr), keyPtr, NULL);
+
+    return (slotPtr != NULL ? (void*)slotPtr->valuePtr : NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieve a stored key from a Flat HashMap.
+ *
+ * @return  Returns a pointer to the key that was stored in the map by le_flatHashmap_Put() or
+ *          NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_GetStoredKey
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be retrieved.
+)
+{
+    Slot_t* slotPtr = FindSlot(mapRef, HashKey(mapRef, keyPtr), keyPtr, NULL);
+
+    return (slotPtr != NULL ? (void*)slotPtr->keyPtr : NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a value from a Flat HashMap.  Entries are never moved by this, so the iterator stays
+ * valid.
+ *
+ * @return  Returns a pointer to the value or NULL if the key is not found.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_Remove
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be removed.
+)
+{
+    Table_t* tablePtr;
+    Slot_t* slotPtr = FindSlot(mapRef, HashKey(mapRef, keyPtr), keyPtr, &tablePtr);
+
+    if (slotPtr == NULL)
+    {
+        return NULL;
+    }
+
+    void* valuePtr = (void*)slotPtr->valuePtr;
+    EraseAt(tablePtr, slotPtr - tablePtr->slotsPtr);
+    return valuePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests if the Flat HashMap contains a particular key.
+ *
+ * @return  Returns true if the key is found, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_ContainsKey
+(
+    le_flatHashmap_Ref_t mapRef,    ///< [in] Reference to the map.
+    const void* keyPtr              ///< [in] Pointer to the key to be searched.
+)
+{
+    return (FindSlot(mapRef, HashKey(mapRef, keyPtr), keyPtr, NULL) != NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests if the Flat HashMap is empty (i.e. contains zero keys).
+ *
+ * @return  Returns true if empty, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_IsEmpty
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    return (le_flatHashmap_Size(mapRef) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of keys in the Flat HashMap.
+ *
+ * @return  The number of keys in the map.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_flatHashmap_Size
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    return mapRef->table.size + mapRef->oldTable.size;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes all the entries held in the Flat HashMap. This will not delete the data pointed to by
+ * the key and value pointers.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_flatHashmap_RemoveAll
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    Table_t* tablePtr = &mapRef->table;
+
+    FreeTable(&mapRef->oldTable);
+    mapRef->migrateIndex = 0;
+
+    memset(tablePtr->ctrlPtr, CTRL_EMPTY, tablePtr->capacity + GROUP_WIDTH);
+    tablePtr->size = 0;
+    tablePtr->growthLeft = CapacityToGrowth(tablePtr->capacity);
+
+    le_flatHashmap_GetIterator(mapRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterates over the whole map, calling the supplied callback with each key-value pair. If the
+ * callback returns false for any key then this function will return.
+ *
+ * @return  Returns true if all elements were checked; or false if iteration was stopped early
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_flatHashmap_ForEach
+(
+    le_flatHashmap_Ref_t mapRef,            ///< [in] Reference to the map.
+    le_hashmap_ForEachHandler_t forEachFn,  ///< [in] Callback function to be called with each pair.
+    void* contextPtr                        ///< [in] Pointer to a context to be supplied to the
+                                            ///<      callback.
+)
+{
+    Table_t* tables[] = { &mapRef->oldTable, &mapRef->table };
+    size_t t, i;
+
+    for (t = 0; t < NUM_ARRAY_MEMBERS(tables); t++)
+    {
+        for (i = 0; i < tables[t]->capacity; i++)
+        {
+            if (IsFull(tables[t]->ctrlPtr[i]) &&
+                !forEachFn(tables[t]->slotsPtr[i].keyPtr,
+                           tables[t]->slotsPtr[i].valuePtr,
+                           contextPtr))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets an iterator for step-by-step iteration over the map, reset to the start of the map.
+ *
+ * @return  Returns A reference to the map's iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+le_flatHashmap_It_Ref_t le_flatHashmap_GetIterator
+(
+    le_flatHashmap_Ref_t mapRef     ///< [in] Reference to the map.
+)
+{
+    mapRef->iterator.position = ITERATOR_START;
+    return &mapRef->iterator;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves the iterator to the next key/value pair in the map.
+ *
+ * @return  Returns LE_OK unless you go past the end of the map, then returns LE_NOT_FOUND.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_flatHashmap_NextNode
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+)
+{
+    FlatHashmap_t* mapPtr = CONTAINER_OF(iteratorRef, FlatHashmap_t, iterator);
+    size_t endPosition = mapPtr->oldTable.capacity + mapPtr->table.capacity;
+    size_t position = iteratorRef->position;
+
+    // ITERATOR_START + 1 wraps around to the first slot.
+    while (++position < endPosition)
+    {
+        size_t index = 0;
+        Table_t* tablePtr = PositionToSlot(mapPtr, position, &index);
+
+        if (IsFull(tablePtr->ctrlPtr[index]))
+        {
+            iteratorRef->position = position;
+            return LE_OK;
+        }
+    }
+
+    iteratorRef->position = endPosition;
+    return LE_NOT_FOUND;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieves a pointer to the key where the iterator is currently pointing.
+ *
+ * @return  Pointer to the current key, or NULL if the iterator is not ready or its entry has been
+ *          removed.
+ */
+//--------------------------------------------------------------------------------------------------
+const void* le_flatHashmap_GetKey
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+)
+{
+    Slot_t* slotPtr = IteratorSlot(iteratorRef);
+
+    return (slotPtr != NULL ? slotPtr->keyPtr : NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Retrieves a pointer to the value where the iterator is currently pointing.
+ *
+ * @return  Pointer to the current value, or NULL if the iterator is not ready or its entry has
+ *          been removed.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_flatHashmap_GetValue
+(
+    le_flatHashmap_It_Ref_t iteratorRef     ///< [IN] Reference to the iterator.
+)
+{
+    Slot_t* slotPtr = IteratorSlot(iteratorRef);
+
+    return (slotPtr != NULL ? (void*)slotPtr->valuePtr : NULL);
+}
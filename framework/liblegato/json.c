@@ -8,11 +8,39 @@
 
 #include "legato.h"
 
+#include <sys/socket.h>
+
+#if LE_CONFIG_JSON_SIMD && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define SCAN_SSE2
+#elif LE_CONFIG_JSON_SIMD && defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#   include <arm_neon.h>
+#   define SCAN_NEON
+#endif
+
 
 /// Maximum number of bytes allowed in a string value, object member name, or number's text
 /// including the null terminator.
 #define MAX_STRING_BYTES 1024
 
+/// Size of the buffer that a JSON document is read into from a file descriptor.
+#define READ_BUFFER_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ways of reading a JSON document from a file descriptor.  The parser must never consume data
+ * that follows the end of the document, because the client may want to read it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    READ_BLOCKS,        ///< Read full buffers, and seek back over any data left over at the end.
+    READ_PEEK,          ///< Peek at full buffers, and only consume the data that has been parsed.
+    READ_BOUNDED,       ///< Read no more than the smallest number of bytes left in the document.
+}
+ReadMode_t;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -57,7 +85,12 @@ typedef struct le_json_ParsingSession
     int fd;                         ///< File descriptor to read the JSON document from, if parsing
                                     ///< from a document.
     le_fdMonitor_Ref_t fdMonitor;   ///< File Descriptor Monitor used to monitor the fd.
+    ReadMode_t readMode;            ///< How the document is read from the file descriptor.
+    char readBuffer[READ_BUFFER_BYTES]; ///< Data read from the file descriptor.
     const char *jsonString;         ///< String to read from, if parsing from a string.
+    const char *dataPtr;            ///< Data being parsed (readBuffer or jsonString).
+    size_t dataLen;                 ///< # of bytes of data available at dataPtr.
+    size_t dataPos;                 ///< # of bytes of data at dataPtr that have been parsed.
     size_t bytesRead;               ///< # of bytes read from the file descriptor.
     size_t line;                    ///< Line number of the JSON document (starts at 1).
 
@@ -109,6 +142,191 @@ static le_mem_PoolRef_t ContextPool;
 static pthread_key_t HandlerKey;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the first occurrence of either of two characters.
+ *
+ * @return The index of the first occurrence, or length if neither character is found.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindEither
+(
+    const char* dataPtr,
+    size_t length,
+    char a,
+    char b
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i = 0;
+
+#if defined(SCAN_SSE2)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(dataPtr + i));
+        unsigned int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va),
+                                                           _mm_cmpeq_epi8(v, vb)));
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(SCAN_NEON)
+    const uint8x16_t va = vdupq_n_u8((uint8_t)a);
+    const uint8x16_t vb = vdupq_n_u8((uint8_t)b);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t v = vld1q_u8((const uint8_t*)dataPtr + i);
+        uint8x16_t eq = vorrq_u8(vceqq_u8(v, va), vceqq_u8(v, vb));
+        // Narrow each byte of the comparison result to 4 bits of a 64-bit mask.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                                          vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask != 0)
+        {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Compare 8 bytes at a time.  The lowest byte flagged is always a true match.
+    const uint64_t lsbs = UINT64_C(0x0101010101010101);
+    const uint64_t msbs = UINT64_C(0x8080808080808080);
+    const uint64_t wa = lsbs * (uint8_t)a;
+    const uint64_t wb = lsbs * (uint8_t)b;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, dataPtr + i, sizeof(w));
+
+        uint64_t xa = w ^ wa;
+        uint64_t xb = w ^ wb;
+        uint64_t mask = ((xa - lsbs) & ~xa & msbs) | ((xb - lsbs) & ~xb & msbs);
+        if (mask != 0)
+        {
+            return i + (__builtin_ctzll(mask) >> 3);
+        }
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        if ((dataPtr[i] == a) || (dataPtr[i] == b))
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if a character is whitespace, as isspace() in the "C" locale.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsSpace
+(
+    char c
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (c == ' ') || ((unsigned char)(c - '\t') <= '\r' - '\t');
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip over whitespace.
+ *
+ * @return The number of whitespace characters at the start of the data.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t SkipSpace
+(
+    const char* dataPtr,
+    size_t length,
+    size_t* newLinesPtr     ///< [OUT] Number of new-line characters skipped.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i = 0;
+    size_t newLines = 0;
+
+#if defined(SCAN_SSE2)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    const __m128i newLine = _mm_set1_epi8('\n');
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(dataPtr + i));
+        // '\t' to '\r' are whitespace: subtract '\t' and do an unsigned compare with the range.
+        __m128i t = _mm_sub_epi8(v, tab);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                  _mm_cmpeq_epi8(_mm_min_epu8(t, range), t));
+        unsigned int notSpace = ~_mm_movemask_epi8(ws) & 0xFFFF;
+        unsigned int newLineMask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, newLine));
+
+        if (notSpace != 0)
+        {
+            unsigned int index = __builtin_ctz(notSpace);
+
+            newLines += __builtin_popcount(newLineMask & ((1u << index) - 1));
+            *newLinesPtr = newLines;
+            return i + index;
+        }
+        newLines += __builtin_popcount(newLineMask);
+    }
+#elif defined(SCAN_NEON)
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t range = vdupq_n_u8('\r' - '\t');
+    const uint8x16_t newLine = vdupq_n_u8('\n');
+
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t v = vld1q_u8((const uint8_t*)dataPtr + i);
+        uint8x16_t ws = vorrq_u8(vceqq_u8(v, space), vcleq_u8(vsubq_u8(v, tab), range));
+        // Narrow each byte of the comparison results to 4 bits of a 64-bit mask.
+        uint64_t notSpace = vget_lane_u64(vreinterpret_u64_u8(
+                                              vshrn_n_u16(vreinterpretq_u16_u8(vmvnq_u8(ws)), 4)),
+                                          0);
+        uint64_t newLineMask = vget_lane_u64(vreinterpret_u64_u8(
+                                                 vshrn_n_u16(vreinterpretq_u16_u8(
+                                                                 vceqq_u8(v, newLine)), 4)),
+                                             0);
+
+        if (notSpace != 0)
+        {
+            unsigned int index = __builtin_ctzll(notSpace) >> 2;
+
+            newLines += __builtin_popcountll(newLineMask & ((UINT64_C(1) << (index * 4)) - 1)) / 4;
+            *newLinesPtr = newLines;
+            return i + index;
+        }
+        newLines += __builtin_popcountll(newLineMask) / 4;
+    }
+#endif
+
+    for (; (i < length) && IsSpace(dataPtr[i]); i++)
+    {
+        if (dataPtr[i] == '\n')
+        {
+            newLines++;
+        }
+    }
+
+    *newLinesPtr = newLines;
+    return i;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * @return true if parsing has not been stopped.
@@ -124,6 +342,88 @@ static inline bool NotStopped
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Consumes data that has been peeked at from the file descriptor.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ConsumePeekedData
+(
+    Parser_t* parserPtr,
+    size_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The data has already been parsed, so it can be read into the read buffer.
+    while (count > 0)
+    {
+        ssize_t bytesRead = read(parserPtr->fd, parserPtr->readBuffer, count);
+
+        if (bytesRead <= 0)
+        {
+            if ((bytesRead < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return false;
+        }
+        count -= bytesRead;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Leaves any data that has been read from the file descriptor but not parsed for the client to
+ * read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReturnUnparsedData
+(
+    Parser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((parserPtr->dataPtr != parserPtr->readBuffer) || (parserPtr->dataLen == 0))
+    {
+        return;
+    }
+
+    size_t unparsed = parserPtr->dataLen - parserPtr->dataPos;
+
+    switch (parserPtr->readMode)
+    {
+        case READ_BLOCKS:
+
+            if ((unparsed != 0) && (lseek(parserPtr->fd, -(off_t)unparsed, SEEK_CUR) == -1))
+            {
+                LE_ERROR("Failed to seek back over %" PRIuS " bytes after JSON document (%m).",
+                         unparsed);
+            }
+            break;
+
+        case READ_PEEK:
+
+            if (!ConsumePeekedData(parserPtr, parserPtr->dataPos))
+            {
+                LE_ERROR("Failed to read JSON document data that has been parsed.");
+            }
+            break;
+
+        case READ_BOUNDED:
+
+            break;
+    }
+
+    parserPtr->dataLen = 0;
+    parserPtr->dataPos = 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing.  (Stopping a stopped parser is okay.)
@@ -138,6 +438,7 @@ static void StopParsing
     if (NotStopped(parserPtr))
     {
         parserPtr->next = EXPECT_NOTHING;
+        ReturnUnparsedData(parserPtr);
         if (parserPtr->fdMonitor != NULL)
         {
             le_fdMonitor_Delete(parserPtr->fdMonitor);
@@ -480,7 +781,7 @@ static void ParseValue
 //--------------------------------------------------------------------------------------------------
 {
     // Throw away whitespace until something else comes along.
-    if (!isspace(c))
+    if (!IsSpace(c))
     {
         if (c == '{')   // Start of an object.
         {
@@ -694,7 +995,7 @@ static void ProcessChar
                 parserPtr->next = EXPECT_VALUE_OR_ARRAY_END;
                 Report(parserPtr, LE_JSON_ARRAY_START);
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr, LE_JSON_SYNTAX_ERROR, "Document must start with '{' or '['.");
             }
@@ -713,7 +1014,7 @@ static void ProcessChar
                 PushContext(parserPtr, LE_JSON_CONTEXT_MEMBER, GetEventHandler(parserPtr));
                 parserPtr->next = EXPECT_STRING;
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -728,7 +1029,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_VALUE;
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -753,7 +1054,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_MEMBER;
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -769,7 +1070,7 @@ static void ProcessChar
                 PushContext(parserPtr, LE_JSON_CONTEXT_MEMBER, GetEventHandler(parserPtr));
                 parserPtr->next = EXPECT_STRING;
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -802,7 +1103,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_VALUE;
             }
-            else if (!isspace(c))
+            else if (!IsSpace(c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -866,6 +1167,156 @@ static void ProcessChar
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes the data at parserPtr->dataPtr that hasn't been processed yet, until it has all been
+ * processed or parsing stops.
+ *
+ * Runs of whitespace between tokens and runs of ordinary string characters are handled in one
+ * go rather than one character at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessData
+(
+    Parser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while ((parserPtr->dataPos < parserPtr->dataLen) && NotStopped(parserPtr))
+    {
+        const char* runPtr = parserPtr->dataPtr + parserPtr->dataPos;
+        size_t available = parserPtr->dataLen - parserPtr->dataPos;
+        size_t runLength;
+
+        switch (parserPtr->next)
+        {
+            case EXPECT_STRING:
+
+                // Everything up to the next '"' goes into the buffer.  New-lines are left for
+                // ProcessChar() so they get counted.
+                runLength = FindEither(runPtr, available, '"', '\n');
+                if (runLength > 0)
+                {
+                    if (runLength > sizeof(parserPtr->buffer) - 1 - parserPtr->numBytes)
+                    {
+                        Error(parserPtr,
+                              LE_JSON_READ_ERROR,
+                              "Content item too long to fit in internal buffer.");
+                        return;
+                    }
+                    memcpy(parserPtr->buffer + parserPtr->numBytes, runPtr, runLength);
+                    parserPtr->numBytes += runLength;
+                    parserPtr->dataPos += runLength;
+                    parserPtr->bytesRead += runLength;
+                    continue;
+                }
+                break;
+
+            case EXPECT_OBJECT_OR_ARRAY:
+            case EXPECT_MEMBER_OR_OBJECT_END:
+            case EXPECT_COLON:
+            case EXPECT_VALUE:
+            case EXPECT_COMMA_OR_OBJECT_END:
+            case EXPECT_MEMBER:
+            case EXPECT_VALUE_OR_ARRAY_END:
+            case EXPECT_COMMA_OR_ARRAY_END:
+            {
+                // Whitespace is ignored in all these states.
+                size_t newLines;
+
+                runLength = SkipSpace(runPtr, available, &newLines);
+                if (runLength > 0)
+                {
+                    parserPtr->dataPos += runLength;
+                    parserPtr->bytesRead += runLength;
+                    parserPtr->line += newLines;
+                    continue;
+                }
+                break;
+            }
+
+            default:
+
+                break;
+        }
+
+        char c = *runPtr;
+
+        parserPtr->dataPos++;
+        parserPtr->bytesRead++;
+        if (c == '\n')
+        {
+            parserPtr->line++;
+        }
+        ProcessChar(parserPtr, c);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out the smallest number of bytes that can be left in the document, so that reading that
+ * many bytes can't consume any data following the document.
+ *
+ * @return The number of bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t MinBytesLeft
+(
+    Parser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+    le_sls_Link_t* linkPtr = le_sls_Peek(&parserPtr->contextStack);
+
+    while (linkPtr != NULL)
+    {
+        switch (CONTAINER_OF(linkPtr, Context_t, link)->type)
+        {
+            case LE_JSON_CONTEXT_OBJECT:    // Needs a '}'.
+            case LE_JSON_CONTEXT_ARRAY:     // Needs a ']'.
+            case LE_JSON_CONTEXT_STRING:    // Needs a '"'.
+                count++;
+                break;
+
+            // Needs a value, unless the value has been started, in which case what the value
+            // needs is counted instead, because the end of the value is the end of the member.
+            case LE_JSON_CONTEXT_MEMBER:
+                if (linkPtr == le_sls_Peek(&parserPtr->contextStack))
+                {
+                    count++;
+                }
+                break;
+
+            // The rest of a constant.  Constants are always on top of the stack, so the buffer
+            // holds the part of the constant that has been read.
+            case LE_JSON_CONTEXT_TRUE:
+                count += sizeof("true") - 1 - parserPtr->numBytes;
+                break;
+
+            case LE_JSON_CONTEXT_FALSE:
+                count += sizeof("false") - 1 - parserPtr->numBytes;
+                break;
+
+            case LE_JSON_CONTEXT_NULL:
+                count += sizeof("null") - 1 - parserPtr->numBytes;
+                break;
+
+            // A number can end at any point, and the top level needs nothing more once the
+            // document has started.
+            case LE_JSON_CONTEXT_NUMBER:
+            case LE_JSON_CONTEXT_DOC:
+                break;
+        }
+
+        linkPtr = le_sls_PeekNext(&parserPtr->contextStack, linkPtr);
+    }
+
+    return (count > 0) ? count : 1;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data from the JSON document file descriptor and process it.
@@ -880,11 +1331,29 @@ static void ReadData
 {
     while (NotStopped(parserPtr))
     {
-        char c;
+        size_t readSize = sizeof(parserPtr->readBuffer);
         ssize_t bytesRead;
+
+        if (parserPtr->readMode == READ_BOUNDED)
+        {
+            size_t minBytesLeft = MinBytesLeft(parserPtr);
+
+            if (minBytesLeft < readSize)
+            {
+                readSize = minBytesLeft;
+            }
+        }
+
         do
         {
-            bytesRead = read(fd, &c, 1);
+            if (parserPtr->readMode == READ_PEEK)
+            {
+                bytesRead = recv(fd, parserPtr->readBuffer, readSize, MSG_PEEK);
+            }
+            else
+            {
+                bytesRead = read(fd, parserPtr->readBuffer, readSize);
+            }
         }
         while ((bytesRead == -1) && (errno == EINTR));
 
@@ -929,12 +1398,28 @@ static void ReadData
         }
         else
         {
-            parserPtr->bytesRead++;
-            if (c == '\n')
+            parserPtr->dataPtr = parserPtr->readBuffer;
+            parserPtr->dataLen = bytesRead;
+            parserPtr->dataPos = 0;
+
+            // If parsing stops part way through the data, StopParsing() leaves the rest for the
+            // client.
+            ProcessData(parserPtr);
+
+            if ((parserPtr->readMode == READ_PEEK) && (parserPtr->dataLen != 0))
             {
-                parserPtr->line++;
+                size_t count = parserPtr->dataLen;
+
+                parserPtr->dataLen = 0;
+                if (!ConsumePeekedData(parserPtr, count))
+                {
+                    Error(parserPtr, LE_JSON_READ_ERROR, "Failed to read peeked data.");
+                    return;
+                }
             }
-            ProcessChar(parserPtr, c);
+
+            parserPtr->dataLen = 0;
+            parserPtr->dataPos = 0;
         }
     }
 }
@@ -998,30 +1483,20 @@ static void StringEventHandler
     void        *unused
 )
 {
-    char c;
-
     // Increment the reference count on the Parser object so it won't go away until we are done
     // with it, even if the client calls le_json_Cleanup() for this parser.
     le_mem_AddRef(parserPtr);
 
-    while (NotStopped(parserPtr))
+    parserPtr->dataPtr = parserPtr->jsonString;
+    parserPtr->dataLen = strlen(parserPtr->jsonString);
+    parserPtr->dataPos = 0;
+
+    ProcessData(parserPtr);
+
+    if (NotStopped(parserPtr))
     {
-        c = parserPtr->jsonString[parserPtr->bytesRead];
-        if (c == '\0') // End of string?
-        {
-            // The document has been truncated.
-            Error(parserPtr, LE_JSON_READ_ERROR, "Unexpected end of JSON string");
-            break;
-        }
-        else
-        {
-            parserPtr->bytesRead++;
-            if (c == '\n')
-            {
-                parserPtr->line++;
-            }
-            ProcessChar(parserPtr, c);
-        }
+        // The document has been truncated.
+        Error(parserPtr, LE_JSON_READ_ERROR, "Unexpected end of JSON string");
     }
 
     // We are finished with the parser object now.
@@ -1062,15 +1537,55 @@ static le_json_ParsingSessionRef_t NewParser
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Parse a JSON document received via a file descriptor.
+ * Works out how a JSON document can be read from a file descriptor without consuming any data
+ * following it.
  *
- * @return Reference to the JSON parsing session started by this function call.
+ * @return The read mode.
  */
 //--------------------------------------------------------------------------------------------------
-le_json_ParsingSessionRef_t le_json_Parse
+static ReadMode_t GetReadMode
 (
-    int fd, ///< File descriptor to read the JSON document from.
-    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    int fd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat st;
+
+    if (fstat(fd, &st) == 0)
+    {
+        if ((S_ISREG(st.st_mode) || S_ISBLK(st.st_mode)) && (lseek(fd, 0, SEEK_CUR) != -1))
+        {
+            return READ_BLOCKS;
+        }
+
+        if (S_ISSOCK(st.st_mode))
+        {
+            int type;
+            socklen_t typeSize = sizeof(type);
+
+            if ((getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &typeSize) == 0) &&
+                (type == SOCK_STREAM))
+            {
+                return READ_PEEK;
+            }
+        }
+    }
+
+    // Pipes, FIFOs, character devices, and datagram sockets.
+    return READ_BOUNDED;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document received via a file descriptor.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_Parse
+(
+    int fd, ///< File descriptor to read the JSON document from.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
     le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
     void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
 )
@@ -1080,6 +1595,8 @@ le_json_ParsingSessionRef_t le_json_Parse
     Parser_t* parserPtr = NewParser(eventHandler, errorHandler, opaquePtr);
 
     parserPtr->fd = fd;
+    parserPtr->readMode = GetReadMode(fd);
+    parserPtr->dataPtr = parserPtr->readBuffer;
     parserPtr->fdMonitor = le_fdMonitor_Create("le_json", fd, FdEventHandler, POLLIN);
     le_fdMonitor_SetContextPtr(parserPtr->fdMonitor, parserPtr);
 
@@ -1434,3 +1951,1141 @@ le_json_ParsingSessionRef_t le_json_GetSession
 {
     return GetCurrentParser(__func__);
 }
+
+
+// =============================================
+//  PARSED DOCUMENTS
+// =============================================
+
+/// Member name offset of a value that isn't an object member.
+#define NO_NAME UINT32_MAX
+
+/// Longest number accepted in a parsed document, including the null terminator.
+#define MAX_NUMBER_BYTES 64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A value in a parsed document.  Values are stored in document order, so the members or elements
+ * of an object or array follow it directly, each followed by its own members or elements.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t     type;       ///< le_json_ContextType_t of the value.
+    uint32_t    next;       ///< Next member or element of the same object or array.
+    uint32_t    count;      ///< Number of members or elements of an object or array.
+    uint32_t    name;       ///< Offset of the member name in the string arena, or NO_NAME.
+    union
+    {
+        double      number; ///< Value of a number.
+        uint32_t    string; ///< Offset of the value of a string in the string arena.
+    }
+    u;
+}
+DocValue_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A parsed document.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_json_Doc
+{
+    DocValue_t* valuesPtr;      ///< Values.  The first one is unused, so the root is value 1.
+    size_t numValues;           ///< Number of values, including the unused one.
+    size_t capacity;            ///< Number of values there is room for.
+    char* stringsPtr;           ///< String arena, holding strings and member names.
+}
+Doc_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An object or array that is being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t container;         ///< The object or array.
+    uint32_t lastChild;         ///< Its last member or element so far, or LE_JSON_NO_VALUE.
+}
+DocLevel_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the parsing of a document into a Doc_t.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* textPtr;        ///< Document text.
+    size_t textLen;             ///< Length of the document text.
+    size_t pos;                 ///< Position of the next character to parse.
+    Doc_t* docPtr;              ///< Document being built.
+    size_t stringsUsed;         ///< Bytes of the string arena in use.
+    DocLevel_t* levelsPtr;      ///< Objects and arrays being parsed, outermost first.
+    size_t depth;               ///< Number of objects and arrays being parsed.
+    size_t levelsCapacity;      ///< Number of levels there is room for.
+    char* errorMsgPtr;          ///< Buffer to put an error message in, or NULL.
+    size_t errorMsgSize;        ///< Size of the error message buffer.
+}
+DocParser_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report an error found while parsing a document.
+ *
+ * @return false.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocError
+(
+    DocParser_t* parserPtr,
+    const char* msg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((parserPtr->errorMsgPtr != NULL) && (parserPtr->errorMsgSize > 0))
+    {
+        size_t line = 1;
+        size_t i;
+
+        for (i = 0; (i < parserPtr->pos) && (i < parserPtr->textLen); i++)
+        {
+            if (parserPtr->textPtr[i] == '\n')
+            {
+                line++;
+            }
+        }
+
+        snprintf(parserPtr->errorMsgPtr, parserPtr->errorMsgSize, "%s (at line %" PRIuS ")",
+                 msg, line);
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip whitespace in a document.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void DocSkipSpace
+(
+    DocParser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t newLines;
+
+    parserPtr->pos += SkipSpace(parserPtr->textPtr + parserPtr->pos,
+                                parserPtr->textLen - parserPtr->pos,
+                                &newLines);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a value to a document, as the next member or element of the innermost object or array.
+ *
+ * @return The new value, or LE_JSON_NO_VALUE if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_json_Value_t DocAddValue
+(
+    DocParser_t* parserPtr,
+    uint32_t name       ///< Member name, or NO_NAME.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Doc_t* docPtr = parserPtr->docPtr;
+
+    if (docPtr->numValues == docPtr->capacity)
+    {
+        size_t capacity = docPtr->capacity * 2;
+
+        if (capacity > UINT32_MAX)
+        {
+            return LE_JSON_NO_VALUE;
+        }
+
+        DocValue_t* valuesPtr = realloc(docPtr->valuesPtr, capacity * sizeof(DocValue_t));
+
+        if (valuesPtr == NULL)
+        {
+            return LE_JSON_NO_VALUE;
+        }
+        docPtr->valuesPtr = valuesPtr;
+        docPtr->capacity = capacity;
+    }
+
+    le_json_Value_t value = docPtr->numValues++;
+    DocValue_t* valuePtr = &docPtr->valuesPtr[value];
+
+    memset(valuePtr, 0, sizeof(*valuePtr));
+    valuePtr->next = LE_JSON_NO_VALUE;
+    valuePtr->name = name;
+
+    if (parserPtr->depth > 0)
+    {
+        DocLevel_t* levelPtr = &parserPtr->levelsPtr[parserPtr->depth - 1];
+
+        docPtr->valuesPtr[levelPtr->container].count++;
+        if (levelPtr->lastChild != LE_JSON_NO_VALUE)
+        {
+            docPtr->valuesPtr[levelPtr->lastChild].next = value;
+        }
+        levelPtr->lastChild = value;
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse four hexadecimal digits of a \\u escape sequence.
+ *
+ * @return The code unit, or -1 if the digits are not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t DocParseHex4
+(
+    DocParser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int32_t value = 0;
+    int i;
+
+    if (parserPtr->textLen - parserPtr->pos < 4)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        char c = parserPtr->textPtr[parserPtr->pos++];
+
+        value <<= 4;
+        if ((c >= '0') && (c <= '9'))
+        {
+            value |= c - '0';
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            value |= c - 'a' + 10;
+        }
+        else if ((c >= 'A') && (c <= 'F'))
+        {
+            value |= c - 'A' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a \\u escape sequence (after the 'u'), including the second half of a surrogate pair,
+ * and append its UTF-8 encoding to a string.
+ *
+ * @return A pointer to the end of the string, or NULL if the escape sequence is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* DocParseUnicodeEscape
+(
+    DocParser_t* parserPtr,
+    char* outPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int32_t codePoint = DocParseHex4(parserPtr);
+
+    if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF))
+    {
+        // High surrogate.  The low surrogate must follow.
+        if ((parserPtr->textLen - parserPtr->pos < 2) ||
+            (parserPtr->textPtr[parserPtr->pos] != '\\') ||
+            (parserPtr->textPtr[parserPtr->pos + 1] != 'u'))
+        {
+            return NULL;
+        }
+        parserPtr->pos += 2;
+
+        int32_t low = DocParseHex4(parserPtr);
+        if ((low < 0xDC00) || (low > 0xDFFF))
+        {
+            return NULL;
+        }
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+    }
+    else if ((codePoint <= 0) || ((codePoint >= 0xDC00) && (codePoint <= 0xDFFF)))
+    {
+        // Bad digits, a null character (which can't be put in a C string) or a lone low surrogate.
+        return NULL;
+    }
+
+    if (codePoint < 0x80)
+    {
+        *outPtr++ = codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+        *outPtr++ = 0xC0 | (codePoint >> 6);
+        *outPtr++ = 0x80 | (codePoint & 0x3F);
+    }
+    else if (codePoint < 0x10000)
+    {
+        *outPtr++ = 0xE0 | (codePoint >> 12);
+        *outPtr++ = 0x80 | ((codePoint >> 6) & 0x3F);
+        *outPtr++ = 0x80 | (codePoint & 0x3F);
+    }
+    else
+    {
+        *outPtr++ = 0xF0 | (codePoint >> 18);
+        *outPtr++ = 0x80 | ((codePoint >> 12) & 0x3F);
+        *outPtr++ = 0x80 | ((codePoint >> 6) & 0x3F);
+        *outPtr++ = 0x80 | (codePoint & 0x3F);
+    }
+
+    return outPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a string in a document into the string arena.  The decoded string is never longer than
+ * its text, including the quotes, so the arena can't overflow.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParseString
+(
+    DocParser_t* parserPtr,
+    uint32_t* offsetPtr         ///< [OUT] Offset of the string in the string arena.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* textPtr = parserPtr->textPtr;
+    char* startPtr = parserPtr->docPtr->stringsPtr + parserPtr->stringsUsed;
+    char* outPtr = startPtr;
+
+    // Skip the opening quote.
+    parserPtr->pos++;
+
+    for (;;)
+    {
+        size_t runLength = FindEither(textPtr + parserPtr->pos,
+                                      parserPtr->textLen - parserPtr->pos,
+                                      '"',
+                                      '\\');
+
+        memcpy(outPtr, textPtr + parserPtr->pos, runLength);
+        outPtr += runLength;
+        parserPtr->pos += runLength;
+
+        if (parserPtr->pos >= parserPtr->textLen - 1)
+        {
+            // Even an escaped character needs two more bytes.
+            if ((parserPtr->pos < parserPtr->textLen) && (textPtr[parserPtr->pos] == '"'))
+            {
+                parserPtr->pos++;
+                break;
+            }
+            return DocError(parserPtr, "Unterminated string.");
+        }
+
+        if (textPtr[parserPtr->pos++] == '"')
+        {
+            break;
+        }
+
+        char c = textPtr[parserPtr->pos++];
+        switch (c)
+        {
+            case '"':
+            case '\\':
+            case '/':
+                *outPtr++ = c;
+                break;
+
+            case 'b':
+                *outPtr++ = '\b';
+                break;
+
+            case 'f':
+                *outPtr++ = '\f';
+                break;
+
+            case 'n':
+                *outPtr++ = '\n';
+                break;
+
+            case 'r':
+                *outPtr++ = '\r';
+                break;
+
+            case 't':
+                *outPtr++ = '\t';
+                break;
+
+            case 'u':
+                outPtr = DocParseUnicodeEscape(parserPtr, outPtr);
+                if (outPtr == NULL)
+                {
+                    return DocError(parserPtr, "Invalid \\u escape sequence in string.");
+                }
+                break;
+
+            default:
+                return DocError(parserPtr, "Invalid escape sequence in string.");
+        }
+    }
+
+    *outPtr++ = '\0';
+
+    if (!le_utf8_IsFormatCorrect(startPtr))
+    {
+        return DocError(parserPtr, "String is not valid UTF-8.");
+    }
+
+    *offsetPtr = parserPtr->stringsUsed;
+    parserPtr->stringsUsed += outPtr - startPtr;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse an object member name and the colon after it.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParseMemberName
+(
+    DocParser_t* parserPtr,
+    uint32_t* namePtr           ///< [OUT] Offset of the name in the string arena.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((parserPtr->pos >= parserPtr->textLen) || (parserPtr->textPtr[parserPtr->pos] != '"'))
+    {
+        return DocError(parserPtr, "Expected beginning of object member name (\").");
+    }
+
+    if (!DocParseString(parserPtr, namePtr))
+    {
+        return false;
+    }
+
+    DocSkipSpace(parserPtr);
+
+    if ((parserPtr->pos >= parserPtr->textLen) || (parserPtr->textPtr[parserPtr->pos] != ':'))
+    {
+        return DocError(parserPtr, "Expected ':' after object member name.");
+    }
+    parserPtr->pos++;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a number in a document.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParseNumber
+(
+    DocParser_t* parserPtr,
+    double* numberPtr           ///< [OUT] Value of the number.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char buffer[MAX_NUMBER_BYTES];
+    size_t length = 0;
+    char* endPtr;
+
+    while ((parserPtr->pos + length < parserPtr->textLen) &&
+           (strchr("+-.0123456789eE", parserPtr->textPtr[parserPtr->pos + length]) != NULL) &&
+           (parserPtr->textPtr[parserPtr->pos + length] != '\0'))
+    {
+        length++;
+    }
+
+    if (length >= sizeof(buffer))
+    {
+        return DocError(parserPtr, "Number too long.");
+    }
+
+    memcpy(buffer, parserPtr->textPtr + parserPtr->pos, length);
+    buffer[length] = '\0';
+
+    errno = 0;
+    *numberPtr = strtod(buffer, &endPtr);
+
+    if (endPtr[0] != '\0')
+    {
+        return DocError(parserPtr, "Invalid characters in number.");
+    }
+    if (errno == ERANGE)
+    {
+        return DocError(parserPtr, (*numberPtr == 0) ? "Numerical underflow occurred." :
+                                                       "Numerical overflow occurred.");
+    }
+
+    parserPtr->pos += length;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a constant (true, false or null) in a document.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParseConstant
+(
+    DocParser_t* parserPtr,
+    const char* expected
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t length = strlen(expected);
+
+    if ((parserPtr->textLen - parserPtr->pos < length) ||
+        (memcmp(parserPtr->textPtr + parserPtr->pos, expected, length) != 0))
+    {
+        char msg[64];
+
+        snprintf(msg, sizeof(msg), "Expected '%s'.", expected);
+        return DocError(parserPtr, msg);
+    }
+
+    parserPtr->pos += length;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing an object or array.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocPushLevel
+(
+    DocParser_t* parserPtr,
+    le_json_Value_t container
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (parserPtr->depth == parserPtr->levelsCapacity)
+    {
+        size_t capacity = (parserPtr->levelsCapacity == 0) ? 16 : parserPtr->levelsCapacity * 2;
+        DocLevel_t* levelsPtr = realloc(parserPtr->levelsPtr, capacity * sizeof(DocLevel_t));
+
+        if (levelsPtr == NULL)
+        {
+            return DocError(parserPtr, "Out of memory.");
+        }
+        parserPtr->levelsPtr = levelsPtr;
+        parserPtr->levelsCapacity = capacity;
+    }
+
+    parserPtr->levelsPtr[parserPtr->depth].container = container;
+    parserPtr->levelsPtr[parserPtr->depth].lastChild = LE_JSON_NO_VALUE;
+    parserPtr->depth++;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a value in a document.  If it is an object or array, only its start is parsed.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParseValue
+(
+    DocParser_t* parserPtr,
+    uint32_t name               ///< Member name of the value, or NO_NAME.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (parserPtr->pos >= parserPtr->textLen)
+    {
+        return DocError(parserPtr, "Unexpected end of document.");
+    }
+
+    le_json_Value_t value = DocAddValue(parserPtr, name);
+    if (value == LE_JSON_NO_VALUE)
+    {
+        return DocError(parserPtr, "Out of memory.");
+    }
+
+    DocValue_t* valuePtr = &parserPtr->docPtr->valuesPtr[value];
+    char c = parserPtr->textPtr[parserPtr->pos];
+
+    switch (c)
+    {
+        case '{':
+            valuePtr->type = LE_JSON_CONTEXT_OBJECT;
+            parserPtr->pos++;
+            return DocPushLevel(parserPtr, value);
+
+        case '[':
+            valuePtr->type = LE_JSON_CONTEXT_ARRAY;
+            parserPtr->pos++;
+            return DocPushLevel(parserPtr, value);
+
+        case '"':
+            valuePtr->type = LE_JSON_CONTEXT_STRING;
+            return DocParseString(parserPtr, &valuePtr->u.string);
+
+        case 't':
+            valuePtr->type = LE_JSON_CONTEXT_TRUE;
+            return DocParseConstant(parserPtr, "true");
+
+        case 'f':
+            valuePtr->type = LE_JSON_CONTEXT_FALSE;
+            return DocParseConstant(parserPtr, "false");
+
+        case 'n':
+            valuePtr->type = LE_JSON_CONTEXT_NULL;
+            return DocParseConstant(parserPtr, "null");
+
+        default:
+            if (isdigit(c) || (c == '-'))
+            {
+                valuePtr->type = LE_JSON_CONTEXT_NUMBER;
+                return DocParseNumber(parserPtr, &valuePtr->u.number);
+            }
+            return DocError(parserPtr, "Unexpected character at beginning of value.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a whole document.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DocParse
+(
+    DocParser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t name = NO_NAME;
+
+    DocSkipSpace(parserPtr);
+
+    if ((parserPtr->pos >= parserPtr->textLen) ||
+        ((parserPtr->textPtr[parserPtr->pos] != '{') && (parserPtr->textPtr[parserPtr->pos] != '[')))
+    {
+        return DocError(parserPtr, "Document must start with '{' or '['.");
+    }
+
+    for (;;)
+    {
+        // Parse a value (or the start of one, if it's an object or array).
+        size_t oldDepth = parserPtr->depth;
+
+        DocSkipSpace(parserPtr);
+        if (!DocParseValue(parserPtr, name))
+        {
+            return false;
+        }
+        name = NO_NAME;
+
+        // The first member or element of an object or array doesn't have a comma before it.
+        bool isNewContainer = (parserPtr->depth > oldDepth);
+
+        // Work out where the next value is, ending objects and arrays on the way.
+        for (;;)
+        {
+            if (parserPtr->depth == 0)
+            {
+                // That was the end of the document.  Only whitespace may follow.
+                DocSkipSpace(parserPtr);
+                if (parserPtr->pos != parserPtr->textLen)
+                {
+                    return DocError(parserPtr, "Unexpected data after end of document.");
+                }
+                return true;
+            }
+
+            DocSkipSpace(parserPtr);
+            if (parserPtr->pos >= parserPtr->textLen)
+            {
+                return DocError(parserPtr, "Unexpected end of document.");
+            }
+
+            const DocLevel_t* levelPtr = &parserPtr->levelsPtr[parserPtr->depth - 1];
+            bool isObject = (parserPtr->docPtr->valuesPtr[levelPtr->container].type ==
+                             LE_JSON_CONTEXT_OBJECT);
+            char c = parserPtr->textPtr[parserPtr->pos];
+
+            if (c == (isObject ? '}' : ']'))
+            {
+                parserPtr->pos++;
+                parserPtr->depth--;
+                isNewContainer = false;
+                continue;
+            }
+
+            if (!isNewContainer)
+            {
+                if (c != ',')
+                {
+                    return DocError(parserPtr, isObject ?
+                                    "Expected end of object (}) or a comma separator (,)." :
+                                    "Expected end of array (]) or a comma separator (,).");
+                }
+                parserPtr->pos++;
+                DocSkipSpace(parserPtr);
+            }
+
+            if (isObject && !DocParseMemberName(parserPtr, &name))
+            {
+                return false;
+            }
+            break;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a value of a document, killing the process if the value reference is not valid.
+ *
+ * @return Pointer to the value.
+ */
+//--------------------------------------------------------------------------------------------------
+static const DocValue_t* GetDocValue
+(
+    le_json_DocRef_t docRef,
+    le_json_Value_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(docRef == NULL, "Null document reference.");
+    LE_FATAL_IF((value == LE_JSON_NO_VALUE) || (value >= docRef->numValues),
+                "Invalid document value %" PRIu32 ".",
+                value);
+
+    return &docRef->valuesPtr[value];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a whole JSON document held in memory into a document that can be walked using
+ * le_json_GetRoot(), le_json_GetFirstChild(), le_json_GetNextSibling(), etc.
+ *
+ * @return Reference to the document, or NULL if the document is not valid JSON (in which case
+ *         an error message is put in the error message buffer, if one is provided).
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_DocRef_t le_json_ParseDoc
+(
+    const char* textPtr,    ///< [IN] Document text.  Does not need to be null-terminated.
+    size_t textLength,      ///< [IN] Length of the document text, in bytes.
+    char* errorMsgPtr,      ///< [OUT] Buffer to put an error message in (can be NULL).
+    size_t errorMsgSize     ///< [IN] Size of the error message buffer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DocParser_t parser =
+    {
+        .textPtr = textPtr,
+        .textLen = textLength,
+        .errorMsgPtr = errorMsgPtr,
+        .errorMsgSize = errorMsgSize,
+    };
+
+    Doc_t* docPtr = calloc(1, sizeof(Doc_t));
+    if (docPtr == NULL)
+    {
+        DocError(&parser, "Out of memory.");
+        return NULL;
+    }
+    parser.docPtr = docPtr;
+
+    // Decoded strings are never longer than their text, so this is enough for all of them.
+    // Guess at one value for every 16 bytes of text, to start with.
+    docPtr->stringsPtr = malloc(textLength + 1);
+    docPtr->capacity = (textLength / 16) + 2;
+    docPtr->valuesPtr = malloc(docPtr->capacity * sizeof(DocValue_t));
+    docPtr->numValues = 1;
+
+    bool isOk;
+    if ((docPtr->stringsPtr == NULL) || (docPtr->valuesPtr == NULL))
+    {
+        isOk = DocError(&parser, "Out of memory.");
+    }
+    else
+    {
+        memset(&docPtr->valuesPtr[0], 0, sizeof(DocValue_t));
+        isOk = DocParse(&parser);
+    }
+
+    free(parser.levelsPtr);
+
+    if (!isOk)
+    {
+        le_json_DeleteDoc(docPtr);
+        return NULL;
+    }
+
+    return docPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole JSON document from a file descriptor, up to end-of-file, and parse it into a
+ * document (see le_json_ParseDoc()).  If the file descriptor is non-blocking, this waits for data
+ * to arrive.
+ *
+ * @return Reference to the document, or NULL if the document could not be read or is not valid
+ *         JSON (in which case an error message is put in the error message buffer, if one is
+ *         provided).
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_DocRef_t le_json_ReadDoc
+(
+    int fd,                 ///< [IN] File descriptor to read the document from.
+    char* errorMsgPtr,      ///< [OUT] Buffer to put an error message in (can be NULL).
+    size_t errorMsgSize     ///< [IN] Size of the error message buffer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat st;
+    size_t capacity = READ_BUFFER_BYTES;
+    size_t length = 0;
+
+    // For regular files, read the whole file in one go if possible.
+    if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0))
+    {
+        capacity = st.st_size + 1;
+    }
+
+    char* textPtr = malloc(capacity);
+
+    for (;;)
+    {
+        if (textPtr == NULL)
+        {
+            if ((errorMsgPtr != NULL) && (errorMsgSize > 0))
+            {
+                snprintf(errorMsgPtr, errorMsgSize, "Out of memory.");
+            }
+            return NULL;
+        }
+
+        if (length == capacity)
+        {
+            char* newTextPtr = realloc(textPtr, capacity * 2);
+            if (newTextPtr == NULL)
+            {
+                free(textPtr);
+            }
+            textPtr = newTextPtr;
+            capacity *= 2;
+            continue;
+        }
+
+        ssize_t bytesRead = read(fd, textPtr + length, capacity - length);
+
+        if (bytesRead > 0)
+        {
+            length += bytesRead;
+        }
+        else if (bytesRead == 0)
+        {
+            break;
+        }
+        else if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            struct pollfd pollFd = { .fd = fd, .events = POLLIN };
+
+            (void)poll(&pollFd, 1, -1);
+        }
+        else if (errno != EINTR)
+        {
+            if ((errorMsgPtr != NULL) && (errorMsgSize > 0))
+            {
+                snprintf(errorMsgPtr, errorMsgSize, "Read failed: %m.");
+            }
+            free(textPtr);
+            return NULL;
+        }
+    }
+
+    le_json_DocRef_t docRef = le_json_ParseDoc(textPtr, length, errorMsgPtr, errorMsgSize);
+
+    free(textPtr);
+
+    return docRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a document, releasing its memory.  Strings fetched from the document can't be used after
+ * this.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_DeleteDoc
+(
+    le_json_DocRef_t docRef     ///< [IN] Document to delete.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (docRef != NULL)
+    {
+        free(docRef->valuesPtr);
+        free(docRef->stringsPtr);
+        free(docRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the root value (the outermost object or array) of a document.
+ *
+ * @return The root value.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetRoot
+(
+    le_json_DocRef_t docRef     ///< [IN] Document.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(docRef == NULL, "Null document reference.");
+
+    return 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a value in a document.
+ *
+ * @return LE_JSON_CONTEXT_OBJECT, LE_JSON_CONTEXT_ARRAY, LE_JSON_CONTEXT_STRING,
+ *         LE_JSON_CONTEXT_NUMBER, LE_JSON_CONTEXT_TRUE, LE_JSON_CONTEXT_FALSE or
+ *         LE_JSON_CONTEXT_NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ContextType_t le_json_GetValueType
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return GetDocValue(docRef, value)->type;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of members of an object or elements of an array.
+ *
+ * @return The number of members or elements, or 0 if the value is not an object or array.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_json_GetChildCount
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object or array.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return GetDocValue(docRef, value)->count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first member of an object or element of an array.
+ *
+ * @return The first member or element, or LE_JSON_NO_VALUE if there are none.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetFirstChild
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object or array.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Children follow their parent directly.
+    return (GetDocValue(docRef, value)->count > 0) ? value + 1 : LE_JSON_NO_VALUE;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next member of the same object or element of the same array.
+ *
+ * @return The next member or element, or LE_JSON_NO_VALUE if this was the last one.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_GetNextSibling
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object member or array element.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return GetDocValue(docRef, value)->next;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of an object member.
+ *
+ * @return The member name, or NULL if the value is not an object member.  The string is valid
+ *         until the document is deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_json_GetMemberName
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Object member.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const DocValue_t* valuePtr = GetDocValue(docRef, value);
+
+    if (valuePtr->name == NO_NAME)
+    {
+        return NULL;
+    }
+
+    return docRef->stringsPtr + valuePtr->name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a member of an object by name.  If the object has more than one member with this name, the
+ * first one is found.
+ *
+ * @return The member, or LE_JSON_NO_VALUE if not found or the value is not an object.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_Value_t le_json_FindMember
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t object,     ///< [IN] Object.
+    const char* name            ///< [IN] Member name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (GetDocValue(docRef, object)->type != LE_JSON_CONTEXT_OBJECT)
+    {
+        return LE_JSON_NO_VALUE;
+    }
+
+    le_json_Value_t member = le_json_GetFirstChild(docRef, object);
+
+    while (member != LE_JSON_NO_VALUE)
+    {
+        const DocValue_t* memberPtr = &docRef->valuesPtr[member];
+
+        if (strcmp(docRef->stringsPtr + memberPtr->name, name) == 0)
+        {
+            return member;
+        }
+        member = memberPtr->next;
+    }
+
+    return LE_JSON_NO_VALUE;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a string.  Escape sequences have been decoded.
+ *
+ * @return The string, which is valid until the document is deleted.
+ *
+ * @warning The value must be a string.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_json_GetStringValue
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] String value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const DocValue_t* valuePtr = GetDocValue(docRef, value);
+
+    if (valuePtr->type != LE_JSON_CONTEXT_STRING)
+    {
+        LE_FATAL("Value is a %s, not a string.", le_json_GetContextName(valuePtr->type));
+    }
+
+    return docRef->stringsPtr + valuePtr->u.string;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a number.
+ *
+ * @return The number.
+ *
+ * @warning The value must be a number.
+ */
+//--------------------------------------------------------------------------------------------------
+double le_json_GetNumberValue
+(
+    le_json_DocRef_t docRef,    ///< [IN] Document.
+    le_json_Value_t value       ///< [IN] Number value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const DocValue_t* valuePtr = GetDocValue(docRef, value);
+
+    if (valuePtr->type != LE_JSON_CONTEXT_NUMBER)
+    {
+        LE_FATAL("Value is a %s, not a number.", le_json_GetContextName(valuePtr->type));
+    }
+
+    return valuePtr->u.number;
+}
@@ -34,6 +34,19 @@
  * new events to the queue, then epoll_wait() will never be called and therefore fd events will
  * never be detected.)
  *
+ * If the EVENT_COALESCE_WAKEUPS KConfig option is enabled, the eventfd is only written when an
+ * Event Report is added to an empty Event Queue (more precisely, when no reports have been queued
+ * since the Event Loop last read the eventfd).  The number of queued reports is instead counted
+ * in the thread's pendingReportCount, under the event mutex.  When the Event Loop wakes up, it
+ * reads the eventfd once and claims the whole batch of pending reports.  A burst of reports sent
+ * to a busy thread therefore costs one write() and one read() instead of one of each per report.
+ *
+ * If EVENT_MAX_REPORTS_PER_WAKEUP is non-zero, at most that many Event Reports are processed
+ * before epoll_wait() is called again.  The rest stay claimed (in liveEventCount) and epoll_wait()
+ * is called with a zero timeout so that fd events are picked up between batches.  fd events
+ * detected while such a backlog remains are dispatched to their handlers straight away, rather
+ * than being queued behind the backlog.
+ *
  * ----
  *
  * Copyright (C) Sierra Wireless Inc.
@@ -103,8 +116,13 @@ event_PerThreadRec_t* fa_event_CreatePerThreadInfo
 
     // Open an eventfd for this thread.  This will be uses to signal to the epoll fd that there
     // are Event Reports on the Event Queue.
-    recPtr->eventQueueFd = eventfd(0, 0);
+    // The eventfd is non-blocking because the Event Loop may look for new Event Reports when
+    // epoll_wait() hasn't reported the eventfd as readable.
+    recPtr->eventQueueFd = eventfd(0, EFD_NONBLOCK);
     LE_FATAL_IF(recPtr->eventQueueFd < 0, "eventfd() failed with errno %d (%m).", errno);
+#if LE_CONFIG_EVENT_COALESCE_WAKEUPS
+    recPtr->pendingReportCount = 0;
+#endif
 
     // Add the eventfd to the list of file descriptors to wait for using epoll_wait().
     struct epoll_event ev;
@@ -169,6 +187,10 @@ void fa_event_DestructThread
  * Write to a thread's Event File Descriptor.  This increments it by one.
  *
  * This must be done exactly once for each Event Report pushed onto the thread's Event Queue.
+ * If wakeups are coalesced, only the first Event Report since the Event Loop last read the
+ * eventfd actually writes to it.
+ *
+ * @warning Assumes the event mutex is locked.
  */
 //--------------------------------------------------------------------------------------------------
 void fa_eventLoop_TriggerEvent_NoLock
@@ -184,6 +206,14 @@ void fa_eventLoop_TriggerEvent_NoLock
 
     ssize_t writeSize;
 
+#if LE_CONFIG_EVENT_COALESCE_WAKEUPS
+    // If the Event Loop hasn't claimed the previous reports yet, the eventfd is already signalled.
+    if (perThreadRecPtr->pendingReportCount++ > 0)
+    {
+        return;
+    }
+#endif
+
     for (;;)
     {
         writeSize = write(perThreadRecPtr->eventQueueFd, &writeBuff, sizeof(writeBuff));
@@ -211,7 +241,10 @@ void fa_eventLoop_TriggerEvent_NoLock
  * Read a thread's Event File Descriptor.  This fetches the value of the Event FD (which is
  * the number of event reports on the Event Queue) and resets the Event FD value to zero.
  *
- * @return The number of Event Reports on the thread's Event Queue.
+ * If wakeups are coalesced, the count is taken from the thread's pendingReportCount instead.
+ *
+ * @return The number of Event Reports added to the thread's Event Queue since the last call.
+ *         This may be zero.
  */
 //--------------------------------------------------------------------------------------------------
 uint64_t fa_eventLoop_WaitForEvent
@@ -229,13 +262,32 @@ uint64_t fa_eventLoop_WaitForEvent
     for (;;)
     {
         readSize = read(perThreadRecPtr->eventQueueFd, &readBuff, sizeof(readBuff));
+        if ((readSize == -1) && (errno == EAGAIN))
+        {
+            // Nothing has been written since the last read.
+            readBuff = 0;
+            readSize = sizeof(readBuff);
+        }
+
         if (readSize == sizeof(readBuff))
         {
+#if LE_CONFIG_EVENT_COALESCE_WAKEUPS
+            // Claim everything queued so far.  Reports queued after this will signal the eventfd
+            // again.
+            int oldState = event_Lock();
+            readBuff = perThreadRecPtr->pendingReportCount;
+            perThreadRecPtr->pendingReportCount = 0;
+            event_Unlock(oldState);
+#endif
             return readBuff;
         }
         else
         {
-            if ((readSize == -1) && (errno != EINTR))
+            if ((readSize == -1) && (errno == EINTR))
+            {
+                continue;
+            }
+            else if (readSize == -1)
             {
                 LE_FATAL("read() failed with errno %d (%m).", errno);
             }
@@ -283,11 +335,16 @@ void le_event_RunLoop
     for (;;)
     {
         // Wait for something to happen on one of the file descriptors that we are monitoring
-        // using our epoll fd.
-        int result = epoll_wait(epollFd, epollEventList, NUM_ARRAY_MEMBERS(epollEventList), -1);
-
-        // If something happened on one or more of the monitored file descriptors,
-        if (result > 0)
+        // using our epoll fd.  If Event Reports were left over from the last batch, just poll.
+        int timeout = (perThreadRecPtr->liveEventCount > 0) ? 0 : -1;
+        int result = epoll_wait(epollFd,
+                                epollEventList,
+                                NUM_ARRAY_MEMBERS(epollEventList),
+                                timeout);
+
+        // If something happened on one or more of the monitored file descriptors, or there are
+        // Event Reports left to process,
+        if ((result > 0) || ((result == 0) && (timeout == 0)))
         {
             int i;
 
@@ -305,10 +362,20 @@ void le_event_RunLoop
                 // fd that experienced the event.
                 void* safeRef = epollEventList[i].data.ptr;
 
-                if (safeRef != NULL)
+                if (safeRef == NULL)
                 {
-                    fdMon_Report(safeRef, epollEventList[i].events);
+                    continue;
                 }
+
+#if LE_CONFIG_EVENT_MAX_REPORTS_PER_WAKEUP > 0
+                // Don't make fd events wait behind Event Reports left over from the last batch.
+                if (timeout == 0)
+                {
+                    fdMon_Dispatch(safeRef, epollEventList[i].events);
+                    continue;
+                }
+#endif
+                fdMon_Report(safeRef, epollEventList[i].events);
             }
 
             // Process all the Event Reports on the Event Queue.
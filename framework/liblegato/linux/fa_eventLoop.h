@@ -21,6 +21,11 @@ typedef struct
     int                     epollFd;                ///< epoll(7) file descriptor.
     int                     eventQueueFd;           ///< eventfd(2) file descriptor for the Event
                                                     ///< Queue.
+#if LE_CONFIG_EVENT_COALESCE_WAKEUPS
+    uint64_t                pendingReportCount;     ///< Event Reports queued since the Event Loop
+                                                    ///< last read the eventfd.  Protected by the
+                                                    ///< event mutex.
+#endif
 }
 event_LinuxPerThreadRec_t;
 
@@ -12,10 +12,17 @@
  *
  * When a file descriptor event is detected by the Event Loop, fdMon_Report() is called with
  * the FD Monitor Reference (a safe reference) and a bit map containing the events that were
- * detected.  fdMon_Report() queues a function call (DispatchToHandler()) to the calling thread.
+ * detected.  fdMon_Report() adds the events to the FD Monitor's queued events and, unless one is
+ * already queued, queues a function call (DispatchToHandler()) to the calling thread.
  * When that function gets called, it does a look-up of the safe reference.  If it finds an
  * FD Monitor object matching that reference (it could have been deleted in the meantime), then
- * it calls its registered handler function for that event.
+ * it calls its registered handler function for the queued events.
+ *
+ * If the Event Loop still has a backlog of Event Reports when it detects fd events (see
+ * EVENT_MAX_REPORTS_PER_WAKEUP), it calls fdMon_Dispatch() instead, which calls the handler
+ * directly so that the fd events don't wait behind the backlog.  It takes the queued events along
+ * with the new ones, so a DispatchToHandler() call still waiting in the backlog then finds no
+ * events and doesn't call the handler again for the same event.
  *
  * The reason it was decided not to use Publish-Subscribe Events for this feature is that Event IDs
  * can't be deleted, and yet FD Monitors can.
@@ -107,6 +114,8 @@ typedef struct FdMonitor
     int                     fd;                 ///< File descriptor being monitored.
     uint32_t                epollEvents;        ///< epoll(7) flags for events being monitored.
     bool                    isAlwaysReady;      ///< Don't use epoll(7).  Treat as always ready.
+    bool                    isDispatchQueued;   ///< DispatchToHandler() is on the Event Queue.
+    uint32_t                queuedEvents;       ///< epoll(7) flags for DispatchToHandler() to report.
     le_fdMonitor_Ref_t safeRef;            ///< Safe Reference for this object.
     event_PerThreadRec_t*   threadRecPtr;       ///< Ptr to per-thread data for monitoring thread.
 
@@ -409,37 +418,80 @@ static void DeleteFdMonitor
 }
 
 
+static void DispatchToHandler(void* param1Ptr, void* param2Ptr);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Dispatch an FD Event to the appropriate registered handler function.
+ * Queue FD Events to be dispatched to an FD Monitor's handler function by the Event Loop.
+ *
+ * Only one DispatchToHandler() call is queued at a time for an FD Monitor: events reported while
+ * it is waiting on the Event Queue are added to the ones it will report.
  */
 //--------------------------------------------------------------------------------------------------
-static void DispatchToHandler
+static void QueueDispatch
 (
-    void* param1Ptr,    ///< FD Monitor safe reference.
-    void* param2Ptr     ///< epoll() event flags.
+    FdMonitor_t*    fdMonitorPtr,   ///< [in] FD Monitor object for the fd.
+    uint32_t        eventFlags      ///< [in] OR'd together event flags from epoll_wait().
 )
 //--------------------------------------------------------------------------------------------------
 {
-    uint32_t epollEventFlags = (uint32_t)(size_t)param2Ptr;
+    fdMonitorPtr->queuedEvents |= eventFlags;
+
+    if (!fdMonitorPtr->isDispatchQueued)
+    {
+        fdMonitorPtr->isDispatchQueued = true;
+        le_event_QueueFunction(DispatchToHandler, fdMonitorPtr->safeRef, NULL);
+    }
+}
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up an FD Monitor object owned by the calling thread.
+ *
+ * @return Pointer to the object, or NULL if it has been deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+static FdMonitor_t* LookupMonitor
+(
+    void*   safeRef     ///< [in] FD Monitor safe reference.
+)
+//--------------------------------------------------------------------------------------------------
+{
     LOCK
 
     // Get a pointer to the FD Monitor object for this fd.
-    FdMonitor_t* fdMonitorPtr = le_ref_Lookup(FdMonitorRefMap, param1Ptr);
+    FdMonitor_t* fdMonitorPtr = le_ref_Lookup(FdMonitorRefMap, safeRef);
 
     UNLOCK
 
     // If the FD Monitor object has been deleted, we can just ignore this.
     if (fdMonitorPtr == NULL)
     {
-        TRACE("Discarding events for non-existent FD Monitor %p.", param1Ptr);
-        return;
+        TRACE("Discarding events for non-existent FD Monitor %p.", safeRef);
+        return NULL;
     }
 
     // Sanity check: The FD monitor must belong to the current thread.
     LE_ASSERT(thread_GetEventRecPtr() == fdMonitorPtr->threadRecPtr);
 
+    return fdMonitorPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call an FD Monitor's registered handler function for FD Events.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallHandler
+(
+    FdMonitor_t*    fdMonitorPtr,   ///< [in] FD Monitor object for the fd.
+    uint32_t        epollEventFlags ///< [in] epoll() event flags.
+)
+//--------------------------------------------------------------------------------------------------
+{
     // Mask out any events that have been disabled since epoll_wait() reported these events to us.
     epollEventFlags &= (fdMonitorPtr->epollEvents | EPOLLERR | EPOLLHUP | EPOLLRDHUP);
 
@@ -450,7 +502,7 @@ static void DispatchToHandler
         //       we will only end up in here if both POLLIN and POLLOUT are disabled, in which case
         //       returning now will prevent re-queuing of DispatchToHandler(), which is what we
         //       want.  When either POLLIN or POLLOUT are re-enabled, le_fdMonitor_Enable() will
-        //       call fdMon_Report() to get things going again.
+        //       queue it again to get things going again.
         return;
     }
 
@@ -489,7 +541,7 @@ static void DispatchToHandler
     // when one of them is re-enabled.
     if ((fdMonitorPtr->isAlwaysReady) && (fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT)))
     {
-        fdMon_Report(fdMonitorPtr->safeRef, fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT));
+        QueueDispatch(fdMonitorPtr, fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT));
     }
 
     // Release our reference.  We don't need the Monitor object anymore.
@@ -497,6 +549,35 @@ static void DispatchToHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch the FD Events queued for an FD Monitor to its registered handler function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DispatchToHandler
+(
+    void* param1Ptr,    ///< FD Monitor safe reference.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FdMonitor_t* fdMonitorPtr = LookupMonitor(param1Ptr);
+
+    if (fdMonitorPtr == NULL)
+    {
+        return;
+    }
+
+    // Take the queued events.  There are none left if fdMon_Dispatch() already took them.
+    uint32_t epollEventFlags = fdMonitorPtr->queuedEvents;
+
+    fdMonitorPtr->queuedEvents = 0;
+    fdMonitorPtr->isDispatchQueued = false;
+
+    CallHandler(fdMonitorPtr, epollEventFlags);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Update the epoll(7) FD for a given FD Monitor object.
@@ -614,7 +695,41 @@ void fdMon_Report
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_event_QueueFunction(DispatchToHandler, safeRef, (void*)(ssize_t)eventFlags);
+    FdMonitor_t* fdMonitorPtr = LookupMonitor(safeRef);
+
+    if (fdMonitorPtr != NULL)
+    {
+        QueueDispatch(fdMonitorPtr, eventFlags);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch FD Events to the FD Monitor's handler immediately, instead of queueing them behind
+ * the Event Reports already on the calling thread's Event Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdMon_Dispatch
+(
+    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
+    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FdMonitor_t* fdMonitorPtr = LookupMonitor(safeRef);
+
+    if (fdMonitorPtr == NULL)
+    {
+        return;
+    }
+
+    // Also take the events of a DispatchToHandler() call still waiting on the Event Queue, so that
+    // it doesn't call the handler again for the same events.
+    eventFlags |= fdMonitorPtr->queuedEvents;
+    fdMonitorPtr->queuedEvents = 0;
+
+    CallHandler(fdMonitorPtr, eventFlags);
 }
 
 
@@ -700,6 +815,8 @@ le_fdMonitor_Ref_t _le_fdMonitor_Create
     fdMonitorPtr->fd = fd;
     fdMonitorPtr->epollEvents = PollToEPoll(events) | EPOLLWAKEUP;  // Non-deferrable by default.
     fdMonitorPtr->isAlwaysReady = false;
+    fdMonitorPtr->isDispatchQueued = false;
+    fdMonitorPtr->queuedEvents = 0;
     fdMonitorPtr->threadRecPtr = &perThreadRecPtr->portablePerThreadRec;
     fdMonitorPtr->handlerFunc = handlerFunc;
     fdMonitorPtr->contextPtr = NULL;
@@ -736,7 +853,7 @@ le_fdMonitor_Ref_t _le_fdMonitor_Create
             uint32_t epollEvents = fdMonitorPtr->epollEvents & (EPOLLIN | EPOLLOUT);
             if (epollEvents != 0)
             {
-                fdMon_Report(fdMonitorPtr->safeRef, epollEvents);
+                QueueDispatch(fdMonitorPtr, epollEvents);
             }
         }
         else
@@ -815,7 +932,7 @@ void le_fdMonitor_Enable
         if ((handlerMonitorPtr == NULL) || (handlerMonitorPtr->safeRef == monitorRef))
         {
             // Queue up DispatchToHandler() for this fd.
-            fdMon_Report(monitorRef, epollEvents & (EPOLLIN | EPOLLOUT));
+            QueueDispatch(monitorPtr, epollEvents & (EPOLLIN | EPOLLOUT));
         }
     }
 
@@ -23,6 +23,7 @@
 #include "atomFile.h"
 #include "fs.h"
 #include "rand.h"
+#include "stats.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -50,6 +51,9 @@ __attribute__((constructor)) void _legato_InitFramework
     // hasn't been called yet.  Keep it that way.  Also, be careful when using logging inside
     // the memory pool module, because there is the risk of creating infinite recursion.
 
+#if LE_CONFIG_RUNTIME_STATS
+    stats_Init();      // Uses nothing else.  Must come first so that every pool is counted.
+#endif
     mem_Init();
     log_Init();        // Uses memory pools.
     sig_Init();        // Uses memory pools.
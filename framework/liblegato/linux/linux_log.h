@@ -153,4 +153,20 @@ void log_LogGenericMsg
     const char* msgPtr          ///< [IN] Message.
 );
 
+#if LE_CONFIG_LOG_BINARY_RING
+#include "logRing.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message decoded from another process's binary log ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void log_LogRingMsg
+(
+    const char* procNamePtr,        ///< [IN] Process name.
+    pid_t pid,                      ///< [IN] PID of the process.
+    const logRing_Msg_t* msgPtr     ///< [IN] Message.
+);
+#endif
+
 #endif // LINUX_LOG_INCLUDE_GUARD
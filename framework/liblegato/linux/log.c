@@ -12,6 +12,7 @@
 #include "logDaemon/logDaemon.h"
 #include "limit.h"
 #include "messagingSession.h"
+#include "logRing.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -746,6 +747,70 @@ static void RegisterWithLogControlDaemon
 }
 
 
+#if LE_CONFIG_LOG_BINARY_RING
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates this process's binary log ring and passes it to the Log Control Daemon.  Nothing is
+ * written to the ring unless the Log Control Daemon accepts it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ShareRingWithLogControlDaemon
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* procNamePtr = le_arg_GetProgramName();
+    if (procNamePtr == NULL)
+    {
+        procNamePtr = "n/a";
+    }
+
+    int ringFd = logRing_Create(procNamePtr);
+    if (ringFd < 0)
+    {
+        return;
+    }
+
+    // The ring keeps its own file descriptor, and the message closes the one it sends.
+    int fd = dup(ringFd);
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to duplicate log ring fd. Errno = %d (%m).", errno);
+        logRing_Delete();
+        return;
+    }
+
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(IpcSessionRef);
+    char* packetPtr = le_msg_GetPayloadPtr(msgRef);
+
+    snprintf(packetPtr, LOG_MAX_CMD_PACKET_BYTES, "%c%s/%s/%d",
+             LOG_CMD_SHARE_RING, procNamePtr, STRINGIZE(LE_COMPONENT_NAME), getpid());
+    le_msg_SetFd(msgRef, fd);
+
+    // The response's payload is the result code.
+    le_result_t result = LE_COMM_ERROR;
+
+    msgRef = le_msg_RequestSyncResponse(msgRef);
+    if (msgRef != NULL)
+    {
+        memcpy(&result, le_msg_GetPayloadPtr(msgRef), sizeof(result));
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    if (result == LE_OK)
+    {
+        logRing_Start();
+    }
+    else
+    {
+        LE_WARN("Log Control Daemon did not accept binary log ring (%s).", LE_RESULT_TXT(result));
+        logRing_Delete();
+    }
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the logging system.
@@ -868,6 +933,10 @@ void log_ConnectToControlDaemon
 
             linkPtr = le_sls_PeekNext(&SessionList, linkPtr);
         }
+
+#if LE_CONFIG_LOG_BINARY_RING
+        ShareRingWithLogControlDaemon();
+#endif
     }
 }
 
@@ -1026,6 +1095,83 @@ static int ConvertToSyslogLevel
 #endif
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a formatted log message out to the log.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteMsg
+(
+    le_log_Level_t level,               ///< [IN] Severity level, or -1 for a trace.
+    const char* levelPtr,               ///< [IN] Level (or trace keyword) string.
+    const char* procNamePtr,            ///< [IN] Process name.
+    pid_t pid,                          ///< [IN] PID of the process.
+    const char* compNamePtr,            ///< [IN] Component name.
+    const char* threadNamePtr,          ///< [IN] Thread name.
+    const char* baseFileNamePtr,        ///< [IN] File name, without directory.
+    const char* functionNamePtr,        ///< [IN] Function name, or NULL.
+    unsigned int lineNumber,            ///< [IN] Line number.
+    const char* msgPtr,                 ///< [IN] The user message.
+    const time_t* timePtr               ///< [IN] Time the message was logged, or NULL for now.
+)
+{
+    // If running on an embedded target, write the message out to the log.
+#ifdef LEGATO_EMBEDDED
+
+    if (functionNamePtr == NULL)
+    {
+        syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %d | %s\n",
+           levelPtr, procNamePtr, pid, compNamePtr, threadNamePtr, baseFileNamePtr,
+           lineNumber, msgPtr);
+    }
+    else
+    {
+        syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
+           levelPtr, procNamePtr, pid, compNamePtr, threadNamePtr, baseFileNamePtr,
+           functionNamePtr, lineNumber, msgPtr);
+    }
+
+    // If running on a PC, write the message to standard error with a timestamp added.
+#else
+
+    time_t now;
+    char timeStamp[26] = "";
+    char* timeStampPtr = timeStamp;
+
+    if (timePtr != NULL)
+    {
+        now = *timePtr;
+    }
+    else
+    {
+        time(&now);
+    }
+
+    if ( (now != ((time_t)-1)) && (ctime_r(&now, timeStamp) != NULL) )
+    {
+        // Tue Jan 14 18:01:56 2014
+        // 0123456789012345678901234
+        timeStampPtr = timeStamp + 4; // Skip day of week.
+        timeStamp[19] = '\0';  // Exclude the year.
+    }
+
+    if (functionNamePtr == NULL)
+    {
+        fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %d | %s\n",
+                timeStampPtr, levelPtr, procNamePtr, pid, compNamePtr,
+                threadNamePtr, baseFileNamePtr, lineNumber, msgPtr);
+    }
+    else
+    {
+        fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
+            timeStampPtr, levelPtr, procNamePtr, pid, compNamePtr, threadNamePtr,
+            baseFileNamePtr, functionNamePtr, lineNumber, msgPtr);
+    }
+
+#endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Builds the log message and sends it to the logging system.
@@ -1089,6 +1235,27 @@ void _le_log_Send
     // Get the thread name.
     const char* threadNamePtr = le_thread_GetMyName();
 
+    va_list varParams;
+
+#if LE_CONFIG_LOG_BINARY_RING
+    // Debug, info and trace messages go into the binary log ring, if this process has one, and
+    // are formatted later by the Log Control Daemon.  More severe messages are written right away.
+    if ((int)level < LE_LOG_WARN)
+    {
+        bool isWritten;
+
+        va_start(varParams, formatPtr);
+        isWritten = logRing_Write(level, levelPtr, compNamePtr, baseFileNamePtr, functionNamePtr,
+                                  lineNumber, threadNamePtr, savedErrno, formatPtr, varParams);
+        va_end(varParams);
+
+        if (isWritten)
+        {
+            return;
+        }
+    }
+#endif
+
     // Get the process name.
     const char* procNamePtr = le_arg_GetProgramName();
     if (procNamePtr == NULL)
@@ -1099,7 +1266,6 @@ void _le_log_Send
     // Get the user message.
     char msg[MAX_MSG_SIZE] = "";
 
-    va_list varParams;
     va_start(varParams, formatPtr);
 
     // Reset the errno to ensure that we report the proper errno value.
@@ -1111,52 +1277,31 @@ void _le_log_Send
 
     va_end(varParams);
 
-    // If running on an embedded target, write the message out to the log.
-#ifdef LEGATO_EMBEDDED
-
-    if (functionNamePtr == NULL)
-    {
-        syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %d | %s\n",
-           levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
-           lineNumber, msg);
-    }
-    else
-    {
-        syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-           levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
-           functionNamePtr, lineNumber, msg);
-    }
-
-    // If running on a PC, write the message to standard error with a timestamp added.
-#else
-
-    time_t now;
-    char timeStamp[26] = "";
-    char* timeStampPtr = timeStamp;
+    WriteMsg(level, levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
+             functionNamePtr, lineNumber, msg, NULL);
+}
 
-    if ( (time(&now) != ((time_t)-1)) && (ctime_r(&now, timeStamp) != NULL) )
-    {
-        // Tue Jan 14 18:01:56 2014
-        // 0123456789012345678901234
-        timeStampPtr = timeStamp + 4; // Skip day of week.
-        timeStamp[19] = '\0';  // Exclude the year.
-    }
 
-    if (functionNamePtr == NULL)
-    {
-        fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %d | %s\n",
-                timeStampPtr, levelPtr, procNamePtr, getpid(), compNamePtr,
-                threadNamePtr, baseFileNamePtr, lineNumber, msg);
-    }
-    else
-    {
-        fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-            timeStampPtr, levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr,
-            baseFileNamePtr, functionNamePtr, lineNumber, msg);
-    }
+#if LE_CONFIG_LOG_BINARY_RING
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a message decoded from another process's binary log ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void log_LogRingMsg
+(
+    const char* procNamePtr,        ///< [IN] Process name.
+    pid_t pid,                      ///< [IN] PID of the process.
+    const logRing_Msg_t* msgPtr     ///< [IN] Message.
+)
+{
+    time_t msgTime = msgPtr->timestamp / 1000000000ULL;
 
-#endif
+    WriteMsg(msgPtr->level, msgPtr->levelStr, procNamePtr, pid, msgPtr->compName,
+             msgPtr->threadName, msgPtr->fileName, msgPtr->functionName, msgPtr->line,
+             msgPtr->msg, &msgTime);
 }
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,979 @@
+/** @file logRing.c
+ *
+ * Binary log ring writer, used by the logging code in every process, and reader, used by the
+ * Log Control Daemon.  See logRing.h for the layout of a ring.
+ *
+ * The writer keeps a cache of the call sites and thread names it has added to the dictionary,
+ * keyed by the pointers it was given, so a message from a call site that has been seen before
+ * costs a hash lookup, a copy of the arguments and a timestamp.  All writes are made with the
+ * ring's mutex held, so the ring has a single writer even in multi-threaded processes.
+ *
+ * Once the cache or the dictionary is full, or when the ring has no room for a record, messages
+ * are not written to the ring and the caller logs them directly.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "logRing.h"
+#include "fileDescriptor.h"
+
+#if LE_CONFIG_LOG_BINARY_RING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// memfd_create() and file sealing are needed.  Older C libraries don't have a wrapper for
+// memfd_create(), so make the system call directly.
+#if defined(__NR_memfd_create) && defined(F_ADD_SEALS)
+#   define HAVE_MEMFD 1
+#else
+#   define HAVE_MEMFD 0
+#endif
+
+#ifndef MFD_CLOEXEC
+#   define MFD_CLOEXEC          0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#   define MFD_ALLOW_SEALING    0x0002U
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of call sites the writer can cache (power of 2).  Only three quarters of them are used,
+ * to keep probe sequences short.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SITE_CACHE_SIZE         512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of thread names the writer can cache (power of 2).
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_CACHE_SIZE       64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Round a size up to a multiple of a power of 2.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ALIGN_UP(size, align)   (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dictionary offset returned when an entry can't be added.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NO_ENTRY                UINT32_MAX
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A cached call site.  The pointers are the ones the site's messages were logged with.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char*     formatPtr;                      ///< Format string (NULL if the slot is free).
+    const char*     dictFormatPtr;                  ///< Copy of the format in the dictionary.
+    const char*     fileNamePtr;                    ///< File name.
+    const char*     functionNamePtr;                ///< Function name.
+    const char*     levelStr;                       ///< Level or trace keyword string.
+    const char*     compNamePtr;                    ///< Component name.
+    unsigned int    line;                           ///< Line number.
+    uint32_t        offset;                         ///< Dictionary offset of the site.
+    int             numArgs;                        ///< Number of arguments, or -1 for text.
+    uint8_t         types[LOGRING_MAX_ARGS];        ///< Argument types (logRing_ArgType_t).
+    int16_t         precisions[LOGRING_MAX_ARGS];   ///< Precisions of string arguments.
+}
+Site_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A cached thread name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char*     namePtr;        ///< Thread name pointer (NULL if the slot is free).
+    uint32_t        offset;         ///< Dictionary offset of the name.
+}
+ThreadName_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A process's ring, as mapped by the Log Control Daemon.
+ */
+//--------------------------------------------------------------------------------------------------
+struct logRing_Reader
+{
+    logRing_Header_t*   headerPtr;      ///< Start of the mapping.
+    size_t              mapSize;        ///< Size of the mapping.
+    uint32_t            dictSize;       ///< Size of the dictionary.
+    uint32_t            ringSize;       ///< Size of the record ring.
+    uint64_t            tail;           ///< Position of the next record to read.
+    uint64_t            overflows;      ///< Overflow count seen by the last drain.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This process's ring.  NULL if there isn't one.
+ */
+//--------------------------------------------------------------------------------------------------
+static logRing_Header_t* HeaderPtr;
+static uint8_t* DictPtr;
+static uint8_t* RingPtr;
+static uint32_t DictSize;
+static uint32_t RingSize;
+static size_t MapSize;
+static int RingFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writer's copies of the positions and counts it publishes in the header.  The header is shared
+ * with the Log Control Daemon, so the writer never reads them back from it.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t Head;
+static uint64_t Oldest;
+static uint32_t DictUsed;
+static uint64_t Overflows;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true once the Log Control Daemon has accepted the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsStarted;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writer's caches of call sites and thread names, and the number of call sites cached.
+ */
+//--------------------------------------------------------------------------------------------------
+static Site_t* Sites;
+static size_t NumSites;
+static ThreadName_t ThreadNames[THREAD_CACHE_SIZE];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex protecting the writer's state and the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which reader objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ReaderPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop writing to the ring in a child process after a fork(), because the ring is still shared
+ * with the parent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopInChild
+(
+    void
+)
+{
+    IsStarted = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash a pointer.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t HashPtr
+(
+    const void* ptr
+)
+{
+    uint64_t h = (uintptr_t)ptr * 0x9E3779B97F4A7C15ULL;
+
+    return (size_t)(h >> 32);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append an entry to the dictionary.
+ *
+ * @return The entry's offset, or NO_ENTRY if the dictionary is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t AddEntry
+(
+    uint8_t type,
+    uint8_t flags,
+    int level,
+    unsigned int line,
+    const char** stringsPtr,
+    size_t numStrings
+)
+{
+    size_t lengths[5];
+    size_t size = sizeof(logRing_Entry_t);
+    size_t i;
+
+    for (i = 0; i < numStrings; i++)
+    {
+        lengths[i] = strlen(stringsPtr[i]) + 1;
+        size += lengths[i];
+    }
+    size = ALIGN_UP(size, 4);
+
+    uint32_t offset = DictUsed;
+
+    if ((size > LOGRING_MAX_ENTRY_BYTES) || (size > DictSize - offset))
+    {
+        return NO_ENTRY;
+    }
+
+    logRing_Entry_t* entryPtr = (logRing_Entry_t*)(DictPtr + offset);
+    char* strPtr = entryPtr->strings;
+
+    entryPtr->size = size;
+    entryPtr->type = type;
+    entryPtr->flags = flags;
+    entryPtr->level = level;
+    entryPtr->line = line;
+    for (i = 0; i < numStrings; i++)
+    {
+        memcpy(strPtr, stringsPtr[i], lengths[i]);
+        strPtr += lengths[i];
+    }
+    memset(strPtr, 0, (char*)entryPtr + size - strPtr);
+
+    // Publish the entry before any record that uses it.
+    DictUsed = offset + size;
+    __atomic_store_n(&HeaderPtr->dictUsed, DictUsed, __ATOMIC_RELEASE);
+
+    return offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a call site in the cache, adding it to the cache and the dictionary if it isn't there.
+ *
+ * @return The site, or NULL if it couldn't be added.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Site_t* GetSite
+(
+    int level,
+    const char* levelStr,
+    const char* compNamePtr,
+    const char* fileNamePtr,
+    const char* functionNamePtr,
+    unsigned int line,
+    const char* formatPtr
+)
+{
+    size_t i = (HashPtr(formatPtr) ^ HashPtr(fileNamePtr) ^ line) & (SITE_CACHE_SIZE - 1);
+    Site_t* sitePtr;
+
+    for (;;)
+    {
+        sitePtr = &Sites[i];
+
+        if (sitePtr->formatPtr == NULL)
+        {
+            break;
+        }
+        if ((sitePtr->formatPtr == formatPtr) &&
+            (sitePtr->fileNamePtr == fileNamePtr) &&
+            (sitePtr->line == line) &&
+            (sitePtr->levelStr == levelStr) &&
+            (sitePtr->compNamePtr == compNamePtr) &&
+            (sitePtr->functionNamePtr == functionNamePtr))
+        {
+            return sitePtr;
+        }
+        i = (i + 1) & (SITE_CACHE_SIZE - 1);
+    }
+
+    if (NumSites >= SITE_CACHE_SIZE / 4 * 3)
+    {
+        return NULL;
+    }
+
+    logRing_ArgType_t types[LOGRING_MAX_ARGS];
+    int precisions[LOGRING_MAX_ARGS];
+    int numArgs = -1;
+
+    if (strlen(formatPtr) < LOGRING_MAX_FORMAT_BYTES)
+    {
+        numArgs = logRing_ParseFormat(formatPtr, types, precisions);
+    }
+
+    // Messages from sites with formats that can't be packed are written as text, so the site's
+    // format string isn't needed.
+    const char* strings[5] =
+    {
+        levelStr,
+        compNamePtr,
+        fileNamePtr,
+        (functionNamePtr != NULL) ? functionNamePtr : "",
+        (numArgs >= 0) ? formatPtr : ""
+    };
+
+    uint32_t offset = AddEntry(LOGRING_ENTRY_SITE,
+                               (functionNamePtr != NULL) ? LOGRING_SITE_HAS_FUNCTION : 0,
+                               level,
+                               line,
+                               strings,
+                               NUM_ARRAY_MEMBERS(strings));
+    if (offset == NO_ENTRY)
+    {
+        return NULL;
+    }
+
+    // The format string is the site's last string.
+    logRing_Entry_t* entryPtr = (logRing_Entry_t*)(DictPtr + offset);
+    const char* strPtr = entryPtr->strings;
+    for (i = 0; i < NUM_ARRAY_MEMBERS(strings) - 1; i++)
+    {
+        strPtr += strlen(strPtr) + 1;
+    }
+
+    sitePtr->dictFormatPtr = strPtr;
+    sitePtr->fileNamePtr = fileNamePtr;
+    sitePtr->functionNamePtr = functionNamePtr;
+    sitePtr->levelStr = levelStr;
+    sitePtr->compNamePtr = compNamePtr;
+    sitePtr->line = line;
+    sitePtr->offset = offset;
+    sitePtr->numArgs = numArgs;
+    for (i = 0; (int)i < numArgs; i++)
+    {
+        sitePtr->types[i] = types[i];
+        sitePtr->precisions[i] = precisions[i];
+    }
+    sitePtr->formatPtr = formatPtr;
+    NumSites++;
+
+    return sitePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the dictionary offset of a thread name, adding the name to the dictionary if needed.
+ *
+ * Thread names can change, so the cached name is compared with the current one.
+ *
+ * @return The offset, or NO_ENTRY if the name couldn't be added.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetThreadName
+(
+    const char* namePtr
+)
+{
+    ThreadName_t* threadPtr = &ThreadNames[HashPtr(namePtr) & (THREAD_CACHE_SIZE - 1)];
+
+    if ((threadPtr->namePtr == namePtr) &&
+        (strcmp(((logRing_Entry_t*)(DictPtr + threadPtr->offset))->strings, namePtr) == 0))
+    {
+        return threadPtr->offset;
+    }
+
+    uint32_t offset = AddEntry(LOGRING_ENTRY_THREAD, 0, 0, 0, &namePtr, 1);
+
+    if (offset != NO_ENTRY)
+    {
+        threadPtr->namePtr = namePtr;
+        threadPtr->offset = offset;
+    }
+
+    return offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack a call site's arguments.
+ *
+ * @return The size of the packed arguments, or -1 if they don't fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t PackArgs
+(
+    const Site_t* sitePtr,
+    int savedErrno,
+    va_list args,
+    uint8_t* bufPtr,
+    size_t bufSize
+)
+{
+    uint8_t* ptr = bufPtr;
+    uint8_t* endPtr = bufPtr + bufSize;
+    int lastInt = -1;
+    int i;
+
+    for (i = 0; i < sitePtr->numArgs; i++)
+    {
+        int32_t i32;
+        int64_t i64;
+        double d;
+        const char* strPtr;
+
+        if (endPtr - ptr < 8)
+        {
+            return -1;
+        }
+
+        switch (sitePtr->types[i])
+        {
+            case LOGRING_ARG_INT:
+                i32 = lastInt = va_arg(args, int);
+                memcpy(ptr, &i32, sizeof(i32));
+                ptr += sizeof(i32);
+                continue;
+
+            case LOGRING_ARG_ERRNO:
+                i32 = savedErrno;
+                memcpy(ptr, &i32, sizeof(i32));
+                ptr += sizeof(i32);
+                continue;
+
+            case LOGRING_ARG_LONG:
+                i64 = va_arg(args, long);
+                break;
+
+            case LOGRING_ARG_ULONG:
+                i64 = va_arg(args, unsigned long);
+                break;
+
+            case LOGRING_ARG_LLONG:
+                i64 = va_arg(args, long long);
+                break;
+
+            case LOGRING_ARG_SSIZE:
+                i64 = va_arg(args, ssize_t);
+                break;
+
+            case LOGRING_ARG_SIZE:
+                i64 = va_arg(args, size_t);
+                break;
+
+            case LOGRING_ARG_PTRDIFF:
+                i64 = va_arg(args, ptrdiff_t);
+                break;
+
+            case LOGRING_ARG_UPTRDIFF:
+                i64 = (size_t)va_arg(args, ptrdiff_t);
+                break;
+
+            case LOGRING_ARG_PTR:
+                i64 = (uintptr_t)va_arg(args, void*);
+                break;
+
+            case LOGRING_ARG_DOUBLE:
+                d = va_arg(args, double);
+                memcpy(ptr, &d, sizeof(d));
+                ptr += sizeof(d);
+                continue;
+
+            case LOGRING_ARG_STR:
+            {
+                uint16_t len = 0xFFFF;
+
+                strPtr = va_arg(args, const char*);
+                if (strPtr != NULL)
+                {
+                    // Don't read past the precision; the string may not be terminated.
+                    int precision = sitePtr->precisions[i];
+                    size_t maxLen = LOGRING_MAX_STR_BYTES;
+
+                    if ((precision == LOGRING_PRECISION_STAR) && (lastInt >= 0))
+                    {
+                        precision = lastInt;
+                    }
+                    if ((precision >= 0) && ((size_t)precision < maxLen))
+                    {
+                        maxLen = precision;
+                    }
+                    len = strnlen(strPtr, maxLen);
+                    if ((size_t)(endPtr - ptr) < sizeof(len) + len)
+                    {
+                        return -1;
+                    }
+                }
+                memcpy(ptr, &len, sizeof(len));
+                ptr += sizeof(len);
+                if (strPtr != NULL)
+                {
+                    memcpy(ptr, strPtr, len);
+                    ptr += len;
+                }
+                continue;
+            }
+
+            default:
+                return -1;
+        }
+
+        memcpy(ptr, &i64, sizeof(i64));
+        ptr += sizeof(i64);
+    }
+
+    return ptr - bufPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a record into the ring and publish it.
+ *
+ * @return false if there is no room.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool PutRecord
+(
+    const logRing_Record_t* recordPtr
+)
+{
+    uint64_t head = Head;
+    uint64_t tail = __atomic_load_n(&HeaderPtr->tail, __ATOMIC_ACQUIRE);
+    uint32_t offset = head & (RingSize - 1);
+    uint32_t size = recordPtr->size;
+    uint32_t padSize = (RingSize - offset < size) ? RingSize - offset : 0;
+
+    // The tail is written by the daemon, so a bad one is treated as a full ring.
+    if ((tail > head) || (head + padSize + size - tail > RingSize))
+    {
+        return false;
+    }
+
+    // Records that have been read stay in the ring until they are overwritten.  Keep track of the
+    // oldest one, so they can be decoded from a copy of the ring after a crash.
+    while (head + padSize + size - Oldest > RingSize)
+    {
+        uint32_t oldSize;
+
+        memcpy(&oldSize, RingPtr + (Oldest & (RingSize - 1)), sizeof(oldSize));
+        if ((oldSize == 0) || (oldSize % 8 != 0) || (oldSize > head - Oldest))
+        {
+            // The ring has been overwritten by someone else, so none of the old records count.
+            Oldest = head + padSize;
+            break;
+        }
+        Oldest += oldSize;
+    }
+    __atomic_store_n(&HeaderPtr->oldest, Oldest, __ATOMIC_RELAXED);
+
+    if (padSize != 0)
+    {
+        logRing_Record_t* padPtr = (logRing_Record_t*)(RingPtr + offset);
+
+        padPtr->size = padSize;
+        padPtr->siteOffset = LOGRING_PAD_SITE;
+        head += padSize;
+        offset = 0;
+    }
+
+    memcpy(RingPtr + offset, recordPtr, size);
+
+    Head = head + size;
+    __atomic_store_n(&HeaderPtr->head, Head, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create this process's ring.  It is not written to until logRing_Start() is called.
+ *
+ * @return A file descriptor for the ring's memfd, to be passed to the Log Control Daemon, or -1 on
+ *         failure.  The ring keeps the file descriptor open.
+ */
+//--------------------------------------------------------------------------------------------------
+int logRing_Create
+(
+    const char* procNamePtr             ///< [IN] Name of this process.
+)
+{
+#if HAVE_MEMFD
+    LE_ASSERT(HeaderPtr == NULL);
+
+    // The ring size must be a power of 2.
+    uint32_t ringSize = 2 * LOGRING_MAX_RECORD_BYTES;
+    while (ringSize * 2 <= LE_CONFIG_LOG_BINARY_RING_SIZE)
+    {
+        ringSize *= 2;
+    }
+    uint32_t dictSize = ALIGN_UP(LE_CONFIG_LOG_BINARY_RING_DICT_SIZE, 8);
+    size_t mapSize = ALIGN_UP(sizeof(logRing_Header_t) + dictSize + ringSize,
+                                 (size_t)sysconf(_SC_PAGESIZE));
+
+    // Used when a ring is dumped from /proc/<pid>/fd.
+    int fd = syscall(__NR_memfd_create, "le_log_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        LE_ERROR("memfd_create() failed. Errno = %d (%m).", errno);
+        return -1;
+    }
+
+    if (ftruncate(fd, mapSize) != 0)
+    {
+        LE_ERROR("ftruncate() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return -1;
+    }
+
+    // Stop the size from changing under the daemon's feet.
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        LE_ERROR("Failed to seal log ring. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return -1;
+    }
+
+    void* mapPtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("mmap() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return -1;
+    }
+
+    Sites = calloc(SITE_CACHE_SIZE, sizeof(Site_t));
+    if (Sites == NULL)
+    {
+        LE_ERROR("Failed to allocate log ring call site cache.");
+        munmap(mapPtr, mapSize);
+        fd_Close(fd);
+        return -1;
+    }
+
+    // A new memfd is zero-filled, so the positions all start at 0.
+    HeaderPtr = mapPtr;
+    memcpy(HeaderPtr->magic, LOGRING_MAGIC, sizeof(HeaderPtr->magic));
+    HeaderPtr->version = LOGRING_VERSION;
+    HeaderPtr->dictSize = dictSize;
+    HeaderPtr->ringSize = ringSize;
+    HeaderPtr->pid = getpid();
+    le_utf8_Copy(HeaderPtr->procName, procNamePtr, sizeof(HeaderPtr->procName), NULL);
+
+    DictPtr = (uint8_t*)mapPtr + sizeof(logRing_Header_t);
+    RingPtr = DictPtr + dictSize;
+    DictSize = dictSize;
+    RingSize = ringSize;
+    MapSize = mapSize;
+    RingFd = fd;
+    Head = 0;
+    Oldest = 0;
+    DictUsed = 0;
+    Overflows = 0;
+
+    return fd;
+#else
+    LE_DEBUG("Binary log ring is not supported on this system.");
+    return -1;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start writing messages into the ring, once the Log Control Daemon has accepted it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Start
+(
+    void
+)
+{
+    static bool isAtForkRegistered = false;
+
+    LE_ASSERT(HeaderPtr != NULL);
+
+    if (!isAtForkRegistered)
+    {
+        LE_ASSERT(pthread_atfork(NULL, NULL, StopInChild) == 0);
+        isAtForkRegistered = true;
+    }
+
+    IsStarted = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the ring, if the Log Control Daemon didn't accept it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Delete
+(
+    void
+)
+{
+    if (HeaderPtr == NULL)
+    {
+        return;
+    }
+
+    IsStarted = false;
+    munmap(HeaderPtr, MapSize);
+    fd_Close(RingFd);
+    free(Sites);
+
+    HeaderPtr = NULL;
+    DictPtr = NULL;
+    RingPtr = NULL;
+    RingFd = -1;
+    Sites = NULL;
+    NumSites = 0;
+    memset(ThreadNames, 0, sizeof(ThreadNames));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a message into the ring.
+ *
+ * @return false if the message could not be written, in which case it must be logged directly.
+ *         The argument list is not used up either way.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_Write
+(
+    int level,                          ///< [IN] Severity level, or -1 for a trace.
+    const char* levelStr,               ///< [IN] Level (or trace keyword) string.
+    const char* compNamePtr,            ///< [IN] Component name.
+    const char* fileNamePtr,            ///< [IN] File name, without directory.
+    const char* functionNamePtr,        ///< [IN] Function name, or NULL.
+    unsigned int line,                  ///< [IN] Line number.
+    const char* threadNamePtr,          ///< [IN] Name of the calling thread.
+    int savedErrno,                     ///< [IN] errno value to use for %m.
+    const char* formatPtr,              ///< [IN] Format string.
+    va_list args                        ///< [IN] Arguments.
+)
+{
+    if (!IsStarted)
+    {
+        return false;
+    }
+
+    union
+    {
+        logRing_Record_t header;
+        uint8_t bytes[LOGRING_MAX_RECORD_BYTES];
+    }
+    record;
+    uint8_t* argsPtr = record.bytes + sizeof(logRing_Record_t);
+    size_t argsRoom = sizeof(record) - sizeof(logRing_Record_t);
+    ssize_t argsSize = -1;
+    struct timespec now;
+    bool isWritten = false;
+    va_list argsCopy;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+
+    const Site_t* sitePtr = GetSite(level, levelStr, compNamePtr, fileNamePtr, functionNamePtr,
+                                    line, formatPtr);
+    uint32_t threadOffset = GetThreadName(threadNamePtr);
+
+    if ((sitePtr == NULL) || (threadOffset == NO_ENTRY))
+    {
+        goto done;
+    }
+
+    record.header.siteOffset = sitePtr->offset;
+    record.header.threadOffset = threadOffset;
+    record.header.flags = 0;
+    record.header.timestamp = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    // The format pointer identifies the call site, but a caller could pass a buffer whose
+    // contents change, so check that the format is still the one in the dictionary.
+    if ((sitePtr->numArgs >= 0) && (strcmp(sitePtr->dictFormatPtr, formatPtr) == 0))
+    {
+        va_copy(argsCopy, args);
+        argsSize = PackArgs(sitePtr, savedErrno, argsCopy, argsPtr, argsRoom);
+        va_end(argsCopy);
+    }
+
+    if (argsSize < 0)
+    {
+        // Write the message already formatted, packed like a string argument.
+        char msg[LOGRING_MAX_MSG_BYTES];
+        uint16_t len;
+
+        va_copy(argsCopy, args);
+        errno = savedErrno;
+        vsnprintf(msg, sizeof(msg), formatPtr, argsCopy);
+        va_end(argsCopy);
+
+        len = strlen(msg);
+        memcpy(argsPtr, &len, sizeof(len));
+        memcpy(argsPtr + sizeof(len), msg, len);
+        argsSize = sizeof(len) + len;
+        record.header.flags = LOGRING_RECORD_TEXT;
+    }
+
+    record.header.argsSize = argsSize;
+    record.header.size = ALIGN_UP(sizeof(logRing_Record_t) + argsSize, 8);
+
+    isWritten = PutRecord(&record.header);
+    if (!isWritten)
+    {
+        Overflows++;
+        __atomic_store_n(&HeaderPtr->overflows, Overflows, __ATOMIC_RELAXED);
+    }
+
+done:
+    LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+    return isWritten;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a ring received from a process.
+ *
+ * @return The ring, or NULL if it is not acceptable.  The file descriptor is not kept.
+ */
+//--------------------------------------------------------------------------------------------------
+logRing_Reader_t* logRing_Attach
+(
+    int fd                              ///< [IN] File descriptor received from the process.
+)
+{
+#if HAVE_MEMFD
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+    {
+        LE_ERROR("fstat() failed. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    // The process must not be able to shrink the ring while it is mapped, or the daemon would
+    // crash with SIGBUS.
+    int seals = fcntl(fd, F_GET_SEALS);
+    if ((seals < 0) || !(seals & F_SEAL_SHRINK))
+    {
+        LE_ERROR("Log ring is not sealed.");
+        return NULL;
+    }
+
+    if ((st.st_size < (off_t)sizeof(logRing_Header_t)) || (st.st_size > LOGRING_MAX_REGION_BYTES))
+    {
+        LE_ERROR("Log ring has bad size (%lld bytes).", (long long)st.st_size);
+        return NULL;
+    }
+
+    size_t mapSize = st.st_size;
+    void* mapPtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("mmap() failed. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    uint32_t dictSize;
+    uint32_t ringSize;
+
+    if (!logRing_CheckHeader(mapPtr, mapSize, &dictSize, &ringSize))
+    {
+        LE_ERROR("Log ring has bad header.");
+        munmap(mapPtr, mapSize);
+        return NULL;
+    }
+
+    if (ReaderPool == NULL)
+    {
+        ReaderPool = le_mem_CreatePool("LogRingReader", sizeof(logRing_Reader_t));
+    }
+
+    logRing_Reader_t* readerPtr = le_mem_ForceAlloc(ReaderPool);
+
+    readerPtr->headerPtr = mapPtr;
+    readerPtr->mapSize = mapSize;
+    readerPtr->dictSize = dictSize;
+    readerPtr->ringSize = ringSize;
+    readerPtr->tail = __atomic_load_n(&readerPtr->headerPtr->tail, __ATOMIC_ACQUIRE);
+    readerPtr->overflows = 0;
+
+    return readerPtr;
+#else
+    LE_ERROR("Binary log ring is not supported on this system.");
+    return NULL;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode all the unread records in a ring, calling a handler for each message.
+ *
+ * @return The number of messages the process had to log directly since the last call.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t logRing_Drain
+(
+    logRing_Reader_t* readerPtr,        ///< [IN] The ring.
+    logRing_MsgHandler_t handlerPtr,    ///< [IN] Function to call for each message.
+    void* contextPtr                    ///< [IN] Context pointer passed to the handler.
+)
+{
+    logRing_Header_t* headerPtr = readerPtr->headerPtr;
+    uint64_t head = __atomic_load_n(&headerPtr->head, __ATOMIC_ACQUIRE);
+
+    if (head != readerPtr->tail)
+    {
+        uint64_t pos = logRing_Decode(headerPtr,
+                                      readerPtr->dictSize,
+                                      readerPtr->ringSize,
+                                      readerPtr->tail,
+                                      head,
+                                      handlerPtr,
+                                      contextPtr);
+        if (pos != head)
+        {
+            LE_ERROR("Bad record in log ring of process %d. Skipping %" PRIu64 " bytes.",
+                     headerPtr->pid, head - pos);
+        }
+
+        // Even after a bad record, skip to the head so the process can keep writing.
+        readerPtr->tail = head;
+        __atomic_store_n(&headerPtr->tail, head, __ATOMIC_RELEASE);
+    }
+
+    uint64_t overflows = __atomic_load_n(&headerPtr->overflows, __ATOMIC_RELAXED);
+    uint64_t newOverflows = overflows - readerPtr->overflows;
+
+    readerPtr->overflows = overflows;
+
+    return newOverflows;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Detach
+(
+    logRing_Reader_t* readerPtr         ///< [IN] The ring.
+)
+{
+    munmap(readerPtr->headerPtr, readerPtr->mapSize);
+    le_mem_Release(readerPtr);
+}
+
+#endif /* end LE_CONFIG_LOG_BINARY_RING */
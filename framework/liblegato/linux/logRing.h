@@ -0,0 +1,386 @@
+/** @file logRing.h
+ *
+ * Binary log ring definitions, shared by the log client code in liblegato, the Log Control Daemon
+ * and the host-side logRingDecode tool.
+ *
+ * When the binary log ring is enabled, each process creates a memfd and passes it to the Log
+ * Control Daemon over its log client IPC session.  Debug, info and trace messages are then written
+ * into the memfd as binary records instead of being formatted and sent to syslog by the caller.
+ * The Log Control Daemon drains the rings periodically, formats the messages and writes them out
+ * the way the process would have.
+ *
+ * The memfd contains, in order:
+ *
+ *  - A header (logRing_Header_t).
+ *  - A dictionary.  Entries are appended by the process and never
+ *    change afterwards.  There is one entry per log statement (call site), holding its level, the
+ *    component name, the file name, the function name, the line number and the format string, and
+ *    one entry per thread name.
+ *  - The record ring, of a power of two number of bytes.  Each record holds the dictionary offsets
+ *    of its call site and thread name, a timestamp and the message's arguments, packed according
+ *    to the conversions in the call site's format string.
+ *
+ * The process is the only writer of the ring and the daemon the only reader.  Positions in the
+ * ring are byte counts that only ever increase; the process advances the head after writing a
+ * record and the daemon advances the tail after formatting it.  Records never wrap around the end
+ * of the ring; a padding record fills the space instead.
+ *
+ * Messages whose format strings contain conversions that can't be packed (long doubles, wide
+ * strings, positional arguments, etc.), or whose arguments don't fit in a record, are written as
+ * text records, which hold the message already formatted.
+ *
+ * This file is also used standalone by logRingDecode, so must not include legato.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_LOG_RING_H_INCLUDE_GUARD
+#define LEGATO_LOG_RING_H_INCLUDE_GUARD
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic string at the start of a ring, and its layout version.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_MAGIC               "LELOGRNG"
+#define LOGRING_VERSION             1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_PROC_NAME_BYTES     48      ///< Size of the process name in the header.
+#define LOGRING_MAX_ARGS            16      ///< Most arguments a packed format string can have.
+#define LOGRING_MAX_STR_BYTES       255     ///< Longest string argument copied into a record.
+#define LOGRING_MAX_FORMAT_BYTES    512     ///< Largest format string, including terminator.
+#define LOGRING_MAX_ENTRY_BYTES     2048    ///< Largest dictionary entry.
+#define LOGRING_MAX_RECORD_BYTES    1024    ///< Largest record, including its header.
+#define LOGRING_MAX_MSG_BYTES       256     ///< Size of a formatted message, including terminator.
+#define LOGRING_MAX_REGION_BYTES    (16 * 1024 * 1024)  ///< Largest memfd accepted by the daemon.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dictionary offset used in place of a call site offset to mark a padding record.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_PAD_SITE            0xFFFFFFFFU
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring header, at the start of the memfd.
+ *
+ * The head is only written by the process and the tail only by the daemon, so they are kept on
+ * separate cache lines.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char        magic[8];                           ///< LOGRING_MAGIC, without terminator.
+    uint32_t    version;                            ///< LOGRING_VERSION.
+    uint32_t    dictSize;                           ///< Size of the dictionary, in bytes.
+    uint32_t    ringSize;                           ///< Size of the record ring (power of 2).
+    int32_t     pid;                                ///< Process ID of the writer.
+    char        procName[LOGRING_PROC_NAME_BYTES];  ///< Process name of the writer.
+    uint32_t    dictUsed;                           ///< Bytes of the dictionary in use.
+    uint32_t    reserved;
+    uint64_t    overflows;                          ///< Messages logged directly for lack of room.
+    uint8_t     pad1[128 - 88];
+
+    uint64_t    head;                               ///< Position after the newest record.
+    uint64_t    oldest;                             ///< Position of the oldest intact record.
+    uint8_t     pad2[64 - 16];
+
+    uint64_t    tail;                               ///< Position of the oldest unread record.
+    uint8_t     pad3[64 - 8];
+}
+logRing_Header_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dictionary entry types and flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_ENTRY_SITE          1       ///< A call site.
+#define LOGRING_ENTRY_THREAD        2       ///< A thread name.
+
+#define LOGRING_SITE_HAS_FUNCTION   0x01    ///< The site has a function name.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dictionary entry.
+ *
+ * For a call site, the strings are the level (or trace keyword) string, the component name, the
+ * file name, the function name and the format string, each null-terminated.  For a thread, there
+ * is just the thread name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    size;       ///< Size of the entry, including the strings.  Multiple of 4.
+    uint8_t     type;       ///< LOGRING_ENTRY_SITE or LOGRING_ENTRY_THREAD.
+    uint8_t     flags;      ///< LOGRING_SITE_xxx flags.
+    int16_t     level;      ///< Severity level (le_log_Level_t), or -1 for a trace.
+    uint32_t    line;       ///< Line number.
+    char        strings[];  ///< Null-terminated strings.
+}
+logRing_Entry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record header.  The packed arguments follow, and the record is padded to a multiple of 8 bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    size;           ///< Size of the record including padding.  Multiple of 8.
+    uint32_t    siteOffset;     ///< Dictionary offset of the call site, or LOGRING_PAD_SITE.
+    uint32_t    threadOffset;   ///< Dictionary offset of the thread name.
+    uint16_t    argsSize;       ///< Size of the packed arguments.
+    uint16_t    flags;          ///< LOGRING_RECORD_xxx flags.
+    uint64_t    timestamp;      ///< Nanoseconds since the Epoch.
+}
+logRing_Record_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_RECORD_TEXT         0x0001  ///< The arguments are just the formatted message.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of packed arguments.  Integers are packed as 64 bits except for LOGRING_ARG_INT, and
+ * strings as a 16-bit length (0xFFFF for a NULL pointer) followed by the characters.  Values are
+ * not aligned.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LOGRING_ARG_INT,        ///< int (also char and short), packed as 32 bits.
+    LOGRING_ARG_LONG,       ///< long.
+    LOGRING_ARG_ULONG,      ///< unsigned long.
+    LOGRING_ARG_LLONG,      ///< long long, unsigned long long, intmax_t or uintmax_t.
+    LOGRING_ARG_SSIZE,      ///< ssize_t.
+    LOGRING_ARG_SIZE,       ///< size_t.
+    LOGRING_ARG_PTRDIFF,    ///< ptrdiff_t.
+    LOGRING_ARG_UPTRDIFF,   ///< ptrdiff_t printed as unsigned.
+    LOGRING_ARG_DOUBLE,     ///< double (also float).
+    LOGRING_ARG_STR,        ///< Null-terminated string.
+    LOGRING_ARG_PTR,        ///< Pointer.
+    LOGRING_ARG_ERRNO,      ///< errno value for %m, packed as 32 bits.  Doesn't consume an arg.
+}
+logRing_ArgType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Precision of a string conversion, as given by logRing_ParseFormat().  Other values are the
+ * precision given in the format string.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGRING_PRECISION_NONE      (-1)    ///< No precision.
+#define LOGRING_PRECISION_STAR      (-2)    ///< The precision is the previous (int) argument.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A decoded message, passed to a logRing_MsgHandler_t.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int         level;          ///< Severity level (le_log_Level_t), or -1 for a trace.
+    const char* levelStr;       ///< Level (or trace keyword) string.
+    const char* compName;       ///< Component name.
+    const char* threadName;     ///< Thread name.
+    const char* fileName;       ///< File name, without directory.
+    const char* functionName;   ///< Function name, or NULL.
+    unsigned int line;          ///< Line number.
+    uint64_t    timestamp;      ///< Nanoseconds since the Epoch.
+    const char* msg;            ///< Formatted message.
+}
+logRing_Msg_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called for each message decoded from a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*logRing_MsgHandler_t)
+(
+    const logRing_Msg_t* msgPtr,    ///< [IN] The message.
+    void* contextPtr                ///< [IN] Context pointer given to logRing_Decode().
+);
+
+
+// =====================================
+//  DECODING (logRingFormat.c)
+// =====================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work out the argument types of a format string.
+ *
+ * @return The number of argument types, or -1 if the format string can't be packed.
+ */
+//--------------------------------------------------------------------------------------------------
+int logRing_ParseFormat
+(
+    const char* formatPtr,              ///< [IN] Format string.
+    logRing_ArgType_t* typesPtr,        ///< [OUT] Argument types (LOGRING_MAX_ARGS of them).
+    int* precisionsPtr                  ///< [OUT] Precision of each string argument (see
+                                        ///        LOGRING_PRECISION_NONE).  Unused for others.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a ring header and get the ring's geometry from it.
+ *
+ * @return true if the header is valid and the ring fits in regionSize bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_CheckHeader
+(
+    const void* regionPtr,              ///< [IN] Start of the ring's memory.
+    size_t regionSize,                  ///< [IN] Size of the ring's memory.
+    uint32_t* dictSizePtr,              ///< [OUT] Size of the dictionary.
+    uint32_t* ringSizePtr               ///< [OUT] Size of the record ring.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode the records between two positions of a ring, calling a handler for each message.
+ *
+ * The ring may be shared with a running process, so everything is copied out of it before being
+ * used and every size and offset is checked.  The header must have been checked with
+ * logRing_CheckHeader() and the geometry it gave must be passed in.
+ *
+ * @return The position decoding stopped at.  This is endPos unless a bad record was found.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t logRing_Decode
+(
+    const void* regionPtr,              ///< [IN] Start of the ring's memory.
+    uint32_t dictSize,                  ///< [IN] Size of the dictionary.
+    uint32_t ringSize,                  ///< [IN] Size of the record ring.
+    uint64_t startPos,                  ///< [IN] Position of the first record to decode.
+    uint64_t endPos,                    ///< [IN] Position to stop at.
+    logRing_MsgHandler_t handlerPtr,    ///< [IN] Function to call for each message.
+    void* contextPtr                    ///< [IN] Context pointer passed to the handler.
+);
+
+
+// =====================================
+//  PROCESS SIDE (logRing.c)
+// =====================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create this process's ring.  It is not written to until logRing_Start() is called.
+ *
+ * @return A file descriptor for the ring's memfd, to be passed to the Log Control Daemon, or -1 on
+ *         failure.  The ring keeps the file descriptor open.
+ */
+//--------------------------------------------------------------------------------------------------
+int logRing_Create
+(
+    const char* procNamePtr             ///< [IN] Name of this process.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start writing messages into the ring, once the Log Control Daemon has accepted it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Start
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the ring, if the Log Control Daemon didn't accept it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Delete
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a message into the ring.
+ *
+ * @return false if the message could not be written, in which case it must be logged directly.
+ *         The argument list is not used up either way.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_Write
+(
+    int level,                          ///< [IN] Severity level, or -1 for a trace.
+    const char* levelStr,               ///< [IN] Level (or trace keyword) string.
+    const char* compNamePtr,            ///< [IN] Component name.
+    const char* fileNamePtr,            ///< [IN] File name, without directory.
+    const char* functionNamePtr,        ///< [IN] Function name, or NULL.
+    unsigned int line,                  ///< [IN] Line number.
+    const char* threadNamePtr,          ///< [IN] Name of the calling thread.
+    int savedErrno,                     ///< [IN] errno value to use for %m.
+    const char* formatPtr,              ///< [IN] Format string.
+    va_list args                        ///< [IN] Arguments.
+);
+
+
+// =====================================
+//  DAEMON SIDE (logRing.c)
+// =====================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A process's ring, as mapped by the Log Control Daemon.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct logRing_Reader logRing_Reader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a ring received from a process.
+ *
+ * @return The ring, or NULL if it is not acceptable.  The file descriptor is not kept.
+ */
+//--------------------------------------------------------------------------------------------------
+logRing_Reader_t* logRing_Attach
+(
+    int fd                              ///< [IN] File descriptor received from the process.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode all the unread records in a ring, calling a handler for each message.
+ *
+ * @return The number of messages the process had to log directly since the last call.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t logRing_Drain
+(
+    logRing_Reader_t* readerPtr,        ///< [IN] The ring.
+    logRing_MsgHandler_t handlerPtr,    ///< [IN] Function to call for each message.
+    void* contextPtr                    ///< [IN] Context pointer passed to the handler.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Detach
+(
+    logRing_Reader_t* readerPtr         ///< [IN] The ring.
+);
+
+
+#endif // LEGATO_LOG_RING_H_INCLUDE_GUARD
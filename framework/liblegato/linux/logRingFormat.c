@@ -0,0 +1,862 @@
+/** @file logRingFormat.c
+ *
+ * Parsing of log format strings and decoding of binary log ring records (see logRing.h).
+ *
+ * A message is formatted one conversion at a time.  Each conversion specification is rebuilt from
+ * the parts of it that were understood and given exactly one value of the matching type, so a
+ * format string or record from a misbehaving process can't make snprintf() read arguments that
+ * aren't there.
+ *
+ * This file is used standalone by logRingDecode, so cannot include legato.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "logRing.h"
+
+_Static_assert(sizeof(logRing_Header_t) == 256, "Log ring header must be 256 bytes");
+_Static_assert(sizeof(logRing_Record_t) % 8 == 0, "Log ring record header must be 8-byte aligned");
+_Static_assert(sizeof(intmax_t) == sizeof(long long), "intmax_t must be the size of long long");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest field width or precision that is passed on to snprintf().  Anything wider would only be
+ * truncated anyway.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_FIELD_WIDTH     4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of a field width or precision that is taken from the arguments.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FIELD_STAR          (-2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of a field width or precision that is not given.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FIELD_NONE          (-1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A parsed conversion specification.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char                flags[8];       ///< Flag characters, null-terminated.
+    int                 width;          ///< Field width, FIELD_NONE or FIELD_STAR.
+    int                 precision;      ///< Precision, FIELD_NONE or FIELD_STAR.
+    char                length[3];      ///< Length modifier, null-terminated.
+    char                conversion;     ///< Conversion character.
+    logRing_ArgType_t   type;           ///< Type of the value (not used for %%).
+}
+Spec_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message being formatted.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char*   bufPtr;     ///< Message buffer.
+    size_t  size;       ///< Size of the buffer.
+    size_t  len;        ///< Length of the message so far.
+}
+Output_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Packed arguments being read.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t*  ptr;    ///< Next argument.
+    size_t          left;   ///< Bytes left.
+}
+Args_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a field width or precision.
+ *
+ * @return Pointer to the character after it.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ParseField
+(
+    const char* ptr,
+    int* valuePtr
+)
+{
+    if (*ptr == '*')
+    {
+        *valuePtr = FIELD_STAR;
+        return ptr + 1;
+    }
+
+    int value = 0;
+
+    while ((*ptr >= '0') && (*ptr <= '9'))
+    {
+        if (value <= MAX_FIELD_WIDTH)
+        {
+            value = value * 10 + (*ptr - '0');
+        }
+        ptr++;
+    }
+
+    *valuePtr = (value > MAX_FIELD_WIDTH) ? MAX_FIELD_WIDTH : value;
+    return ptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a conversion specification.
+ *
+ * @return Pointer to the character after it, or NULL if it can't be packed.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ParseSpec
+(
+    const char* ptr,        ///< [IN] Character after the '%'.
+    Spec_t* specPtr         ///< [OUT] The specification.
+)
+{
+    size_t numFlags = 0;
+
+    while ((*ptr != '\0') && (strchr("-+ #0'", *ptr) != NULL))
+    {
+        if (numFlags >= sizeof(specPtr->flags) - 1)
+        {
+            return NULL;
+        }
+        specPtr->flags[numFlags++] = *ptr++;
+    }
+    specPtr->flags[numFlags] = '\0';
+
+    specPtr->width = FIELD_NONE;
+    if ((*ptr == '*') || ((*ptr >= '1') && (*ptr <= '9')))
+    {
+        ptr = ParseField(ptr, &specPtr->width);
+    }
+
+    specPtr->precision = FIELD_NONE;
+    if (*ptr == '.')
+    {
+        ptr = ParseField(ptr + 1, &specPtr->precision);
+    }
+
+    size_t lengthLen = 0;
+    if (((ptr[0] == 'h') && (ptr[1] == 'h')) || ((ptr[0] == 'l') && (ptr[1] == 'l')))
+    {
+        lengthLen = 2;
+    }
+    else if ((*ptr != '\0') && (strchr("hlqLjzt", *ptr) != NULL))
+    {
+        lengthLen = 1;
+    }
+    memcpy(specPtr->length, ptr, lengthLen);
+    specPtr->length[lengthLen] = '\0';
+    ptr += lengthLen;
+
+    const char* length = specPtr->length;
+    bool isSigned = false;
+
+    specPtr->conversion = *ptr;
+
+    switch (*ptr)
+    {
+        case '%':
+            if ((numFlags != 0) || (specPtr->width != FIELD_NONE) ||
+                (specPtr->precision != FIELD_NONE) || (lengthLen != 0))
+            {
+                return NULL;
+            }
+            break;
+
+        case 'd':
+        case 'i':
+            isSigned = true;
+            // Fall through.
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            if ((length[0] == '\0') || (length[0] == 'h'))
+            {
+                specPtr->type = LOGRING_ARG_INT;
+            }
+            else if (strcmp(length, "l") == 0)
+            {
+                specPtr->type = isSigned ? LOGRING_ARG_LONG : LOGRING_ARG_ULONG;
+            }
+            else if ((strcmp(length, "ll") == 0) || (length[0] == 'q') || (length[0] == 'j'))
+            {
+                specPtr->type = LOGRING_ARG_LLONG;
+            }
+            else if (length[0] == 'z')
+            {
+                specPtr->type = isSigned ? LOGRING_ARG_SSIZE : LOGRING_ARG_SIZE;
+            }
+            else if (length[0] == 't')
+            {
+                specPtr->type = isSigned ? LOGRING_ARG_PTRDIFF : LOGRING_ARG_UPTRDIFF;
+            }
+            else
+            {
+                return NULL;
+            }
+            break;
+
+        case 'c':
+            if (lengthLen != 0)
+            {
+                return NULL;
+            }
+            specPtr->type = LOGRING_ARG_INT;
+            break;
+
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if ((lengthLen != 0) && (strcmp(length, "l") != 0))
+            {
+                return NULL;
+            }
+            specPtr->type = LOGRING_ARG_DOUBLE;
+            break;
+
+        case 's':
+        case 'p':
+        case 'm':
+            if (lengthLen != 0)
+            {
+                return NULL;
+            }
+            specPtr->type = (*ptr == 's') ? LOGRING_ARG_STR :
+                            (*ptr == 'p') ? LOGRING_ARG_PTR : LOGRING_ARG_ERRNO;
+            break;
+
+        default:
+            // %n, wide characters, positional arguments, etc.
+            return NULL;
+    }
+
+    return ptr + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work out the argument types of a format string.
+ *
+ * @return The number of argument types, or -1 if the format string can't be packed.
+ */
+//--------------------------------------------------------------------------------------------------
+int logRing_ParseFormat
+(
+    const char* formatPtr,              ///< [IN] Format string.
+    logRing_ArgType_t* typesPtr,        ///< [OUT] Argument types (LOGRING_MAX_ARGS of them).
+    int* precisionsPtr                  ///< [OUT] Precision of each string argument (see
+                                        ///        LOGRING_PRECISION_NONE).  Unused for others.
+)
+{
+    const char* ptr = formatPtr;
+    int numArgs = 0;
+    Spec_t spec;
+
+    while ((ptr = strchr(ptr, '%')) != NULL)
+    {
+        ptr = ParseSpec(ptr + 1, &spec);
+        if (ptr == NULL)
+        {
+            return -1;
+        }
+        if (spec.conversion == '%')
+        {
+            continue;
+        }
+
+        int needed = 1 + (spec.width == FIELD_STAR) + (spec.precision == FIELD_STAR);
+        if (numArgs + needed > LOGRING_MAX_ARGS)
+        {
+            return -1;
+        }
+
+        if (spec.width == FIELD_STAR)
+        {
+            typesPtr[numArgs++] = LOGRING_ARG_INT;
+        }
+        if (spec.precision == FIELD_STAR)
+        {
+            typesPtr[numArgs++] = LOGRING_ARG_INT;
+        }
+
+        typesPtr[numArgs] = spec.type;
+        precisionsPtr[numArgs] = (spec.precision == FIELD_STAR) ? LOGRING_PRECISION_STAR :
+                                 (spec.precision == FIELD_NONE) ? LOGRING_PRECISION_NONE :
+                                 spec.precision;
+        numArgs++;
+    }
+
+    return numArgs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append characters to a message, truncating it if it gets too long.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Append
+(
+    Output_t* outPtr,
+    const char* strPtr,
+    size_t len
+)
+{
+    size_t room = outPtr->size - 1 - outPtr->len;
+
+    if (len > room)
+    {
+        len = room;
+    }
+    memcpy(outPtr->bufPtr + outPtr->len, strPtr, len);
+    outPtr->len += len;
+    outPtr->bufPtr[outPtr->len] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account for the characters written by snprintf() at the end of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Appended
+(
+    Output_t* outPtr,
+    int n
+)
+{
+    size_t room = outPtr->size - 1 - outPtr->len;
+
+    if (n > 0)
+    {
+        outPtr->len += ((size_t)n > room) ? room : (size_t)n;
+    }
+    outPtr->bufPtr[outPtr->len] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take bytes from the packed arguments.
+ *
+ * @return false if there aren't enough left.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetArg
+(
+    Args_t* argsPtr,
+    void* valuePtr,
+    size_t size
+)
+{
+    if (argsPtr->left < size)
+    {
+        return false;
+    }
+    memcpy(valuePtr, argsPtr->ptr, size);
+    argsPtr->ptr += size;
+    argsPtr->left -= size;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a string from the packed arguments.
+ *
+ * @return false if the string is bad.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetStrArg
+(
+    Args_t* argsPtr,
+    char* bufPtr,           ///< [OUT] LOGRING_MAX_STR_BYTES + 1 bytes.
+    bool* isNullPtr         ///< [OUT] Set to true if the string was a NULL pointer.
+)
+{
+    uint16_t len;
+
+    if (!GetArg(argsPtr, &len, sizeof(len)))
+    {
+        return false;
+    }
+
+    *isNullPtr = (len == 0xFFFF);
+    if (*isNullPtr)
+    {
+        bufPtr[0] = '\0';
+        return true;
+    }
+
+    if ((len > LOGRING_MAX_STR_BYTES) || !GetArg(argsPtr, bufPtr, len))
+    {
+        return false;
+    }
+    bufPtr[len] = '\0';
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the conversion specification that is passed to snprintf().
+ */
+//--------------------------------------------------------------------------------------------------
+static void BuildSpec
+(
+    char* bufPtr,               ///< [OUT] Specification (at least 40 bytes).
+    const Spec_t* specPtr,
+    const char* extraFlags,     ///< [IN] Flags to add.
+    int width,
+    int precision,
+    const char* length,
+    char conversion
+)
+{
+    int n = sprintf(bufPtr, "%%%s%s", specPtr->flags, extraFlags);
+
+    if (width != FIELD_NONE)
+    {
+        n += sprintf(bufPtr + n, "%d", width);
+    }
+    if (precision != FIELD_NONE)
+    {
+        n += sprintf(bufPtr + n, ".%d", precision);
+    }
+    sprintf(bufPtr + n, "%s%c", length, conversion);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format a message from its format string and packed arguments.
+ *
+ * @return false if the arguments don't match the format string.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FormatMsg
+(
+    const char* formatPtr,
+    Args_t* argsPtr,
+    char* msgPtr                ///< [OUT] LOGRING_MAX_MSG_BYTES bytes.
+)
+{
+    Output_t out = { .bufPtr = msgPtr, .size = LOGRING_MAX_MSG_BYTES, .len = 0 };
+    const char* ptr = formatPtr;
+    char str[LOGRING_MAX_STR_BYTES + 1];
+    char fmt[40];
+    Spec_t spec;
+
+    msgPtr[0] = '\0';
+
+    while (*ptr != '\0')
+    {
+        const char* percentPtr = strchr(ptr, '%');
+
+        if (percentPtr == NULL)
+        {
+            Append(&out, ptr, strlen(ptr));
+            break;
+        }
+        Append(&out, ptr, percentPtr - ptr);
+
+        ptr = ParseSpec(percentPtr + 1, &spec);
+        if (ptr == NULL)
+        {
+            return false;
+        }
+        if (spec.conversion == '%')
+        {
+            Append(&out, "%", 1);
+            continue;
+        }
+
+        const char* extraFlags = "";
+        int width = spec.width;
+        int precision = spec.precision;
+        int32_t i32;
+
+        if (width == FIELD_STAR)
+        {
+            if (!GetArg(argsPtr, &i32, sizeof(i32)))
+            {
+                return false;
+            }
+            // A negative width is a '-' flag and a positive width.
+            if (i32 < 0)
+            {
+                extraFlags = "-";
+                i32 = (i32 < -MAX_FIELD_WIDTH) ? MAX_FIELD_WIDTH : -i32;
+            }
+            width = (i32 > MAX_FIELD_WIDTH) ? MAX_FIELD_WIDTH : i32;
+        }
+        if (precision == FIELD_STAR)
+        {
+            if (!GetArg(argsPtr, &i32, sizeof(i32)))
+            {
+                return false;
+            }
+            // A negative precision is taken as if it were missing.
+            precision = (i32 < 0) ? FIELD_NONE : (i32 > MAX_FIELD_WIDTH) ? MAX_FIELD_WIDTH : i32;
+        }
+
+        char* endPtr = out.bufPtr + out.len;
+        size_t room = out.size - out.len;
+        bool isSigned = (spec.conversion == 'd') || (spec.conversion == 'i');
+        int64_t i64;
+        double d;
+        bool isNull;
+
+        switch (spec.type)
+        {
+            case LOGRING_ARG_INT:
+                if (!GetArg(argsPtr, &i32, sizeof(i32)))
+                {
+                    return false;
+                }
+                BuildSpec(fmt, &spec, extraFlags, width, precision, spec.length, spec.conversion);
+                Appended(&out, snprintf(endPtr, room, fmt, (int)i32));
+                break;
+
+            case LOGRING_ARG_LONG:
+            case LOGRING_ARG_ULONG:
+            case LOGRING_ARG_LLONG:
+            case LOGRING_ARG_SSIZE:
+            case LOGRING_ARG_SIZE:
+            case LOGRING_ARG_PTRDIFF:
+            case LOGRING_ARG_UPTRDIFF:
+                if (!GetArg(argsPtr, &i64, sizeof(i64)))
+                {
+                    return false;
+                }
+                BuildSpec(fmt, &spec, extraFlags, width, precision, "ll", spec.conversion);
+                if (isSigned)
+                {
+                    Appended(&out, snprintf(endPtr, room, fmt, (long long)i64));
+                }
+                else
+                {
+                    Appended(&out, snprintf(endPtr, room, fmt, (unsigned long long)i64));
+                }
+                break;
+
+            case LOGRING_ARG_DOUBLE:
+                if (!GetArg(argsPtr, &d, sizeof(d)))
+                {
+                    return false;
+                }
+                BuildSpec(fmt, &spec, extraFlags, width, precision, "", spec.conversion);
+                Appended(&out, snprintf(endPtr, room, fmt, d));
+                break;
+
+            case LOGRING_ARG_STR:
+                if (!GetStrArg(argsPtr, str, &isNull))
+                {
+                    return false;
+                }
+                BuildSpec(fmt, &spec, extraFlags, width, precision, "", 's');
+                Appended(&out, snprintf(endPtr, room, fmt, isNull ? "(null)" : str));
+                break;
+
+            case LOGRING_ARG_PTR:
+                if (!GetArg(argsPtr, &i64, sizeof(i64)))
+                {
+                    return false;
+                }
+                // Print pointers the way the GNU C library does.
+                if (i64 == 0)
+                {
+                    BuildSpec(fmt, &spec, extraFlags, width, FIELD_NONE, "", 's');
+                    Appended(&out, snprintf(endPtr, room, fmt, "(nil)"));
+                }
+                else
+                {
+                    BuildSpec(fmt, &spec, (extraFlags[0] == '-') ? "-#" : "#", width, precision,
+                              "ll", 'x');
+                    Appended(&out, snprintf(endPtr, room, fmt, (unsigned long long)i64));
+                }
+                break;
+
+            case LOGRING_ARG_ERRNO:
+                if (!GetArg(argsPtr, &i32, sizeof(i32)))
+                {
+                    return false;
+                }
+                BuildSpec(fmt, &spec, extraFlags, width, precision, "", 's');
+                Appended(&out, snprintf(endPtr, room, fmt, strerror(i32)));
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    // Every argument must have been used.
+    return (argsPtr->left == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a dictionary entry out of a ring.
+ *
+ * @return false if the entry is bad.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetEntry
+(
+    const uint8_t* dictPtr,
+    uint32_t dictUsed,
+    uint32_t offset,
+    uint8_t type,               ///< [IN] Expected type of entry.
+    logRing_Entry_t* entryPtr,  ///< [OUT] LOGRING_MAX_ENTRY_BYTES bytes.
+    const char** stringsPtr,    ///< [OUT] Pointers to the entry's strings.
+    size_t numStrings
+)
+{
+    uint32_t size;
+
+    if ((offset % 4 != 0) || (offset >= dictUsed) || (dictUsed - offset < sizeof(logRing_Entry_t)))
+    {
+        return false;
+    }
+
+    memcpy(&size, dictPtr + offset, sizeof(size));
+    if ((size <= sizeof(logRing_Entry_t)) || (size > LOGRING_MAX_ENTRY_BYTES) ||
+        (size > dictUsed - offset))
+    {
+        return false;
+    }
+
+    memcpy(entryPtr, dictPtr + offset, size);
+    if ((entryPtr->size != size) || (entryPtr->type != type))
+    {
+        return false;
+    }
+
+    const char* ptr = entryPtr->strings;
+    const char* endPtr = (const char*)entryPtr + size;
+    size_t i;
+
+    for (i = 0; i < numStrings; i++)
+    {
+        const char* nulPtr = memchr(ptr, '\0', endPtr - ptr);
+
+        if (nulPtr == NULL)
+        {
+            return false;
+        }
+        stringsPtr[i] = ptr;
+        ptr = nulPtr + 1;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a ring header and get the ring's geometry from it.
+ *
+ * @return true if the header is valid and the ring fits in regionSize bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logRing_CheckHeader
+(
+    const void* regionPtr,              ///< [IN] Start of the ring's memory.
+    size_t regionSize,                  ///< [IN] Size of the ring's memory.
+    uint32_t* dictSizePtr,              ///< [OUT] Size of the dictionary.
+    uint32_t* ringSizePtr               ///< [OUT] Size of the record ring.
+)
+{
+    logRing_Header_t header;
+
+    if (regionSize < sizeof(header))
+    {
+        return false;
+    }
+
+    // Take a copy of the header before checking it, so it can't change afterwards.
+    memcpy(&header, regionPtr, sizeof(header));
+
+    if ((memcmp(header.magic, LOGRING_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != LOGRING_VERSION) ||
+        (header.dictSize % 8 != 0) ||
+        (header.ringSize < 2 * LOGRING_MAX_RECORD_BYTES) ||
+        ((header.ringSize & (header.ringSize - 1)) != 0) ||
+        ((uint64_t)sizeof(header) + header.dictSize + header.ringSize > regionSize))
+    {
+        return false;
+    }
+
+    *dictSizePtr = header.dictSize;
+    *ringSizePtr = header.ringSize;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode the records between two positions of a ring, calling a handler for each message.
+ *
+ * The ring may be shared with a running process, so everything is copied out of it before being
+ * used and every size and offset is checked.  The header must have been checked with
+ * logRing_CheckHeader() and the geometry it gave must be passed in.
+ *
+ * @return The position decoding stopped at.  This is endPos unless a bad record was found.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t logRing_Decode
+(
+    const void* regionPtr,              ///< [IN] Start of the ring's memory.
+    uint32_t dictSize,                  ///< [IN] Size of the dictionary.
+    uint32_t ringSize,                  ///< [IN] Size of the record ring.
+    uint64_t startPos,                  ///< [IN] Position of the first record to decode.
+    uint64_t endPos,                    ///< [IN] Position to stop at.
+    logRing_MsgHandler_t handlerPtr,    ///< [IN] Function to call for each message.
+    void* contextPtr                    ///< [IN] Context pointer passed to the handler.
+)
+{
+    const logRing_Header_t* headerPtr = regionPtr;
+    const uint8_t* dictPtr = (const uint8_t*)regionPtr + sizeof(logRing_Header_t);
+    const uint8_t* ringPtr = dictPtr + dictSize;
+    uint64_t pos = startPos;
+
+    union
+    {
+        logRing_Record_t header;
+        uint8_t bytes[LOGRING_MAX_RECORD_BYTES];
+    }
+    record;
+    union
+    {
+        logRing_Entry_t header;
+        uint8_t bytes[LOGRING_MAX_ENTRY_BYTES];
+    }
+    site, thread;
+    char msg[LOGRING_MAX_MSG_BYTES];
+
+    if ((startPos % 8 != 0) || (endPos - startPos > ringSize))
+    {
+        return startPos;
+    }
+
+    // The dictionary entries used by the records up to endPos were added before endPos was
+    // published, so only this much of the dictionary needs to be looked at.
+    uint32_t dictUsed = __atomic_load_n(&headerPtr->dictUsed, __ATOMIC_ACQUIRE);
+    if (dictUsed > dictSize)
+    {
+        dictUsed = dictSize;
+    }
+
+    while (pos != endPos)
+    {
+        uint32_t offset = pos & (ringSize - 1);
+        uint32_t sizeAndSite[2];
+
+        memcpy(sizeAndSite, ringPtr + offset, sizeof(sizeAndSite));
+
+        uint32_t size = sizeAndSite[0];
+        if ((size < sizeof(sizeAndSite)) || (size % 8 != 0) || (size > ringSize - offset) ||
+            (size > endPos - pos))
+        {
+            break;
+        }
+
+        if (sizeAndSite[1] == LOGRING_PAD_SITE)
+        {
+            pos += size;
+            continue;
+        }
+
+        if ((size < sizeof(logRing_Record_t)) || (size > sizeof(record)))
+        {
+            break;
+        }
+        memcpy(record.bytes, ringPtr + offset, size);
+        if ((record.header.size != size) ||
+            (record.header.argsSize > size - sizeof(logRing_Record_t)))
+        {
+            break;
+        }
+
+        const char* siteStrings[5];
+        const char* threadName;
+
+        if (!GetEntry(dictPtr, dictUsed, record.header.siteOffset, LOGRING_ENTRY_SITE,
+                      &site.header, siteStrings, 5) ||
+            !GetEntry(dictPtr, dictUsed, record.header.threadOffset, LOGRING_ENTRY_THREAD,
+                      &thread.header, &threadName, 1))
+        {
+            break;
+        }
+
+        Args_t args = { .ptr = record.bytes + sizeof(logRing_Record_t),
+                        .left = record.header.argsSize };
+
+        if (record.header.flags & LOGRING_RECORD_TEXT)
+        {
+            bool isNull;
+
+            // The formatted message was packed as a string.
+            if (!GetStrArg(&args, msg, &isNull) || isNull || (args.left != 0))
+            {
+                break;
+            }
+        }
+        else if (!FormatMsg(siteStrings[4], &args, msg))
+        {
+            break;
+        }
+
+        logRing_Msg_t decoded =
+        {
+            .level = site.header.level,
+            .levelStr = siteStrings[0],
+            .compName = siteStrings[1],
+            .threadName = threadName,
+            .fileName = siteStrings[2],
+            .functionName = (site.header.flags & LOGRING_SITE_HAS_FUNCTION) ? siteStrings[3] : NULL,
+            .line = site.header.line,
+            .timestamp = record.header.timestamp,
+            .msg = msg
+        };
+
+        handlerPtr(&decoded, contextPtr);
+
+        pos += size;
+    }
+
+    return pos;
+}
@@ -85,6 +85,14 @@
  * side.  For all other types of messages, this is set to 0 (NULL) to indicate that it does
  * not belong to a request-response transaction.
  *
+ * Sessions can optionally carry message payloads in shared memory (see
+ * @ref c_messagingSharedMemory).  The client creates a sealed memfd holding a pool of payload
+ * buffers, half for each direction, and passes it to the server in a setup control message right
+ * after the session opens.  After that, a message whose payload is in a shared buffer is sent as a
+ * small "doorbell" control message naming the buffer, and ownership of the buffer passes to the
+ * receiver.  Control messages are told apart from normal ones by a reserved, even value in the
+ * transaction ID field (Safe References are always odd).  See messagingShm.c.
+ *
  * See also @ref serviceDirectoryProtocol.
  *
  * @warning The code in this subsystem @b must be thread safe and re-entrant.
@@ -100,6 +108,7 @@
 #include "messagingSession.h"
 #include "messagingInterface.h"
 #include "messagingLocal.h"
+#include "messagingShm.h"
 
 // =======================================
 //  PROTECTED (INTER-MODULE) FUNCTIONS
@@ -121,6 +130,7 @@ void msg_Init
     msgLocal_Init();
     msgProto_Init();
     msgMessage_Init();
+    msgShm_Init();
     msgInterface_Init();
     msgSession_Init();
 }
@@ -101,11 +101,196 @@ static void MessageDestructor
         fd_Close(msgPtr->fd);
     }
 
+    // Give back the shared memory buffer holding the payload, if any.
+    if (msgPtr->shmRegionPtr != NULL)
+    {
+        msgShm_FreeBuffer(msgPtr->shmRegionPtr, msgPtr->shmBufferIdx);
+        le_mem_Release(msgPtr->shmRegionPtr);
+    }
+
     // Release the Message object's hold on the Session object.
     le_mem_Release(msgPtr->message.sessionRef);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Message object for a Unix socket session, with the payload inside the object.
+ *
+ * @return  Pointer to the Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+static UnixMessage_t* CreateUnixMsg
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Get a reference to the Session's Protocol and ask the Protocol to allocate a Message
+    // object from its Message Pool.
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
+    UnixMessage_t* msgPtr = msgProto_AllocMessage(protocolRef);
+
+    // Initialize the Message object's data members.
+    msgPtr->link = LE_DLS_LINK_INIT;
+    msgPtr->message.sessionRef = sessionRef;
+    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
+
+    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
+    switch (interfaceType)
+    {
+        case LE_MSG_INTERFACE_CLIENT:
+            msgPtr->clientServer.client.completionCallback = NULL;
+            msgPtr->clientServer.client.contextPtr = NULL;
+            break;
+
+        case LE_MSG_INTERFACE_SERVER:
+            msgPtr->clientServer.server.responseFd = -1;
+            msgPtr->clientServer.server.isResponseFdMoved = false;
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d).", interfaceType);
+    }
+
+    msgPtr->shmRegionPtr = NULL;
+    msgPtr->shmBufferIdx = 0;
+    msgPtr->fd = -1;
+    msgPtr->txnId = 0;
+
+    return msgPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a Message object ready to be sent and work out what has to be written to the socket for it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareToSend
+(
+    UnixMessage_t* msgPtr,              ///< [IN] The Message to be sent.
+    unixSocket_MsgBuff_t* buffPtr,      ///< [OUT] What to send through the socket.
+    msgShm_ControlMsg_t* doorbellPtr    ///< [OUT] Space for a doorbell, if one is needed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If this is a response message, being prepared for the first time (it is prepared again if
+    // the socket couldn't take it),
+    if (le_msg_NeedsResponse(msgMessage_GetMessageRef(msgPtr))
+        && !msgPtr->clientServer.server.isResponseFdMoved)
+    {
+        // If there was an fd that was received from the client but not fetched from the message
+        // generate a warning and close that fd.
+        if (msgPtr->fd >= 0)
+        {
+            LE_WARN("File descriptor not retrieved from message received from client.");
+            fd_Close(msgPtr->fd);
+        }
+
+        // Move the responseFd to the normal fd position in the message object.
+        msgPtr->fd = msgPtr->clientServer.server.responseFd;
+        msgPtr->clientServer.server.responseFd = -1;
+        msgPtr->clientServer.server.isResponseFdMoved = true;
+    }
+
+    buffPtr->fd = msgPtr->fd;
+
+    // If the payload is in shared memory, only send a doorbell pointing the receiver at it.
+    if (msgPtr->shmRegionPtr != NULL)
+    {
+        doorbellPtr->marker = MSGSHM_CONTROL_MARKER;
+        doorbellPtr->type = MSGSHM_CONTROL_DOORBELL;
+        doorbellPtr->bufferIdx = msgPtr->shmBufferIdx;
+        doorbellPtr->txnId = msgPtr->txnId;
+
+        buffPtr->dataPtr = doorbellPtr;
+        buffPtr->dataSize = sizeof(*doorbellPtr);
+    }
+    else
+    {
+        // The first bytes come from our transaction ID and the rest (if any)
+        // from our Message object's payload section, which comes right after the transaction ID.
+        buffPtr->dataPtr = &msgPtr->txnId;
+        buffPtr->dataSize = sizeof(msgPtr->txnId) +
+                            le_msg_GetMaxPayloadSize(msgMessage_GetMessageRef(msgPtr));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update a Message object after it has been sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishSend
+(
+    UnixMessage_t* msgPtr   ///< [IN] The Message that was sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (msgPtr->shmRegionPtr != NULL)
+    {
+        // The receiver owns the buffer now, so let go of it without freeing it.
+        le_mem_Release(msgPtr->shmRegionPtr);
+        msgPtr->shmRegionPtr = NULL;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work out where a message received from the socket should be put in a Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareToReceive
+(
+    UnixMessage_t* msgPtr,              ///< [IN] The Message to receive into.
+    unixSocket_MsgBuff_t* buffPtr       ///< [OUT] Where to receive into.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Receive the first bytes into our transaction ID and the rest (if any)
+    // into our Message object's payload section.
+    buffPtr->dataPtr = &msgPtr->txnId;
+    buffPtr->dataSize = sizeof(msgPtr->txnId) +
+                        le_msg_GetMaxPayloadSize(msgMessage_GetMessageRef(msgPtr));
+    buffPtr->fd = -1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update a Message object after something has been received into it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishReceive
+(
+    UnixMessage_t* msgPtr,              ///< [IN] The Message received into.
+    unixSocket_MsgBuff_t* buffPtr       ///< [IN] What was received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgPtr->fd = buffPtr->fd;
+
+    if (msgSession_GetInterfaceType(msgPtr->message.sessionRef) == LE_MSG_INTERFACE_SERVER)
+    {
+        msgPtr->clientServer.server.responseFd = -1;
+        msgPtr->clientServer.server.isResponseFdMoved = false;
+    }
+
+    // Messages are created for receiving without clearing their payloads, so clear whatever
+    // wasn't written by the sender.  A control message's payload area is never used as a
+    // payload, so it is left alone.
+    size_t maxSize = sizeof(msgPtr->txnId) +
+                     le_msg_GetMaxPayloadSize(msgMessage_GetMessageRef(msgPtr));
+    if ((buffPtr->dataSize < maxSize) && (msgPtr->txnId != MSGSHM_CONTROL_MARKER))
+    {
+        memset((uint8_t*)&msgPtr->txnId + buffPtr->dataSize, 0, maxSize - buffPtr->dataSize);
+    }
+}
+
+
 // =======================================
 //  PROTECTED (INTER-MODULE) FUNCTIONS
 // =======================================
@@ -161,6 +346,89 @@ le_mem_PoolRef_t msgMessage_CreatePool
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Message object to receive a message into.  Unlike le_msg_CreateMsg(), this never puts
+ * the payload in shared memory, and the payload is not cleared until something is received into
+ * it with msgMessage_Receive() or msgMessage_ReceiveBatch().
+ *
+ * @return  The message reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t msgMessage_CreateRxMsg
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Reference to the session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The payload is cleared once the message has been received, so there's no need to do it here.
+    return msgMessage_GetMessageRef(CreateUnixMsg(sessionRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the control message that was received into a Message object.  Only valid if the Message's
+ * transaction ID is MSGSHM_CONTROL_MARKER.
+ *
+ * @return A pointer to the control message (inside the Message object).
+ */
+//--------------------------------------------------------------------------------------------------
+const msgShm_ControlMsg_t* msgMessage_GetControlMsg
+(
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRef);
+
+    LE_ASSERT(msgPtr->txnId == MSGSHM_CONTROL_MARKER);
+
+    // Control messages are received the same way as other messages, so they start at the
+    // transaction ID and continue into the payload.
+    return (const msgShm_ControlMsg_t*)&msgPtr->txnId;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn a Message object holding a received doorbell into the message the doorbell announced,
+ * with its payload in a buffer of a shared memory region.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the doorbell refers to a buffer that is not in use.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_AcceptDoorbell
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] Message holding the doorbell.
+    msgShm_Region_t*    regionPtr   ///< [IN] The session's shared memory region.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRef);
+    const msgShm_ControlMsg_t* doorbellPtr = msgMessage_GetControlMsg(msgRef);
+    uint32_t bufferIdx = doorbellPtr->bufferIdx;
+    void* txnId = doorbellPtr->txnId;
+
+    if (!msgShm_IsBufferInUse(regionPtr, bufferIdx))
+    {
+        LE_ERROR("Doorbell for shared memory buffer %" PRIu32 " which is not in use.", bufferIdx);
+        return LE_FAULT;
+    }
+
+    // The buffer now belongs to this message.  Any fd that came with the doorbell is left in
+    // the message.
+    le_mem_AddRef(regionPtr);
+    msgPtr->shmRegionPtr = regionPtr;
+    msgPtr->shmBufferIdx = bufferIdx;
+    msgPtr->txnId = txnId;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send a single message over a connected socket.
@@ -168,10 +436,7 @@ le_mem_PoolRef_t msgMessage_CreatePool
  * @return
  * - LE_OK if successful.
  * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
- * - LE_COMM_ERROR if the localSocketFd is not connected.
- * - LE_FAULT if failed for some other reason (check your logs).
- *
- * @note    Won't return LE_NO_MEMORY if the socket is in blocking mode.
+ * - LE_COMM_ERROR if the socket reported an error on the send operation.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t msgMessage_Send
@@ -182,31 +447,65 @@ le_result_t msgMessage_Send
 //--------------------------------------------------------------------------------------------------
 {
     UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRef);
+    unixSocket_MsgBuff_t buff;
+    msgShm_ControlMsg_t doorbell;
 
-    // If this is a response message,
-    if (le_msg_NeedsResponse(msgRef))
+    PrepareToSend(msgPtr, &buff, &doorbell);
+
+    le_result_t result = unixSocket_SendMsg(socketFd,
+                                            buff.dataPtr,
+                                            buff.dataSize,
+                                            buff.fd,
+                                            false); // Don't send process credentials.
+    if (result == LE_OK)
     {
-        // If there was an fd that was received from the client but not fetched from the message
-        // generate a warning and close that fd.
-        if (msgPtr->fd >= 0)
-        {
-            LE_WARN("File descriptor not retrieved from message received from client.");
-            fd_Close(msgPtr->fd);
-        }
+        FinishSend(msgPtr);
+    }
 
-        // Move the responseFd to the normal fd position in the message object.
-        msgPtr->fd = msgPtr->clientServer.server.responseFd;
-        msgPtr->clientServer.server.responseFd = -1;
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket, in order, using as few system calls as
+ * possible.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the socket reported an error on the send operation.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int                 socketFd,   ///< [IN] Connected socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],  ///< [IN] The Messages to be sent.
+    size_t*             countPtr    ///< [IN+OUT] Number of Messages (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     Messages sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unixSocket_MsgBuff_t buffs[UNIXSOCKET_MAX_BATCH_SIZE];
+    msgShm_ControlMsg_t doorbells[UNIXSOCKET_MAX_BATCH_SIZE];
+    size_t i;
+
+    LE_ASSERT(*countPtr <= UNIXSOCKET_MAX_BATCH_SIZE);
+
+    for (i = 0; i < *countPtr; i++)
+    {
+        PrepareToSend(msgMessage_GetUnixMessagePtr(msgRefs[i]), &buffs[i], &doorbells[i]);
+    }
+
+    le_result_t result = unixSocket_SendMsgBatch(socketFd, buffs, countPtr);
+
+    for (i = 0; i < *countPtr; i++)
+    {
+        FinishSend(msgMessage_GetUnixMessagePtr(msgRefs[i]));
     }
 
-    // The first bytes come from our transaction ID and the rest (if any)
-    // from our Message object's payload section, which comes right after the transaction ID.
-    return unixSocket_SendMsg(  socketFd,
-                                &msgPtr->txnId,
-                                sizeof(msgPtr->txnId) +
-                                le_msg_GetMaxPayloadSize(msgMessage_GetMessageRef(msgPtr)),
-                                msgPtr->fd,
-                                false   ); // Don't send process credentials.
+    return result;
 }
 
 
@@ -231,18 +530,93 @@ le_result_t msgMessage_Receive
     // Receive the first bytes into our transaction ID and the rest (if any)
     // into our Message object's payload section.
     UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRef);
+    unixSocket_MsgBuff_t buff;
+
+    PrepareToReceive(msgPtr, &buff);
 
-    size_t byteCount = sizeof(msgPtr->txnId) + le_msg_GetMaxPayloadSize(msgRef);
     le_result_t result = unixSocket_ReceiveMsg( socketFd,
-                                                &msgPtr->txnId,
-                                                &byteCount,
-                                                &msgPtr->fd,
+                                                buff.dataPtr,
+                                                &buff.dataSize,
+                                                &buff.fd,
                                                 NULL    );  // Don't receive credentials.
-    if (msgSession_GetInterfaceType(msgRef->sessionRef) == LE_MSG_INTERFACE_SERVER)
+    FinishReceive(msgPtr, &buff);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive whatever messages are waiting on a connected socket, up to the number of Message
+ * objects provided, using one system call.
+ *
+ * Messages that couldn't be received whole are logged and dropped, and the messages after them
+ * are still delivered.  The Message objects used by the messages received are moved to the start
+ * of the array, and those of the dropped messages after them, so they can be used again.
+ *
+ * @return
+ * - LE_OK if at least one message was received, even if it was dropped.
+ * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_COMM_ERROR if an error was encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                 socketFd,   ///< [IN] The socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],  ///< [IN+OUT] Message objects to store the received messages
+                                    ///     in.  Reordered as described above.
+    size_t*             countPtr,   ///< [IN+OUT] Number of Message objects (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages received and not dropped.
+    size_t*             droppedPtr  ///< [OUT] Number of messages received and dropped.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unixSocket_MsgBuff_t buffs[UNIXSOCKET_MAX_BATCH_SIZE];
+    size_t i;
+
+    LE_ASSERT(*countPtr <= UNIXSOCKET_MAX_BATCH_SIZE);
+
+    for (i = 0; i < *countPtr; i++)
     {
-        msgPtr->clientServer.server.responseFd = -1;
+        PrepareToReceive(msgMessage_GetUnixMessagePtr(msgRefs[i]), &buffs[i]);
+    }
+
+    le_result_t result = unixSocket_ReceiveMsgBatch(socketFd, buffs, countPtr);
+    size_t count = 0;
+
+    for (i = 0; i < *countPtr; i++)
+    {
+        UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRefs[i]);
+
+        FinishReceive(msgPtr, &buffs[i]);
+
+        if (buffs[i].result != LE_OK)
+        {
+            LE_ERROR("Dropped a message received on socket fd %d (%s).",
+                     socketFd,
+                     LE_RESULT_TXT(buffs[i].result));
+
+            // Don't let the Message be mistaken for a request needing a response.
+            msgPtr->txnId = 0;
+            continue;
+        }
+
+        // Keep the messages received whole in order at the start of the array.
+        if (count != i)
+        {
+            le_msg_MessageRef_t droppedMsgRef = msgRefs[count];
+
+            msgRefs[count] = msgRefs[i];
+            msgRefs[i] = droppedMsgRef;
+        }
+        count++;
     }
 
+    *droppedPtr = *countPtr - count;
+    *countPtr = count;
+
     return result;
 }
 
@@ -338,35 +712,29 @@ le_msg_MessageRef_t le_msg_CreateMsg
     LE_FATAL_IF(sessionRef->type != LE_MSG_SESSION_UNIX_SOCKET,
                 "Corrupted session type: %d", sessionRef->type);
 
-    // Get a reference to the Session's Protocol and ask the Protocol to allocate a Message
-    // object from its Message Pool.
-    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
-    UnixMessage_t* msgPtr = msgProto_AllocMessage(protocolRef);
+    UnixMessage_t* msgPtr = CreateUnixMsg(sessionRef);
+    void* payloadPtr = msgPtr->payload;
 
-    // Initialize the Message object's data members.
-    msgPtr->link = LE_DLS_LINK_INIT;
-    msgPtr->message.sessionRef = sessionRef;
-    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
-
-    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
-    switch (interfaceType)
+    // If the session uses shared memory, try to put the payload in a shared memory buffer.
+    // If they are all in use, fall back to sending this message through the socket.
+    msgShm_Region_t* regionPtr = msgSession_GetShmRegion(sessionRef);
+    if (regionPtr != NULL)
     {
-        case LE_MSG_INTERFACE_CLIENT:
-            msgPtr->clientServer.client.completionCallback = NULL;
-            msgPtr->clientServer.client.contextPtr = NULL;
-            break;
-
-        case LE_MSG_INTERFACE_SERVER:
-            msgPtr->clientServer.server.responseFd = -1;
-            break;
-
-        default:
-            LE_FATAL("Unhandled interface type (%d).", interfaceType);
+        int32_t bufferIdx = msgShm_AllocBuffer(regionPtr);
+        if (bufferIdx >= 0)
+        {
+            // The message keeps the reference to the region.
+            msgPtr->shmRegionPtr = regionPtr;
+            msgPtr->shmBufferIdx = bufferIdx;
+            payloadPtr = msgShm_GetBufferPtr(regionPtr, bufferIdx);
+        }
+        else
+        {
+            le_mem_Release(regionPtr);
+        }
     }
 
-    msgPtr->fd = -1;
-    msgPtr->txnId = 0;
-    memset(msgPtr->payload, 0, le_msg_GetProtocolMaxMsgSize(protocolRef));
+    memset(payloadPtr, 0, le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(sessionRef)));
 
     return msgMessage_GetMessageRef(msgPtr);
 }
@@ -485,7 +853,16 @@ void* le_msg_GetPayloadPtr
         case LE_MSG_SESSION_LOCAL:
             return msgLocal_GetPayloadPtr(msgRef);
         case LE_MSG_SESSION_UNIX_SOCKET:
-            return msgMessage_GetUnixMessagePtr(msgRef)->payload;
+        {
+            UnixMessage_t* msgPtr = msgMessage_GetUnixMessagePtr(msgRef);
+
+            if (msgPtr->shmRegionPtr != NULL)
+            {
+                return msgShm_GetBufferPtr(msgPtr->shmRegionPtr, msgPtr->shmBufferIdx);
+            }
+
+            return msgPtr->payload;
+        }
         default:
             LE_FATAL("Corrupted session type: %d", msgRef->sessionRef->type);
     }
@@ -8,6 +8,8 @@
 #ifndef LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 #define LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 
+#include "messagingShm.h"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a message.
@@ -35,11 +37,15 @@ typedef struct le_msg_UnixMessage
         struct
         {
             int responseFd;    ///< fd to send back with the response message. (-1 = no fd)
+            bool isResponseFdMoved; ///< responseFd was moved to fd to send the response.
         }
         server;
     }
     clientServer;
 
+    msgShm_Region_t*            shmRegionPtr; ///< Shared memory region holding the payload.
+                                              ///  NULL = the payload is in this object.
+    uint32_t                    shmBufferIdx; ///< Index of the payload's shared memory buffer.
     int                         fd;         ///< File descriptor to send or received (-1 = no fd)
     void*                       txnId;      ///< Safe reference value used as a transaction ID.
     void*                       payload[0]; ///< Variable-length payload buffer appears at the end.
@@ -73,6 +79,51 @@ le_mem_PoolRef_t msgMessage_CreatePool
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Message object to receive a message into.  Unlike le_msg_CreateMsg(), this never puts
+ * the payload in shared memory.
+ *
+ * @return  The message reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t msgMessage_CreateRxMsg
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Reference to the session.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the control message that was received into a Message object.  Only valid if the Message's
+ * transaction ID is MSGSHM_CONTROL_MARKER.
+ *
+ * @return A pointer to the control message (inside the Message object).
+ */
+//--------------------------------------------------------------------------------------------------
+const msgShm_ControlMsg_t* msgMessage_GetControlMsg
+(
+    le_msg_MessageRef_t msgRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn a Message object holding a received doorbell into the message the doorbell announced,
+ * with its payload in a buffer of a shared memory region.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the doorbell refers to a buffer that is not in use.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_AcceptDoorbell
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] Message holding the doorbell.
+    msgShm_Region_t*    regionPtr   ///< [IN] The session's shared memory region.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send a single message over a connected socket.
@@ -90,6 +141,27 @@ le_result_t msgMessage_Send
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket, in order, using as few system calls as
+ * possible.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the socket reported an error on the send operation.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int                 socketFd,   ///< [IN] Connected socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],  ///< [IN] The Messages to be sent.
+    size_t*             countPtr    ///< [IN+OUT] Number of Messages (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     Messages sent.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receive a single message from a connected socket.
@@ -108,6 +180,34 @@ le_result_t msgMessage_Receive
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive whatever messages are waiting on a connected socket, up to the number of Message
+ * objects provided, using one system call.
+ *
+ * Messages that couldn't be received whole are logged and dropped, and the messages after them
+ * are still delivered.  The Message objects used by the messages received are moved to the start
+ * of the array, and those of the dropped messages after them, so they can be used again.
+ *
+ * @return
+ * - LE_OK if at least one message was received, even if it was dropped.
+ * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_COMM_ERROR if an error was encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                 socketFd,   ///< [IN] The socket's file descriptor.
+    le_msg_MessageRef_t msgRefs[],  ///< [IN+OUT] Message objects to store the received messages
+                                    ///     in.  Reordered as described above.
+    size_t*             countPtr,   ///< [IN+OUT] Number of Message objects (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages received and not dropped.
+    size_t*             droppedPtr  ///< [OUT] Number of messages received and dropped.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets a pointer to the queue link inside a Message object.
@@ -31,6 +31,24 @@
 #define MAX_EXPECTED_TXNS 32
 
 
+//--------------------------------------------------------------------------------------------------
+/// Largest number of messages sent or received through a session's socket in one system call.
+//--------------------------------------------------------------------------------------------------
+#define BATCH_SIZE LE_CONFIG_IPC_BATCH_SIZE
+
+static_assert((BATCH_SIZE >= 1) && (BATCH_SIZE <= UNIXSOCKET_MAX_BATCH_SIZE),
+              "LE_CONFIG_IPC_BATCH_SIZE out of range");
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts of the socket system calls made to send and receive messages, and of the messages they
+ * carried, for all sessions in this process.  Updated atomically, without holding the Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_BatchStats_t BatchStats;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mutex used to protect data structures in this module from multi-threaded race conditions.
@@ -93,6 +111,91 @@ static le_msg_SessionRef_t msgSession_GetSessionRef(msgSession_UnixSession_t *un
 static void AttemptOpen(msgSession_UnixSession_t* sessionPtr);
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a system call that sent or received messages to the Batch Statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountBatch
+(
+    uint64_t* callCountPtr,     ///< [IN] Count of system calls to update.
+    uint64_t* msgCountPtr,      ///< [IN] Count of messages to update.
+    size_t* maxBatchPtr,        ///< [IN] Largest batch to update.
+    size_t msgCount             ///< [IN] Number of messages sent or received by the call.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (msgCount == 0)
+    {
+        return;
+    }
+
+    __atomic_fetch_add(callCountPtr, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(msgCountPtr, msgCount, __ATOMIC_RELAXED);
+
+    size_t maxBatch = __atomic_load_n(maxBatchPtr, __ATOMIC_RELAXED);
+    while ((msgCount > maxBatch) &&
+           !__atomic_compare_exchange_n(maxBatchPtr, &maxBatch, msgCount, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // maxBatch was updated with the current value.  Try again.
+    }
+}
+
+#define COUNT_RX_BATCH(n) \
+    CountBatch(&BatchStats.rxCallCount, &BatchStats.rxMsgCount, &BatchStats.rxMaxBatch, (n))
+#define COUNT_TX_BATCH(n) \
+    CountBatch(&BatchStats.txCallCount, &BatchStats.txMsgCount, &BatchStats.txMaxBatch, (n))
+
+
+#if LE_CONFIG_RUNTIME_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a message sent or received on a session in the runtime statistics page.  Its payload is
+ * counted at the protocol's maximum payload size, which is what goes over the socket.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountMessage
+(
+    msgSession_UnixSession_t* sessionPtr,
+    le_msg_MessageRef_t msgRef,
+    bool isTx                   ///< [IN] true if the message was sent, false if received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    statsPage_Session_t* slotPtr = sessionPtr->statsPtr;
+    uint64_t numBytes = le_msg_GetMaxPayloadSize(msgRef);
+
+    if (isTx)
+    {
+        STATS_ADD(ipcTxMsgs, 1);
+        STATS_ADD(ipcTxBytes, numBytes);
+        if (slotPtr != NULL)
+        {
+            stats_Add(&slotPtr->txMsgs, 1);
+            stats_Add(&slotPtr->txBytes, numBytes);
+        }
+    }
+    else
+    {
+        STATS_ADD(ipcRxMsgs, 1);
+        STATS_ADD(ipcRxBytes, numBytes);
+        if (slotPtr != NULL)
+        {
+            stats_Add(&slotPtr->rxMsgs, 1);
+            stats_Add(&slotPtr->rxBytes, numBytes);
+        }
+    }
+}
+
+#   define COUNT_TX_MSG(sessionPtr, msgRef)     CountMessage((sessionPtr), (msgRef), true)
+#   define COUNT_RX_MSG(sessionPtr, msgRef)     CountMessage((sessionPtr), (msgRef), false)
+#else
+#   define COUNT_TX_MSG(sessionPtr, msgRef)     ((void)0)
+#   define COUNT_RX_MSG(sessionPtr, msgRef)     ((void)0)
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Pushes a message onto the tail of the Transmit Queue.
@@ -453,8 +556,17 @@ static msgSession_UnixSession_t* CreateSession
     sessionPtr->closeHandler = NULL;
     sessionPtr->closeContextPtr = NULL;
 
+    sessionPtr->shmNumBuffers = 0;
+    sessionPtr->shmRegionPtr = NULL;
+    sessionPtr->batchDepth = 0;
+
     sessionPtr->interfaceRef = interfaceRef;
 
+#if LE_CONFIG_RUNTIME_STATS
+    bool isServer = (interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER);
+    sessionPtr->statsPtr = stats_AddSession(le_msg_GetInterfaceName(interfaceRef), isServer);
+#endif
+
     SessionObjListChangeCount++;
     msgInterface_AddSession(interfaceRef, msgSession_GetSessionRef(sessionPtr));
 
@@ -497,6 +609,17 @@ static void CloseSession
     fd_Close(sessionPtr->socketFd);
     sessionPtr->socketFd = -1;
 
+    // Drop the session's hold on the shared memory region.  Messages still using buffers in it
+    // keep it mapped until they are released.
+    LOCK
+    msgShm_Region_t* shmRegionPtr = sessionPtr->shmRegionPtr;
+    sessionPtr->shmRegionPtr = NULL;
+    UNLOCK
+    if (shmRegionPtr != NULL)
+    {
+        le_mem_Release(shmRegionPtr);
+    }
+
     // If there are any messages stranded on the transmit queue, the pending transaction list,
     // or the receive queue, clean them all up.
     if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
@@ -532,6 +655,11 @@ static void DeleteSession
     msgInterface_RemoveSession(sessionPtr->interfaceRef,
                                msgSession_GetSessionRef(sessionPtr));
 
+#if LE_CONFIG_RUNTIME_STATS
+    stats_FreeSlot(sessionPtr->statsPtr);
+    sessionPtr->statsPtr = NULL;
+#endif
+
     // Release the Session object itself.
     le_mem_Release(sessionPtr);
 }
@@ -923,34 +1051,272 @@ static void ClientSocketError
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Receive messages from the socket and put them on the Receive Queue.
+ * Client-side: set up the shared memory transport on a session that has just been opened, if the
+ * client asked for it.  The region is sent to the server, which maps it before it looks at any
+ * message sent after it.
+ *
+ * If anything goes wrong, the session just keeps sending everything through the socket.
  */
 //--------------------------------------------------------------------------------------------------
-static void ReceiveMessages
+static void StartSharedMemory
 (
     msgSession_UnixSession_t* sessionPtr
 )
 //--------------------------------------------------------------------------------------------------
+{
+    int fd;
+
+    if (sessionPtr->shmNumBuffers == 0)
+    {
+        return;
+    }
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(msgSession_GetSessionRef(sessionPtr));
+
+    msgShm_Region_t* regionPtr = msgShm_Create(sessionPtr->shmNumBuffers,
+                                               le_msg_GetProtocolMaxMsgSize(protocolRef),
+                                               &fd);
+    if (regionPtr == NULL)
+    {
+        LE_WARN("Not using shared memory for session (%s:%s).",
+                le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+                le_msg_GetProtocolIdStr(protocolRef));
+        return;
+    }
+
+    msgShm_ControlMsg_t setup =
+    {
+        .marker = MSGSHM_CONTROL_MARKER,
+        .type = MSGSHM_CONTROL_SETUP,
+        .bufferIdx = 0,
+        .txnId = NULL
+    };
+
+    // The socket was only just connected, so there is room in it for this small message.
+    le_result_t result = unixSocket_SendMsg(sessionPtr->socketFd,
+                                            &setup,
+                                            sizeof(setup),
+                                            fd,
+                                            false); // Don't send process credentials.
+    fd_Close(fd);
+
+    if (result != LE_OK)
+    {
+        LE_WARN("Failed to send shared memory region for session (%s:%s). Result = %s.",
+                le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+                le_msg_GetProtocolIdStr(protocolRef),
+                LE_RESULT_TXT(result));
+        le_mem_Release(regionPtr);
+        return;
+    }
+
+    LOCK
+    sessionPtr->shmRegionPtr = regionPtr;
+    UNLOCK
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle a control message of the shared memory transport.
+ *
+ * @return true if the Message object now holds a normal message that should be processed,
+ *         false if it should be released.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ProcessControlMessage
+(
+    msgSession_UnixSession_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const msgShm_ControlMsg_t* controlPtr = msgMessage_GetControlMsg(msgRef);
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(msgSession_GetSessionRef(sessionPtr));
+
+    switch (controlPtr->type)
+    {
+        case MSGSHM_CONTROL_SETUP:
+        {
+            if (   (sessionPtr->interfaceRef->interfaceType != LE_MSG_INTERFACE_SERVER)
+                || (sessionPtr->shmRegionPtr != NULL)  )
+            {
+                break;
+            }
+
+            int fd = le_msg_GetFd(msgRef);
+            if (fd < 0)
+            {
+                break;
+            }
+
+            msgShm_Region_t* regionPtr = msgShm_Attach(fd, le_msg_GetProtocolMaxMsgSize(protocolRef));
+            fd_Close(fd);
+
+            if (regionPtr != NULL)
+            {
+                LOCK
+                sessionPtr->shmRegionPtr = regionPtr;
+                UNLOCK
+            }
+
+            return false;
+        }
+
+        case MSGSHM_CONTROL_DOORBELL:
+            if (   (sessionPtr->shmRegionPtr != NULL)
+                && (msgMessage_AcceptDoorbell(msgRef, sessionPtr->shmRegionPtr) == LE_OK)  )
+            {
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    LE_ERROR("Dropping invalid shared memory control message (type %" PRIu32 ") on session (%s:%s).",
+             controlPtr->type,
+             le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+             le_msg_GetProtocolIdStr(protocolRef));
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a message just received from a session's socket.  Shared memory control messages are
+ * handled here.
+ *
+ * @return true if the message should be processed, false if it should be released.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsUserMessage
+(
+    msgSession_UnixSession_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (msgMessage_GetTxnId(msgRef) != MSGSHM_CONTROL_MARKER)
+        || ProcessControlMessage(sessionPtr, msgRef)  )
+    {
+        return true;
+    }
+
+    // Clear the marker so the message isn't mistaken for a request needing a response when it
+    // is released.
+    msgMessage_SetTxnId(msgRef, 0);
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive one message from a session's socket.  Shared memory control messages are handled here
+ * and don't get passed to the caller.
+ *
+ * @return
+ * - LE_OK if a message was received.
+ * - Otherwise, whatever msgMessage_Receive() returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReceiveMessage
+(
+    msgSession_UnixSession_t* sessionPtr,
+    le_msg_MessageRef_t* msgRefPtr      ///< [OUT] The received message.
+)
+//--------------------------------------------------------------------------------------------------
 {
     for (;;)
     {
         // Create a Message object.
-        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(msgSession_GetSessionRef(sessionPtr));
+        le_msg_MessageRef_t msgRef = msgMessage_CreateRxMsg(msgSession_GetSessionRef(sessionPtr));
 
         // Receive from the socket into the Message object.
         le_result_t result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
 
-        if (result == LE_OK)
+        if (result != LE_OK)
         {
-            // Received something.  Push it onto the Receive Queue for later processing.
-            PushReceiveQueue(sessionPtr, msgRef);
+            le_msg_ReleaseMsg(msgRef);
+            return result;
         }
-        else
+
+        COUNT_RX_BATCH(1);
+
+        if (IsUserMessage(sessionPtr, msgRef))
         {
-            // Nothing left to receive from the socket.  We are done.
-            le_msg_ReleaseMsg(msgRef);
-            break;
+            COUNT_RX_MSG(sessionPtr, msgRef);
+            *msgRefPtr = msgRef;
+            return LE_OK;
         }
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive messages from the socket and put them on the Receive Queue.
+ *
+ * Up to BATCH_SIZE messages are received per system call.  Message objects that were not needed
+ * by one call, or that held messages that were dropped, are kept for the next.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReceiveMessages
+(
+    msgSession_UnixSession_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_SessionRef_t sessionRef = msgSession_GetSessionRef(sessionPtr);
+    le_msg_MessageRef_t msgRefs[BATCH_SIZE];
+    size_t count = BATCH_SIZE;
+    size_t dropped = 0;
+    size_t i;
+
+    do
+    {
+        // Create Message objects to replace the ones used by the last batch.
+        for (i = 0; i < count; i++)
+        {
+            msgRefs[i] = msgMessage_CreateRxMsg(sessionRef);
+        }
+
+        // Receive from the socket into the Message objects.  On failure, nothing was received.
+        // The Message objects of dropped messages are left after the ones received.
+        count = BATCH_SIZE;
+        if (msgMessage_ReceiveBatch(sessionPtr->socketFd, msgRefs, &count, &dropped) != LE_OK)
+        {
+            count = 0;
+            dropped = 0;
+        }
+
+        COUNT_RX_BATCH(count + dropped);
+
+        // Push what was received onto the Receive Queue for later processing.
+        for (i = 0; i < count; i++)
+        {
+            if (IsUserMessage(sessionPtr, msgRefs[i]))
+            {
+                COUNT_RX_MSG(sessionPtr, msgRefs[i]);
+                PushReceiveQueue(sessionPtr, msgRefs[i]);
+            }
+            else
+            {
+                le_msg_ReleaseMsg(msgRefs[i]);
+            }
+        }
+    }
+    // If the batch wasn't filled, there's nothing left to receive from the socket.  We are done.
+    while (count + dropped == BATCH_SIZE);
+
+    for (i = count; i < BATCH_SIZE; i++)
+    {
+        le_msg_ReleaseMsg(msgRefs[i]);
     }
 }
 
@@ -1001,10 +1367,61 @@ static void ServerSocketError
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deal with a message from a session's Transmit Queue that has been sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MessageSent
+(
+    msgSession_UnixSession_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    COUNT_TX_MSG(sessionPtr, msgRef);
+
+    switch (sessionPtr->interfaceRef->interfaceType)
+    {
+        // If this is the client side of the session,
+        case LE_MSG_INTERFACE_CLIENT:
+            // If a response is expected from the other side later, then put this
+            // message on the Transaction List.
+            if (msgMessage_GetTxnId(msgRef) != 0)
+            {
+                AddToTxnList(sessionPtr, msgRef);
+            }
+            // Otherwise, release it.
+            else
+            {
+                le_msg_ReleaseMsg(msgRef);
+            }
+
+            break;
+
+        // If this is the server side of the session,
+        case LE_MSG_INTERFACE_SERVER:
+            // Release the message, but first clear out the transaction ID so that
+            // the message knows that it is not being deleted without a reponse message
+            // being sent if one was expected.
+            msgMessage_SetTxnId(msgRef, 0);
+            le_msg_ReleaseMsg(msgRef);
+
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d)",
+                     sessionPtr->interfaceRef->interfaceType);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send messages from a session's Transmit Queue until either the socket becomes full or there
  * are no more messages waiting on the queue.
+ *
+ * Up to BATCH_SIZE messages are sent per system call.
  */
 //--------------------------------------------------------------------------------------------------
 static void SendFromTransmitQueue
@@ -1013,11 +1430,24 @@ static void SendFromTransmitQueue
 )
 //--------------------------------------------------------------------------------------------------
 {
+    le_msg_MessageRef_t msgRefs[BATCH_SIZE];
+    size_t i;
+
     for (;;)
     {
-        le_msg_MessageRef_t msgRef = PopTransmitQueue(sessionPtr);
+        size_t count = 0;
 
-        if (msgRef == NULL)
+        while (count < BATCH_SIZE)
+        {
+            le_msg_MessageRef_t msgRef = PopTransmitQueue(sessionPtr);
+            if (msgRef == NULL)
+            {
+                break;
+            }
+            msgRefs[count++] = msgRef;
+        }
+
+        if (count == 0)
         {
             // Since the Transmit Queue is empty, tell the FD Monitor that we don't need to be
             // notified about writeability anymore.
@@ -1025,51 +1455,30 @@ static void SendFromTransmitQueue
             break;
         }
 
-        le_result_t result = msgMessage_Send(sessionPtr->socketFd, msgRef);
+        size_t sentCount = count;
+        le_result_t result = msgMessage_SendBatch(sessionPtr->socketFd, msgRefs, &sentCount);
+
+        COUNT_TX_BATCH(sentCount);
+
+        for (i = 0; i < sentCount; i++)
+        {
+            MessageSent(sessionPtr, msgRefs[i]);
+        }
+
+        // Put anything that wasn't sent back on the head of the queue, in the original order.
+        for (i = count; i > sentCount; i--)
+        {
+            UnPopTransmitQueue(sessionPtr, msgRefs[i - 1]);
+        }
 
         switch (result)
         {
             case LE_OK:
-                switch (sessionPtr->interfaceRef->interfaceType)
-                {
-                    // If this is the client side of the session,
-                    case LE_MSG_INTERFACE_CLIENT:
-                        // If a response is expected from the other side later, then put this
-                        // message on the Transaction List.
-                        if (msgMessage_GetTxnId(msgRef) != 0)
-                        {
-                            AddToTxnList(sessionPtr, msgRef);
-                        }
-                        // Otherwise, release it.
-                        else
-                        {
-                            le_msg_ReleaseMsg(msgRef);
-                        }
-
-                        break;
-
-                    // If this is the server side of the session,
-                    case LE_MSG_INTERFACE_SERVER:
-                        // Release the message, but first clear out the transaction ID so that
-                        // the message knows that it is not being deleted without a reponse message
-                        // being sent if one was expected.
-                        msgMessage_SetTxnId(msgRef, 0);
-                        le_msg_ReleaseMsg(msgRef);
-
-                        break;
-
-                    default:
-                        LE_FATAL("Unhandled interface type (%d)",
-                                 sessionPtr->interfaceRef->interfaceType);
-                }
-
-                break;  // Continue to loop around and send another.
+                break;  // Continue to loop around and send another batch.
 
             case LE_NO_MEMORY:
-                // Have to wait for the socket to become writeable.  Put the message back on
-                // the head of the queue and ask the FD Monitor to tell us when the socket becomes
-                // writeable again.
-                UnPopTransmitQueue(sessionPtr, msgRef);
+                // Have to wait for the socket to become writeable.  Ask the FD Monitor to tell us
+                // when the socket becomes writeable again.
                 EnableWriteabilityNotification(sessionPtr);
 
                 return;
@@ -1077,10 +1486,8 @@ static void SendFromTransmitQueue
             case LE_COMM_ERROR:
                 // In this case, we expect a handler function to be called by the FD Monitor,
                 // so we don't need to handle this case here.  However, we must stop
-                // trying to transmit now.  Stick the current message back on the Transmit Queue
-                // so it gets cleaned up with the others when the session closes.
-                UnPopTransmitQueue(sessionPtr, msgRef);
-
+                // trying to transmit now.  The messages that weren't sent are back on the
+                // Transmit Queue so they get cleaned up with the others when the session closes.
                 return;
 
             default:
@@ -1126,6 +1533,8 @@ static void ClientSocketReadable
             {
                 sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
 
+                StartSharedMemory(sessionPtr);
+
                 // Call the client's completion callback.
                 sessionPtr->openHandler(msgSession_GetSessionRef(sessionPtr), sessionPtr->openContextPtr);
             }
@@ -1462,6 +1871,8 @@ static le_result_t AttemptOpenSync
                 StartSocketMonitoring(sessionPtr, ClientSocketEventHandler);
 
                 sessionPtr->state = LE_MSG_SESSION_STATE_OPEN;
+
+                StartSharedMemory(sessionPtr);
             }
             else
             {
@@ -1604,6 +2015,34 @@ bool msgSession_IsOpen
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the shared memory region used to carry message payloads on a given session.
+ *
+ * @return  A pointer to the region, or NULL if the session doesn't use shared memory.  The caller
+ *          gets a reference to the region and must release it with le_mem_Release().
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgSession_GetShmRegion
+(
+    le_msg_SessionRef_t sessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgSession_UnixSession_t* unixSessionPtr = msgSession_GetUnixSessionPtr(sessionRef);
+
+    LOCK
+    msgShm_Region_t* regionPtr = unixSessionPtr->shmRegionPtr;
+    if (regionPtr != NULL)
+    {
+        le_mem_AddRef(regionPtr);
+    }
+    UNLOCK
+
+    return regionPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a given Message object through a given Session.
@@ -1635,8 +2074,11 @@ void msgSession_SendMessage
         // Put the message on the Transmit Queue.
         PushTransmitQueue(unixSessionPtr, messageRef);
 
-        // Try to send something from the Transmit Queue.
-        SendFromTransmitQueue(unixSessionPtr);
+        // Try to send something from the Transmit Queue, unless a batch is being built.
+        if (unixSessionPtr->batchDepth == 0)
+        {
+            SendFromTransmitQueue(unixSessionPtr);
+        }
     }
 }
 
@@ -1671,8 +2113,11 @@ void msgSession_RequestResponse
     // Put the message on the Transmit Queue.
     PushTransmitQueue(unixSessionPtr, msgRef);
 
-    // Try to send something from the Transmit Queue.
-    SendFromTransmitQueue(unixSessionPtr);
+    // Try to send something from the Transmit Queue, unless a batch is being built.
+    if (unixSessionPtr->batchDepth == 0)
+    {
+        SendFromTransmitQueue(unixSessionPtr);
+    }
 }
 
 
@@ -1703,8 +2148,16 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     // Put the socket into blocking mode.
     fd_SetBlocking(unixSessionPtr->socketFd);
 
+    // Anything still on the Transmit Queue (e.g., part of a batch) was requested before this, so
+    // it has to go first.
+    SendFromTransmitQueue(unixSessionPtr);
+
     // Send the Request Message.
-    msgMessage_Send(unixSessionPtr->socketFd, msgRef);
+    if (msgMessage_Send(unixSessionPtr->socketFd, msgRef) == LE_OK)
+    {
+        COUNT_TX_BATCH(1);
+        COUNT_TX_MSG(unixSessionPtr, msgRef);
+    }
 
     // While we have not yet received the response we are waiting for, keep
     // receiving messages.  Any that we receive that don't match the transaction ID
@@ -1712,15 +2165,12 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     // function call.
     for (;;)
     {
-        rxMsgRef = le_msg_CreateMsg(sessionRef);
-
-        le_result_t result = msgMessage_Receive(unixSessionPtr->socketFd, rxMsgRef);
+        le_result_t result = ReceiveMessage(unixSessionPtr, &rxMsgRef);
 
         if (result != LE_OK)
         {
             // The socket experienced an error or the connection was closed.
             // No message was received.
-            le_msg_ReleaseMsg(rxMsgRef);
             rxMsgRef = NULL;
             break;
         }
@@ -2129,6 +2579,259 @@ void le_msg_SetSessionCloseHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets counts of the socket system calls made by this process to send and receive messages, and
+ * of the messages they carried.  Comparing the message counts to the call counts shows how well
+ * messages are being batched.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_GetBatchStats
+(
+    le_msg_BatchStats_t* statsPtr   ///< [OUT] The statistics.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(statsPtr);
+
+    statsPtr->rxCallCount = __atomic_load_n(&BatchStats.rxCallCount, __ATOMIC_RELAXED);
+    statsPtr->rxMsgCount = __atomic_load_n(&BatchStats.rxMsgCount, __ATOMIC_RELAXED);
+    statsPtr->rxMaxBatch = __atomic_load_n(&BatchStats.rxMaxBatch, __ATOMIC_RELAXED);
+    statsPtr->txCallCount = __atomic_load_n(&BatchStats.txCallCount, __ATOMIC_RELAXED);
+    statsPtr->txMsgCount = __atomic_load_n(&BatchStats.txMsgCount, __ATOMIC_RELAXED);
+    statsPtr->txMaxBatch = __atomic_load_n(&BatchStats.txMaxBatch, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes the responses to asynchronous requests that are waiting on a session's Receive Queue
+ * (put there while waiting for a synchronous response).  Other messages are left on the queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessQueuedResponses
+(
+    msgSession_UnixSession_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&sessionPtr->receiveQueue);
+
+    while (linkPtr != NULL)
+    {
+        le_dls_Link_t* nextLinkPtr = le_dls_PeekNext(&sessionPtr->receiveQueue, linkPtr);
+        le_msg_MessageRef_t msgRef = msgMessage_GetMessageContainingLink(linkPtr);
+
+        if (LookupTxnId(msgRef) != NULL)
+        {
+            le_dls_Remove(&sessionPtr->receiveQueue, linkPtr);
+            ProcessMessageFromServer(sessionPtr, msgRef);
+        }
+
+        linkPtr = nextLinkPtr;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends everything on a session's Transmit Queue, then waits until every request on the session's
+ * Transaction List has got its response, calling their completion callbacks.  Other messages
+ * received in the meantime are queued for later handling, as for a synchronous request.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaitForResponses
+(
+    msgSession_UnixSession_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t rxMsgRef;
+
+    // Put the socket into blocking mode, so that the whole Transmit Queue gets sent.
+    fd_SetBlocking(sessionPtr->socketFd);
+    SendFromTransmitQueue(sessionPtr);
+
+    ProcessQueuedResponses(sessionPtr);
+
+    // The completion callbacks may start new transactions, which are waited for too.  If the
+    // session closes, the remaining transactions are dealt with when the hang-up is handled.
+    while ((sessionPtr->state == LE_MSG_SESSION_STATE_OPEN) &&
+           !le_dls_IsEmpty(&sessionPtr->txnList))
+    {
+        SendFromTransmitQueue(sessionPtr);
+
+        if (ReceiveMessage(sessionPtr, &rxMsgRef) != LE_OK)
+        {
+            break;
+        }
+
+        if (LookupTxnId(rxMsgRef) != NULL)
+        {
+            ProcessMessageFromServer(sessionPtr, rxMsgRef);
+        }
+        else
+        {
+            if (le_dls_IsEmpty(&sessionPtr->receiveQueue))
+            {
+                TriggerDeferredProcessing(sessionPtr);
+            }
+            PushReceiveQueue(sessionPtr, rxMsgRef);
+        }
+    }
+
+    // Put the socket back into non-blocking mode.
+    if (sessionPtr->socketFd >= 0)
+    {
+        fd_SetNonBlocking(sessionPtr->socketFd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of messages on a session.  Until the matching le_msg_EndBatch(), messages sent
+ * with le_msg_Send() or le_msg_RequestResponse() are queued instead of being written to the
+ * socket.  Batches can be nested; only the outermost le_msg_EndBatch() sends the messages.
+ *
+ * Has no effect on local sessions.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Only the thread that owns the session can start a batch on it.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_StartBatch
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(sessionRef);
+    switch (sessionRef->type)
+    {
+        case LE_MSG_SESSION_LOCAL:
+            break;
+        case LE_MSG_SESSION_UNIX_SOCKET:
+        {
+            msgSession_UnixSession_t* unixSessionPtr = msgSession_GetUnixSessionPtr(sessionRef);
+
+            LE_FATAL_IF(unixSessionPtr->interfaceRef->interfaceType != LE_MSG_INTERFACE_CLIENT,
+                        "Server attempted to start a batch on a session.");
+            LE_FATAL_IF(le_thread_GetCurrent() != unixSessionPtr->threadRef,
+                        "Calling thread doesn't own the session '%s'.",
+                        le_msg_GetInterfaceName(unixSessionPtr->interfaceRef));
+
+            unixSessionPtr->batchDepth++;
+            break;
+        }
+        default:
+            LE_FATAL("Corrupted session type: %d", sessionRef->type);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ends a batch of messages on a session.  At the end of the outermost batch, the queued messages
+ * are sent together, then the calling thread is blocked until the responses to all of the
+ * session's outstanding asynchronous requests have arrived.  Their callbacks are called before
+ * this function returns.
+ *
+ * Has no effect on local sessions.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Only the thread that owns the session can end a batch on it.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_EndBatch
+(
+    le_msg_SessionRef_t sessionRef  ///< [in] Reference to the session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(sessionRef);
+    switch (sessionRef->type)
+    {
+        case LE_MSG_SESSION_LOCAL:
+            break;
+        case LE_MSG_SESSION_UNIX_SOCKET:
+        {
+            msgSession_UnixSession_t* unixSessionPtr = msgSession_GetUnixSessionPtr(sessionRef);
+
+            LE_FATAL_IF(le_thread_GetCurrent() != unixSessionPtr->threadRef,
+                        "Calling thread doesn't own the session '%s'.",
+                        le_msg_GetInterfaceName(unixSessionPtr->interfaceRef));
+            LE_FATAL_IF(unixSessionPtr->batchDepth == 0,
+                        "le_msg_EndBatch() called without le_msg_StartBatch() on session '%s'.",
+                        le_msg_GetInterfaceName(unixSessionPtr->interfaceRef));
+
+            if ((--unixSessionPtr->batchDepth == 0) &&
+                (unixSessionPtr->state == LE_MSG_SESSION_STATE_OPEN))
+            {
+                WaitForResponses(unixSessionPtr);
+            }
+            break;
+        }
+        default:
+            LE_FATAL("Corrupted session type: %d", sessionRef->type);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Requests that message payloads be carried in shared memory for a session, instead of being
+ * copied through its socket.
+ *
+ * Has no effect on local sessions, or if the protocol's maximum message size is too small.
+ *
+ * @note
+ * - This is a client-only function.
+ * - Must be called before the session is opened.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_EnableSharedMemory
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t              numBuffers  ///< [in] Number of payload buffers for each direction.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(sessionRef);
+    switch (sessionRef->type)
+    {
+        case LE_MSG_SESSION_LOCAL:
+            LE_DEBUG("EnableSharedMemory: Local session, ignored");
+            break;
+        case LE_MSG_SESSION_UNIX_SOCKET:
+        {
+            msgSession_UnixSession_t* unixSessionPtr = msgSession_GetUnixSessionPtr(sessionRef);
+
+            LE_FATAL_IF(unixSessionPtr->interfaceRef->interfaceType != LE_MSG_INTERFACE_CLIENT,
+                        "Server attempted to enable shared memory on a session.");
+            LE_FATAL_IF(unixSessionPtr->state != LE_MSG_SESSION_STATE_CLOSED,
+                        "Attempted to enable shared memory on a session that is already open.");
+
+            if (le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(sessionRef))
+                < MSGSHM_MIN_PAYLOAD_SIZE)
+            {
+                LE_WARN("Messages of protocol '%s' are too small for shared memory.",
+                        le_msg_GetProtocolIdStr(le_msg_GetSessionProtocol(sessionRef)));
+                break;
+            }
+
+            unixSessionPtr->shmNumBuffers = numBuffers;
+            break;
+        }
+        default:
+            LE_FATAL("Corrupted session type: %d", sessionRef->type);
+            break;
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the handler callback function to be called when the session is closed from the other
@@ -12,6 +12,8 @@
 
 #include "messagingCommon.h"
 #include "messagingInterface.h"
+#include "messagingShm.h"
+#include "stats.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -63,6 +65,18 @@ typedef struct msg_UnixSession
     void*                           openContextPtr; ///< Open handler's context pointer.
     le_msg_SessionEventHandler_t    closeHandler;   ///< Close handler function.
     void*                           closeContextPtr;///< Close handler's context pointer.
+    size_t                          shmNumBuffers;  ///< Client: number of shared memory buffers
+                                                    ///  per direction to set up when the session
+                                                    ///  opens (0 = don't use shared memory).
+    msgShm_Region_t*                shmRegionPtr;   ///< Shared memory region (NULL if none).
+    size_t                          batchDepth;     ///< Client: number of le_msg_StartBatch()
+                                                    ///  calls not yet matched by
+                                                    ///  le_msg_EndBatch().  Messages are only
+                                                    ///  queued while this is not 0.
+#if LE_CONFIG_RUNTIME_STATS
+    statsPage_Session_t*            statsPtr;       ///< Slot in the runtime statistics page, or
+                                                    ///  NULL if it doesn't have one.
+#endif
 }
 msgSession_UnixSession_t;
 
@@ -116,6 +130,20 @@ bool msgSession_IsOpen
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the shared memory region used to carry message payloads on a given session.
+ *
+ * @return  A pointer to the region, or NULL if the session doesn't use shared memory.  The caller
+ *          gets a reference to the region and must release it with le_mem_Release().
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgSession_GetShmRegion
+(
+    le_msg_SessionRef_t sessionRef
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a given Message object through a given Session.
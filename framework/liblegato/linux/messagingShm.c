@@ -0,0 +1,449 @@
+/** @file messagingShm.c
+ *
+ * @ref c_messaging implementation's "Shared Memory" module.
+ *
+ * A client can ask for a session's message payloads to be carried through shared memory instead
+ * of through the session's socket (see le_msg_EnableSharedMemory()).  When the session opens, the
+ * client creates a memfd, maps it, seals its size and passes it to the server in a SETUP control
+ * message (using SCM_RIGHTS, like le_msg_SetFd()).
+ *
+ * The region starts with a small header, followed by an array of buffer states and then the
+ * buffers themselves.  Each buffer can hold one message payload of the protocol's maximum size.
+ * The first half of the buffers is allocated from by the client and the second half by the server,
+ * so each side only needs an atomic compare-and-swap to take a free buffer.  Either side can free
+ * a buffer, because the receiver of a message owns its payload buffer until it releases the
+ * message (or reuses it for the response).
+ *
+ * When a message with a payload in shared memory is sent, only a small DOORBELL control message
+ * containing the buffer index and the transaction ID goes through the socket.  The receiver hands
+ * the buffer to the received Message object, so the payload is never copied.  If no buffer is
+ * free when a message is created, the message is created and sent the normal way.
+ *
+ * Control messages start with MSGSHM_CONTROL_MARKER where the transaction ID normally goes.
+ *
+ * The server keeps its own copies of the values in the header and checks every buffer index it
+ * receives, so a misbehaving client can only corrupt its own messages.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "messagingShm.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// memfd_create() and file sealing are needed.  Older C libraries don't have a wrapper for
+// memfd_create(), so make the system call directly.
+#if defined(__NR_memfd_create) && defined(F_ADD_SEALS)
+#   define HAVE_MEMFD 1
+#else
+#   define HAVE_MEMFD 0
+#endif
+
+#ifndef MFD_CLOEXEC
+#   define MFD_CLOEXEC          0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#   define MFD_ALLOW_SEALING    0x0002U
+#endif
+
+/// Magic number at the start of a region ("LESM").
+#define REGION_MAGIC            0x4D53454CU
+
+/// Alignment of the buffers in a region.
+#define BUFFER_ALIGN            64
+
+/// Largest number of buffers in each direction.
+#define MAX_BUFFERS             1024
+
+/// Largest region a server will agree to map.
+#define MAX_REGION_SIZE         (64 * 1024 * 1024)
+
+/// Buffer states.
+#define BUFFER_FREE             0
+#define BUFFER_IN_USE           1
+
+/// Round a size up to a multiple of an alignment (which must be a power of two).
+#define ALIGN_UP(size, align)   (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of a shared memory region.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;          ///< REGION_MAGIC.
+    uint32_t    numBuffers;     ///< Total number of buffers (both directions).
+    uint32_t    bufferSize;     ///< Size of each buffer, in bytes.
+    uint32_t    reserved;       ///< Unused.
+    uint32_t    state[];        ///< State of each buffer (BUFFER_FREE or BUFFER_IN_USE).
+}
+RegionHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A process's mapping of a shared memory region.
+ */
+//--------------------------------------------------------------------------------------------------
+struct msgShm_Region
+{
+    RegionHeader_t* headerPtr;      ///< Start of the mapping.
+    size_t          mapSize;        ///< Size of the mapping, in bytes.
+    uint8_t*        buffersPtr;     ///< Start of the first buffer.
+    uint32_t        numBuffers;     ///< Total number of buffers (local copy).
+    uint32_t        bufferSize;     ///< Size of each buffer (local copy).
+    uint32_t        firstOwnBuffer; ///< First buffer in the half this process allocates from.
+    uint32_t        numOwnBuffers;  ///< Number of buffers in the half this process allocates from.
+    uint32_t        nextBuffer;     ///< Where to start looking for a free buffer (relative to
+                                    ///  firstOwnBuffer).
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Region objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t RegionPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset of the first buffer in a region.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BuffersOffset
+(
+    uint32_t numBuffers
+)
+{
+    return ALIGN_UP(sizeof(RegionHeader_t) + numBuffers * sizeof(uint32_t), BUFFER_ALIGN);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor for Region objects.  Unmaps the region.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RegionDestructor
+(
+    void* objPtr
+)
+{
+    msgShm_Region_t* regionPtr = objPtr;
+
+    if (munmap(regionPtr->headerPtr, regionPtr->mapSize) != 0)
+    {
+        LE_ERROR("munmap() failed. Errno = %d (%m).", errno);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a Region object for a mapping.
+ *
+ * @return A pointer to the Region object.
+ */
+//--------------------------------------------------------------------------------------------------
+static msgShm_Region_t* NewRegion
+(
+    void*       mapPtr,
+    size_t      mapSize,
+    uint32_t    numBuffers,
+    uint32_t    bufferSize,
+    bool        isServer
+)
+{
+    msgShm_Region_t* regionPtr = le_mem_ForceAlloc(RegionPool);
+
+    regionPtr->headerPtr = mapPtr;
+    regionPtr->mapSize = mapSize;
+    regionPtr->buffersPtr = (uint8_t*)mapPtr + BuffersOffset(numBuffers);
+    regionPtr->numBuffers = numBuffers;
+    regionPtr->bufferSize = bufferSize;
+    regionPtr->numOwnBuffers = numBuffers / 2;
+    regionPtr->firstOwnBuffer = (isServer ? regionPtr->numOwnBuffers : 0);
+    regionPtr->nextBuffer = 0;
+
+    return regionPtr;
+}
+
+
+// =======================================
+//  PROTECTED (INTER-MODULE) FUNCTIONS
+// =======================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RegionPool = le_mem_CreatePool("MsgShmRegion", sizeof(msgShm_Region_t));
+    le_mem_SetDestructor(RegionPool, RegionDestructor);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a shared memory region for the client side of a session.
+ *
+ * @return A pointer to the region, or NULL if failed (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgShm_Create
+(
+    size_t  numBuffers,     ///< [IN] Number of payload buffers for each direction.
+    size_t  payloadSize,    ///< [IN] Maximum payload size of the session's protocol.
+    int*    fdPtr           ///< [OUT] File descriptor to pass to the server.  The caller must
+                            ///        close it.
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if HAVE_MEMFD
+    if (numBuffers > MAX_BUFFERS)
+    {
+        numBuffers = MAX_BUFFERS;
+    }
+
+    uint32_t totalBuffers = 2 * numBuffers;
+    uint32_t bufferSize = ALIGN_UP(payloadSize, BUFFER_ALIGN);
+    size_t mapSize = ALIGN_UP(BuffersOffset(totalBuffers) + (size_t)totalBuffers * bufferSize,
+                              (size_t)sysconf(_SC_PAGESIZE));
+
+    if (mapSize > MAX_REGION_SIZE)
+    {
+        LE_ERROR("Shared memory region too large (%" PRIuS " bytes).", mapSize);
+        return NULL;
+    }
+
+    int fd = syscall(__NR_memfd_create, "le_msg", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        LE_ERROR("memfd_create() failed. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    if (ftruncate(fd, mapSize) != 0)
+    {
+        LE_ERROR("ftruncate() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    // Stop the size from changing under the server's feet.
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        LE_ERROR("Failed to seal shared memory. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    void* mapPtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("mmap() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    // A new memfd is zero-filled, so all the buffers start out free.
+    RegionHeader_t* headerPtr = mapPtr;
+    headerPtr->magic = REGION_MAGIC;
+    headerPtr->numBuffers = totalBuffers;
+    headerPtr->bufferSize = bufferSize;
+
+    *fdPtr = fd;
+
+    return NewRegion(mapPtr, mapSize, totalBuffers, bufferSize, false);
+#else
+    LE_WARN("Shared memory messaging is not supported on this system.");
+    return NULL;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a shared memory region received from a client into the server's address space.
+ *
+ * @return A pointer to the region, or NULL if the region is not acceptable.
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgShm_Attach
+(
+    int     fd,             ///< [IN] File descriptor received from the client.
+    size_t  payloadSize     ///< [IN] Maximum payload size of the session's protocol.
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if HAVE_MEMFD
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+    {
+        LE_ERROR("fstat() failed. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    // The client must not be able to shrink the region while it is mapped, or the server would
+    // crash with SIGBUS.
+    int seals = fcntl(fd, F_GET_SEALS);
+    if ((seals < 0) || !(seals & F_SEAL_SHRINK))
+    {
+        LE_ERROR("Shared memory from client is not sealed.");
+        return NULL;
+    }
+
+    if ((st.st_size < (off_t)sizeof(RegionHeader_t)) || (st.st_size > MAX_REGION_SIZE))
+    {
+        LE_ERROR("Shared memory from client has bad size (%lld bytes).", (long long)st.st_size);
+        return NULL;
+    }
+
+    size_t mapSize = st.st_size;
+    void* mapPtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("mmap() failed. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    // Take copies of the header values before checking them, so they can't change afterwards.
+    RegionHeader_t* headerPtr = mapPtr;
+    uint32_t magic = headerPtr->magic;
+    uint32_t numBuffers = headerPtr->numBuffers;
+    uint32_t bufferSize = headerPtr->bufferSize;
+
+    if (   (magic != REGION_MAGIC)
+        || (numBuffers == 0)
+        || (numBuffers > 2 * MAX_BUFFERS)
+        || (numBuffers % 2 != 0)
+        || (bufferSize < payloadSize)
+        || (bufferSize % BUFFER_ALIGN != 0)
+        || (BuffersOffset(numBuffers) + (size_t)numBuffers * bufferSize > mapSize))
+    {
+        LE_ERROR("Shared memory from client has bad header.");
+        munmap(mapPtr, mapSize);
+        return NULL;
+    }
+
+    return NewRegion(mapPtr, mapSize, numBuffers, bufferSize, true);
+#else
+    LE_ERROR("Shared memory messaging is not supported on this system.");
+    return NULL;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a free buffer from the calling side's half of the region.
+ *
+ * @return The buffer index, or -1 if all of them are in use.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t msgShm_AllocBuffer
+(
+    msgShm_Region_t* regionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t start = __atomic_load_n(&regionPtr->nextBuffer, __ATOMIC_RELAXED);
+    uint32_t i;
+
+    for (i = 0; i < regionPtr->numOwnBuffers; i++)
+    {
+        uint32_t ownIdx = (start + i) % regionPtr->numOwnBuffers;
+        uint32_t bufferIdx = regionPtr->firstOwnBuffer + ownIdx;
+        uint32_t expected = BUFFER_FREE;
+
+        // Acquire, so that the other side is done with the previous contents of the buffer
+        // before we start writing to it.
+        if (__atomic_compare_exchange_n(&regionPtr->headerPtr->state[bufferIdx],
+                                        &expected,
+                                        BUFFER_IN_USE,
+                                        false,
+                                        __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(&regionPtr->nextBuffer,
+                             (ownIdx + 1) % regionPtr->numOwnBuffers,
+                             __ATOMIC_RELAXED);
+            return bufferIdx;
+        }
+    }
+
+    return -1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Return a buffer to the side of the region that owns it.  May be called by either side.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_FreeBuffer
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(bufferIdx < regionPtr->numBuffers);
+
+    __atomic_store_n(&regionPtr->headerPtr->state[bufferIdx], BUFFER_FREE, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a buffer index received in a doorbell refers to a buffer in use.
+ *
+ * @return true if the buffer can be handed to a received message.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_IsBufferInUse
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (bufferIdx < regionPtr->numBuffers)
+            && (__atomic_load_n(&regionPtr->headerPtr->state[bufferIdx], __ATOMIC_ACQUIRE)
+                == BUFFER_IN_USE));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to a buffer's payload.
+ *
+ * @return The pointer.
+ */
+//--------------------------------------------------------------------------------------------------
+void* msgShm_GetBufferPtr
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(bufferIdx < regionPtr->numBuffers);
+
+    return regionPtr->buffersPtr + (size_t)bufferIdx * regionPtr->bufferSize;
+}
@@ -0,0 +1,168 @@
+/** @file messagingShm.h
+ *
+ * @ref c_messaging implementation's "Shared Memory" module's inter-module interface definitions.
+ *
+ * See @ref messagingShm.c for an overview of the shared memory transport.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
+#define LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value sent in place of the transaction ID at the start of a control message.
+ *
+ * Transaction IDs are Safe References, which are always odd, so this even value can never be
+ * mistaken for one.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_CONTROL_MARKER   ((void*)(uintptr_t)0x53484D30)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of control messages.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    MSGSHM_CONTROL_SETUP = 1,   ///< Client to server: shared memory fd is attached.
+    MSGSHM_CONTROL_DOORBELL,    ///< A message payload is waiting in a shared memory buffer.
+}
+msgShm_ControlType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Control message sent over a session's socket for sessions using the shared memory transport.
+ *
+ * This is received into a normal Message object, with the marker landing in the transaction ID
+ * and the rest in the payload.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*       marker;     ///< Always MSGSHM_CONTROL_MARKER.
+    uint32_t    type;       ///< Control message type (msgShm_ControlType_t).
+    uint32_t    bufferIdx;  ///< Doorbell: index of the buffer holding the message payload.
+    void*       txnId;      ///< Doorbell: transaction ID of the message.
+}
+msgShm_ControlMsg_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Smallest protocol payload size for which the shared memory transport can be used.  Control
+ * messages have to fit into a normal Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_MIN_PAYLOAD_SIZE (sizeof(msgShm_ControlMsg_t) - sizeof(void*))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A process's mapping of a session's shared memory region.  Reference counted: the session holds
+ * one reference and every message with a payload in the region holds another.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct msgShm_Region msgShm_Region_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a shared memory region for the client side of a session.
+ *
+ * @return A pointer to the region, or NULL if failed (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgShm_Create
+(
+    size_t  numBuffers,     ///< [IN] Number of payload buffers for each direction.
+    size_t  payloadSize,    ///< [IN] Maximum payload size of the session's protocol.
+    int*    fdPtr           ///< [OUT] File descriptor to pass to the server.  The caller must
+                            ///        close it.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a shared memory region received from a client into the server's address space.
+ *
+ * @return A pointer to the region, or NULL if the region is not acceptable.
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_Region_t* msgShm_Attach
+(
+    int     fd,             ///< [IN] File descriptor received from the client.
+    size_t  payloadSize     ///< [IN] Maximum payload size of the session's protocol.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a free buffer from the calling side's half of the region.
+ *
+ * @return The buffer index, or -1 if all of them are in use.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t msgShm_AllocBuffer
+(
+    msgShm_Region_t* regionPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Return a buffer to the side of the region that owns it.  May be called by either side.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_FreeBuffer
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a buffer index received in a doorbell refers to a buffer in use.
+ *
+ * @return true if the buffer can be handed to a received message.
+ */
+//--------------------------------------------------------------------------------------------------
+bool msgShm_IsBufferInUse
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to a buffer's payload.
+ *
+ * @return The pointer.
+ */
+//--------------------------------------------------------------------------------------------------
+void* msgShm_GetBufferPtr
+(
+    msgShm_Region_t*    regionPtr,
+    uint32_t            bufferIdx
+);
+
+
+#endif // LEGATO_MESSAGING_SHM_H_INCLUDE_GUARD
@@ -0,0 +1,446 @@
+//--------------------------------------------------------------------------------------------------
+/** @file stats.c
+ *
+ * Runtime statistics page.
+ *
+ * The page is created once at start-up, in a memfd that stays open and mapped for the life of the
+ * process, so that legato-top can find it through /proc/<pid>/fd.  Slots are claimed and freed
+ * with compare-and-swap on their state, so no lock is needed by the modules that update them.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "stats.h"
+#include "fileDescriptor.h"
+
+#if LE_CONFIG_RUNTIME_STATS
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// memfd_create() and file sealing are needed.  Older C libraries don't have a wrapper for
+// memfd_create(), so make the system call directly.
+#if defined(__NR_memfd_create) && defined(F_ADD_SEALS)
+#   define HAVE_MEMFD 1
+#else
+#   define HAVE_MEMFD 0
+#endif
+
+#ifndef MFD_CLOEXEC
+#   define MFD_CLOEXEC          0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#   define MFD_ALLOW_SEALING    0x0002U
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Alignment of the sections in the page, so that slots don't share cache lines across sections.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SECTION_ALIGN   64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Round a size up to a multiple of a power of 2.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ALIGN_UP(size, align)   (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This process's statistics page, or NULL if it couldn't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Header_t* stats_PagePtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a slot of a section.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void* GetSlot
+(
+    const statsPage_Section_t*  sectionPtr, ///< [IN] The section.
+    uint32_t                    index       ///< [IN] Index of the slot.
+)
+{
+    return (uint8_t*)stats_PagePtr + sectionPtr->offset + (size_t)index * sectionPtr->slotSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims a free slot of a section.  Its state is left STATSPAGE_SLOT_CLAIMED, and everything after
+ * its state is zeroed.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ClaimSlot
+(
+    const statsPage_Section_t*  sectionPtr  ///< [IN] The section.
+)
+{
+    uint32_t i;
+
+    if (stats_PagePtr == NULL)
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < sectionPtr->count; i++)
+    {
+        uint32_t* statePtr = GetSlot(sectionPtr, i);
+        uint32_t state = STATSPAGE_SLOT_FREE;
+
+        if ((__atomic_load_n(statePtr, __ATOMIC_RELAXED) == STATSPAGE_SLOT_FREE) &&
+            __atomic_compare_exchange_n(statePtr, &state, STATSPAGE_SLOT_CLAIMED, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            memset(statePtr + 1, 0, sectionPtr->slotSize - sizeof(*statePtr));
+            return statePtr;
+        }
+    }
+
+    stats_Add(&stats_PagePtr->slotsExhausted, 1);
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lays out a section of the page.
+ *
+ * @return Offset of the end of the section.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t LayOutSection
+(
+    statsPage_Section_t*    sectionPtr, ///< [OUT] The section.
+    uint32_t                offset,     ///< [IN] Offset of the end of the previous section.
+    uint32_t                count,      ///< [IN] Number of slots.
+    uint32_t                slotSize    ///< [IN] Size of a slot.
+)
+{
+    sectionPtr->offset = ALIGN_UP(offset, SECTION_ALIGN);
+    sectionPtr->count = count;
+    sectionPtr->slotSize = slotSize;
+
+    return sectionPtr->offset + count * slotSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops a child process that was forked without exec from writing to its parent's page.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopInChild
+(
+    void
+)
+{
+    stats_PagePtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates this process's statistics page.  On failure, an error is logged and statistics are not
+ * kept.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_Init
+(
+    void
+)
+{
+#if HAVE_MEMFD
+    statsPage_Header_t layout;
+
+    memset(&layout, 0, sizeof(layout));
+
+    uint32_t size = sizeof(layout);
+    size = LayOutSection(&layout.pools, size, LE_CONFIG_RUNTIME_STATS_MAX_POOLS,
+                         sizeof(statsPage_Pool_t));
+    size = LayOutSection(&layout.threads, size, LE_CONFIG_RUNTIME_STATS_MAX_THREADS,
+                         sizeof(statsPage_Thread_t));
+    size = LayOutSection(&layout.sessions, size, LE_CONFIG_RUNTIME_STATS_MAX_SESSIONS,
+                         sizeof(statsPage_Session_t));
+    size = LayOutSection(&layout.handlers, size, LE_CONFIG_RUNTIME_STATS_MAX_HANDLERS,
+                         sizeof(statsPage_Handler_t));
+    size = ALIGN_UP(size, (uint32_t)sysconf(_SC_PAGESIZE));
+
+    // legato-top looks for this name in /proc/<pid>/fd.
+    int fd = syscall(__NR_memfd_create, STATSPAGE_MEMFD_NAME, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        LE_ERROR("memfd_create() failed. Errno = %d (%m).", errno);
+        return;
+    }
+
+    if (ftruncate(fd, size) != 0)
+    {
+        LE_ERROR("ftruncate() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return;
+    }
+
+    // Stop the size from changing under the readers' feet.
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        LE_ERROR("Failed to seal statistics page. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return;
+    }
+
+    void* mapPtr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("mmap() failed. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return;
+    }
+
+    // A new memfd is zero-filled, so all the counters start at 0 and all the slots are free.
+    // The file descriptor is deliberately left open, for readers to find.
+    memcpy(layout.magic, STATSPAGE_MAGIC, sizeof(layout.magic));
+    layout.version = STATSPAGE_VERSION;
+    layout.pageSize = size;
+    layout.pid = getpid();
+    memcpy(mapPtr, &layout, sizeof(layout));
+
+    LE_ASSERT(pthread_atfork(NULL, NULL, StopInChild) == 0);
+
+    stats_PagePtr = mapPtr;
+#else
+    LE_ERROR("Runtime statistics need memfd_create() and file sealing.");
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the monotonic time, in nanoseconds, for latency measurements.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_GetTimeNs
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims a memory pool slot.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Pool_t* stats_AddPool
+(
+    const char* namePtr,    ///< [IN] Name of the pool.
+    size_t      objSize     ///< [IN] Size of the objects in the pool.
+)
+{
+    statsPage_Pool_t* slotPtr = ClaimSlot(&stats_PagePtr->pools);
+
+    if (slotPtr != NULL)
+    {
+        le_utf8_Copy(slotPtr->name, namePtr, sizeof(slotPtr->name), NULL);
+        slotPtr->objSize = objSize;
+        __atomic_store_n(&slotPtr->state, STATSPAGE_SLOT_IN_USE, __ATOMIC_RELEASE);
+    }
+
+    return slotPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims a thread slot.  The slot is not shown until stats_StartThread() is called.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Thread_t* stats_AddThread
+(
+    void
+)
+{
+    return ClaimSlot(&stats_PagePtr->threads);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Names a thread slot after the calling thread and shows it.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_StartThread
+(
+    statsPage_Thread_t* slotPtr     ///< [IN] The slot.  Can be NULL.
+)
+{
+    if (slotPtr != NULL)
+    {
+        le_utf8_Copy(slotPtr->name, le_thread_GetMyName(), sizeof(slotPtr->name), NULL);
+        slotPtr->tid = syscall(SYS_gettid);
+        __atomic_store_n(&slotPtr->state, STATSPAGE_SLOT_IN_USE, __ATOMIC_RELEASE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims an IPC session slot.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Session_t* stats_AddSession
+(
+    const char* interfaceNamePtr,   ///< [IN] Name of the session's interface.
+    bool        isServer            ///< [IN] true if this is the server end of the session.
+)
+{
+    statsPage_Session_t* slotPtr = ClaimSlot(&stats_PagePtr->sessions);
+
+    if (slotPtr != NULL)
+    {
+        le_utf8_Copy(slotPtr->name, interfaceNamePtr, sizeof(slotPtr->name), NULL);
+        slotPtr->isServer = isServer;
+        __atomic_store_n(&slotPtr->state, STATSPAGE_SLOT_IN_USE, __ATOMIC_RELEASE);
+    }
+
+    return slotPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Frees a memory pool, thread or IPC session slot.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_FreeSlot
+(
+    void*   slotPtr     ///< [IN] The slot.  Can be NULL.
+)
+{
+    if (slotPtr != NULL)
+    {
+        __atomic_store_n((uint32_t*)slotPtr, STATSPAGE_SLOT_FREE, __ATOMIC_RELEASE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the slot of an event handler function, claiming one if it doesn't have one yet.
+ *
+ * The handler table is open-addressed, with linear probing from the hash of the function's
+ * address.  Slots are never freed, so a probe can stop at the first free slot.
+ *
+ * @return The slot, or NULL if there is no page or the handler table is full.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Handler_t* stats_GetHandler
+(
+    const void* funcPtr,    ///< [IN] Address of the handler function.
+    const char* namePtr     ///< [IN] Name of the handler, or NULL if it has none.
+)
+{
+    if (stats_PagePtr == NULL)
+    {
+        return NULL;
+    }
+
+    const statsPage_Section_t* sectionPtr = &stats_PagePtr->handlers;
+    uint64_t func = (uintptr_t)funcPtr;
+    uint32_t index = (uint32_t)(((func >> 2) * 0x9E3779B97F4A7C15ULL) >> 32) % sectionPtr->count;
+    uint32_t i;
+
+    for (i = 0; i < sectionPtr->count; i++)
+    {
+        statsPage_Handler_t* slotPtr = GetSlot(sectionPtr, index);
+        uint64_t slotFunc = __atomic_load_n(&slotPtr->func, __ATOMIC_ACQUIRE);
+
+        if (slotFunc == func)
+        {
+            return slotPtr;
+        }
+
+        if ((slotFunc == 0) &&
+            __atomic_compare_exchange_n(&slotPtr->func, &slotFunc, func, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            if (namePtr != NULL)
+            {
+                le_utf8_Copy(slotPtr->name, namePtr, sizeof(slotPtr->name), NULL);
+            }
+            return slotPtr;
+        }
+
+        // Another thread may just have claimed this slot for the same function.
+        if (slotFunc == func)
+        {
+            return slotPtr;
+        }
+
+        index = (index + 1) % sectionPtr->count;
+    }
+
+    stats_Add(&stats_PagePtr->slotsExhausted, 1);
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a dispatch to an event handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_CountDispatch
+(
+    statsPage_Handler_t*    slotPtr,    ///< [IN] The handler's slot.  Can be NULL.
+    uint64_t                waitNs,     ///< [IN] Time from queuing to dispatch, in nanoseconds.
+    uint64_t                runNs       ///< [IN] Time spent in the handler, in nanoseconds.
+)
+{
+    if (slotPtr == NULL)
+    {
+        return;
+    }
+
+    uint64_t waitUs = waitNs / 1000;
+    uint32_t bucket = 0;
+
+    if (waitUs != 0)
+    {
+        bucket = 64 - __builtin_clzll(waitUs);
+        if (bucket >= STATSPAGE_HISTOGRAM_BUCKETS)
+        {
+            bucket = STATSPAGE_HISTOGRAM_BUCKETS - 1;
+        }
+    }
+
+    stats_Add(&slotPtr->count, 1);
+    stats_Add(&slotPtr->totalWaitNs, waitNs);
+    stats_Add(&slotPtr->totalRunNs, runNs);
+    stats_Max(&slotPtr->maxWaitNs, waitNs);
+    stats_Max(&slotPtr->maxRunNs, runNs);
+    __atomic_fetch_add(&slotPtr->waitHistogram[bucket], 1, __ATOMIC_RELAXED);
+}
+
+#endif // LE_CONFIG_RUNTIME_STATS
@@ -0,0 +1,185 @@
+/** @file statsPage.h
+ *
+ * Runtime statistics page definitions, shared by the statistics code in liblegato and the
+ * legato-top target tool.
+ *
+ * When runtime statistics are enabled, each process creates a memfd named STATSPAGE_MEMFD_NAME and
+ * keeps it open and mapped.  Other processes (legato-top) find it through /proc/<pid>/fd and map it
+ * read-only.  The process updates the page on its hot paths with relaxed atomic operations, and
+ * never takes a lock or makes a system call to do so.
+ *
+ * The memfd contains, in order:
+ *
+ *  - A header (statsPage_Header_t), holding process-wide counters and the location of each of the
+ *    sections below.
+ *  - The memory pool section, one statsPage_Pool_t per pool.
+ *  - The thread section, one statsPage_Thread_t per thread with an event loop.
+ *  - The IPC session section, one statsPage_Session_t per open session.
+ *  - The handler section, one statsPage_Handler_t per event handler function, found by hashing
+ *    the function's address.
+ *
+ * Pool, thread and session slots are claimed when the object is created and freed when it is
+ * deleted, so a reader can see a slot change owner between two reads.  Handler slots are never
+ * freed.  Values are counters that only increase, except where noted, so a reader computes rates
+ * from the difference between two samples.
+ *
+ * This file is also used by legato-top, so must not include legato.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_STATS_PAGE_H_INCLUDE_GUARD
+#define LEGATO_STATS_PAGE_H_INCLUDE_GUARD
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic string at the start of a page, its layout version, and the name of its memfd.  The link
+ * in /proc/<pid>/fd reads "/memfd:le_stats (deleted)".
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATSPAGE_MAGIC             "LESTATPG"
+#define STATSPAGE_VERSION           1
+#define STATSPAGE_MEMFD_NAME        "le_stats"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATSPAGE_NAME_BYTES        48      ///< Size of a name in a slot, including terminator.
+#define STATSPAGE_HISTOGRAM_BUCKETS 20      ///< Buckets in a latency histogram.
+#define STATSPAGE_MAX_PAGE_BYTES    (4 * 1024 * 1024)   ///< Largest page accepted by readers.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slot states.  A slot is written while CLAIMED, and only shown by readers when IN_USE.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATSPAGE_SLOT_FREE         0
+#define STATSPAGE_SLOT_CLAIMED      1
+#define STATSPAGE_SLOT_IN_USE       2
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Location of a section of slots in the page.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    offset;         ///< Offset of the first slot from the start of the page.
+    uint32_t    count;          ///< Number of slots.
+    uint32_t    slotSize;       ///< Size of each slot, in bytes.
+    uint32_t    reserved;
+}
+statsPage_Section_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Page header, at the start of the memfd.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char                magic[8];           ///< STATSPAGE_MAGIC, without terminator.
+    uint32_t            version;            ///< STATSPAGE_VERSION.
+    uint32_t            pageSize;           ///< Size of the memfd, in bytes.
+    int32_t             pid;                ///< Process ID of the writer.
+    uint32_t            reserved;
+
+    statsPage_Section_t pools;              ///< statsPage_Pool_t slots.
+    statsPage_Section_t threads;            ///< statsPage_Thread_t slots.
+    statsPage_Section_t sessions;           ///< statsPage_Session_t slots.
+    statsPage_Section_t handlers;           ///< statsPage_Handler_t slots.
+
+    uint64_t            ipcTxMsgs;          ///< IPC messages sent, on all sessions.
+    uint64_t            ipcRxMsgs;          ///< IPC messages received, on all sessions.
+    uint64_t            ipcTxBytes;         ///< Payload bytes sent, on all sessions.
+    uint64_t            ipcRxBytes;         ///< Payload bytes received, on all sessions.
+    uint64_t            timersCreated;      ///< Timers created.
+    uint64_t            timersDeleted;      ///< Timers deleted.
+    uint64_t            timerStarts;        ///< Timers started.
+    uint64_t            timerExpiries;      ///< Timer expiries.
+    uint64_t            eventsDispatched;   ///< Event reports dispatched, on all threads.
+    uint64_t            slotsExhausted;     ///< Objects left out of the page for lack of slots.
+}
+statsPage_Header_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pool slot.  The blocks in use include those held in thread caches.  The overflow and
+ * allocation counts go back to 0 when le_mem_ResetStats() is called.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    state;                      ///< STATSPAGE_SLOT_xxx.
+    uint32_t    objSize;                    ///< Size of the objects in the pool.
+    char        name[STATSPAGE_NAME_BYTES]; ///< Pool name.
+    uint64_t    totalBlocks;                ///< Blocks in the pool (can decrease).
+    uint64_t    inUse;                      ///< Blocks allocated (can decrease).
+    uint64_t    maxUsed;                    ///< Most blocks allocated at once.
+    uint64_t    overflows;                  ///< Times le_mem_ForceAlloc() expanded the pool.
+    uint64_t    allocs;                     ///< Allocations, not counting those served by
+                                            ///  thread caches since their last refill or spill.
+}
+statsPage_Pool_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread slot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    state;                      ///< STATSPAGE_SLOT_xxx.
+    int32_t     tid;                        ///< Kernel thread ID.
+    char        name[STATSPAGE_NAME_BYTES]; ///< Thread name.
+    uint64_t    queueDepth;                 ///< Reports in the event queue (can decrease).
+    uint64_t    queueHighWater;             ///< Most reports ever in the event queue.
+    uint64_t    dispatched;                 ///< Event reports dispatched.
+}
+statsPage_Thread_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * IPC session slot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    state;                      ///< STATSPAGE_SLOT_xxx.
+    uint32_t    isServer;                   ///< 1 for the server end of a session, 0 for a client.
+    char        name[STATSPAGE_NAME_BYTES]; ///< Interface name.
+    uint64_t    txMsgs;                     ///< Messages sent.
+    uint64_t    rxMsgs;                     ///< Messages received.
+    uint64_t    txBytes;                    ///< Payload bytes sent.
+    uint64_t    rxBytes;                    ///< Payload bytes received.
+}
+statsPage_Session_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler slot.  The handler is the function that the event loop dispatches to: a handler
+ * added with le_event_AddHandler() and friends, or a function queued with le_event_QueueFunction().
+ *
+ * Bucket 0 of the histogram counts waits under 1 microsecond and bucket n (n > 0) waits from
+ * 2^(n-1) to 2^n microseconds.  The last bucket also counts all longer waits.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    func;                       ///< Address of the function, 0 if the slot is free.
+    char        name[STATSPAGE_NAME_BYTES]; ///< Handler name, or "" if unknown.
+    uint64_t    count;                      ///< Dispatches.
+    uint64_t    totalWaitNs;                ///< Time from queuing to dispatch, in nanoseconds.
+    uint64_t    totalRunNs;                 ///< Time spent in the handler, in nanoseconds.
+    uint64_t    maxWaitNs;                  ///< Longest wait, in nanoseconds.
+    uint64_t    maxRunNs;                   ///< Longest run, in nanoseconds.
+    uint32_t    waitHistogram[STATSPAGE_HISTOGRAM_BUCKETS];  ///< Waits, in log2 microsecond
+                                                            ///  buckets.
+}
+statsPage_Handler_t;
+
+#endif // LEGATO_STATS_PAGE_H_INCLUDE_GUARD
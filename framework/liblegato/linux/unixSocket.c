@@ -15,6 +15,50 @@
 #define CMSG_BUFF_SIZE (CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(struct ucred)))
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ancillary data buffer, aligned for the cmsghdr structures stored in it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef union
+{
+    char            buff[CMSG_BUFF_SIZE];
+    struct cmsghdr  align;
+}
+CmsgBuff_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert the errno left by a failed send system call into a result code.
+ *
+ * @return The result code to report to the caller.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SendErrorResult
+(
+    const char* syscallName     ///< [IN] Name of the system call that failed, for logging.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (errno)
+    {
+        case EAGAIN:  // Same as EWOULDBLOCK
+            return LE_NO_MEMORY;
+
+        case ENOTCONN:
+        case ECONNRESET:
+        case EPIPE:
+            LE_WARN("%s() failed with errno %d (%m).", syscallName, errno);
+            return LE_COMM_ERROR;
+
+        default:
+            LE_ERROR("%s() failed with errno %d (%m).", syscallName, errno);
+            return LE_FAULT;
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Extract a file descriptor from an SCM_RIGHTS ancillary data message.
@@ -479,21 +523,7 @@ le_result_t unixSocket_SendMsg
 
     if (bytesSent < 0)
     {
-        switch (errno)
-        {
-            case EAGAIN:  // Same as EWOULDBLOCK
-                return LE_NO_MEMORY;
-
-            case ENOTCONN:
-            case ECONNRESET:
-            case EPIPE:
-                LE_WARN("sendmsg() failed with errno %d (%m).", errno);
-                return LE_COMM_ERROR;
-
-            default:
-                LE_ERROR("sendmsg() failed with errno %d (%m).", errno);
-                return LE_FAULT;
-        }
+        return SendErrorResult("sendmsg");
     }
 
     if (bytesSent < dataSize)
@@ -731,6 +761,228 @@ le_result_t unixSocket_ReceiveDataMsg
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages, each containing data and optionally a file descriptor, through a
+ * connected Unix domain datagram or sequenced-packet socket, using as few system calls as
+ * possible.
+ *
+ * Messages are sent in order.  If one can't be sent, none of the ones after it are sent.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - Otherwise, the unixSocket_SendMsg() result for the first message that wasn't sent.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendMsgBatch
+(
+    int localSocketFd,              ///< [IN] fd of the local socket that will be used to send.
+    unixSocket_MsgBuff_t* msgArray, ///< [IN] The messages to send.
+    size_t* countPtr                ///< [IN+OUT] Number of messages in the array (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct mmsghdr msgHeaders[UNIXSOCKET_MAX_BATCH_SIZE];
+    struct iovec ioVectors[UNIXSOCKET_MAX_BATCH_SIZE];
+    CmsgBuff_t cmsgBuffers[UNIXSOCKET_MAX_BATCH_SIZE];
+    size_t count = *countPtr;
+    size_t sent = 0;
+    size_t i;
+
+    LE_ASSERT(count <= UNIXSOCKET_MAX_BATCH_SIZE);
+
+    memset(msgHeaders, 0, count * sizeof(msgHeaders[0]));
+
+    for (i = 0; i < count; i++)
+    {
+        struct msghdr* msgHeaderPtr = &msgHeaders[i].msg_hdr;
+
+        ioVectors[i].iov_base = msgArray[i].dataPtr;
+        ioVectors[i].iov_len = msgArray[i].dataSize;
+        msgHeaderPtr->msg_iov = &ioVectors[i];
+        msgHeaderPtr->msg_iovlen = 1;
+
+        // Attach the file descriptor's "send rights to access an fd" control message, if any.
+        if (msgArray[i].fd >= 0)
+        {
+            msgHeaderPtr->msg_control = cmsgBuffers[i].buff;
+            msgHeaderPtr->msg_controllen = CMSG_SPACE(sizeof(int));
+
+            struct cmsghdr* cmsgHeaderPtr = CMSG_FIRSTHDR(msgHeaderPtr);
+            cmsgHeaderPtr->cmsg_level = SOL_SOCKET;
+            cmsgHeaderPtr->cmsg_type = SCM_RIGHTS;
+            cmsgHeaderPtr->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsgHeaderPtr), &msgArray[i].fd, sizeof(int));
+
+            msgHeaderPtr->msg_controllen = cmsgHeaderPtr->cmsg_len;
+
+            LE_DEBUG("Sending fd %d.", msgArray[i].fd);
+        }
+    }
+
+    // sendmmsg() stops early if a message can't be sent, so keep going until one fails.
+    while (sent < count)
+    {
+        int numSent;
+        do
+        {
+            numSent = sendmmsg(localSocketFd, &msgHeaders[sent], count - sent, 0);
+        }
+        while ((numSent < 0) && (errno == EINTR));
+
+        if (numSent < 0)
+        {
+            *countPtr = sent;
+            return SendErrorResult("sendmmsg");
+        }
+
+        for (i = sent; i < sent + numSent; i++)
+        {
+            if (msgHeaders[i].msg_len < msgArray[i].dataSize)
+            {
+                LE_ERROR("The last %zu data bytes (of %zu total) were discarded by sendmmsg()!",
+                         msgArray[i].dataSize - msgHeaders[i].msg_len,
+                         msgArray[i].dataSize);
+                *countPtr = i;
+                return LE_FAULT;
+            }
+        }
+
+        sent += numSent;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives whatever messages are waiting on a connected Unix domain datagram or sequenced-packet
+ * socket, up to the size of a batch, using one system call.  Credentials are not received.
+ *
+ * If the socket is blocking, this waits for at least one message.
+ *
+ * A message that couldn't be received whole (e.g., it was too big for its buffer) doesn't stop the
+ * batch: it is counted, with its result set to what unixSocket_ReceiveMsg() would have returned
+ * for it and any file descriptor that came with it closed, and the messages after it are received
+ * as usual.
+ *
+ * @return
+ * - LE_OK if at least one message was received, whole or not.  If the connection closed after it,
+ *   the next call reports that.
+ * - Otherwise, the unixSocket_ReceiveMsg() result: LE_WOULD_BLOCK, LE_CLOSED or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,              ///< [IN] fd of local socket that will be used to receive.
+    unixSocket_MsgBuff_t* msgArray, ///< [IN+OUT] Buffers to receive the messages into.
+    size_t* countPtr                ///< [IN+OUT] Number of buffers in the array (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct mmsghdr msgHeaders[UNIXSOCKET_MAX_BATCH_SIZE];
+    struct iovec ioVectors[UNIXSOCKET_MAX_BATCH_SIZE];
+    CmsgBuff_t cmsgBuffers[UNIXSOCKET_MAX_BATCH_SIZE];
+    size_t count = *countPtr;
+    size_t i;
+
+    LE_ASSERT(count <= UNIXSOCKET_MAX_BATCH_SIZE);
+
+    *countPtr = 0;
+
+    memset(msgHeaders, 0, count * sizeof(msgHeaders[0]));
+
+    for (i = 0; i < count; i++)
+    {
+        ioVectors[i].iov_base = msgArray[i].dataPtr;
+        ioVectors[i].iov_len = msgArray[i].dataSize;
+        msgHeaders[i].msg_hdr.msg_iov = &ioVectors[i];
+        msgHeaders[i].msg_hdr.msg_iovlen = 1;
+        msgHeaders[i].msg_hdr.msg_control = cmsgBuffers[i].buff;
+        msgHeaders[i].msg_hdr.msg_controllen = sizeof(cmsgBuffers[i].buff);
+
+        msgArray[i].dataSize = 0;
+        msgArray[i].fd = -1;
+    }
+
+    // Keep trying to receive until we don't get interrupted by a signal.
+    int numReceived;
+    do
+    {
+        numReceived = recvmmsg(localSocketFd, msgHeaders, count, 0, NULL);
+    }
+    while ((numReceived < 0) && (errno == EINTR));
+
+    // If we failed, process the error and return.
+    if (numReceived < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            return LE_WOULD_BLOCK;
+        }
+        else if (errno == ECONNRESET)
+        {
+            return LE_CLOSED;
+        }
+        else
+        {
+            LE_ERROR("recvmmsg() failed with errno %d (%m).", errno);
+            return LE_FAULT;
+        }
+    }
+
+    for (i = 0; i < (size_t)numReceived; i++)
+    {
+        struct msghdr* msgHeaderPtr = &msgHeaders[i].msg_hdr;
+        le_result_t result = LE_OK;
+
+        if (msgHeaderPtr->msg_controllen > 0)
+        {
+            ExtractAncillaryData(msgHeaderPtr, &msgArray[i].fd, NULL);
+        }
+
+        // Apply the same checks as unixSocket_ReceiveMsg().
+        if ((msgHeaderPtr->msg_flags & MSG_CTRUNC) != 0)
+        {
+            LE_WARN("Ancillary data was discarded because it couldn't fit in our buffer.");
+            if (msgHeaders[i].msg_len == 0)
+            {
+                result = LE_FAULT;
+            }
+        }
+        else if ((msgHeaderPtr->msg_controllen == 0) && (msgHeaders[i].msg_len == 0))
+        {
+            // The connection closed.  This is not a message, and nothing can follow it.
+            break;
+        }
+
+        if ((result == LE_OK) && ((msgHeaderPtr->msg_flags & MSG_TRUNC) != 0))
+        {
+            result = LE_NO_MEMORY;
+        }
+
+        msgArray[i].dataSize = msgHeaders[i].msg_len;
+        msgArray[i].result = result;
+
+        // A message that wasn't received whole is dropped by the caller, so don't leak its fd.
+        if ((result != LE_OK) && (msgArray[i].fd >= 0))
+        {
+            fd_Close(msgArray[i].fd);
+            msgArray[i].fd = -1;
+        }
+    }
+
+    *countPtr = i;
+
+    return (*countPtr > 0) ? LE_OK : LE_CLOSED;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
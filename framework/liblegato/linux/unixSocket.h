@@ -518,6 +518,85 @@ le_result_t unixSocket_ReceiveDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages that can be passed to unixSocket_SendMsgBatch() or
+ * unixSocket_ReceiveMsgBatch() in one call.
+ */
+//--------------------------------------------------------------------------------------------------
+#define UNIXSOCKET_MAX_BATCH_SIZE   64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One message of a batch sent or received through a Unix domain sequenced-packet or datagram
+ * socket.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*   dataPtr;    ///< Data payload to be sent, or buffer to receive the data payload into.
+    size_t  dataSize;   ///< Sending: number of bytes to send.  Receiving: number of bytes that
+                        ///  can fit in the buffer, updated to the number of bytes received.
+    int     fd;         ///< Sending: file descriptor to send (-1 if none).  Receiving: file
+                        ///  descriptor received (-1 if none).
+    le_result_t result; ///< Receiving: LE_OK if the message was received whole, otherwise the
+                        ///  unixSocket_ReceiveMsg() result for it.  Not used for sending.
+}
+unixSocket_MsgBuff_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages, each containing data and optionally a file descriptor, through a
+ * connected Unix domain datagram or sequenced-packet socket, using as few system calls as
+ * possible.
+ *
+ * Messages are sent in order.  If one can't be sent, none of the ones after it are sent.
+ *
+ * @return
+ * - LE_OK if all the messages were sent.
+ * - Otherwise, the unixSocket_SendMsg() result for the first message that wasn't sent.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendMsgBatch
+(
+    int localSocketFd,              ///< [IN] fd of the local socket that will be used to send.
+    unixSocket_MsgBuff_t* msgArray, ///< [IN] The messages to send.
+    size_t* countPtr                ///< [IN+OUT] Number of messages in the array (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages sent.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives whatever messages are waiting on a connected Unix domain datagram or sequenced-packet
+ * socket, up to the size of a batch, using one system call.  Credentials are not received.
+ *
+ * If the socket is blocking, this waits for at least one message.
+ *
+ * A message that couldn't be received whole (e.g., it was too big for its buffer) doesn't stop the
+ * batch: it is counted, with its result set to what unixSocket_ReceiveMsg() would have returned
+ * for it and any file descriptor that came with it closed, and the messages after it are received
+ * as usual.
+ *
+ * @return
+ * - LE_OK if at least one message was received, whole or not.  If the connection closed after it,
+ *   the next call reports that.
+ * - Otherwise, the unixSocket_ReceiveMsg() result: LE_WOULD_BLOCK, LE_CLOSED or LE_FAULT.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,              ///< [IN] fd of local socket that will be used to receive.
+    unixSocket_MsgBuff_t* msgArray, ///< [IN+OUT] Buffers to receive the messages into.
+    size_t* countPtr                ///< [IN+OUT] Number of buffers in the array (at most
+                                    ///     UNIXSOCKET_MAX_BATCH_SIZE).  Updated to the number of
+                                    ///     messages received.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
@@ -30,6 +30,19 @@
  * delete a sub-pool while there are still blocks allocated from it.  The sub-pool itself is then
  * removed from the list of pools and released back into the pool of sub-pools.
  *
+ * THREAD CACHES
+ * =============
+ *
+ * When the @ref MEM_THREAD_CACHE KConfig option is enabled, le_mem_EnableThreadCache() can be used
+ * to give a pool a "magazine" of free blocks per thread.  A thread's cache for a pool is only ever
+ * touched by that thread, so allocations and releases that can be satisfied from the cache do
+ * not take the mutex.  When a cache runs empty, it is refilled with a batch of blocks popped from
+ * the pool's free list, and when it fills up, a batch of blocks is spilled back onto the free
+ * list; both are done with the mutex held.  From the point of view of the pool, blocks sitting
+ * in thread caches are "in use", so le_mem_GetStats() subtracts them back out by walking the
+ * pool's list of thread caches.  A thread's caches are flushed back into their pools when the
+ * thread exits.
+ *
  * GUARD BANDS
  * ===========
  *
@@ -44,6 +57,7 @@
  */
 #include "legato.h"
 #include "mem.h"
+#include "stats.h"
 
 #define GUARD_WORD ((uint32_t)0xDEADBEEF)
 #define GUARD_BAND_SIZE (sizeof(GUARD_WORD) * LE_CONFIG_NUM_GUARD_BAND_WORDS)
@@ -158,6 +172,58 @@ static le_mem_PoolRef_t SubPoolsPool;
 static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+//--------------------------------------------------------------------------------------------------
+/**
+ * A thread's cache of free blocks for one pool.
+ *
+ * The blocks array and the counters are only written by the owning thread.  Other threads read
+ * numBlocks and numAllocs (with relaxed atomic loads, while holding the mutex) to compute pool
+ * statistics.  The cacheLink and numAllocsFolded members are protected by the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t       cacheLink;          ///< Link in the pool's list of thread caches.
+    le_mem_PoolRef_t    poolPtr;            ///< Pool that the cached blocks belong to.
+    size_t              numBlocks;          ///< Number of blocks currently in the cache.
+    size_t              numAllocs;          ///< Number of allocations served from this cache.
+    size_t              numAllocsFolded;    ///< Value of numAllocs last added to the pool's stats.
+    MemBlock_t*         blocks[];           ///< Cached blocks (room for 2 * threadCacheSize).
+}
+ThreadCache_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-thread table of thread caches, indexed by the pools' threadCacheSlot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    ThreadCache_t* cachePtr[LE_CONFIG_MEM_THREAD_CACHE_MAX_POOLS];
+}
+ThreadCacheTable_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread-local data key used to find the calling thread's table of thread caches.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t ThreadCacheKey;
+static pthread_once_t ThreadCacheKeyOnce = PTHREAD_ONCE_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of thread cache slots handed out to pools so far.  Protected by the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t NumThreadCacheSlots = 0;
+#endif /* end LE_CONFIG_MEM_THREAD_CACHE */
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Exposing the memory pool list; mainly for the Inspect tool.
@@ -220,6 +286,35 @@ void mem_Unlock
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a pool's statistics into its slot in the runtime statistics page, if it has one.
+ *
+ * @note Assumes that the mutex is locked, or that the pool isn't shared with other threads yet.
+ */
+//--------------------------------------------------------------------------------------------------
+#if LE_CONFIG_RUNTIME_STATS
+static void PublishStats
+(
+    le_mem_PoolRef_t    pool    ///< [IN] The pool.
+)
+{
+    statsPage_Pool_t* slotPtr = pool->statsPtr;
+
+    if (slotPtr != NULL)
+    {
+        stats_Set(&slotPtr->totalBlocks, pool->totalBlocks);
+        stats_Set(&slotPtr->inUse, pool->numBlocksInUse);
+        stats_Set(&slotPtr->maxUsed, pool->maxNumBlocksUsed);
+        stats_Set(&slotPtr->overflows, pool->numOverflows);
+        stats_Set(&slotPtr->allocs, pool->numAllocations);
+    }
+}
+#else
+#   define PublishStats(pool)   ((void)0)
+#endif
+
+
 #if LE_CONFIG_USE_GUARD_BAND
 
     //----------------------------------------------------------------------------------------------
@@ -377,6 +472,10 @@ static void InitPool
 
     pool->poolLink = LE_DLS_LINK_INIT;
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    pool->threadCacheList = LE_DLS_LIST_INIT;
+#endif
+
 #if LE_CONFIG_MEM_TRACE
     pool->memTrace = NULL;
 
@@ -386,6 +485,10 @@ static void InitPool
         LE_DEBUG("Tracing enabled for pool '%s'.", pool->name);
     }
 #endif
+
+#if LE_CONFIG_RUNTIME_STATS
+    pool->statsPtr = stats_AddPool(MEMPOOL_NAME(pool->name), objSize);
+#endif
 }
 
 #if LE_CONFIG_MEM_POOLS
@@ -611,6 +714,314 @@ static void InitBlock
 #endif
 
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Adds the allocations served by a thread cache since the last call to the pool's statistics.
+     *
+     * @note Assumes that the mutex is locked.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void FoldThreadCacheAllocs
+    (
+        ThreadCache_t* cachePtr     ///< [IN] The thread cache.
+    )
+    {
+        size_t numAllocs = __atomic_load_n(&cachePtr->numAllocs, __ATOMIC_RELAXED);
+
+#   if LE_CONFIG_MEM_POOL_STATS
+        cachePtr->poolPtr->numAllocations += (numAllocs - cachePtr->numAllocsFolded);
+#   endif
+        cachePtr->numAllocsFolded = numAllocs;
+
+        PublishStats(cachePtr->poolPtr);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Moves a number of blocks from the bottom of a thread cache back onto its pool's free list.
+     *
+     * The blocks at the bottom of the cache are the ones least recently released, so the most
+     * recently used (and most likely to be in the CPU cache) blocks stay in the thread cache.
+     *
+     * @note Must only be called by the thread that owns the cache.  Locks the mutex.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void SpillThreadCache
+    (
+        ThreadCache_t*  cachePtr,   ///< [IN] The thread cache.
+        size_t          numBlocks   ///< [IN] Number of blocks to spill.
+    )
+    {
+        le_mem_PoolRef_t pool = cachePtr->poolPtr;
+        size_t i;
+
+        mem_Lock();
+
+        for (i = 0; i < numBlocks; i++)
+        {
+            MemBlock_t* blockPtr = cachePtr->blocks[i];
+
+            blockPtr->data[0].link = LE_SLS_LINK_INIT;
+            le_sls_Stack(&(pool->freeList), &(blockPtr->data[0].link));
+        }
+
+        pool->numBlocksInUse -= numBlocks;
+
+        memmove(cachePtr->blocks,
+                cachePtr->blocks + numBlocks,
+                (cachePtr->numBlocks - numBlocks) * sizeof(cachePtr->blocks[0]));
+        __atomic_store_n(&cachePtr->numBlocks, cachePtr->numBlocks - numBlocks, __ATOMIC_RELAXED);
+
+        FoldThreadCacheAllocs(cachePtr);
+
+        mem_Unlock();
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Refills an empty thread cache with up to a batch of blocks from its pool's free list.
+     *
+     * @note Must only be called by the thread that owns the cache.  Locks the mutex.
+     *
+     * @return The number of blocks now in the cache (0 if the pool's free list was empty).
+     */
+    //----------------------------------------------------------------------------------------------
+    static size_t RefillThreadCache
+    (
+        ThreadCache_t*  cachePtr    ///< [IN] The (empty) thread cache.
+    )
+    {
+        le_mem_PoolRef_t pool = cachePtr->poolPtr;
+        size_t numBlocks = 0;
+        le_sls_Link_t* blockLinkPtr;
+
+        mem_Lock();
+
+        while ((numBlocks < pool->threadCacheSize) &&
+               ((blockLinkPtr = le_sls_Pop(&(pool->freeList))) != NULL))
+        {
+            cachePtr->blocks[numBlocks++] = CONTAINER_OF(blockLinkPtr, MemBlock_t, data[0].link);
+        }
+
+        pool->numBlocksInUse += numBlocks;
+
+#   if LE_CONFIG_MEM_POOL_STATS
+        if (pool->numBlocksInUse > pool->maxNumBlocksUsed)
+        {
+            pool->maxNumBlocksUsed = pool->numBlocksInUse;
+        }
+#   endif
+
+        __atomic_store_n(&cachePtr->numBlocks, numBlocks, __ATOMIC_RELAXED);
+
+        FoldThreadCacheAllocs(cachePtr);
+
+        mem_Unlock();
+
+        return numBlocks;
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Flushes all of a thread's caches back into their pools.  Called automatically when a thread
+     * that has used a thread cache exits.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void FlushThreadCaches
+    (
+        void* tablePtr      ///< [IN] The exiting thread's table of thread caches.
+    )
+    {
+        ThreadCacheTable_t* cacheTablePtr = tablePtr;
+        size_t i;
+
+        for (i = 0; i < LE_CONFIG_MEM_THREAD_CACHE_MAX_POOLS; i++)
+        {
+            ThreadCache_t* cachePtr = cacheTablePtr->cachePtr[i];
+
+            if (cachePtr != NULL)
+            {
+                SpillThreadCache(cachePtr, cachePtr->numBlocks);
+
+                mem_Lock();
+                le_dls_Remove(&(cachePtr->poolPtr->threadCacheList), &(cachePtr->cacheLink));
+                mem_Unlock();
+
+                free(cachePtr);
+            }
+        }
+
+        free(cacheTablePtr);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Creates the thread-local data key used to find a thread's table of thread caches.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void CreateThreadCacheKey
+    (
+        void
+    )
+    {
+        LE_ASSERT(pthread_key_create(&ThreadCacheKey, FlushThreadCaches) == 0);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets the calling thread's cache for a pool, creating it if necessary.
+     *
+     * @return Pointer to the thread cache.
+     */
+    //----------------------------------------------------------------------------------------------
+    static ThreadCache_t* GetThreadCache
+    (
+        le_mem_PoolRef_t    pool    ///< [IN] Pool with thread caching enabled.
+    )
+    {
+        ThreadCacheTable_t* cacheTablePtr = pthread_getspecific(ThreadCacheKey);
+
+        if (cacheTablePtr == NULL)
+        {
+            cacheTablePtr = calloc(1, sizeof(ThreadCacheTable_t));
+            LE_ASSERT(cacheTablePtr);
+            LE_ASSERT(pthread_setspecific(ThreadCacheKey, cacheTablePtr) == 0);
+        }
+
+        ThreadCache_t* cachePtr = cacheTablePtr->cachePtr[pool->threadCacheSlot];
+
+        if (cachePtr == NULL)
+        {
+            cachePtr = calloc(1, sizeof(ThreadCache_t) +
+                                 (2 * pool->threadCacheSize * sizeof(cachePtr->blocks[0])));
+            LE_ASSERT(cachePtr);
+
+            cachePtr->cacheLink = LE_DLS_LINK_INIT;
+            cachePtr->poolPtr = pool;
+
+            mem_Lock();
+            le_dls_Queue(&(pool->threadCacheList), &(cachePtr->cacheLink));
+            mem_Unlock();
+
+            cacheTablePtr->cachePtr[pool->threadCacheSlot] = cachePtr;
+        }
+
+        return cachePtr;
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Allocates a block from the calling thread's cache for a pool, refilling the cache from the
+     * pool's free list if it is empty.
+     *
+     * @return Pointer to the block, or NULL if the pool has no free blocks.
+     */
+    //----------------------------------------------------------------------------------------------
+    static MemBlock_t* ThreadCacheAlloc
+    (
+        le_mem_PoolRef_t    pool    ///< [IN] Pool with thread caching enabled.
+    )
+    {
+        ThreadCache_t* cachePtr = GetThreadCache(pool);
+        size_t numBlocks = cachePtr->numBlocks;
+
+        if ((numBlocks == 0) && ((numBlocks = RefillThreadCache(cachePtr)) == 0))
+        {
+            return NULL;
+        }
+
+        numBlocks--;
+        MemBlock_t* blockPtr = cachePtr->blocks[numBlocks];
+
+        __atomic_store_n(&cachePtr->numBlocks, numBlocks, __ATOMIC_RELAXED);
+        __atomic_store_n(&cachePtr->numAllocs, cachePtr->numAllocs + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&blockPtr->refCount, 1, __ATOMIC_RELAXED);
+
+        return blockPtr;
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Releases a reference to a block from a pool with thread caching enabled.  If the reference
+     * count reaches zero, the object is destructed and the block is put into the calling thread's
+     * cache, spilling a batch of blocks back to the pool first if the cache is full.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void ThreadCacheRelease
+    (
+        void*       objPtr,     ///< [IN] Pointer to the object being released.
+        MemBlock_t* blockPtr    ///< [IN] Block containing the object.
+    )
+    {
+        le_mem_PoolRef_t pool = blockPtr->poolPtr;
+        size_t refCount = __atomic_fetch_sub(&blockPtr->refCount, 1, __ATOMIC_ACQ_REL);
+
+        if (refCount > 1)
+        {
+            return;
+        }
+
+        if (refCount == 0)
+        {
+            LE_EMERG("Releasing free block.");
+            LE_FATAL("Free block released from pool %p (%s).", pool, MEMPOOL_NAME(pool->name));
+        }
+
+        if (pool->destructor)
+        {
+            pool->destructor(objPtr);
+        }
+
+        ThreadCache_t* cachePtr = GetThreadCache(pool);
+
+        if (cachePtr->numBlocks >= (2 * pool->threadCacheSize))
+        {
+            SpillThreadCache(cachePtr, pool->threadCacheSize);
+        }
+
+        cachePtr->blocks[cachePtr->numBlocks] = blockPtr;
+        __atomic_store_n(&cachePtr->numBlocks, cachePtr->numBlocks + 1, __ATOMIC_RELAXED);
+    }
+
+
+    //----------------------------------------------------------------------------------------------
+    /**
+     * Gets the number of free blocks sitting in a pool's thread caches and the number of
+     * allocations they have served that have not yet been added to the pool's statistics.
+     *
+     * @note Assumes that the mutex is locked.
+     */
+    //----------------------------------------------------------------------------------------------
+    static void GetThreadCacheCounts
+    (
+        le_mem_PoolRef_t    pool,               ///< [IN] The pool.
+        size_t*             numCachedPtr,       ///< [OUT] Number of blocks in thread caches.
+        size_t*             numAllocsPtr        ///< [OUT] Number of allocations not yet folded.
+    )
+    {
+        ThreadCache_t* cachePtr;
+
+        *numCachedPtr = 0;
+        *numAllocsPtr = 0;
+
+        LE_DLS_FOREACH(&(pool->threadCacheList), cachePtr, ThreadCache_t, cacheLink)
+        {
+            *numCachedPtr += __atomic_load_n(&cachePtr->numBlocks, __ATOMIC_RELAXED);
+            *numAllocsPtr += __atomic_load_n(&cachePtr->numAllocs, __ATOMIC_RELAXED) -
+                             cachePtr->numAllocsFolded;
+        }
+    }
+#endif /* end LE_CONFIG_MEM_THREAD_CACHE */
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Log an error message if there is another pool with the same name as a given pool.
@@ -669,6 +1080,12 @@ void SubPoolDestructor
                 "More blocks returned to pool (%" PRIuS ") than present in pool (%" PRIuS ")",
                 blocksFreed, subPool->superPoolPtr->numBlocksInUse);
     subPool->superPoolPtr->numBlocksInUse -= blocksFreed;
+    PublishStats(subPool->superPoolPtr);
+#endif
+
+#if LE_CONFIG_RUNTIME_STATS
+    stats_FreeSlot(subPool->statsPtr);
+    subPool->statsPtr = NULL;
 #endif
 
     // Remove the sub-pool from the list of sub-pools.
@@ -891,6 +1308,7 @@ le_mem_PoolRef_t _le_mem_InitStaticPool
 
     // Update the pool.
     poolPtr->totalBlocks += numBlocks;
+    PublishStats(poolPtr);
 #endif
 
     return poolPtr;
@@ -953,12 +1371,16 @@ static le_mem_PoolRef_t ExpandPool_NoLock
             pool->superPoolPtr->maxNumBlocksUsed = pool->superPoolPtr->numBlocksInUse;
         }
 #   endif /* end LE_CONFIG_MEM_POOL_STATS */
+
+        PublishStats(pool->superPoolPtr);
     }
     else
     {
         // This is not a sub-pool.
         AddBlocks(pool, numObjects);
     }
+
+    PublishStats(pool);
 #endif /* end LE_CONFIG_MEM_POOLS */
 
     return pool;
@@ -1014,6 +1436,26 @@ void* le_mem_TryAlloc
     MemBlock_t* blockPtr = NULL;
     void* userPtr = NULL;
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    if (pool->threadCacheSize != 0)
+    {
+        // Fast path: take a block from this thread's cache without locking.
+        blockPtr = ThreadCacheAlloc(pool);
+
+        if (blockPtr != NULL)
+        {
+#   if LE_CONFIG_USE_GUARD_BAND
+            InitGuardBands(blockPtr);
+            userPtr = &blockPtr->data[0].item + GUARD_BAND_SIZE;
+#   else
+            userPtr = blockPtr->data;
+#   endif
+        }
+
+        return userPtr;
+    }
+#endif
+
     mem_Lock();
 
 #if LE_CONFIG_MEM_POOLS
@@ -1046,6 +1488,7 @@ void* le_mem_TryAlloc
         pool->maxNumBlocksUsed = pool->numBlocksInUse;
     }
 #endif
+        PublishStats(pool);
 
         blockPtr->refCount = 1;
 
@@ -1120,6 +1563,7 @@ void* le_mem_ForceAlloc
 #    if LE_CONFIG_MEM_POOL_STATS
         pool->numOverflows++;
 #    endif
+        PublishStats(pool);
 
             // log a warning.
 #   if !LE_CONFIG_LINUX
@@ -1285,6 +1729,52 @@ void le_mem_SetNumObjsToForce
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables a per-thread cache of free objects for a pool.
+ *
+ * @return
+ *      Nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mem_EnableThreadCache
+(
+    le_mem_PoolRef_t    pool,       ///< [IN] Pool to enable the thread cache for.
+    size_t              numObjects  ///< [IN] Number of objects moved to or from a thread's cache
+                                    ///       at once.
+)
+{
+    LE_ASSERT(pool != NULL);
+
+#if LE_CONFIG_MEM_THREAD_CACHE
+    LE_ASSERT(numObjects > 0);
+
+    LE_ASSERT(pthread_once(&ThreadCacheKeyOnce, CreateThreadCacheKey) == 0);
+
+    mem_Lock();
+
+    LE_FATAL_IF(pool->superPoolPtr != NULL,
+                "Thread cache can't be enabled for sub-pool '%s'.", MEMPOOL_NAME(pool->name));
+    LE_FATAL_IF(pool->threadCacheSize != 0,
+                "Thread cache already enabled for pool '%s'.", MEMPOOL_NAME(pool->name));
+    LE_FATAL_IF(pool->numBlocksInUse != 0,
+                "Thread cache enabled for pool '%s' while %" PRIuS " blocks are allocated.",
+                MEMPOOL_NAME(pool->name),
+                pool->numBlocksInUse);
+    LE_FATAL_IF(NumThreadCacheSlots >= LE_CONFIG_MEM_THREAD_CACHE_MAX_POOLS,
+                "Too many pools with thread caches (max %d).",
+                LE_CONFIG_MEM_THREAD_CACHE_MAX_POOLS);
+
+    pool->threadCacheSlot = NumThreadCacheSlots++;
+    pool->threadCacheSize = numObjects;
+
+    mem_Unlock();
+#else
+    (void)numObjects;
+#endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Releases an object.  If the object's reference count has reached zero, it will be destructed
@@ -1320,6 +1810,14 @@ void le_mem_Release
     CheckGuardBands(blockPtr);
 #endif
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    if (blockPtr->poolPtr->threadCacheSize != 0)
+    {
+        ThreadCacheRelease(objPtr, blockPtr);
+        return;
+    }
+#endif
+
     mem_Lock();
 
     switch (blockPtr->refCount)
@@ -1359,6 +1857,7 @@ void le_mem_Release
 #endif
 
             poolPtr->numBlocksInUse--;
+            PublishStats(poolPtr);
 
             break;
         }
@@ -1402,6 +1901,16 @@ void le_mem_AddRef
     CheckGuardBands(memBlockPtr);
 #endif
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    if (memBlockPtr->poolPtr->threadCacheSize != 0)
+    {
+        // Blocks from thread-cached pools are released without the mutex, so their reference
+        // counts must always be updated atomically.
+        LE_ASSERT(__atomic_fetch_add(&memBlockPtr->refCount, 1, __ATOMIC_RELAXED) != 0);
+        return;
+    }
+#endif
+
     mem_Lock();
 
     LE_ASSERT(memBlockPtr->refCount != 0);
@@ -1476,19 +1985,28 @@ void le_mem_GetStats
 {
     LE_ASSERT( (pool != NULL) && (statsPtr != NULL) );
 
+    size_t numCached = 0;
+    size_t numCachedAllocs = 0;
+
     mem_Lock();
 
+#if LE_CONFIG_MEM_THREAD_CACHE
+    // Blocks sitting in thread caches are counted as in use by the pool, but are really free.
+    GetThreadCacheCounts(pool, &numCached, &numCachedAllocs);
+#endif
+
 #if LE_CONFIG_MEM_POOL_STATS
-    statsPtr->numAllocs = pool->numAllocations;
+    statsPtr->numAllocs = pool->numAllocations + numCachedAllocs;
     statsPtr->numOverflows = pool->numOverflows;
     statsPtr->maxNumBlocksUsed = pool->maxNumBlocksUsed;
 #else
     statsPtr->numAllocs = 0;
     statsPtr->numOverflows = 0;
     statsPtr->maxNumBlocksUsed = 0;
+    (void)numCachedAllocs;
 #endif
-    statsPtr->numFree = pool->totalBlocks - pool->numBlocksInUse;
-    statsPtr->numBlocksInUse = pool->numBlocksInUse;
+    statsPtr->numFree = pool->totalBlocks - pool->numBlocksInUse + numCached;
+    statsPtr->numBlocksInUse = pool->numBlocksInUse - numCached;
 
     mem_Unlock();
 }
@@ -1513,6 +2031,18 @@ void le_mem_ResetStats
     mem_Lock();
     pool->numAllocations = 0;
     pool->numOverflows = 0;
+
+#   if LE_CONFIG_MEM_THREAD_CACHE
+    // Discard the allocations counted by thread caches but not yet added to the pool.
+    ThreadCache_t* cachePtr;
+    LE_DLS_FOREACH(&(pool->threadCacheList), cachePtr, ThreadCache_t, cacheLink)
+    {
+        cachePtr->numAllocsFolded = __atomic_load_n(&cachePtr->numAllocs, __ATOMIC_RELAXED);
+    }
+#   endif
+
+    PublishStats(pool);
+
     mem_Unlock();
 #endif
 }
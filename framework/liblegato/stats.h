@@ -0,0 +1,218 @@
+//--------------------------------------------------------------------------------------------------
+/** @file stats.h
+ *
+ * Runtime statistics inter-module include file.
+ *
+ * When LE_CONFIG_RUNTIME_STATS is enabled, the framework modules count what they do in this
+ * process's statistics page (see statsPage.h).  Updates are relaxed atomic operations on the
+ * mapped page and are skipped if the page couldn't be created.  When it is disabled, the
+ * STATS_xxx() macros compile to nothing.
+ *
+ * This file exposes interfaces that are for use by other modules inside the framework
+ * implementation, but must not be used outside of the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SRC_STATS_INCLUDE_GUARD
+#define LEGATO_SRC_STATS_INCLUDE_GUARD
+
+#if LE_CONFIG_RUNTIME_STATS
+
+#include "statsPage.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This process's statistics page, or NULL if it couldn't be created.
+ *
+ * @note Only to be used through the functions and macros below.
+ */
+//--------------------------------------------------------------------------------------------------
+extern statsPage_Header_t* stats_PagePtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a counter in the statistics page.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void stats_Add
+(
+    uint64_t*   counterPtr, ///< [IN] The counter.
+    uint64_t    value       ///< [IN] Amount to add.
+)
+{
+    __atomic_fetch_add(counterPtr, value, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets a value in the statistics page.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void stats_Set
+(
+    uint64_t*   valuePtr,   ///< [IN] The value.
+    uint64_t    value       ///< [IN] New value.
+)
+{
+    __atomic_store_n(valuePtr, value, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Raises a maximum in the statistics page, if a value is greater than it.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void stats_Max
+(
+    uint64_t*   maxPtr,     ///< [IN] The maximum.
+    uint64_t    value       ///< [IN] Value to compare with it.
+)
+{
+    uint64_t oldMax = __atomic_load_n(maxPtr, __ATOMIC_RELAXED);
+
+    while ((value > oldMax) &&
+           !__atomic_compare_exchange_n(maxPtr, &oldMax, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to one of the process-wide counters in the header of the statistics page.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATS_ADD(field, value)                                 \
+    do {                                                        \
+        if (stats_PagePtr != NULL)                              \
+        {                                                       \
+            stats_Add(&stats_PagePtr->field, (value));          \
+        }                                                       \
+    } while (0)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates this process's statistics page.  On failure, an error is logged and statistics are not
+ * kept.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the monotonic time, in nanoseconds, for latency measurements.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_GetTimeNs
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims a memory pool slot.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Pool_t* stats_AddPool
+(
+    const char* namePtr,    ///< [IN] Name of the pool.
+    size_t      objSize     ///< [IN] Size of the objects in the pool.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims a thread slot.  The slot is not shown until stats_StartThread() is called.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Thread_t* stats_AddThread
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Names a thread slot after the calling thread and shows it.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_StartThread
+(
+    statsPage_Thread_t* slotPtr     ///< [IN] The slot.  Can be NULL.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Claims an IPC session slot.
+ *
+ * @return The slot, or NULL if there is no page or no free slot.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Session_t* stats_AddSession
+(
+    const char* interfaceNamePtr,   ///< [IN] Name of the session's interface.
+    bool        isServer            ///< [IN] true if this is the server end of the session.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Frees a memory pool, thread or IPC session slot.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_FreeSlot
+(
+    void*   slotPtr     ///< [IN] The slot.  Can be NULL.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the slot of an event handler function, claiming one if it doesn't have one yet.
+ *
+ * @return The slot, or NULL if there is no page or the handler table is full.
+ */
+//--------------------------------------------------------------------------------------------------
+statsPage_Handler_t* stats_GetHandler
+(
+    const void* funcPtr,    ///< [IN] Address of the handler function.
+    const char* namePtr     ///< [IN] Name of the handler, or NULL if it has none.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts a dispatch to an event handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_CountDispatch
+(
+    statsPage_Handler_t*    slotPtr,    ///< [IN] The handler's slot.  Can be NULL.
+    uint64_t                waitNs,     ///< [IN] Time from queuing to dispatch, in nanoseconds.
+    uint64_t                runNs       ///< [IN] Time spent in the handler, in nanoseconds.
+);
+
+#else // !LE_CONFIG_RUNTIME_STATS
+
+#define STATS_ADD(field, value)     ((void)0)
+
+#endif // LE_CONFIG_RUNTIME_STATS
+
+#endif // LEGATO_SRC_STATS_INCLUDE_GUARD
@@ -10,6 +10,7 @@
 #include "clock.h"
 #include "thread.h"
 #include "timer.h"
+#include "stats.h"
 
 /// Statically allocated timer pool
 LE_MEM_DEFINE_STATIC_POOL(TimerPool, LE_CONFIG_MAX_TIMER_POOL_SIZE, sizeof(Timer_t));
@@ -119,19 +120,180 @@ static Timer_t* CreateTimer
 }
 
 
+#if LE_CONFIG_TIMER_HEAP
 //--------------------------------------------------------------------------------------------------
 /**
- * Add the timer record to the given list, sorted according to the timer value
+ * Check if a timer should expire before another one in the timer heap.  Timers with the same
+ * expiry time expire in the order they were started, as they would on a sorted list.
+ *
+ * @return true if timerAPtr should expire before timerBPtr.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool HeapLessThan
+(
+    Timer_t* timerAPtr,                 ///< [IN] First timer.
+    Timer_t* timerBPtr                  ///< [IN] Second timer.
+)
+{
+    if (le_clk_Equal(timerAPtr->expiryTime, timerBPtr->expiryTime))
+    {
+        return timerAPtr->heapSeq < timerBPtr->heapSeq;
+    }
+
+    return le_clk_GreaterThan(timerBPtr->expiryTime, timerAPtr->expiryTime);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Meld two timer heaps into one.
+ *
+ * @return The root of the melded heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* HeapMeld
+(
+    Timer_t* heapAPtr,                  ///< [IN] Root of the first heap (may be NULL).
+    Timer_t* heapBPtr                   ///< [IN] Root of the second heap (may be NULL).
+)
+{
+    if (heapAPtr == NULL)
+    {
+        return heapBPtr;
+    }
+    if (heapBPtr == NULL)
+    {
+        return heapAPtr;
+    }
+
+    if (HeapLessThan(heapBPtr, heapAPtr))
+    {
+        Timer_t* tempPtr = heapAPtr;
+        heapAPtr = heapBPtr;
+        heapBPtr = tempPtr;
+    }
+
+    // Make heap B the first child of heap A.
+    heapBPtr->heapPrevPtr = heapAPtr;
+    heapBPtr->heapNextPtr = heapAPtr->heapChildPtr;
+    if (heapAPtr->heapChildPtr != NULL)
+    {
+        heapAPtr->heapChildPtr->heapPrevPtr = heapBPtr;
+    }
+    heapAPtr->heapChildPtr = heapBPtr;
+
+    heapAPtr->heapPrevPtr = NULL;
+    heapAPtr->heapNextPtr = NULL;
+
+    return heapAPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Meld a list of sibling heaps into a single heap, using the standard two-pass pairing.
+ *
+ * @return The root of the melded heap, or NULL if the list was empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* HeapMergePairs
+(
+    Timer_t* firstPtr                   ///< [IN] First heap on the sibling list.
+)
+{
+    Timer_t* pairListPtr = NULL;
+
+    // First pass: meld siblings in pairs from left to right, pushing the results onto a list
+    // (linked through heapNextPtr) in reverse order.
+    while (firstPtr != NULL)
+    {
+        Timer_t* secondPtr = firstPtr->heapNextPtr;
+        Timer_t* restPtr = (secondPtr != NULL) ? secondPtr->heapNextPtr : NULL;
+
+        firstPtr->heapNextPtr = NULL;
+        if (secondPtr != NULL)
+        {
+            secondPtr->heapNextPtr = NULL;
+        }
+
+        Timer_t* pairPtr = HeapMeld(firstPtr, secondPtr);
+        pairPtr->heapNextPtr = pairListPtr;
+        pairListPtr = pairPtr;
+
+        firstPtr = restPtr;
+    }
+
+    // Second pass: meld the pairs from right to left into a single heap.
+    Timer_t* rootPtr = NULL;
+    while (pairListPtr != NULL)
+    {
+        Timer_t* nextPtr = pairListPtr->heapNextPtr;
+
+        pairListPtr->heapNextPtr = NULL;
+        rootPtr = HeapMeld(rootPtr, pairListPtr);
+
+        pairListPtr = nextPtr;
+    }
+
+    return rootPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a timer from a timer heap.
+ *
+ * @return The new root of the heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* HeapRemove
+(
+    Timer_t* rootPtr,                   ///< [IN] Root of the heap.
+    Timer_t* timerPtr                   ///< [IN] Timer to remove.
+)
+{
+    Timer_t* subHeapPtr = HeapMergePairs(timerPtr->heapChildPtr);
+
+    if (timerPtr != rootPtr)
+    {
+        // Unlink the timer (and its sub-heap) from its parent or left sibling.
+        if (timerPtr->heapPrevPtr->heapChildPtr == timerPtr)
+        {
+            timerPtr->heapPrevPtr->heapChildPtr = timerPtr->heapNextPtr;
+        }
+        else
+        {
+            timerPtr->heapPrevPtr->heapNextPtr = timerPtr->heapNextPtr;
+        }
+        if (timerPtr->heapNextPtr != NULL)
+        {
+            timerPtr->heapNextPtr->heapPrevPtr = timerPtr->heapPrevPtr;
+        }
+
+        subHeapPtr = HeapMeld(rootPtr, subHeapPtr);
+    }
+
+    timerPtr->heapChildPtr = NULL;
+    timerPtr->heapNextPtr = NULL;
+    timerPtr->heapPrevPtr = NULL;
+
+    return subHeapPtr;
+}
+#endif /* end LE_CONFIG_TIMER_HEAP */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the timer record to the thread's active timers, ordered according to the timer value
  */
 //--------------------------------------------------------------------------------------------------
 static void AddToTimerList
 (
-    le_dls_List_t* listPtr,               ///< [IN] The list to add to.
+    timer_ThreadRec_t* threadRecPtr,      ///< [IN] The thread's timer record.
     Timer_t* newTimerPtr                  ///< [IN] The timer to add
 )
 {
-    Timer_t* timerPtr;
-    le_dls_Link_t* linkPtr;
+    le_dls_List_t* listPtr = &threadRecPtr->activeTimerList;
 
     if ( newTimerPtr->isActive )
     {
@@ -139,6 +301,21 @@ static void AddToTimerList
         return;
     }
 
+    TimerListChangeCount++;
+
+#if LE_CONFIG_TIMER_HEAP
+    // The heap keeps the timers ordered; the list just tracks which timers are running.
+    le_dls_Queue(listPtr, &newTimerPtr->link);
+
+    newTimerPtr->heapSeq = threadRecPtr->nextHeapSeq++;
+    newTimerPtr->heapChildPtr = NULL;
+    newTimerPtr->heapNextPtr = NULL;
+    newTimerPtr->heapPrevPtr = NULL;
+    threadRecPtr->heapRootPtr = HeapMeld(threadRecPtr->heapRootPtr, newTimerPtr);
+#else
+    Timer_t* timerPtr;
+    le_dls_Link_t* linkPtr;
+
     // Get the start of the list
     linkPtr = le_dls_Peek(listPtr);
 
@@ -155,7 +332,6 @@ static void AddToTimerList
         linkPtr = le_dls_PeekNext(listPtr, linkPtr);
     }
 
-    TimerListChangeCount++;
     if (linkPtr == NULL)
     {
         // The list is either empty, or the new timer has the largest expiry time.
@@ -167,6 +343,7 @@ static void AddToTimerList
         // Found a timer with larger expiry time; insert the new timer before it.
         le_dls_AddBefore(listPtr, linkPtr, &newTimerPtr->link);
     }
+#endif
 
     // The new timer is now on the active list
     newTimerPtr->isActive = true;
@@ -175,76 +352,77 @@ static void AddToTimerList
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Peek at the first timer from the given timer list
+ * Peek at the first timer to expire from the thread's active timers
  *
  * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ *      - pointer to the first timer to expire
+ *      - NULL if there are no active timers
  */
 //--------------------------------------------------------------------------------------------------
 static Timer_t* PeekFromTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
 )
 {
+#if LE_CONFIG_TIMER_HEAP
+    return threadRecPtr->heapRootPtr;
+#else
     le_dls_Link_t* linkPtr;
 
-    linkPtr = le_dls_Peek(listPtr);
+    linkPtr = le_dls_Peek(&threadRecPtr->activeTimerList);
     if (linkPtr != NULL)
     {
         return ( CONTAINER_OF(linkPtr, Timer_t, link) );
     }
     return NULL;
+#endif
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pop the first timer from the given timer list
- *
- * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ * Remove the timer from the thread's active timers
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* PopFromTimerList
+static void RemoveFromTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    Timer_t* timerPtr                   ///< [IN] The timer to remove
 )
 {
-    le_dls_Link_t* linkPtr;
-    Timer_t* timerPtr;
-
-    linkPtr = le_dls_Pop(listPtr);
-    if (linkPtr != NULL)
-    {
-        TimerListChangeCount++;
-        timerPtr = CONTAINER_OF(linkPtr, Timer_t, link);
-
-        // The timer is no longer on the active list
-        timerPtr->isActive = false;
+    // Remove the timer from the active list
+    timerPtr->isActive = false;
+    TimerListChangeCount++;
+    le_dls_Remove(&threadRecPtr->activeTimerList, &timerPtr->link);
 
-        return timerPtr;
-    }
-    return NULL;
+#if LE_CONFIG_TIMER_HEAP
+    threadRecPtr->heapRootPtr = HeapRemove(threadRecPtr->heapRootPtr, timerPtr);
+#endif
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove the timer from the given timer list
+ * Pop the first timer to expire from the thread's active timers
+ *
+ * @return:
+ *      - pointer to the first timer to expire
+ *      - NULL if there are no active timers
  */
 //--------------------------------------------------------------------------------------------------
-static void RemoveFromTimerList
+static Timer_t* PopFromTimerList
 (
-    le_dls_List_t* listPtr,             ///< [IN] The list to look at.
-    Timer_t* timerPtr                   ///< [IN] The timer to remove
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
 )
 {
-    // Remove the timer from the active list
-    timerPtr->isActive = false;
-    TimerListChangeCount++;
-    le_dls_Remove(listPtr, &timerPtr->link);
+    Timer_t* timerPtr = PeekFromTimerList(threadRecPtr);
+
+    if (timerPtr != NULL)
+    {
+        RemoveFromTimerList(threadRecPtr, timerPtr);
+    }
+
+    return timerPtr;
 }
 
 
@@ -315,11 +493,11 @@ static void RunTimer
 
     Timer_t* firstTimerPtr;
 
-    AddToTimerList(&threadRecPtr->activeTimerList, timerPtr);
+    AddToTimerList(threadRecPtr, timerPtr);
 
     // Get the first timer from the active list. This is needed to determine whether the timer
     // needs to be restarted, in case the new timer was put at the beginning of the list.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
 
     // If the timer is not running, or it is running a timer that is no longer at the beginning
     // of the active list, then (re)start the timer.
@@ -344,7 +522,7 @@ static void StopTimer
 {
     timer_ThreadRec_t* threadRecPtr = fa_timer_GetThreadTimerRec(timerPtr);
 
-    RemoveFromTimerList(&threadRecPtr->activeTimerList, timerPtr);
+    RemoveFromTimerList(threadRecPtr, timerPtr);
 
     // If the timer was at the start of the active list, then restart the timerFD using the next
     // timer on the active list, if any.  Otherwise, stop the timerFD.
@@ -353,7 +531,7 @@ static void StopTimer
         TRACE("Stopping the first active timer");
         threadRecPtr->firstTimerPtr = NULL;
 
-        Timer_t* firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+        Timer_t* firstTimerPtr = PeekFromTimerList(threadRecPtr);
         if (firstTimerPtr != NULL)
         {
             RestartTimerPhys(firstTimerPtr);
@@ -382,6 +560,7 @@ static void ProcessExpiredTimer
 
     // Keep track of the number of times the timer has expired, regardless of whether it repeats.
     expiredTimer->expiryCount++;
+    STATS_ADD(timerExpiries, 1);
 
     // Handle repeating timers by adding it back to the list; do this before calling the expiry
     // handler to reduce jitter.
@@ -399,7 +578,7 @@ static void ProcessExpiredTimer
         expiredTimer->expiryTime = le_clk_Add(expiredTimer->expiryTime, expiredTimer->interval);
 
         // Add the timer back to the timer list
-        AddToTimerList(&threadRecPtr->activeTimerList, expiredTimer);
+        AddToTimerList(threadRecPtr, expiredTimer);
         //PrintTimerList(&threadRecPtr->activeTimerList);
     }
 
@@ -446,7 +625,7 @@ void timer_Handler
     Timer_t* firstTimerPtr;
 
     // Pop off the first timer from the active list, and make sure it is the expected timer.
-    firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PopFromTimerList(threadRecPtr);
     LE_ASSERT( NULL != firstTimerPtr);
 
     LE_ASSERT( threadRecPtr->firstTimerPtr == firstTimerPtr );
@@ -461,17 +640,17 @@ void timer_Handler
 
     // Check if there are any other timers that have since expired, pop them off the
     // list and process them.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
     while ( firstTimerPtr != NULL &&
             le_clk_GreaterThan(clk_GetRelativeTime(firstTimerPtr->isWakeupEnabled),
                                firstTimerPtr->expiryTime) )
     {
         // Pop off the timer and process it
-        firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PopFromTimerList(threadRecPtr);
         ProcessExpiredTimer(firstTimerPtr);
 
         // Try the next timer on the list
-        firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PeekFromTimerList(threadRecPtr);
     }
 
     // While processing expired timers in the above loop, it is possible that a timer was started,
@@ -556,6 +735,10 @@ timer_ThreadRec_t* timer_InitThread
 
     threadRecPtr->activeTimerList = LE_DLS_LIST_INIT;
     threadRecPtr->firstTimerPtr = NULL;
+#if LE_CONFIG_TIMER_HEAP
+    threadRecPtr->heapRootPtr = NULL;
+    threadRecPtr->nextHeapSeq = 0;
+#endif
 
     return threadRecPtr;
 }
@@ -608,6 +791,9 @@ void timer_DestructThread
 
             le_mem_Release(timerPtr);
         }
+#if LE_CONFIG_TIMER_HEAP
+        threadRecPtr->heapRootPtr = NULL;
+#endif
         fa_timer_DestructThread(threadRecPtr);
     }
 }
@@ -641,6 +827,7 @@ le_timer_Ref_t _le_timer_Create
 #else
     newTimerPtr = CreateTimer();
 #endif
+    STATS_ADD(timersCreated, 1);
 
     return newTimerPtr->safeRef;
 }
@@ -671,6 +858,8 @@ void le_timer_Delete
     le_ref_DeleteRef(SafeRefMap, timerRef);
     le_mem_Release(timerPtr);
     Unlock();
+
+    STATS_ADD(timersDeleted, 1);
 }
 
 
@@ -1099,6 +1288,7 @@ le_result_t le_timer_Start
     timerPtr->expiryTime = le_clk_Add(clk_GetRelativeTime(timerPtr->isWakeupEnabled),
                                       timerPtr->interval);
     RunTimer(timerPtr);
+    STATS_ADD(timerStarts, 1);
 
     return LE_OK;
 }
@@ -46,7 +46,7 @@ timer_Type_t;
  * Timer object.  Created by le_timer_Create().
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct
+typedef struct Timer
 {
     // Settable attributes
 #if LE_CONFIG_TIMER_NAMES_ENABLED
@@ -65,6 +65,13 @@ typedef struct
     le_timer_Ref_t safeRef;                  ///< For the API user to refer to this timer by
     bool isWakeupEnabled;                    ///< Will system be woken up from suspended timer.
                                              ///  Default behaviour will be set to true.
+#if LE_CONFIG_TIMER_HEAP
+    struct Timer* heapChildPtr;              ///< First child in the timer heap.
+    struct Timer* heapNextPtr;               ///< Next sibling in the timer heap.
+    struct Timer* heapPrevPtr;               ///< Previous sibling, or parent if this is the
+                                             ///  first child, in the timer heap.
+    uint64_t heapSeq;                        ///< Insertion order, to break expiry time ties.
+#endif
 }
 Timer_t;
 
@@ -83,6 +90,12 @@ Timer_t;
 typedef struct
 {
     le_dls_List_t activeTimerList;      ///< Linked list of running legato timers for this thread
+                                        ///  (not sorted if the timer heap is enabled).
+#if LE_CONFIG_TIMER_HEAP
+    Timer_t* heapRootPtr;               ///< Root of the heap of running timers, ordered by
+                                        ///  expiry time.  NULL if no timers are running.
+    uint64_t nextHeapSeq;               ///< Insertion order to assign to the next timer.
+#endif
     Timer_t* firstTimerPtr;             ///< Pointer to the timer on the active list that is
                                         ///  associated with the currently running timerFD,
                                         ///  or NULL if there are no timers on the active list.
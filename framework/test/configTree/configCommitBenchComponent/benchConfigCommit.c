@@ -0,0 +1,172 @@
+/**
+ * This module benchmarks committing small changes to a large configuration tree.
+ *
+ * Usage: benchConfigCommit [-n <node count>] [-c <commit count>]
+ *
+ * A tree of node count integer values is created in the app's own tree, in groups of 100 under
+ * /bench.  Then write transactions that each change one value, or ten values, are committed one
+ * after the other, and the number of commits per second is reported.  Every commit has to reach
+ * the filesystem before le_cfg_CommitTxn() returns, so this measures what a client that writes on
+ * every state change sees.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+#define DEFAULT_NODE_COUNT      20000
+#define DEFAULT_COMMIT_COUNT    500
+
+/// Number of values in each group under /bench.
+#define GROUP_SIZE              100
+
+static int NodeCount = DEFAULT_NODE_COUNT;
+static int CommitCount = DEFAULT_COMMIT_COUNT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Numbers of values changed by each commit.
+ */
+//--------------------------------------------------------------------------------------------------
+static const int DeltaSizes[] = { 1, 10 };
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of the i'th value, relative to /bench.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ValuePath
+(
+    char* pathPtr,
+    size_t pathSize,
+    int i
+)
+{
+    snprintf(pathPtr, pathSize, "g%d/n%d", i / GROUP_SIZE, i);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the tree in one transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateTree
+(
+    void
+)
+{
+    char path[64];
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn("/bench");
+    int i;
+
+    le_cfg_SetEmpty(iterRef, "");
+
+    for (i = 0; i < NodeCount; i++)
+    {
+        ValuePath(path, sizeof(path), i);
+        le_cfg_SetInt(iterRef, path, i);
+    }
+
+    le_cfg_CommitTxn(iterRef);
+
+    LE_TEST_INFO("created %d values in %.1f ms", NodeCount, ElapsedUsec(startTime) / 1000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commit transactions that each change a given number of values, spread over the tree.
+ *
+ * @return true if the values read back afterwards are the ones last written.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RunOne
+(
+    int deltaSize
+)
+{
+    char path[64];
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_cfg_IteratorRef_t iterRef;
+    int value = 0;
+    int i, j;
+
+    for (i = 0; i < CommitCount; i++)
+    {
+        iterRef = le_cfg_CreateWriteTxn("/bench");
+
+        for (j = 0; j < deltaSize; j++)
+        {
+            // Stepping by a prime scatters the changes over all of the groups.
+            ValuePath(path, sizeof(path), (value * 7919) % NodeCount);
+            le_cfg_SetInt(iterRef, path, -value);
+            value++;
+        }
+
+        le_cfg_CommitTxn(iterRef);
+    }
+
+    double usec = ElapsedUsec(startTime);
+
+    LE_TEST_INFO("%2d value(s) per commit, %d values: %8.1f commits/s, %8.1f us per commit",
+                 deltaSize,
+                 NodeCount,
+                 CommitCount * 1000000.0 / usec,
+                 usec / CommitCount);
+
+    // Read back the values changed by the last commit.
+    bool ok = true;
+
+    iterRef = le_cfg_CreateReadTxn("/bench");
+
+    for (j = value - deltaSize; j < value; j++)
+    {
+        ValuePath(path, sizeof(path), (j * 7919) % NodeCount);
+        ok = (le_cfg_GetInt(iterRef, path, 1) == -j) && ok;
+    }
+
+    le_cfg_CancelTxn(iterRef);
+
+    return ok;
+}
+
+COMPONENT_INIT
+{
+    size_t i;
+
+    le_arg_SetIntVar(&NodeCount, "n", "node-count");
+    le_arg_SetIntVar(&CommitCount, "c", "commit-count");
+    le_arg_Scan();
+
+    LE_ASSERT((NodeCount > 0) && (CommitCount > 0));
+
+    LE_TEST_PLAN((int)NUM_ARRAY_MEMBERS(DeltaSizes));
+
+    CreateTree();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(DeltaSizes); i++)
+    {
+        LE_TEST_OK(RunOne(DeltaSizes[i]), "%d value(s) per commit", DeltaSizes[i]);
+    }
+
+    le_cfg_QuickDeleteNode("/bench");
+
+    LE_TEST_EXIT;
+}
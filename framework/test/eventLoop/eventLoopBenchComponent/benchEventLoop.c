@@ -0,0 +1,371 @@
+/**
+ * This module benchmarks delivery of queued functions between threads through the Event Loop.
+ *
+ * Usage: benchEventLoop [-n <iterations>] [-t <producer threads>]
+ *
+ * Three tests are run, one after the other, from the main thread's Event Loop:
+ *
+ *  - Ping-pong: the main thread and an echo thread queue a function to each other, back and
+ *    forth, and the round-trip latency is reported.
+ *  - Fan-in: several producer threads queue functions to the main thread as fast as they can,
+ *    and the aggregate number of functions delivered per second is reported.
+ *  - Fairness: the main thread queues a large burst of functions to itself, the first of which
+ *    makes a pipe readable.  The number of queued functions still waiting to run when the main
+ *    thread handles the fd event is reported.
+ *
+ * Compare the results with the EVENT_COALESCE_WAKEUPS and EVENT_MAX_REPORTS_PER_WAKEUP KConfig
+ * options enabled and disabled.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_ITERATIONS      100000
+#define DEFAULT_PRODUCERS       4
+#define MAX_PRODUCERS           64
+
+static int Iterations = DEFAULT_ITERATIONS;
+static int NumProducers = DEFAULT_PRODUCERS;
+
+static le_thread_Ref_t MainThread;
+static le_thread_Ref_t EchoThread;
+static le_thread_Ref_t Producers[MAX_PRODUCERS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of queued functions the main thread is still waiting for in the current test.
+ */
+//--------------------------------------------------------------------------------------------------
+static int Remaining;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start time of the current test.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t StartTime;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore that the producer threads wait on so they all start at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t StartSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipe used by the fairness test, and the FD Monitor watching its read end.
+ */
+//--------------------------------------------------------------------------------------------------
+static int PipeFds[2];
+static le_fdMonitor_Ref_t PipeMonitor;
+
+
+static void StartFanIn(void);
+static void StartFairness(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of seconds elapsed since StartTime.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedSeconds
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    return elapsed.sec + elapsed.usec / 1000000.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main thread of the echo thread.  Just runs the Event Loop.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* EchoThreadMain
+(
+    void* contextPtr
+)
+{
+    le_sem_Post(StartSem);
+    le_event_RunLoop();
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued to the echo thread to make it exit when the ping-pong test is done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EchoThreadExit
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_thread_Exit(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ping-pong test, echo thread side: send the ball back to the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Ping(void* param1Ptr, void* param2Ptr);
+
+static void Pong
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_event_QueueFunctionToThread(MainThread, Ping, NULL, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ping-pong test, main thread side: send the ball to the echo thread until enough round trips
+ * have been made.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Ping
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    if (--Remaining > 0)
+    {
+        le_event_QueueFunctionToThread(EchoThread, Pong, NULL, NULL);
+        return;
+    }
+
+    double seconds = ElapsedSeconds();
+
+    LE_TEST_INFO("ping-pong: %d round trips, %.2f us per round trip",
+                 Iterations, seconds * 1000000.0 / Iterations);
+    LE_TEST_OK(true, "ping-pong completed");
+
+    le_event_QueueFunctionToThread(EchoThread, EchoThreadExit, NULL, NULL);
+    le_thread_Join(EchoThread, NULL);
+
+    StartFanIn();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the ping-pong test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPingPong
+(
+    void
+)
+{
+    EchoThread = le_thread_Create("echo", EchoThreadMain, NULL);
+    le_thread_SetJoinable(EchoThread);
+    le_thread_Start(EchoThread);
+    le_sem_Wait(StartSem);
+
+    Remaining = Iterations;
+    StartTime = le_clk_GetRelativeTime();
+    le_event_QueueFunctionToThread(EchoThread, Pong, NULL, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fan-in test, main thread side: count the delivered functions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FanInReceived
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    int i;
+
+    if (--Remaining > 0)
+    {
+        return;
+    }
+
+    double seconds = ElapsedSeconds();
+    int total = (Iterations / NumProducers) * NumProducers;
+
+    LE_TEST_INFO("fan-in: %d producer(s), %d functions, %12.0f functions per sec",
+                 NumProducers, total, total / seconds);
+    LE_TEST_OK(true, "fan-in completed");
+
+    for (i = 0; i < NumProducers; i++)
+    {
+        le_thread_Join(Producers[i], NULL);
+    }
+
+    StartFairness();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fan-in test, producer side: queue this producer's share of functions to the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* FanInProducer
+(
+    void* contextPtr
+)
+{
+    int i;
+
+    le_sem_Wait(StartSem);
+
+    for (i = 0; i < Iterations / NumProducers; i++)
+    {
+        le_event_QueueFunctionToThread(MainThread, FanInReceived, NULL, NULL);
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the fan-in test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartFanIn
+(
+    void
+)
+{
+    char name[32];
+    int i;
+
+    Remaining = (Iterations / NumProducers) * NumProducers;
+
+    for (i = 0; i < NumProducers; i++)
+    {
+        snprintf(name, sizeof(name), "producer%d", i);
+        Producers[i] = le_thread_Create(name, FanInProducer, NULL);
+        le_thread_SetJoinable(Producers[i]);
+        le_thread_Start(Producers[i]);
+    }
+
+    StartTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NumProducers; i++)
+    {
+        le_sem_Post(StartSem);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fairness test: count the delivered functions.  The test ends when both the functions and the
+ * fd event have been handled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FairnessReceived
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    if ((--Remaining == 0) && (PipeMonitor == NULL))
+    {
+        LE_TEST_EXIT;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fairness test: first function of the burst.  Makes the pipe readable.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FairnessWritePipe
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    StartTime = le_clk_GetRelativeTime();
+    LE_ASSERT(write(PipeFds[1], "x", 1) == 1);
+
+    FairnessReceived(param1Ptr, param2Ptr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fairness test: handle the pipe becoming readable.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FairnessPipeHandler
+(
+    int fd,
+    short events
+)
+{
+    char byte;
+
+    LE_ASSERT(read(fd, &byte, 1) == 1);
+
+    LE_TEST_INFO("fairness: fd event handled after %.2f ms with %d of %d queued functions "
+                 "still waiting",
+                 ElapsedSeconds() * 1000.0, Remaining, Iterations);
+    LE_TEST_OK(true, "fairness: fd event handled");
+
+    le_fdMonitor_Delete(PipeMonitor);
+    PipeMonitor = NULL;
+    close(PipeFds[0]);
+    close(PipeFds[1]);
+
+    if (Remaining == 0)
+    {
+        LE_TEST_EXIT;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the fairness test by queueing a burst of functions to the main thread.  The first one
+ * makes the pipe readable, while the rest of the burst is still waiting to be processed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartFairness
+(
+    void
+)
+{
+    int i;
+
+    LE_ASSERT(pipe(PipeFds) == 0);
+    PipeMonitor = le_fdMonitor_Create("benchPipe", PipeFds[0], FairnessPipeHandler, POLLIN);
+
+    Remaining = Iterations;
+
+    le_event_QueueFunction(FairnessWritePipe, NULL, NULL);
+    for (i = 1; i < Iterations; i++)
+    {
+        le_event_QueueFunction(FairnessReceived, NULL, NULL);
+    }
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&Iterations, "n", "iterations");
+    le_arg_SetIntVar(&NumProducers, "t", "threads");
+    le_arg_Scan();
+
+    LE_TEST_PLAN(3);
+
+    LE_FATAL_IF((NumProducers < 1) || (NumProducers > MAX_PRODUCERS),
+                "Producer count must be between 1 and %d", MAX_PRODUCERS);
+    LE_FATAL_IF(Iterations < NumProducers, "Iterations must be at least %d", NumProducers);
+
+    MainThread = le_thread_GetCurrent();
+    StartSem = le_sem_Create("eventBenchStart", 0);
+
+    StartPingPong();
+}
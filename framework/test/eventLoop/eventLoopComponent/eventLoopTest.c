@@ -25,6 +25,14 @@ static Report_t ReportA = { "Report A", &TestAPassed };
 static Report_t ReportB = { "Report B", &TestBPassed };
 static Report_t ReportC = { "Report C", &TestCPassed };
 
+// Number of functions queued along with the fd event, more than the default
+// EVENT_MAX_REPORTS_PER_WAKEUP so that the fd event is seen while reports are still left over.
+#define FD_TEST_BACKLOG 200
+
+static int PipeFds[2];
+static int PipeHandlerCalls = 0;
+static int PipeBytesRead = 0;
+
 
 static void EventHandlerA
 (
@@ -84,6 +92,48 @@ static void Destructor
 }
 
 
+static void PipeHandler
+(
+    int fd,
+    short events
+)
+{
+    char byte;
+
+    PipeHandlerCalls++;
+
+    // The pipe is non-blocking, so a second call for the same event doesn't hang.
+    if (read(fd, &byte, 1) == 1)
+    {
+        PipeBytesRead++;
+    }
+}
+
+
+static void QueuedNothing
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+}
+
+
+static void CheckFdResults
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_TEST_OK(PipeBytesRead == 1, "Pipe byte read by the fd event handler.");
+    LE_TEST_OK(PipeHandlerCalls == 1, "fd event handler called once (called %d times).",
+               PipeHandlerCalls);
+
+    LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
+    LE_TEST_EXIT;
+}
+
+
 static void CheckTestResults
 (
     void* param1Ptr,
@@ -97,8 +147,8 @@ static void CheckTestResults
     LE_TEST_OK(TestAPassed, "Test Event B passed");
     LE_TEST_OK(TestAPassed, "Test Event C passed");
 
-    LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
-    LE_TEST_EXIT;
+    // Queued after the fd event was reported, so run after its handler.
+    le_event_QueueFunction(CheckFdResults, NULL, NULL);
 }
 
 
@@ -110,7 +160,7 @@ COMPONENT_INIT
 
     LE_INFO("%s called!", __func__);
 
-    LE_TEST_PLAN(22);
+    LE_TEST_PLAN(27);
 
     EventIdA = le_event_CreateId("Event A", sizeof(ReportA));
     LE_TEST_OK(true, "Created event ID A.");
@@ -148,6 +198,19 @@ COMPONENT_INIT
     le_event_ReportWithRefCounting(EventIdC, reportPtr);
     LE_TEST_OK(true, "Reporting event C with ref counting...");
 
+    // Make a pipe readable while a backlog of functions is queued.  The fd event must be handled
+    // once, whether it is queued behind the backlog or dispatched ahead of it.
+    LE_TEST_ASSERT(pipe(PipeFds) == 0, "Created pipe.");
+    LE_TEST_ASSERT(fcntl(PipeFds[0], F_SETFL, O_NONBLOCK) == 0, "Made pipe non-blocking.");
+    le_fdMonitor_Create("Pipe", PipeFds[0], PipeHandler, POLLIN);
+
+    int i;
+    for (i = 0; i < FD_TEST_BACKLOG; i++)
+    {
+        le_event_QueueFunction(QueuedNothing, NULL, NULL);
+    }
+    LE_TEST_ASSERT(write(PipeFds[1], "x", 1) == 1, "Wrote to pipe.");
+
     le_event_QueueFunction(CheckTestResults, &ReportA, &ReportB);
     LE_TEST_OK(true, "Queuing function to check test results for events A and B...");
 }
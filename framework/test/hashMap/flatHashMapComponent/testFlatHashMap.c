@@ -0,0 +1,537 @@
+/**
+ * Functional test of the le_flatHashmap module in the legato runtime library.
+ *
+ * The cases that depend on the layout of the map (tombstones, rebuilding at the same size and
+ * incremental resizing) are set up from the map's growth rules: a table of N slots holds 7N/8 keys
+ * before it is rebuilt, and each insertion during an incremental resize moves 32 slots.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of keys used by the tests.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NUM_KEYS            2048
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keys held by a map of 1024 slots when it is full.  Adding one more key rebuilds it.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FULL_1024_SLOTS     896
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of keys added after the incremental resize starts.  Each moves 32 of the 1024 old slots,
+ * so the resize is still in progress after all of them.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RESIZE_EXTRA_KEYS   16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Capacity and batch size for the tombstone test.  The map holds 64 slots, and stays less than
+ * half full so that it is always rebuilt at the same size.  The keys of a batch all have the same
+ * hash.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHURN_CAPACITY      50
+#define CHURN_BATCH_KEYS    20
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keys and values.  Value i is stored for key i.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Keys[NUM_KEYS];
+static uint32_t Values[NUM_KEYS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of times each key was seen while iterating over a map.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SeenCount[NUM_KEYS];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash function giving all the keys of a batch the same hash, so that they share one probe
+ * sequence.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BatchHash
+(
+    const void* keyPtr
+)
+{
+    return *(const uint32_t*)keyPtr / CHURN_BATCH_KEYS;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index of a stored key.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t KeyIndex
+(
+    const void* keyPtr
+)
+{
+    return (const uint32_t*)keyPtr - Keys;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the keys in [first, last) are in the map, with their values, and that the other keys
+ * are not.
+ *
+ * @return true if the map holds exactly those keys.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HoldsKeys
+(
+    le_flatHashmap_Ref_t    map,
+    size_t                  first,
+    size_t                  last
+)
+{
+    size_t i;
+
+    if (le_flatHashmap_Size(map) != last - first)
+    {
+        LE_TEST_INFO("Size %" PRIuS " instead of %" PRIuS, le_flatHashmap_Size(map), last - first);
+        return false;
+    }
+
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        bool expected = (i >= first) && (i < last);
+        uint32_t key = Keys[i];
+
+        if ((le_flatHashmap_ContainsKey(map, &key) != expected) ||
+            (le_flatHashmap_Get(map, &key) != (expected ? &Values[i] : NULL)) ||
+            (le_flatHashmap_GetStoredKey(map, &key) != (expected ? &Keys[i] : NULL)))
+        {
+            LE_TEST_INFO("Key %" PRIu32 " is wrong", key);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the keys in [first, last) to the map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PutKeys
+(
+    le_flatHashmap_Ref_t    map,
+    size_t                  first,
+    size_t                  last
+)
+{
+    size_t i;
+
+    for (i = first; i < last; i++)
+    {
+        LE_TEST_ASSERT(le_flatHashmap_Put(map, &Keys[i], &Values[i]) == NULL,
+                       "Put new key %" PRIuS, i);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Walk the map with its iterator, counting the keys seen in SeenCount[].  Every odd key is removed
+ * when it is reached.
+ *
+ * @return true if the iterator returned consistent keys and values.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IterateAndRemoveOdd
+(
+    le_flatHashmap_Ref_t    map
+)
+{
+    le_flatHashmap_It_Ref_t iter = le_flatHashmap_GetIterator(map);
+    bool ok = true;
+
+    memset(SeenCount, 0, sizeof(SeenCount));
+
+    if ((le_flatHashmap_GetKey(iter) != NULL) || (le_flatHashmap_GetValue(iter) != NULL))
+    {
+        LE_TEST_INFO("Iterator is on an entry before NextNode()");
+        ok = false;
+    }
+
+    while (le_flatHashmap_NextNode(iter) == LE_OK)
+    {
+        const void* keyPtr = le_flatHashmap_GetKey(iter);
+        size_t i = KeyIndex(keyPtr);
+
+        if ((i >= NUM_KEYS) || (le_flatHashmap_GetValue(iter) != &Values[i]))
+        {
+            LE_TEST_INFO("Iterator returned a bad entry");
+            return false;
+        }
+
+        SeenCount[i]++;
+
+        if (i % 2 == 1)
+        {
+            if (le_flatHashmap_Remove(map, keyPtr) != &Values[i])
+            {
+                LE_TEST_INFO("Could not remove key %" PRIuS, i);
+                ok = false;
+            }
+
+            // The removed entry is no longer available through the iterator.
+            if ((le_flatHashmap_GetKey(iter) != NULL) || (le_flatHashmap_GetValue(iter) != NULL))
+            {
+                LE_TEST_INFO("Iterator still on removed key %" PRIuS, i);
+                ok = false;
+            }
+        }
+    }
+
+    // Past the end, the iterator stays there.
+    if ((le_flatHashmap_NextNode(iter) != LE_NOT_FOUND) || (le_flatHashmap_GetKey(iter) != NULL))
+    {
+        LE_TEST_INFO("Iterator did not stay past the end");
+        ok = false;
+    }
+
+    return ok;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that each key in [first, last) was seen exactly once by the last iteration, and no others.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool SeenOnce
+(
+    size_t  first,
+    size_t  last
+)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        if (SeenCount[i] != ((i >= first) && (i < last) ? 1 : 0))
+        {
+            LE_TEST_INFO("Key %" PRIuS " seen %d times", i, SeenCount[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that only the even keys in [first, last) are in the map.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HoldsEvenKeys
+(
+    le_flatHashmap_Ref_t    map,
+    size_t                  first,
+    size_t                  last
+)
+{
+    size_t i;
+    size_t count = 0;
+
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        bool expected = (i >= first) && (i < last) && (i % 2 == 0);
+
+        if (le_flatHashmap_Get(map, &Keys[i]) != (expected ? &Values[i] : NULL))
+        {
+            LE_TEST_INFO("Key %" PRIuS " is wrong", i);
+            return false;
+        }
+        count += expected;
+    }
+
+    return (le_flatHashmap_Size(map) == count);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * ForEach() callback counting the keys it is called with, and stopping at the key in the context
+ * if any.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CountKey
+(
+    const void* keyPtr,
+    const void* valuePtr,
+    void*       contextPtr
+)
+{
+    size_t i = KeyIndex(keyPtr);
+
+    if ((i < NUM_KEYS) && (valuePtr == &Values[i]))
+    {
+        SeenCount[i]++;
+    }
+
+    return (keyPtr != contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test adding, replacing, looking up and removing keys.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestBasic
+(
+    void
+)
+{
+    le_flatHashmap_Ref_t map = le_flatHashmap_Create("Basic", 10, le_hashmap_HashUInt32,
+                                                     le_hashmap_EqualsUInt32);
+    uint32_t key = Keys[5];
+    uint32_t otherValue = 0;
+
+    LE_TEST_INFO("=== Basic operations ===");
+
+    LE_TEST_OK(le_flatHashmap_IsEmpty(map), "New map is empty");
+
+    PutKeys(map, 0, NUM_KEYS);
+    LE_TEST_OK(HoldsKeys(map, 0, NUM_KEYS), "Map grew to hold all the keys");
+
+    // Replacing a value keeps the stored key, and the lookups are done with a copy of the key.
+    LE_TEST_OK(le_flatHashmap_Put(map, &key, &otherValue) == &Values[5], "Replace a value");
+    LE_TEST_OK(le_flatHashmap_Get(map, &key) == &otherValue, "Get the new value");
+    LE_TEST_OK(le_flatHashmap_GetStoredKey(map, &key) == &Keys[5], "Stored key is unchanged");
+    LE_TEST_OK(le_flatHashmap_Put(map, &key, &Values[5]) == &otherValue, "Restore the value");
+
+    LE_TEST_OK(le_flatHashmap_Remove(map, &key) == &Values[5], "Remove a key");
+    LE_TEST_OK(le_flatHashmap_Remove(map, &key) == NULL, "Remove a missing key");
+    LE_TEST_OK(!le_flatHashmap_ContainsKey(map, &key), "Removed key is gone");
+    LE_TEST_OK(le_flatHashmap_Size(map) == NUM_KEYS - 1, "Size after removal");
+
+    le_flatHashmap_RemoveAll(map);
+    LE_TEST_OK(le_flatHashmap_IsEmpty(map) && HoldsKeys(map, 0, 0), "RemoveAll empties the map");
+    LE_TEST_OK(le_flatHashmap_NextNode(le_flatHashmap_GetIterator(map)) == LE_NOT_FOUND,
+               "Iterating over an empty map");
+
+    PutKeys(map, 0, NUM_KEYS / 2);
+    LE_TEST_OK(HoldsKeys(map, 0, NUM_KEYS / 2), "Map refilled after RemoveAll");
+
+    le_flatHashmap_Delete(map);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the iterator and ForEach(), including removing entries during the iteration.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestIterator
+(
+    void
+)
+{
+    le_flatHashmap_Ref_t map = le_flatHashmap_Create("Iterator", 100, le_hashmap_HashUInt32,
+                                                     le_hashmap_EqualsUInt32);
+    size_t i;
+
+    LE_TEST_INFO("=== Iterator ===");
+
+    PutKeys(map, 0, NUM_KEYS);
+
+    memset(SeenCount, 0, sizeof(SeenCount));
+    LE_TEST_OK(le_flatHashmap_ForEach(map, CountKey, NULL) && SeenOnce(0, NUM_KEYS),
+               "ForEach visits each key once");
+
+    memset(SeenCount, 0, sizeof(SeenCount));
+    LE_TEST_OK(!le_flatHashmap_ForEach(map, CountKey, &Keys[7]) && (SeenCount[7] == 1),
+               "ForEach stops when the callback returns false");
+
+    LE_TEST_OK(IterateAndRemoveOdd(map), "Iterate and remove the odd keys");
+    LE_TEST_OK(SeenOnce(0, NUM_KEYS), "Iterator visited each key once");
+    LE_TEST_OK(HoldsEvenKeys(map, 0, NUM_KEYS), "Only the even keys are left");
+
+    // Removing keys other than the current one does not disturb the iterator either.  Keys removed
+    // before being reached are marked with -1 and must not be visited, those removed after being
+    // visited are marked with 2.
+    le_flatHashmap_It_Ref_t iter = le_flatHashmap_GetIterator(map);
+    bool ok = true;
+
+    memset(SeenCount, 0, sizeof(SeenCount));
+    while (le_flatHashmap_NextNode(iter) == LE_OK)
+    {
+        i = KeyIndex(le_flatHashmap_GetKey(iter));
+        ok = ok && (SeenCount[i] == 0);
+        SeenCount[i] = 1;
+
+        if ((i + 2 < NUM_KEYS) && (le_flatHashmap_Remove(map, &Keys[i + 2]) != NULL))
+        {
+            SeenCount[i + 2] = (SeenCount[i + 2] == 0 ? -1 : 2);
+        }
+    }
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        ok = ok && (le_flatHashmap_ContainsKey(map, &Keys[i]) == (SeenCount[i] == 1));
+    }
+    LE_TEST_OK(ok, "Keys removed ahead of the iterator are not visited");
+
+    le_flatHashmap_Delete(map);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test iterating and looking up keys while an incremental resize is in progress, with entries in
+ * both the old and the new table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestIncrementalResize
+(
+    void
+)
+{
+    le_flatHashmap_Ref_t map = le_flatHashmap_Create("Incremental", FULL_1024_SLOTS,
+                                                     le_hashmap_HashUInt32,
+                                                     le_hashmap_EqualsUInt32);
+    size_t last = FULL_1024_SLOTS + 1 + RESIZE_EXTRA_KEYS;
+    uint32_t otherValue = 0;
+
+    LE_TEST_INFO("=== Incremental resize ===");
+
+    le_flatHashmap_EnableIncrementalResize(map);
+
+    // Fill the 1024 slots, then start the resize.
+    PutKeys(map, 0, last);
+    LE_TEST_OK(HoldsKeys(map, 0, last), "Keys found in both tables");
+
+    // Replace the values of all the keys, whichever table they are in, and remove and add back
+    // the last key.
+    bool ok = true;
+    size_t i;
+
+    for (i = 0; i < last; i++)
+    {
+        ok = ok && (le_flatHashmap_Put(map, &Keys[i], &otherValue) == &Values[i]) &&
+                   (le_flatHashmap_Get(map, &Keys[i]) == &otherValue) &&
+                   (le_flatHashmap_Put(map, &Keys[i], &Values[i]) == &otherValue);
+    }
+    LE_TEST_OK(ok, "Replace values during the resize");
+    LE_TEST_OK((le_flatHashmap_Remove(map, &Keys[last - 1]) == &Values[last - 1]) &&
+               (le_flatHashmap_Put(map, &Keys[last - 1], &Values[last - 1]) == NULL),
+               "Remove and add back a key during the resize");
+    LE_TEST_OK(HoldsKeys(map, 0, last), "Keys found after replacing values");
+
+    memset(SeenCount, 0, sizeof(SeenCount));
+    LE_TEST_OK(le_flatHashmap_ForEach(map, CountKey, NULL) && SeenOnce(0, last),
+               "ForEach visits each key once during the resize");
+
+    LE_TEST_OK(IterateAndRemoveOdd(map), "Iterate and remove the odd keys during the resize");
+    LE_TEST_OK(SeenOnce(0, last), "Iterator visited each key once during the resize");
+    LE_TEST_OK(HoldsEvenKeys(map, 0, last), "Only the even keys are left");
+
+    // Finish the resize.
+    PutKeys(map, NUM_KEYS / 2, NUM_KEYS);
+    ok = (le_flatHashmap_Size(map) == (last + 1) / 2 + NUM_KEYS / 2);
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        bool expected = (i >= NUM_KEYS / 2) || ((i < last) && (i % 2 == 0));
+
+        ok = ok && (le_flatHashmap_Get(map, &Keys[i]) == (expected ? &Values[i] : NULL));
+    }
+    LE_TEST_OK(ok, "Keys kept once the resize has finished");
+
+    le_flatHashmap_RemoveAll(map);
+    LE_TEST_OK(HoldsKeys(map, 0, 0), "RemoveAll during a resize");
+    PutKeys(map, 0, last);
+    LE_TEST_OK(HoldsKeys(map, 0, last), "Map refilled after RemoveAll");
+
+    le_flatHashmap_Delete(map);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test reusing the slots of removed keys, and rebuilding the map at the same size to clear out
+ * tombstones.  The keys of a batch collide, so removing them from the middle of their probe
+ * sequence leaves tombstones.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestTombstones
+(
+    void
+)
+{
+    le_flatHashmap_Ref_t map = le_flatHashmap_Create("Tombstones", CHURN_CAPACITY, BatchHash,
+                                                     le_hashmap_EqualsUInt32);
+    size_t first, i;
+    bool ok = true;
+
+    LE_TEST_INFO("=== Tombstones ===");
+
+    PutKeys(map, 0, CHURN_BATCH_KEYS);
+
+    // Remove keys in the middle of the probe sequence and add them back into their slots.
+    for (i = 1; i < CHURN_BATCH_KEYS; i += 2)
+    {
+        le_flatHashmap_Remove(map, &Keys[i]);
+    }
+    LE_TEST_OK(HoldsEvenKeys(map, 0, CHURN_BATCH_KEYS), "Keys found past tombstones");
+    for (i = 1; i < CHURN_BATCH_KEYS; i += 2)
+    {
+        ok = ok && (le_flatHashmap_Put(map, &Keys[i], &Values[i]) == NULL);
+    }
+    LE_TEST_OK(ok && HoldsKeys(map, 0, CHURN_BATCH_KEYS), "Removed keys added back");
+
+    // Add and remove one batch after the other.  Each batch probes from a different slot, so the
+    // tombstones left by the previous batches pile up until the map has to be rebuilt.
+    for (first = CHURN_BATCH_KEYS; first + CHURN_BATCH_KEYS <= NUM_KEYS; first += CHURN_BATCH_KEYS)
+    {
+        size_t last = first + CHURN_BATCH_KEYS;
+
+        for (i = first - CHURN_BATCH_KEYS; i < first; i++)
+        {
+            ok = ok && (le_flatHashmap_Remove(map, &Keys[i]) == &Values[i]);
+        }
+        for (i = first; i < last; i++)
+        {
+            ok = ok && (le_flatHashmap_Put(map, &Keys[i], &Values[i]) == NULL);
+        }
+        if (!ok || !HoldsKeys(map, first, last))
+        {
+            ok = false;
+            break;
+        }
+    }
+    LE_TEST_OK(ok, "Batches of keys added and removed");
+
+    le_flatHashmap_Delete(map);
+}
+
+COMPONENT_INIT
+{
+    size_t i;
+
+    LE_TEST_PLAN(LE_TEST_NO_PLAN);
+
+    for (i = 0; i < NUM_KEYS; i++)
+    {
+        Keys[i] = (uint32_t)i;
+        Values[i] = (uint32_t)i;
+    }
+
+    TestBasic();
+    TestIterator();
+    TestIncrementalResize();
+    TestTombstones();
+
+    LE_TEST_EXIT;
+}
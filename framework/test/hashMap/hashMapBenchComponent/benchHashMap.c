@@ -0,0 +1,309 @@
+/**
+ * This module benchmarks the chained le_hashmap against the open-addressing le_flatHashmap.
+ *
+ * Usage: benchHashMap [-m <max entries>]
+ *
+ * For 1000, 100000 and 1000000 entries (up to max entries), integer keys are inserted, looked up
+ * (both keys that are present and keys that are not), and removed again, and the average time of
+ * each operation is reported.  The chained map is created with the final number of entries as its
+ * capacity, while the flat maps start empty and grow as needed.
+ *
+ * For the flat maps, the longest single insertion is also reported, with and without
+ * le_flatHashmap_EnableIncrementalResize().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_MAX_ENTRIES     1000000
+
+static int MaxEntries = DEFAULT_MAX_ENTRIES;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Numbers of entries to benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static const int EntryCounts[] = { 1000, 100000, 1000000 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Operations of a type of map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;                                               ///< Name of the map type.
+    bool isFlat;                                                    ///< true for le_flatHashmap.
+    void* (*create)(size_t count);                                  ///< Create an empty map.
+    void* (*put)(void* mapRef, const void* keyPtr, const void* valuePtr);
+    void* (*get)(void* mapRef, const void* keyPtr);
+    void* (*remove)(void* mapRef, const void* keyPtr);
+    void (*destroy)(void* mapRef);                                  ///< Delete or empty the map.
+}
+MapType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keys that are put in the maps, and keys that are never put in them.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t* Keys;
+static uint32_t* MissingKeys;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chained map operations.  These maps can't be deleted, so they are only emptied.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ChainedCreate(size_t count)
+{
+    return le_hashmap_Create("benchChained", count, le_hashmap_HashUInt32, le_hashmap_EqualsUInt32);
+}
+
+static void* ChainedPut(void* mapRef, const void* keyPtr, const void* valuePtr)
+{
+    return le_hashmap_Put(mapRef, keyPtr, valuePtr);
+}
+
+static void* ChainedGet(void* mapRef, const void* keyPtr)
+{
+    return le_hashmap_Get(mapRef, keyPtr);
+}
+
+static void* ChainedRemove(void* mapRef, const void* keyPtr)
+{
+    return le_hashmap_Remove(mapRef, keyPtr);
+}
+
+static void ChainedDestroy(void* mapRef)
+{
+    le_hashmap_RemoveAll(mapRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flat map operations.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* FlatCreate(size_t count)
+{
+    return le_flatHashmap_Create("benchFlat", 0, le_hashmap_HashUInt32, le_hashmap_EqualsUInt32);
+}
+
+static void* FlatIncrementalCreate(size_t count)
+{
+    le_flatHashmap_Ref_t mapRef = FlatCreate(count);
+
+    le_flatHashmap_EnableIncrementalResize(mapRef);
+    return mapRef;
+}
+
+static void* FlatPut(void* mapRef, const void* keyPtr, const void* valuePtr)
+{
+    return le_flatHashmap_Put(mapRef, keyPtr, valuePtr);
+}
+
+static void* FlatGet(void* mapRef, const void* keyPtr)
+{
+    return le_flatHashmap_Get(mapRef, keyPtr);
+}
+
+static void* FlatRemove(void* mapRef, const void* keyPtr)
+{
+    return le_flatHashmap_Remove(mapRef, keyPtr);
+}
+
+static void FlatDestroy(void* mapRef)
+{
+    le_flatHashmap_Delete(mapRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of map to benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static const MapType_t MapTypes[] =
+{
+    { "chained", false, ChainedCreate, ChainedPut, ChainedGet, ChainedRemove, ChainedDestroy },
+    { "flat", true, FlatCreate, FlatPut, FlatGet, FlatRemove, FlatDestroy },
+    { "flat incr", true, FlatIncrementalCreate, FlatPut, FlatGet, FlatRemove, FlatDestroy },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value stored for the i'th key.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void* ValueOf
+(
+    int i
+)
+{
+    return (void*)(uintptr_t)(i + 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a new map, timing each insertion.
+ *
+ * @return The longest insertion, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double LongestInsert
+(
+    const MapType_t* typePtr,
+    int count
+)
+{
+    void* mapRef = typePtr->create(count);
+    double longest = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        le_clk_Time_t startTime = le_clk_GetRelativeTime();
+        double usec;
+
+        typePtr->put(mapRef, &Keys[i], ValueOf(i));
+
+        usec = ElapsedUsec(startTime);
+        if (usec > longest)
+        {
+            longest = usec;
+        }
+    }
+
+    typePtr->destroy(mapRef);
+    return longest;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark one type of map with a given number of entries.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunOne
+(
+    const MapType_t* typePtr,
+    int count
+)
+{
+    void* mapRef = typePtr->create(count);
+    double insertUsec, hitUsec, missUsec, removeUsec;
+    le_clk_Time_t startTime;
+    bool ok = true;
+    int i;
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < count; i++)
+    {
+        ok = (typePtr->put(mapRef, &Keys[i], ValueOf(i)) == NULL) && ok;
+    }
+    insertUsec = ElapsedUsec(startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < count; i++)
+    {
+        ok = (typePtr->get(mapRef, &Keys[i]) == ValueOf(i)) && ok;
+    }
+    hitUsec = ElapsedUsec(startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < count; i++)
+    {
+        ok = (typePtr->get(mapRef, &MissingKeys[i]) == NULL) && ok;
+    }
+    missUsec = ElapsedUsec(startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < count; i++)
+    {
+        ok = (typePtr->remove(mapRef, &Keys[i]) == ValueOf(i)) && ok;
+    }
+    removeUsec = ElapsedUsec(startTime);
+
+    ok = (typePtr->get(mapRef, &Keys[0]) == NULL) && ok;
+    typePtr->destroy(mapRef);
+
+    LE_TEST_INFO("%-9s %7d entries: insert %7.1f ns, hit %7.1f ns, miss %7.1f ns, "
+                 "remove %7.1f ns",
+                 typePtr->name,
+                 count,
+                 insertUsec * 1000.0 / count,
+                 hitUsec * 1000.0 / count,
+                 missUsec * 1000.0 / count,
+                 removeUsec * 1000.0 / count);
+
+    if (typePtr->isFlat)
+    {
+        LE_TEST_INFO("%-9s %7d entries: longest insert %.0f us",
+                     typePtr->name, count, LongestInsert(typePtr, count));
+    }
+
+    LE_TEST_OK(ok, "%s map with %d entries", typePtr->name, count);
+}
+
+COMPONENT_INIT
+{
+    size_t i, j;
+    int maxCount = 0;
+
+    le_arg_SetIntVar(&MaxEntries, "m", "max-entries");
+    le_arg_Scan();
+
+    LE_TEST_PLAN((int)(NUM_ARRAY_MEMBERS(EntryCounts) * NUM_ARRAY_MEMBERS(MapTypes)));
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(EntryCounts); i++)
+    {
+        if ((EntryCounts[i] <= MaxEntries) && (EntryCounts[i] > maxCount))
+        {
+            maxCount = EntryCounts[i];
+        }
+    }
+
+    // Multiplying by an odd constant scatters the keys without making any two of them equal.
+    Keys = malloc(maxCount * sizeof(uint32_t));
+    MissingKeys = malloc(maxCount * sizeof(uint32_t));
+    LE_ASSERT((Keys != NULL) && (MissingKeys != NULL));
+
+    for (i = 0; i < (size_t)maxCount; i++)
+    {
+        Keys[i] = (uint32_t)(2 * i) * 2654435761u;
+        MissingKeys[i] = (uint32_t)(2 * i + 1) * 2654435761u;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(EntryCounts); i++)
+    {
+        LE_TEST_BEGIN_SKIP(EntryCounts[i] > MaxEntries, NUM_ARRAY_MEMBERS(MapTypes));
+        for (j = 0; j < NUM_ARRAY_MEMBERS(MapTypes); j++)
+        {
+            RunOne(&MapTypes[j], EntryCounts[i]);
+        }
+        LE_TEST_END_SKIP();
+    }
+
+    free(Keys);
+    free(MissingKeys);
+
+    LE_TEST_EXIT;
+}
@@ -0,0 +1,327 @@
+/**
+ * This module benchmarks bursts of messages through Low-Level Messaging sessions, and reports how
+ * many messages were carried by each socket system call.
+ *
+ * Usage: benchIpcBatch [-n <messages per client>] [-c <client threads>]
+ *
+ * A server thread and several client threads run in the same process.  Two tests are run:
+ *
+ *  - Fan-out: once all the clients have subscribed, the server sends a burst of indications to
+ *    every client, the way a positioning service fans out fixes to its clients.
+ *  - Fan-in: every client sends a burst of messages to the server.
+ *
+ * For each, the message rate and the le_msg_GetBatchStats() counts are reported.  Compare the
+ * results with the IPC_BATCH_SIZE KConfig option set to 1 and to larger values.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_MESSAGES        10000
+#define DEFAULT_CLIENTS         4
+#define MAX_CLIENTS             32
+
+#define PROTOCOL_ID             "ipcBatchBench"
+#define SERVICE_NAME            "ipcBatchBench"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message types.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    MSG_SUBSCRIBE,      ///< Client to server: start sending me indications.
+    MSG_INDICATION,     ///< Server to client: fanned out data.
+    MSG_DATA,           ///< Client to server: fanned in data.
+}
+MsgType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message payload.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MsgType_t   type;
+    uint32_t    seq;
+    uint8_t     data[56];
+}
+Msg_t;
+
+static int NumMessages = DEFAULT_MESSAGES;
+static int NumClients = DEFAULT_CLIENTS;
+
+static le_msg_ProtocolRef_t ProtocolRef;
+static le_thread_Ref_t ClientThreads[MAX_CLIENTS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Posted by the server thread when its service is advertised, and by the threads receiving the
+ * messages of a test when they have received all of them.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t ReadySem;
+static le_sem_Ref_t DoneSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server state.  Only accessed by the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionRef_t Subscribers[MAX_CLIENTS];
+static int NumSubscribers;
+static int FanInReceived;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send one message through a session.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendMsg
+(
+    le_msg_SessionRef_t sessionRef,
+    MsgType_t type,
+    uint32_t seq
+)
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    Msg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    msgPtr->type = type;
+    msgPtr->seq = seq;
+
+    le_msg_Send(msgRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server side: handle a message from a client.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServerRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void* contextPtr
+)
+{
+    Msg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    int i, j;
+
+    switch (msgPtr->type)
+    {
+        case MSG_SUBSCRIBE:
+            LE_ASSERT(NumSubscribers < NumClients);
+            Subscribers[NumSubscribers++] = le_msg_GetSession(msgRef);
+
+            // Once everyone has subscribed, fan out the whole burst.
+            if (NumSubscribers == NumClients)
+            {
+                for (i = 0; i < NumMessages; i++)
+                {
+                    for (j = 0; j < NumSubscribers; j++)
+                    {
+                        SendMsg(Subscribers[j], MSG_INDICATION, i);
+                    }
+                }
+            }
+            break;
+
+        case MSG_DATA:
+            if (++FanInReceived == NumMessages * NumClients)
+            {
+                le_sem_Post(DoneSem);
+            }
+            break;
+
+        default:
+            LE_FATAL("Unexpected message type %d", msgPtr->type);
+    }
+
+    le_msg_ReleaseMsg(msgRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* contextPtr
+)
+{
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(ProtocolRef, SERVICE_NAME);
+
+    le_msg_SetServiceRecvHandler(serviceRef, ServerRecvHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+
+    le_sem_Post(ReadySem);
+    le_event_RunLoop();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: count the indications from the server.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void* contextPtr
+)
+{
+    int* countPtr = contextPtr;
+    Msg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    LE_ASSERT(msgPtr->type == MSG_INDICATION);
+    LE_ASSERT(msgPtr->seq == (uint32_t)*countPtr);
+
+    if (++(*countPtr) == NumMessages)
+    {
+        le_sem_Post(DoneSem);
+    }
+
+    le_msg_ReleaseMsg(msgRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: send a burst of messages to the server.  Queued to each client thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientSendBurst
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_msg_SessionRef_t sessionRef = param1Ptr;
+    int i;
+
+    for (i = 0; i < NumMessages; i++)
+    {
+        SendMsg(sessionRef, MSG_DATA, i);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a client thread.  Subscribes to the server's indications.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ClientThreadMain
+(
+    void* contextPtr
+)
+{
+    le_msg_SessionRef_t* sessionRefPtr = contextPtr;
+    int receivedCount = 0;
+
+    *sessionRefPtr = le_msg_CreateSession(ProtocolRef, SERVICE_NAME);
+    le_msg_SetSessionRecvHandler(*sessionRefPtr, ClientRecvHandler, &receivedCount);
+    le_msg_OpenSessionSync(*sessionRefPtr);
+
+    SendMsg(*sessionRefPtr, MSG_SUBSCRIBE, 0);
+
+    le_event_RunLoop();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for every thread taking part in a test to finish, then report the results.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportTest
+(
+    const char* testName,
+    int numWaits,                           ///< Number of times to wait on DoneSem.
+    le_clk_Time_t startTime,
+    const le_msg_BatchStats_t* startStatsPtr
+)
+{
+    le_msg_BatchStats_t stats;
+    int i;
+
+    for (i = 0; i < numWaits; i++)
+    {
+        le_sem_Wait(DoneSem);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    double seconds = elapsed.sec + elapsed.usec / 1000000.0;
+    int total = NumMessages * NumClients;
+
+    le_msg_GetBatchStats(&stats);
+
+    uint64_t rxCalls = stats.rxCallCount - startStatsPtr->rxCallCount;
+    uint64_t rxMsgs = stats.rxMsgCount - startStatsPtr->rxMsgCount;
+    uint64_t txCalls = stats.txCallCount - startStatsPtr->txCallCount;
+    uint64_t txMsgs = stats.txMsgCount - startStatsPtr->txMsgCount;
+
+    LE_TEST_INFO("%s: %d client(s), %d messages, %10.0f messages per sec",
+                 testName, NumClients, total, total / seconds);
+    LE_TEST_INFO("%s: received %" PRIu64 " messages in %" PRIu64 " calls (%.2f per call), "
+                 "sent %" PRIu64 " messages in %" PRIu64 " calls (%.2f per call)",
+                 testName,
+                 rxMsgs, rxCalls, rxCalls ? (double)rxMsgs / rxCalls : 0.0,
+                 txMsgs, txCalls, txCalls ? (double)txMsgs / txCalls : 0.0);
+    LE_TEST_INFO("%s: largest batches so far: %" PRIuS " received, %" PRIuS " sent",
+                 testName, stats.rxMaxBatch, stats.txMaxBatch);
+    LE_TEST_OK(rxMsgs >= (uint64_t)total, "%s completed", testName);
+}
+
+COMPONENT_INIT
+{
+    le_msg_SessionRef_t clientSessions[MAX_CLIENTS];
+    le_msg_BatchStats_t startStats;
+    le_clk_Time_t startTime;
+    char name[32];
+    int i;
+
+    le_arg_SetIntVar(&NumMessages, "n", "messages");
+    le_arg_SetIntVar(&NumClients, "c", "clients");
+    le_arg_Scan();
+
+    LE_TEST_PLAN(2);
+
+    LE_FATAL_IF((NumClients < 1) || (NumClients > MAX_CLIENTS),
+                "Client count must be between 1 and %d", MAX_CLIENTS);
+    LE_FATAL_IF(NumMessages < 1, "Message count must be at least 1");
+
+    ProtocolRef = le_msg_GetProtocolRef(PROTOCOL_ID, sizeof(Msg_t));
+    ReadySem = le_sem_Create("ipcBatchBenchReady", 0);
+    DoneSem = le_sem_Create("ipcBatchBenchDone", 0);
+
+    le_thread_Start(le_thread_Create("ipcBatchBenchServer", ServerThreadMain, NULL));
+    le_sem_Wait(ReadySem);
+
+    // Fan-out test.  The server starts sending as soon as the last client subscribes.
+    le_msg_GetBatchStats(&startStats);
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NumClients; i++)
+    {
+        snprintf(name, sizeof(name), "ipcBatchClient%d", i);
+        ClientThreads[i] = le_thread_Create(name, ClientThreadMain, &clientSessions[i]);
+        le_thread_Start(ClientThreads[i]);
+    }
+
+    ReportTest("fan-out", NumClients, startTime, &startStats);
+
+    // Fan-in test.
+    le_msg_GetBatchStats(&startStats);
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NumClients; i++)
+    {
+        le_event_QueueFunctionToThread(ClientThreads[i], ClientSendBurst, clientSessions[i], NULL);
+    }
+
+    ReportTest("fan-in", 1, startTime, &startStats);
+
+    LE_TEST_EXIT;
+}
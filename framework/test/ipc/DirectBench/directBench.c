@@ -0,0 +1,62 @@
+/**
+ * This module benchmarks calls to an API bound directly, against the same calls packed into
+ * messages.
+ *
+ * Usage: benchIpcDirect [-n <calls>]
+ *        benchIpcMarshalled [-n <calls>]
+ *
+ * The same component is built into two executables of bench_IpcDirect:
+ *
+ *  - benchIpcDirect also holds the ipcTest server, which provides the API as [direct]: every
+ *    ipcTest_EchoSimple() call is a function call into the server.
+ *  - benchIpcMarshalled is bound to the ipcTest server of another process: every call is packed
+ *    into a message, and waits for the response.
+ *
+ * Each reports the time per call, to be compared with the other.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+#define DEFAULT_CALLS           100000
+
+static int NumCalls = DEFAULT_CALLS;
+
+
+COMPONENT_INIT
+{
+    int mismatches = 0;
+    int i;
+
+    le_arg_SetIntVar(&NumCalls, "n", "calls");
+    le_arg_Scan();
+
+    LE_FATAL_IF(NumCalls < 1, "Call count must be at least 1");
+
+    LE_TEST_PLAN(1);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NumCalls; i++)
+    {
+        int32_t outValue = -1;
+
+        ipcTest_EchoSimple(i, &outValue);
+        if (outValue != i)
+        {
+            mismatches++;
+        }
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    uint64_t elapsedNs = (uint64_t)elapsed.sec * 1000000000 + (uint64_t)elapsed.usec * 1000;
+
+    LE_TEST_INFO("%s: %d calls in %" PRIu64 " us, %" PRIu64 " ns per call",
+                 le_arg_GetProgramName(), NumCalls, elapsedNs / 1000, elapsedNs / NumCalls);
+    LE_TEST_OK(mismatches == 0, "%s: %d of %d calls echoed correctly",
+               le_arg_GetProgramName(), NumCalls - mismatches, NumCalls);
+
+    LE_TEST_EXIT;
+}
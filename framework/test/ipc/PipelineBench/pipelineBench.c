@@ -0,0 +1,185 @@
+/**
+ * This module benchmarks calls to an API in another process made one at a time, against the same
+ * calls made asynchronously and sent in batches.
+ *
+ * Usage: benchIpcPipeline [-n <calls>] [-b <calls per batch>]
+ *
+ * Three tests are run against the ipcTest server, each making the same number of EchoSimple calls:
+ *
+ *  - Synchronous: ipcTest_EchoSimple(), which waits for each response before the next request.
+ *  - Asynchronous: ipcTest_EchoSimpleAsync(), with the responses handled by the event loop.  Up to
+ *    a batch worth of calls are in flight at any time.
+ *  - Batched: ipcTest_EchoSimpleAsync() between ipcTest_StartBatch() and ipcTest_EndBatch(), so
+ *    each batch of requests is written at once and the server handles them in one wake-up.
+ *
+ * The number of calls per second is reported for each, along with the le_msg_GetBatchStats()
+ * counts.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+#define DEFAULT_CALLS           10000
+#define DEFAULT_BATCH_SIZE      50
+
+static int NumCalls = DEFAULT_CALLS;
+static int BatchSize = DEFAULT_BATCH_SIZE;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Progress of the asynchronous calls of a test.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CallsSent;
+static int CallsDone;
+static int Mismatches;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of the test that is running, and the counts at that time.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t StartTime;
+static le_msg_BatchStats_t StartStats;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start timing a test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartTest
+(
+    void
+)
+{
+    CallsSent = 0;
+    CallsDone = 0;
+    Mismatches = 0;
+
+    le_msg_GetBatchStats(&StartStats);
+    StartTime = le_clk_GetRelativeTime();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the results of a test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportTest
+(
+    const char* testName
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+    double seconds = elapsed.sec + elapsed.usec / 1000000.0;
+    le_msg_BatchStats_t stats;
+
+    le_msg_GetBatchStats(&stats);
+
+    uint64_t txCalls = stats.txCallCount - StartStats.txCallCount;
+    uint64_t txMsgs = stats.txMsgCount - StartStats.txMsgCount;
+
+    LE_TEST_INFO("%s: %d calls, %10.0f calls per sec, "
+                 "sent %" PRIu64 " messages in %" PRIu64 " system calls",
+                 testName, NumCalls, NumCalls / seconds, txMsgs, txCalls);
+    LE_TEST_OK((CallsDone == NumCalls) && (Mismatches == 0),
+               "%s: %d of %d calls echoed correctly", testName, CallsDone - Mismatches, NumCalls);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle the response to an asynchronous EchoSimple call.  Responses arrive in the order the
+ * requests were sent, so each must echo the number of calls done before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EchoSimpleDone
+(
+    int32_t OutValue,
+    void* contextPtr
+)
+{
+    if (OutValue != CallsDone)
+    {
+        Mismatches++;
+    }
+    CallsDone++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle the response to an asynchronous EchoSimple call made without a batch: send another call
+ * in its place, until all have been sent.  Once all have been answered, the test is over.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EchoSimpleDoneNext
+(
+    int32_t OutValue,
+    void* contextPtr
+)
+{
+    EchoSimpleDone(OutValue, contextPtr);
+
+    if (CallsSent < NumCalls)
+    {
+        ipcTest_EchoSimpleAsync(CallsSent++, EchoSimpleDoneNext, NULL);
+    }
+    else if (CallsDone == NumCalls)
+    {
+        ReportTest("asynchronous");
+        LE_TEST_EXIT;
+    }
+}
+
+
+COMPONENT_INIT
+{
+    int i;
+
+    le_arg_SetIntVar(&NumCalls, "n", "calls");
+    le_arg_SetIntVar(&BatchSize, "b", "batch");
+    le_arg_Scan();
+
+    LE_FATAL_IF(NumCalls < 1, "Call count must be at least 1");
+    LE_FATAL_IF(BatchSize < 1, "Batch size must be at least 1");
+
+    LE_TEST_PLAN(3);
+
+    ipcTest_ConnectService();
+
+    // Synchronous calls.
+    StartTest();
+    for (i = 0; i < NumCalls; i++)
+    {
+        int32_t outValue = -1;
+
+        ipcTest_EchoSimple(i, &outValue);
+        EchoSimpleDone(outValue, NULL);
+    }
+    ReportTest("synchronous");
+
+    // Batched calls.  Every response has been handled when ipcTest_EndBatch() returns.
+    StartTest();
+    while (CallsSent < NumCalls)
+    {
+        ipcTest_StartBatch();
+        for (i = 0; (i < BatchSize) && (CallsSent < NumCalls); i++)
+        {
+            ipcTest_EchoSimpleAsync(CallsSent++, EchoSimpleDone, NULL);
+        }
+        ipcTest_EndBatch();
+    }
+    ReportTest("batched");
+
+    // Asynchronous calls, with the responses handled by the event loop once this returns.
+    StartTest();
+    for (i = 0; (i < BatchSize) && (CallsSent < NumCalls); i++)
+    {
+        ipcTest_EchoSimpleAsync(CallsSent++, EchoSimpleDoneNext, NULL);
+    }
+}
@@ -0,0 +1,188 @@
+/**
+ * This module benchmarks synchronous request-response transactions over Low-Level Messaging
+ * sessions, with and without the shared memory transport.
+ *
+ * Usage: benchIpcShm [-n <iterations>]
+ *
+ * A server thread provides one service per message size.  The main thread opens a session to each
+ * service, first copying payloads through the socket and then with le_msg_EnableSharedMemory(),
+ * and does request-response transactions in which both sides write the whole payload.  The time
+ * per transaction and the payload throughput are reported for each.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_ITERATIONS      10000
+#define SHM_NUM_BUFFERS         4
+#define MAX_NAME_BYTES          32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message sizes to benchmark.  There must be a binding for each in the .adef.
+ */
+//--------------------------------------------------------------------------------------------------
+static const size_t MsgSizes[] = { 64, 256, 1024, 4096, 16384, 65536 };
+
+#define NUM_SIZES   NUM_ARRAY_MEMBERS(MsgSizes)
+
+static int Iterations = DEFAULT_ITERATIONS;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore posted by the server thread once all its services are advertised.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t ServerReadySem;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the protocol used for a given message size.  The service instance has the same name as the
+ * protocol.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_ProtocolRef_t GetProtocol
+(
+    size_t msgSize,
+    char* nameBuffPtr,
+    size_t nameBuffSize
+)
+{
+    LE_ASSERT(snprintf(nameBuffPtr, nameBuffSize, "ipcShmBench%" PRIuS, msgSize) < nameBuffSize);
+
+    return le_msg_GetProtocolRef(nameBuffPtr, msgSize);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server side: write the response over the request and send it back.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServerRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void* contextPtr
+)
+{
+    size_t msgSize = (size_t)(uintptr_t)contextPtr;
+    uint8_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+
+    LE_ASSERT(payloadPtr[msgSize - 1] == 0xA5);
+    memset(payloadPtr, 0x5A, msgSize);
+
+    le_msg_Respond(msgRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* contextPtr
+)
+{
+    char name[MAX_NAME_BYTES];
+    size_t i;
+
+    for (i = 0; i < NUM_SIZES; i++)
+    {
+        le_msg_ProtocolRef_t protocolRef = GetProtocol(MsgSizes[i], name, sizeof(name));
+        le_msg_ServiceRef_t serviceRef = le_msg_CreateService(protocolRef, name);
+
+        le_msg_SetServiceRecvHandler(serviceRef,
+                                     ServerRecvHandler,
+                                     (void*)(uintptr_t)MsgSizes[i]);
+        le_msg_AdvertiseService(serviceRef);
+    }
+
+    le_sem_Post(ServerReadySem);
+    le_event_RunLoop();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the request-response transactions for one message size.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunOne
+(
+    size_t msgSize,
+    bool useShm
+)
+{
+    char name[MAX_NAME_BYTES];
+    le_msg_ProtocolRef_t protocolRef = GetProtocol(msgSize, name, sizeof(name));
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, name);
+    int i;
+    bool ok = true;
+
+    if (useShm)
+    {
+        le_msg_EnableSharedMemory(sessionRef, SHM_NUM_BUFFERS);
+    }
+
+    le_msg_OpenSessionSync(sessionRef);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+        uint8_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+
+        memset(payloadPtr, 0xA5, msgSize);
+
+        msgRef = le_msg_RequestSyncResponse(msgRef);
+        if (msgRef == NULL)
+        {
+            ok = false;
+            break;
+        }
+
+        payloadPtr = le_msg_GetPayloadPtr(msgRef);
+        ok = ok && (payloadPtr[0] == 0x5A) && (payloadPtr[msgSize - 1] == 0x5A);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    double seconds = elapsed.sec + elapsed.usec / 1000000.0;
+
+    le_msg_DeleteSession(sessionRef);
+
+    LE_TEST_INFO("%-6s %6" PRIuS " bytes: %8.2f us per transaction, %8.1f MB/s",
+                 useShm ? "shm" : "socket",
+                 msgSize,
+                 seconds * 1000000.0 / Iterations,
+                 (2.0 * msgSize * Iterations) / (seconds * 1000000.0));
+    LE_TEST_OK(ok, "%s transactions with %" PRIuS " byte messages",
+               useShm ? "shared memory" : "socket", msgSize);
+}
+
+COMPONENT_INIT
+{
+    size_t i;
+
+    le_arg_SetIntVar(&Iterations, "n", "iterations");
+    le_arg_Scan();
+
+    LE_FATAL_IF(Iterations < 1, "Iterations must be at least 1");
+
+    LE_TEST_PLAN((int)(2 * NUM_SIZES));
+
+    ServerReadySem = le_sem_Create("ipcShmBenchReady", 0);
+    le_thread_Start(le_thread_Create("ipcShmBenchServer", ServerThreadMain, NULL));
+    le_sem_Wait(ServerReadySem);
+
+    for (i = 0; i < NUM_SIZES; i++)
+    {
+        RunOne(MsgSizes[i], false);
+        RunOne(MsgSizes[i], true);
+    }
+
+    LE_TEST_EXIT;
+}
@@ -0,0 +1,390 @@
+/**
+ * This module benchmarks the JSON parser.
+ *
+ * Usage: benchJson [-s <document size in KiB>] [-n <passes>]
+ *
+ * A document of objects holding strings (some long, some with escape sequences), numbers,
+ * constants and small arrays is generated and then parsed with event handlers from a C string,
+ * from a regular file and from a pipe fed by another thread, and parsed into a document in
+ * memory.  The throughput of each, in MiB/s, is reported, and the number of values found by each
+ * is checked against the number generated.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_SIZE_KIB        1024
+#define DEFAULT_PASSES          5
+
+static int SizeKiB = DEFAULT_SIZE_KIB;
+static int Passes = DEFAULT_PASSES;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ways the document is fed to the parser, in the order they are run.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SOURCE_STRING,
+    SOURCE_FILE,
+    SOURCE_PIPE,
+    SOURCE_DOC,
+    SOURCE_COUNT
+}
+Source_t;
+
+static const char* SourceNames[SOURCE_COUNT] = { "string", "file", "pipe", "doc" };
+
+static char* DocPtr;            ///< Generated document.
+static size_t DocLength;        ///< Length of the generated document.
+static size_t NumValues;        ///< Number of values (including objects and arrays) generated.
+
+static Source_t Source;         ///< Source being run.
+static int Pass;                ///< Pass being run.
+static size_t ValueCount;       ///< Number of values reported by the parser in this pass.
+static int Fd = -1;             ///< File descriptor being parsed, or -1.
+static le_thread_Ref_t WriterThread;    ///< Thread feeding the pipe, or NULL.
+static le_clk_Time_t StartTime; ///< Start of this source's passes.
+static bool IsCountOk;          ///< Whether the value counts of all passes were right.
+
+static void StartPass(void* param1Ptr, void* param2Ptr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append text to the document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Append
+(
+    size_t* capacityPtr,
+    const char* format,
+    ...
+)
+{
+    va_list args;
+
+    for (;;)
+    {
+        va_start(args, format);
+        int length = vsnprintf(DocPtr + DocLength, *capacityPtr - DocLength, format, args);
+        va_end(args);
+
+        LE_ASSERT(length >= 0);
+        if (DocLength + length < *capacityPtr)
+        {
+            DocLength += length;
+            return;
+        }
+
+        *capacityPtr *= 2;
+        DocPtr = realloc(DocPtr, *capacityPtr);
+        LE_ASSERT(DocPtr != NULL);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Generate
+(
+    void
+)
+{
+    size_t capacity = SizeKiB * 1024 + 4096;
+    char longString[201];
+    int i;
+
+    for (i = 0; i < (int)sizeof(longString) - 1; i++)
+    {
+        longString[i] = 'a' + (i % 26);
+    }
+    longString[sizeof(longString) - 1] = '\0';
+
+    DocPtr = malloc(capacity);
+    LE_ASSERT(DocPtr != NULL);
+    DocLength = 0;
+
+    Append(&capacity, "[\n");
+    NumValues = 1;
+
+    for (i = 0; DocLength < (size_t)SizeKiB * 1024; i++)
+    {
+        Append(&capacity,
+               "%s    {\n"
+               "        \"id\": %d,\n"
+               "        \"name\": \"item number %d\",\n"
+               "        \"ratio\": %.6f,\n"
+               "        \"enabled\": %s,\n"
+               "        \"parent\": null,\n"
+               "        \"path\": \"\\/usr\\/local\\/item\\t%d\\n\",\n"
+               "        \"description\": \"%s\",\n"
+               "        \"tags\": [1, 2.5, -300, \"x\"]\n"
+               "    }",
+               (i == 0) ? "" : ",\n",
+               i,
+               i,
+               i / 7.0,
+               (i % 2) ? "true" : "false",
+               i,
+               (i % 4) ? "short" : longString);
+
+        // The object, its 8 members and the 4 elements of its array.
+        NumValues += 1 + 8 + 4;
+    }
+
+    Append(&capacity, "\n]\n");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the values in a parsed document.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountValues
+(
+    le_json_DocRef_t doc,
+    le_json_Value_t value
+)
+{
+    size_t count = 1;
+    le_json_Value_t child;
+
+    for (child = le_json_GetFirstChild(doc, value);
+         child != LE_JSON_NO_VALUE;
+         child = le_json_GetNextSibling(doc, child))
+    {
+        count += CountValues(doc, child);
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Feed the document into a pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WriterThreadMain
+(
+    void* contextPtr
+)
+{
+    int fd = (int)(intptr_t)contextPtr;
+    size_t written = 0;
+
+    while (written < DocLength)
+    {
+        ssize_t result = write(fd, DocPtr + written, DocLength - written);
+
+        if (result < 0)
+        {
+            LE_ASSERT(errno == EINTR);
+        }
+        else
+        {
+            written += result;
+        }
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the results of a source's passes and start the next source.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndSource
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+    double sec = elapsed.sec + elapsed.usec / 1000000.0;
+    double mibPerSec = (sec > 0) ? (double)DocLength * Passes / (1024 * 1024) / sec : 0;
+
+    LE_TEST_INFO("%-6s %8.2f MiB/s (%d passes of %" PRIuS " bytes in %.3f s)",
+                 SourceNames[Source], mibPerSec, Passes, DocLength, sec);
+    LE_TEST_OK(IsCountOk, "%s: found all %" PRIuS " values", SourceNames[Source], NumValues);
+
+    Source++;
+    Pass = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish a pass and start the next one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndPass
+(
+    void
+)
+{
+    if (ValueCount != NumValues)
+    {
+        LE_TEST_INFO("%s pass %d found %" PRIuS " values", SourceNames[Source], Pass, ValueCount);
+        IsCountOk = false;
+    }
+
+    if (WriterThread != NULL)
+    {
+        le_thread_Join(WriterThread, NULL);
+        WriterThread = NULL;
+    }
+    if (Fd >= 0)
+    {
+        close(Fd);
+        Fd = -1;
+    }
+
+    Pass++;
+    if (Pass == Passes)
+    {
+        EndSource();
+    }
+
+    le_event_QueueFunction(StartPass, NULL, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the values reported by the parser.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OnEvent
+(
+    le_json_Event_t event
+)
+{
+    switch (event)
+    {
+        case LE_JSON_OBJECT_START:
+        case LE_JSON_ARRAY_START:
+        case LE_JSON_STRING:
+        case LE_JSON_NUMBER:
+        case LE_JSON_TRUE:
+        case LE_JSON_FALSE:
+        case LE_JSON_NULL:
+            ValueCount++;
+            break;
+
+        case LE_JSON_DOC_END:
+            le_json_Cleanup(le_json_GetSession());
+            EndPass();
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parsing errors are fatal to the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OnError
+(
+    le_json_Error_t error,
+    const char* msg
+)
+{
+    LE_TEST_FATAL("Parse error (%d) from %s: %s", error, SourceNames[Source], msg);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a pass.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPass
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    char path[] = "/tmp/benchJsonXXXXXX";
+    char errorMsg[128];
+    int fds[2];
+
+    (void)param1Ptr;
+    (void)param2Ptr;
+
+    if (Pass == 0)
+    {
+        StartTime = le_clk_GetRelativeTime();
+        IsCountOk = true;
+    }
+    ValueCount = 0;
+
+    switch (Source)
+    {
+        case SOURCE_STRING:
+            le_json_ParseString(DocPtr, OnEvent, OnError, NULL);
+            break;
+
+        case SOURCE_FILE:
+            Fd = mkstemp(path);
+            LE_ASSERT(Fd >= 0);
+            unlink(path);
+            LE_ASSERT(write(Fd, DocPtr, DocLength) == (ssize_t)DocLength);
+            LE_ASSERT(lseek(Fd, 0, SEEK_SET) == 0);
+            le_json_Parse(Fd, OnEvent, OnError, NULL);
+            break;
+
+        case SOURCE_PIPE:
+            LE_ASSERT(pipe(fds) == 0);
+            LE_ASSERT(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+            Fd = fds[0];
+            WriterThread = le_thread_Create("jsonWriter", WriterThreadMain,
+                                            (void*)(intptr_t)fds[1]);
+            le_thread_SetJoinable(WriterThread);
+            le_thread_Start(WriterThread);
+            le_json_Parse(Fd, OnEvent, OnError, NULL);
+            break;
+
+        case SOURCE_DOC:
+        {
+            le_json_DocRef_t doc = le_json_ParseDoc(DocPtr, DocLength, errorMsg, sizeof(errorMsg));
+
+            if (doc == NULL)
+            {
+                LE_TEST_FATAL("Parse error from doc: %s", errorMsg);
+            }
+            ValueCount = CountValues(doc, le_json_GetRoot(doc));
+            le_json_DeleteDoc(doc);
+            EndPass();
+            break;
+        }
+
+        default:
+            free(DocPtr);
+            LE_TEST_EXIT;
+    }
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&SizeKiB, "s", "size");
+    le_arg_SetIntVar(&Passes, "n", "passes");
+    le_arg_Scan();
+
+    LE_ASSERT((SizeKiB > 0) && (Passes > 0));
+
+    LE_TEST_PLAN(SOURCE_COUNT);
+
+    Generate();
+    LE_TEST_INFO("Generated %" PRIuS " byte document with %" PRIuS " values",
+                 DocLength, NumValues);
+
+    Source = SOURCE_STRING;
+    Pass = 0;
+    le_event_QueueFunction(StartPass, NULL, NULL);
+}
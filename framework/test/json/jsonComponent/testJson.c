@@ -49,7 +49,29 @@ static struct JsonExpectation Expected[] =
     { LE_JSON_OBJECT_END,       NULL,       0 }
 };
 
+/// Data written after the document, which must be left unread by the parser.
+static const char *Trailer = "TRAILER";
+
+/// What is left to read after the document: the newline that ends it, then the trailer.
+static const char *Leftover = "\nTRAILER";
+
+/// Ways the document is fed to the parser, in the order they are tested.
+typedef enum
+{
+    SOURCE_STRING,
+    SOURCE_PIPE,
+    SOURCE_FILE,
+    SOURCE_COUNT
+}
+Source_t;
+
+static const char *SourceNames[SOURCE_COUNT] = { "string", "pipe", "file" };
+
 static size_t TestIndex;
+static Source_t Source;
+static int Fd = -1;
+
+static void StartParsing(void *param1Ptr, void *param2Ptr);
 
 static void OnEvent
 (
@@ -69,8 +91,21 @@ static void OnEvent
         LE_TEST_OK(session != NULL, "Got session");
 
         le_json_Cleanup(session);
-        LE_TEST_INFO("======== END SUCCESSFUL JSON TEST ========");
-        LE_TEST_EXIT;
+
+        if (Fd >= 0)
+        {
+            char leftover[16] = "";
+            ssize_t length = read(Fd, leftover, sizeof(leftover) - 1);
+
+            LE_TEST_OK((length == (ssize_t)strlen(Leftover)) &&
+                (strncmp(leftover, Leftover, length) == 0),
+                "Data after document left unread (%" PRIdS " bytes)", length);
+            close(Fd);
+            Fd = -1;
+        }
+
+        Source++;
+        le_event_QueueFunction(StartParsing, NULL, NULL);
         return;
     }
 
@@ -109,13 +144,172 @@ static void OnError
     LE_TEST_FATAL("Parse error (%d): %s", error, msg);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the document followed by the trailer to a file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteDocument
+(
+    int fd
+)
+{
+    LE_ASSERT(write(fd, StaticJson, strlen(StaticJson)) == (ssize_t)strlen(StaticJson));
+    LE_ASSERT(write(fd, Trailer, strlen(Trailer)) == (ssize_t)strlen(Trailer));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that documents parsed into memory can be walked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestParsedDocuments
+(
+    void
+)
+{
+    char                errorMsg[128];
+    le_json_DocRef_t    doc;
+    le_json_Value_t     root;
+    le_json_Value_t     value;
+
+    LE_TEST_INFO("Parsed documents");
+
+    doc = le_json_ParseDoc(StaticJson, strlen(StaticJson), errorMsg, sizeof(errorMsg));
+    LE_TEST_ASSERT(doc != NULL, "Parsed document");
+
+    root = le_json_GetRoot(doc);
+    LE_TEST_OK(le_json_GetValueType(doc, root) == LE_JSON_CONTEXT_OBJECT, "Root is an object");
+    LE_TEST_OK(le_json_GetChildCount(doc, root) == 3, "Root has 3 members");
+
+    value = le_json_GetFirstChild(doc, root);
+    LE_TEST_OK(strcmp(le_json_GetMemberName(doc, value), "one") == 0, "First member is 'one'");
+    LE_TEST_OK(le_json_GetNumberValue(doc, value) == 1, "Member 'one' is 1");
+
+    value = le_json_GetNextSibling(doc, value);
+    LE_TEST_OK(le_json_GetValueType(doc, value) == LE_JSON_CONTEXT_ARRAY &&
+        le_json_GetChildCount(doc, value) == 2, "Member 'two' is an array of 2 elements");
+    LE_TEST_OK(le_json_GetMemberName(doc, le_json_GetFirstChild(doc, value)) == NULL,
+        "Array elements have no name");
+
+    value = le_json_FindMember(doc, root, "three");
+    LE_TEST_OK(le_json_GetNextSibling(doc, value) == LE_JSON_NO_VALUE, "'three' is last");
+    LE_TEST_OK(le_json_GetNumberValue(doc, le_json_FindMember(doc, value, "3")) == 3.3,
+        "Found member '3'");
+    LE_TEST_OK(le_json_GetValueType(doc, le_json_FindMember(doc, value, "III")) ==
+        LE_JSON_CONTEXT_NULL, "Found member 'III'");
+    LE_TEST_OK(le_json_GetValueType(doc, le_json_FindMember(doc, value, "trois")) ==
+        LE_JSON_CONTEXT_TRUE, "Found member 'trois'");
+    LE_TEST_OK(strcmp(le_json_GetStringValue(doc, le_json_FindMember(doc, value, "tres")),
+        "\"three\"") == 0, "Found member 'tres'");
+    LE_TEST_OK(le_json_FindMember(doc, value, "four") == LE_JSON_NO_VALUE, "No member 'four'");
+
+    le_json_DeleteDoc(doc);
+
+    static const char *escaped = "[\"\\u00e9\\ud83d\\ude00\\t\\/\", {}, []]";
+    doc = le_json_ParseDoc(escaped, strlen(escaped), errorMsg, sizeof(errorMsg));
+    LE_TEST_ASSERT(doc != NULL, "Parsed document with escapes");
+    value = le_json_GetFirstChild(doc, le_json_GetRoot(doc));
+    LE_TEST_OK(strcmp(le_json_GetStringValue(doc, value), "\xc3\xa9\xf0\x9f\x98\x80\t/") == 0,
+        "Escapes decoded");
+    value = le_json_GetNextSibling(doc, value);
+    LE_TEST_OK(le_json_GetFirstChild(doc, value) == LE_JSON_NO_VALUE, "Empty object");
+    LE_TEST_OK(le_json_GetChildCount(doc, le_json_GetNextSibling(doc, value)) == 0,
+        "Empty array");
+    le_json_DeleteDoc(doc);
+
+    static const char *badDocs[] =
+    {
+        "",
+        "1",
+        "{\"a\":1,}",
+        "[1 2]",
+        "[\"\\u0000\"]",
+        "[\"unterminated]",
+        "[tru]",
+        "{} {}",
+    };
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(badDocs); i++)
+    {
+        errorMsg[0] = '\0';
+        doc = le_json_ParseDoc(badDocs[i], strlen(badDocs[i]), errorMsg, sizeof(errorMsg));
+        LE_TEST_OK(doc == NULL && errorMsg[0] != '\0', "Rejected '%s': %s", badDocs[i],
+            errorMsg);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the document from the next source.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartParsing
+(
+    void *param1Ptr,
+    void *param2Ptr
+)
+{
+    int fds[2];
+    char path[] = "/tmp/testJsonXXXXXX";
+
+    (void)param1Ptr;
+    (void)param2Ptr;
+
+    TestIndex = 0;
+
+    switch (Source)
+    {
+        case SOURCE_STRING:
+            break;
+
+        case SOURCE_PIPE:
+            LE_ASSERT(pipe(fds) == 0);
+            WriteDocument(fds[1]);
+            close(fds[1]);
+            Fd = fds[0];
+            break;
+
+        case SOURCE_FILE:
+            Fd = mkstemp(path);
+            LE_ASSERT(Fd >= 0);
+            unlink(path);
+            WriteDocument(Fd);
+            LE_ASSERT(lseek(Fd, 0, SEEK_SET) == 0);
+            break;
+
+        default:
+            TestParsedDocuments();
+            LE_TEST_INFO("======== END SUCCESSFUL JSON TEST ========");
+            LE_TEST_EXIT;
+            return;
+    }
+
+    LE_TEST_INFO("Parsing from %s", SourceNames[Source]);
+
+    if (Fd >= 0)
+    {
+        LE_TEST_OK(le_json_Parse(Fd, &OnEvent, &OnError, NULL) != NULL, "Created parser");
+    }
+    else
+    {
+        LE_TEST_OK(le_json_ParseString(StaticJson, &OnEvent, &OnError, NULL) != NULL,
+            "Created parser");
+    }
+}
+
 COMPONENT_INIT
 {
-    int testCount = NUM_ARRAY_MEMBERS(Expected) * 3 + 3;
+    // Each source: each event checked 3 times, plus the parser, event count and session checks.
+    // Each file descriptor source also checks the data after the document.  Then the parsed
+    // document checks.
+    int testCount = (NUM_ARRAY_MEMBERS(Expected) * 3 + 3) * SOURCE_COUNT + (SOURCE_COUNT - 1) +
+        17 + 8;
 
     LE_TEST_INFO("======== BEGIN JSON TEST ========");
-    TestIndex = 0;
+    Source = SOURCE_STRING;
     LE_TEST_PLAN(testCount);
 
-    LE_TEST_OK(le_json_ParseString(StaticJson, &OnEvent, &OnError, NULL) != NULL, "Created parser");
+    StartParsing(NULL, NULL);
 }
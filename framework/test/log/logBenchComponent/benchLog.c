@@ -0,0 +1,219 @@
+/**
+ * This module benchmarks the cost of logging an info message to the caller.
+ *
+ * Usage: benchLog [-b <bursts>] [-n <messages per burst>]
+ *
+ * Bursts of LE_INFO() calls with a few integer and string arguments are made, with a pause between
+ * bursts, and the time of each call is measured.  The calls per second, and the mean, median,
+ * 99th percentile and longest call are reported.
+ *
+ * When the framework is built with LOG_BINARY_RING, messages are written into the process's
+ * binary log ring, so the benchmark is run once in this process and once in a forked child, which
+ * doesn't use the ring and logs every message directly.  The child reports its results to the
+ * parent over a pipe.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_BURSTS          100
+#define DEFAULT_BURST_SIZE      100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pause between bursts, long enough for the Log Control Daemon to drain the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BURST_PAUSE_MS          100
+
+static int Bursts = DEFAULT_BURSTS;
+static int BurstSize = DEFAULT_BURST_SIZE;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Results of a run.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double callsPerSec;     ///< Calls per second, over the time spent logging.
+    double meanUsec;        ///< Mean time of a call.
+    double medianUsec;      ///< Median time of a call.
+    double p99Usec;         ///< 99th percentile time of a call.
+    double maxUsec;         ///< Longest call.
+}
+Results_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of microseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ElapsedUsec
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000.0 + elapsed.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two call times, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareUsec
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    double a = *(const double*)aPtr;
+    double b = *(const double*)bPtr;
+
+    return (a > b) - (a < b);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Log the bursts of messages, timing each call.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Run
+(
+    const char* pathPtr,        ///< [IN] Name of the logging path being measured.
+    Results_t* resultsPtr       ///< [OUT] Results.
+)
+{
+    int count = Bursts * BurstSize;
+    double* usecPtr = malloc(count * sizeof(double));
+    double totalUsec = 0;
+    int i, j;
+
+    LE_ASSERT(usecPtr != NULL);
+
+    for (i = 0; i < Bursts; i++)
+    {
+        for (j = 0; j < BurstSize; j++)
+        {
+            le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+            LE_INFO("%s burst %d message %d: value 0x%08x, ratio %.3f, name '%s'",
+                    pathPtr, i, j, (unsigned int)(i * j), (double)j / BurstSize, "benchLog");
+
+            usecPtr[i * BurstSize + j] = ElapsedUsec(startTime);
+            totalUsec += usecPtr[i * BurstSize + j];
+        }
+
+        usleep(BURST_PAUSE_MS * 1000);
+    }
+
+    qsort(usecPtr, count, sizeof(double), CompareUsec);
+
+    resultsPtr->callsPerSec = (totalUsec > 0) ? count * 1000000.0 / totalUsec : 0;
+    resultsPtr->meanUsec = totalUsec / count;
+    resultsPtr->medianUsec = usecPtr[count / 2];
+    resultsPtr->p99Usec = usecPtr[(int)(count * 0.99)];
+    resultsPtr->maxUsec = usecPtr[count - 1];
+
+    free(usecPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the results of a run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const char* pathPtr,
+    const Results_t* resultsPtr
+)
+{
+    LE_TEST_INFO("%-6s %9.0f calls/s, mean %6.2f us, median %6.2f us, p99 %7.2f us, max %8.2f us",
+                 pathPtr,
+                 resultsPtr->callsPerSec,
+                 resultsPtr->meanUsec,
+                 resultsPtr->medianUsec,
+                 resultsPtr->p99Usec,
+                 resultsPtr->maxUsec);
+}
+
+#if LE_CONFIG_LOG_BINARY_RING
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the benchmark in a forked child, which logs directly.
+ *
+ * @return true if the child's results were received.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RunDirect
+(
+    Results_t* resultsPtr       ///< [OUT] Results.
+)
+{
+    int fds[2];
+    int status;
+    bool ok;
+
+    LE_ASSERT(pipe(fds) == 0);
+
+    pid_t pid = fork();
+    LE_ASSERT(pid >= 0);
+
+    if (pid == 0)
+    {
+        Results_t results;
+
+        close(fds[0]);
+        Run("direct", &results);
+        _exit(write(fds[1], &results, sizeof(results)) == sizeof(results) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ok = (read(fds[0], resultsPtr, sizeof(*resultsPtr)) == sizeof(*resultsPtr));
+    close(fds[0]);
+
+    ok = (waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == 0) && ok;
+
+    return ok;
+}
+#endif
+
+COMPONENT_INIT
+{
+    Results_t results;
+
+    le_arg_SetIntVar(&Bursts, "b", "bursts");
+    le_arg_SetIntVar(&BurstSize, "n", "burst-size");
+    le_arg_Scan();
+
+    LE_ASSERT((Bursts > 0) && (BurstSize > 0));
+
+#if LE_CONFIG_LOG_BINARY_RING
+    LE_TEST_PLAN(2);
+
+    Run("ring", &results);
+    Report("ring", &results);
+    LE_TEST_OK(results.callsPerSec > 0, "ring");
+
+    bool ok = RunDirect(&results);
+    if (ok)
+    {
+        Report("direct", &results);
+    }
+    LE_TEST_OK(ok, "direct");
+#else
+    LE_TEST_PLAN(1);
+
+    Run("direct", &results);
+    Report("direct", &results);
+    LE_TEST_OK(results.callsPerSec > 0, "direct");
+#endif
+
+    LE_TEST_EXIT;
+}
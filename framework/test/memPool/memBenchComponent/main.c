@@ -0,0 +1,172 @@
+ /**
+  * This module benchmarks le_mem allocation and release throughput when several threads share
+  * a memory pool, with and without per-thread caches.
+  *
+  * Usage: benchMemPool [-t <maxThreads>] [-n <iterations per thread>]
+  *
+  * For every thread count from 1 to maxThreads, each thread repeatedly allocates a burst of
+  * objects from the pool and releases them again.  The aggregate number of alloc/release pairs
+  * per second is reported for a plain pool and for a pool with a thread cache enabled (which is
+  * the same as the plain pool unless the MEM_THREAD_CACHE KConfig option is enabled).
+  *
+  * Copyright (C) Sierra Wireless Inc.
+  */
+
+#include "legato.h"
+
+#define DEFAULT_MAX_THREADS     8
+#define DEFAULT_ITERATIONS      200000
+#define MAX_THREADS             64
+#define BURST_SIZE              16
+#define THREAD_CACHE_SIZE       32
+#define OBJECT_SIZE             64
+
+static int MaxThreads = DEFAULT_MAX_THREADS;
+static int Iterations = DEFAULT_ITERATIONS;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore that the worker threads wait on so they all start at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t StartSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread: allocates and releases bursts of objects from the pool passed as context.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerThread
+(
+    void* contextPtr
+)
+{
+    le_mem_PoolRef_t pool = contextPtr;
+    void* objPtr[BURST_SIZE];
+    int i, j;
+
+    le_sem_Wait(StartSem);
+
+    for (i = 0; i < Iterations; i += BURST_SIZE)
+    {
+        for (j = 0; j < BURST_SIZE; j++)
+        {
+            objPtr[j] = le_mem_ForceAlloc(pool);
+            *(uint32_t*)objPtr[j] = j;
+        }
+        for (j = 0; j < BURST_SIZE; j++)
+        {
+            le_mem_Release(objPtr[j]);
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs one benchmark pass with a given number of threads.
+ *
+ * @return Number of alloc/release pairs per second, summed over all threads.
+ */
+//--------------------------------------------------------------------------------------------------
+static double RunPass
+(
+    le_mem_PoolRef_t pool,
+    int numThreads
+)
+{
+    le_thread_Ref_t threads[MAX_THREADS];
+    char name[32];
+    int i;
+
+    for (i = 0; i < numThreads; i++)
+    {
+        snprintf(name, sizeof(name), "memBench%d", i);
+        threads[i] = le_thread_Create(name, WorkerThread, pool);
+        le_thread_SetJoinable(threads[i]);
+        le_thread_Start(threads[i]);
+    }
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    for (i = 0; i < numThreads; i++)
+    {
+        le_sem_Post(StartSem);
+    }
+    for (i = 0; i < numThreads; i++)
+    {
+        le_thread_Join(threads[i], NULL);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+    double seconds = elapsed.sec + elapsed.usec / 1000000.0;
+
+    return ((double)numThreads * Iterations) / seconds;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the benchmark for 1 to MaxThreads threads on a pool and checks the pool statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunBenchmark
+(
+    le_mem_PoolRef_t pool,
+    const char* label
+)
+{
+    le_mem_PoolStats_t stats;
+    double baseline = 0;
+    int numThreads;
+
+    for (numThreads = 1; numThreads <= MaxThreads; numThreads++)
+    {
+        le_mem_ResetStats(pool);
+
+        double opsPerSec = RunPass(pool, numThreads);
+        if (numThreads == 1)
+        {
+            baseline = opsPerSec;
+        }
+
+        LE_TEST_INFO("%s: %2d thread(s): %12.0f alloc/release per sec (x%.2f)",
+                     label, numThreads, opsPerSec, opsPerSec / baseline);
+
+        le_mem_GetStats(pool, &stats);
+        LE_TEST_OK(stats.numBlocksInUse == 0, "%s: no blocks in use after %d thread(s)",
+                   label, numThreads);
+        LE_TEST_BEGIN_SKIP(!LE_CONFIG_IS_ENABLED(LE_CONFIG_MEM_POOL_STATS), 1);
+        LE_TEST_OK(stats.numAllocs == (uint64_t)numThreads * (Iterations / BURST_SIZE) * BURST_SIZE,
+                   "%s: allocation count is %" PRIu64, label, stats.numAllocs);
+        LE_TEST_END_SKIP();
+    }
+}
+
+COMPONENT_INIT
+{
+    le_mem_PoolRef_t plainPool, cachedPool;
+
+    le_arg_SetIntVar(&MaxThreads, "t", "threads");
+    le_arg_SetIntVar(&Iterations, "n", "iterations");
+    le_arg_Scan();
+
+    LE_TEST_PLAN(LE_TEST_NO_PLAN);
+
+    LE_FATAL_IF((MaxThreads < 1) || (MaxThreads > MAX_THREADS),
+                "Thread count must be between 1 and %d", MAX_THREADS);
+
+    StartSem = le_sem_Create("memBenchStart", 0);
+
+    plainPool = le_mem_CreatePool("Plain Pool", OBJECT_SIZE);
+    le_mem_ExpandPool(plainPool, BURST_SIZE * MaxThreads);
+
+    cachedPool = le_mem_CreatePool("Cached Pool", OBJECT_SIZE);
+    le_mem_ExpandPool(cachedPool, (BURST_SIZE + 2 * THREAD_CACHE_SIZE) * MaxThreads);
+    le_mem_EnableThreadCache(cachedPool, THREAD_CACHE_SIZE);
+
+    RunBenchmark(plainPool, "shared free list");
+    RunBenchmark(cachedPool, "thread cache");
+
+    LE_TEST_EXIT;
+}
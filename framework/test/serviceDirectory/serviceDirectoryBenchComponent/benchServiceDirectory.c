@@ -0,0 +1,376 @@
+/**
+ * This module benchmarks the Service Directory with a boot-time storm of session opens.
+ *
+ * Usage: benchServiceDirectory [-n <sessions>] [-c <client threads>] [-w <window>]
+ *                              [-s <services>]
+ *
+ * A server thread offers a set of stand-in services, and several client threads open sessions to
+ * them in the same process.  Each client thread keeps a window of session opens outstanding,
+ * spread over the services in turn, and closes each session as soon as it opens.  Every open
+ * goes through the Service Directory.  Two phases are timed:
+ *
+ *  - Storm: every client fills its window before the services are advertised, the way apps open
+ *    their sessions at start-up while their servers are still starting.  The time from the
+ *    advertisements to the last of these sessions opening is reported.
+ *  - Churn: the remaining sessions are opened and closed with the services available.  The open
+ *    rate and open latency percentiles are reported.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_SESSIONS        4000
+#define DEFAULT_CLIENTS         8
+#define DEFAULT_WINDOW          32
+#define MAX_CLIENTS             32
+#define MAX_WINDOW              64
+#define MAX_SESSIONS            100000
+
+/// The stand-in services, each bound to the client interface of the same name in the .adef.
+#define MAX_SERVICES            16
+#define SERVICE_NAME_PREFIX     "sdirBench"
+#define PROTOCOL_ID             "sdirBench"
+
+/// How long to let the clients' opens reach the Service Directory before advertising.
+#define STORM_SETTLE_USEC       200000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message payload.  No messages are sent, but the protocol needs a size.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    unused;
+}
+Msg_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An outstanding session open.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Client Client_t;
+
+typedef struct
+{
+    Client_t*           clientPtr;      ///< Client thread the open belongs to.
+    le_msg_SessionRef_t sessionRef;     ///< Session being opened.
+    le_clk_Time_t       startTime;      ///< When the open was started.
+    bool                isStorm;        ///< true if started before the services were advertised.
+}
+Open_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A client thread.  Only accessed by that thread, once it has started.
+ */
+//--------------------------------------------------------------------------------------------------
+struct Client
+{
+    int             toStart;            ///< Opens still to be started.
+    int             nextService;        ///< Service of the next open.
+    Open_t          opens[MAX_WINDOW];  ///< Window of outstanding opens.
+};
+
+static int NumSessions = DEFAULT_SESSIONS;
+static int NumClients = DEFAULT_CLIENTS;
+static int WindowSize = DEFAULT_WINDOW;
+static int NumServices = MAX_SERVICES;
+
+static le_msg_ProtocolRef_t ProtocolRef;
+static le_thread_Ref_t ServerThread;
+static Client_t Clients[MAX_CLIENTS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Posted by the server thread when its services are created, by the client threads when their
+ * window of opens has been started, when the sessions of the storm phase have opened, and when
+ * all of the sessions have opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t ReadySem;
+static le_sem_Ref_t StormSem;
+static le_sem_Ref_t DoneSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sessions opened so far, how many of them were started before the services were advertised,
+ * how many were, and the open latencies of the others, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenedCount;
+static int StormOpenedCount;
+static int StormCount;
+static int LatencyCount;
+static uint32_t LatencyUs[MAX_SESSIONS];
+
+static le_msg_ServiceRef_t Services[MAX_SERVICES];
+
+static void StartOpen(Open_t* openPtr, bool isStorm);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare function for sorting the latencies.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLatency
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    uint32_t a = *(const uint32_t*)aPtr;
+    uint32_t b = *(const uint32_t*)bPtr;
+
+    return (a > b) - (a < b);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the server thread.  Creates the services, but doesn't advertise them yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* contextPtr
+)
+{
+    char name[32];
+    int i;
+
+    for (i = 0; i < NumServices; i++)
+    {
+        snprintf(name, sizeof(name), SERVICE_NAME_PREFIX "%d", i);
+        Services[i] = le_msg_CreateService(ProtocolRef, name);
+    }
+
+    le_sem_Post(ReadySem);
+    le_event_RunLoop();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server side: advertise all the services.  Queued to the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AdvertiseServices
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    int i;
+
+    for (i = 0; i < NumServices; i++)
+    {
+        le_msg_AdvertiseService(Services[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: close a session that has opened and start the next open in its place.  Queued to
+ * the client thread by the open handler, so the session isn't deleted from inside its own handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseAndReopen
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    Open_t* openPtr = param1Ptr;
+
+    le_msg_CloseSession(openPtr->sessionRef);
+    le_msg_DeleteSession(openPtr->sessionRef);
+    openPtr->sessionRef = NULL;
+
+    if (openPtr->clientPtr->toStart > 0)
+    {
+        StartOpen(openPtr, false);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: a session has opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionOpenHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    Open_t* openPtr = contextPtr;
+
+    if (openPtr->isStorm)
+    {
+        if (__atomic_add_fetch(&StormOpenedCount, 1, __ATOMIC_RELAXED) == StormCount)
+        {
+            le_sem_Post(StormSem);
+        }
+    }
+    else
+    {
+        le_clk_Time_t latency = le_clk_Sub(le_clk_GetRelativeTime(), openPtr->startTime);
+        int index = __atomic_fetch_add(&LatencyCount, 1, __ATOMIC_RELAXED);
+
+        LatencyUs[index] = latency.sec * 1000000 + latency.usec;
+    }
+
+    if (__atomic_add_fetch(&OpenedCount, 1, __ATOMIC_RELAXED) == NumSessions)
+    {
+        le_sem_Post(DoneSem);
+    }
+
+    le_event_QueueFunction(CloseAndReopen, openPtr, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: a session was closed before it opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    LE_TEST_FATAL("Session closed by the Service Directory or the server");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client side: start opening a session to the client's next service.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartOpen
+(
+    Open_t* openPtr,
+    bool isStorm
+)
+{
+    Client_t* clientPtr = openPtr->clientPtr;
+    char name[32];
+
+    snprintf(name, sizeof(name), SERVICE_NAME_PREFIX "%d", clientPtr->nextService);
+    clientPtr->nextService = (clientPtr->nextService + 1) % NumServices;
+    clientPtr->toStart--;
+
+    openPtr->sessionRef = le_msg_CreateSession(ProtocolRef, name);
+    le_msg_SetSessionCloseHandler(openPtr->sessionRef, SessionCloseHandler, openPtr);
+    openPtr->startTime = le_clk_GetRelativeTime();
+    openPtr->isStorm = isStorm;
+    le_msg_OpenSession(openPtr->sessionRef, SessionOpenHandler, openPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a client thread.  Starts its window of opens.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ClientThreadMain
+(
+    void* contextPtr
+)
+{
+    Client_t* clientPtr = contextPtr;
+    int i;
+
+    for (i = 0; (i < WindowSize) && (clientPtr->toStart > 0); i++)
+    {
+        clientPtr->opens[i].clientPtr = clientPtr;
+        StartOpen(&clientPtr->opens[i], true);
+    }
+
+    le_sem_Post(ReadySem);
+    le_event_RunLoop();
+}
+
+COMPONENT_INIT
+{
+    char name[32];
+    int i;
+
+    le_arg_SetIntVar(&NumSessions, "n", "sessions");
+    le_arg_SetIntVar(&NumClients, "c", "clients");
+    le_arg_SetIntVar(&WindowSize, "w", "window");
+    le_arg_SetIntVar(&NumServices, "s", "services");
+    le_arg_Scan();
+
+    LE_TEST_PLAN(2);
+
+    LE_FATAL_IF((NumClients < 1) || (NumClients > MAX_CLIENTS),
+                "Client count must be between 1 and %d", MAX_CLIENTS);
+    LE_FATAL_IF((WindowSize < 1) || (WindowSize > MAX_WINDOW),
+                "Window must be between 1 and %d", MAX_WINDOW);
+    LE_FATAL_IF((NumServices < 1) || (NumServices > MAX_SERVICES),
+                "Service count must be between 1 and %d", MAX_SERVICES);
+    LE_FATAL_IF((NumSessions <= NumClients * WindowSize) || (NumSessions > MAX_SESSIONS),
+                "Session count must be more than %d and at most %d",
+                NumClients * WindowSize, MAX_SESSIONS);
+
+    StormCount = NumClients * WindowSize;
+
+    ProtocolRef = le_msg_GetProtocolRef(PROTOCOL_ID, sizeof(Msg_t));
+    ReadySem = le_sem_Create("sdirBenchReady", 0);
+    StormSem = le_sem_Create("sdirBenchStorm", 0);
+    DoneSem = le_sem_Create("sdirBenchDone", 0);
+
+    ServerThread = le_thread_Create("sdirBenchServer", ServerThreadMain, NULL);
+    le_thread_Start(ServerThread);
+    le_sem_Wait(ReadySem);
+
+    // Share out the sessions and start the clients.  Their opens wait in the Service Directory
+    // for the services to be advertised.
+    for (i = 0; i < NumClients; i++)
+    {
+        Clients[i].toStart = NumSessions / NumClients + (i < NumSessions % NumClients);
+        Clients[i].nextService = i % NumServices;
+
+        snprintf(name, sizeof(name), "sdirBenchClient%d", i);
+        le_thread_Start(le_thread_Create(name, ClientThreadMain, &Clients[i]));
+    }
+    for (i = 0; i < NumClients; i++)
+    {
+        le_sem_Wait(ReadySem);
+    }
+    usleep(STORM_SETTLE_USEC);
+
+    // Storm phase.
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_event_QueueFunctionToThread(ServerThread, AdvertiseServices, NULL, NULL);
+    le_sem_Wait(StormSem);
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    double seconds = elapsed.sec + elapsed.usec / 1000000.0;
+
+    LE_TEST_INFO("storm: %d sessions waiting for %d services opened in %.1f ms "
+                 "(%.0f sessions per sec)",
+                 StormCount, NumServices, seconds * 1000, StormCount / seconds);
+    LE_TEST_OK(true, "storm completed");
+
+    // Churn phase.  Some of its sessions have already opened while the storm was ending.
+    int startCount = __atomic_load_n(&LatencyCount, __ATOMIC_RELAXED);
+    startTime = le_clk_GetRelativeTime();
+    le_sem_Wait(DoneSem);
+
+    elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    seconds = elapsed.sec + elapsed.usec / 1000000.0;
+
+    int count = __atomic_load_n(&LatencyCount, __ATOMIC_RELAXED);
+    qsort(LatencyUs, count, sizeof(LatencyUs[0]), CompareLatency);
+
+    LE_TEST_INFO("churn: %d client(s), %d sessions, %10.0f sessions per sec",
+                 NumClients, count, (count - startCount) / seconds);
+    LE_TEST_INFO("churn: open latency p50 %" PRIu32 " us, p99 %" PRIu32 " us, max %" PRIu32 " us",
+                 LatencyUs[count / 2], LatencyUs[(count * 99) / 100], LatencyUs[count - 1]);
+    LE_TEST_OK(count == NumSessions - StormCount, "churn completed");
+
+    LE_TEST_EXIT;
+}
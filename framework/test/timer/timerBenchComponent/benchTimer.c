@@ -0,0 +1,220 @@
+/**
+ * This module benchmarks starting, restarting and stopping large numbers of le_timer timers on
+ * one thread, and checks that they still expire in order.
+ *
+ * Usage: benchTimer [-n <number of timers>]
+ *
+ * The per-operation latencies reported depend on the timer queue implementation selected in
+ * KConfig (sorted list or pairing heap).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define DEFAULT_NUM_TIMERS      100000
+#define NUM_EXPIRY_TIMERS       1000
+#define EXPIRY_SPREAD_MS        500
+
+static int NumTimers = DEFAULT_NUM_TIMERS;
+
+static le_timer_Ref_t* Timers;
+static size_t* Order;
+
+static le_timer_Ref_t ExpiryTimers[NUM_EXPIRY_TIMERS];
+static int NumExpired = 0;
+static int NumOutOfOrder = 0;
+static le_clk_Time_t LastExpiry = { 0, 0 };
+static const le_clk_Time_t ExpiryTolerance = { 0, 1000 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shuffle the order in which the benchmark timers are operated on.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Shuffle
+(
+    void
+)
+{
+    size_t i;
+
+    for (i = NumTimers - 1; i > 0; i--)
+    {
+        size_t j = (size_t)rand() % (i + 1);
+        size_t temp = Order[i];
+        Order[i] = Order[j];
+        Order[j] = temp;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the average time per operation since a given start time, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double NsPerOp
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return ((elapsed.sec * 1000000.0) + elapsed.usec) * 1000.0 / NumTimers;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time starting, restarting and stopping all of the benchmark timers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunBenchmark
+(
+    void
+)
+{
+    le_clk_Time_t start;
+    int i;
+    int numRunning = 0;
+
+    // Long, spread-out intervals so that none of them expire during the benchmark.
+    for (i = 0; i < NumTimers; i++)
+    {
+        Timers[i] = le_timer_Create("bench");
+        LE_ASSERT_OK(le_timer_SetMsInterval(Timers[i], 1000000 + (rand() % 1000000)));
+        Order[i] = i;
+    }
+
+    Shuffle();
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NumTimers; i++)
+    {
+        LE_ASSERT_OK(le_timer_Start(Timers[Order[i]]));
+    }
+    LE_TEST_INFO("start:   %10.1f ns/op (%d timers)", NsPerOp(start), NumTimers);
+
+    Shuffle();
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NumTimers; i++)
+    {
+        le_timer_Restart(Timers[Order[i]]);
+    }
+    LE_TEST_INFO("restart: %10.1f ns/op (%d timers)", NsPerOp(start), NumTimers);
+
+    for (i = 0; i < NumTimers; i++)
+    {
+        numRunning += le_timer_IsRunning(Timers[i]);
+    }
+    LE_TEST_OK(numRunning == NumTimers, "all %d timers running", numRunning);
+
+    Shuffle();
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < NumTimers; i++)
+    {
+        LE_ASSERT_OK(le_timer_Stop(Timers[Order[i]]));
+    }
+    LE_TEST_INFO("stop:    %10.1f ns/op (%d timers)", NsPerOp(start), NumTimers);
+
+    for (i = 0; i < NumTimers; i++)
+    {
+        le_timer_Delete(Timers[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expiry handler for the ordering test.  Each timer's context is its expected expiry time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpiryHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    le_clk_Time_t* expiryPtr = le_timer_GetContextPtr(timerRef);
+
+    // Expected expiry times are measured around the calls that started the timers, so allow for
+    // a little slack between timers due at (almost) the same time.
+    if (le_clk_GreaterThan(le_clk_Sub(LastExpiry, ExpiryTolerance), *expiryPtr))
+    {
+        NumOutOfOrder++;
+    }
+    if (le_clk_GreaterThan(*expiryPtr, LastExpiry))
+    {
+        LastExpiry = *expiryPtr;
+    }
+
+    if (++NumExpired == NUM_EXPIRY_TIMERS)
+    {
+        LE_TEST_OK(NumOutOfOrder == 0, "%d timers expired, %d out of order",
+                   NumExpired, NumOutOfOrder);
+        LE_TEST_EXIT;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a timer for the ordering test and record when it is expected to expire.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartExpiryTimer
+(
+    le_timer_Ref_t timerRef,
+    le_clk_Time_t* expiryPtr
+)
+{
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+    *expiryPtr = le_clk_Add(le_clk_GetRelativeTime(), le_timer_GetInterval(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a set of short timers, stopping some and restarting others, and check that they expire
+ * in order of their expiry times.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartExpiryTest
+(
+    void
+)
+{
+    static le_clk_Time_t expiryTimes[NUM_EXPIRY_TIMERS];
+    int i;
+
+    for (i = 0; i < NUM_EXPIRY_TIMERS; i++)
+    {
+        ExpiryTimers[i] = le_timer_Create("expiry");
+        LE_ASSERT_OK(le_timer_SetMsInterval(ExpiryTimers[i], 1 + (rand() % EXPIRY_SPREAD_MS)));
+        LE_ASSERT_OK(le_timer_SetHandler(ExpiryTimers[i], ExpiryHandler));
+        LE_ASSERT_OK(le_timer_SetContextPtr(ExpiryTimers[i], &expiryTimes[i]));
+        StartExpiryTimer(ExpiryTimers[i], &expiryTimes[i]);
+    }
+
+    // Stop and restart every third timer, so it is removed from the middle of the queue.
+    for (i = 0; i < NUM_EXPIRY_TIMERS; i += 3)
+    {
+        LE_ASSERT_OK(le_timer_Stop(ExpiryTimers[i]));
+        StartExpiryTimer(ExpiryTimers[i], &expiryTimes[i]);
+    }
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&NumTimers, "n", "num-timers");
+    le_arg_Scan();
+
+    LE_TEST_PLAN(2);
+    LE_FATAL_IF(NumTimers < 1, "Number of timers must be positive");
+
+    Timers = calloc(NumTimers, sizeof(*Timers));
+    Order = calloc(NumTimers, sizeof(*Order));
+    LE_ASSERT((Timers != NULL) && (Order != NULL));
+
+    srand(1);
+    RunBenchmark();
+
+    free(Timers);
+    free(Order);
+
+    StartExpiryTest();
+}
@@ -0,0 +1,497 @@
+/**
+ * This module benchmarks unpacking an update pack's tarball.
+ *
+ * Usage: benchUnpack [-s <update size in MiB>] [-d <work directory>]
+ *
+ * A tree of files the size of a system update, partly compressible and partly not, is generated
+ * in the work directory and packed into a bzip2 tarball (and LZ4 and zstd tarballs, if the update
+ * daemon was built to support them and the lz4 and zstd tools are installed).  Each tarball is
+ * then unpacked the way the update daemon used to, by feeding it through a pipe to a forked
+ * "tar xj", and the way it does now, in-process with the MD5 hash of the tarball computed on the
+ * way.  Every unpack
+ * runs in a child process, so the wall clock time, CPU time and peak resident set size of the
+ * largest process involved are reported for each, along with those of a child that does nothing.
+ * The unpacked trees are checked against the generated one.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "md5.h"
+#include "untar.h"
+
+#include <ftw.h>
+#include <sys/resource.h>
+
+#define DEFAULT_SIZE_MIB        50
+#define DEFAULT_WORK_DIR        "/tmp/benchUnpack"
+
+/// Number of bytes the update daemon reads from the update pack at a time.
+#define READ_BYTES              (16 * 1024)
+
+/// Number of bytes the update daemon used to copy to the tar pipeline at a time.
+#define PIPE_WRITE_BYTES        1024
+
+/// Size of the buffers holding the paths of the work directory's contents.
+#define PATH_BYTES              256
+
+static int SizeMiB = DEFAULT_SIZE_MIB;
+static const char* WorkDir = DEFAULT_WORK_DIR;
+
+static char SrcDir[PATH_BYTES];     ///< Generated tree.
+static char DestDir[PATH_BYTES];    ///< Where the tarballs are unpacked.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tarballs, in the order they are unpacked.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    const char* name;           ///< Compression name.
+    const char* compressCmd;    ///< Shell command that compresses stdin to stdout.
+}
+Packs[] =
+{
+    { "bzip2", "bzip2 -c" },
+#if LE_CONFIG_UPDATE_PACK_LZ4
+    { "lz4", "lz4 -q -c -9" },
+#endif
+#if LE_CONFIG_UPDATE_PACK_ZSTD
+    { "zstd", "zstd -q -c -12" },
+#endif
+};
+
+#define NUM_PACKS   NUM_ARRAY_MEMBERS(Packs)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Results of an unpack.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double wallSec;         ///< Wall clock time.
+    double cpuSec;          ///< User + system CPU time of the child and its children.
+    long maxRssKiB;         ///< Peak resident set size of the largest process.
+}
+Results_t;
+
+/// File count and total size of the tree being walked by CountFile().
+static size_t TreeFiles;
+static uint64_t TreeBytes;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double Now
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return now.sec + now.usec / 1000000.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a buffer with pseudo-random bytes.  Some blocks are random, some are text-like (a small
+ * alphabet), and some are zeros, which compresses roughly like a system update does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillBuffer
+(
+    uint8_t* bufferPtr,
+    size_t length,
+    uint32_t* seedPtr
+)
+{
+    static const char alphabet[] = "etaoin shrdlucmfwypvbgkqjxz_();{}\n";
+    uint32_t x = *seedPtr;
+    size_t i = 0;
+
+    while (i < length)
+    {
+        size_t blockEnd = i + 4096;
+        if (blockEnd > length)
+        {
+            blockEnd = length;
+        }
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        unsigned int kind = x % 4;
+
+        for (; i < blockEnd; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            switch (kind)
+            {
+                case 0:
+                    bufferPtr[i] = (uint8_t)x;
+                    break;
+                case 3:
+                    bufferPtr[i] = 0;
+                    break;
+                default:
+                    bufferPtr[i] = alphabet[x % (sizeof(alphabet) - 1)];
+                    break;
+            }
+        }
+    }
+
+    *seedPtr = x;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the tree to pack: apps with a few directories each, holding files from 1 KiB to 2 MiB.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeTree
+(
+    void
+)
+{
+    static const size_t fileSizes[] = { 1024, 7000, 30000, 100000, 400000, 2097152 };
+    static const char* subDirs[] = { "bin", "lib", "share/data" };
+    uint64_t totalBytes = (uint64_t)SizeMiB * 1024 * 1024;
+    uint64_t bytes = 0;
+    uint32_t seed = 0x1234567;
+    uint8_t* bufferPtr = malloc(fileSizes[NUM_ARRAY_MEMBERS(fileSizes) - 1]);
+    unsigned int fileNum = 0;
+
+    LE_ASSERT(bufferPtr != NULL);
+
+    while (bytes < totalBytes)
+    {
+        char dirPath[PATH_BYTES * 2];
+        char filePath[PATH_BYTES * 3];
+        size_t size = fileSizes[fileNum % NUM_ARRAY_MEMBERS(fileSizes)];
+
+        if (size > totalBytes - bytes)
+        {
+            size = totalBytes - bytes;
+        }
+
+        snprintf(dirPath, sizeof(dirPath), "%s/apps/app%u/%s",
+                 SrcDir, fileNum / 60, subDirs[fileNum % NUM_ARRAY_MEMBERS(subDirs)]);
+        LE_ASSERT(le_dir_MakePath(dirPath, 0755) == LE_OK);
+        snprintf(filePath, sizeof(filePath), "%s/file%u", dirPath, fileNum);
+
+        FillBuffer(bufferPtr, size, &seed);
+
+        int fd = open(filePath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        LE_ASSERT(fd >= 0);
+        LE_ASSERT(write(fd, bufferPtr, size) == (ssize_t)size);
+        LE_ASSERT(close(fd) == 0);
+
+        bytes += size;
+        fileNum++;
+    }
+
+    free(bufferPtr);
+
+    LE_TEST_INFO("Generated %u files, %" PRIu64 " bytes.", fileNum, bytes);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a regular file (nftw() callback).
+ */
+//--------------------------------------------------------------------------------------------------
+static int CountFile
+(
+    const char* pathPtr,
+    const struct stat* statPtr,
+    int type,
+    struct FTW* ftwPtr
+)
+{
+    if (type == FTW_F)
+    {
+        TreeFiles++;
+        TreeBytes += statPtr->st_size;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the unpacked tree has as many files and bytes as the generated one.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsUnpackedTreeRight
+(
+    void
+)
+{
+    size_t srcFiles;
+    uint64_t srcBytes;
+
+    TreeFiles = 0;
+    TreeBytes = 0;
+    LE_ASSERT(nftw(SrcDir, CountFile, 16, FTW_PHYS) == 0);
+    srcFiles = TreeFiles;
+    srcBytes = TreeBytes;
+
+    TreeFiles = 0;
+    TreeBytes = 0;
+    LE_ASSERT(nftw(DestDir, CountFile, 16, FTW_PHYS) == 0);
+
+    return (TreeFiles == srcFiles) && (TreeBytes == srcBytes);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack a tarball by feeding it through a pipe to a forked "tar xj", like the update daemon used
+ * to.  Runs in the child process.
+ *
+ * @return Exit code for the child process.
+ */
+//--------------------------------------------------------------------------------------------------
+static int UnpackForked
+(
+    const char* packPath
+)
+{
+    char buffer[PIPE_WRITE_BYTES];
+    int fds[2];
+    int status;
+
+    int inFd = open(packPath, O_RDONLY);
+    LE_ASSERT(inFd >= 0);
+    LE_ASSERT(pipe(fds) == 0);
+
+    pid_t pid = fork();
+    LE_ASSERT(pid >= 0);
+
+    if (pid == 0)
+    {
+        close(fds[1]);
+        close(inFd);
+        dup2(fds[0], STDIN_FILENO);
+        close(fds[0]);
+        execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", DestDir, (char*)NULL);
+        execl("/bin/tar", "tar", "xjop", "-C", DestDir, (char*)NULL);
+        _exit(127);
+    }
+
+    close(fds[0]);
+
+    ssize_t readResult;
+    while ((readResult = read(inFd, buffer, sizeof(buffer))) > 0)
+    {
+        if (write(fds[1], buffer, readResult) != readResult)
+        {
+            break;
+        }
+    }
+    close(fds[1]);
+    close(inFd);
+
+    if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    {
+        return EXIT_FAILURE;
+    }
+    return (readResult == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack a tarball in-process, hashing it on the way, like the update daemon does now.  Runs in
+ * the child process.
+ *
+ * @return Exit code for the child process.
+ */
+//--------------------------------------------------------------------------------------------------
+static int UnpackInProcess
+(
+    const char* packPath
+)
+{
+    uint8_t buffer[READ_BYTES];
+    md5_Context_t md5Context;
+    char md5[MD5_STRING_BYTES];
+    le_result_t result = LE_OK;
+
+    int inFd = open(packPath, O_RDONLY);
+    LE_ASSERT(inFd >= 0);
+
+    untar_Ref_t untarRef = untar_Create(DestDir);
+    LE_ASSERT(untarRef != NULL);
+    md5_Init(&md5Context);
+
+    ssize_t readResult;
+    while ((result == LE_OK) && ((readResult = read(inFd, buffer, sizeof(buffer))) > 0))
+    {
+        md5_Update(&md5Context, buffer, readResult);
+        result = untar_Write(untarRef, buffer, readResult);
+    }
+    if (result == LE_OK)
+    {
+        result = untar_Finish(untarRef);
+    }
+    md5_Final(&md5Context, md5);
+
+    untar_Delete(untarRef);
+    close(inFd);
+
+    return (result == LE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do nothing.  Runs in the child process, to measure what the child inherits from this process.
+ *
+ * @return Exit code for the child process.
+ */
+//--------------------------------------------------------------------------------------------------
+static int DoNothing
+(
+    const char* packPath
+)
+{
+    return EXIT_SUCCESS;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run an unpack function in a child process, and measure it.
+ *
+ * @return true if the unpack succeeded and the unpacked tree is right.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool Run
+(
+    int (*unpackFunc)(const char* packPath),
+    const char* packPath,
+    Results_t* resultsPtr       ///< [OUT]
+)
+{
+    struct rusage usage;
+    int status;
+
+    LE_ASSERT(le_dir_RemoveRecursive(DestDir) == LE_OK);
+    LE_ASSERT(le_dir_MakePath(DestDir, 0755) == LE_OK);
+
+    // Make sure the tarball is in the page cache, so every run reads it the same way.
+    if (packPath != NULL)
+    {
+        char cmd[PATH_BYTES + 32];
+        snprintf(cmd, sizeof(cmd), "cat '%s' > /dev/null", packPath);
+        LE_ASSERT(system(cmd) == 0);
+    }
+
+    double start = Now();
+
+    pid_t pid = fork();
+    LE_ASSERT(pid >= 0);
+
+    if (pid == 0)
+    {
+        _exit(unpackFunc(packPath));
+    }
+
+    LE_ASSERT(wait4(pid, &status, 0, &usage) == pid);
+
+    resultsPtr->wallSec = Now() - start;
+    resultsPtr->cpuSec = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+                         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+    resultsPtr->maxRssKiB = usage.ru_maxrss;
+
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+    {
+        return false;
+    }
+    return (packPath == NULL) || IsUnpackedTreeRight();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the results of an unpack.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const char* name,
+    const Results_t* resultsPtr
+)
+{
+    LE_TEST_INFO("%-18s %7.2f s wall %7.2f s CPU %8.1f MiB/s  peak RSS %6ld KiB",
+                 name,
+                 resultsPtr->wallSec,
+                 resultsPtr->cpuSec,
+                 SizeMiB / resultsPtr->wallSec,
+                 resultsPtr->maxRssKiB);
+}
+
+COMPONENT_INIT
+{
+    char packPaths[NUM_PACKS][PATH_BYTES];
+    bool isPacked[NUM_PACKS];
+    Results_t results;
+    size_t i;
+
+    le_arg_SetIntVar(&SizeMiB, "s", "size");
+    le_arg_SetStringVar(&WorkDir, "d", "dir");
+    le_arg_Scan();
+
+    LE_ASSERT(SizeMiB > 0);
+
+    snprintf(SrcDir, sizeof(SrcDir), "%s/src", WorkDir);
+    snprintf(DestDir, sizeof(DestDir), "%s/dest", WorkDir);
+    LE_ASSERT(le_dir_RemoveRecursive(WorkDir) == LE_OK);
+    LE_ASSERT(le_dir_MakePath(SrcDir, 0755) == LE_OK);
+
+    MakeTree();
+
+    // One test for the baseline, one for the forked tar, and one per in-process unpack.
+    int plan = 2;
+    for (i = 0; i < NUM_PACKS; i++)
+    {
+        char cmd[4 * PATH_BYTES + 32];
+
+        snprintf(packPaths[i], sizeof(packPaths[i]), "%s/pack.tar.%s", WorkDir, Packs[i].name);
+        snprintf(cmd, sizeof(cmd),
+                 "tar -C '%s' -cf - . | %s > '%s'", SrcDir, Packs[i].compressCmd, packPaths[i]);
+        isPacked[i] = (system(cmd) == 0);
+        if (isPacked[i])
+        {
+            struct stat st;
+            LE_ASSERT(stat(packPaths[i], &st) == 0);
+            LE_TEST_INFO("%s tarball: %lld bytes.", Packs[i].name, (long long)st.st_size);
+            plan++;
+        }
+    }
+    LE_ASSERT(isPacked[0]);
+
+    LE_TEST_PLAN(plan);
+
+    LE_TEST_OK(Run(DoNothing, NULL, &results), "baseline");
+    Report("baseline", &results);
+
+    LE_TEST_OK(Run(UnpackForked, packPaths[0], &results), "forked tar (bzip2)");
+    Report("forked tar (bzip2)", &results);
+
+    for (i = 0; i < NUM_PACKS; i++)
+    {
+        if (isPacked[i])
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "in-process (%s)", Packs[i].name);
+            LE_TEST_OK(Run(UnpackInProcess, packPaths[i], &results), "%s", name);
+            Report(name, &results);
+        }
+    }
+
+    le_dir_RemoveRecursive(WorkDir);
+
+    LE_TEST_EXIT;
+}
@@ -26,6 +26,7 @@ BuildParams_t::BuildParams_t
     jobCount(0),
     target("localhost"),
     osType("linux"),
+    packCompression("bzip2"),
     codeGenOnly(false),
     isStandAloneComp(false),
     noPie(false),
@@ -42,6 +42,8 @@ struct BuildParams_t
     std::string             privKey;            ///< Path for ima signing private key.
     std::string             pubCert;            ///< Path for ima signing public certificate.
     bool                    signPkg;            ///< true = Sign the package with ima-key
+    std::string             packCompression;    ///< Update pack tarball compression ("bzip2",
+                                                ///< "lz4" or "zstd").
 
     bool                    codeGenOnly;        ///< true = only generate code, don't compile, etc.
     bool                    isStandAloneComp;   ///< true = generate stand-alone component
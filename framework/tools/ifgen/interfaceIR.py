@@ -202,7 +202,8 @@ class StructStringMember(StructMember):
         self.maxCount = maxCount
 
     def MaxSize(self):
-        return self.maxCount * self.apiType.size
+        # Strings are packed with their length first.
+        return UINT32_TYPE.size + self.maxCount * self.apiType.size
 
     def __str__(self):
         return "{} {}[{}]".format(self.apiType, self.name, self.maxCount)
@@ -213,7 +214,8 @@ class StructArrayMember(StructMember):
         self.maxCount = maxCount
 
     def MaxSize(self):
-        return self.maxCount * self.apiType.size
+        # Arrays are packed with their element count first.
+        return UINT32_TYPE.size + self.maxCount * self.apiType.size
 
     def __str__(self):
         return "{} {}[{}]".format(self.apiType, self.name, self.maxCount)
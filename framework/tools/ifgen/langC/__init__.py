@@ -39,10 +39,19 @@ Filters = { 'DecorateName':        codeGenHelpers.DecorateName,
             'UnpackFunction':        codeGenHelpers.GetUnpackFunction,
             'CAPIParameters':        codeGenHelpers.IterCAPIParameters,
             'MaxCOutputBuffers':     codeGenHelpers.GetMaxCOutputBuffers,
-            'LocalMessageSize':      codeGenHelpers.GetLocalMessageSize}
+            'LocalMessageSize':      codeGenHelpers.GetLocalMessageSize,
+            'PackedRequestSize':     codeGenHelpers.GetPackedRequestSize,
+            'PackedResponseSize':    codeGenHelpers.GetPackedResponseSize,
+            'PackedSize':            codeGenHelpers.GetPackedSize,
+            'AsyncRequest':          codeGenHelpers.GetAsyncRequest,
+            'AsyncResponseHandler':  codeGenHelpers.GetAsyncResponseHandler,
+            'OutputMask':            codeGenHelpers.GetOutputMask}
 
 
-Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter }
+Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter,
+          'RawType':               codeGenHelpers.IsRawType,
+          'RawStruct':             codeGenHelpers.IsRawStruct,
+          'AsyncFunction':         codeGenHelpers.IsAsyncFunction }
 
 Globals = { 'Labeler':             codeGenHelpers.Labeler }
 
@@ -361,6 +361,103 @@ def GetLocalMessageSize(interface, pointerSize):
                     for handler in interface.types.values()
                     if isinstance(handler, interfaceIR.HandlerType)])
 
+#---------------------------------------------------------------------------------------------------
+# Message layouts
+#---------------------------------------------------------------------------------------------------
+
+# Types which le_pack packs as an exact copy of their C representation.  Arrays of these types can
+# be packed or unpacked with a single memcpy().
+_RAW_TYPES = frozenset([interfaceIR.UINT8_TYPE,
+                        interfaceIR.UINT16_TYPE,
+                        interfaceIR.UINT32_TYPE,
+                        interfaceIR.UINT64_TYPE,
+                        interfaceIR.INT8_TYPE,
+                        interfaceIR.INT16_TYPE,
+                        interfaceIR.INT32_TYPE,
+                        interfaceIR.INT64_TYPE,
+                        interfaceIR.CHAR_TYPE,
+                        interfaceIR.DOUBLE_TYPE,
+                        interfaceIR.RESULT_TYPE,
+                        interfaceIR.ONOFF_TYPE])
+
+def IsRawType(apiType):
+    """
+    Is a type packed as an exact copy of its C representation?
+    """
+    return apiType in _RAW_TYPES
+
+def IsRawStruct(apiType):
+    """
+    Is a structure made only of raw type members?  Such a structure is packed as an exact copy of
+    its C representation, provided the C compiler didn't pad it.
+    """
+    return (isinstance(apiType, interfaceIR.StructType) and
+            all([type(member) is interfaceIR.StructMember and IsRawType(member.apiType)
+                 for member in apiType.members]))
+
+def GetPackedSize(apiType):
+    """
+    Get the largest number of bytes a value of a type can take in a message.
+    """
+    if isinstance(apiType, interfaceIR.StructType):
+        size = 0
+        for member in apiType.members:
+            if isinstance(member, interfaceIR.StructStringMember):
+                size += interfaceIR.UINT32_TYPE.size + member.maxCount
+            elif isinstance(member, interfaceIR.StructArrayMember):
+                size += interfaceIR.UINT32_TYPE.size + \
+                        member.maxCount * GetPackedSize(member.apiType)
+            else:
+                size += GetPackedSize(member.apiType)
+        return size
+    else:
+        return apiType.size
+
+def GetPackedParameterSize(parameter, direction):
+    """
+    Get the largest number of bytes a parameter can take in a message going in a direction.
+    """
+    if isinstance(parameter, interfaceIR.StringParameter):
+        if parameter.direction & direction:
+            return interfaceIR.UINT32_TYPE.size + parameter.maxCount
+        elif direction == interfaceIR.DIR_IN:
+            # The size of the output buffer.
+            return interfaceIR.UINT32_TYPE.size
+    elif isinstance(parameter, interfaceIR.ArrayParameter):
+        if parameter.direction & direction:
+            return interfaceIR.UINT32_TYPE.size + \
+                   parameter.maxCount * GetPackedSize(parameter.apiType)
+        elif direction == interfaceIR.DIR_IN:
+            # The size of the output buffer.
+            return interfaceIR.UINT32_TYPE.size
+    elif parameter.direction & direction:
+        return GetPackedSize(parameter.apiType)
+    return 0
+
+def GetPackedRequestSize(function):
+    """
+    Get the largest number of bytes of parameters in a request message to a function, or in a
+    message to a handler.
+    """
+    if isinstance(function, interfaceIR.HandlerType):
+        # Context pointer
+        size = interfaceIR.UINT32_TYPE.size
+    elif any([parameter.direction & interfaceIR.DIR_OUT for parameter in function.parameters]):
+        # Required outputs
+        size = interfaceIR.UINT32_TYPE.size
+    else:
+        size = 0
+    return size + sum([GetPackedParameterSize(parameter, interfaceIR.DIR_IN)
+                       for parameter in function.parameters])
+
+def GetPackedResponseSize(function):
+    """
+    Get the largest number of bytes of results in a response message from a function.
+    """
+    return sum([GetPackedSize(function.returnType) if function.returnType else 0] +
+               [GetPackedParameterSize(parameter, interfaceIR.DIR_OUT)
+                for parameter in function.parameters])
+
 def GetCOutputBufferCount(function):
     outputCount = 0
     for parameter in function.parameters:
@@ -373,12 +470,63 @@ def GetCOutputBufferCount(function):
 def GetMaxCOutputBuffers(interface):
     return max([GetCOutputBufferCount(function) for function in interface.functions.values()])
 
+#---------------------------------------------------------------------------------------------------
+# Asynchronous calls
+#---------------------------------------------------------------------------------------------------
+def GetAsyncRequest(function):
+    """
+    Get a function with only the input parameters of a function, which are the parameters of its
+    asynchronous variant (before the response handler).
+    """
+    return interfaceIR.Function(None, function.name,
+                                [parameter for parameter in function.parameters
+                                 if parameter.direction == interfaceIR.DIR_IN])
+
+def GetAsyncResponseHandler(function):
+    """
+    Get the handler for the response to an asynchronous call of a function.  It is passed the
+    result, if any, then the output parameters, as inputs.
+    """
+    parameters = []
+    if function.returnType:
+        parameters.append(interfaceIR.Parameter(function.returnType, 'result'))
+    for parameter in function.parameters:
+        if parameter.direction & interfaceIR.DIR_OUT == 0:
+            continue
+        if isinstance(parameter, interfaceIR.StringParameter):
+            parameters.append(interfaceIR.StringParameter(parameter.name, parameter.maxCount))
+        elif isinstance(parameter, interfaceIR.ArrayParameter):
+            parameters.append(interfaceIR.ArrayParameter(parameter.apiType, parameter.name,
+                                                         parameter.maxCount))
+        else:
+            parameters.append(interfaceIR.Parameter(parameter.apiType, parameter.name))
+    return interfaceIR.HandlerType(function.name + 'RespHandler', parameters)
+
+def GetOutputMask(function):
+    """
+    Get the mask of required outputs which asks for all of a function's outputs.
+    """
+    outputCount = len([parameter for parameter in function.parameters
+                       if parameter.direction & interfaceIR.DIR_OUT])
+    return "0x%x" % ((1 << outputCount) - 1)
+
 #---------------------------------------------------------------------------------------------------
 # Test functions
 #---------------------------------------------------------------------------------------------------
 def IsSizeParameter(parameter):
     return isinstance(parameter, SizeParameter)
 
+def IsAsyncFunction(function, functions):
+    """
+    Asynchronous variants are generated for functions that aren't add or remove handler functions,
+    and don't take a handler.  An API can't have two functions with the same name, so no variant
+    is generated if the API already has a function with the name of the asynchronous variant.
+    """
+    return (not isinstance(function, interfaceIR.EventFunction) and
+            not any([isinstance(parameter.apiType, interfaceIR.HandlerType)
+                     for parameter in function.parameters]) and
+            not any([other.name == function.name + 'Async' for other in functions]))
+
 #---------------------------------------------------------------------------------------------------
 # Global functions
 #---------------------------------------------------------------------------------------------------
@@ -500,6 +500,59 @@ void {{apiName}}_DisconnectService
         }
     }
 }
+{%- if not args.localService %}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a batch of asynchronous calls from the current client thread.
+ *
+ * Until the matching EndBatch, the requests made with the Async functions of this API are queued
+ * instead of being sent.  EndBatch then sends them all at once, so the server handles them in one
+ * go, and waits for the responses.  Batches can be nested.  For details, see
+ * @ref c_messagingBatching.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+void {{apiName}}_StartBatch
+(
+    void
+)
+{
+    if (ifgen_{{apiBaseName}}_HasLocalBinding())
+    {
+        // Calls to local bindings are made right away, so there is nothing to batch.
+        return;
+    }
+
+    le_msg_StartBatch(GetCurrentSessionRef());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a batch of asynchronous calls from the current client thread.
+ *
+ * At the end of the outermost batch, send the queued requests and block until all of the
+ * responses have arrived.  The response handlers are called before this function returns.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+void {{apiName}}_EndBatch
+(
+    void
+)
+{
+    if (ifgen_{{apiBaseName}}_HasLocalBinding())
+    {
+        return;
+    }
+
+    le_msg_EndBatch(GetCurrentSessionRef());
+}
+{%- endif %}
 
 {%- for function in functions %}
 {# Currently function prototype is formatter is copied & pasted from interface header template.
@@ -526,4 +579,45 @@ void {{apiName}}_DisconnectService
         {%- endfor %}
     );
 }
+{%- if function is AsyncFunction(functions) and not args.localService %}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asynchronous version of {{apiName}}_{{function.name}}().
+ *
+ * Send the request and return without waiting for the response.  handlerPtr is called with the
+ * result and the "out" parameters by the current thread's event loop once the response arrives,
+ * or by {{apiName}}_EndBatch() if the call is made as part of a batch.  handlerPtr can be NULL if
+ * the results are not needed.
+ *
+ * If the client is bound directly to the server, the call is made right away, and handlerPtr is
+ * called before this function returns.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+void {{apiName}}_{{function.name}}Async
+(
+    {%- for parameter in function|AsyncRequest|CAPIParameters %}
+    {{parameter|FormatParameter}},
+        ///< [{{parameter.direction|FormatDirection}}]
+             {{-parameter.comments|join("\n///<")|indent(8)}}
+    {%-endfor%}
+    {{apiName}}_{{function.name}}RespHandlerFunc_t handlerPtr,
+        ///< [IN] Handler for the response.
+    void* contextPtr
+        ///< [IN] Context pointer passed to the handler.
+)
+{
+    ifgen_{{apiBaseName}}_{{function.name}}Async(
+        GetCurrentSessionRef(),
+        {%- for parameter in function|AsyncRequest|CAPIParameters %}
+        {{parameter|FormatParameterName}},
+        {%- endfor %}
+        handlerPtr,
+        contextPtr
+    );
+}
+{%- endif %}
 {%- endfor %}
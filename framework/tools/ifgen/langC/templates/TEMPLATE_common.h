@@ -143,6 +143,36 @@ LE_SHARED {{function.returnType|FormatType(useBaseName=True)}} ifgen_{{apiBaseNa
              {{-parameter.comments|join("\n///<")|indent(8)}}
     {%-endfor%}
 );
+{%- if function is AsyncFunction(functions) and not args.localService %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the response to an asynchronous {{function.name}} call.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*{{apiBaseName}}_{{function.name}}RespHandlerFunc_t)
+(
+    {%- for parameter in function|AsyncResponseHandler|CAPIParameters %}
+        {{parameter|FormatParameter(useBaseName=True)}}{% if not loop.last %},{% endif %}
+    {%-endfor%}
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asynchronous version of {{function.name}}: send the request and return without waiting.  The
+ * handler is called with the results once the response arrives.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void ifgen_{{apiBaseName}}_{{function.name}}Async
+(
+    le_msg_SessionRef_t _ifgen_sessionRef,
+    {%- for parameter in function|AsyncRequest|CAPIParameters %}
+        {{parameter|FormatParameter(useBaseName=True)}},
+    {%-endfor%}
+        {{apiBaseName}}_{{function.name}}RespHandlerFunc_t handlerPtr,
+        void* contextPtr
+);
+{%- endif %}
 {%- endfor %}
 
 #endif // {{apiBaseName|upper}}_COMMON_H_INCLUDE_GUARD
@@ -492,6 +492,142 @@ error_unpack:
     {%- endif %}
     {%- endwith %}
 }
+{%- if function is AsyncFunction(functions) and not args.localService %}
+{%- set respHandler = function|AsyncResponseHandler %}
+
+
+// This function parses the response to an asynchronous call, and then calls the handler passed
+// to the call, which is stored in a client data object.
+static void _Respond_ifgen_{{apiBaseName}}_{{function.name}}
+(
+    le_msg_MessageRef_t _msgRef,
+    void* _dataPtr
+)
+{
+    {%- with error_unpack_label=Labeler("error_unpack") %}
+    // Pull out the handler and its context, then release the client data, since this is the only
+    // response.
+    _ClientData_t* _clientDataPtr = _dataPtr;
+    {{apiBaseName}}_{{function.name}}RespHandlerFunc_t _handlerRef_ifgen_{{apiBaseName}}_{{function.name}} =
+        {#- #} ({{apiBaseName}}_{{function.name}}RespHandlerFunc_t)_clientDataPtr->handlerPtr;
+    void* contextPtr = _clientDataPtr->contextPtr;
+    le_mem_Release(_clientDataPtr);
+
+    // It is a serious error if we don't get a valid response from the server.
+    if (_msgRef == NULL)
+    {
+        LE_FATAL("Error receiving response from server");
+    }
+
+    _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
+
+    // Unpack the result and the "out" parameters
+    {%- call pack.UnpackInputs(respHandler.parameters,useBaseName=True) %}
+        goto {{error_unpack_label}};
+    {%- endcall %}
+
+    // Release the message, now that everything has been copied out of it.
+    le_msg_ReleaseMsg(_msgRef);
+
+    // Call the handler
+    if ( _handlerRef_ifgen_{{apiBaseName}}_{{function.name}} != NULL )
+    {
+        _handlerRef_ifgen_{{apiBaseName}}_{{function.name}}(
+            {%- for parameter in respHandler|CAPIParameters %}
+            {{- parameter|FormatParameterName}}{% if not loop.last %}, {% endif %}
+            {%- endfor %} );
+    }
+
+    return;
+    {%- if error_unpack_label.IsUsed() %}
+
+error_unpack:
+    LE_FATAL("Unexpected response from server.");
+    {%- endif %}
+    {%- endwith %}
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asynchronous version of {{function.name}}: send the request and return without waiting.  The
+ * handler is called with the results once the response arrives.
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((weak))
+LE_SHARED void ifgen_{{apiBaseName}}_{{function.name}}Async
+(
+    le_msg_SessionRef_t _ifgen_sessionRef,
+    {%- for parameter in function|AsyncRequest|CAPIParameters %}
+    {{parameter|FormatParameter(useBaseName=True)}},
+    {%-endfor%}
+    {{apiBaseName}}_{{function.name}}RespHandlerFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+
+    // Range check values, if appropriate
+    {%- for parameter in function.parameters if parameter is InParameter %}
+    {%- if parameter is StringParameter %}
+    if ( {{parameter|GetParameterCount}} > {{parameter.maxCount}} )
+    {
+        LE_FATAL("{{parameter|GetParameterCount}} > {{parameter.maxCount}}");
+    }
+    {%- elif parameter is ArrayParameter %}
+    if ( (NULL == {{parameter|FormatParameterName}}) &&
+         (0 != {{parameter|GetParameterCount}}) )
+    {
+        LE_FATAL("If {{parameter|FormatParameterName}} is NULL "
+                 "{{parameter|GetParameterCount}} must be zero");
+    }
+    if ( {{parameter|GetParameterCount}} > {{parameter.maxCount}} )
+    {
+        LE_FATAL("{{parameter|GetParameterCount}} > {{parameter.maxCount}}");
+    }
+    {%- endif %}
+    {%- endfor %}
+
+    // The handler and its context are kept in a client data object until the response arrives.
+    _ClientData_t* _clientDataPtr = le_mem_ForceAlloc(_ClientDataPool);
+    _clientDataPtr->handlerPtr = (le_event_HandlerFunc_t)handlerPtr;
+    _clientDataPtr->contextPtr = contextPtr;
+    _clientDataPtr->handlerRef = NULL;
+    _clientDataPtr->callersThreadRef = le_thread_GetCurrent();
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(_ifgen_sessionRef);
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_{{apiBaseName}}_{{function.name}};
+    _msgBufPtr = _msgPtr->buffer;
+    {%- if any(function.parameters, "OutParameter") %}
+
+    // All of the outputs are needed to call the handler.
+    LE_ASSERT(le_pack_PackUint32(&_msgBufPtr, {{function|OutputMask}}));
+    {%- endif %}
+
+    // Pack the input parameters, and the largest size of each "out" string or array.
+    {%- for parameter in function.parameters %}
+    {%- if parameter is InParameter %}
+    {{- pack.PackInputs([parameter]) }}
+    {%- elif parameter is StringParameter or parameter is ArrayParameter %}
+    LE_ASSERT(le_pack_PackSize( &_msgBufPtr, {{parameter.maxCount}} ));
+    {%- endif %}
+    {%- endfor %}
+
+    // Send the request to the server.  The response is handled by the event loop, or by
+    // le_msg_EndBatch() if this request is part of a batch.
+    TRACE("Sending asynchronous request to server : %ti bytes sent",
+          _msgBufPtr-_msgPtr->buffer);
+
+    le_msg_RequestResponse(_msgRef, _Respond_ifgen_{{apiBaseName}}_{{function.name}}, _clientDataPtr);
+}
+{%- endif %}
 {%- endfor %}
 
 
@@ -99,4 +99,87 @@ void {{apiName}}_DisconnectService
 (
     void
 );
+{%- if not args.localService %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a batch of asynchronous calls from the current client thread.
+ *
+ * Until the matching EndBatch, the requests made with the Async functions of this API are queued
+ * instead of being sent.  EndBatch then sends them all at once, so the server handles them in one
+ * go, and waits for the responses.  Batches can be nested.  For details, see
+ * @ref c_messagingBatching.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void {{apiName}}_StartBatch
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a batch of asynchronous calls from the current client thread.
+ *
+ * At the end of the outermost batch, send the queued requests and block until all of the
+ * responses have arrived.  The response handlers are called before this function returns.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void {{apiName}}_EndBatch
+(
+    void
+);
+{%- endif %}
+{%- endblock %}
+{% block FunctionDeclaration %}
+{{- super() }}
+{%- if function is AsyncFunction(functions) and not args.localService %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the response to an asynchronous {{function.name}} call.
+ */
+//--------------------------------------------------------------------------------------------------
+{%- if apiBaseName != apiName %}
+typedef {{apiBaseName}}_{{function.name}}RespHandlerFunc_t {{apiName}}_{{function.name}}RespHandlerFunc_t;
+{%- else %}
+typedef void (*{{apiName}}_{{function.name}}RespHandlerFunc_t)
+(
+    {%- for parameter in function|AsyncResponseHandler|CAPIParameters %}
+        {{parameter|FormatParameter}}{% if not loop.last %},{% endif %}
+    {%-endfor%}
+);
+{%- endif %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asynchronous version of {{apiName}}_{{function.name}}().
+ *
+ * Send the request and return without waiting for the response.  handlerPtr is called with the
+ * result and the "out" parameters by the current thread's event loop once the response arrives,
+ * or by {{apiName}}_EndBatch() if the call is made as part of a batch.  handlerPtr can be NULL if
+ * the results are not needed.
+ *
+ * If the client is bound directly to the server, the call is made right away, and handlerPtr is
+ * called before this function returns.
+ *
+ * This function is created automatically.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_FULL_API void {{apiName}}_{{function.name}}Async
+(
+    {%- for parameter in function|AsyncRequest|CAPIParameters %}
+    {{parameter|FormatParameter}},
+        ///< [{{parameter.direction|FormatDirection}}]
+             {{-parameter.comments|join("\n///<")|indent(8)}}
+    {%-endfor%}
+    {{apiName}}_{{function.name}}RespHandlerFunc_t handlerPtr,
+        ///< [IN] Handler for the response.
+    void* contextPtr
+        ///< [IN] Context pointer passed to the handler.
+);
+{%- endif %}
 {%- endblock %}
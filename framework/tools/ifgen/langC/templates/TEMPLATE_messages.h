@@ -45,6 +45,20 @@ _Message_t;
 {% for function in functions %}
 #define _MSGID_{{apiBaseName}}_{{function.name}} {{loop.index0}}
 {%- endfor %}
+{%- if not args.localService %}
+
+// Check the largest message to and from each function, and to each handler, fits in a message.
+{%- for function in functions %}
+static_assert({{function|PackedRequestSize}} <= _MAX_MSG_SIZE,
+              "{{apiBaseName}}_{{function.name}} request too large");
+static_assert({{function|PackedResponseSize}} <= _MAX_MSG_SIZE,
+              "{{apiBaseName}}_{{function.name}} response too large");
+{%- endfor %}
+{%- for type in types if type is HandlerType %}
+static_assert({{type|PackedRequestSize}} <= _MAX_MSG_SIZE,
+              "{{apiBaseName}}_{{type.name}} message too large");
+{%- endfor %}
+{%- endif %}
 
 
 // Define type-safe pack/unpack functions for all enums, including included types
@@ -541,6 +541,80 @@ LE_SHARED {{function.returnType|FormatType(useBaseName=True)}} ifgen_{{apiBaseNa
         {%- endfor %}
     );
 }
+{%- if function is AsyncFunction(functions) and not args.localService %}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asynchronous version of {{function.name}}.  When called in-place there are no messages to wait
+ * for, so the call is made right away and the handler is called with the results.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void ifgen_{{apiBaseName}}_{{function.name}}Async
+(
+    le_msg_SessionRef_t _ifgen_sessionRef,
+    {%- for parameter in function|AsyncRequest|CAPIParameters %}
+    {{parameter|FormatParameter(useBaseName=True)}},
+    {%-endfor%}
+    {{apiBaseName}}_{{function.name}}RespHandlerFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    // Storage for the "out" parameters
+    {%- for parameter in function.parameters if parameter is OutParameter %}
+    {%- if parameter is StringParameter %}
+    char {{parameter.name|DecorateName}}[{{parameter.maxCount + 1}}] = "";
+    {%- elif parameter is ArrayParameter %}
+    {{parameter.apiType|FormatType(useBaseName=True)}} {{parameter.name}}Ptr[{{parameter.maxCount}}];
+    size_t {{parameter.name}}Size = {{parameter.maxCount}};
+    {%- elif parameter.apiType is StructType %}
+    {{parameter.apiType|FormatType(useBaseName=True)}} {{parameter.name}}Value;
+    {%- else %}
+    {{parameter.apiType|FormatType(useBaseName=True)}} {{parameter.name|DecorateName}}
+        {#- #} = {{parameter.apiType|FormatTypeInitializer(useBaseName=True)}};
+    {%- endif %}
+    {%- endfor %}
+
+    {% if function.returnType %}{{function.returnType|FormatType(useBaseName=True)}} _result = {% endif -%}
+    ifgen_{{apiBaseName}}_{{function.name}}(
+        _ifgen_sessionRef
+        {%- for parameter in function|CAPIParameters %},
+        {%- if parameter is SizeParameter %}
+        {%- if parameter.relatedParameter is not OutParameter %}
+        {{parameter|FormatParameterName}}
+        {%- elif parameter.relatedParameter is StringParameter %}
+        sizeof({{parameter.relatedParameter.name|DecorateName}})
+        {%- else %}
+        &{{parameter.name}}
+        {%- endif %}
+        {%- elif parameter is not OutParameter %}
+        {{parameter|FormatParameterName}}
+        {%- elif parameter is StringParameter %}
+        {{parameter.name|DecorateName}}
+        {%- elif parameter is ArrayParameter %}
+        {{parameter.name}}Ptr
+        {%- elif parameter.apiType is StructType %}
+        &{{parameter.name}}Value
+        {%- else %}
+        &{{parameter.name|DecorateName}}
+        {%- endif %}
+        {%- endfor %}
+    );
+
+    if (handlerPtr != NULL)
+    {
+        handlerPtr(
+            {%- if function.returnType %}_result, {% endif %}
+            {%- for parameter in function.parameters if parameter is OutParameter %}
+            {%- if parameter is StringParameter %}
+            {{- parameter.name|DecorateName}}, {% elif parameter is ArrayParameter %}
+            {{- parameter.name}}Ptr, {{parameter.name}}Size, {% elif parameter.apiType is StructType %}
+            {{- '&' ~ parameter.name}}Value, {% else %}
+            {{- parameter.name|DecorateName}}, {% endif %}
+            {%- endfor %}contextPtr);
+    }
+}
+{%- endif %}
 {%- endfor %}
 {%- endif %}
 
@@ -0,0 +1,264 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file logRingDecode.c  Print the messages held in binary log rings
+ *
+ * Scans a file, such as a core dump or a copy of a process's memory, for binary log rings and
+ * prints the messages they still hold, oldest first.  See logRing.h for the layout of a ring.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "logRing.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rings start on a page boundary, so only page boundaries are searched for ring headers.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RING_ALIGNMENT      4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring being printed, passed as context to the message handler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* procNamePtr;    ///< Process name of the writer.
+    int         pid;            ///< Process ID of the writer.
+    unsigned    count;          ///< Number of messages printed.
+}
+Ring_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the usage of the tool.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintUsage
+(
+    const char* progNamePtr
+)
+{
+    fprintf(stderr,
+            "usage: %s FILE\n"
+            "\n"
+            "Print the log messages held in the binary log rings found in FILE (or in the\n"
+            "standard input if FILE is -), such as a core dump of a Legato process.\n",
+            progNamePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole file into memory.
+ *
+ * @return The file's contents, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* ReadFile
+(
+    FILE* filePtr,
+    size_t* sizePtr     ///< [OUT] Size of the file.
+)
+{
+    size_t size = 0;
+    size_t capacity = 1024 * 1024;
+    uint8_t* bufPtr = malloc(capacity);
+
+    while (bufPtr != NULL)
+    {
+        size += fread(bufPtr + size, 1, capacity - size, filePtr);
+
+        if (size < capacity)
+        {
+            if (ferror(filePtr))
+            {
+                break;
+            }
+            *sizePtr = size;
+            return bufPtr;
+        }
+
+        uint8_t* newBufPtr = realloc(bufPtr, capacity * 2);
+        if (newBufPtr == NULL)
+        {
+            break;
+        }
+        bufPtr = newBufPtr;
+        capacity *= 2;
+    }
+
+    free(bufPtr);
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print a message decoded from a ring, in the format used by the log.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintMsg
+(
+    const logRing_Msg_t* msgPtr,
+    void* contextPtr
+)
+{
+    Ring_t* ringPtr = contextPtr;
+    time_t seconds = (time_t)(msgPtr->timestamp / 1000000000);
+    struct tm tm;
+    char timeStr[32] = "";
+
+    gmtime_r(&seconds, &tm);
+    strftime(timeStr, sizeof(timeStr), "%b %e %H:%M:%S", &tm);
+
+    printf("%s.%06u | %s | %s[%d]/%s T=%s | %s %s%s%u | %s\n",
+           timeStr,
+           (unsigned)(msgPtr->timestamp % 1000000000 / 1000),
+           msgPtr->levelStr,
+           ringPtr->procNamePtr,
+           ringPtr->pid,
+           msgPtr->compName,
+           msgPtr->threadName,
+           msgPtr->fileName,
+           (msgPtr->functionName != NULL) ? msgPtr->functionName : "",
+           (msgPtr->functionName != NULL) ? "() " : "",
+           msgPtr->line,
+           msgPtr->msg);
+
+    ringPtr->count++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the messages held in a ring.
+ *
+ * @return The number of bytes the ring takes up.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t PrintRing
+(
+    const uint8_t* regionPtr,   ///< [IN] Start of the ring.
+    uint32_t dictSize,          ///< [IN] Size of the dictionary.
+    uint32_t ringSize,          ///< [IN] Size of the record ring.
+    uint64_t fileOffset         ///< [IN] Offset of the ring in the file.
+)
+{
+    logRing_Header_t header;
+    char procName[LOGRING_PROC_NAME_BYTES];
+
+    memcpy(&header, regionPtr, sizeof(header));
+    memcpy(procName, header.procName, sizeof(procName));
+    procName[sizeof(procName) - 1] = '\0';
+
+    // The oldest record still intact is where printing starts.  Records before the daemon's tail
+    // have already been logged, but the point is to see what happened most recently, so print
+    // them too.
+    uint64_t startPos = header.oldest;
+    if ((startPos > header.head) || (header.head - startPos > ringSize) || (startPos % 8 != 0))
+    {
+        fprintf(stderr,
+                "Ring of process '%s' (pid %d) at offset 0x%" PRIx64 " has bad positions.\n",
+                procName, (int)header.pid, fileOffset);
+        return sizeof(header) + dictSize + ringSize;
+    }
+
+    Ring_t ring = { .procNamePtr = procName, .pid = header.pid, .count = 0 };
+
+    printf("===== Process '%s' (pid %d), ring at offset 0x%" PRIx64
+           ", %" PRIu64 " messages logged directly for lack of room =====\n",
+           procName, (int)header.pid, fileOffset, header.overflows);
+
+    uint64_t endPos = logRing_Decode(regionPtr, dictSize, ringSize, startPos, header.head,
+                                     PrintMsg, &ring);
+    if (endPos != header.head)
+    {
+        fprintf(stderr, "Bad record at position %" PRIu64 " of ring of process '%s' (pid %d).\n",
+                endPos, procName, (int)header.pid);
+    }
+
+    printf("===== %u messages =====\n", ring.count);
+
+    return sizeof(header) + dictSize + ringSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry point.
+ */
+//--------------------------------------------------------------------------------------------------
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    if ((argc != 2) || (strcmp(argv[1], "--help") == 0) || (strcmp(argv[1], "-h") == 0))
+    {
+        PrintUsage(argv[0]);
+        exit(argc == 2 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    FILE* filePtr = (strcmp(argv[1], "-") == 0) ? stdin : fopen(argv[1], "r");
+    if (filePtr == NULL)
+    {
+        fprintf(stderr, "Can't open '%s': %s\n", argv[1], strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    size_t size;
+    uint8_t* bufPtr = ReadFile(filePtr, &size);
+    if (bufPtr == NULL)
+    {
+        fprintf(stderr, "Can't read '%s': %s\n", argv[1], strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    if (filePtr != stdin)
+    {
+        fclose(filePtr);
+    }
+
+    unsigned numRings = 0;
+    size_t offset = 0;
+
+    while (size - offset >= sizeof(logRing_Header_t))
+    {
+        uint32_t dictSize;
+        uint32_t ringSize;
+
+        if ((memcmp(bufPtr + offset, LOGRING_MAGIC, strlen(LOGRING_MAGIC)) == 0) &&
+            logRing_CheckHeader(bufPtr + offset, size - offset, &dictSize, &ringSize))
+        {
+            size_t ringBytes = PrintRing(bufPtr + offset, dictSize, ringSize, offset);
+            offset += (ringBytes + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+            numRings++;
+        }
+        else
+        {
+            offset += RING_ALIGNMENT;
+        }
+    }
+
+    free(bufPtr);
+
+    if (numRings == 0)
+    {
+        fprintf(stderr, "No log rings found in '%s'.\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,904 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file bsDiff.c  In-process bsdiff engine used by mkPatch
+ *
+ * The suffix sorting and the diff algorithm are those of bsdiff 4.3, see
+ * 3rdParty/bsdiff-4.3/bsdiff-4.3.tar.gz, so the patches built are byte-for-byte the ones written
+ * by the bsdiff tool:
+ *
+ * Copyright 2003-2005 Colin Percival
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted providing that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Adaptations: Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <pthread.h>
+#include <bzlib.h>
+
+#include "bsDiff.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the patch header: magic, size of the compressed control block, size of the compressed
+ * diff block and size of the destination image.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PATCH_HEADER_SIZE   32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of an offset in the patch header and in the control block
+ */
+//--------------------------------------------------------------------------------------------------
+#define OFFT_SIZE           8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * bzip2 block size (in 100k units), as used by bsdiff
+ */
+//--------------------------------------------------------------------------------------------------
+#define BZ2_BLOCK_SIZE      9
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Minimum of two values
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN(x, y)           (((x) < (y)) ? (x) : (y))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix array entry. Images are limited to 2 GB, so 32-bits entries halve the memory needed by
+ * the suffix sort compared to the off_t of bsdiff.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef int32_t SaIdx_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix array index of an original image
+ */
+//--------------------------------------------------------------------------------------------------
+struct bsDiff_Index
+{
+    const uint8_t *origPtr;     ///< Original image
+    int64_t origSize;           ///< Size of the original image
+    SaIdx_t *saPtr;             ///< Suffix array, origSize + 1 entries
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Growable buffer for the control block
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t *dataPtr;
+    size_t len;
+    size_t size;
+}
+Buffer_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work shared by the threads of bsDiff_DiffSegments()
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const bsDiff_Index_t *indexPtr;     ///< Index of the original image
+    const uint8_t *destPtr;             ///< Destination image
+    size_t destSize;                    ///< Size of the destination image
+    size_t segmentSize;                 ///< Size of a segment
+    size_t nbSegments;                  ///< Number of segments
+    bsDiff_Patch_t *patchesPtr;         ///< One patch per segment
+    size_t nextSegment;                 ///< Next segment to diff, taken atomically
+    le_result_t result;                 ///< First error met, LE_OK else
+}
+SegmentWork_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sort a group of suffixes by their h-th character rank (Larsson-Sadakane ternary split)
+ */
+//--------------------------------------------------------------------------------------------------
+static void Split
+(
+    SaIdx_t *I,
+    SaIdx_t *V,
+    SaIdx_t start,
+    SaIdx_t len,
+    SaIdx_t h
+)
+{
+    SaIdx_t i, j, k, x, tmp, jj, kk;
+
+    if( len < 16 )
+    {
+        for( k = start; k < start + len; k += j )
+        {
+            j = 1;
+            x = V[I[k] + h];
+            for( i = 1; k + i < start + len; i++ )
+            {
+                if( V[I[k + i] + h] < x )
+                {
+                    x = V[I[k + i] + h];
+                    j = 0;
+                }
+                if( V[I[k + i] + h] == x )
+                {
+                    tmp = I[k + j]; I[k + j] = I[k + i]; I[k + i] = tmp;
+                    j++;
+                }
+            }
+            for( i = 0; i < j; i++ )
+            {
+                V[I[k + i]] = k + j - 1;
+            }
+            if( j == 1 )
+            {
+                I[k] = -1;
+            }
+        }
+        return;
+    }
+
+    x = V[I[start + len / 2] + h];
+    jj = 0;
+    kk = 0;
+    for( i = start; i < start + len; i++ )
+    {
+        if( V[I[i] + h] < x )
+        {
+            jj++;
+        }
+        if( V[I[i] + h] == x )
+        {
+            kk++;
+        }
+    }
+    jj += start;
+    kk += jj;
+
+    i = start;
+    j = 0;
+    k = 0;
+    while( i < jj )
+    {
+        if( V[I[i] + h] < x )
+        {
+            i++;
+        }
+        else if( V[I[i] + h] == x )
+        {
+            tmp = I[i]; I[i] = I[jj + j]; I[jj + j] = tmp;
+            j++;
+        }
+        else
+        {
+            tmp = I[i]; I[i] = I[kk + k]; I[kk + k] = tmp;
+            k++;
+        }
+    }
+
+    while( jj + j < kk )
+    {
+        if( V[I[jj + j] + h] == x )
+        {
+            j++;
+        }
+        else
+        {
+            tmp = I[jj + j]; I[jj + j] = I[kk + k]; I[kk + k] = tmp;
+            k++;
+        }
+    }
+
+    if( jj > start )
+    {
+        Split( I, V, start, jj - start, h );
+    }
+
+    for( i = 0; i < kk - jj; i++ )
+    {
+        V[I[jj + i]] = kk - 1;
+    }
+    if( jj == kk - 1 )
+    {
+        I[jj] = -1;
+    }
+
+    if( start + len > kk )
+    {
+        Split( I, V, kk, start + len - kk, h );
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the suffix array I of an image, using V as work area. Both have size + 1 entries.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QSufSort
+(
+    SaIdx_t *I,
+    SaIdx_t *V,
+    const uint8_t *origPtr,
+    SaIdx_t size
+)
+{
+    SaIdx_t buckets[256];
+    SaIdx_t i, h, len;
+
+    memset( buckets, 0, sizeof(buckets) );
+    for( i = 0; i < size; i++ )
+    {
+        buckets[origPtr[i]]++;
+    }
+    for( i = 1; i < 256; i++ )
+    {
+        buckets[i] += buckets[i - 1];
+    }
+    for( i = 255; i > 0; i-- )
+    {
+        buckets[i] = buckets[i - 1];
+    }
+    buckets[0] = 0;
+
+    for( i = 0; i < size; i++ )
+    {
+        I[++buckets[origPtr[i]]] = i;
+    }
+    I[0] = size;
+    for( i = 0; i < size; i++ )
+    {
+        V[i] = buckets[origPtr[i]];
+    }
+    V[size] = 0;
+    for( i = 1; i < 256; i++ )
+    {
+        if( buckets[i] == buckets[i - 1] + 1 )
+        {
+            I[buckets[i]] = -1;
+        }
+    }
+    I[0] = -1;
+
+    for( h = 1; I[0] != -(size + 1); h += h )
+    {
+        len = 0;
+        for( i = 0; i < size + 1; )
+        {
+            if( I[i] < 0 )
+            {
+                len -= I[i];
+                i -= I[i];
+            }
+            else
+            {
+                if( len )
+                {
+                    I[i - len] = -len;
+                }
+                len = V[I[i]] + 1 - i;
+                Split( I, V, i, len, h );
+                i += len;
+                len = 0;
+            }
+        }
+        if( len )
+        {
+            I[i - len] = -len;
+        }
+    }
+
+    for( i = 0; i < size + 1; i++ )
+    {
+        I[V[i]] = i;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Length of the common prefix of two buffers
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t MatchLen
+(
+    const uint8_t *origPtr,
+    int64_t origSize,
+    const uint8_t *destPtr,
+    int64_t destSize
+)
+{
+    int64_t i;
+
+    for( i = 0; (i < origSize) && (i < destSize); i++ )
+    {
+        if( origPtr[i] != destPtr[i] )
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Binary search of the suffix array for the longest match of a buffer between entries st and en
+ *
+ * @return The length of the match, its position in the original image being stored in *posPtr
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t Search
+(
+    const bsDiff_Index_t *indexPtr,
+    const uint8_t *destPtr,
+    int64_t destSize,
+    int64_t st,
+    int64_t en,
+    int64_t *posPtr
+)
+{
+    const SaIdx_t *I = indexPtr->saPtr;
+    const uint8_t *origPtr = indexPtr->origPtr;
+    int64_t origSize = indexPtr->origSize;
+    int64_t x, y;
+
+    while( en - st >= 2 )
+    {
+        x = st + (en - st) / 2;
+        if( memcmp( origPtr + I[x], destPtr, MIN(origSize - I[x], destSize) ) < 0 )
+        {
+            st = x;
+        }
+        else
+        {
+            en = x;
+        }
+    }
+
+    x = MatchLen( origPtr + I[st], origSize - I[st], destPtr, destSize );
+    y = MatchLen( origPtr + I[en], origSize - I[en], destPtr, destSize );
+
+    if( x > y )
+    {
+        *posPtr = I[st];
+        return x;
+    }
+    *posPtr = I[en];
+    return y;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode an offset as bsdiff does: 8 bytes little-endian magnitude, sign in the top bit
+ */
+//--------------------------------------------------------------------------------------------------
+static void OfftOut
+(
+    int64_t x,
+    uint8_t *bufPtr
+)
+{
+    uint64_t y = (x < 0) ? -(uint64_t)x : (uint64_t)x;
+    int i;
+
+    for( i = 0; i < OFFT_SIZE; i++ )
+    {
+        bufPtr[i] = y & 0xFFU;
+        y >>= 8;
+    }
+    if( x < 0 )
+    {
+        bufPtr[OFFT_SIZE - 1] |= 0x80U;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a control triplet to the control block
+ *
+ * @return
+ *      - LE_OK         On success
+ *      - LE_NO_MEMORY  Memory is exhausted
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendCtrl
+(
+    Buffer_t *ctrlPtr,
+    int64_t diffLen,
+    int64_t extraLen,
+    int64_t seek
+)
+{
+    if( ctrlPtr->len + (3 * OFFT_SIZE) > ctrlPtr->size )
+    {
+        size_t size = ctrlPtr->size ? (2 * ctrlPtr->size) : (1024 * 3 * OFFT_SIZE);
+        uint8_t *dataPtr = realloc( ctrlPtr->dataPtr, size );
+
+        if( NULL == dataPtr )
+        {
+            return LE_NO_MEMORY;
+        }
+        ctrlPtr->dataPtr = dataPtr;
+        ctrlPtr->size = size;
+    }
+
+    OfftOut( diffLen, ctrlPtr->dataPtr + ctrlPtr->len );
+    OfftOut( extraLen, ctrlPtr->dataPtr + ctrlPtr->len + OFFT_SIZE );
+    OfftOut( seek, ctrlPtr->dataPtr + ctrlPtr->len + (2 * OFFT_SIZE) );
+    ctrlPtr->len += 3 * OFFT_SIZE;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worst case size of bzip2 output, as documented for BZ2_bzBuffToBuffCompress()
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Bz2Bound
+(
+    size_t len
+)
+{
+    return len + (len / 100) + 600;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compress a block into the patch
+ *
+ * @return
+ *      - LE_OK         On success, *lenPtr being the compressed size
+ *      - LE_FAULT      The compression fails
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Compress
+(
+    const uint8_t *srcPtr,
+    size_t srcLen,
+    uint8_t *outPtr,
+    size_t outSize,
+    size_t *lenPtr
+)
+{
+    static const uint8_t empty = 0;
+    unsigned int outLen = outSize;
+    int rc;
+
+    // An empty block is still a bzip2 stream, but bzip2 rejects a NULL source
+    rc = BZ2_bzBuffToBuffCompress( (char *)outPtr, &outLen,
+                                   (char *)(srcPtr ? srcPtr : &empty), srcLen,
+                                   BZ2_BLOCK_SIZE, 0, 0 );
+    if( BZ_OK != rc )
+    {
+        fprintf(stderr, "BZ2_bzBuffToBuffCompress() fails: %d\n", rc);
+        return LE_FAULT;
+    }
+    *lenPtr = outLen;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the suffix array index of an original image.
+ */
+//--------------------------------------------------------------------------------------------------
+bsDiff_Index_t *bsDiff_CreateIndex
+(
+    const uint8_t *origPtr,
+    size_t origSize
+)
+{
+    bsDiff_Index_t *indexPtr;
+    SaIdx_t *vPtr;
+
+    if( origSize >= INT32_MAX )
+    {
+        fprintf(stderr, "Original image too large: %zu bytes\n", origSize);
+        return NULL;
+    }
+
+    indexPtr = calloc( 1, sizeof(*indexPtr) );
+    if( NULL == indexPtr )
+    {
+        return NULL;
+    }
+    indexPtr->origPtr = origPtr;
+    indexPtr->origSize = origSize;
+    indexPtr->saPtr = malloc( (origSize + 1) * sizeof(SaIdx_t) );
+    vPtr = malloc( (origSize + 1) * sizeof(SaIdx_t) );
+    if( (NULL == indexPtr->saPtr) || (NULL == vPtr) )
+    {
+        free( vPtr );
+        bsDiff_DeleteIndex( indexPtr );
+        return NULL;
+    }
+
+    QSufSort( indexPtr->saPtr, vPtr, origPtr, origSize );
+    free( vPtr );
+
+    return indexPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete an index built by bsDiff_CreateIndex()
+ */
+//--------------------------------------------------------------------------------------------------
+void bsDiff_DeleteIndex
+(
+    bsDiff_Index_t *indexPtr
+)
+{
+    if( indexPtr )
+    {
+        free( indexPtr->saPtr );
+        free( indexPtr );
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the patch turning the original image of an index into a destination image.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bsDiff_Diff
+(
+    const bsDiff_Index_t *indexPtr,
+    const uint8_t *destPtr,
+    size_t destSize,
+    bsDiff_Patch_t *patchPtr
+)
+{
+    const uint8_t *origPtr = indexPtr->origPtr;
+    int64_t origSize = indexPtr->origSize;
+    int64_t newSize = destSize;
+    int64_t scan, pos = 0, len;
+    int64_t lastScan, lastPos, lastOffset;
+    int64_t oldScore, scsc;
+    int64_t s, sf, lenf, sb, lenb;
+    int64_t overlap, ss, lens;
+    int64_t i;
+    size_t dbLen = 0, ebLen = 0;
+    size_t ctrlZLen, dbZLen, ebZLen, outSize;
+    uint8_t *dbPtr, *ebPtr, *outPtr = NULL;
+    Buffer_t ctrl = { NULL, 0, 0 };
+    le_result_t result = LE_NO_MEMORY;
+
+    patchPtr->dataPtr = NULL;
+    patchPtr->size = 0;
+
+    // Allocate newSize + 1 bytes to never malloc(0)
+    dbPtr = malloc( newSize + 1 );
+    ebPtr = malloc( newSize + 1 );
+    if( (NULL == dbPtr) || (NULL == ebPtr) )
+    {
+        goto out;
+    }
+
+    scan = 0;
+    len = 0;
+    lastScan = 0;
+    lastPos = 0;
+    lastOffset = 0;
+    while( scan < newSize )
+    {
+        oldScore = 0;
+
+        for( scsc = scan += len; scan < newSize; scan++ )
+        {
+            len = Search( indexPtr, destPtr + scan, newSize - scan, 0, origSize, &pos );
+
+            for( ; scsc < scan + len; scsc++ )
+            {
+                if( (scsc + lastOffset < origSize) &&
+                    (origPtr[scsc + lastOffset] == destPtr[scsc]) )
+                {
+                    oldScore++;
+                }
+            }
+
+            if( ((len == oldScore) && (len != 0)) || (len > oldScore + 8) )
+            {
+                break;
+            }
+
+            if( (scan + lastOffset < origSize) &&
+                (origPtr[scan + lastOffset] == destPtr[scan]) )
+            {
+                oldScore--;
+            }
+        }
+
+        if( (len != oldScore) || (scan == newSize) )
+        {
+            s = 0;
+            sf = 0;
+            lenf = 0;
+            for( i = 0; (lastScan + i < scan) && (lastPos + i < origSize); )
+            {
+                if( origPtr[lastPos + i] == destPtr[lastScan + i] )
+                {
+                    s++;
+                }
+                i++;
+                if( s * 2 - i > sf * 2 - lenf )
+                {
+                    sf = s;
+                    lenf = i;
+                }
+            }
+
+            lenb = 0;
+            if( scan < newSize )
+            {
+                s = 0;
+                sb = 0;
+                for( i = 1; (scan >= lastScan + i) && (pos >= i); i++ )
+                {
+                    if( origPtr[pos - i] == destPtr[scan - i] )
+                    {
+                        s++;
+                    }
+                    if( s * 2 - i > sb * 2 - lenb )
+                    {
+                        sb = s;
+                        lenb = i;
+                    }
+                }
+            }
+
+            if( lastScan + lenf > scan - lenb )
+            {
+                overlap = (lastScan + lenf) - (scan - lenb);
+                s = 0;
+                ss = 0;
+                lens = 0;
+                for( i = 0; i < overlap; i++ )
+                {
+                    if( destPtr[lastScan + lenf - overlap + i] ==
+                        origPtr[lastPos + lenf - overlap + i] )
+                    {
+                        s++;
+                    }
+                    if( destPtr[scan - lenb + i] == origPtr[pos - lenb + i] )
+                    {
+                        s--;
+                    }
+                    if( s > ss )
+                    {
+                        ss = s;
+                        lens = i + 1;
+                    }
+                }
+
+                lenf += lens - overlap;
+                lenb -= lens;
+            }
+
+            for( i = 0; i < lenf; i++ )
+            {
+                dbPtr[dbLen + i] = destPtr[lastScan + i] - origPtr[lastPos + i];
+            }
+            for( i = 0; i < (scan - lenb) - (lastScan + lenf); i++ )
+            {
+                ebPtr[ebLen + i] = destPtr[lastScan + lenf + i];
+            }
+
+            dbLen += lenf;
+            ebLen += (scan - lenb) - (lastScan + lenf);
+
+            if( LE_OK != AppendCtrl( &ctrl,
+                                     lenf,
+                                     (scan - lenb) - (lastScan + lenf),
+                                     (pos - lenb) - (lastPos + lenf) ) )
+            {
+                goto out;
+            }
+
+            lastScan = scan - lenb;
+            lastPos = pos - lenb;
+            lastOffset = pos - scan;
+        }
+    }
+
+    // Patch is the header followed by the compressed control, diff and extra blocks
+    outSize = PATCH_HEADER_SIZE + Bz2Bound( ctrl.len ) + Bz2Bound( dbLen ) + Bz2Bound( ebLen );
+    outPtr = malloc( outSize );
+    if( NULL == outPtr )
+    {
+        goto out;
+    }
+
+    result = Compress( ctrl.dataPtr, ctrl.len,
+                       outPtr + PATCH_HEADER_SIZE, outSize - PATCH_HEADER_SIZE, &ctrlZLen );
+    if( LE_OK != result )
+    {
+        goto out;
+    }
+    result = Compress( dbPtr, dbLen,
+                       outPtr + PATCH_HEADER_SIZE + ctrlZLen,
+                       outSize - PATCH_HEADER_SIZE - ctrlZLen, &dbZLen );
+    if( LE_OK != result )
+    {
+        goto out;
+    }
+    result = Compress( ebPtr, ebLen,
+                       outPtr + PATCH_HEADER_SIZE + ctrlZLen + dbZLen,
+                       outSize - PATCH_HEADER_SIZE - ctrlZLen - dbZLen, &ebZLen );
+    if( LE_OK != result )
+    {
+        goto out;
+    }
+
+    memcpy( outPtr, "BSDIFF40", 8 );
+    OfftOut( ctrlZLen, outPtr + 8 );
+    OfftOut( dbZLen, outPtr + 16 );
+    OfftOut( newSize, outPtr + 24 );
+
+    patchPtr->dataPtr = outPtr;
+    patchPtr->size = PATCH_HEADER_SIZE + ctrlZLen + dbZLen + ebZLen;
+    outPtr = NULL;
+
+out:
+    free( outPtr );
+    free( ctrl.dataPtr );
+    free( ebPtr );
+    free( dbPtr );
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread of bsDiff_DiffSegments(): take the next segment until all are done or one fails
+ */
+//--------------------------------------------------------------------------------------------------
+static void *DiffSegmentThread
+(
+    void *contextPtr
+)
+{
+    SegmentWork_t *workPtr = contextPtr;
+    size_t segment;
+    size_t offset;
+    le_result_t result;
+
+    while( LE_OK == __atomic_load_n( &workPtr->result, __ATOMIC_RELAXED ) )
+    {
+        segment = __atomic_fetch_add( &workPtr->nextSegment, 1, __ATOMIC_RELAXED );
+        if( segment >= workPtr->nbSegments )
+        {
+            break;
+        }
+
+        offset = segment * workPtr->segmentSize;
+        result = bsDiff_Diff( workPtr->indexPtr,
+                              workPtr->destPtr + offset,
+                              MIN(workPtr->segmentSize, workPtr->destSize - offset),
+                              &workPtr->patchesPtr[segment] );
+        if( LE_OK != result )
+        {
+            le_result_t expected = LE_OK;
+
+            __atomic_compare_exchange_n( &workPtr->result, &expected, result, false,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the patches of all segments of a destination image, on up to nbThreads threads.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bsDiff_DiffSegments
+(
+    const bsDiff_Index_t *indexPtr,
+    const uint8_t *destPtr,
+    size_t destSize,
+    size_t segmentSize,
+    int nbThreads,
+    bsDiff_Patch_t *patchesPtr
+)
+{
+    SegmentWork_t work;
+    pthread_t *threadsPtr;
+    int nbStarted;
+    size_t i;
+
+    memset( &work, 0, sizeof(work) );
+    work.indexPtr = indexPtr;
+    work.destPtr = destPtr;
+    work.destSize = destSize;
+    work.segmentSize = segmentSize;
+    work.nbSegments = (destSize + segmentSize - 1) / segmentSize;
+    work.patchesPtr = patchesPtr;
+    work.result = LE_OK;
+
+    memset( patchesPtr, 0, work.nbSegments * sizeof(*patchesPtr) );
+
+    if( (size_t)nbThreads > work.nbSegments )
+    {
+        nbThreads = work.nbSegments;
+    }
+    if( nbThreads <= 1 )
+    {
+        DiffSegmentThread( &work );
+    }
+    else
+    {
+        threadsPtr = malloc( nbThreads * sizeof(*threadsPtr) );
+        if( NULL == threadsPtr )
+        {
+            return LE_NO_MEMORY;
+        }
+        for( nbStarted = 0; nbStarted < nbThreads; nbStarted++ )
+        {
+            if( 0 != pthread_create( &threadsPtr[nbStarted], NULL, DiffSegmentThread, &work ) )
+            {
+                fprintf(stderr, "pthread_create() fails: %m\n");
+                __atomic_store_n( &work.result, LE_FAULT, __ATOMIC_RELAXED );
+                break;
+            }
+        }
+        for( i = 0; i < (size_t)nbStarted; i++ )
+        {
+            pthread_join( threadsPtr[i], NULL );
+        }
+        free( threadsPtr );
+    }
+
+    if( LE_OK != work.result )
+    {
+        for( i = 0; i < work.nbSegments; i++ )
+        {
+            bsDiff_FreePatch( &patchesPtr[i] );
+        }
+    }
+    return work.result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a patch built by bsDiff_Diff() or bsDiff_DiffSegments()
+ */
+//--------------------------------------------------------------------------------------------------
+void bsDiff_FreePatch
+(
+    bsDiff_Patch_t *patchPtr
+)
+{
+    free( patchPtr->dataPtr );
+    patchPtr->dataPtr = NULL;
+    patchPtr->size = 0;
+}
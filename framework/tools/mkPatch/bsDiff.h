@@ -0,0 +1,115 @@
+/**
+ * @file bsDiff.h
+ *
+ * In-process delta engine producing patches in the bsdiff 4.x "BSDIFF40" format, as applied by
+ * bsPatch() on the target.
+ *
+ * The suffix array of the original image is built once by bsDiff_CreateIndex() and is then only
+ * read, so it is shared by all the segments diffed against that image, and by all the threads of
+ * bsDiff_DiffSegments().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef BSDIFF_INCLUDE_GUARD
+#define BSDIFF_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix array index of an original image. Opaque.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct bsDiff_Index bsDiff_Index_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A patch built by the engine
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t *dataPtr;       ///< Patch data, allocated with malloc(3)
+    size_t   size;          ///< Size of the patch data
+}
+bsDiff_Patch_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the suffix array index of an original image. The image is not copied and must remain
+ * valid until the index is deleted.
+ *
+ * @return
+ *      - The index
+ *      - NULL if the image is too large or if memory is exhausted
+ */
+//--------------------------------------------------------------------------------------------------
+bsDiff_Index_t *bsDiff_CreateIndex
+(
+    const uint8_t *origPtr,     ///< [IN] Original image
+    size_t origSize             ///< [IN] Size of the original image
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete an index built by bsDiff_CreateIndex()
+ */
+//--------------------------------------------------------------------------------------------------
+void bsDiff_DeleteIndex
+(
+    bsDiff_Index_t *indexPtr    ///< [IN] Index to delete
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the patch turning the original image of an index into a destination image. The patch is
+ * identical to the one written by "bsdiff orig dest patch".
+ *
+ * @return
+ *      - LE_OK         The patch is built and must be released with bsDiff_FreePatch()
+ *      - LE_NO_MEMORY  Memory is exhausted
+ *      - LE_FAULT      The compression of the patch fails
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bsDiff_Diff
+(
+    const bsDiff_Index_t *indexPtr, ///< [IN] Index of the original image
+    const uint8_t *destPtr,         ///< [IN] Destination image
+    size_t destSize,                ///< [IN] Size of the destination image
+    bsDiff_Patch_t *patchPtr        ///< [OUT] Patch built
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split a destination image into segments of segmentSize bytes (the last one may be shorter) and
+ * build the patch of each segment against the original image of an index, using up to nbThreads
+ * threads. Patch n is always the one of segment n, so the result does not depend on nbThreads.
+ *
+ * @return
+ *      - LE_OK         All patches are built and must be released with bsDiff_FreePatch()
+ *      - LE_NO_MEMORY  Memory is exhausted
+ *      - LE_FAULT      The compression of a patch or the creation of a thread fails
+ *
+ * @note On failure, no patch is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bsDiff_DiffSegments
+(
+    const bsDiff_Index_t *indexPtr, ///< [IN] Index of the original image
+    const uint8_t *destPtr,         ///< [IN] Destination image
+    size_t destSize,                ///< [IN] Size of the destination image
+    size_t segmentSize,             ///< [IN] Size of a segment
+    int nbThreads,                  ///< [IN] Maximum number of threads to use
+    bsDiff_Patch_t *patchesPtr      ///< [OUT] One patch per segment
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a patch built by bsDiff_Diff() or bsDiff_DiffSegments()
+ */
+//--------------------------------------------------------------------------------------------------
+void bsDiff_FreePatch
+(
+    bsDiff_Patch_t *patchPtr    ///< [IN] Patch to release
+);
+
+#endif // BSDIFF_INCLUDE_GUARD
@@ -11,13 +11,13 @@
 #include <endian.h>
 
 #include "flash-ubi.h"
+#include "bsDiff.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Defines some executables requested by the tool
  */
 //--------------------------------------------------------------------------------------------------
-#define BSDIFF "bsdiff"
 #define HDRCNV "hdrcnv"
 
 //--------------------------------------------------------------------------------------------------
@@ -205,17 +205,10 @@ static DeltaPatchHeader_t PatchHeader;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Buffer for the segment to read
+ * Number of threads building the segment patches. Default is the number of online CPUs.
  */
 //--------------------------------------------------------------------------------------------------
-static uint8_t Chunk[SEGMENT_SIZE];
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Buffer for the segment patch
- */
-//--------------------------------------------------------------------------------------------------
-static uint8_t PatchedChunk[2 * SEGMENT_SIZE];
+static int NbJobs = 0;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -791,6 +784,60 @@ static void ExecSystem
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole image into memory and compute its CRC32. In case of error, call exit(3).
+ *
+ * @return The image, to be released with free(3)
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t *ReadImage
+(
+    const char *namePtr,
+    const char *kindPtr,
+    size_t *sizePtr,
+    uint32_t *crc32Ptr
+)
+{
+    int fd;
+    struct stat st;
+    uint8_t *imagePtr;
+    size_t size = 0;
+    ssize_t len = 0;
+
+    fd = open( namePtr, O_RDONLY );
+    if( 0 > fd )
+    {
+        fprintf(stderr, "Unable to open %s file %s: %m\n", kindPtr, namePtr);
+        exit(1);
+    }
+    fstat( fd, &st );
+
+    // Allocate one more byte to never malloc(0)
+    imagePtr = malloc( st.st_size + 1 );
+    if( NULL == imagePtr )
+    {
+        fprintf(stderr, "Unable to allocate %lld bytes for %s file %s\n",
+                (long long)st.st_size, kindPtr, namePtr);
+        exit(1);
+    }
+    while( (size < (size_t)st.st_size) &&
+           (0 < (len = read( fd, imagePtr + size, st.st_size - size ))) )
+    {
+        size += len;
+    }
+    if( 0 > len )
+    {
+        fprintf(stderr, "read() fails: %m\n" );
+        exit(4);
+    }
+    close( fd );
+
+    *sizePtr = size;
+    *crc32Ptr = le_crc_Crc32( imagePtr, size, LE_CRC_START_CRC32 );
+    return imagePtr;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print usage and exit...
@@ -802,7 +849,7 @@ static void Usage
 )
 {
     fprintf(stderr,
-            "usage: %s -T TARGET [-o patchname] [-S 4K|2K] [-E 256K|128K] [-N] [-v]\n"
+            "usage: %s -T TARGET [-o patchname] [-S 4K|2K] [-E 256K|128K] [-N] [-j JOBS] [-v]\n"
             "        {-p PART {[-U VOLID] file-orig file-dest}}\n",
             ProgName );
     fprintf(stderr, "\n");
@@ -817,6 +864,9 @@ static void Usage
                     "        Specify another PEB size (optional - specified only one time).\n");
     fprintf(stderr, "   -N, --no-spkg-header\n"
                     "        Do not generate the CWE SPKG header.\n");
+    fprintf(stderr, "   -j, --jobs <JOBS>\n"
+                    "        Build the segment patches with JOBS threads. Default is the number\n"
+                    "        of CPUs. The patch does not depend on JOBS.\n");
     fprintf(stderr, "   -v, --verbose\n"
                     "        Be verbose.\n");
     fprintf(stderr, "   -p, --partition <PART>\n"
@@ -851,7 +901,7 @@ static void CheckForTool
         exit(1);
     }
     toolPathPtr = fgets( toolPath, sizeof(toolPath), fdPtr );
-    fclose( fdPtr );
+    pclose( fdPtr );
     if( !toolPathPtr )
     {
         fprintf(stderr,
@@ -885,7 +935,7 @@ int main
 {
     char tmpName[PATH_MAX];
     int fdr, fdw, fdp;
-    int len, patchNum = 0;
+    int patchNum = 0;
     int iargc = argc;
     char** argvPtr = &argv[1];
     struct stat st;
@@ -907,10 +957,16 @@ int main
     char* toolchainPtr = NULL;
     char* toolchainEnvPtr = NULL;
     char* envPtr = NULL;
+    uint8_t* origImagePtr;
+    uint8_t* destImagePtr;
+    size_t origSize, destSize;
+    bsDiff_Index_t* origIndexPtr;
+    bsDiff_Patch_t* patchesPtr;
+    uint8_t miscOpts;
+    le_result_t result;
 
     ProgName = argv[0];
-
-    CheckForTool( BSDIFF, NULL );
+    NbJobs = sysconf( _SC_NPROCESSORS_ONLN );
 
     getcwd(CurrentWorkDir, sizeof(CurrentWorkDir));
     atexit( Exithandler );
@@ -1044,6 +1100,23 @@ int main
             iargc--;
         }
 
+        else if( (iargc >= 5) &&
+                 ((0 == strcmp(*argvPtr, "--jobs")) || (0 == strcmp(*argvPtr, "-j"))) )
+        {
+            char *endPtr;
+
+            ++argvPtr;
+            errno = 0;
+            NbJobs = strtol( *argvPtr, &endPtr, 10 );
+            if( (errno) || (*endPtr) || (NbJobs <= 0) )
+            {
+                fprintf(stderr, "Incorrect number of jobs '%s'\n", *argvPtr );
+                exit(1);
+            }
+            ++argvPtr;
+            iargc -= 2;
+        }
+
         else if( (iargc >= 4) &&
                  ((0 == strcmp(*argvPtr, "--verbose")) || (0 == strcmp(*argvPtr, "-v"))) )
         {
@@ -1133,7 +1206,7 @@ int main
             OrigPtr = *(argvPtr++);
             DestPtr = *(argvPtr++);
             iargc -= 2;
-            chunkLen = sizeof(Chunk);
+            chunkLen = SEGMENT_SIZE;
             ubiVolId = ((uint32_t)-1);
         }
 
@@ -1215,6 +1288,8 @@ int main
         nbVolume = (nbVolumeOrig > nbVolumeDest) ? nbVolumeDest : nbVolumeOrig;
         do
         {
+            int i;
+
             patchNum = 0;
 
             memset( &PatchMetaHeader, 0, sizeof(PatchMetaHeader) );
@@ -1233,22 +1308,8 @@ int main
             {
                 snprintf(OrigName, sizeof(OrigName), "%s", OrigPtr);
             }
-            fdr = open( OrigName, O_RDONLY );
-            if( 0 > fdr )
-            {
-                fprintf(stderr, "Unable to open origin file %s: %m\n", OrigName);
-                exit(1);
-            }
-            fstat( fdr, &st );
-            PatchMetaHeader.origSize = htobe32(st.st_size);
-
-            crc32Orig = LE_CRC_START_CRC32;
-
-            while( 0 < (len = read( fdr, Chunk, chunkLen )) )
-            {
-                crc32Orig = le_crc_Crc32( Chunk, len, crc32Orig );
-            }
-            close( fdr );
+            origImagePtr = ReadImage( OrigName, "origin", &origSize, &crc32Orig );
+            PatchMetaHeader.origSize = htobe32(origSize);
             PatchMetaHeader.origCrc32 = htobe32(crc32Orig);
 
             if( notUbiOpt && isUbiImage )
@@ -1263,19 +1324,11 @@ int main
             {
                 snprintf(DestName, sizeof(DestName), "%s", DestPtr);
             }
-            fdr = open( DestName, O_RDONLY );
-            if( 0 > fdr )
-            {
-                fprintf(stderr, "Unable to open destination file %s: %m\n", DestPtr);
-                exit(1);
-            }
-            fstat( fdr, &st );
-            PatchMetaHeader.destSize = htobe32(st.st_size);
+            destImagePtr = ReadImage( DestName, "destination", &destSize, &crc32Dest );
+            PatchMetaHeader.destSize = htobe32(destSize);
 
             PatchMetaHeader.ubiVolId = htobe32(ubiVolId);
 
-            crc32Dest = LE_CRC_START_CRC32;
-
             snprintf( tmpName, sizeof(tmpName),
                       "patch.%u.bin",
                       pid );
@@ -1287,58 +1340,49 @@ int main
             }
             write( fdp, &PatchMetaHeader, sizeof(PatchMetaHeader) );
 
-            while( 0 < (len = read( fdr, Chunk, chunkLen)) )
+            // The suffix array of the origin is built once and shared by all segments, which are
+            // diffed in parallel. Patches are then written in segment order.
+            origIndexPtr = bsDiff_CreateIndex( origImagePtr, origSize );
+            if( NULL == origIndexPtr )
             {
-                crc32Dest = le_crc_Crc32( Chunk, len, crc32Dest );
-                snprintf( tmpName, sizeof(tmpName), "patchdest.%u.bin.%d", pid, patchNum );
-                fdw = open( tmpName, O_WRONLY | O_TRUNC | O_CREAT, S_IWUSR | S_IRUSR );
-                if( 0 <= fdw )
-                {
-                    write( fdw, Chunk, len );
-                    close( fdw );
-                }
-                else {
-                    fprintf( stderr, "Open of patch file %s fails: %m\n", tmpName );
-                    exit(3);
-                }
-                snprintf( CmdBuf, sizeof(CmdBuf),
-                          BSDIFF " %s %s patched.%u.bin.%d",
-                          OrigName, tmpName, pid, patchNum );
-                if( IsVerbose )
-                {
-                    printf( "%s\n", CmdBuf );
-                }
-                ExecSystem( CmdBuf );
-                snprintf( tmpName, sizeof(tmpName), "patched.%u.bin.%d", pid, patchNum );
-                fdw = open( tmpName, O_RDONLY );
-                if( 0 > fdw )
-                {
-                    fprintf(stderr, "Unable to open destination file %s: %m\n", tmpName);
-                    exit(1);
-                }
-                fstat( fdw, &st );
-                PatchHeader.offset = htobe32(patchNum * chunkLen);
-                patchNum++;
-                PatchHeader.number = htobe32(patchNum);
-                PatchHeader.size = htobe32(st.st_size);
+                fprintf(stderr, "Unable to index origin file %s\n", OrigName);
+                exit(1);
+            }
+            patchNum = (destSize + chunkLen - 1) / chunkLen;
+            patchesPtr = calloc( patchNum + 1, sizeof(*patchesPtr) );
+            if( NULL == patchesPtr )
+            {
+                fprintf(stderr, "Unable to allocate %d segment patches\n", patchNum);
+                exit(1);
+            }
+            if( IsVerbose )
+            {
+                printf( "Diffing %d segments of %s with %d jobs\n", patchNum, DestName, NbJobs );
+            }
+            result = bsDiff_DiffSegments( origIndexPtr, destImagePtr, destSize, chunkLen, NbJobs,
+                                          patchesPtr );
+            if( LE_OK != result )
+            {
+                fprintf(stderr, "Unable to build patch of %s: %d\n", DestName, result);
+                exit(3);
+            }
+            bsDiff_DeleteIndex( origIndexPtr );
+            free( origImagePtr );
+            free( destImagePtr );
+
+            for( i = 0; i < patchNum; i++ )
+            {
+                PatchHeader.offset = htobe32(i * chunkLen);
+                PatchHeader.number = htobe32(i + 1);
+                PatchHeader.size = htobe32(patchesPtr[i].size);
                 printf("Patch Header: offset 0x%x number %d size %u (0x%x)\n",
                        be32toh(PatchHeader.offset), be32toh(PatchHeader.number),
                        be32toh(PatchHeader.size), be32toh(PatchHeader.size));
-                len = read( fdw, PatchedChunk, st.st_size );
-                if( 0 > len )
-                {
-                    fprintf(stderr, "read() fails: %m\n" );
-                    exit(4);
-                }
-                close(fdw);
                 write( fdp, &PatchHeader, sizeof(PatchHeader) );
-                write( fdp, PatchedChunk, st.st_size );
-            }
-            if( len < 0 )
-            {
-                fprintf(stderr, "read() fails: %m\n" );
-                exit(4);
+                write( fdp, patchesPtr[i].dataPtr, patchesPtr[i].size );
+                bsDiff_FreePatch( &patchesPtr[i] );
             }
+            free( patchesPtr );
 
             PatchMetaHeader.destCrc32 = htobe32(crc32Dest);
             PatchMetaHeader.numPatches = htobe32(patchNum);
@@ -1354,7 +1398,6 @@ int main
                     be32toh(PatchMetaHeader.ubiVolId),
                     be32toh(PatchMetaHeader.origSize), be32toh(PatchMetaHeader.origCrc32),
                     be32toh(PatchMetaHeader.destSize), be32toh(PatchMetaHeader.destCrc32));
-            close( fdr );
             close( fdp );
 
             snprintf( CmdBuf, sizeof(CmdBuf),
@@ -1378,15 +1421,15 @@ int main
                 close(fdw);
                 exit(6);
             }
-            read( fdw, Chunk, 1 );
-            Chunk[0] |= MISC_OPTS_DELTAPATCH;
+            read( fdw, &miscOpts, 1 );
+            miscOpts |= MISC_OPTS_DELTAPATCH;
             if (0 > lseek64( fdw, MISC_OPTS_OFFSET, SEEK_SET ))
             {
                 fprintf(stderr, "%s %d; lseek64() fails: %m\n", __func__, __LINE__);
                 close(fdw);
                 exit(7);
             }
-            write( fdw, Chunk, 1 );
+            write( fdw, &miscOpts, 1 );
             close(fdw);
             ubiIdx++;
 
@@ -0,0 +1,491 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file mkPatchBench.c  Benchmark of the delta patch generation of mkPatch
+ *
+ * Builds a set of synthetic original and destination images, and times the generation of their
+ * segment patches, as done by mkPatch, for an increasing number of threads. Patches built with
+ * several threads are checked to be identical to those built with one thread.
+ *
+ * With -x, the external bsdiff tool is also run on each segment, as mkPatch did before the diff
+ * engine was linked in, and its patches are checked to be identical too.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <time.h>
+
+#include "bsDiff.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Segment sizes used by mkPatch: raw images, and UBI volumes (256K PEB less two 4K pages)
+ */
+//--------------------------------------------------------------------------------------------------
+#define SEGMENT_SIZE        (1024U * 1024U)
+#define UBI_SEGMENT_SIZE    ((256 * 1024U) - (2 * 4096U))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of distinct "words" the synthetic images are built from. Reusing words gives the images
+ * the repeated content of real firmware, which is what makes the suffix search work.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NB_WORDS            4096
+#define MAX_WORD_LEN        64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Minimum of two values
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN(x, y)           (((x) < (y)) ? (x) : (y))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Synthetic image of the set
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char *namePtr;        ///< Name of the image
+    size_t sizeMult;            ///< Size, in multiples of the base size
+    size_t segmentSize;         ///< Size of a patch segment
+    unsigned int editsPerMB;    ///< Bytes changed per MB
+    unsigned int movesPerMB;    ///< Insertions and deletions per MB
+}
+ImageDesc_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Image set: a kernel-like image with scattered changes, a larger rootfs-like image with more
+ * moved content, and a UBI volume diffed with the UBI segment size.
+ */
+//--------------------------------------------------------------------------------------------------
+static const ImageDesc_t ImageSet[] =
+{
+    { "boot",   1, SEGMENT_SIZE,     500,  8  },
+    { "system", 3, SEGMENT_SIZE,     200,  32 },
+    { "ubi",    1, UBI_SEGMENT_SIZE, 1000, 16 },
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the pseudo-random generator, so the image set only depends on the seed
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t RandState;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pseudo-random generator (xorshift64*)
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t Rand
+(
+    void
+)
+{
+    RandState ^= RandState >> 12;
+    RandState ^= RandState << 25;
+    RandState ^= RandState >> 27;
+    return RandState * 0x2545F4914F6CDD1DULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the monotonic time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double Now
+(
+    void
+)
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate memory or exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void *Alloc
+(
+    size_t size
+)
+{
+    void *ptr = malloc( size );
+
+    if( NULL == ptr )
+    {
+        fprintf(stderr, "Unable to allocate %zu bytes\n", size);
+        exit(1);
+    }
+    return ptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build an original image of the given size from the words
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t *MakeOrig
+(
+    uint8_t (*wordsPtr)[MAX_WORD_LEN],
+    const uint8_t *wordLenPtr,
+    size_t size
+)
+{
+    uint8_t *imagePtr = Alloc( size + 1 );
+    size_t len = 0;
+
+    while( len < size )
+    {
+        int w = Rand() % NB_WORDS;
+        size_t n = MIN((size_t)wordLenPtr[w], size - len);
+
+        memcpy( imagePtr + len, wordsPtr[w], n );
+        len += n;
+    }
+    return imagePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build a destination image from an original: changed bytes, inserted and deleted runs, and a
+ * new tail. The size of the new image is returned in *sizePtr.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t *MakeDest
+(
+    const uint8_t *origPtr,
+    size_t origSize,
+    const ImageDesc_t *descPtr,
+    size_t *sizePtr
+)
+{
+    size_t mb = (origSize + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    size_t maxSize = origSize + (mb * descPtr->movesPerMB * 512) + (origSize / 16) + 1;
+    uint8_t *destPtr = Alloc( maxSize );
+    size_t size = origSize;
+    size_t i, pos, n;
+
+    memcpy( destPtr, origPtr, origSize );
+
+    for( i = 0; i < mb * descPtr->editsPerMB; i++ )
+    {
+        destPtr[Rand() % size] = Rand();
+    }
+
+    for( i = 0; i < mb * descPtr->movesPerMB; i++ )
+    {
+        pos = Rand() % size;
+        n = 1 + (Rand() % 512);
+        if( Rand() & 1 )
+        {
+            memmove( destPtr + pos + n, destPtr + pos, size - pos );
+            for( ; n > 0; n--, size++ )
+            {
+                destPtr[pos++] = Rand();
+            }
+        }
+        else
+        {
+            n = MIN(n, size - pos);
+            memmove( destPtr + pos, destPtr + pos + n, size - pos - n );
+            size -= n;
+        }
+    }
+
+    for( i = 0; i < origSize / 16; i++ )
+    {
+        destPtr[size++] = Rand();
+    }
+
+    *sizePtr = size;
+    return destPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a buffer to a file or exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFile
+(
+    const char *namePtr,
+    const uint8_t *dataPtr,
+    size_t size
+)
+{
+    FILE *filePtr = fopen( namePtr, "w" );
+
+    if( (NULL == filePtr) || (size != fwrite( dataPtr, 1, size, filePtr )) )
+    {
+        fprintf(stderr, "Unable to write %s: %m\n", namePtr);
+        exit(1);
+    }
+    fclose( filePtr );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the external bsdiff on each segment, as mkPatch used to, and compare its patches with those
+ * of the engine.
+ *
+ * @return The time taken, or a negative value if a patch differs
+ */
+//--------------------------------------------------------------------------------------------------
+static double RunExternal
+(
+    const char *dirPtr,
+    const uint8_t *origPtr,
+    size_t origSize,
+    const uint8_t *destPtr,
+    size_t destSize,
+    size_t segmentSize,
+    const bsDiff_Patch_t *patchesPtr
+)
+{
+    char origName[PATH_MAX], segName[PATH_MAX], patchName[PATH_MAX], cmd[3 * PATH_MAX + 16];
+    size_t nbSegments = (destSize + segmentSize - 1) / segmentSize;
+    double start, total = 0.0;
+    bool isSame = true;
+    size_t i;
+
+    snprintf( origName, sizeof(origName), "%s/orig", dirPtr );
+    snprintf( segName, sizeof(segName), "%s/seg", dirPtr );
+    snprintf( patchName, sizeof(patchName), "%s/patch", dirPtr );
+    WriteFile( origName, origPtr, origSize );
+
+    for( i = 0; i < nbSegments; i++ )
+    {
+        FILE *filePtr;
+        uint8_t *patchPtr;
+        long size;
+        int rc;
+
+        WriteFile( segName, destPtr + (i * segmentSize),
+                   MIN(segmentSize, destSize - (i * segmentSize)) );
+        snprintf( cmd, sizeof(cmd), "bsdiff %s %s %s", origName, segName, patchName );
+        start = Now();
+        rc = system( cmd );
+        total += Now() - start;
+        if( (!WIFEXITED(rc)) || WEXITSTATUS(rc) )
+        {
+            fprintf(stderr, "system(%s) fails: rc=%d\n", cmd, rc);
+            exit(2);
+        }
+
+        filePtr = fopen( patchName, "r" );
+        if( NULL == filePtr )
+        {
+            fprintf(stderr, "Unable to open %s: %m\n", patchName);
+            exit(1);
+        }
+        fseek( filePtr, 0, SEEK_END );
+        size = ftell( filePtr );
+        rewind( filePtr );
+        patchPtr = Alloc( size + 1 );
+        if( ((size_t)size != patchesPtr[i].size) ||
+            ((size_t)size != fread( patchPtr, 1, size, filePtr )) ||
+            memcmp( patchPtr, patchesPtr[i].dataPtr, size ) )
+        {
+            fprintf(stderr, "Segment %zu: bsdiff patch differs\n", i);
+            isSame = false;
+        }
+        free( patchPtr );
+        fclose( filePtr );
+    }
+
+    unlink( origName );
+    unlink( segName );
+    unlink( patchName );
+    return isSame ? total : -1.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print usage and exit...
+ */
+//--------------------------------------------------------------------------------------------------
+static void Usage
+(
+    const char *progNamePtr
+)
+{
+    fprintf(stderr,
+            "usage: %s [-s MB] [-j JOBS] [-r SEED] [-x]\n"
+            "   -s <MB>    Base image size in MB (default 4).\n"
+            "   -j <JOBS>  Highest number of threads to time (default: number of CPUs).\n"
+            "   -r <SEED>  Seed of the synthetic images (default 1).\n"
+            "   -x         Also time the external bsdiff, one run per segment.\n",
+            progNamePtr);
+    exit(1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main :)
+ */
+//--------------------------------------------------------------------------------------------------
+int main
+(
+    int    argc,
+    char** argv
+)
+{
+    static uint8_t words[NB_WORDS][MAX_WORD_LEN];
+    static uint8_t wordLen[NB_WORDS];
+    size_t baseSize = 4 * 1024 * 1024;
+    int maxJobs = sysconf( _SC_NPROCESSORS_ONLN );
+    uint64_t seed = 1;
+    bool runExternal = false;
+    char dir[] = "/tmp/mkPatchBench.XXXXXX";
+    size_t i, s, nbSegments;
+    int opt, jobs;
+    bool isOk = true;
+
+    while( -1 != (opt = getopt( argc, argv, "s:j:r:x" )) )
+    {
+        switch( opt )
+        {
+            case 's': baseSize = strtoul( optarg, NULL, 10 ) * 1024 * 1024; break;
+            case 'j': maxJobs = atoi( optarg ); break;
+            case 'r': seed = strtoull( optarg, NULL, 10 ); break;
+            case 'x': runExternal = true; break;
+            default:  Usage( argv[0] );
+        }
+    }
+    if( (0 == baseSize) || (maxJobs <= 0) )
+    {
+        Usage( argv[0] );
+    }
+    if( runExternal && (NULL == mkdtemp( dir )) )
+    {
+        fprintf(stderr, "Unable to create %s: %m\n", dir);
+        exit(1);
+    }
+
+    RandState = seed * 0x9E3779B97F4A7C15ULL + 1;
+    for( i = 0; i < NB_WORDS; i++ )
+    {
+        wordLen[i] = 4 + (Rand() % (MAX_WORD_LEN - 4));
+        for( s = 0; s < wordLen[i]; s++ )
+        {
+            words[i][s] = Rand();
+        }
+    }
+
+    printf("%-8s %10s %10s %5s %10s %5s %10s %8s %8s\n",
+           "image", "orig", "dest", "segs", "patch", "jobs", "index(s)", "diff(s)", "vs 1 job");
+
+    for( i = 0; i < NUM_ARRAY_MEMBERS(ImageSet); i++ )
+    {
+        const ImageDesc_t *descPtr = &ImageSet[i];
+        size_t origSize = descPtr->sizeMult * baseSize;
+        size_t destSize, patchSize = 0;
+        uint8_t *origPtr = MakeOrig( words, wordLen, origSize );
+        uint8_t *destPtr = MakeDest( origPtr, origSize, descPtr, &destSize );
+        bsDiff_Patch_t *refPtr, *patchesPtr;
+        bsDiff_Index_t *indexPtr;
+        double start, indexTime, refTime = 0.0;
+
+        nbSegments = (destSize + descPtr->segmentSize - 1) / descPtr->segmentSize;
+        refPtr = Alloc( nbSegments * sizeof(*refPtr) );
+        patchesPtr = Alloc( nbSegments * sizeof(*patchesPtr) );
+
+        start = Now();
+        indexPtr = bsDiff_CreateIndex( origPtr, origSize );
+        indexTime = Now() - start;
+        if( NULL == indexPtr )
+        {
+            fprintf(stderr, "Unable to index %s\n", descPtr->namePtr);
+            exit(1);
+        }
+
+        // Time 1, 2, 4... threads, up to maxJobs
+        for( jobs = 1; jobs <= maxJobs;
+             jobs = (jobs < maxJobs) ? MIN(2 * jobs, maxJobs) : (maxJobs + 1) )
+        {
+            bsDiff_Patch_t *outPtr = (1 == jobs) ? refPtr : patchesPtr;
+            double diffTime;
+
+            start = Now();
+            if( LE_OK != bsDiff_DiffSegments( indexPtr, destPtr, destSize, descPtr->segmentSize,
+                                              jobs, outPtr ) )
+            {
+                fprintf(stderr, "Unable to diff %s\n", descPtr->namePtr);
+                exit(1);
+            }
+            diffTime = Now() - start;
+
+            if( 1 == jobs )
+            {
+                refTime = diffTime;
+                for( s = 0; s < nbSegments; s++ )
+                {
+                    patchSize += refPtr[s].size;
+                }
+            }
+            else
+            {
+                for( s = 0; s < nbSegments; s++ )
+                {
+                    if( (refPtr[s].size != patchesPtr[s].size) ||
+                        memcmp( refPtr[s].dataPtr, patchesPtr[s].dataPtr, refPtr[s].size ) )
+                    {
+                        fprintf(stderr, "%s: segment %zu differs with %d jobs\n",
+                                descPtr->namePtr, s, jobs);
+                        isOk = false;
+                    }
+                    bsDiff_FreePatch( &patchesPtr[s] );
+                }
+            }
+
+            printf("%-8s %10zu %10zu %5zu %10zu %5d %10.3f %8.3f %7.2fx\n",
+                   descPtr->namePtr, origSize, destSize, nbSegments, patchSize, jobs,
+                   indexTime, diffTime, (indexTime + refTime) / (indexTime + diffTime));
+        }
+
+        if( runExternal )
+        {
+            double extTime = RunExternal( dir, origPtr, origSize, destPtr, destSize,
+                                          descPtr->segmentSize, refPtr );
+
+            if( 0 > extTime )
+            {
+                isOk = false;
+            }
+            else
+            {
+                printf("%-8s %10zu %10zu %5zu %10zu %5s %10s %8.3f %7.2fx\n",
+                       descPtr->namePtr, origSize, destSize, nbSegments, patchSize, "bsdiff",
+                       "-", extTime, (indexTime + refTime) / extTime);
+            }
+        }
+
+        for( s = 0; s < nbSegments; s++ )
+        {
+            bsDiff_FreePatch( &refPtr[s] );
+        }
+        bsDiff_DeleteIndex( indexPtr );
+        free( patchesPtr );
+        free( refPtr );
+        free( destPtr );
+        free( origPtr );
+    }
+
+    if( runExternal )
+    {
+        rmdir( dir );
+    }
+
+    printf("%s\n", isOk ? "Patches identical for all thread counts" : "PATCHES DIFFER");
+    return isOk ? 0 : 1;
+}
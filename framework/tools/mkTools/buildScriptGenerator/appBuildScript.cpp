@@ -95,7 +95,8 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
         "            find $workingDir/staging -exec touch --no-dereference "
                     "--date=@$$mtime {} \\; && $\n"
         "            (cd $workingDir/staging && find . -print0 | LC_ALL=C sort -z"
-                     " |tar --no-recursion --null -T - -cjf - ) > $workingDir/$name.$target && $\n"
+                     " |" << baseGeneratorPtr->GetPackTarCommand() << " )"
+                     " > $workingDir/$name.$target && $\n"
         // Get the size of the tarball.
         "            tarballSize=`stat -c '%s' $workingDir/$name.$target` && $\n"
         // Get the app's MD5 hash from its info.properties file.
@@ -106,6 +107,7 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
         "              printf '\"name\":\"$name\",\\n' && $\n"
         "              printf '\"version\":\"$version\",\\n' && $\n"
         "              printf '\"md5\":\"%s\",\\n' \"$$md5\" && $\n"
+        << baseGeneratorPtr->GetPackPayloadMd5Command("$workingDir/$name.$target") <<
         "              printf '\"size\":%s\\n' \"$$tarballSize\" && $\n"
         "              printf '}' && $\n"
         "              cat $workingDir/$name.$target $\n"
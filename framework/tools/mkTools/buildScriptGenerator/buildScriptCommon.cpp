@@ -204,6 +204,58 @@ std::string BuildScriptGenerator_t::GetPathEnvVarDecl
     return pathStr;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the shell command that makes an update pack tarball.  It reads a null-separated list of
+ * paths from its standard input and writes the compressed tarball to its standard output.
+ *
+ * @return The command.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string BuildScriptGenerator_t::GetPackTarCommand
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (buildParams.packCompression == "lz4")
+    {
+        return "tar --no-recursion --null -T - -cf - |lz4 -q -c -9";
+    }
+    else if (buildParams.packCompression == "zstd")
+    {
+        return "tar --no-recursion --null -T - -cf - |zstd -q -c -12";
+    }
+
+    return "tar --no-recursion --null -T - -cjf -";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the shell command that prints the "payloadMd5" member of an update pack section's JSON
+ * header, followed by " && $" and a new line.  Only update daemons that can unpack the newer
+ * compression formats know this member, so bzip2 update packs don't have it.
+ *
+ * @return The command, or an empty string if there is no "payloadMd5" member.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string BuildScriptGenerator_t::GetPackPayloadMd5Command
+(
+    const std::string& tarballPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (buildParams.packCompression == "bzip2")
+    {
+        return "";
+    }
+
+    return "              printf '\"payloadMd5\":\"%s\",\\n' "
+           "`md5sum " + tarballPath + " |cut -d ' ' -f 1` && $\n";
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Generate generic build rules.
@@ -77,6 +77,8 @@ class BuildScriptGenerator_t
                                                       model::FileSystemObjectSet_t& bundledFiles);
 
         std::string GetPathEnvVarDecl(void);
+        std::string GetPackTarCommand(void);
+        std::string GetPackPayloadMd5Command(const std::string& tarballPath);
         std::string PermissionsToModeFlags(model::Permissions_t permissions);
 
     public:
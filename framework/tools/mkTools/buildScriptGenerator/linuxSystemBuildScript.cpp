@@ -162,8 +162,8 @@ void LinuxSystemBuildScriptGenerator_t::GenerateSystemBuildRules
     "            find $stagingDir -exec touch  --no-dereference --date=@$$mtime {} \\; && $\n"
     // Pack the system's staging area into a compressed tarball.
     "           (cd $stagingDir && find . -print0 | LC_ALL=C sort -z"
-                                 " |tar --no-recursion --null -T -"
-                                 " -cjf - ) > $builddir/"<< systemPtr->name <<".$target && $\n"
+                                 " |" << baseGeneratorPtr->GetPackTarCommand() << " )"
+                                 " > $builddir/"<< systemPtr->name <<".$target && $\n"
 
     // Get the size of the tarball.
     "            tarballSize=`stat -c '%s' $builddir/" << systemPtr->name << ".$target` && $\n"
@@ -176,6 +176,7 @@ void LinuxSystemBuildScriptGenerator_t::GenerateSystemBuildRules
     "            ( printf '{\\n' && $\n"
     "              printf '\"command\":\"updateSystem\",\\n' && $\n"
     "              printf '\"md5\":\"%s\",\\n' \"$$md5\" && $\n"
+    << baseGeneratorPtr->GetPackPayloadMd5Command("$builddir/" + systemPtr->name + ".$target") <<
     "              printf '\"size\":%s\\n' \"$$tarballSize\" && $\n"
     "              printf '}' && $\n"
     "              cat $builddir/" << systemPtr->name << ".$target && $\n"
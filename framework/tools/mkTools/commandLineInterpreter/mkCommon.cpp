@@ -402,6 +402,33 @@ void CheckForIMASigning
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that the update pack compression in @c buildParams is one that mkTools can produce.
+ */
+//--------------------------------------------------------------------------------------------------
+void CheckPackCompression
+(
+    const mk::BuildParams_t& buildParams
+)
+{
+    const std::string& compression = buildParams.packCompression;
+
+    if ((compression != "bzip2") && (compression != "lz4") && (compression != "zstd"))
+    {
+        throw mk::Exception_t(mk::format(LE_I18N("Unknown update pack compression '%s'. "
+                                         "Use 'bzip2', 'lz4' or 'zstd'."),
+                                         compression));
+    }
+
+    // Signed tarballs are made by ima-sign.sh, which always uses bzip2.
+    if (buildParams.signPkg && (compression != "bzip2"))
+    {
+        throw mk::Exception_t(LE_I18N("Signed (-S) update packs can only use bzip2 compression."));
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Run the Ninja build tool.  Executes the build.ninja script in the root of the working directory
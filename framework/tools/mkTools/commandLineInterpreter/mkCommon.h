@@ -41,6 +41,17 @@ void CheckForIMASigning
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that the update pack compression in @c buildParams is one that mkTools can produce.
+ */
+//--------------------------------------------------------------------------------------------------
+void CheckPackCompression
+(
+    const mk::BuildParams_t& buildParams
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Run the Ninja build tool.  Executes the build.ninja script in the root of the working directory
@@ -253,6 +253,18 @@ static void GetCommandLineArgs
                                     )
                             );
 
+    args::AddOptionalString(&BuildParams.packCompression,
+                            "bzip2",
+                            'z',
+                            "compression",
+                            LE_I18N("Compression used for the tarballs in the update pack: "
+                                    "'bzip2' (the default), 'lz4' or 'zstd'.  lz4 and zstd "
+                                    "update packs unpack much faster, but can only be installed "
+                                    "on targets whose update daemon was built with "
+                                    "LE_CONFIG_UPDATE_PACK_LZ4 or LE_CONFIG_UPDATE_PACK_ZSTD."
+                                    )
+                            );
+
     args::AddOptionalFlag(&DontRunNinja,
                            'n',
                            "dont-run-ninja",
@@ -306,6 +318,9 @@ static void GetCommandLineArgs
     // Now check for IMA signing
     CheckForIMASigning(BuildParams);
 
+    // Check the update pack compression.
+    CheckPackCompression(BuildParams);
+
     // Make sure we have the .adef file's absolute path (for improved error reporting).
     AdefFilePath = path::MakeAbsolute(AdefFilePath);
 
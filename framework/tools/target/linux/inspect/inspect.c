@@ -23,6 +23,7 @@
 #include "timer.h"
 
 #include <sys/ptrace.h>
+#include <sys/uio.h>
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -358,6 +359,80 @@ static bool IsVerbose = false;
 static bool IsChildStopped = false;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * true = snapshot mode.  The process is never attached to or stopped.  Its lists are read while it
+ * runs, and the change counters are used to detect and retry torn reads.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSnapshot = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * In snapshot mode, set when a read of the remote process failed, which happens when a node is
+ * freed while it is being read.  The inspection is then retried.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsReadTorn = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of attempts at a snapshot before giving up and reporting it as interrupted.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_MAX_ATTEMPTS               10
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stream that the inspection results are printed to.  This is stdout, except in snapshot mode
+ * where each attempt is printed to memory first so that a torn attempt can be thrown away.
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* OutputFile;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true = read the remote process through /proc/<pid>/mem, because process_vm_readv() isn't
+ * supported by the kernel.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool UseProcMem = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor of /proc/<pid>/mem, or -1 if it isn't open.
+ */
+//--------------------------------------------------------------------------------------------------
+static int ProcMemFd = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of separate areas read by a single TargetReadScatter() call.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SCATTER_READS                   4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An area of the remote process's memory to read, and where to copy it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uintptr_t remoteAddr;   ///< Remote address to read from.
+    void* bufferPtr;        ///< Destination to read into.
+    size_t size;            ///< Number of bytes to read.
+}
+RemoteRead_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Local mapped address of liblegato.so
@@ -473,7 +548,7 @@ static uintptr_t GetRemoteAddress
 //--------------------------------------------------------------------------------------------------
 /**
  * Attach to the target process in order to gain control of its execution and access its memory
- * space.
+ * space.  Does nothing in snapshot mode.
  */
 //--------------------------------------------------------------------------------------------------
 static void TargetAttach
@@ -481,6 +556,11 @@ static void TargetAttach
     pid_t pid              ///< [IN] Remote process to attach to
 )
 {
+    if (IsSnapshot)
+    {
+        return;
+    }
+
     if (ptrace(PTRACE_SEIZE, pid, NULL, (void*)0) == -1)
     {
         fprintf(stderr, "Failed to attach to pid %d: error %d\n", pid, errno);
@@ -490,7 +570,7 @@ static void TargetAttach
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Detach from a process that we had previously attached to.
+ * Detach from a process that we had previously attached to.  Does nothing in snapshot mode.
  */
 //--------------------------------------------------------------------------------------------------
 static void TargetDetach
@@ -498,6 +578,11 @@ static void TargetDetach
     pid_t pid              ///< [IN] Remote process to detach from
 )
 {
+    if (IsSnapshot)
+    {
+        return;
+    }
+
     if (ptrace(PTRACE_DETACH, pid, 0, 0) == -1)
     {
         fprintf(stderr, "Failed to detach from pid %d: error %d\n", pid, errno);
@@ -507,7 +592,8 @@ static void TargetDetach
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pause execution of a running process which we had previously attached to.
+ * Pause execution of a running process which we had previously attached to.  Does nothing in
+ * snapshot mode.
  */
 //--------------------------------------------------------------------------------------------------
 static void TargetStop
@@ -517,6 +603,11 @@ static void TargetStop
 {
     int waitStatus;
 
+    if (IsSnapshot)
+    {
+        return;
+    }
+
     if (ptrace(PTRACE_INTERRUPT, pid, 0, 0) == -1)
     {
         fprintf(stderr, "Failed to stop pid %d: error %d\n", pid, errno);
@@ -557,7 +648,7 @@ static void TargetStop
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Resume execution of a previously paused process.
+ * Resume execution of a previously paused process.  Does nothing in snapshot mode.
  */
 //--------------------------------------------------------------------------------------------------
 static void TargetStart
@@ -567,6 +658,11 @@ static void TargetStart
 {
     IsChildStopped = false;
 
+    if (IsSnapshot)
+    {
+        return;
+    }
+
     if (ptrace(PTRACE_CONT, pid, 0, (void *) (intptr_t) PendingChildSignal) == -1)
     {
         fprintf(stderr, "Failed to start pid %d: error %d\n", pid, errno);
@@ -579,43 +675,118 @@ static void TargetStart
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read from the memory of an attached target process.
+ * Read areas of the memory of the target process into local buffers, with a single
+ * process_vm_readv() call.  If the kernel doesn't support process_vm_readv(), /proc/<pid>/mem is
+ * read instead.
+ *
+ * In snapshot mode, a failed read isn't reported as an error, because the area may have been freed
+ * by the running process.  The buffers are zeroed and IsReadTorn is set so that the inspection is
+ * retried.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if any of the areas couldn't be read.
  */
 //--------------------------------------------------------------------------------------------------
-static bool TargetReadAddress
+static le_result_t TargetReadScatter
 (
-    pid_t pid,              ///< [IN] Remote process to read address
-    uintptr_t remoteAddr,   ///< [IN] Remote address to read from target
-    void* buffer,           ///< [OUT] Destination to read into
-    size_t size             ///< [IN] Number of bytes to read
+    pid_t pid,                      ///< [IN] Remote process to read from.
+    const RemoteRead_t* readsPtr,   ///< [IN] Areas to read.
+    size_t readCount                ///< [IN] Number of areas to read.
 )
 {
-    LE_ASSERT(IsChildStopped);
+    LE_ASSERT(IsChildStopped || IsSnapshot);
+    LE_ASSERT(readCount <= MAX_SCATTER_READS);
+
+    le_result_t result = LE_OK;
+    size_t i;
 
-    uintptr_t readWord;
-    for (readWord = remoteAddr & ~(sizeof(long) - 1);
-         size > 0;
-         readWord += sizeof(long))
+    if (!UseProcMem)
     {
-        errno = 0;
-        long peekWord = ptrace(PTRACE_PEEKDATA, pid, readWord, 0);
+        struct iovec localIov[MAX_SCATTER_READS];
+        struct iovec remoteIov[MAX_SCATTER_READS];
+        size_t totalSize = 0;
+
+        for (i = 0; i < readCount; i++)
+        {
+            localIov[i].iov_base = readsPtr[i].bufferPtr;
+            localIov[i].iov_len = readsPtr[i].size;
+            remoteIov[i].iov_base = (void*)readsPtr[i].remoteAddr;
+            remoteIov[i].iov_len = readsPtr[i].size;
+            totalSize += readsPtr[i].size;
+        }
+
+        ssize_t readSize = process_vm_readv(pid, localIov, readCount, remoteIov, readCount, 0);
+
+        if ((readSize < 0) && (errno == ENOSYS))
+        {
+            LE_INFO("process_vm_readv() is not supported, reading /proc/%d/mem instead.", pid);
+            UseProcMem = true;
+        }
+        else if (readSize != (ssize_t)totalSize)
+        {
+            result = LE_FAULT;
+        }
+    }
+
+    if (UseProcMem)
+    {
+        if (ProcMemFd < 0)
+        {
+            char path[LIMIT_MAX_PATH_BYTES];
+
+            snprintf(path, sizeof(path), "/proc/%d/mem", pid);
+            ProcMemFd = open(path, O_RDONLY | O_CLOEXEC);
+            if (ProcMemFd < 0)
+            {
+                INTERNAL_ERR("Failed to open '%s' (%m).", path);
+            }
+        }
+
+        for (i = 0; (i < readCount) && (result == LE_OK); i++)
+        {
+            if (pread(ProcMemFd, readsPtr[i].bufferPtr, readsPtr[i].size,
+                      (off_t)readsPtr[i].remoteAddr) != (ssize_t)readsPtr[i].size)
+            {
+                result = LE_FAULT;
+            }
+        }
+    }
 
-        // Check if ptrace was able to get memory
-        if (errno != 0)
+    if ((result != LE_OK) && IsSnapshot)
+    {
+        for (i = 0; i < readCount; i++)
         {
-            return LE_FAULT;
+            memset(readsPtr[i].bufferPtr, 0, readsPtr[i].size);
         }
 
-        uintptr_t startOffset = (remoteAddr - readWord);
-        size_t readSize = sizeof(long) - startOffset;
-        LE_ASSERT(startOffset < sizeof(long));
-        memcpy(buffer, ((char*)&peekWord) + startOffset, readSize);
-        size -= readSize;
-        remoteAddr += readSize;
-        buffer = (char*)buffer + readSize;
+        IsReadTorn = true;
+        result = LE_OK;
     }
 
-    return LE_OK;
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read from the memory of the target process.  See TargetReadScatter().
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the memory couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t TargetReadAddress
+(
+    pid_t pid,              ///< [IN] Remote process to read address
+    uintptr_t remoteAddr,   ///< [IN] Remote address to read from target
+    void* buffer,           ///< [OUT] Destination to read into
+    size_t size             ///< [IN] Number of bytes to read
+)
+{
+    RemoteRead_t read = { .remoteAddr = remoteAddr, .bufferPtr = buffer, .size = size };
+
+    return TargetReadScatter(pid, &read, 1);
 }
 
 
@@ -698,19 +869,18 @@ static MemPoolIter_Ref_t CreateMemPoolIter
     MemPoolIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
     InitRemoteDlsListAccessObj(&iteratorPtr->memPoolList);
 
-    // Get the List for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, listAddrOffset, &(iteratorPtr->memPoolList.List),
-                             sizeof(iteratorPtr->memPoolList.List)) != LE_OK)
+    // Get the List and the ListChgCntRef for the process-under-inspection.
+    RemoteRead_t reads[] =
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("mempool list"));
-    }
+        { listAddrOffset, &(iteratorPtr->memPoolList.List),
+          sizeof(iteratorPtr->memPoolList.List) },
+        { listChgCntAddrOffset, &(iteratorPtr->memPoolList.ListChgCntRef),
+          sizeof(iteratorPtr->memPoolList.ListChgCntRef) }
+    };
 
-    // Get the ListChgCntRef for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, listChgCntAddrOffset,
-                          &(iteratorPtr->memPoolList.ListChgCntRef),
-                          sizeof(iteratorPtr->memPoolList.ListChgCntRef)) != LE_OK)
+    if (TargetReadScatter(PidToInspect, reads, NUM_ARRAY_MEMBERS(reads)) != LE_OK)
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("mempool list change counter ref"));
+        INTERNAL_ERR(REMOTE_READ_ERR("mempool list and change counter ref"));
     }
 
     return iteratorPtr;
@@ -741,19 +911,18 @@ static ThreadObjIter_Ref_t CreateThreadObjIter
     ThreadObjIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
     InitRemoteDlsListAccessObj(&iteratorPtr->threadObjList);
 
-    // Get the List for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, listAddrOffset, &(iteratorPtr->threadObjList.List),
-                          sizeof(iteratorPtr->threadObjList.List)) != LE_OK)
+    // Get the List and the ListChgCntRef for the process-under-inspection.
+    RemoteRead_t reads[] =
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list"));
-    }
+        { listAddrOffset, &(iteratorPtr->threadObjList.List),
+          sizeof(iteratorPtr->threadObjList.List) },
+        { listChgCntAddrOffset, &(iteratorPtr->threadObjList.ListChgCntRef),
+          sizeof(iteratorPtr->threadObjList.ListChgCntRef) }
+    };
 
-    // Get the ListChgCntRef for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, listChgCntAddrOffset,
-                          &(iteratorPtr->threadObjList.ListChgCntRef),
-                          sizeof(iteratorPtr->threadObjList.ListChgCntRef)) != LE_OK)
+    if (TargetReadScatter(PidToInspect, reads, NUM_ARRAY_MEMBERS(reads)) != LE_OK)
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list change counter ref"));
+        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list and change counter ref"));
     }
 
     return iteratorPtr;
@@ -814,27 +983,21 @@ static void* CreateThreadMemberObjIter
     InitRemoteDlsListAccessObj(&iteratorPtr->threadObjList);
     InitRemoteDlsListAccessObj(&iteratorPtr->threadMemberObjList);
 
-    // Get the list of thread objs for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, threadObjListAddrOffset, &(iteratorPtr->threadObjList.List),
-                             sizeof(iteratorPtr->threadObjList.List)) != LE_OK)
+    // Get the list of thread objs, the thread obj ListChgCntRef and the thread member obj
+    // ListChgCntRef for the process-under-inspection.
+    RemoteRead_t reads[] =
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list"));
-    }
+        { threadObjListAddrOffset, &(iteratorPtr->threadObjList.List),
+          sizeof(iteratorPtr->threadObjList.List) },
+        { threadObjListChgCntAddrOffset, &(iteratorPtr->threadObjList.ListChgCntRef),
+          sizeof(iteratorPtr->threadObjList.ListChgCntRef) },
+        { threadMemberObjListChgCntAddrOffset, &(iteratorPtr->threadMemberObjList.ListChgCntRef),
+          sizeof(iteratorPtr->threadMemberObjList.ListChgCntRef) }
+    };
 
-    // Get the thread obj ListChgCntRef for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, threadObjListChgCntAddrOffset,
-                          &(iteratorPtr->threadObjList.ListChgCntRef),
-                          sizeof(iteratorPtr->threadObjList.ListChgCntRef)) != LE_OK)
+    if (TargetReadScatter(PidToInspect, reads, NUM_ARRAY_MEMBERS(reads)) != LE_OK)
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list change counter ref"));
-    }
-
-    // Get the thread member obj ListChgCntRef for the process-under-inspection.
-    if (TargetReadAddress(PidToInspect, threadMemberObjListChgCntAddrOffset,
-                          &(iteratorPtr->threadMemberObjList.ListChgCntRef),
-                          sizeof(iteratorPtr->threadMemberObjList.ListChgCntRef)) != LE_OK)
-    {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread member obj list change counter ref"));
+        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list and change counter refs"));
     }
 
     return iteratorPtr;
@@ -1117,16 +1280,17 @@ static size_t GetThreadMemberObjListChgCnt
 )
 {
     size_t threadObjListChgCnt, threadMemberObjListChgCnt;
-    if (TargetReadAddress(PidToInspect, (uintptr_t)(iterator->threadObjList.ListChgCntRef),
-                          &threadObjListChgCnt, sizeof(threadObjListChgCnt)) != LE_OK)
+    RemoteRead_t reads[] =
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread obj list change counter"));
-    }
+        { (uintptr_t)(iterator->threadObjList.ListChgCntRef),
+          &threadObjListChgCnt, sizeof(threadObjListChgCnt) },
+        { (uintptr_t)(iterator->threadMemberObjList.ListChgCntRef),
+          &threadMemberObjListChgCnt, sizeof(threadMemberObjListChgCnt) }
+    };
 
-    if (TargetReadAddress(PidToInspect, (uintptr_t)(iterator->threadMemberObjList.ListChgCntRef),
-                          &threadMemberObjListChgCnt, sizeof(threadMemberObjListChgCnt)) != LE_OK)
+    if (TargetReadScatter(PidToInspect, reads, NUM_ARRAY_MEMBERS(reads)) != LE_OK)
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("thread member obj list change counter"));
+        INTERNAL_ERR(REMOTE_READ_ERR("thread obj and thread member obj list change counters"));
     }
 
     return (threadObjListChgCnt + threadMemberObjListChgCnt);
@@ -1171,14 +1335,21 @@ static size_t GetSessionListChgCnt
     SessionObjIter_Ref_t iterator ///< [IN] The iterator to get the list change counter from.
 )
 {
-    size_t sessionListChgCnt;
-    if (TargetReadAddress(PidToInspect, (uintptr_t)(iterator->sessionList.ListChgCntRef),
-                          &sessionListChgCnt, sizeof(sessionListChgCnt)) != LE_OK)
+    size_t interfaceObjMapChgCnt, sessionListChgCnt;
+    RemoteRead_t reads[] =
+    {
+        { (uintptr_t)(iterator->interfaceObjMap.mapChgCntRef),
+          &interfaceObjMapChgCnt, sizeof(interfaceObjMapChgCnt) },
+        { (uintptr_t)(iterator->sessionList.ListChgCntRef),
+          &sessionListChgCnt, sizeof(sessionListChgCnt) }
+    };
+
+    if (TargetReadScatter(PidToInspect, reads, NUM_ARRAY_MEMBERS(reads)) != LE_OK)
     {
-        INTERNAL_ERR(REMOTE_READ_ERR("session list change counter"));
+        INTERNAL_ERR(REMOTE_READ_ERR("interface obj map and session list change counters"));
     }
 
-    return GetInterfaceObjMapChgCnt((InterfaceObjIter_Ref_t)iterator) + sessionListChgCnt;
+    return interfaceObjMapChgCnt + sessionListChgCnt;
 }
 
 
@@ -1923,6 +2094,14 @@ static void PrintHelp
         "    --format=json\n"
         "        Outputs the inspection results in JSON format.\n"
         "\n"
+        "    -s, --snapshot\n"
+        "        Reads the process without stopping it.  If the lists being inspected change\n"
+        "        while they are read, the inspection is retried.\n"
+        "\n"
+        "    --stream=SECONDS\n"
+        "        Prints a snapshot in JSON format every SECONDS, with a timestamp.  Same as\n"
+        "        -s --format=json --interval=SECONDS.\n"
+        "\n"
         "    --help\n"
         "        Display this help and exit.\n"
         );
@@ -2439,7 +2618,7 @@ static void PrintHeader
 
         i++;
     }
-    puts(TableLineBuffer);
+    fprintf(OutputFile, "%s\n", TableLineBuffer);
 }
 
 
@@ -2469,7 +2648,7 @@ static void PrintInfo
 
         i++;
     }
-    puts(TableLineBuffer);
+    fprintf(OutputFile, "%s\n", TableLineBuffer);
 }
 
 
@@ -2507,7 +2686,7 @@ static void PrintUnderColumn
                           (int)strlen(ColumnSpacers), "");
         i++;
     }
-    puts(TableLineBuffer);
+    fprintf(OutputFile, "%s\n", TableLineBuffer);
 }
 
 
@@ -2619,13 +2798,13 @@ static int PrintInspectHeader
 
     if (!IsOutputJson)
     {
-        printf("\n");
+        fprintf(OutputFile, "\n");
         lineCount++;
 
         // Print title.
-        printf("Legato %s Inspector\n", inspectTypeString);
+        fprintf(OutputFile, "Legato %s Inspector\n", inspectTypeString);
         lineCount++;
-        printf("Inspecting process %d\n", PidToInspect);
+        fprintf(OutputFile, "Inspecting process %d\n", PidToInspect);
         lineCount++;
 
         // Print column headers.
@@ -2636,7 +2815,7 @@ static int PrintInspectHeader
     {
         // The beginning curly brace of the "main" JSON object, and the beginning of the "Headers"
         // data.
-        printf("{\"Headers\":[");
+        fprintf(OutputFile, "{\"Headers\":[");
 
         // Print the column headers.
         int i;
@@ -2647,21 +2826,22 @@ static int PrintInspectHeader
             {
                 if (printed == true)
                 {
-                    printf(",");
+                    fprintf(OutputFile, ",");
                 }
                 else
                 {
                     printed = true;
                 }
 
-                printf("\"%s\"", table[i].colTitle);
+                fprintf(OutputFile, "\"%s\"", table[i].colTitle);
             }
         }
 
-        printf("],");
+        fprintf(OutputFile, "],");
 
         // Print the data of "InspectType", "PID", and the beginning of "Data".
-        printf("\"InspectType\":\"%s\",\"PID\":\"%d\",\"Data\":[", inspectTypeString, PidToInspect);
+        fprintf(OutputFile, "\"InspectType\":\"%s\",\"PID\":\"%d\",\"Data\":[",
+                inspectTypeString, PidToInspect);
     }
 
     return lineCount;
@@ -2708,14 +2888,14 @@ static void ExportArrayToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf("%s", array);
+        fprintf(OutputFile, "%s", array);
     }
 }
 
@@ -2736,16 +2916,16 @@ static void ExportStrToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf("\"");
-        printf(col->fieldFormat, 0, field);
-        printf("\"");
+        fprintf(OutputFile, "\"");
+        fprintf(OutputFile, col->fieldFormat, 0, field);
+        fprintf(OutputFile, "\"");
     }
 }
 
@@ -2766,14 +2946,14 @@ static void ExportSizeTToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf(col->fieldFormat, 0, field);
+        fprintf(OutputFile, col->fieldFormat, 0, field);
     }
 }
 
@@ -2792,14 +2972,14 @@ static void ExportIntToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf(col->fieldFormat, 0, field);
+        fprintf(OutputFile, col->fieldFormat, 0, field);
     }
 }
 
@@ -2818,14 +2998,14 @@ static void ExportDoubleToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf(col->fieldFormat, 0, field);
+        fprintf(OutputFile, col->fieldFormat, 0, field);
     }
 }
 
@@ -2844,14 +3024,14 @@ static void ExportUint32ToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf(col->fieldFormat, 0, field);
+        fprintf(OutputFile, col->fieldFormat, 0, field);
     }
 }
 
@@ -2870,14 +3050,14 @@ static void ExportUint64ToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
             *printed = true;
         }
 
-        printf(col->fieldFormat, 0, field);
+        fprintf(OutputFile, col->fieldFormat, 0, field);
     }
 }
 
@@ -2897,7 +3077,7 @@ static void ExportBoolToJson
     {
         if (*printed == true)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -2906,11 +3086,11 @@ static void ExportBoolToJson
 
         if (field == true)
         {
-            printf("true");
+            fprintf(OutputFile, "true");
         }
         else
         {
-            printf("false");
+            fprintf(OutputFile, "false");
         }
     }
 }
@@ -3052,6 +3232,14 @@ static void FillBoolColField
 static bool IsPrintedNodeFirst = true;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of attempts made at the last inspection.  Always 1 unless in snapshot mode.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SnapshotAttempts = 0;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print memory pool information to stdout.
@@ -3113,7 +3301,7 @@ static int PrintMemPoolInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3122,7 +3310,7 @@ static int PrintMemPoolInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportSizeTToJson (le_mem_GetObjectCount(memPool),  MemPoolTableInfo,
                                                             MemPoolTableInfoSize, &index, &printed);
@@ -3143,7 +3331,7 @@ static int PrintMemPoolInfo
         ExportStrToJson   (subPoolStr,                      MemPoolTableInfo,
                                                             MemPoolTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3248,7 +3436,7 @@ static int PrintThreadObjInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3257,7 +3445,7 @@ static int PrintThreadObjInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson   (THREAD_NAME(threadObjRef->name), ThreadObjTableInfo,
                                                           ThreadObjTableInfoSize, &index, &printed);
@@ -3282,7 +3470,7 @@ static int PrintThreadObjInfo
         ExportSizeTToJson (stackSize,                     ThreadObjTableInfo,
                                                           ThreadObjTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3324,7 +3512,7 @@ static int PrintTimerInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3333,7 +3521,7 @@ static int PrintTimerInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson   (TIMER_NAME(timerRef->name), TimerTableInfo,
                                                   TimerTableInfoSize, &index, &printed);
@@ -3348,7 +3536,7 @@ static int PrintTimerInfo
         ExportUint32ToJson(timerRef->expiryCount, TimerTableInfo,
                                                   TimerTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3643,7 +3831,7 @@ static int PrintMutexInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3652,7 +3840,7 @@ static int PrintMutexInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson  (MUTEX_NAME(mutexRef->name), MutexTableInfo,
                                                   MutexTableInfoSize, &index, &printed);
@@ -3663,7 +3851,7 @@ static int PrintMutexInfo
         ExportArrayToJson(waitingThreadJsonArray, MutexTableInfo,
                                                   MutexTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3718,7 +3906,7 @@ static int PrintSemaphoreInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3727,14 +3915,14 @@ static int PrintSemaphoreInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson  (SEM_NAME(semaphoreRef->nameStr), SemaphoreTableInfo,
                                                   SemaphoreTableInfoSize, &index, &printed);
         ExportArrayToJson(waitingThreadJsonArray, SemaphoreTableInfo,
                                                   SemaphoreTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3836,7 +4024,7 @@ static int PrintServiceObjInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3845,7 +4033,7 @@ static int PrintServiceObjInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson  (serviceObjRef->interface.id.name, ServiceObjTableInfo,
                                                          ServiceObjTableInfoSize, &index, &printed);
@@ -3860,7 +4048,7 @@ static int PrintServiceObjInfo
         ExportIntToJson  (serviceObjRef->directorySocketFd, ServiceObjTableInfo,
                                                          ServiceObjTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3907,7 +4095,7 @@ static int PrintClientObjInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3916,7 +4104,7 @@ static int PrintClientObjInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson  (clientObjRef->interface.id.name, ClientObjTableInfo,
                                                           ClientObjTableInfoSize, &index, &printed);
@@ -3925,7 +4113,7 @@ static int PrintClientObjInfo
         ExportSizeTToJson(protocol.maxPayloadSize,        ClientObjTableInfo,
                                                           ClientObjTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -3981,7 +4169,7 @@ static int PrintSessionObjInfo
         // If it's not the first time, print a comma.
         if (!IsPrintedNodeFirst)
         {
-            printf(",");
+            fprintf(OutputFile, ",");
         }
         else
         {
@@ -3990,7 +4178,7 @@ static int PrintSessionObjInfo
 
         bool printed = false;
 
-        printf("[");
+        fprintf(OutputFile, "[");
 
         ExportStrToJson(interface.id.name,       SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index, &printed);
@@ -4001,7 +4189,7 @@ static int PrintSessionObjInfo
         ExportIntToJson(sessionObjRef->socketFd, SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index, &printed);
 
-        printf("]");
+        fprintf(OutputFile, "]");
     }
 
     return lineCount;
@@ -4035,26 +4223,35 @@ static int InspectEndHandling
     {
         if (endStatus == INSPECT_INTERRUPTED)
         {
-            printf(">>> Detected list changes. Stopping inspection. <<<\n");
+            fprintf(OutputFile, ">>> Detected list changes. Stopping inspection. <<<\n");
             lineCount++;
         }
     }
     else
     {
         // Print the end of "Data".
-        printf("],");
+        fprintf(OutputFile, "],");
 
         if (endStatus == INSPECT_INTERRUPTED)
         {
-            printf("\"Interrupted\":true");
+            fprintf(OutputFile, "\"Interrupted\":true");
         }
         else
         {
-            printf("\"Interrupted\":false");
+            fprintf(OutputFile, "\"Interrupted\":false");
+        }
+
+        // In snapshot mode, print when the snapshot was taken and how many attempts it took.
+        if (IsSnapshot)
+        {
+            le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+            fprintf(OutputFile, ",\"Timestamp\":%ld.%03ld,\"Attempts\":%d",
+                    (long)now.sec, (long)(now.usec / 1000), SnapshotAttempts);
         }
 
         // Print the end of the "main" JSON object.
-        printf("}\n");
+        fprintf(OutputFile, "}\n");
     }
 
     // The last line of the current run of inspection has finished, so it's a good place to
@@ -4066,9 +4263,6 @@ static int InspectEndHandling
     // If Inspect is set to repeat periodically, configure the repeat interval.
     if (IsFollowing)
     {
-        // Reset this boolean for the next round.
-        IsPrintedNodeFirst = true;
-
         le_clk_Time_t refreshInterval;
 
         switch (endStatus)
@@ -4087,11 +4281,14 @@ static int InspectEndHandling
                 INTERNAL_ERR("Invalid end status.");
         }
 
-        // Set up the refresh timer.
-        refreshTimer = le_timer_Create("RefreshTimer");
+        // Set up the refresh timer the first time, and re-use it after that.
+        if (refreshTimer == NULL)
+        {
+            refreshTimer = le_timer_Create("RefreshTimer");
 
-        INTERNAL_ERR_IF(le_timer_SetHandler(refreshTimer, RefreshTimerHandler) != LE_OK,
-                        "Could not set timer handler.\n");
+            INTERNAL_ERR_IF(le_timer_SetHandler(refreshTimer, RefreshTimerHandler) != LE_OK,
+                            "Could not set timer handler.\n");
+        }
 
         INTERNAL_ERR_IF(le_timer_SetInterval(refreshTimer, refreshInterval) != LE_OK,
                         "Could not set refresh time.\n");
@@ -4193,9 +4390,6 @@ static void InspectFunc
             INTERNAL_ERR("unexpected inspect type %d.", inspectType);
     }
 
-    // Create an iterator.
-    void* iterRef = createIterFunc();
-
     static int lineCount = 0;
 
     // Print header information.
@@ -4206,44 +4400,95 @@ static void InspectFunc
         printf("%c[0J", ESCAPE_CHAR);             // Clear Screen.
     }
 
-    lineCount += PrintInspectHeader();
-
+    InspectEndStatus_t endStatus;
+    int attemptLineCount;
+    char* bufferPtr = NULL;
+    size_t bufferSize = 0;
 
-    // Iterate through the list of nodes.
-    size_t initialChangeCount = getListChgCntFunc(iterRef);
-    size_t currentChangeCount;
-    void* nodeRef = NULL;
+    SnapshotAttempts = 0;
 
+    // In snapshot mode, each attempt is printed to memory, and only copied to stdout if it wasn't
+    // torn by changes to the node list (or if it is the last attempt).
     do
     {
-        nodeRef = getNextNodeFunc(iterRef);
+        if (IsSnapshot)
+        {
+            OutputFile = open_memstream(&bufferPtr, &bufferSize);
+            INTERNAL_ERR_IF(OutputFile == NULL, "Could not open memory stream (%m).");
+            IsReadTorn = false;
+        }
+
+        SnapshotAttempts++;
+        IsPrintedNodeFirst = true;
+        attemptLineCount = PrintInspectHeader();
 
-        if (nodeRef != NULL)
+        // Create an iterator.
+        void* iterRef = createIterFunc();
+
+        // Iterate through the list of nodes.
+        size_t initialChangeCount = getListChgCntFunc(iterRef);
+        size_t currentChangeCount;
+        void* nodeRef = NULL;
+
+        if (IsSnapshot)
         {
-            lineCount += printNodeInfoFunc(nodeRef);
+            // The process is running, so the list may have changed between reading its head and
+            // reading the change counter.  Read the head again now that the counter is known.
+            le_mem_Release(iterRef);
+            iterRef = createIterFunc();
         }
 
-        currentChangeCount = getListChgCntFunc(iterRef);
-    }
-    // Access the next node only if the current node is not NULL and there has been no changes to
-    // the node list.
-    while ((nodeRef != NULL) && (currentChangeCount == initialChangeCount));
+        do
+        {
+            nodeRef = getNextNodeFunc(iterRef);
 
-    // If the loop terminated because the next node is NULL and there has been no changes to the
-    // node list, then we can delcare the end of list has been reached.
-    if ((nodeRef == NULL) && (currentChangeCount == initialChangeCount))
-    {
-        lineCount += InspectEndHandling(INSPECT_SUCCESS);
-    }
-    // Detected changes to the node list.
-    else
-    {
-        lineCount += InspectEndHandling(INSPECT_INTERRUPTED);
+            if (nodeRef != NULL)
+            {
+                attemptLineCount += printNodeInfoFunc(nodeRef);
+            }
+
+            currentChangeCount = getListChgCntFunc(iterRef);
+        }
+        // Access the next node only if the current node is not NULL and there has been no changes
+        // to the node list.
+        while ((nodeRef != NULL) && (currentChangeCount == initialChangeCount) && !IsReadTorn);
+
+        // If the loop terminated because the next node is NULL and there has been no changes to
+        // the node list, then we can delcare the end of list has been reached.  Otherwise changes
+        // to the node list were detected.
+        if ((nodeRef == NULL) && (currentChangeCount == initialChangeCount) && !IsReadTorn)
+        {
+            endStatus = INSPECT_SUCCESS;
+        }
+        else
+        {
+            endStatus = INSPECT_INTERRUPTED;
+        }
+
+        le_mem_Release(iterRef);
+
+        if (IsSnapshot)
+        {
+            fclose(OutputFile);
+            OutputFile = stdout;
+
+            if ((endStatus == INSPECT_SUCCESS) || (SnapshotAttempts >= SNAPSHOT_MAX_ATTEMPTS))
+            {
+                fwrite(bufferPtr, 1, bufferSize, stdout);
+            }
+
+            free(bufferPtr);
+            bufferPtr = NULL;
+        }
     }
+    while (IsSnapshot && (endStatus == INSPECT_INTERRUPTED) &&
+           (SnapshotAttempts < SNAPSHOT_MAX_ATTEMPTS));
+
+    lineCount += attemptLineCount;
+    lineCount += InspectEndHandling(endStatus);
 
     // Note that InspectFunc is called multiple times when the "interval mode" is on, so don't
-    // close the fd "FdProcMem". Let the OS handle the cleanup.
-    le_mem_Release(iterRef);
+    // close the fd "ProcMemFd". Let the OS handle the cleanup.
 
     return;
 }
@@ -4471,6 +4716,23 @@ static void FormatOptionCallback
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by command line argument scanner when the --stream= option is given.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void StreamOptionCallback
+(
+    int value
+)
+{
+    IsSnapshot = true;
+    IsOutputJson = true;
+
+    FollowOptionCallback(value);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a memory pool for the iterators depending on the inspect type.
@@ -4551,8 +4813,16 @@ COMPONENT_INIT
     // --format=json option outputs data to the specified file in JSON format.
     le_arg_SetStringCallback(FormatOptionCallback, NULL, "format");
 
+    // -s or --snapshot option reads the process without stopping it.
+    le_arg_SetFlagVar(&IsSnapshot, "s", "snapshot");
+
+    // --stream=N option prints a JSON snapshot every N seconds (implies -s, -f and --format=json).
+    le_arg_SetIntCallback(StreamOptionCallback, NULL, "stream");
+
     le_arg_Scan();
 
+    OutputFile = stdout;
+
     // Create a memory pool for iterators.
     InitIteratorPool(InspectType);
 
@@ -0,0 +1,1059 @@
+//--------------------------------------------------------------------------------------------------
+/** @file legatoTop.c
+ *
+ * Legato top tool, which shows the runtime statistics that Legato processes keep in their
+ * statistics pages (see statsPage.h) when the framework is built with LE_CONFIG_RUNTIME_STATS.
+ *
+ * Each process's page is found once, by looking for its memfd in /proc/<pid>/fd, and then stays
+ * mapped read-only.  Refreshing the display only reads the mapped pages, so it doesn't stop or
+ * trace the processes and costs them nothing.  Rates are computed from the difference between two
+ * samples.
+ *
+ * Must be run as root.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "statsPage.h"
+#include "fileDescriptor.h"
+
+#include <dirent.h>
+#include <sys/mman.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default refresh interval, in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_REFRESH_INTERVAL    2
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of refreshes between looks at processes that had no statistics page.  Legato processes
+ * create their page before main() runs, so a process without one is usually not a Legato process.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NO_PAGE_RECHECK_COUNT       5
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimated number of processes, used to size the hash map.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PROCESS_MAP_SIZE            63
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of rows of handlers shown for a process.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_HANDLER_ROWS            20
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Link target of a statistics page's memfd in /proc/<pid>/fd.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MEMFD_LINK_PREFIX           "/memfd:" STATSPAGE_MEMFD_NAME " "
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A process being watched.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t                    pid;            ///< Process ID.  The key in the ProcessMap.
+    char                        name[32];       ///< Process name, from /proc/<pid>/comm.
+    const statsPage_Header_t*   pagePtr;        ///< Mapped page, or NULL if the process has none.
+    size_t                      pageSize;       ///< Size of the mapping.
+    ino_t                       pageInode;      ///< Inode of the page's memfd.
+    int                         fdNum;          ///< File descriptor of the memfd in the process.
+    statsPage_Header_t*         prevPtr;        ///< Copy of the page at the last refresh, or NULL.
+    unsigned int                lastSeen;       ///< Refresh at which the process was last seen.
+    unsigned int                noPageCount;    ///< Refreshes since the page was last looked for.
+}
+Process_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes being watched, by process ID.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ProcessMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of Process_t objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ProcessPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsFollowing = false;
+static int RefreshInterval = DEFAULT_REFRESH_INTERVAL;
+static int PidToShow = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of refreshes so far.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int RefreshCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a counter from a page.  Pages are written with atomic operations, so 64-bit values are
+ * read atomically too, to avoid torn reads on 32-bit targets.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t Load
+(
+    const uint64_t* valuePtr    ///< [IN] The counter.
+)
+{
+    return __atomic_load_n(valuePtr, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the rate of change of a counter, per second, between the previous sample and now.
+ *
+ * @return The rate, or 0 if there is no previous sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static double Rate
+(
+    uint64_t now,           ///< [IN] Value now.
+    uint64_t prev,          ///< [IN] Value at the previous sample.
+    bool hasPrev            ///< [IN] true if there is a previous sample.
+)
+{
+    if (!hasPrev || (now < prev))
+    {
+        return 0;
+    }
+
+    return (double)(now - prev) / RefreshInterval;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a slot of a section of a page.
+ *
+ * @return The slot, or NULL if it isn't inside the page.
+ */
+//--------------------------------------------------------------------------------------------------
+static const void* GetSlot
+(
+    const statsPage_Header_t*   pagePtr,        ///< [IN] The page.
+    const statsPage_Section_t*  sectionPtr,     ///< [IN] The section, in the same page.
+    uint32_t                    index           ///< [IN] Index of the slot.
+)
+{
+    size_t offset = sectionPtr->offset + (size_t)index * sectionPtr->slotSize;
+
+    if (offset + sectionPtr->slotSize > pagePtr->pageSize)
+    {
+        return NULL;
+    }
+
+    return (const uint8_t*)pagePtr + offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that a page has a header this tool understands and that its sections are the sizes
+ * expected.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsPageValid
+(
+    const statsPage_Header_t*   pagePtr,    ///< [IN] The page.
+    size_t                      size,       ///< [IN] Size of the mapping.
+    pid_t                       pid         ///< [IN] Process the page was found in.
+)
+{
+    return (size >= sizeof(statsPage_Header_t)) &&
+           (memcmp(pagePtr->magic, STATSPAGE_MAGIC, sizeof(pagePtr->magic)) == 0) &&
+           (pagePtr->version == STATSPAGE_VERSION) &&
+           (pagePtr->pageSize <= size) &&
+           (pagePtr->pid == pid) &&
+           (pagePtr->pools.slotSize == sizeof(statsPage_Pool_t)) &&
+           (pagePtr->threads.slotSize == sizeof(statsPage_Thread_t)) &&
+           (pagePtr->sessions.slotSize == sizeof(statsPage_Session_t)) &&
+           (pagePtr->handlers.slotSize == sizeof(statsPage_Handler_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forgets a process's page.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnmapPage
+(
+    Process_t* procPtr  ///< [IN] The process.
+)
+{
+    if (procPtr->pagePtr != NULL)
+    {
+        munmap((void*)procPtr->pagePtr, procPtr->pageSize);
+        procPtr->pagePtr = NULL;
+    }
+
+    free(procPtr->prevPtr);
+    procPtr->prevPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps the statistics page of a process, if it has one, by looking for its memfd among the
+ * process's open files.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MapPage
+(
+    Process_t* procPtr  ///< [IN] The process.
+)
+{
+    char path[64];
+    char target[64];
+    struct dirent* entryPtr;
+
+    snprintf(path, sizeof(path), "/proc/%" PRIu32 "/fd", procPtr->pid);
+
+    DIR* dirPtr = opendir(path);
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        snprintf(path, sizeof(path), "/proc/%" PRIu32 "/fd/%s", procPtr->pid, entryPtr->d_name);
+
+        ssize_t len = readlink(path, target, sizeof(target) - 1);
+        if (len <= 0)
+        {
+            continue;
+        }
+        target[len] = '\0';
+
+        if (strncmp(target, MEMFD_LINK_PREFIX, sizeof(MEMFD_LINK_PREFIX) - 1) != 0)
+        {
+            continue;
+        }
+
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        struct stat st;
+        void* mapPtr = MAP_FAILED;
+
+        if ((fstat(fd, &st) == 0) &&
+            (st.st_size >= (off_t)sizeof(statsPage_Header_t)) &&
+            (st.st_size <= STATSPAGE_MAX_PAGE_BYTES))
+        {
+            mapPtr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        fd_Close(fd);
+
+        if (mapPtr == MAP_FAILED)
+        {
+            continue;
+        }
+
+        if (!IsPageValid(mapPtr, st.st_size, procPtr->pid))
+        {
+            munmap(mapPtr, st.st_size);
+            continue;
+        }
+
+        procPtr->pagePtr = mapPtr;
+        procPtr->pageSize = st.st_size;
+        procPtr->pageInode = st.st_ino;
+        procPtr->fdNum = atoi(entryPtr->d_name);
+        break;
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that a mapped page still belongs to the process with the same process ID, which may
+ * have exited and had its ID re-used.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsPageCurrent
+(
+    const Process_t* procPtr    ///< [IN] The process.
+)
+{
+    char path[64];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "/proc/%" PRIu32 "/fd/%d", procPtr->pid, procPtr->fdNum);
+
+    return (stat(path, &st) == 0) && (st.st_ino == procPtr->pageInode);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the name of a process from /proc/<pid>/comm.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadProcessName
+(
+    Process_t* procPtr  ///< [IN] The process.
+)
+{
+    char path[64];
+
+    snprintf(path, sizeof(path), "/proc/%" PRIu32 "/comm", procPtr->pid);
+
+    procPtr->name[0] = '\0';
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        ssize_t len = read(fd, procPtr->name, sizeof(procPtr->name) - 1);
+        fd_Close(fd);
+
+        if (len > 0)
+        {
+            procPtr->name[len] = '\0';
+            procPtr->name[strcspn(procPtr->name, "\n")] = '\0';
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds or creates the entry for a process, and makes sure its page (if it has one) is mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateProcess
+(
+    uint32_t pid    ///< [IN] Process ID.
+)
+{
+    Process_t* procPtr = le_hashmap_Get(ProcessMap, &pid);
+
+    if (procPtr == NULL)
+    {
+        procPtr = le_mem_ForceAlloc(ProcessPool);
+        memset(procPtr, 0, sizeof(*procPtr));
+        procPtr->pid = pid;
+        procPtr->noPageCount = NO_PAGE_RECHECK_COUNT;
+        le_hashmap_Put(ProcessMap, &procPtr->pid, procPtr);
+    }
+
+    procPtr->lastSeen = RefreshCount;
+
+    if ((procPtr->pagePtr != NULL) && !IsPageCurrent(procPtr))
+    {
+        UnmapPage(procPtr);
+        procPtr->noPageCount = NO_PAGE_RECHECK_COUNT;
+    }
+
+    if ((procPtr->pagePtr == NULL) && (++procPtr->noPageCount >= NO_PAGE_RECHECK_COUNT))
+    {
+        procPtr->noPageCount = 0;
+        MapPage(procPtr);
+        if (procPtr->pagePtr != NULL)
+        {
+            ReadProcessName(procPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Brings the process map up to date with the running processes.  Processes that have exited are
+ * forgotten.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScanProcesses
+(
+    void
+)
+{
+    RefreshCount++;
+
+    if (PidToShow > 0)
+    {
+        UpdateProcess(PidToShow);
+    }
+    else
+    {
+        DIR* dirPtr = opendir("/proc");
+        struct dirent* entryPtr;
+
+        LE_FATAL_IF(dirPtr == NULL, "Failed to open /proc. %m.");
+
+        while ((entryPtr = readdir(dirPtr)) != NULL)
+        {
+            char* endPtr;
+            unsigned long pid = strtoul(entryPtr->d_name, &endPtr, 10);
+
+            if ((*endPtr == '\0') && (pid > 0))
+            {
+                UpdateProcess(pid);
+            }
+        }
+
+        closedir(dirPtr);
+    }
+
+    // Forget the processes that weren't seen this time.  They can't be removed from the map while
+    // iterating over it, so are collected first.
+    le_hashmap_It_Ref_t iterRef = le_hashmap_GetIterator(ProcessMap);
+    Process_t* deadProcs[le_hashmap_Size(ProcessMap) + 1];
+    size_t numDead = 0;
+    size_t i;
+
+    while (le_hashmap_NextNode(iterRef) == LE_OK)
+    {
+        Process_t* procPtr = (Process_t*)le_hashmap_GetValue(iterRef);
+
+        if (procPtr->lastSeen != RefreshCount)
+        {
+            deadProcs[numDead++] = procPtr;
+        }
+    }
+
+    for (i = 0; i < numDead; i++)
+    {
+        UnmapPage(deadProcs[i]);
+        le_hashmap_Remove(ProcessMap, &deadProcs[i]->pid);
+        le_mem_Release(deadProcs[i]);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keeps a copy of a process's page, to compute rates from at the next refresh.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SaveSample
+(
+    Process_t* procPtr  ///< [IN] The process.
+)
+{
+    if (procPtr->prevPtr == NULL)
+    {
+        procPtr->prevPtr = malloc(procPtr->pageSize);
+        LE_ASSERT(procPtr->prevPtr != NULL);
+    }
+
+    memcpy(procPtr->prevPtr, procPtr->pagePtr, procPtr->pageSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares process entries by process ID, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int ComparePids
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const Process_t* a = *(const Process_t* const*)aPtr;
+    const Process_t* b = *(const Process_t* const*)bPtr;
+
+    return (a->pid > b->pid) - (a->pid < b->pid);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints one line per process with a statistics page.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintSummary
+(
+    void
+)
+{
+    size_t count = 0;
+    size_t i;
+    le_hashmap_It_Ref_t iterRef = le_hashmap_GetIterator(ProcessMap);
+    Process_t* procs[le_hashmap_Size(ProcessMap) + 1];
+
+    while (le_hashmap_NextNode(iterRef) == LE_OK)
+    {
+        Process_t* procPtr = (Process_t*)le_hashmap_GetValue(iterRef);
+
+        if (procPtr->pagePtr != NULL)
+        {
+            procs[count++] = procPtr;
+        }
+    }
+
+    qsort(procs, count, sizeof(procs[0]), ComparePids);
+
+    printf("%7s %-16s %9s %9s %9s %9s %9s %6s %6s %7s %8s %6s\n",
+           "PID", "NAME", "TX/s", "RX/s", "TXKB/s", "RXKB/s", "EVENTS/s",
+           "QUEUE", "QMAX", "TIMERS", "EXPIRY/s", "POOLOVF");
+
+    for (i = 0; i < count; i++)
+    {
+        const statsPage_Header_t* pagePtr = procs[i]->pagePtr;
+        const statsPage_Header_t* prevPtr = procs[i]->prevPtr;
+        bool hasPrev = (prevPtr != NULL);
+        uint64_t queue = 0;
+        uint64_t queueMax = 0;
+        uint64_t overflows = 0;
+        uint32_t j;
+
+        for (j = 0; j < pagePtr->threads.count; j++)
+        {
+            const statsPage_Thread_t* slotPtr = GetSlot(pagePtr, &pagePtr->threads, j);
+
+            if ((slotPtr != NULL) && (slotPtr->state == STATSPAGE_SLOT_IN_USE))
+            {
+                queue += Load(&slotPtr->queueDepth);
+                if (Load(&slotPtr->queueHighWater) > queueMax)
+                {
+                    queueMax = Load(&slotPtr->queueHighWater);
+                }
+            }
+        }
+
+        for (j = 0; j < pagePtr->pools.count; j++)
+        {
+            const statsPage_Pool_t* slotPtr = GetSlot(pagePtr, &pagePtr->pools, j);
+
+            if ((slotPtr != NULL) && (slotPtr->state == STATSPAGE_SLOT_IN_USE))
+            {
+                overflows += Load(&slotPtr->overflows);
+            }
+        }
+
+#define PAGE_RATE(field) \
+        Rate(Load(&pagePtr->field), hasPrev ? prevPtr->field : 0, hasPrev)
+
+        printf("%7" PRIu32 " %-16.16s %9.0f %9.0f %9.1f %9.1f %9.0f %6" PRIu64 " %6" PRIu64
+               " %7" PRIu64 " %8.0f %6" PRIu64 "\n",
+               procs[i]->pid,
+               procs[i]->name,
+               PAGE_RATE(ipcTxMsgs),
+               PAGE_RATE(ipcRxMsgs),
+               PAGE_RATE(ipcTxBytes) / 1024,
+               PAGE_RATE(ipcRxBytes) / 1024,
+               PAGE_RATE(eventsDispatched),
+               queue,
+               queueMax,
+               Load(&pagePtr->timersCreated) - Load(&pagePtr->timersDeleted),
+               PAGE_RATE(timerExpiries),
+               overflows);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the slot in the previous sample that matches a slot of the current page: the same slot,
+ * still in use and with the same name.
+ *
+ * @return The previous slot, or NULL if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static const void* GetPrevSlot
+(
+    const Process_t*            procPtr,    ///< [IN] The process.
+    const statsPage_Section_t*  sectionPtr, ///< [IN] The section, in the current page.
+    uint32_t                    index,      ///< [IN] Index of the slot.
+    size_t                      nameOffset  ///< [IN] Offset of the slot's name.
+)
+{
+    if (procPtr->prevPtr == NULL)
+    {
+        return NULL;
+    }
+
+    const uint8_t* slotPtr = GetSlot(procPtr->pagePtr, sectionPtr, index);
+    const uint8_t* prevSlotPtr = slotPtr - (const uint8_t*)procPtr->pagePtr +
+                                 (const uint8_t*)procPtr->prevPtr;
+
+    if ((*(const uint32_t*)prevSlotPtr != STATSPAGE_SLOT_IN_USE) ||
+        (strncmp((const char*)prevSlotPtr + nameOffset, (const char*)slotPtr + nameOffset,
+                 STATSPAGE_NAME_BYTES) != 0))
+    {
+        return NULL;
+    }
+
+    return prevSlotPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the upper bound, in microseconds, of the histogram bucket that a percentile of the
+ * waits falls into.
+ *
+ * @return The bound, or 0 if there were no waits.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetPercentile
+(
+    const uint32_t* countsPtr,  ///< [IN] Number of waits in each bucket.
+    unsigned int percentile     ///< [IN] The percentile (1 to 100).
+)
+{
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    int i;
+
+    for (i = 0; i < STATSPAGE_HISTOGRAM_BUCKETS; i++)
+    {
+        total += countsPtr[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < STATSPAGE_HISTOGRAM_BUCKETS; i++)
+    {
+        sum += countsPtr[i];
+        if (sum * 100 >= total * percentile)
+        {
+            break;
+        }
+    }
+
+    return 1ULL << i;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A handler's dispatches since the previous sample, for sorting.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const statsPage_Handler_t*  slotPtr;    ///< Handler's slot in the page.
+    uint64_t                    count;      ///< Dispatches since the previous sample.
+    uint64_t                    waitNs;     ///< Wait time since the previous sample.
+    uint64_t                    runNs;      ///< Run time since the previous sample.
+    uint32_t                    waitHistogram[STATSPAGE_HISTOGRAM_BUCKETS]; ///< Waits since the
+                                                                            ///  previous sample.
+}
+HandlerRow_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares handler rows by number of dispatches, busiest first, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareHandlerRows
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const HandlerRow_t* a = aPtr;
+    const HandlerRow_t* b = bPtr;
+
+    return (a->count < b->count) - (a->count > b->count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the handlers of a process, busiest first.  Without a previous sample, the totals since
+ * the process started are shown.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHandlers
+(
+    const Process_t* procPtr    ///< [IN] The process.
+)
+{
+    const statsPage_Header_t* pagePtr = procPtr->pagePtr;
+    const statsPage_Header_t* prevPtr = procPtr->prevPtr;
+    HandlerRow_t* rows = calloc(pagePtr->handlers.count, sizeof(HandlerRow_t));
+    size_t numRows = 0;
+    uint32_t i;
+    int j;
+
+    LE_ASSERT(rows != NULL);
+
+    for (i = 0; i < pagePtr->handlers.count; i++)
+    {
+        const statsPage_Handler_t* slotPtr = GetSlot(pagePtr, &pagePtr->handlers, i);
+
+        if ((slotPtr == NULL) || (Load(&slotPtr->func) == 0))
+        {
+            continue;
+        }
+
+        HandlerRow_t* rowPtr = &rows[numRows];
+        const statsPage_Handler_t* prevSlotPtr = NULL;
+
+        if (prevPtr != NULL)
+        {
+            prevSlotPtr = GetSlot(prevPtr, &prevPtr->handlers, i);
+        }
+
+        rowPtr->slotPtr = slotPtr;
+        rowPtr->count = Load(&slotPtr->count);
+        rowPtr->waitNs = Load(&slotPtr->totalWaitNs);
+        rowPtr->runNs = Load(&slotPtr->totalRunNs);
+        for (j = 0; j < STATSPAGE_HISTOGRAM_BUCKETS; j++)
+        {
+            rowPtr->waitHistogram[j] = slotPtr->waitHistogram[j];
+        }
+
+        // Handler slots are never re-used, so the same slot holds the same handler.
+        if ((prevSlotPtr != NULL) && (prevSlotPtr->func == slotPtr->func))
+        {
+            rowPtr->count -= prevSlotPtr->count;
+            rowPtr->waitNs -= prevSlotPtr->totalWaitNs;
+            rowPtr->runNs -= prevSlotPtr->totalRunNs;
+            for (j = 0; j < STATSPAGE_HISTOGRAM_BUCKETS; j++)
+            {
+                rowPtr->waitHistogram[j] -= prevSlotPtr->waitHistogram[j];
+            }
+        }
+
+        numRows++;
+    }
+
+    qsort(rows, numRows, sizeof(rows[0]), CompareHandlerRows);
+
+    printf("\n%-32s %9s %9s %9s %9s %9s %9s %9s\n",
+           "HANDLER", prevPtr ? "CALLS/s" : "CALLS", "WAIT(us)", "P50(us)", "P99(us)",
+           "MAXW(us)", "RUN(us)", "MAXR(us)");
+
+    for (i = 0; (i < numRows) && (i < MAX_HANDLER_ROWS); i++)
+    {
+        const HandlerRow_t* rowPtr = &rows[i];
+        const statsPage_Handler_t* slotPtr = rowPtr->slotPtr;
+        char name[STATSPAGE_NAME_BYTES];
+        double calls = rowPtr->count;
+
+        if (slotPtr->name[0] != '\0')
+        {
+            le_utf8_Copy(name, slotPtr->name, sizeof(name), NULL);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "0x%" PRIx64, Load(&slotPtr->func));
+        }
+
+        if (prevPtr != NULL)
+        {
+            calls /= RefreshInterval;
+        }
+
+        printf("%-32.32s %9.0f %9.1f %9" PRIu64 " %9" PRIu64 " %9.1f %9.1f %9.1f\n",
+               name,
+               calls,
+               rowPtr->count ? rowPtr->waitNs / 1000.0 / rowPtr->count : 0.0,
+               GetPercentile(rowPtr->waitHistogram, 50),
+               GetPercentile(rowPtr->waitHistogram, 99),
+               Load(&slotPtr->maxWaitNs) / 1000.0,
+               rowPtr->count ? rowPtr->runNs / 1000.0 / rowPtr->count : 0.0,
+               Load(&slotPtr->maxRunNs) / 1000.0);
+    }
+
+    free(rows);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the threads, IPC sessions, memory pools and handlers of one process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintProcess
+(
+    const Process_t* procPtr    ///< [IN] The process.
+)
+{
+    const statsPage_Header_t* pagePtr = procPtr->pagePtr;
+    bool hasPrev = (procPtr->prevPtr != NULL);
+    uint32_t i;
+
+    printf("Process %" PRIu32 " (%s): %" PRIu64 " timers, %" PRIu64 " timer starts, %" PRIu64
+           " expiries, %" PRIu64 " objects not tracked\n",
+           procPtr->pid, procPtr->name,
+           Load(&pagePtr->timersCreated) - Load(&pagePtr->timersDeleted),
+           Load(&pagePtr->timerStarts),
+           Load(&pagePtr->timerExpiries),
+           Load(&pagePtr->slotsExhausted));
+
+    printf("\n%-32s %7s %9s %9s %12s\n", "THREAD", "TID", "QUEUE", "QMAX", "EVENTS/s");
+    for (i = 0; i < pagePtr->threads.count; i++)
+    {
+        const statsPage_Thread_t* slotPtr = GetSlot(pagePtr, &pagePtr->threads, i);
+
+        if ((slotPtr == NULL) || (slotPtr->state != STATSPAGE_SLOT_IN_USE))
+        {
+            continue;
+        }
+
+        const statsPage_Thread_t* prevSlotPtr =
+            GetPrevSlot(procPtr, &pagePtr->threads, i, offsetof(statsPage_Thread_t, name));
+
+        printf("%-32.32s %7" PRId32 " %9" PRIu64 " %9" PRIu64 " %12.0f\n",
+               slotPtr->name,
+               slotPtr->tid,
+               Load(&slotPtr->queueDepth),
+               Load(&slotPtr->queueHighWater),
+               Rate(Load(&slotPtr->dispatched), prevSlotPtr ? prevSlotPtr->dispatched : 0,
+                    hasPrev && prevSlotPtr));
+    }
+
+    printf("\n%-32s %6s %9s %9s %9s %9s\n", "SESSION", "SIDE", "TX/s", "RX/s", "TX", "RX");
+    for (i = 0; i < pagePtr->sessions.count; i++)
+    {
+        const statsPage_Session_t* slotPtr = GetSlot(pagePtr, &pagePtr->sessions, i);
+
+        if ((slotPtr == NULL) || (slotPtr->state != STATSPAGE_SLOT_IN_USE))
+        {
+            continue;
+        }
+
+        const statsPage_Session_t* prevSlotPtr =
+            GetPrevSlot(procPtr, &pagePtr->sessions, i, offsetof(statsPage_Session_t, name));
+        bool hasPrevSlot = (prevSlotPtr != NULL);
+
+        printf("%-32.32s %6s %9.0f %9.0f %9" PRIu64 " %9" PRIu64 "\n",
+               slotPtr->name,
+               slotPtr->isServer ? "server" : "client",
+               Rate(Load(&slotPtr->txMsgs), hasPrevSlot ? prevSlotPtr->txMsgs : 0, hasPrevSlot),
+               Rate(Load(&slotPtr->rxMsgs), hasPrevSlot ? prevSlotPtr->rxMsgs : 0, hasPrevSlot),
+               Load(&slotPtr->txMsgs),
+               Load(&slotPtr->rxMsgs));
+    }
+
+    printf("\n%-32s %7s %9s %9s %9s %9s %12s\n",
+           "POOL", "OBJSIZE", "TOTAL", "USED", "MAXUSED", "OVERFLOWS", "ALLOCS/s");
+    for (i = 0; i < pagePtr->pools.count; i++)
+    {
+        const statsPage_Pool_t* slotPtr = GetSlot(pagePtr, &pagePtr->pools, i);
+
+        if ((slotPtr == NULL) || (slotPtr->state != STATSPAGE_SLOT_IN_USE))
+        {
+            continue;
+        }
+
+        const statsPage_Pool_t* prevSlotPtr =
+            GetPrevSlot(procPtr, &pagePtr->pools, i, offsetof(statsPage_Pool_t, name));
+
+        printf("%-32.32s %7" PRIu32 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64
+               " %12.0f\n",
+               slotPtr->name,
+               slotPtr->objSize,
+               Load(&slotPtr->totalBlocks),
+               Load(&slotPtr->inUse),
+               Load(&slotPtr->maxUsed),
+               Load(&slotPtr->overflows),
+               Rate(Load(&slotPtr->allocs), prevSlotPtr ? prevSlotPtr->allocs : 0,
+                    prevSlotPtr != NULL));
+    }
+
+    PrintHandlers(procPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a sample of every page and, except for the first, prints it.  The first sample is only
+ * taken as the starting point for rates.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Refresh
+(
+    le_timer_Ref_t timerRef     ///< [IN] Refresh timer.
+)
+{
+    ScanProcesses();
+
+    if (RefreshCount > 1)
+    {
+        if (IsFollowing)
+        {
+            // Clear the screen and move the cursor to the top left.
+            printf("\033[2J\033[H");
+        }
+
+        if (PidToShow > 0)
+        {
+            uint32_t pid = PidToShow;
+            Process_t* procPtr = le_hashmap_Get(ProcessMap, &pid);
+
+            if ((procPtr == NULL) || (procPtr->pagePtr == NULL))
+            {
+                fprintf(stderr, "Process %d has no statistics page.\n", PidToShow);
+                exit(EXIT_FAILURE);
+            }
+
+            PrintProcess(procPtr);
+        }
+        else
+        {
+            PrintSummary();
+        }
+
+        fflush(stdout);
+
+        if (!IsFollowing)
+        {
+            exit(EXIT_SUCCESS);
+        }
+    }
+
+    le_hashmap_It_Ref_t iterRef = le_hashmap_GetIterator(ProcessMap);
+
+    while (le_hashmap_NextNode(iterRef) == LE_OK)
+    {
+        Process_t* procPtr = (Process_t*)le_hashmap_GetValue(iterRef);
+
+        if (procPtr->pagePtr != NULL)
+        {
+            SaveSample(procPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints help to stdout and exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts(
+        "NAME:\n"
+        "    legato-top - Shows the runtime statistics of Legato processes.\n"
+        "\n"
+        "SYNOPSIS:\n"
+        "    legato-top [OPTIONS] [PID]\n"
+        "\n"
+        "DESCRIPTION:\n"
+        "    legato-top                 Prints one line per Legato process: IPC messages and\n"
+        "                               bytes per second, events dispatched per second, event\n"
+        "                               queue depth and high-water mark, timers, timer expiries\n"
+        "                               per second and memory pool overflows.\n"
+        "    legato-top PID             Prints the threads, IPC sessions, memory pools and event\n"
+        "                               handlers of a process, with the handlers' dispatch\n"
+        "                               latencies.\n"
+        "\n"
+        "    Rates are measured over one interval, so the first output appears after one\n"
+        "    interval.  Only processes of a framework built with runtime statistics enabled\n"
+        "    are shown.\n"
+        "\n"
+        "OPTIONS:\n"
+        "    -f\n"
+        "        Periodically prints updated information.\n"
+        "\n"
+        "    --interval=SECONDS\n"
+        "        Measures rates over SECONDS (default 2).  With -f, prints updated information\n"
+        "        every SECONDS.\n"
+        "\n"
+        "    --help\n"
+        "        Display this help and exit.\n"
+        );
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the command line argument scanner when the PID is given.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PidArgHandler
+(
+    const char* pidStr
+)
+{
+    char* endPtr;
+    long pid = strtol(pidStr, &endPtr, 10);
+
+    if ((*endPtr != '\0') || (pid <= 0) || (pid > INT32_MAX))
+    {
+        fprintf(stderr, "Invalid PID (%s).\n", pidStr);
+        exit(EXIT_FAILURE);
+    }
+
+    PidToShow = pid;
+}
+
+
+COMPONENT_INIT
+{
+    // An optional PID selects the process to show in detail.
+    le_arg_AddPositionalCallback(PidArgHandler);
+    le_arg_AllowLessPositionalArgsThanCallbacks();
+
+    // --help option causes everything else to be ignored, prints help, and exits.
+    le_arg_SetFlagCallback(PrintHelp, NULL, "help");
+
+    // -f option starts "following" (periodic updates until the program is terminated).
+    le_arg_SetFlagVar(&IsFollowing, "f", NULL);
+
+    // --interval=N option specifies the sampling period.
+    le_arg_SetIntVar(&RefreshInterval, NULL, "interval");
+
+    le_arg_Scan();
+
+    if (RefreshInterval <= 0)
+    {
+        fprintf(stderr, "Interval must be a positive integer.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ProcessPool = le_mem_CreatePool("Processes", sizeof(Process_t));
+    ProcessMap = le_hashmap_Create("Processes",
+                                   PROCESS_MAP_SIZE,
+                                   le_hashmap_HashUInt32,
+                                   le_hashmap_EqualsUInt32);
+
+    le_timer_Ref_t timerRef = le_timer_Create("Refresh");
+    le_clk_Time_t interval = { .sec = RefreshInterval, .usec = 0 };
+
+    LE_ASSERT(le_timer_SetHandler(timerRef, Refresh) == LE_OK);
+    LE_ASSERT(le_timer_SetInterval(timerRef, interval) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(timerRef, 0) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+
+    // Take the first sample now.
+    Refresh(timerRef);
+}